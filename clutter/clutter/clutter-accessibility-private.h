@@ -32,4 +32,8 @@ void _clutter_accessibility_override_atk_util (void);
 gboolean clutter_accessibility_snoop_key_event (ClutterStage    *stage,
                                                 ClutterKeyEvent *key);
 
+void clutter_actor_accessible_queue_state_change (AtkObject    *accessible,
+                                                  AtkStateType  state,
+                                                  gboolean      value);
+
 G_END_DECLS
@@ -64,6 +64,11 @@
  *
  *  https://bugzilla.gnome.org/show_bug.cgi?id=649804
  *
+ * State changes: the state changes ClutterActor reports while mapping,
+ * showing or making actors reactive are queued and emitted at most once
+ * per state from an idle, after the frame that caused them. A state that
+ * was toggled back before the idle ran is not reported at all.
+ *
  */
 
 #include "config.h"
@@ -73,8 +78,10 @@
 #include <atk/atk.h>
 #include <glib.h>
 
+#include "clutter/clutter-accessibility-private.h"
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-actor-accessible.h"
+#include "clutter/clutter-main.h"
 #include "clutter/clutter-stage.h"
 
 /* AtkComponent.h */
@@ -83,8 +90,15 @@ static void clutter_actor_accessible_component_interface_init (AtkComponentIface
 struct _ClutterActorAccessiblePrivate
 {
   GList *children;
+
+  /* queued state changes, one bit per AtkStateType */
+  uint64_t pending_states;
+  uint64_t pending_values;
 };
 
+static GHashTable *pending_state_changes = NULL;
+static guint state_changes_idle_id = 0;
+
 G_DEFINE_TYPE_WITH_CODE (ClutterActorAccessible,
                          clutter_actor_accessible,
                          ATK_TYPE_GOBJECT_ACCESSIBLE,
@@ -204,6 +218,107 @@ clutter_actor_accessible_initialize (AtkObject *obj,
                                  interface would be a panel */
 }
 
+static void
+clutter_actor_accessible_flush_state_changes (ClutterActorAccessible *self)
+{
+  ClutterActorAccessiblePrivate *priv =
+    clutter_actor_accessible_get_instance_private (self);
+  uint64_t pending_states = priv->pending_states;
+  uint64_t pending_values = priv->pending_values;
+  int state;
+
+  priv->pending_states = 0;
+  priv->pending_values = 0;
+
+  /* Object is defunct */
+  if (CLUTTER_ACTOR_FROM_ACCESSIBLE (self) == NULL)
+    return;
+
+  for (state = 0; pending_states != 0; state++)
+    {
+      uint64_t bit = UINT64_C (1) << state;
+
+      if ((pending_states & bit) == 0)
+        continue;
+
+      pending_states &= ~bit;
+      atk_object_notify_state_change (ATK_OBJECT (self), state,
+                                      (pending_values & bit) != 0);
+    }
+}
+
+static gboolean
+flush_pending_state_changes (gpointer user_data)
+{
+  g_autoptr (GHashTable) pending = g_steal_pointer (&pending_state_changes);
+  GHashTableIter iter;
+  gpointer key;
+
+  state_changes_idle_id = 0;
+
+  g_hash_table_iter_init (&iter, pending);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    clutter_actor_accessible_flush_state_changes (key);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * clutter_actor_accessible_queue_state_change:
+ * @accessible: an #AtkObject
+ * @state: the #AtkStateType that changed
+ * @value: the new value of @state
+ *
+ * Reports that @state of @accessible changed to @value. For
+ * #ClutterActorAccessible objects the notification is deferred to an
+ * idle, and dropped if @state changes back before that; any other
+ * accessible is notified right away.
+ */
+void
+clutter_actor_accessible_queue_state_change (AtkObject    *accessible,
+                                             AtkStateType  state,
+                                             gboolean      value)
+{
+  ClutterActorAccessiblePrivate *priv;
+  uint64_t bit;
+
+  if (!CLUTTER_IS_ACTOR_ACCESSIBLE (accessible) || state >= 64)
+    {
+      atk_object_notify_state_change (accessible, state, value);
+      return;
+    }
+
+  priv = clutter_actor_accessible_get_instance_private (CLUTTER_ACTOR_ACCESSIBLE (accessible));
+  bit = UINT64_C (1) << state;
+
+  if (priv->pending_states & bit)
+    {
+      /* Every queued change is a toggle, so a second one for the same
+       * state restores the value assistive technologies already know.
+       */
+      if (((priv->pending_values & bit) != 0) != !!value)
+        priv->pending_states &= ~bit;
+      return;
+    }
+
+  priv->pending_states |= bit;
+  if (value)
+    priv->pending_values |= bit;
+  else
+    priv->pending_values &= ~bit;
+
+  if (!pending_state_changes)
+    pending_state_changes = g_hash_table_new_full (NULL, NULL,
+                                                   g_object_unref, NULL);
+
+  if (!g_hash_table_contains (pending_state_changes, accessible))
+    g_hash_table_add (pending_state_changes, g_object_ref (accessible));
+
+  if (state_changes_idle_id == 0)
+    state_changes_idle_id = clutter_threads_add_idle (flush_pending_state_changes,
+                                                      NULL);
+}
+
 /* AtkObject */
 static const gchar *
 clutter_actor_accessible_get_name (AtkObject *obj)
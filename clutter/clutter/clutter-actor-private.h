@@ -284,6 +284,14 @@ void clutter_actor_finish_layout (ClutterActor *self,
 
 void clutter_actor_queue_immediate_relayout (ClutterActor *self);
 
+gboolean clutter_actor_reallocate_relayout_boundary (ClutterActor *self);
+
+uint64_t clutter_actor_get_relayout_serial (ClutterActor *self);
+
+ClutterContent * clutter_actor_get_sole_content (ClutterActor *self);
+
+AtkObject * clutter_actor_peek_accessible (ClutterActor *self);
+
 gboolean clutter_actor_is_painting_unmapped (ClutterActor *self);
 
 void clutter_actor_attach_grab (ClutterActor *actor,
@@ -300,4 +308,11 @@ const GList * clutter_actor_peek_actions (ClutterActor *self);
 void clutter_actor_set_implicitly_grabbed (ClutterActor *actor,
                                            gboolean      is_implicitly_grabbed);
 
+GParamSpec * clutter_actor_find_direct_animatable_property (ClutterActor *actor,
+                                                            const char   *property_name);
+
+void clutter_actor_set_animated_property (ClutterActor *actor,
+                                          GParamSpec   *pspec,
+                                          const GValue *value);
+
 G_END_DECLS
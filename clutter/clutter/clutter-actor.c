@@ -488,6 +488,7 @@
 
 #include "clutter/clutter-actor-private.h"
 
+#include "clutter/clutter-accessibility-private.h"
 #include "clutter/clutter-action.h"
 #include "clutter/clutter-action-private.h"
 #include "clutter/clutter-actor-meta-private.h"
@@ -543,6 +544,21 @@ typedef enum
  * will ask for 3 different preferred size in each allocation cycle */
 #define N_CACHED_SIZE_REQUESTS 3
 
+typedef struct _ClutterRetainedPaintNodes
+{
+  GPtrArray *nodes;
+
+  /* state the nodes were built for */
+  graphene_matrix_t modelview;
+  float width;
+  float height;
+  float resource_scale;
+  uint8_t paint_opacity;
+  ClutterPaintFlag paint_flags;
+  ClutterColorState *color_state;
+  ClutterColorState *target_color_state;
+} ClutterRetainedPaintNodes;
+
 struct _ClutterActorPrivate
 {
   ClutterContext *context;
@@ -661,6 +677,17 @@ struct _ClutterActorPrivate
    */
   ClutterPaintVolume visible_paint_volume;
 
+  /* The stage paint box of the paint volume, and the frame it was
+   * computed for. It is reused by every consumer within that frame.
+   */
+  ClutterActorBox paint_box;
+  int64_t paint_box_frame_counter;
+
+  /* bumped every time a relayout is queued on the actor, either by
+   * the actor itself or by one of its children
+   */
+  uint64_t relayout_serial;
+
   CoglColor bg_color;
 
   /* a string used for debugging messages */
@@ -693,6 +720,10 @@ struct _ClutterActorPrivate
 
   GArray *next_redraw_clips;
 
+  /* the paint nodes built by the actor itself on its last paint, kept
+   * around when retain_paint_nodes is set */
+  ClutterRetainedPaintNodes *retained_paint_nodes;
+
   /* bitfields: KEEP AT THE END */
 
   /* fixed position and sizes */
@@ -732,11 +763,14 @@ struct _ClutterActorPrivate
   guint needs_y_expand              : 1;
   guint needs_paint_volume_update   : 1;
   guint needs_visible_paint_volume_update : 1;
+  guint paint_box_valid : 1;
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_update_stage_views    : 1;
   guint clear_stage_views_needs_stage_views_changed : 1;
   guint needs_redraw : 1;
   guint needs_finish_layout : 1;
+  guint queued_as_relayout_boundary : 1;
+  guint retain_paint_nodes : 1;
   guint stage_relative_modelview_valid : 1;
 };
 
@@ -937,6 +971,9 @@ static void clutter_actor_set_natural_height_set (ClutterActor *self,
 static void clutter_actor_update_map_state       (ClutterActor  *self,
                                                   MapStateChange change);
 static void clutter_actor_unrealize_not_hiding   (ClutterActor *self);
+static void clutter_actor_real_queue_relayout    (ClutterActor *self);
+static void clutter_actor_allocate_internal      (ClutterActor          *self,
+                                                  const ClutterActorBox *allocation);
 
 static ClutterPaintVolume *_clutter_actor_get_paint_volume_mutable (ClutterActor *self);
 
@@ -1412,6 +1449,7 @@ queue_update_paint_volume (ClutterActor *actor)
     {
       actor->priv->needs_paint_volume_update = TRUE;
       actor->priv->needs_visible_paint_volume_update = TRUE;
+      actor->priv->paint_box_valid = FALSE;
       actor->priv->needs_finish_layout = TRUE;
       actor = actor->priv->parent;
     }
@@ -1459,11 +1497,11 @@ clutter_actor_real_map (ClutterActor *self)
    */
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MAPPED]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible && !clutter_actor_is_painting_unmapped (self))
-    atk_object_notify_state_change (accessible,
-                                    ATK_STATE_SHOWING,
-                                    TRUE);
+    clutter_actor_accessible_queue_state_change (accessible,
+                                                 ATK_STATE_SHOWING,
+                                                 TRUE);
 
   for (iter = priv->first_child;
        iter != NULL;
@@ -1580,6 +1618,8 @@ clutter_actor_real_unmap (ClutterActor *self)
 
   self->flags &= ~CLUTTER_ACTOR_MAPPED;
 
+  clutter_actor_clear_retained_paint_nodes (self);
+
   if (priv->unmapped_paint_branch_counter == 0)
     {
       if (priv->parent && !CLUTTER_ACTOR_IN_DESTRUCTION (priv->parent))
@@ -1596,11 +1636,11 @@ clutter_actor_real_unmap (ClutterActor *self)
    */
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_MAPPED]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible && !clutter_actor_is_painting_unmapped (self))
-    atk_object_notify_state_change (accessible,
-                                    ATK_STATE_SHOWING,
-                                    FALSE);
+    clutter_actor_accessible_queue_state_change (accessible,
+                                                 ATK_STATE_SHOWING,
+                                                 FALSE);
 
   if (priv->n_pointers > 0)
     {
@@ -1773,11 +1813,11 @@ clutter_actor_show (ClutterActor *self)
   g_signal_emit (self, actor_signals[SHOW], 0);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_VISIBLE]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible)
-    atk_object_notify_state_change (accessible,
-                                    ATK_STATE_VISIBLE,
-                                    TRUE);
+    clutter_actor_accessible_queue_state_change (accessible,
+                                                 ATK_STATE_VISIBLE,
+                                                 TRUE);
 
   if (priv->parent != NULL)
     clutter_actor_queue_redraw (self);
@@ -1871,11 +1911,11 @@ clutter_actor_hide (ClutterActor *self)
   g_signal_emit (self, actor_signals[HIDE], 0);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_VISIBLE]);
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   if (accessible)
-    atk_object_notify_state_change (accessible,
-                                    ATK_STATE_VISIBLE,
-                                    FALSE);
+    clutter_actor_accessible_queue_state_change (accessible,
+                                                 ATK_STATE_VISIBLE,
+                                                 FALSE);
 
 
   if (priv->parent != NULL && priv->needs_allocation)
@@ -2354,6 +2394,7 @@ absolute_geometry_changed (ClutterActor *actor)
 {
   actor->priv->needs_update_stage_views = TRUE;
   actor->priv->needs_visible_paint_volume_update = TRUE;
+  actor->priv->paint_box_valid = FALSE;
   actor->priv->stage_relative_modelview_valid = FALSE;
 
   actor->priv->needs_finish_layout = TRUE;
@@ -2375,8 +2416,14 @@ absolute_geometry_changed_cb (ClutterActor *actor,
 static void
 transform_changed (ClutterActor *actor)
 {
+  ClutterActor *stage;
+
   actor->priv->transform_valid = FALSE;
 
+  stage = _clutter_actor_get_stage_internal (actor);
+  if (stage)
+    clutter_stage_invalidate_pick (CLUTTER_STAGE (stage), actor);
+
   if (actor->priv->parent)
     queue_update_paint_volume (actor->priv->parent);
 
@@ -2563,6 +2610,108 @@ _clutter_actor_propagate_queue_redraw (ClutterActor *self)
     }
 }
 
+/* Whether a relayout queued by a child can stop at @self. The parent of
+ * @self lays it out based on its preferred size and expand flags only,
+ * so if neither can be affected by the children, it is enough to
+ * reallocate @self in place.
+ */
+static gboolean
+clutter_actor_is_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->parent == NULL || CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    return FALSE;
+
+  if (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
+    return FALSE;
+
+  /* Not allocated yet, or already waiting for a full relayout */
+  if (priv->needs_allocation)
+    return FALSE;
+
+  if (!priv->min_width_set || !priv->natural_width_set ||
+      !priv->min_height_set || !priv->natural_height_set)
+    return FALSE;
+
+  if (priv->needs_compute_expand)
+    return FALSE;
+
+  if (priv->clones != NULL && g_hash_table_size (priv->clones) > 0)
+    return FALSE;
+
+  if (CLUTTER_ACTOR_GET_CLASS (self)->queue_relayout !=
+      clutter_actor_real_queue_relayout)
+    return FALSE;
+
+  if (g_signal_has_handler_pending (self, actor_signals[QUEUE_RELAYOUT],
+                                    0, TRUE))
+    return FALSE;
+
+  return _clutter_actor_get_stage_internal (self) != NULL;
+}
+
+static void
+clutter_actor_queue_boundary_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  CLUTTER_NOTE (LAYOUT, "Stopping relayout at boundary %s",
+                _clutter_actor_get_debug_name (self));
+
+  priv->relayout_serial++;
+  priv->needs_allocation = TRUE;
+
+  if (priv->queued_as_relayout_boundary)
+    return;
+
+  priv->queued_as_relayout_boundary = TRUE;
+  clutter_actor_queue_shallow_relayout (self);
+}
+
+/*
+ * clutter_actor_reallocate_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Reallocates @self in place if it was queued for relayout as a relayout
+ * boundary.
+ *
+ * Returns: %TRUE if @self was a queued relayout boundary
+ */
+gboolean
+clutter_actor_reallocate_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (!priv->queued_as_relayout_boundary)
+    return FALSE;
+
+  priv->queued_as_relayout_boundary = FALSE;
+
+  /* Something further up might have allocated us in the meantime */
+  if (priv->needs_allocation)
+    clutter_actor_allocate_internal (self, &priv->allocation);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_get_relayout_serial:
+ * @self: a #ClutterActor
+ *
+ * Retrieves a counter that changes every time a relayout is queued on
+ * @self, including the ones queued because one of its children changed.
+ * Layout managers can use it to tell whether measurements they cached
+ * for the children of @self are still valid.
+ *
+ * Returns: the relayout serial of @self
+ */
+uint64_t
+clutter_actor_get_relayout_serial (ClutterActor *self)
+{
+  return self->priv->relayout_serial;
+}
+
 static void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
@@ -2587,6 +2736,8 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
     {
       if (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
         clutter_actor_queue_shallow_relayout (self);
+      else if (clutter_actor_is_relayout_boundary (priv->parent))
+        clutter_actor_queue_boundary_relayout (priv->parent);
       else
         _clutter_actor_queue_only_relayout (priv->parent);
     }
@@ -3434,6 +3585,145 @@ clutter_actor_paint_node (ClutterActor        *actor,
   return TRUE;
 }
 
+static void
+clutter_retained_paint_nodes_free (ClutterRetainedPaintNodes *retained)
+{
+  g_ptr_array_unref (retained->nodes);
+  g_clear_object (&retained->color_state);
+  g_clear_object (&retained->target_color_state);
+  g_free (retained);
+}
+
+static void
+clutter_actor_clear_retained_paint_nodes (ClutterActor *self)
+{
+  g_clear_pointer (&self->priv->retained_paint_nodes,
+                   clutter_retained_paint_nodes_free);
+}
+
+static void
+clutter_actor_get_retained_paint_nodes_state (ClutterActor              *self,
+                                              ClutterPaintContext       *paint_context,
+                                              ClutterRetainedPaintNodes *state)
+{
+  ClutterActorPrivate *priv = self->priv;
+  CoglFramebuffer *framebuffer;
+
+  framebuffer = clutter_paint_context_get_framebuffer (paint_context);
+  cogl_framebuffer_get_modelview_matrix (framebuffer, &state->modelview);
+
+  state->width = clutter_actor_box_get_width (&priv->allocation);
+  state->height = clutter_actor_box_get_height (&priv->allocation);
+  state->resource_scale = clutter_actor_get_real_resource_scale (self);
+  state->paint_opacity = clutter_actor_get_paint_opacity_internal (self);
+  state->paint_flags = clutter_paint_context_get_paint_flags (paint_context);
+  state->color_state = clutter_paint_context_get_color_state (paint_context);
+  state->target_color_state =
+    clutter_paint_context_get_target_color_state (paint_context);
+}
+
+static gboolean
+clutter_actor_can_retain_paint_nodes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (!priv->retain_paint_nodes)
+    return FALSE;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES))
+    return FALSE;
+
+  /* Clones paint the source with a different transformation on each
+   * paint; don't let them evict the nodes of the real paint.
+   */
+  if (in_clone_paint ())
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Re-adds the paint nodes retained from the last paint to @root and
+ * paints them, if they were built for the same state the actor is
+ * about to be painted in.
+ */
+static gboolean
+clutter_actor_replay_retained_paint_nodes (ClutterActor        *self,
+                                           ClutterPaintNode    *root,
+                                           ClutterPaintContext *paint_context)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterRetainedPaintNodes *retained = priv->retained_paint_nodes;
+  ClutterRetainedPaintNodes state;
+  unsigned int i;
+
+  if (retained == NULL)
+    return FALSE;
+
+  clutter_actor_get_retained_paint_nodes_state (self, paint_context, &state);
+
+  if (!graphene_matrix_equal_fast (&retained->modelview, &state.modelview) ||
+      !G_APPROX_VALUE (retained->width, state.width, FLT_EPSILON) ||
+      !G_APPROX_VALUE (retained->height, state.height, FLT_EPSILON) ||
+      retained->resource_scale != state.resource_scale ||
+      retained->paint_opacity != state.paint_opacity ||
+      retained->paint_flags != state.paint_flags ||
+      retained->color_state != state.color_state ||
+      retained->target_color_state != state.target_color_state)
+    {
+      clutter_actor_clear_retained_paint_nodes (self);
+      return FALSE;
+    }
+
+  /* The nodes are detached once the root of the previous paint is
+   * released; if something still holds on to it, build new ones.
+   */
+  for (i = 0; i < retained->nodes->len; i++)
+    {
+      ClutterPaintNode *node = g_ptr_array_index (retained->nodes, i);
+
+      if (node->parent != NULL)
+        {
+          clutter_actor_clear_retained_paint_nodes (self);
+          return FALSE;
+        }
+    }
+
+  for (i = 0; i < retained->nodes->len; i++)
+    clutter_paint_node_add_child (root, g_ptr_array_index (retained->nodes, i));
+
+  if (retained->nodes->len > 0)
+    clutter_paint_node_paint (root, paint_context);
+
+  return TRUE;
+}
+
+static void
+clutter_actor_retain_paint_nodes (ClutterActor        *self,
+                                  ClutterPaintNode    *root,
+                                  ClutterPaintContext *paint_context)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterRetainedPaintNodes *retained;
+  ClutterPaintNode *iter;
+
+  clutter_actor_clear_retained_paint_nodes (self);
+
+  retained = g_new0 (ClutterRetainedPaintNodes, 1);
+  clutter_actor_get_retained_paint_nodes_state (self, paint_context, retained);
+  g_object_ref (retained->color_state);
+  g_object_ref (retained->target_color_state);
+
+  retained->nodes =
+    g_ptr_array_new_full (clutter_paint_node_get_n_children (root),
+                          (GDestroyNotify) clutter_paint_node_unref);
+
+  for (iter = root->first_child; iter != NULL; iter = iter->next_sibling)
+    g_ptr_array_add (retained->nodes, clutter_paint_node_ref (iter));
+
+  priv->retained_paint_nodes = retained;
+}
+
 /**
  * clutter_actor_paint:
  * @self: A #ClutterActor
@@ -3460,7 +3750,14 @@ clutter_actor_paint (ClutterActor        *self,
   g_autoptr (ClutterPaintNode) root_node = NULL;
   ClutterActorPrivate *priv;
   ClutterActorBox clip;
+  ClutterStageView *effects_view = NULL;
+  CoglFramebuffer *effects_framebuffer = NULL;
   gboolean culling_inhibited;
+  gboolean cull_success = FALSE;
+  /* annoyingly gcc warns if uninitialized even though
+   * the initialization is redundant :-( */
+  ClutterCullResult cull_result = CLUTTER_CULL_RESULT_IN;
+  gboolean paint_cull_result = FALSE;
   gboolean clip_set = FALSE;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
@@ -3500,9 +3797,39 @@ clutter_actor_paint (ClutterActor        *self,
 
   clutter_paint_context_push_color_state (paint_context, priv->color_state);
 
+  /* Cull before building any paint nodes: with several stage views, most
+   * actors are outside of most of the views they are painted for.
+   */
+  culling_inhibited = priv->inhibit_culling_counter > 0;
+  if (!culling_inhibited && !in_clone_paint ())
+    {
+      gboolean should_cull_out = (clutter_paint_debug_flags &
+                                  (CLUTTER_DEBUG_DISABLE_CULLING |
+                                   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)) !=
+                                 (CLUTTER_DEBUG_DISABLE_CULLING |
+                                  CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS);
+
+      cull_success = should_cull_out
+        ? cull_actor (self, paint_context, &cull_result)
+        : FALSE;
+
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
+        paint_cull_result = TRUE;
+      else if (cull_result == CLUTTER_CULL_RESULT_OUT && cull_success)
+        {
+          COGL_PERF_COUNTER_ADD (CulledActors, "CulledActors",
+                                 "actors culled out when painting", 1);
+          goto out;
+        }
+    }
+
   actor_node = clutter_actor_node_new (self, -1);
   root_node = clutter_paint_node_ref (actor_node);
 
+  if (G_UNLIKELY (paint_cull_result))
+    _clutter_actor_paint_cull_result (self, cull_success, cull_result,
+                                      actor_node);
+
   if (priv->has_clip)
     {
       clip.x1 = priv->clip.origin.x;
@@ -3592,28 +3919,8 @@ clutter_actor_paint (ClutterActor        *self,
    */
   add_or_remove_flatten_effect (self);
 
-  culling_inhibited = priv->inhibit_culling_counter > 0;
-  if (!culling_inhibited && !in_clone_paint ())
-    {
-      gboolean success;
-      gboolean should_cull_out = (clutter_paint_debug_flags &
-                                  (CLUTTER_DEBUG_DISABLE_CULLING |
-                                   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)) !=
-                                 (CLUTTER_DEBUG_DISABLE_CULLING |
-                                  CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS);
-      /* annoyingly gcc warns if uninitialized even though
-       * the initialization is redundant :-( */
-      ClutterCullResult result = CLUTTER_CULL_RESULT_IN;
-
-      success = should_cull_out
-        ? cull_actor (self, paint_context, &result)
-        : FALSE;
-
-      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
-        _clutter_actor_paint_cull_result (self, success, result, actor_node);
-      else if (result == CLUTTER_CULL_RESULT_OUT && success)
-        goto out;
-    }
+  COGL_PERF_COUNTER_ADD (PaintedActors, "PaintedActors",
+                         "actors painted", 1);
 
   if (priv->effects == NULL)
     priv->next_effect_to_paint = NULL;
@@ -3624,8 +3931,25 @@ clutter_actor_paint (ClutterActor        *self,
   if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES))
     _clutter_actor_draw_paint_volume (self, actor_node);
 
+  if (priv->next_effect_to_paint)
+    {
+      effects_view = clutter_paint_context_get_stage_view (paint_context);
+      effects_framebuffer =
+        clutter_paint_context_get_framebuffer (paint_context);
+    }
+
+  if (effects_view)
+    clutter_stage_view_begin_gpu_phase (effects_view,
+                                        CLUTTER_GPU_PHASE_EFFECTS,
+                                        effects_framebuffer);
+
   clutter_paint_node_paint (root_node, paint_context);
 
+  if (effects_view)
+    clutter_stage_view_end_gpu_phase (effects_view,
+                                      CLUTTER_GPU_PHASE_EFFECTS,
+                                      effects_framebuffer);
+
   /* If we make it here then the actor has run through a complete
    * paint run including all the effects so it's no longer dirty,
    * unless a new redraw was queued up.
@@ -3680,10 +4004,19 @@ clutter_actor_continue_paint (ClutterActor        *self,
       dummy = _clutter_dummy_node_new (self, framebuffer);
       clutter_paint_node_set_static_name (dummy, "Root");
 
-      /* XXX - for 1.12, we use the return value of paint_node() to
-       * decide whether we should call the paint() vfunc.
-       */
-      clutter_actor_paint_node (self, dummy, paint_context);
+      if (!clutter_actor_can_retain_paint_nodes (self))
+        {
+          /* XXX - for 1.12, we use the return value of paint_node() to
+           * decide whether we should call the paint() vfunc.
+           */
+          clutter_actor_paint_node (self, dummy, paint_context);
+        }
+      else if (!clutter_actor_replay_retained_paint_nodes (self, dummy,
+                                                           paint_context))
+        {
+          clutter_actor_paint_node (self, dummy, paint_context);
+          clutter_actor_retain_paint_nodes (self, dummy, paint_context);
+        }
 
       CLUTTER_ACTOR_GET_CLASS (self)->paint (self, paint_context);
     }
@@ -3765,6 +4098,8 @@ clutter_actor_pick (ClutterActor       *actor,
   /* mark that we are in the paint process */
   CLUTTER_SET_PRIVATE_FLAGS (actor, CLUTTER_IN_PICK);
 
+  clutter_pick_context_begin_actor (pick_context, actor);
+
   if (should_cull && priv->has_paint_volume && priv->visible_paint_volume_valid)
     {
       graphene_box_t box;
@@ -3826,6 +4161,8 @@ clutter_actor_pick (ClutterActor       *actor,
     clutter_pick_context_pop_transform (pick_context);
 
 out:
+  clutter_pick_context_end_actor (pick_context);
+
   /* paint sequence complete */
   CLUTTER_UNSET_PRIVATE_FLAGS (actor, CLUTTER_IN_PICK);
 }
@@ -5373,6 +5710,8 @@ clutter_actor_dispose (GObject *object)
   g_clear_object (&priv->effects);
   g_clear_object (&priv->flatten_effect);
 
+  clutter_actor_clear_retained_paint_nodes (self);
+
   if (priv->child_model != NULL)
     {
       if (priv->create_child_notify != NULL)
@@ -5481,6 +5820,27 @@ clutter_actor_real_get_accessible (ClutterActor *actor)
   return priv->accessible;
 }
 
+/*
+ * clutter_actor_peek_accessible:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the accessible object of @self if it was already created,
+ * so that notifying assistive technologies about changes does not
+ * create accessibles nobody asked for. Actors with a custom
+ * get_accessible implementation always have theirs returned.
+ *
+ * Returns: (transfer none) (nullable): the accessible object of @self
+ */
+AtkObject *
+clutter_actor_peek_accessible (ClutterActor *self)
+{
+  if (CLUTTER_ACTOR_GET_CLASS (self)->get_accessible !=
+      clutter_actor_real_get_accessible)
+    return clutter_actor_get_accessible (self);
+
+  return self->priv->accessible;
+}
+
 static AtkObject *
 _clutter_actor_ref_accessible (AtkImplementor *implementor)
 {
@@ -7568,6 +7928,31 @@ clutter_actor_destroy (ClutterActor *self)
   g_object_unref (self);
 }
 
+static void
+schedule_update_for_redraw (ClutterActor *self,
+                            ClutterStage *stage)
+{
+  ClutterActorPrivate *priv = self->priv;
+  GList *l;
+
+  /* Only wake up the views the actor is known to be on, so that an actor
+   * animating on one monitor doesn't cause updates of all the others.
+   * Views the redraw clip ends up on otherwise are scheduled when the
+   * clip is added in clutter_actor_finish_layout().
+   */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) ||
+      priv->needs_update_stage_views ||
+      priv->stage_views == NULL ||
+      !clutter_actor_is_mapped (self))
+    {
+      clutter_stage_schedule_update (stage);
+      return;
+    }
+
+  for (l = priv->stage_views; l; l = l->next)
+    clutter_stage_view_schedule_update (l->data);
+}
+
 void
 _clutter_actor_queue_redraw_full (ClutterActor             *self,
                                   const ClutterPaintVolume *volume,
@@ -7576,6 +7961,14 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *stage;
 
+  /* A redraw queued from an effect only invalidates the output of
+   * that effect, the actor itself didn't change. Drop the retained
+   * paint nodes before the early returns below, so that changes made
+   * while unmapped aren't lost.
+   */
+  if (effect == NULL)
+    clutter_actor_clear_retained_paint_nodes (self);
+
   /* ignore queueing a redraw for actors being destroyed */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
@@ -7610,6 +8003,8 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
     return;
 
+  clutter_stage_invalidate_pick (CLUTTER_STAGE (stage), self);
+
   if (priv->needs_redraw && priv->next_redraw_clips->len == 0)
     {
       /* priv->needs_redraw is TRUE while priv->next_redraw_clips->len is 0, this
@@ -7624,7 +8019,7 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
 
           priv->needs_redraw = TRUE;
 
-          clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+          schedule_update_for_redraw (self, CLUTTER_STAGE (stage));
 
           while (iter && !iter->priv->needs_finish_layout)
             {
@@ -7712,6 +8107,29 @@ clutter_actor_queue_redraw (ClutterActor *self)
                                     NULL /* effect */);
 }
 
+/**
+ * clutter_actor_invalidate_pick:
+ * @self: A #ClutterActor
+ *
+ * Notifies the stage that the way @self or any of its children picks
+ * changed, without queueing a redraw. This is only needed when such state
+ * changes without affecting painting, e.g. when changing an input region.
+ */
+void
+clutter_actor_invalidate_pick (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  if (!clutter_actor_is_mapped (self))
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage)
+    clutter_stage_invalidate_pick (CLUTTER_STAGE (stage), self);
+}
+
 static void
 _clutter_actor_queue_relayout_on_clones (ClutterActor *self)
 {
@@ -7735,6 +8153,8 @@ _clutter_actor_queue_only_relayout (ClutterActor *self)
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
 
+  priv->relayout_serial++;
+
   if (priv->needs_width_request &&
       priv->needs_height_request &&
       priv->needs_allocation)
@@ -10410,6 +10830,59 @@ clutter_actor_get_offscreen_redirect (ClutterActor *self)
   return self->priv->offscreen_redirect;
 }
 
+/**
+ * clutter_actor_set_retain_paint_nodes:
+ * @self: a #ClutterActor
+ * @retain: whether to retain the paint nodes of @self
+ *
+ * Sets whether the paint nodes built by @self itself, that is, its
+ * background color, its [iface@Clutter.Content] and its
+ * [vfunc@Clutter.Actor.paint_node] implementation, should be retained
+ * between paints.
+ *
+ * Retained paint nodes are replayed instead of being built again,
+ * until a redraw is queued on @self, or it is painted with a different
+ * transformation, size, opacity or color state. This is only correct
+ * for actors that queue a redraw whenever anything their paint nodes
+ * depend on changes, which makes it a good fit for static user
+ * interface chrome. Painting of the children is not affected.
+ */
+void
+clutter_actor_set_retain_paint_nodes (ClutterActor *self,
+                                      gboolean      retain)
+{
+  ClutterActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  if (priv->retain_paint_nodes == !!retain)
+    return;
+
+  priv->retain_paint_nodes = !!retain;
+
+  if (!priv->retain_paint_nodes)
+    clutter_actor_clear_retained_paint_nodes (self);
+}
+
+/**
+ * clutter_actor_get_retain_paint_nodes:
+ * @self: a #ClutterActor
+ *
+ * Retrieves whether @self retains its paint nodes between paints, as
+ * set by clutter_actor_set_retain_paint_nodes().
+ *
+ * Return value: %TRUE if the paint nodes of @self are retained
+ */
+gboolean
+clutter_actor_get_retain_paint_nodes (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  return self->priv->retain_paint_nodes;
+}
+
 /**
  * clutter_actor_set_name:
  * @self: A #ClutterActor
@@ -11892,11 +12365,13 @@ clutter_actor_set_reactive (ClutterActor *actor,
 
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 
-  accessible = clutter_actor_get_accessible (actor);
+  clutter_actor_invalidate_pick (actor);
+
+  accessible = clutter_actor_peek_accessible (actor);
   if (accessible)
-    atk_object_notify_state_change (accessible,
-                                    ATK_STATE_SENSITIVE,
-                                    reactive);
+    clutter_actor_accessible_queue_state_change (accessible,
+                                                 ATK_STATE_SENSITIVE,
+                                                 reactive);
 
   if (!clutter_actor_get_reactive (actor) && priv->n_pointers > 0)
     {
@@ -12393,6 +12868,61 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
   clutter_actor_update_devices (actor);
 }
 
+/*< private >
+ * clutter_actor_find_direct_animatable_property:
+ * @actor: a #ClutterActor
+ * @property_name: the name of the animated property
+ *
+ * Looks up an animatable property of #ClutterActor itself that can be set
+ * with clutter_actor_set_animated_property() while it is being animated,
+ * bypassing the #ClutterAnimatable interface. This is not possible for
+ * properties of layout managers, content and actor metas, or for actor
+ * classes overriding how animated values are computed or applied.
+ *
+ * Returns: (nullable): the #GParamSpec of the property
+ */
+GParamSpec *
+clutter_actor_find_direct_animatable_property (ClutterActor *actor,
+                                               const char   *property_name)
+{
+  ClutterAnimatableInterface *iface = CLUTTER_ANIMATABLE_GET_IFACE (actor);
+  GParamSpec *pspec;
+
+  if (iface->set_final_state != clutter_actor_set_final_state ||
+      iface->interpolate_value != NULL)
+    return NULL;
+
+  if (property_name[0] == '@')
+    return NULL;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (actor),
+                                        property_name);
+  if (!pspec ||
+      pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      !(pspec->flags & CLUTTER_PARAM_ANIMATABLE))
+    return NULL;
+
+  return pspec;
+}
+
+/*< private >
+ * clutter_actor_set_animated_property:
+ * @actor: a #ClutterActor
+ * @pspec: a #GParamSpec from clutter_actor_find_direct_animatable_property()
+ * @value: the new value
+ *
+ * Sets a new value of an animated property, like
+ * clutter_animatable_set_final_state() would.
+ */
+void
+clutter_actor_set_animated_property (ClutterActor *actor,
+                                     GParamSpec   *pspec,
+                                     const GValue *value)
+{
+  clutter_actor_set_animatable_property (actor, pspec->param_id, value, pspec);
+  clutter_actor_update_devices (actor);
+}
+
 static ClutterActor *
 clutter_actor_get_actor (ClutterAnimatable *animatable)
 {
@@ -14549,12 +15079,17 @@ gboolean
 clutter_actor_get_paint_box (ClutterActor    *self,
                              ClutterActorBox *box)
 {
+  ClutterActorPrivate *priv;
   ClutterActor *stage;
   ClutterPaintVolume *pv;
+  int64_t frame_counter;
+  gboolean cacheable;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
   g_return_val_if_fail (box != NULL, FALSE);
 
+  priv = self->priv;
+
   stage = _clutter_actor_get_stage_internal (self);
   if (G_UNLIKELY (!stage))
     return FALSE;
@@ -14563,8 +15098,28 @@ clutter_actor_get_paint_box (ClutterActor    *self,
   if (G_UNLIKELY (!pv))
     return FALSE;
 
+  /* Paint volumes overridden by effects can change from call to call */
+  cacheable = (priv->current_effect == NULL &&
+               !priv->had_effects_on_last_paint_volume_update);
+  frame_counter = clutter_stage_get_frame_counter (CLUTTER_STAGE (stage));
+
+  if (cacheable &&
+      priv->paint_box_valid &&
+      priv->paint_box_frame_counter == frame_counter)
+    {
+      *box = priv->paint_box;
+      return TRUE;
+    }
+
   _clutter_paint_volume_get_stage_paint_box (pv, CLUTTER_STAGE (stage), box);
 
+  if (cacheable)
+    {
+      priv->paint_box = *box;
+      priv->paint_box_frame_counter = frame_counter;
+      priv->paint_box_valid = TRUE;
+    }
+
   return TRUE;
 }
 
@@ -14733,7 +15288,7 @@ add_actor_to_redraw_clip (ClutterActor       *self,
       unsigned int i;
 
       for (i = 0; i < priv->next_redraw_clips->len; i++)
-        clutter_stage_add_to_redraw_clip (stage, &g_array_index (priv->next_redraw_clips, ClutterPaintVolume, i));
+        clutter_stage_add_to_redraw_clip (stage, self, &g_array_index (priv->next_redraw_clips, ClutterPaintVolume, i));
 
       priv->next_redraw_clips->len = 0;
     }
@@ -14745,21 +15300,21 @@ add_actor_to_redraw_clip (ClutterActor       *self,
       if (old_visible_paint_volume == NULL || !priv->visible_paint_volume_valid)
         goto full_stage_redraw;
 
-      clutter_stage_add_to_redraw_clip (stage, old_visible_paint_volume);
-      clutter_stage_add_to_redraw_clip (stage, &priv->visible_paint_volume);
+      clutter_stage_add_to_redraw_clip (stage, self, old_visible_paint_volume);
+      clutter_stage_add_to_redraw_clip (stage, self, &priv->visible_paint_volume);
     }
   else
     {
       if (!priv->visible_paint_volume_valid)
         goto full_stage_redraw;
 
-      clutter_stage_add_to_redraw_clip (stage, &priv->visible_paint_volume);
+      clutter_stage_add_to_redraw_clip (stage, self, &priv->visible_paint_volume);
     }
 
   return;
 
 full_stage_redraw:
-  clutter_stage_add_to_redraw_clip (stage, NULL);
+  clutter_stage_add_to_redraw_clip (stage, self, NULL);
 }
 
 static gboolean
@@ -17186,6 +17741,43 @@ clutter_actor_get_content (ClutterActor *self)
   return self->priv->content;
 }
 
+/*
+ * clutter_actor_get_sole_content:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the content of @self if painting it fills the allocation
+ * and is all there is to painting @self, i.e. when @self has no
+ * children, effects, clip, background color or custom paint code.
+ *
+ * Return value: (transfer none) (nullable): the #ClutterContent of @self,
+ *   or %NULL
+ */
+ClutterContent *
+clutter_actor_get_sole_content (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  if (priv->content == NULL)
+    return NULL;
+
+  if (priv->n_children > 0 ||
+      priv->effects != NULL ||
+      priv->has_clip ||
+      priv->clip_to_allocation ||
+      priv->bg_color_set)
+    return NULL;
+
+  if (priv->content_gravity != CLUTTER_CONTENT_GRAVITY_RESIZE_FILL)
+    return NULL;
+
+  if (klass->paint != clutter_actor_real_paint ||
+      klass->paint_node != NULL)
+    return NULL;
+
+  return priv->content;
+}
+
 /**
  * clutter_actor_set_content_gravity:
  * @self: a #ClutterActor
@@ -18711,7 +19303,7 @@ clutter_actor_set_accessible_name (ClutterActor *self,
   if (g_strcmp0 (name, priv->accessible_name) == 0)
     return;
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   g_set_str (&priv->accessible_name, name);
 
   if (accessible)
@@ -18771,7 +19363,7 @@ clutter_actor_set_accessible_role (ClutterActor *self,
   if (self->accessible_role == role)
     return;
 
-  accessible = clutter_actor_get_accessible (self);
+  accessible = clutter_actor_peek_accessible (self);
   self->accessible_role = role;
 
   if (accessible)
@@ -29,14 +29,23 @@
  *
  * #ClutterBlurEffect is a sub-class of #ClutterEffect that allows blurring a
  * actor and its contents.
+ *
+ * By default a small, fixed size box blur is applied. Setting
+ * [property@BlurEffect:radius] blurs using #ClutterBlurNode instead, with the
+ * algorithm chosen by [property@BlurEffect:mode].
  */
 #include "config.h"
 
+#include <math.h>
+
 #include "clutter/clutter-blur-effect.h"
 
 #include "cogl/cogl.h"
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
+#include "clutter/clutter-enum-types.h"
+#include "clutter/clutter-paint-nodes.h"
 #include "clutter/clutter-private.h"
 
 #define BLUR_PADDING    2
@@ -70,8 +79,24 @@ typedef struct _ClutterBlurEffectPrivate
   gint pixel_step_uniform;
 
   CoglPipeline *pipeline;
+
+  /* used instead of the box blur when radius is set */
+  CoglPipeline *texture_pipeline;
+  float radius;
+  ClutterBlurMode mode;
 } ClutterBlurEffectPrivate;
 
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+  PROP_MODE,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterBlurEffect,
                             clutter_blur_effect,
@@ -104,25 +129,98 @@ clutter_blur_effect_create_pipeline (ClutterOffscreenEffect *effect,
     }
 
   cogl_pipeline_set_layer_texture (priv->pipeline, 0, texture);
+  cogl_pipeline_set_layer_texture (priv->texture_pipeline, 0, texture);
 
   return g_object_ref (priv->pipeline);
 }
 
+static void
+clutter_blur_effect_paint_target (ClutterOffscreenEffect *effect,
+                                  ClutterPaintNode       *node,
+                                  ClutterPaintContext    *paint_context)
+{
+  ClutterBlurEffect *blur_effect = CLUTTER_BLUR_EFFECT (effect);
+  ClutterBlurEffectPrivate *priv =
+    clutter_blur_effect_get_instance_private (blur_effect);
+  g_autoptr (ClutterPaintNode) blur_node = NULL;
+  g_autoptr (ClutterPaintNode) pipeline_node = NULL;
+  ClutterActor *actor;
+  CoglTexture *texture;
+  float paint_opacity;
+  float resource_scale;
+  CoglColor color;
+  int width, height;
+
+  if (priv->radius <= 0.0f)
+    {
+      CLUTTER_OFFSCREEN_EFFECT_CLASS (clutter_blur_effect_parent_class)->paint_target (effect,
+                                                                                       node,
+                                                                                       paint_context);
+      return;
+    }
+
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  texture = clutter_offscreen_effect_get_texture (effect);
+  width = cogl_texture_get_width (texture);
+  height = cogl_texture_get_height (texture);
+
+  /* The offscreen texture is rendered at the ceiled resource scale, see
+   * clutter_offscreen_effect_pre_paint().
+   */
+  resource_scale = ceilf (clutter_actor_get_real_resource_scale (actor));
+
+  blur_node = clutter_blur_node_new_with_mode (width, height,
+                                               priv->radius * resource_scale,
+                                               priv->mode);
+  clutter_paint_node_set_static_name (blur_node, "ClutterBlurEffect (blur)");
+  clutter_paint_node_add_child (node, blur_node);
+  clutter_paint_node_add_rectangle (blur_node,
+                                    &(ClutterActorBox) {
+                                      0.f, 0.f,
+                                      width, height,
+                                    });
+
+  paint_opacity = clutter_actor_get_paint_opacity (actor) / 255.0f;
+  cogl_color_init_from_4f (&color,
+                           paint_opacity, paint_opacity,
+                           paint_opacity, paint_opacity);
+  cogl_pipeline_set_color (priv->texture_pipeline, &color);
+
+  pipeline_node = clutter_pipeline_node_new (priv->texture_pipeline);
+  clutter_paint_node_set_static_name (pipeline_node,
+                                      "ClutterBlurEffect (source)");
+  clutter_paint_node_add_child (blur_node, pipeline_node);
+  clutter_paint_node_add_rectangle (pipeline_node,
+                                    &(ClutterActorBox) {
+                                      0.f, 0.f,
+                                      width, height,
+                                    });
+}
+
 static gboolean
 clutter_blur_effect_modify_paint_volume (ClutterEffect      *effect,
                                          ClutterPaintVolume *volume)
 {
+  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
+  ClutterBlurEffectPrivate *priv =
+    clutter_blur_effect_get_instance_private (self);
   gfloat cur_width, cur_height;
   graphene_point3d_t origin;
+  float padding;
+
+  if (priv->radius > 0.0f)
+    padding = ceilf (priv->radius);
+  else
+    padding = BLUR_PADDING;
 
   clutter_paint_volume_get_origin (volume, &origin);
   cur_width = clutter_paint_volume_get_width (volume);
   cur_height = clutter_paint_volume_get_height (volume);
 
-  origin.x -= BLUR_PADDING;
-  origin.y -= BLUR_PADDING;
-  cur_width += 2 * BLUR_PADDING;
-  cur_height += 2 * BLUR_PADDING;
+  origin.x -= padding;
+  origin.y -= padding;
+  cur_width += 2 * padding;
+  cur_height += 2 * padding;
   clutter_paint_volume_set_origin (volume, &origin);
   clutter_paint_volume_set_width (volume, cur_width);
   clutter_paint_volume_set_height (volume, cur_height);
@@ -138,10 +236,61 @@ clutter_blur_effect_dispose (GObject *gobject)
     clutter_blur_effect_get_instance_private (self);
 
   g_clear_object (&priv->pipeline);
+  g_clear_object (&priv->texture_pipeline);
 
   G_OBJECT_CLASS (clutter_blur_effect_parent_class)->dispose (gobject);
 }
 
+static void
+clutter_blur_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      clutter_blur_effect_set_radius (effect, g_value_get_float (value));
+      break;
+
+    case PROP_MODE:
+      clutter_blur_effect_set_mode (effect, g_value_get_enum (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_blur_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+  ClutterBlurEffectPrivate *priv =
+    clutter_blur_effect_get_instance_private (effect);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_float (value, priv->radius);
+      break;
+
+    case PROP_MODE:
+      g_value_set_enum (value, priv->mode);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
 {
@@ -150,11 +299,44 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
   ClutterOffscreenEffectClass *offscreen_class;
 
   gobject_class->dispose = clutter_blur_effect_dispose;
+  gobject_class->set_property = clutter_blur_effect_set_property;
+  gobject_class->get_property = clutter_blur_effect_get_property;
 
   effect_class->modify_paint_volume = clutter_blur_effect_modify_paint_volume;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->create_pipeline = clutter_blur_effect_create_pipeline;
+  offscreen_class->paint_target = clutter_blur_effect_paint_target;
+
+  /**
+   * ClutterBlurEffect:radius:
+   *
+   * The blur radius, in logical pixels. When 0, a small box blur is
+   * applied instead.
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_float ("radius", NULL, NULL,
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_STATIC_STRINGS |
+                        G_PARAM_EXPLICIT_NOTIFY);
+
+  /**
+   * ClutterBlurEffect:mode:
+   *
+   * The algorithm used to blur when [property@BlurEffect:radius] is set.
+   * %CLUTTER_BLUR_MODE_DUAL_KAWASE is considerably cheaper at large radii.
+   */
+  obj_props[PROP_MODE] =
+    g_param_spec_enum ("mode", NULL, NULL,
+                       CLUTTER_TYPE_BLUR_MODE,
+                       CLUTTER_BLUR_MODE_GAUSSIAN,
+                       G_PARAM_READWRITE |
+                       G_PARAM_STATIC_STRINGS |
+                       G_PARAM_EXPLICIT_NOTIFY);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
 static void
@@ -163,12 +345,12 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
   ClutterBlurEffectClass *klass = CLUTTER_BLUR_EFFECT_GET_CLASS (self);
   ClutterBlurEffectPrivate *priv =
     clutter_blur_effect_get_instance_private (self);
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
 
   if (G_UNLIKELY (klass->base_pipeline == NULL))
     {
       CoglSnippet *snippet;
-      CoglContext *ctx =
-        clutter_backend_get_cogl_context (clutter_get_default_backend ());
 
       klass->base_pipeline = cogl_pipeline_new (ctx);
       cogl_pipeline_set_static_name (klass->base_pipeline,
@@ -188,6 +370,14 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
 
   priv->pixel_step_uniform =
     cogl_pipeline_get_uniform_location (priv->pipeline, "pixel_step");
+
+  priv->texture_pipeline =
+    cogl_pipeline_new (ctx);
+  cogl_pipeline_set_static_name (priv->texture_pipeline,
+                                 "ClutterBlurEffect (source)");
+  cogl_pipeline_set_layer_null_texture (priv->texture_pipeline, 0);
+
+  priv->mode = CLUTTER_BLUR_MODE_GAUSSIAN;
 }
 
 /**
@@ -203,3 +393,95 @@ clutter_blur_effect_new (void)
 {
   return g_object_new (CLUTTER_TYPE_BLUR_EFFECT, NULL);
 }
+
+/**
+ * clutter_blur_effect_set_radius:
+ * @effect: a #ClutterBlurEffect
+ * @radius: the blur radius, in logical pixels
+ *
+ * Sets the blur radius of @effect. A radius of 0 uses the default box blur.
+ */
+void
+clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                float              radius)
+{
+  ClutterBlurEffectPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+  g_return_if_fail (radius >= 0.0f);
+
+  priv = clutter_blur_effect_get_instance_private (effect);
+  if (G_APPROX_VALUE (priv->radius, radius, FLT_EPSILON))
+    return;
+
+  priv->radius = radius;
+
+  clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+}
+
+/**
+ * clutter_blur_effect_get_radius:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the blur radius of @effect.
+ *
+ * Return value: the blur radius
+ */
+float
+clutter_blur_effect_get_radius (ClutterBlurEffect *effect)
+{
+  ClutterBlurEffectPrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect), 0.0f);
+
+  priv = clutter_blur_effect_get_instance_private (effect);
+  return priv->radius;
+}
+
+/**
+ * clutter_blur_effect_set_mode:
+ * @effect: a #ClutterBlurEffect
+ * @mode: the blur algorithm
+ *
+ * Sets the algorithm used by @effect when a blur radius is set.
+ */
+void
+clutter_blur_effect_set_mode (ClutterBlurEffect *effect,
+                              ClutterBlurMode    mode)
+{
+  ClutterBlurEffectPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+
+  priv = clutter_blur_effect_get_instance_private (effect);
+  if (priv->mode == mode)
+    return;
+
+  priv->mode = mode;
+
+  clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_MODE]);
+}
+
+/**
+ * clutter_blur_effect_get_mode:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the blur algorithm of @effect.
+ *
+ * Return value: the blur algorithm
+ */
+ClutterBlurMode
+clutter_blur_effect_get_mode (ClutterBlurEffect *effect)
+{
+  ClutterBlurEffectPrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect),
+                        CLUTTER_BLUR_MODE_GAUSSIAN);
+
+  priv = clutter_blur_effect_get_instance_private (effect);
+  return priv->mode;
+}
@@ -51,4 +51,18 @@ struct _ClutterBlurEffectClass
 CLUTTER_EXPORT
 ClutterEffect *clutter_blur_effect_new (void);
 
+CLUTTER_EXPORT
+void clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                     float              radius);
+
+CLUTTER_EXPORT
+float clutter_blur_effect_get_radius (ClutterBlurEffect *effect);
+
+CLUTTER_EXPORT
+void clutter_blur_effect_set_mode (ClutterBlurEffect *effect,
+                                   ClutterBlurMode    mode);
+
+CLUTTER_EXPORT
+ClutterBlurMode clutter_blur_effect_get_mode (ClutterBlurEffect *effect);
+
 G_END_DECLS
@@ -19,19 +19,33 @@
 
 #include <glib-object.h>
 
+#include "clutter/clutter-enums.h"
+#include "clutter/clutter-macros.h"
 #include "cogl/cogl.h"
 
 G_BEGIN_DECLS
 
 typedef struct _ClutterBlur ClutterBlur;
 
+CLUTTER_EXPORT
 ClutterBlur * clutter_blur_new (CoglTexture *texture,
                                 float        radius);
 
+CLUTTER_EXPORT
+ClutterBlur * clutter_blur_new_with_mode (CoglTexture     *texture,
+                                          float            radius,
+                                          ClutterBlurMode  mode);
+
+CLUTTER_EXPORT
 void clutter_blur_apply (ClutterBlur *blur);
 
+CLUTTER_EXPORT
+int64_t clutter_blur_estimate_fetches (ClutterBlur *blur);
+
+CLUTTER_EXPORT
 CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
 
+CLUTTER_EXPORT
 void clutter_blur_free (ClutterBlur *blur);
 
 G_END_DECLS
@@ -20,6 +20,7 @@
 #include "clutter/clutter-blur-private.h"
 
 #include "clutter/clutter-backend.h"
+#include "clutter/clutter-debug.h"
 
 /**
  * ClutterBlur:
@@ -67,6 +68,15 @@
  *
  * https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch40.html
  *
+ * # Dual Kawase
+ *
+ * With %CLUTTER_BLUR_MODE_DUAL_KAWASE, the gaussian passes are replaced by a
+ * chain of downsampling passes, each halving the texture size, followed by
+ * the same number of upsampling passes back to the original size. Each pass
+ * only takes 5 (down) or 8 (up) samples, so the cost barely grows with the
+ * blur radius, at the expense of a blur that is only approximately gaussian.
+ * This is the technique presented by M. Bjørge in "Bandwidth-Efficient
+ * Rendering" at SIGGRAPH 2015.
  */
 
 static const char *gaussian_blur_glsl_declarations =
@@ -108,15 +118,55 @@ static const char *gaussian_blur_glsl =
 "                                                                          \n"
 "  cogl_texel = ret / gauss_coefficient_total;                             \n";
 
+static const char *dual_kawase_glsl_declarations =
+"uniform vec2 half_pixel;                                                  \n"
+"uniform float offset;                                                     \n";
+
+static const char *dual_kawase_down_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 step = half_pixel * offset;                                        \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv) * 4.0;                          \n"
+"  ret += texture2D (cogl_sampler, uv - step);                             \n"
+"  ret += texture2D (cogl_sampler, uv + step);                             \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x, -step.y));           \n"
+"  ret += texture2D (cogl_sampler, uv - vec2 (step.x, -step.y));           \n"
+"                                                                          \n"
+"  cogl_texel = ret / 8.0;                                                 \n";
+
+static const char *dual_kawase_up_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 step = half_pixel * offset;                                        \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv + vec2 (-step.x * 2.0, 0.0));    \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (-step.x, step.y)) * 2.0;     \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, step.y * 2.0));         \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x, step.y)) * 2.0;      \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x * 2.0, 0.0));         \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x, -step.y)) * 2.0;     \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, -step.y * 2.0));        \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (-step.x, -step.y)) * 2.0;    \n"
+"                                                                          \n"
+"  cogl_texel = ret / 12.0;                                                \n";
+
 #define MIN_DOWNSCALE_SIZE 256.f
 #define MAX_SIGMA 6.f
 
+#define DUAL_KAWASE_MAX_ITERATIONS 6
+#define DUAL_KAWASE_MIN_SIZE 8
+
 enum
 {
   VERTICAL,
   HORIZONTAL,
 };
 
+typedef enum
+{
+  KAWASE_DOWN,
+  KAWASE_UP,
+} KawaseDirection;
+
 typedef struct
 {
   CoglFramebuffer *framebuffer;
@@ -127,11 +177,19 @@ typedef struct
 
 struct _ClutterBlur
 {
+  ClutterBlurMode mode;
   CoglTexture *source_texture;
   float sigma;
   float downscale_factor;
 
   BlurPass pass[2];
+
+  /* Dual Kawase: n_iterations downsampling passes followed by as many
+   * upsampling passes.
+   */
+  BlurPass kawase_pass[2 * DUAL_KAWASE_MAX_ITERATIONS];
+  int n_iterations;
+  float offset;
 };
 
 static CoglPipeline*
@@ -171,6 +229,55 @@ create_blur_pipeline (CoglContext *ctx)
   return cogl_pipeline_copy (blur_pipeline);
 }
 
+static CoglPipeline *
+create_kawase_pipeline (CoglContext     *ctx,
+                        KawaseDirection  direction)
+{
+  static CoglPipelineKey kawase_pipeline_keys[] = {
+    [KAWASE_DOWN] = "clutter-blur-kawase-down-pipeline-private",
+    [KAWASE_UP] = "clutter-blur-kawase-up-pipeline-private",
+  };
+  CoglPipeline *kawase_pipeline;
+
+  kawase_pipeline =
+    cogl_context_get_named_pipeline (ctx, &kawase_pipeline_keys[direction]);
+
+  if (G_UNLIKELY (kawase_pipeline == NULL))
+    {
+      CoglSnippet *snippet;
+
+      kawase_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_static_name (kawase_pipeline,
+                                     direction == KAWASE_DOWN ?
+                                     "ClutterBlur (dual kawase down)" :
+                                     "ClutterBlur (dual kawase up)");
+      cogl_pipeline_set_layer_null_texture (kawase_pipeline, 0);
+      cogl_pipeline_set_layer_filters (kawase_pipeline,
+                                       0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (kawase_pipeline,
+                                         0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                  dual_kawase_glsl_declarations,
+                                  NULL);
+      cogl_snippet_set_replace (snippet,
+                                direction == KAWASE_DOWN ?
+                                dual_kawase_down_glsl :
+                                dual_kawase_up_glsl);
+      cogl_pipeline_add_layer_snippet (kawase_pipeline, 0, snippet);
+      g_object_unref (snippet);
+
+      cogl_context_set_named_pipeline (ctx,
+                                       &kawase_pipeline_keys[direction],
+                                       kawase_pipeline);
+    }
+
+  return cogl_pipeline_copy (kawase_pipeline);
+}
+
 static void
 update_blur_uniforms (ClutterBlur *blur,
                       BlurPass    *pass)
@@ -222,26 +329,15 @@ update_blur_uniforms (ClutterBlur *blur,
 }
 
 static gboolean
-create_fbo (ClutterBlur *blur,
-            CoglContext *ctx,
-            BlurPass    *pass)
+create_fbo (CoglContext *ctx,
+            BlurPass    *pass,
+            int          width,
+            int          height)
 {
-  float scaled_height;
-  float scaled_width;
-  float height;
-  float width;
-
   g_clear_object (&pass->texture);
   g_clear_object (&pass->framebuffer);
 
-  width = cogl_texture_get_width (blur->source_texture);
-  height = cogl_texture_get_height (blur->source_texture);
-  scaled_width = floorf (width / blur->downscale_factor);
-  scaled_height = floorf (height / blur->downscale_factor);
-
-  pass->texture = cogl_texture_2d_new_with_size (ctx,
-                                                 (int) scaled_width,
-                                                 (int) scaled_height);
+  pass->texture = cogl_texture_2d_new_with_size (ctx, width, height);
   if (!pass->texture)
     return FALSE;
 
@@ -255,8 +351,8 @@ create_fbo (ClutterBlur *blur,
 
   cogl_framebuffer_orthographic (pass->framebuffer,
                                  0.0, 0.0,
-                                 scaled_width,
-                                 scaled_height,
+                                 width,
+                                 height,
                                  0.0, 1.0);
   return TRUE;
 }
@@ -268,17 +364,121 @@ setup_blur_pass (ClutterBlur *blur,
                  CoglTexture *texture)
 {
   CoglContext *context = cogl_texture_get_context (texture);
+  float width = cogl_texture_get_width (blur->source_texture);
+  float height = cogl_texture_get_height (blur->source_texture);
+
   pass->orientation = orientation;
   pass->pipeline = create_blur_pipeline (context);
   cogl_pipeline_set_layer_texture (pass->pipeline, 0, texture);
 
-  if (!create_fbo (blur, context, pass))
+  if (!create_fbo (context, pass,
+                   (int) floorf (width / blur->downscale_factor),
+                   (int) floorf (height / blur->downscale_factor)))
     return FALSE;
 
   update_blur_uniforms (blur, pass);
   return TRUE;
 }
 
+static gboolean
+setup_kawase_pass (ClutterBlur     *blur,
+                   BlurPass        *pass,
+                   KawaseDirection  direction,
+                   CoglTexture     *texture,
+                   int              width,
+                   int              height)
+{
+  CoglContext *context = cogl_texture_get_context (texture);
+  int half_pixel_uniform;
+  int offset_uniform;
+
+  pass->pipeline = create_kawase_pipeline (context, direction);
+  cogl_pipeline_set_layer_texture (pass->pipeline, 0, texture);
+
+  if (!create_fbo (context, pass, width, height))
+    return FALSE;
+
+  half_pixel_uniform =
+    cogl_pipeline_get_uniform_location (pass->pipeline, "half_pixel");
+  if (half_pixel_uniform > -1)
+    {
+      float half_pixel[2] = {
+        0.5f / cogl_texture_get_width (texture),
+        0.5f / cogl_texture_get_height (texture),
+      };
+
+      cogl_pipeline_set_uniform_float (pass->pipeline,
+                                       half_pixel_uniform,
+                                       2, 1,
+                                       half_pixel);
+    }
+
+  offset_uniform =
+    cogl_pipeline_get_uniform_location (pass->pipeline, "offset");
+  if (offset_uniform > -1)
+    cogl_pipeline_set_uniform_1f (pass->pipeline, offset_uniform, blur->offset);
+
+  return TRUE;
+}
+
+static void
+calculate_kawase_parameters (ClutterBlur *blur,
+                             int          width,
+                             int          height)
+{
+  int n_iterations = 1;
+
+  /* Every iteration roughly doubles the reach of the blur; pick the number
+   * of iterations that gets closest to the radius, and make up for the
+   * rest with the sampling offset.
+   */
+  while (n_iterations < DUAL_KAWASE_MAX_ITERATIONS &&
+         (1 << (n_iterations + 1)) <= blur->sigma * 2.0f &&
+         (width >> (n_iterations + 1)) >= DUAL_KAWASE_MIN_SIZE &&
+         (height >> (n_iterations + 1)) >= DUAL_KAWASE_MIN_SIZE)
+    n_iterations++;
+
+  blur->n_iterations = n_iterations;
+  blur->offset = MAX (1.0f, blur->sigma * 2.0f / (1 << (n_iterations + 1)));
+}
+
+static gboolean
+setup_kawase_passes (ClutterBlur *blur)
+{
+  CoglTexture *texture = blur->source_texture;
+  int width = cogl_texture_get_width (texture);
+  int height = cogl_texture_get_height (texture);
+  int i;
+
+  calculate_kawase_parameters (blur, width, height);
+
+  for (i = 0; i < blur->n_iterations; i++)
+    {
+      BlurPass *pass = &blur->kawase_pass[i];
+
+      if (!setup_kawase_pass (blur, pass, KAWASE_DOWN, texture,
+                              MAX (1, width >> (i + 1)),
+                              MAX (1, height >> (i + 1))))
+        return FALSE;
+
+      texture = pass->texture;
+    }
+
+  for (i = blur->n_iterations - 1; i >= 0; i--)
+    {
+      BlurPass *pass = &blur->kawase_pass[2 * blur->n_iterations - 1 - i];
+
+      if (!setup_kawase_pass (blur, pass, KAWASE_UP, texture,
+                              MAX (1, width >> i),
+                              MAX (1, height >> i)))
+        return FALSE;
+
+      texture = pass->texture;
+    }
+
+  return TRUE;
+}
+
 static float
 calculate_downscale_factor (float width,
                             float height,
@@ -345,6 +545,25 @@ clear_blur_pass (BlurPass *pass)
 ClutterBlur *
 clutter_blur_new (CoglTexture *texture,
                   float        radius)
+{
+  return clutter_blur_new_with_mode (texture, radius,
+                                     CLUTTER_BLUR_MODE_GAUSSIAN);
+}
+
+/**
+ * clutter_blur_new_with_mode:
+ * @texture: a #CoglTexture
+ * @radius: blur radius
+ * @mode: the blur algorithm to use
+ *
+ * Creates a new #ClutterBlur using the algorithm given by @mode.
+ *
+ * Returns: (transfer full) (nullable): A newly created #ClutterBlur
+ */
+ClutterBlur *
+clutter_blur_new_with_mode (CoglTexture     *texture,
+                            float            radius,
+                            ClutterBlurMode  mode)
 {
   ClutterBlur *blur;
   unsigned int height;
@@ -359,6 +578,7 @@ clutter_blur_new (CoglTexture *texture,
   height = cogl_texture_get_height (texture);
 
   blur = g_new0 (ClutterBlur, 1);
+  blur->mode = mode;
   blur->sigma = radius / 2.0f;
   blur->source_texture = g_object_ref (texture);
   blur->downscale_factor = calculate_downscale_factor (width,
@@ -368,6 +588,17 @@ clutter_blur_new (CoglTexture *texture,
   if (G_APPROX_VALUE (blur->sigma, 0.0f, FLT_EPSILON))
     goto out;
 
+  if (mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    {
+      if (!setup_kawase_passes (blur))
+        {
+          clutter_blur_free (blur);
+          return NULL;
+        }
+
+      goto out;
+    }
+
   vpass = &blur->pass[VERTICAL];
   hpass = &blur->pass[HORIZONTAL];
 
@@ -392,13 +623,86 @@ out:
 void
 clutter_blur_apply (ClutterBlur *blur)
 {
+  int i;
+
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return;
 
+  COGL_TRACE_BEGIN_SCOPED (ClutterBlurApply, "Clutter::Blur::apply()");
+
+  COGL_TRACE_DESCRIBE (ClutterBlurApply,
+                       blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE ?
+                       "dual kawase" : "gaussian");
+
+  CLUTTER_NOTE (FRAME_TIMINGS,
+                "blur %s %dx%d sigma %.1f: ~%" G_GINT64_FORMAT
+                " texture fetches",
+                blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE ?
+                "dual-kawase" : "gaussian",
+                cogl_texture_get_width (blur->source_texture),
+                cogl_texture_get_height (blur->source_texture),
+                blur->sigma,
+                clutter_blur_estimate_fetches (blur));
+
+  if (blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    {
+      for (i = 0; i < 2 * blur->n_iterations; i++)
+        apply_blur_pass (&blur->kawase_pass[i]);
+      return;
+    }
+
   apply_blur_pass (&blur->pass[VERTICAL]);
   apply_blur_pass (&blur->pass[HORIZONTAL]);
 }
 
+/**
+ * clutter_blur_estimate_fetches:
+ * @blur: a #ClutterBlur
+ *
+ * Estimates the number of texture fetches done by one
+ * [method@Clutter.Blur.apply], as a measure of its GPU cost.
+ *
+ * Returns: the estimated number of texture fetches
+ */
+int64_t
+clutter_blur_estimate_fetches (ClutterBlur *blur)
+{
+  int64_t n_fetches = 0;
+  int i;
+
+  if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
+    return 0;
+
+  if (blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    {
+      for (i = 0; i < 2 * blur->n_iterations; i++)
+        {
+          CoglTexture *texture = blur->kawase_pass[i].texture;
+          int samples = i < blur->n_iterations ? 5 : 8;
+
+          n_fetches += (int64_t) cogl_texture_get_width (texture) *
+                       cogl_texture_get_height (texture) *
+                       samples;
+        }
+    }
+  else
+    {
+      float scaled_sigma = blur->sigma / blur->downscale_factor;
+      int samples = 1 + 2 * ((int) ceilf (1.5f * scaled_sigma));
+
+      for (i = VERTICAL; i <= HORIZONTAL; i++)
+        {
+          CoglTexture *texture = blur->pass[i].texture;
+
+          n_fetches += (int64_t) cogl_texture_get_width (texture) *
+                       cogl_texture_get_height (texture) *
+                       samples;
+        }
+    }
+
+  return n_fetches;
+}
+
 /**
  * clutter_blur_get_texture:
  * @blur: a #ClutterBlur
@@ -413,6 +717,8 @@ clutter_blur_get_texture (ClutterBlur *blur)
 {
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return blur->source_texture;
+  else if (blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    return blur->kawase_pass[2 * blur->n_iterations - 1].texture;
   else
     return blur->pass[HORIZONTAL].texture;
 }
@@ -426,10 +732,14 @@ clutter_blur_get_texture (ClutterBlur *blur)
 void
 clutter_blur_free (ClutterBlur *blur)
 {
+  int i;
+
   g_assert (blur);
 
   clear_blur_pass (&blur->pass[VERTICAL]);
   clear_blur_pass (&blur->pass[HORIZONTAL]);
+  for (i = 0; i < 2 * DUAL_KAWASE_MAX_ITERATIONS; i++)
+    clear_blur_pass (&blur->kawase_pass[i]);
   g_clear_object (&blur->source_texture);
   g_free (blur);
 }
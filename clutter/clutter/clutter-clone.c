@@ -33,14 +33,20 @@
  *
  * #ClutterClone does not require the presence of support for FBOs
  * in the underlying GL or GLES implementation.
+ *
+ * If [property@Clutter.Clone:use-source-content] is set and the source
+ * paints nothing but its [iface@Clutter.Content], the clone paints that
+ * content into its own allocation instead of painting the source.
  */
 
 #include "config.h"
 
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-clone.h"
+#include "clutter/clutter-content-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-main.h"
+#include "clutter/clutter-paint-node-private.h"
 #include "clutter/clutter-paint-volume-private.h"
 #include "clutter/clutter-private.h"
 
@@ -52,6 +58,8 @@ typedef struct _ClutterClonePrivate
   float x_scale, y_scale;
 
   gulong source_destroy_id;
+
+  guint use_source_content : 1;
 } ClutterClonePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterClone, clutter_clone, CLUTTER_TYPE_ACTOR)
@@ -61,6 +69,7 @@ enum
   PROP_0,
 
   PROP_SOURCE,
+  PROP_USE_SOURCE_CONTENT,
 
   PROP_LAST
 };
@@ -119,6 +128,37 @@ clutter_clone_get_preferred_height (ClutterActor *self,
                                         natural_height_p);
 }
 
+static gboolean
+clutter_clone_paint_source_content (ClutterClone        *self,
+                                    ClutterPaintContext *paint_context)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  g_autoptr (ClutterPaintNode) root = NULL;
+  CoglFramebuffer *framebuffer;
+  ClutterContent *content;
+
+  if (!priv->use_source_content)
+    return FALSE;
+
+  content = clutter_actor_get_sole_content (priv->clone_source);
+  if (content == NULL)
+    return FALSE;
+
+  /* The content is laid out within our own allocation, so unlike when
+   * painting the source there is no need for scaling; the paint opacity
+   * and scaling filters are ours as well.
+   */
+  framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
+  root = _clutter_dummy_node_new (actor, framebuffer);
+  clutter_paint_node_set_static_name (root, "CloneContent");
+
+  _clutter_content_paint_content (content, actor, root, paint_context);
+  clutter_paint_node_paint (root, paint_context);
+
+  return TRUE;
+}
+
 static void
 clutter_clone_paint (ClutterActor        *actor,
                      ClutterPaintContext *paint_context)
@@ -133,6 +173,9 @@ clutter_clone_paint (ClutterActor        *actor,
   CLUTTER_NOTE (PAINT, "painting clone actor '%s'",
                 _clutter_actor_get_debug_name (actor));
 
+  if (clutter_clone_paint_source_content (self, paint_context))
+    return;
+
   /* The final bits of magic:
    * - We need to override the paint opacity of the actor with our own
    *   opacity.
@@ -300,6 +343,10 @@ clutter_clone_set_property (GObject      *gobject,
       clutter_clone_set_source (self, g_value_get_object (value));
       break;
 
+    case PROP_USE_SOURCE_CONTENT:
+      clutter_clone_set_use_source_content (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -321,6 +368,10 @@ clutter_clone_get_property (GObject    *gobject,
       g_value_set_object (value, priv->clone_source);
       break;
 
+    case PROP_USE_SOURCE_CONTENT:
+      g_value_set_boolean (value, priv->use_source_content);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -364,6 +415,20 @@ clutter_clone_class_init (ClutterCloneClass *klass)
                          G_PARAM_READWRITE |
                          G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterClone:use-source-content:
+   *
+   * Whether the clone should paint the [iface@Clutter.Content] of the
+   * source directly, instead of painting the source actor, whenever
+   * the content is all the source paints.
+   */
+  obj_props[PROP_USE_SOURCE_CONTENT] =
+    g_param_spec_boolean ("use-source-content", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS |
+                          G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
@@ -466,3 +531,55 @@ clutter_clone_get_source (ClutterClone *self)
   priv = clutter_clone_get_instance_private (self);
   return priv->clone_source;
 }
+
+/**
+ * clutter_clone_set_use_source_content:
+ * @self: a #ClutterClone
+ * @use_source_content: whether to paint the content of the source
+ *
+ * Sets whether @self should paint the [iface@Clutter.Content] of its
+ * source directly, as a single textured rectangle for texture based
+ * content, rather than running the paint of the source actor.
+ *
+ * This only has an effect while the content is the only thing the
+ * source paints; otherwise the source is painted as usual.
+ */
+void
+clutter_clone_set_use_source_content (ClutterClone *self,
+                                      gboolean      use_source_content)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CLONE (self));
+
+  priv = clutter_clone_get_instance_private (self);
+
+  if (priv->use_source_content == !!use_source_content)
+    return;
+
+  priv->use_source_content = !!use_source_content;
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self),
+                            obj_props[PROP_USE_SOURCE_CONTENT]);
+}
+
+/**
+ * clutter_clone_get_use_source_content:
+ * @self: a #ClutterClone
+ *
+ * Retrieves the value set with clutter_clone_set_use_source_content().
+ *
+ * Return value: %TRUE if @self paints the content of its source directly
+ */
+gboolean
+clutter_clone_get_use_source_content (ClutterClone *self)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_CLONE (self), FALSE);
+
+  priv = clutter_clone_get_instance_private (self);
+  return priv->use_source_content;
+}
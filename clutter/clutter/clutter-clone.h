@@ -58,4 +58,10 @@ void            clutter_clone_set_source        (ClutterClone *self,
 CLUTTER_EXPORT
 ClutterActor *  clutter_clone_get_source        (ClutterClone *self);
 
+CLUTTER_EXPORT
+void            clutter_clone_set_use_source_content (ClutterClone *self,
+                                                      gboolean      use_source_content);
+CLUTTER_EXPORT
+gboolean        clutter_clone_get_use_source_content (ClutterClone *self);
+
 G_END_DECLS
@@ -33,3 +33,13 @@ CoglSnippet * clutter_color_manager_lookup_snippet (ClutterColorManager
 void clutter_color_manager_add_snippet (ClutterColorManager            *color_manager,
                                         const ClutterColorTransformKey *key,
                                         CoglSnippet                    *snippet);
+
+CoglTexture * clutter_color_manager_lookup_lut (ClutterColorManager            *color_manager,
+                                                const ClutterColorTransformKey *key);
+
+void clutter_color_manager_add_lut (ClutterColorManager            *color_manager,
+                                    const ClutterColorTransformKey *key,
+                                    CoglTexture                    *lut);
+
+void clutter_color_manager_remove_luts (ClutterColorManager *color_manager,
+                                        unsigned int         color_state_id);
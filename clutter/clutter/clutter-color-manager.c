@@ -45,6 +45,7 @@ struct _ClutterColorManager
   ClutterContext *context;
 
   GHashTable *snippet_cache;
+  GHashTable *lut_cache;
   unsigned int id_counter;
   ClutterColorState *default_color_state;
 };
@@ -57,6 +58,7 @@ clutter_color_manager_finalize (GObject *object)
   ClutterColorManager *color_manager = CLUTTER_COLOR_MANAGER (object);
 
   g_clear_pointer (&color_manager->snippet_cache, g_hash_table_unref);
+  g_clear_pointer (&color_manager->lut_cache, g_hash_table_unref);
 
   G_OBJECT_CLASS (clutter_color_manager_parent_class)->finalize (object);
 }
@@ -133,6 +135,11 @@ clutter_color_manager_init (ClutterColorManager *color_manager)
                            clutter_color_transform_key_equal,
                            g_free,
                            g_object_unref);
+  color_manager->lut_cache =
+    g_hash_table_new_full (clutter_color_transform_key_hash,
+                           clutter_color_transform_key_equal,
+                           g_free,
+                           g_object_unref);
 }
 
 unsigned int
@@ -171,3 +178,40 @@ clutter_color_manager_add_snippet (ClutterColorManager            *color_manager
                        g_memdup2 (key, sizeof (*key)),
                        g_object_ref (snippet));
 }
+
+CoglTexture *
+clutter_color_manager_lookup_lut (ClutterColorManager            *color_manager,
+                                  const ClutterColorTransformKey *key)
+{
+  return g_hash_table_lookup (color_manager->lut_cache, key);
+}
+
+void
+clutter_color_manager_add_lut (ClutterColorManager            *color_manager,
+                               const ClutterColorTransformKey *key,
+                               CoglTexture                    *lut)
+{
+  g_hash_table_insert (color_manager->lut_cache,
+                       g_memdup2 (key, sizeof (*key)),
+                       g_object_ref (lut));
+}
+
+static gboolean
+lut_uses_color_state (gpointer key,
+                      gpointer value,
+                      gpointer user_data)
+{
+  ClutterColorTransformKey *transform_key = key;
+  unsigned int id = GPOINTER_TO_UINT (user_data);
+
+  return transform_key->source.id == id || transform_key->target.id == id;
+}
+
+void
+clutter_color_manager_remove_luts (ClutterColorManager *color_manager,
+                                   unsigned int         color_state_id)
+{
+  g_hash_table_foreach_remove (color_manager->lut_cache,
+                               lut_uses_color_state,
+                               GUINT_TO_POINTER (color_state_id));
+}
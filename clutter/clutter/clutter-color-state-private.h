@@ -28,10 +28,15 @@ typedef struct _ClutterColorTransformKey
 {
   struct {
     guint eotf_key;
+    /* Only set for keys of baked lookup tables */
+    unsigned int id;
   } source;
   struct {
     guint eotf_key;
+    unsigned int id;
   } target;
+  /* Whether the color states are equal, needing no transform at all */
+  gboolean is_identity;
 } ClutterColorTransformKey;
 
 void clutter_color_transform_key_init (ClutterColorTransformKey *key,
@@ -49,6 +49,8 @@
 
 #include "clutter/clutter-color-state-private.h"
 
+#include <math.h>
+
 #include "clutter/clutter-color-manager-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-enum-types.h"
@@ -59,6 +61,11 @@
 #define UNIFORM_NAME_GAMMA_EXP "gamma_exp"
 #define UNIFORM_NAME_INV_GAMMA_EXP "inv_gamma_exp"
 
+/* Number of samples per channel of baked color transforms, and the pipeline
+ * layer the lookup table texture is bound to. */
+#define LUT_SIZE 33
+#define LUT_LAYER_INDEX 15
+
 struct _ClutterColorState
 {
   GObject parent_instance;
@@ -73,6 +80,8 @@ typedef struct _ClutterColorStatePrivate
   ClutterColorimetry colorimetry;
   ClutterEOTF eotf;
   ClutterLuminance luminance;
+
+  gboolean has_luts;
 } ClutterColorStatePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterColorState,
@@ -85,7 +94,10 @@ clutter_color_transform_key_hash (gconstpointer data)
   const ClutterColorTransformKey *key = data;
 
   return (key->source.eotf_key ^
-          key->target.eotf_key);
+          key->target.eotf_key ^
+          key->source.id ^
+          (key->target.id << 16) ^
+          key->is_identity);
 }
 
 gboolean
@@ -96,7 +108,10 @@ clutter_color_transform_key_equal (gconstpointer data1,
   const ClutterColorTransformKey *key2 = data2;
 
   return (key1->source.eotf_key == key2->source.eotf_key &&
-          key1->target.eotf_key == key2->target.eotf_key);
+          key1->target.eotf_key == key2->target.eotf_key &&
+          key1->source.id == key2->source.id &&
+          key1->target.id == key2->target.id &&
+          key1->is_identity == key2->is_identity);
 }
 
 static guint
@@ -122,7 +137,11 @@ clutter_color_transform_key_init (ClutterColorTransformKey *key,
     clutter_color_state_get_instance_private (target_color_state);
 
   key->source.eotf_key = get_eotf_key (priv->eotf);
+  key->source.id = 0;
   key->target.eotf_key = get_eotf_key (target_priv->eotf);
+  key->target.id = 0;
+  key->is_identity = clutter_color_state_equals (color_state,
+                                                 target_color_state);
 }
 
 static const char *
@@ -281,6 +300,14 @@ clutter_color_state_finalize (GObject *object)
   if (priv->colorimetry.type == CLUTTER_COLORIMETRY_TYPE_PRIMARIES)
     g_clear_pointer (&priv->colorimetry.primaries, g_free);
 
+  if (priv->has_luts)
+    {
+      ClutterColorManager *color_manager =
+        clutter_context_get_color_manager (priv->context);
+
+      clutter_color_manager_remove_luts (color_manager, priv->id);
+    }
+
   G_OBJECT_CLASS (clutter_color_state_parent_class)->finalize (object);
 }
 
@@ -978,6 +1005,78 @@ get_color_space_mapping_matrix (ClutterColorState *color_state,
   out_color_space_mapping[8] = graphene_matrix_get_value (&matrix, 2, 2);
 }
 
+/*
+ * Transforms can be baked into a lookup table instead, sampled by a snippet
+ * that is the same whatever the complexity of the transform. The table is
+ * indexed by the encoded source color, so it is only used when the source
+ * color state is bounded to the normalized [0,1] range.
+ */
+static gboolean
+should_bake_transform (ClutterColorState *color_state)
+{
+  ClutterColorStatePrivate *priv =
+    clutter_color_state_get_instance_private (color_state);
+  ClutterBackend *backend;
+  CoglContext *cogl_context;
+
+  if (G_LIKELY (!(clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_BAKE_COLOR_TRANSFORMS)))
+    return FALSE;
+
+  if (priv->eotf.type == CLUTTER_EOTF_TYPE_NAMED &&
+      priv->eotf.tf_name == CLUTTER_TRANSFER_FUNCTION_LINEAR)
+    return FALSE;
+
+  backend = clutter_context_get_backend (priv->context);
+  cogl_context = clutter_backend_get_cogl_context (backend);
+
+  return cogl_has_feature (cogl_context, COGL_FEATURE_ID_TEXTURE_HALF_FLOAT);
+}
+
+static CoglSnippet *
+create_lut_snippet (void)
+{
+  g_autoptr (GString) snippet_source = NULL;
+  CoglSnippet *snippet;
+
+  /*
+   * The LUT_SIZE³ table is laid out as LUT_SIZE slices of LUT_SIZE×LUT_SIZE
+   * texels next to each other, one slice per blue sample. Red and green are
+   * interpolated by the texture unit, blue by mixing two adjacent slices.
+   */
+  snippet_source = g_string_new (NULL);
+  g_string_append_printf (snippet_source,
+                          "  // Baked color transform\n"
+                          "  vec3 lut_position =\n"
+                          "    clamp (cogl_color_out.rgb, 0.0, 1.0) * %d.0;\n"
+                          "  float lut_slice = min (floor (lut_position.b), %d.0);\n"
+                          "  float lut_slice_fraction = lut_position.b - lut_slice;\n"
+                          "  vec2 lut_coord =\n"
+                          "    vec2 ((lut_slice * %d.0 + lut_position.r + 0.5) / %d.0,\n"
+                          "          (lut_position.g + 0.5) / %d.0);\n"
+                          "  vec3 lut_color =\n"
+                          "    mix (texture2D (cogl_sampler%d, lut_coord).rgb,\n"
+                          "         texture2D (cogl_sampler%d,\n"
+                          "                    lut_coord + vec2 (1.0 / %d.0, 0.0)).rgb,\n"
+                          "         lut_slice_fraction);\n"
+                          "  cogl_color_out = vec4 (lut_color, cogl_color_out.a);\n",
+                          LUT_SIZE - 1,
+                          LUT_SIZE - 2,
+                          LUT_SIZE, LUT_SIZE * LUT_SIZE,
+                          LUT_SIZE,
+                          LUT_LAYER_INDEX,
+                          LUT_LAYER_INDEX,
+                          LUT_SIZE);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                              NULL,
+                              snippet_source->str);
+  cogl_snippet_set_capability (snippet,
+                               CLUTTER_PIPELINE_CAPABILITY,
+                               CLUTTER_PIPELINE_CAPABILITY_COLOR_STATE);
+  return snippet;
+}
+
 static CoglSnippet *
 clutter_color_state_get_transform_snippet (ClutterColorState *color_state,
                                            ClutterColorState *target_color_state)
@@ -1002,6 +1101,15 @@ clutter_color_state_get_transform_snippet (ClutterColorState *color_state,
   if (snippet)
     return g_object_ref (snippet);
 
+  if (should_bake_transform (color_state))
+    {
+      snippet = create_lut_snippet ();
+      clutter_color_manager_add_snippet (color_manager,
+                                         &transform_key,
+                                         g_object_ref (snippet));
+      return snippet;
+    }
+
   get_transfer_functions (color_state, target_color_state,
                           &pre_transfer_function,
                           &post_transfer_function);
@@ -1098,6 +1206,180 @@ get_luminance_mapping (ClutterColorState *color_state,
   return (target_lum->ref / lum->ref) * (lum->max / target_lum->max);
 }
 
+static float evaluate_inv_eotf (const ClutterEOTF *eotf,
+                                float              value);
+
+static float
+evaluate_eotf (const ClutterEOTF *eotf,
+               float              value)
+{
+  switch (eotf->type)
+    {
+    case CLUTTER_EOTF_TYPE_GAMMA:
+      return powf (value, eotf->gamma_exp);
+    case CLUTTER_EOTF_TYPE_NAMED:
+      switch (eotf->tf_name)
+        {
+        case CLUTTER_TRANSFER_FUNCTION_PQ:
+          {
+            const float c1 = 0.8359375f;
+            const float c2 = 18.8515625f;
+            const float c3 = 18.6875f;
+            const float oo_m1 = 1.0f / 0.1593017578125f;
+            const float oo_m2 = 1.0f / 78.84375f;
+            float value_pow_oo_m2 = powf (value, oo_m2);
+
+            return powf (MAX (value_pow_oo_m2 - c1, 0.0f) /
+                         (c2 - c3 * value_pow_oo_m2),
+                         oo_m1);
+          }
+        case CLUTTER_TRANSFER_FUNCTION_BT709:
+          if (value < 0.018f)
+            return value / 4.5f;
+          else
+            return powf ((value + 0.099f) / 1.099f, 1.0f / 0.45f);
+        case CLUTTER_TRANSFER_FUNCTION_SRGB:
+          if (value <= 0.04045f)
+            return value / 12.92f;
+          else
+            return powf ((value + 0.055f) / 1.055f, 12.0f / 5.0f);
+        case CLUTTER_TRANSFER_FUNCTION_LINEAR:
+          return value;
+        }
+    }
+
+  g_assert_not_reached ();
+}
+
+static float
+encode_value (const ClutterEOTF *eotf,
+              float              value)
+{
+  if (eotf->type == CLUTTER_EOTF_TYPE_NAMED &&
+      eotf->tf_name == CLUTTER_TRANSFER_FUNCTION_LINEAR)
+    return value;
+
+  return evaluate_inv_eotf (eotf, MAX (value, 0.0f));
+}
+
+static CoglTexture *
+bake_transform_lut (ClutterColorState  *color_state,
+                    ClutterColorState  *target_color_state,
+                    GError            **error)
+{
+  ClutterColorStatePrivate *priv =
+    clutter_color_state_get_instance_private (color_state);
+  ClutterColorStatePrivate *target_priv =
+    clutter_color_state_get_instance_private (target_color_state);
+  ClutterBackend *backend = clutter_context_get_backend (priv->context);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (backend);
+  g_autoptr (CoglTexture) lut = NULL;
+  g_autofree float *data = NULL;
+  gboolean needs_transfer_functions;
+  float luminance_mapping;
+  float color_space_mapping[9];
+  float decoded[LUT_SIZE];
+  int width = LUT_SIZE * LUT_SIZE;
+  int r, g, b, i;
+
+  /* Mirrors the pipeline of the transform snippet */
+  needs_transfer_functions =
+    !clutter_color_state_equals (color_state, target_color_state);
+  luminance_mapping = get_luminance_mapping (color_state, target_color_state);
+  get_color_space_mapping_matrix (color_state, target_color_state,
+                                  color_space_mapping);
+
+  for (i = 0; i < LUT_SIZE; i++)
+    {
+      float value = (float) i / (LUT_SIZE - 1);
+
+      if (needs_transfer_functions)
+        value = evaluate_eotf (&priv->eotf, value);
+
+      decoded[i] = luminance_mapping * value;
+    }
+
+  data = g_new (float, width * LUT_SIZE * 4);
+
+  for (g = 0; g < LUT_SIZE; g++)
+    {
+      for (b = 0; b < LUT_SIZE; b++)
+        {
+          for (r = 0; r < LUT_SIZE; r++)
+            {
+              float *texel = &data[(g * width + b * LUT_SIZE + r) * 4];
+              float color[3] = { decoded[r], decoded[g], decoded[b] };
+
+              for (i = 0; i < 3; i++)
+                {
+                  float value = (color_space_mapping[i] * color[0] +
+                                 color_space_mapping[3 + i] * color[1] +
+                                 color_space_mapping[6 + i] * color[2]);
+
+                  if (needs_transfer_functions)
+                    value = encode_value (&target_priv->eotf, value);
+
+                  texel[i] = value;
+                }
+              texel[3] = 1.0f;
+            }
+        }
+    }
+
+  lut = cogl_texture_2d_new_with_format (cogl_context,
+                                         width, LUT_SIZE,
+                                         COGL_PIXEL_FORMAT_RGBA_FP_16161616);
+  if (!cogl_texture_set_data (lut,
+                              COGL_PIXEL_FORMAT_RGBA_FP_32323232,
+                              width * 4 * sizeof (float),
+                              (const uint8_t *) data,
+                              0,
+                              error))
+    return NULL;
+
+  return g_steal_pointer (&lut);
+}
+
+static CoglTexture *
+get_transform_lut (ClutterColorState *color_state,
+                   ClutterColorState *target_color_state)
+{
+  ClutterColorStatePrivate *priv =
+    clutter_color_state_get_instance_private (color_state);
+  ClutterColorStatePrivate *target_priv =
+    clutter_color_state_get_instance_private (target_color_state);
+  ClutterColorManager *color_manager =
+    clutter_context_get_color_manager (priv->context);
+  ClutterColorTransformKey transform_key;
+  g_autoptr (CoglTexture) lut = NULL;
+  g_autoptr (GError) error = NULL;
+  CoglTexture *cached_lut;
+
+  clutter_color_transform_key_init (&transform_key,
+                                    color_state,
+                                    target_color_state);
+  transform_key.source.id = priv->id;
+  transform_key.target.id = target_priv->id;
+
+  cached_lut = clutter_color_manager_lookup_lut (color_manager,
+                                                 &transform_key);
+  if (cached_lut)
+    return cached_lut;
+
+  lut = bake_transform_lut (color_state, target_color_state, &error);
+  if (!lut)
+    {
+      g_warning ("Failed to bake color transform: %s", error->message);
+      return NULL;
+    }
+
+  clutter_color_manager_add_lut (color_manager, &transform_key, lut);
+  priv->has_luts = TRUE;
+  target_priv->has_luts = TRUE;
+
+  return lut;
+}
+
 void
 clutter_color_state_update_uniforms (ClutterColorState *color_state,
                                      ClutterColorState *target_color_state,
@@ -1112,6 +1394,19 @@ clutter_color_state_update_uniforms (ClutterColorState *color_state,
   int uniform_location_luminance_mapping;
   int uniform_location_color_space_mapping;
 
+  if (clutter_color_state_equals (color_state, target_color_state))
+    return;
+
+  if (should_bake_transform (color_state))
+    {
+      CoglTexture *lut;
+
+      lut = get_transform_lut (color_state, target_color_state);
+      if (lut)
+        cogl_pipeline_set_layer_texture (pipeline, LUT_LAYER_INDEX, lut);
+      return;
+    }
+
   eotf = clutter_color_state_get_eotf (color_state);
   if (eotf->type == CLUTTER_EOTF_TYPE_GAMMA)
     {
@@ -1171,15 +1466,155 @@ clutter_color_state_add_pipeline_transform (ClutterColorState *color_state,
   g_return_if_fail (CLUTTER_IS_COLOR_STATE (color_state));
   g_return_if_fail (CLUTTER_IS_COLOR_STATE (target_color_state));
 
+  /* Content already in the target color state is painted as is */
+  if (clutter_color_state_equals (color_state, target_color_state))
+    return;
+
   snippet = clutter_color_state_get_transform_snippet (color_state,
                                                        target_color_state);
   cogl_pipeline_add_snippet (pipeline, snippet);
 
+  if (should_bake_transform (color_state))
+    {
+      cogl_pipeline_set_layer_combine (pipeline, LUT_LAYER_INDEX,
+                                       "RGBA = REPLACE (PREVIOUS)",
+                                       NULL);
+      cogl_pipeline_set_layer_filters (pipeline, LUT_LAYER_INDEX,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (pipeline, LUT_LAYER_INDEX,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+    }
+
   clutter_color_state_update_uniforms (color_state,
                                        target_color_state,
                                        pipeline);
 }
 
+/**
+ * clutter_color_state_get_separable_transform:
+ * @color_state: a #ClutterColorState
+ * @target_color_state: the target #ClutterColorState
+ * @out_matrix: (out caller-allocates) (array fixed-size=9): return location
+ *   for a row-major 3x3 matrix
+ *
+ * Retrieves the transform from @color_state to @target_color_state as a
+ * matrix applied to the tristimulus values, to be followed by
+ * clutter_color_state_encode() with @target_color_state. This is the same
+ * transform as added by clutter_color_state_add_pipeline_transform(), but in
+ * a form that can be applied outside of a shader, e.g. by display hardware.
+ *
+ * Only color states with linear transfer characteristics can be transformed
+ * this way.
+ *
+ * Returns: %TRUE if the transform could be retrieved
+ */
+gboolean
+clutter_color_state_get_separable_transform (ClutterColorState *color_state,
+                                             ClutterColorState *target_color_state,
+                                             float              out_matrix[9])
+{
+  ClutterColorStatePrivate *priv;
+  float color_space_mapping[9];
+  float luminance_mapping;
+  int i, j;
+
+  g_return_val_if_fail (CLUTTER_IS_COLOR_STATE (color_state), FALSE);
+  g_return_val_if_fail (CLUTTER_IS_COLOR_STATE (target_color_state), FALSE);
+
+  priv = clutter_color_state_get_instance_private (color_state);
+
+  if (priv->eotf.type != CLUTTER_EOTF_TYPE_NAMED ||
+      priv->eotf.tf_name != CLUTTER_TRANSFER_FUNCTION_LINEAR)
+    return FALSE;
+
+  luminance_mapping = get_luminance_mapping (color_state, target_color_state);
+  get_color_space_mapping_matrix (color_state, target_color_state,
+                                  color_space_mapping);
+
+  /* The mapping matrix is laid out column-major for the shader uniform */
+  for (i = 0; i < 3; i++)
+    {
+      for (j = 0; j < 3; j++)
+        {
+          out_matrix[i * 3 + j] =
+            luminance_mapping * color_space_mapping[j * 3 + i];
+        }
+    }
+
+  return TRUE;
+}
+
+static float
+evaluate_inv_eotf (const ClutterEOTF *eotf,
+                   float              value)
+{
+  switch (eotf->type)
+    {
+    case CLUTTER_EOTF_TYPE_GAMMA:
+      return powf (value, 1.0f / eotf->gamma_exp);
+    case CLUTTER_EOTF_TYPE_NAMED:
+      switch (eotf->tf_name)
+        {
+        case CLUTTER_TRANSFER_FUNCTION_PQ:
+          {
+            const float m1 = 0.1593017578125f;
+            const float m2 = 78.84375f;
+            const float c1 = 0.8359375f;
+            const float c2 = 18.8515625f;
+            const float c3 = 18.6875f;
+            float value_pow_m1 = powf (value, m1);
+
+            return powf ((c1 + c2 * value_pow_m1) / (1.0f + c3 * value_pow_m1),
+                         m2);
+          }
+        case CLUTTER_TRANSFER_FUNCTION_BT709:
+          if (value < 0.018f)
+            return 4.5f * value;
+          else
+            return 1.099f * powf (value, 0.45f) - 0.099f;
+        case CLUTTER_TRANSFER_FUNCTION_SRGB:
+          if (value <= 0.0031308f)
+            return 12.92f * value;
+          else
+            return 1.055f * powf (value, 5.0f / 12.0f) - 0.055f;
+        case CLUTTER_TRANSFER_FUNCTION_LINEAR:
+          return value;
+        }
+    }
+
+  g_assert_not_reached ();
+}
+
+/**
+ * clutter_color_state_encode:
+ * @color_state: a #ClutterColorState
+ * @values: (array length=n_values) (inout): normalized tristimulus values
+ * @n_values: the number of values
+ *
+ * Applies the inverse EOTF of @color_state to @values, turning normalized
+ * ([0,1]) tristimulus values into normalized electrical signal values.
+ */
+void
+clutter_color_state_encode (ClutterColorState *color_state,
+                            float             *values,
+                            size_t             n_values)
+{
+  ClutterColorStatePrivate *priv;
+  size_t i;
+
+  g_return_if_fail (CLUTTER_IS_COLOR_STATE (color_state));
+
+  priv = clutter_color_state_get_instance_private (color_state);
+
+  for (i = 0; i < n_values; i++)
+    {
+      float value = CLAMP (values[i], 0.0f, 1.0f);
+
+      values[i] = CLAMP (evaluate_inv_eotf (&priv->eotf, value), 0.0f, 1.0f);
+    }
+}
+
 static gboolean
 luminance_value_approx_equal (float lum,
                               float other_lum,
@@ -147,6 +147,16 @@ void clutter_color_state_update_uniforms (ClutterColorState *color_state,
                                           ClutterColorState *target_color_state,
                                           CoglPipeline      *pipeline);
 
+CLUTTER_EXPORT
+gboolean clutter_color_state_get_separable_transform (ClutterColorState *color_state,
+                                                      ClutterColorState *target_color_state,
+                                                      float              out_matrix[9]);
+
+CLUTTER_EXPORT
+void clutter_color_state_encode (ClutterColorState *color_state,
+                                 float             *values,
+                                 size_t             n_values);
+
 
 CLUTTER_EXPORT
 gboolean clutter_color_state_equals (ClutterColorState *color_state,
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "clutter/clutter-content.h"
+#include "mtk/mtk.h"
 
 G_BEGIN_DECLS
 
@@ -33,6 +34,9 @@ void            _clutter_content_attached               (ClutterContent   *conte
 void            _clutter_content_detached               (ClutterContent   *content,
                                                          ClutterActor     *actor);
 
+void            _clutter_content_invalidate_area        (ClutterContent     *content,
+                                                         const MtkRectangle *area);
+
 void            _clutter_content_paint_content          (ClutterContent      *content,
                                                          ClutterActor        *actor,
                                                          ClutterPaintNode    *node,
@@ -184,6 +184,75 @@ clutter_content_invalidate (ClutterContent *content)
     }
 }
 
+/*< private >
+ * _clutter_content_invalidate_area:
+ * @content: a #ClutterContent
+ * @area: the changed area, in the units of the preferred size of @content
+ *
+ * Like clutter_content_invalidate(), but only queues redraws of the part
+ * of the attached actors that @area is painted to. Actors that repeat the
+ * content are redrawn completely.
+ */
+void
+_clutter_content_invalidate_area (ClutterContent     *content,
+                                  const MtkRectangle *area)
+{
+  GHashTable *actors;
+  GHashTableIter iter;
+  gpointer key_p, value_p;
+  float content_width, content_height;
+
+  g_return_if_fail (CLUTTER_IS_CONTENT (content));
+
+  if (!clutter_content_get_preferred_size (content,
+                                           &content_width,
+                                           &content_height) ||
+      content_width <= 0.f || content_height <= 0.f)
+    {
+      clutter_content_invalidate (content);
+      return;
+    }
+
+  CLUTTER_CONTENT_GET_IFACE (content)->invalidate (content);
+
+  actors = g_object_get_qdata (G_OBJECT (content), quark_content_actors);
+  if (actors == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, actors);
+  while (g_hash_table_iter_next (&iter, &key_p, &value_p))
+    {
+      ClutterActor *actor = key_p;
+      ClutterActorBox box;
+      graphene_rect_t rect;
+      MtkRectangle clip;
+      float scale_x, scale_y;
+
+      g_assert (actor != NULL);
+
+      if (clutter_actor_get_content_repeat (actor) != CLUTTER_REPEAT_NONE)
+        {
+          clutter_actor_queue_redraw (actor);
+          continue;
+        }
+
+      clutter_actor_get_content_box (actor, &box);
+
+      scale_x = clutter_actor_box_get_width (&box) / content_width;
+      scale_y = clutter_actor_box_get_height (&box) / content_height;
+
+      rect = GRAPHENE_RECT_INIT (box.x1 + area->x * scale_x,
+                                 box.y1 + area->y * scale_y,
+                                 area->width * scale_x,
+                                 area->height * scale_y);
+      mtk_rectangle_from_graphene_rect (&rect,
+                                        MTK_ROUNDING_STRATEGY_GROW,
+                                        &clip);
+
+      clutter_actor_queue_redraw_with_clip (actor, &clip);
+    }
+}
+
 /**
  * clutter_content_invalidate_size:
  * @content: a #ClutterContent
@@ -21,6 +21,7 @@
 
 #include "clutter/clutter-context.h"
 #include "clutter-stage-manager-private.h"
+#include "clutter-text-layout-cache.h"
 
 struct _ClutterContext
 {
@@ -30,6 +31,12 @@ struct _ClutterContext
   ClutterStageManager *stage_manager;
 
   GAsyncQueue *events_queue;
+  /* the last queued motion event, while it is still at the tail of
+   * events_queue; protected by the queue lock */
+  ClutterEvent *coalescable_motion;
+  /* touch update events queued since the last event of any other kind,
+   * at most one per sequence; protected by the queue lock */
+  GPtrArray *coalescable_touch_updates;
 
   /* the event filters added via clutter_event_add_filter. these are
    * ordered from least recently added to most recently added */
@@ -53,3 +60,5 @@ ClutterStageManager * clutter_context_get_stage_manager (ClutterContext *context
 gboolean clutter_context_get_show_fps (ClutterContext *context);
 
 PangoRenderer * clutter_context_get_font_renderer (ClutterContext *context);
+
+ClutterTextLayoutCache * clutter_context_get_text_layout_cache (ClutterContext *context);
@@ -63,6 +63,7 @@ static const GDebugKey clutter_debug_keys[] = {
 
 static const GDebugKey clutter_pick_debug_keys[] = {
   { "nop-picking", CLUTTER_DEBUG_NOP_PICKING },
+  { "disable-pick-cache", CLUTTER_DEBUG_DISABLE_PICK_CACHE },
 };
 
 static const GDebugKey clutter_paint_debug_keys[] = {
@@ -77,6 +78,12 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "damage-region", CLUTTER_DEBUG_PAINT_DAMAGE_REGION },
   { "disable-dynamic-max-render-time", CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME },
   { "max-render-time", CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME },
+  { "disable-retained-paint-nodes", CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES },
+  { "disable-shadowfb-damage-tiles", CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_TILES },
+  { "disable-triple-buffering", CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING },
+  { "bake-color-transforms", CLUTTER_DEBUG_BAKE_COLOR_TRANSFORMS },
+  { "redraw-actors", CLUTTER_DEBUG_REDRAW_ACTORS },
+  { "gpu-phases", CLUTTER_DEBUG_GPU_PHASES },
 };
 
 typedef struct _ClutterContextPrivate
@@ -85,6 +92,7 @@ typedef struct _ClutterContextPrivate
 
   ClutterColorManager *color_manager;
   ClutterPipelineCache *pipeline_cache;
+  ClutterTextLayoutCache *text_layout_cache;
 } ClutterContextPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterContext, clutter_context, G_TYPE_OBJECT)
@@ -95,9 +103,11 @@ clutter_context_dispose (GObject *object)
   ClutterContext *context = CLUTTER_CONTEXT (object);
   ClutterContextPrivate *priv = clutter_context_get_instance_private (context);
 
+  g_clear_pointer (&priv->text_layout_cache, clutter_text_layout_cache_free);
   g_clear_object (&priv->pipeline_cache);
   g_clear_object (&priv->color_manager);
   g_clear_pointer (&context->events_queue, g_async_queue_unref);
+  g_clear_pointer (&context->coalescable_touch_updates, g_ptr_array_unref);
   g_clear_pointer (&context->backend, clutter_backend_destroy);
   g_clear_object (&context->stage_manager);
   g_clear_object (&context->settings);
@@ -280,12 +290,14 @@ clutter_context_new (ClutterBackendConstructor   backend_constructor,
 
   context->events_queue =
     g_async_queue_new_full ((GDestroyNotify) clutter_event_free);
+  context->coalescable_touch_updates = g_ptr_array_new ();
   context->last_repaint_id = 1;
 
   priv->color_manager = g_object_new (CLUTTER_TYPE_COLOR_MANAGER,
                                       "context", context,
                                       NULL);
   priv->pipeline_cache = g_object_new (CLUTTER_TYPE_PIPELINE_CACHE, NULL);
+  priv->text_layout_cache = clutter_text_layout_cache_new (context->backend);
 
   if (!clutter_context_init_real (context, error))
     return NULL;
@@ -352,6 +364,14 @@ clutter_context_get_pipeline_cache (ClutterContext *context)
   return priv->pipeline_cache;
 }
 
+ClutterTextLayoutCache *
+clutter_context_get_text_layout_cache (ClutterContext *context)
+{
+  ClutterContextPrivate *priv = clutter_context_get_instance_private (context);
+
+  return priv->text_layout_cache;
+}
+
 ClutterColorManager *
 clutter_context_get_color_manager (ClutterContext *context)
 {
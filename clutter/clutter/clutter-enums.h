@@ -1198,4 +1198,19 @@ typedef enum /*< prefix=CLUTTER_GESTURE_STATE >*/
   CLUTTER_N_GESTURE_STATES
 } ClutterGestureState;
 
+/**
+ * ClutterBlurMode:
+ * @CLUTTER_BLUR_MODE_GAUSSIAN: Two pass gaussian blur, run on a texture
+ *   downscaled according to the blur radius
+ * @CLUTTER_BLUR_MODE_DUAL_KAWASE: Dual Kawase blur, a chain of downsampling
+ *   and upsampling passes that stays cheap at large blur radii
+ *
+ * The algorithm used to blur textures.
+ */
+typedef enum
+{
+  CLUTTER_BLUR_MODE_GAUSSIAN,
+  CLUTTER_BLUR_MODE_DUAL_KAWASE,
+} ClutterBlurMode;
+
 G_END_DECLS
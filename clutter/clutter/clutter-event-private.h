@@ -179,6 +179,12 @@ CLUTTER_EXPORT
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
+CLUTTER_EXPORT
+void            _clutter_event_push_motion              (ClutterEvent       *event);
+
+CLUTTER_EXPORT
+void            _clutter_event_push_touch_update        (ClutterEvent       *event);
+
 CLUTTER_EXPORT
 const char * clutter_event_get_name (const ClutterEvent *event);
 
@@ -122,6 +122,8 @@ struct _ClutterMotionEvent
   double dy_unaccel;
   double dx_constrained;
   double dy_constrained;
+
+  GArray *history;
 };
 
 struct _ClutterScrollEvent
@@ -157,6 +159,8 @@ struct _ClutterTouchEvent
   ClutterEventSequence *sequence;
   ClutterModifierType modifier_state;
   double *axes; /* reserved */
+
+  GArray *history;
 };
 
 struct _ClutterTouchpadPinchEvent
@@ -838,6 +842,8 @@ clutter_event_new (ClutterEventType type)
   new_event = g_new0 (ClutterEvent, 1);
   new_event->any.type = type;
 
+  COGL_TRACE_ALLOCATION (new_event, sizeof (ClutterEvent));
+
   return new_event;
 }
 
@@ -890,6 +896,8 @@ clutter_event_copy (const ClutterEvent *event)
             g_memdup2 (event->motion.axes,
                        sizeof (double) * CLUTTER_INPUT_AXIS_LAST);
         }
+      if (event->motion.history != NULL)
+        new_event->motion.history = g_array_copy (event->motion.history);
       break;
 
     case CLUTTER_TOUCH_BEGIN:
@@ -902,6 +910,8 @@ clutter_event_copy (const ClutterEvent *event)
             g_memdup2 (event->touch.axes,
                       sizeof (double) * CLUTTER_INPUT_AXIS_LAST);
         }
+      if (event->touch.history != NULL)
+        new_event->touch.history = g_array_copy (event->touch.history);
       break;
 
     case CLUTTER_IM_COMMIT:
@@ -939,6 +949,7 @@ clutter_event_free (ClutterEvent *event)
 
         case CLUTTER_MOTION:
           g_free (event->motion.axes);
+          g_clear_pointer (&event->motion.history, g_array_unref);
           break;
 
         case CLUTTER_SCROLL:
@@ -950,6 +961,7 @@ clutter_event_free (ClutterEvent *event)
         case CLUTTER_TOUCH_END:
         case CLUTTER_TOUCH_CANCEL:
           g_free (event->touch.axes);
+          g_clear_pointer (&event->touch.history, g_array_unref);
           break;
 
         case CLUTTER_IM_COMMIT:
@@ -979,7 +991,13 @@ clutter_event_get (void)
   ClutterContext *context = _clutter_context_get_default ();
   ClutterEvent *event;
 
-  event = g_async_queue_try_pop (context->events_queue);
+  g_async_queue_lock (context->events_queue);
+  event = g_async_queue_try_pop_unlocked (context->events_queue);
+  if (event && event == context->coalescable_motion)
+    context->coalescable_motion = NULL;
+  if (event && event->type == CLUTTER_TOUCH_UPDATE)
+    g_ptr_array_remove_fast (context->coalescable_touch_updates, event);
+  g_async_queue_unlock (context->events_queue);
 
   return event;
 }
@@ -1002,6 +1020,204 @@ _clutter_event_push (const ClutterEvent *event,
 
   g_async_queue_lock (context->events_queue);
   g_async_queue_push_unlocked (context->events_queue, (gpointer) event);
+  context->coalescable_motion = NULL;
+  g_ptr_array_set_size (context->coalescable_touch_updates, 0);
+  if (g_async_queue_length_unlocked (context->events_queue) == 1)
+    g_main_context_wakeup (NULL);
+  g_async_queue_unlock (context->events_queue);
+}
+
+/* Bounds how much history a single coalesced event can carry if the
+ * main thread falls behind */
+#define MAX_MOTION_HISTORY 1024
+
+static gboolean
+can_coalesce_motion (const ClutterEvent *event,
+                     const ClutterEvent *next)
+{
+  if (event->motion.history &&
+      event->motion.history->len >= MAX_MOTION_HISTORY)
+    return FALSE;
+
+  return (event->motion.flags == next->motion.flags &&
+          event->motion.device == next->motion.device &&
+          event->motion.source_device == next->motion.source_device &&
+          event->motion.tool == next->motion.tool &&
+          event->motion.modifier_state == next->motion.modifier_state &&
+          !event->motion.axes &&
+          !next->motion.axes);
+}
+
+static void
+append_motion_history (GArray                   *history,
+                       const ClutterMotionEvent *motion)
+{
+  ClutterMotionHistoryEntry entry;
+
+  entry = (ClutterMotionHistoryEntry) {
+    .time_us = motion->time_us,
+    .dx = motion->dx,
+    .dy = motion->dy,
+    .dx_unaccel = motion->dx_unaccel,
+    .dy_unaccel = motion->dy_unaccel,
+  };
+  g_array_append_val (history, entry);
+}
+
+static void
+coalesce_motion (ClutterEvent       *event,
+                 const ClutterEvent *next)
+{
+  if (!event->motion.history)
+    {
+      event->motion.history =
+        g_array_new (FALSE, FALSE, sizeof (ClutterMotionHistoryEntry));
+      append_motion_history (event->motion.history, &event->motion);
+    }
+
+  append_motion_history (event->motion.history, &next->motion);
+
+  event->motion.time_us = next->motion.time_us;
+  event->motion.x = next->motion.x;
+  event->motion.y = next->motion.y;
+  event->motion.dx += next->motion.dx;
+  event->motion.dy += next->motion.dy;
+  event->motion.dx_unaccel += next->motion.dx_unaccel;
+  event->motion.dy_unaccel += next->motion.dy_unaccel;
+  event->motion.dx_constrained += next->motion.dx_constrained;
+  event->motion.dy_constrained += next->motion.dy_constrained;
+}
+
+/*< private >
+ * _clutter_event_push_motion:
+ * @event: (transfer full): a motion event
+ *
+ * Queues a motion event like _clutter_event_push(), but merges it into the
+ * previously queued motion event if that has not been picked up yet and
+ * nothing else was queued since. Merged events carry the accumulated
+ * deltas, and the individual samples are available through
+ * clutter_event_get_motion_history().
+ */
+void
+_clutter_event_push_motion (ClutterEvent *event)
+{
+  ClutterContext *context = _clutter_context_get_default ();
+  ClutterEvent *pending;
+
+  g_assert (context != NULL);
+  g_return_if_fail (event->type == CLUTTER_MOTION);
+
+  g_async_queue_lock (context->events_queue);
+
+  pending = context->coalescable_motion;
+  if (pending && can_coalesce_motion (pending, event))
+    {
+      coalesce_motion (pending, event);
+      g_async_queue_unlock (context->events_queue);
+      clutter_event_free (event);
+      return;
+    }
+
+  g_async_queue_push_unlocked (context->events_queue, event);
+  context->coalescable_motion = event;
+  g_ptr_array_set_size (context->coalescable_touch_updates, 0);
+  if (g_async_queue_length_unlocked (context->events_queue) == 1)
+    g_main_context_wakeup (NULL);
+  g_async_queue_unlock (context->events_queue);
+}
+
+static gboolean
+can_coalesce_touch_update (const ClutterEvent *event,
+                           const ClutterEvent *next)
+{
+  if (event->touch.history &&
+      event->touch.history->len >= MAX_MOTION_HISTORY)
+    return FALSE;
+
+  return (event->touch.flags == next->touch.flags &&
+          event->touch.device == next->touch.device &&
+          event->touch.source_device == next->touch.source_device &&
+          event->touch.modifier_state == next->touch.modifier_state &&
+          !event->touch.axes &&
+          !next->touch.axes);
+}
+
+static void
+append_touch_history (GArray                  *history,
+                      const ClutterTouchEvent *touch)
+{
+  ClutterTouchHistoryEntry entry;
+
+  entry = (ClutterTouchHistoryEntry) {
+    .time_us = touch->time_us,
+    .x = touch->x,
+    .y = touch->y,
+  };
+  g_array_append_val (history, entry);
+}
+
+static void
+coalesce_touch_update (ClutterEvent       *event,
+                       const ClutterEvent *next)
+{
+  if (!event->touch.history)
+    {
+      event->touch.history =
+        g_array_new (FALSE, FALSE, sizeof (ClutterTouchHistoryEntry));
+      append_touch_history (event->touch.history, &event->touch);
+    }
+
+  append_touch_history (event->touch.history, &next->touch);
+
+  event->touch.time_us = next->touch.time_us;
+  event->touch.x = next->touch.x;
+  event->touch.y = next->touch.y;
+}
+
+/*< private >
+ * _clutter_event_push_touch_update:
+ * @event: (transfer full): a touch update event
+ *
+ * Queues a touch update event like _clutter_event_push(), but merges it
+ * into the update of the same touch sequence that is still waiting in the
+ * queue, as long as only touch updates were queued since. Merged events
+ * have the position of the newest sample, and the individual samples are
+ * available through clutter_event_get_touch_history().
+ */
+void
+_clutter_event_push_touch_update (ClutterEvent *event)
+{
+  ClutterContext *context = _clutter_context_get_default ();
+  unsigned int i;
+
+  g_assert (context != NULL);
+  g_return_if_fail (event->type == CLUTTER_TOUCH_UPDATE);
+
+  g_async_queue_lock (context->events_queue);
+
+  for (i = 0; i < context->coalescable_touch_updates->len; i++)
+    {
+      ClutterEvent *pending =
+        g_ptr_array_index (context->coalescable_touch_updates, i);
+
+      if (pending->touch.sequence != event->touch.sequence)
+        continue;
+
+      if (can_coalesce_touch_update (pending, event))
+        {
+          coalesce_touch_update (pending, event);
+          g_async_queue_unlock (context->events_queue);
+          clutter_event_free (event);
+          return;
+        }
+
+      g_ptr_array_remove_index_fast (context->coalescable_touch_updates, i);
+      break;
+    }
+
+  g_async_queue_push_unlocked (context->events_queue, event);
+  context->coalescable_motion = NULL;
+  g_ptr_array_add (context->coalescable_touch_updates, event);
   if (g_async_queue_length_unlocked (context->events_queue) == 1)
     g_main_context_wakeup (NULL);
   g_async_queue_unlock (context->events_queue);
@@ -1738,6 +1954,63 @@ clutter_event_get_relative_motion (const ClutterEvent *event,
     return FALSE;
 }
 
+/**
+ * clutter_event_get_motion_history:
+ * @event: a motion #ClutterEvent
+ * @n_entries: (out): return location for the number of entries
+ *
+ * Retrieves the individual relative motion samples that were merged into
+ * @event, oldest first. The deltas of @event are the sum of those of all
+ * entries.
+ *
+ * Returns: (array length=n_entries) (nullable): the motion samples, or
+ *   %NULL if @event was not merged from several samples
+ */
+const ClutterMotionHistoryEntry *
+clutter_event_get_motion_history (const ClutterEvent *event,
+                                  size_t             *n_entries)
+{
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (n_entries != NULL, NULL);
+
+  if (event->type != CLUTTER_MOTION || !event->motion.history)
+    {
+      *n_entries = 0;
+      return NULL;
+    }
+
+  *n_entries = event->motion.history->len;
+  return (const ClutterMotionHistoryEntry *) event->motion.history->data;
+}
+
+/**
+ * clutter_event_get_touch_history:
+ * @event: a touch update #ClutterEvent
+ * @n_entries: (out): return location for the number of entries
+ *
+ * Retrieves the individual touch point positions that were merged into
+ * @event, oldest first. The position of @event is that of the last entry.
+ *
+ * Returns: (array length=n_entries) (nullable): the touch samples, or
+ *   %NULL if @event was not merged from several samples
+ */
+const ClutterTouchHistoryEntry *
+clutter_event_get_touch_history (const ClutterEvent *event,
+                                 size_t             *n_entries)
+{
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (n_entries != NULL, NULL);
+
+  if (event->type != CLUTTER_TOUCH_UPDATE || !event->touch.history)
+    {
+      *n_entries = 0;
+      return NULL;
+    }
+
+  *n_entries = event->touch.history->len;
+  return (const ClutterTouchHistoryEntry *) event->touch.history->data;
+}
+
 const char *
 clutter_event_get_im_text (const ClutterEvent *event)
 {
@@ -109,6 +109,40 @@ typedef struct _ClutterPadRingEvent     ClutterPadRingEvent;
 typedef struct _ClutterDeviceEvent      ClutterDeviceEvent;
 typedef struct _ClutterIMEvent          ClutterIMEvent;
 
+/**
+ * ClutterMotionHistoryEntry:
+ * @time_us: the time of the motion sample, in microseconds
+ * @dx: the relative motion on the X axis
+ * @dy: the relative motion on the Y axis
+ * @dx_unaccel: the unaccelerated relative motion on the X axis
+ * @dy_unaccel: the unaccelerated relative motion on the Y axis
+ *
+ * A single relative motion sample that was merged into a motion event.
+ */
+typedef struct _ClutterMotionHistoryEntry
+{
+  int64_t time_us;
+  double dx;
+  double dy;
+  double dx_unaccel;
+  double dy_unaccel;
+} ClutterMotionHistoryEntry;
+
+/**
+ * ClutterTouchHistoryEntry:
+ * @time_us: the time of the touch sample, in microseconds
+ * @x: the X coordinate of the touch point, in stage coordinates
+ * @y: the Y coordinate of the touch point, in stage coordinates
+ *
+ * A single touch point position that was merged into a touch update event.
+ */
+typedef struct _ClutterTouchHistoryEntry
+{
+  int64_t time_us;
+  float x;
+  float y;
+} ClutterTouchHistoryEntry;
+
 /**
  * ClutterEventFilterFunc:
  * @event: the event that is going to be emitted
@@ -285,6 +319,14 @@ gboolean clutter_event_get_relative_motion (const ClutterEvent *event,
                                             double             *dx_constrained,
                                             double             *dy_constrained);
 
+CLUTTER_EXPORT
+const ClutterMotionHistoryEntry * clutter_event_get_motion_history (const ClutterEvent *event,
+                                                                    size_t             *n_entries);
+
+CLUTTER_EXPORT
+const ClutterTouchHistoryEntry * clutter_event_get_touch_history (const ClutterEvent *event,
+                                                                  size_t             *n_entries);
+
 CLUTTER_EXPORT
 const char * clutter_event_get_im_text (const ClutterEvent *event);
 CLUTTER_EXPORT
@@ -87,8 +87,12 @@ struct _ClutterFlowLayout
 
   guint line_count;
 
+  /* area of the container that is actually visible, if known */
+  graphene_rect_t visible_area;
+
   guint is_homogeneous : 1;
   guint snap_to_grid : 1;
+  guint has_visible_area : 1;
 };
 
 enum
@@ -606,6 +610,7 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
       gfloat item_width, item_height;
       gfloat new_x, new_y;
       gfloat child_min, child_natural;
+      gboolean in_view;
 
       if (!clutter_actor_is_visible (child))
         continue;
@@ -688,7 +693,18 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
                                       line_index);
         }
 
-      if (!self->is_homogeneous &&
+      /* children outside of the visible area keep the whole cell
+       * as a placeholder allocation, and are only shrunk to their
+       * preferred size once they scroll into view
+       */
+      in_view = !self->has_visible_area ||
+                graphene_rect_intersection (&self->visible_area,
+                                            &GRAPHENE_RECT_INIT (item_x, item_y,
+                                                                 item_width,
+                                                                 item_height),
+                                            NULL);
+
+      if (in_view && !self->is_homogeneous &&
           !clutter_actor_needs_expand (child,
                                        CLUTTER_ORIENTATION_HORIZONTAL))
         {
@@ -698,7 +714,7 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
           item_width = MIN (item_width, child_natural);
         }
 
-      if (!self->is_homogeneous &&
+      if (in_view && !self->is_homogeneous &&
           !clutter_actor_needs_expand (child,
                                        CLUTTER_ORIENTATION_VERTICAL))
         {
@@ -1436,3 +1452,37 @@ clutter_flow_layout_get_snap_to_grid (ClutterFlowLayout *layout)
 
   return layout->snap_to_grid;
 }
+
+/**
+ * clutter_flow_layout_set_visible_area:
+ * @layout: a #ClutterFlowLayout
+ * @area: (nullable): the visible area of the container, or %NULL
+ *
+ * Sets the area of the container, in the coordinate space of the
+ * container, that is currently visible, for instance because the
+ * container is inside a scrolled view.
+ *
+ * Children placed outside of @area are allocated their whole cell
+ * without querying their preferred size, until the visible area is
+ * changed to include them. Passing %NULL treats every child as
+ * visible, which is the default.
+ */
+void
+clutter_flow_layout_set_visible_area (ClutterFlowLayout     *layout,
+                                      const graphene_rect_t *area)
+{
+  g_return_if_fail (CLUTTER_IS_FLOW_LAYOUT (layout));
+
+  if (!area && !layout->has_visible_area)
+    return;
+
+  if (area && layout->has_visible_area &&
+      graphene_rect_equal (area, &layout->visible_area))
+    return;
+
+  layout->has_visible_area = area != NULL;
+  if (area)
+    layout->visible_area = *area;
+
+  clutter_layout_manager_layout_changed (CLUTTER_LAYOUT_MANAGER (layout));
+}
@@ -86,5 +86,8 @@ void                   clutter_flow_layout_set_snap_to_grid   (ClutterFlowLayout
                                                                gboolean                snap_to_grid);
 CLUTTER_EXPORT
 gboolean               clutter_flow_layout_get_snap_to_grid   (ClutterFlowLayout      *layout);
+CLUTTER_EXPORT
+void                   clutter_flow_layout_set_visible_area   (ClutterFlowLayout      *layout,
+                                                               const graphene_rect_t  *area);
 
 G_END_DECLS
@@ -46,6 +46,23 @@ static guint signals[N_SIGNALS];
 
 #define MINIMUM_REFRESH_RATE 30.f
 
+/* Fractions of the refresh interval the long-term maximum update duration has
+ * to exceed to switch to triple buffering, and drop below to switch back to
+ * double buffering. */
+#define TRIPLE_BUFFERING_ENTER_FRACTION 0.9f
+#define TRIPLE_BUFFERING_LEAVE_FRACTION 0.6f
+
+/* Largest refresh interval difference for which a frame clock still follows
+ * its sync leader. */
+#define SYNC_LEADER_MAX_INTERVAL_DELTA_US 50
+
+/* Fraction of the refresh interval a dispatch may be delayed past its ready
+ * time, e.g. by a flood of client requests, before the frame clock source
+ * is dispatched at the same priority as events, and for how long it stays
+ * that way after the last late dispatch. */
+#define STARVED_DISPATCH_FRACTION 0.25f
+#define STARVED_DISPATCH_BOOST_US (G_USEC_PER_SEC)
+
 typedef struct _ClutterFrameListener
 {
   const ClutterFrameListenerIface *iface;
@@ -72,8 +89,18 @@ typedef enum _ClutterFrameClockState
   CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW,
   CLUTTER_FRAME_CLOCK_STATE_DISPATCHING,
   CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED,
+  CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED,
+  CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW,
+  CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING,
+  CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO,
 } ClutterFrameClockState;
 
+typedef enum _ClutterFrameClockBuffering
+{
+  CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE,
+  CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE,
+} ClutterFrameClockBuffering;
+
 struct _ClutterFrameClock
 {
   GObject parent;
@@ -90,9 +117,13 @@ struct _ClutterFrameClock
 
   ClutterFrameClockState state;
   ClutterFrameClockMode mode;
+  ClutterFrameClockPolicy policy;
+  ClutterFrameClockBuffering buffering;
+  int n_buffering_switches;
 
   int64_t last_dispatch_time_us;
   int64_t last_dispatch_lateness_us;
+  int64_t last_starved_dispatch_time_us;
   int64_t last_presentation_time_us;
   int64_t next_update_time_us;
 
@@ -107,6 +138,15 @@ struct _ClutterFrameClock
   gboolean has_last_next_presentation_time;
   int64_t last_next_presentation_time_us;
 
+  /* Timings of the oldest frame while two frames are in flight. */
+  struct {
+    int64_t dispatch_time_us;
+    int64_t dispatch_lateness_us;
+    int64_t flip_time_us;
+    gboolean is_next_presentation_time_valid;
+    int64_t next_presentation_time_us;
+  } in_flight;
+
   /* Buffer must be submitted to KMS and GPU rendering must be finished
    * this amount of time before the next presentation time.
    */
@@ -139,7 +179,18 @@ struct _ClutterFrameClock
 
   int64_t deadline_evasion_us;
 
+  /* Low framerate compensation in variable refresh rate mode. */
+  struct {
+    int64_t last_content_dispatch_time_us;
+    int64_t content_interval_us;
+    int64_t last_content_presentation_time_us;
+    gboolean has_pending_content;
+    gboolean is_repeat_scheduled;
+  } lfc;
+
   char *output_name;
+
+  ClutterFrameClock *sync_leader;
 };
 
 G_DEFINE_TYPE (ClutterFrameClock, clutter_frame_clock,
@@ -160,6 +211,16 @@ clutter_frame_clock_set_refresh_rate (ClutterFrameClock *frame_clock,
     (int64_t) (0.5 + G_USEC_PER_SEC / refresh_rate);
 }
 
+void
+clutter_frame_clock_set_minimum_refresh_rate (ClutterFrameClock *frame_clock,
+                                              float              minimum_refresh_rate)
+{
+  g_return_if_fail (minimum_refresh_rate > 0.0);
+
+  frame_clock->minimum_refresh_interval_us =
+    (int64_t) (0.5 + G_USEC_PER_SEC / minimum_refresh_rate);
+}
+
 void
 clutter_frame_clock_add_timeline (ClutterFrameClock *frame_clock,
                                   ClutterTimeline   *timeline)
@@ -245,6 +306,145 @@ maybe_reschedule_update (ClutterFrameClock *frame_clock)
     }
 }
 
+static const char *
+policy_to_string (ClutterFrameClockPolicy policy)
+{
+  switch (policy)
+    {
+    case CLUTTER_FRAME_CLOCK_POLICY_DEFAULT:
+      return "default";
+    case CLUTTER_FRAME_CLOCK_POLICY_LOW_LATENCY:
+      return "low latency";
+    case CLUTTER_FRAME_CLOCK_POLICY_FIXED_PHASE:
+      return "fixed phase";
+    }
+
+  g_assert_not_reached ();
+}
+
+static const char *
+buffering_to_string (ClutterFrameClockBuffering buffering)
+{
+  switch (buffering)
+    {
+    case CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE:
+      return "double";
+    case CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE:
+      return "triple";
+    }
+
+  g_assert_not_reached ();
+}
+
+/* Whether a frame is pending presentation while the next one is already
+ * scheduled or dispatched, in which case the timings of the former are kept
+ * in frame_clock->in_flight.
+ */
+static gboolean
+is_pipelining (ClutterFrameClock *frame_clock)
+{
+  switch (frame_clock->state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_INIT:
+    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      return FALSE;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
+      return TRUE;
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+save_in_flight_timings (ClutterFrameClock *frame_clock)
+{
+  frame_clock->in_flight.dispatch_time_us = frame_clock->last_dispatch_time_us;
+  frame_clock->in_flight.dispatch_lateness_us =
+    frame_clock->last_dispatch_lateness_us;
+  frame_clock->in_flight.flip_time_us = frame_clock->last_flip_time_us;
+  frame_clock->in_flight.is_next_presentation_time_valid =
+    frame_clock->is_next_presentation_time_valid;
+  frame_clock->in_flight.next_presentation_time_us =
+    frame_clock->next_presentation_time_us;
+}
+
+static void
+restore_in_flight_timings (ClutterFrameClock *frame_clock)
+{
+  frame_clock->last_dispatch_time_us = frame_clock->in_flight.dispatch_time_us;
+  frame_clock->last_dispatch_lateness_us =
+    frame_clock->in_flight.dispatch_lateness_us;
+  frame_clock->last_flip_time_us = frame_clock->in_flight.flip_time_us;
+  frame_clock->is_next_presentation_time_valid =
+    frame_clock->in_flight.is_next_presentation_time_valid;
+  frame_clock->next_presentation_time_us =
+    frame_clock->in_flight.next_presentation_time_us;
+}
+
+static void
+update_buffering (ClutterFrameClock *frame_clock)
+{
+  ClutterFrameClockBuffering buffering = frame_clock->buffering;
+  int64_t refresh_interval_us = frame_clock->refresh_interval_us;
+  int64_t update_duration_us;
+
+  update_duration_us = frame_clock->longterm_max_update_duration_us +
+                       frame_clock->vblank_duration_us;
+
+  if (frame_clock->mode != CLUTTER_FRAME_CLOCK_MODE_FIXED ||
+      frame_clock->policy == CLUTTER_FRAME_CLOCK_POLICY_LOW_LATENCY ||
+      G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING))
+    buffering = CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE;
+  else if (update_duration_us >
+           refresh_interval_us * TRIPLE_BUFFERING_ENTER_FRACTION)
+    buffering = CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE;
+  else if (update_duration_us <
+           refresh_interval_us * TRIPLE_BUFFERING_LEAVE_FRACTION)
+    buffering = CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE;
+
+  if (frame_clock->buffering == buffering)
+    return;
+
+  CLUTTER_NOTE (FRAME_CLOCK,
+                "Switching to %s buffering (update duration %ld µs, "
+                "refresh interval %ld µs)",
+                buffering_to_string (buffering),
+                update_duration_us,
+                refresh_interval_us);
+
+  frame_clock->buffering = buffering;
+  frame_clock->n_buffering_switches++;
+
+  if (buffering != CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE)
+    return;
+
+  /* Wait for the frame in flight again before dispatching the next one. */
+  switch (frame_clock->state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+      frame_clock->pending_reschedule = TRUE;
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->pending_reschedule_now = TRUE;
+      break;
+    default:
+      return;
+    }
+
+  restore_in_flight_timings (frame_clock);
+  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+  g_source_set_ready_time (frame_clock->source, -1);
+}
+
 static void
 maybe_update_longterm_max_duration_us (ClutterFrameClock *frame_clock,
                                        ClutterFrameInfo  *frame_info)
@@ -273,6 +473,133 @@ maybe_update_longterm_max_duration_us (ClutterFrameClock *frame_clock,
 
   frame_clock->shortterm_max_update_duration_us = 0;
   frame_clock->longterm_promotion_us = frame_info->presentation_time;
+
+  update_buffering (frame_clock);
+}
+
+static void
+finish_pending_frame (ClutterFrameClock *frame_clock)
+{
+  switch (frame_clock->state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_INIT:
+    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+      g_warn_if_reached ();
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+      maybe_reschedule_update (frame_clock);
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+      /* Reschedule relative to the presentation that just happened. */
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+      maybe_reschedule_update (frame_clock);
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->pending_reschedule_now = TRUE;
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+      maybe_reschedule_update (frame_clock);
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_DISPATCHING;
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+      maybe_reschedule_update (frame_clock);
+      break;
+    }
+}
+
+static void
+update_content_cadence (ClutterFrameClock *frame_clock,
+                        int64_t            dispatch_time_us)
+{
+  int64_t interval_us;
+
+  frame_clock->lfc.has_pending_content = TRUE;
+
+  if (frame_clock->lfc.last_content_dispatch_time_us)
+    {
+      interval_us =
+        dispatch_time_us - frame_clock->lfc.last_content_dispatch_time_us;
+
+      /* Start over when the content paused instead of just being slow. */
+      if (interval_us > 4 * frame_clock->minimum_refresh_interval_us)
+        frame_clock->lfc.content_interval_us = 0;
+      else if (!frame_clock->lfc.content_interval_us)
+        frame_clock->lfc.content_interval_us = interval_us;
+      else
+        frame_clock->lfc.content_interval_us +=
+          (interval_us - frame_clock->lfc.content_interval_us) / 4;
+    }
+
+  frame_clock->lfc.last_content_dispatch_time_us = dispatch_time_us;
+}
+
+static void
+maybe_schedule_repeat (ClutterFrameClock *frame_clock)
+{
+  int64_t min_frame_interval_us = frame_clock->refresh_interval_us;
+  int64_t max_frame_interval_us = frame_clock->minimum_refresh_interval_us;
+  int64_t content_interval_us = frame_clock->lfc.content_interval_us;
+  int64_t last_presentation_time_us = frame_clock->last_presentation_time_us;
+  int64_t expected_content_time_us;
+  int64_t repeat_interval_us;
+  int64_t repeat_time_us;
+  int64_t n_intervals;
+
+  if (frame_clock->mode != CLUTTER_FRAME_CLOCK_MODE_VARIABLE ||
+      frame_clock->state != CLUTTER_FRAME_CLOCK_STATE_IDLE ||
+      frame_clock->inhibit_count > 0)
+    return;
+
+  if (content_interval_us <= max_frame_interval_us ||
+      last_presentation_time_us == 0 ||
+      frame_clock->lfc.last_content_presentation_time_us == 0)
+    return;
+
+  /* Split the content interval evenly into intervals within the refresh
+   * rate range of the output, e.g. present 40 FPS content twice per frame at
+   * 80 Hz on a 48-144 Hz panel.
+   */
+  n_intervals = (content_interval_us + max_frame_interval_us - 1) /
+                max_frame_interval_us;
+  repeat_interval_us = content_interval_us / n_intervals;
+  if (repeat_interval_us < min_frame_interval_us)
+    return;
+
+  expected_content_time_us =
+    frame_clock->lfc.last_content_presentation_time_us + content_interval_us;
+
+  /* Leave it to the output when the content stopped following its cadence. */
+  if (last_presentation_time_us >
+      expected_content_time_us + 4 * max_frame_interval_us)
+    return;
+
+  repeat_time_us = last_presentation_time_us + repeat_interval_us;
+
+  /* Avoid a repeat still being presented when the next content update is
+   * predicted to arrive, as long as the output gets refreshed in time.
+   */
+  if (repeat_time_us + min_frame_interval_us > expected_content_time_us)
+    {
+      repeat_time_us = MAX (repeat_time_us,
+                            last_presentation_time_us +
+                            max_frame_interval_us - min_frame_interval_us);
+    }
+
+  frame_clock->lfc.is_repeat_scheduled = TRUE;
+
+  frame_clock->next_update_time_us = repeat_time_us;
+  frame_clock->is_next_presentation_time_valid = FALSE;
+  frame_clock->has_next_frame_deadline = FALSE;
+  g_source_set_ready_time (frame_clock->source, repeat_time_us);
+  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED;
 }
 
 void
@@ -281,13 +608,33 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
 {
   COGL_TRACE_BEGIN_SCOPED (ClutterFrameClockNotifyPresented,
                            "Clutter::FrameClock::presented()");
+  int64_t dispatch_time_us;
+  int64_t dispatch_lateness_us;
+  int64_t flip_time_us;
+
   COGL_TRACE_DESCRIBE (ClutterFrameClockNotifyPresented,
                        frame_clock->output_name);
 
-  frame_clock->last_next_presentation_time_us =
-    frame_clock->next_presentation_time_us;
-  frame_clock->has_last_next_presentation_time =
-    frame_clock->is_next_presentation_time_valid;
+  if (is_pipelining (frame_clock))
+    {
+      frame_clock->last_next_presentation_time_us =
+        frame_clock->in_flight.next_presentation_time_us;
+      frame_clock->has_last_next_presentation_time =
+        frame_clock->in_flight.is_next_presentation_time_valid;
+      dispatch_time_us = frame_clock->in_flight.dispatch_time_us;
+      dispatch_lateness_us = frame_clock->in_flight.dispatch_lateness_us;
+      flip_time_us = frame_clock->in_flight.flip_time_us;
+    }
+  else
+    {
+      frame_clock->last_next_presentation_time_us =
+        frame_clock->next_presentation_time_us;
+      frame_clock->has_last_next_presentation_time =
+        frame_clock->is_next_presentation_time_valid;
+      dispatch_time_us = frame_clock->last_dispatch_time_us;
+      dispatch_lateness_us = frame_clock->last_dispatch_lateness_us;
+      flip_time_us = frame_clock->last_flip_time_us;
+    }
 
   if (G_UNLIKELY (CLUTTER_HAS_DEBUG (FRAME_CLOCK)))
     {
@@ -366,6 +713,13 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
       frame_clock->last_presentation_flags = frame_info->flags;
     }
 
+  if (frame_clock->lfc.has_pending_content)
+    {
+      frame_clock->lfc.last_content_presentation_time_us =
+        frame_clock->last_presentation_time_us;
+      frame_clock->lfc.has_pending_content = FALSE;
+    }
+
   frame_clock->got_measurements_last_frame = FALSE;
 
   if (frame_info->cpu_time_before_buffer_swap_us != 0 &&
@@ -374,27 +728,28 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
       int64_t dispatch_to_swap_us, swap_to_rendering_done_us, swap_to_flip_us;
 
       dispatch_to_swap_us =
-        frame_info->cpu_time_before_buffer_swap_us -
-        frame_clock->last_dispatch_time_us;
+        frame_info->cpu_time_before_buffer_swap_us - dispatch_time_us;
       swap_to_rendering_done_us =
         frame_info->gpu_rendering_duration_ns / 1000;
       swap_to_flip_us =
-        frame_clock->last_flip_time_us -
-        frame_info->cpu_time_before_buffer_swap_us;
+        flip_time_us - frame_info->cpu_time_before_buffer_swap_us;
 
       CLUTTER_NOTE (FRAME_TIMINGS,
                     "update2dispatch %ld µs, dispatch2swap %ld µs, swap2render %ld µs, swap2flip %ld µs",
-                    frame_clock->last_dispatch_lateness_us,
+                    dispatch_lateness_us,
                     dispatch_to_swap_us,
                     swap_to_rendering_done_us,
                     swap_to_flip_us);
 
+      /* Allow measuring up to two refresh intervals, so that it's possible to
+       * tell whether triple buffering would keep up with the refresh rate.
+       */
       frame_clock->shortterm_max_update_duration_us =
-        CLAMP (frame_clock->last_dispatch_lateness_us + dispatch_to_swap_us +
+        CLAMP (dispatch_lateness_us + dispatch_to_swap_us +
                MAX (swap_to_rendering_done_us, swap_to_flip_us) +
                frame_clock->deadline_evasion_us,
                frame_clock->shortterm_max_update_duration_us,
-               frame_clock->refresh_interval_us);
+               2 * frame_clock->refresh_interval_us);
 
       maybe_update_longterm_max_duration_us (frame_clock, frame_info);
 
@@ -404,7 +759,7 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
   else
     {
       CLUTTER_NOTE (FRAME_TIMINGS, "update2dispatch %ld µs",
-                    frame_clock->last_dispatch_lateness_us);
+                    dispatch_lateness_us);
     }
 
   if (frame_info->refresh_rate > 1.0)
@@ -413,20 +768,8 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                                             frame_info->refresh_rate);
     }
 
-  switch (frame_clock->state)
-    {
-    case CLUTTER_FRAME_CLOCK_STATE_INIT:
-    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
-    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
-    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
-      g_warn_if_reached ();
-      break;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
-    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
-      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
-      maybe_reschedule_update (frame_clock);
-      break;
-    }
+  finish_pending_frame (frame_clock);
+  maybe_schedule_repeat (frame_clock);
 }
 
 void
@@ -435,20 +778,7 @@ clutter_frame_clock_notify_ready (ClutterFrameClock *frame_clock)
   COGL_TRACE_BEGIN_SCOPED (ClutterFrameClockNotifyReady, "Clutter::FrameClock::ready()");
   COGL_TRACE_DESCRIBE (ClutterFrameClockNotifyReady, frame_clock->output_name);
 
-  switch (frame_clock->state)
-    {
-    case CLUTTER_FRAME_CLOCK_STATE_INIT:
-    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
-    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
-    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
-      g_warn_if_reached ();
-      break;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
-    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
-      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
-      maybe_reschedule_update (frame_clock);
-      break;
-    }
+  finish_pending_frame (frame_clock);
 }
 
 static int64_t
@@ -482,11 +812,45 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
     frame_clock->vblank_duration_us +
     clutter_max_render_time_constant_us;
 
-  max_render_time_us = CLAMP (max_render_time_us, 0, refresh_interval_us);
+  /* With triple buffering, rendering a frame may overlap with the
+   * presentation of the previous one.
+   */
+  if (frame_clock->buffering == CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE)
+    max_render_time_us = CLAMP (max_render_time_us, 0, 2 * refresh_interval_us);
+  else
+    max_render_time_us = CLAMP (max_render_time_us, 0, refresh_interval_us);
 
   return max_render_time_us;
 }
 
+/*
+ * A frame clock following a sync leader with the same refresh rate aligns
+ * its updates to the presentation times of the leader rather than its
+ * own, so that the frames of all outputs in the group are driven in
+ * lockstep.
+ */
+static gboolean
+get_sync_leader_presentation_time (ClutterFrameClock *frame_clock,
+                                   int64_t           *out_presentation_time_us)
+{
+  ClutterFrameClock *leader = frame_clock->sync_leader;
+  int64_t interval_delta_us;
+
+  if (!leader || leader->last_presentation_time_us == 0)
+    return FALSE;
+
+  if (leader->mode != CLUTTER_FRAME_CLOCK_MODE_FIXED)
+    return FALSE;
+
+  interval_delta_us = leader->refresh_interval_us -
+                      frame_clock->refresh_interval_us;
+  if (ABS (interval_delta_us) > SYNC_LEADER_MAX_INTERVAL_DELTA_US)
+    return FALSE;
+
+  *out_presentation_time_us = leader->last_presentation_time_us;
+  return TRUE;
+}
+
 static void
 calculate_next_update_time_us (ClutterFrameClock *frame_clock,
                                int64_t           *out_next_update_time_us,
@@ -500,6 +864,8 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
   int64_t max_render_time_allowed_us;
   int64_t next_presentation_time_us;
   int64_t next_update_time_us;
+  gboolean has_frame_in_flight;
+  gboolean is_synced;
 
   now_us = g_get_monotonic_time ();
 
@@ -518,6 +884,9 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
       return;
     }
 
+  has_frame_in_flight =
+    frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+
   min_render_time_allowed_us = refresh_interval_us / 2;
   max_render_time_allowed_us =
     clutter_frame_clock_compute_max_render_time_us (frame_clock);
@@ -542,7 +911,10 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
    * 0
    *
    */
-  last_presentation_time_us = frame_clock->last_presentation_time_us;
+  is_synced = get_sync_leader_presentation_time (frame_clock,
+                                                 &last_presentation_time_us);
+  if (!is_synced)
+    last_presentation_time_us = frame_clock->last_presentation_time_us;
   next_presentation_time_us = last_presentation_time_us + refresh_interval_us;
 
   /*
@@ -609,7 +981,22 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
         }
     }
 
-  if (frame_clock->last_presentation_flags & CLUTTER_FRAME_INFO_FLAG_VSYNC &&
+  if (has_frame_in_flight &&
+      frame_clock->in_flight.is_next_presentation_time_valid)
+    {
+      /*
+       * With triple buffering, the frame in flight will take the presentation
+       * it was aimed at, so aim for one after that.
+       */
+      while (next_presentation_time_us <=
+             frame_clock->in_flight.next_presentation_time_us)
+        next_presentation_time_us += refresh_interval_us;
+    }
+
+  if (!is_synced &&
+      !has_frame_in_flight &&
+      frame_clock->policy != CLUTTER_FRAME_CLOCK_POLICY_FIXED_PHASE &&
+      frame_clock->last_presentation_flags & CLUTTER_FRAME_INFO_FLAG_VSYNC &&
       next_presentation_time_us != last_presentation_time_us + refresh_interval_us)
     {
       /* There was an idle period since the last presentation, so there seems
@@ -742,8 +1129,21 @@ clutter_frame_clock_inhibit (ClutterFrameClock *frame_clock)
           frame_clock->pending_reschedule_now = TRUE;
           frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
           break;
+        case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+          frame_clock->pending_reschedule = TRUE;
+          restore_in_flight_timings (frame_clock);
+          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+          break;
+        case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+          frame_clock->pending_reschedule = TRUE;
+          frame_clock->pending_reschedule_now = TRUE;
+          restore_in_flight_timings (frame_clock);
+          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+          break;
         case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
         case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+        case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+        case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
           break;
         }
 
@@ -766,6 +1166,7 @@ void
 clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
 {
   int64_t next_update_time_us = -1;
+  ClutterFrameClockState next_state;
 
   if (frame_clock->inhibit_count > 0)
     {
@@ -779,11 +1180,29 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
     case CLUTTER_FRAME_CLOCK_STATE_INIT:
     case CLUTTER_FRAME_CLOCK_STATE_IDLE:
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+      next_state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW;
       break;
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
       return;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      if (frame_clock->buffering == CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE)
+        {
+          save_in_flight_timings (frame_clock);
+          next_state =
+            CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW;
+          break;
+        }
+
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->pending_reschedule_now = TRUE;
+      return;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+      next_state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW;
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
       frame_clock->pending_reschedule = TRUE;
       frame_clock->pending_reschedule_now = TRUE;
       return;
@@ -812,13 +1231,14 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
 
   frame_clock->next_update_time_us = next_update_time_us;
   g_source_set_ready_time (frame_clock->source, next_update_time_us);
-  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW;
+  frame_clock->state = next_state;
 }
 
 void
 clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
 {
   int64_t next_update_time_us = -1;
+  ClutterFrameClockState next_state;
 
   if (frame_clock->inhibit_count > 0)
     {
@@ -834,12 +1254,26 @@ clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
       frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED;
       return;
     case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+      next_state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED;
       break;
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
       return;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      if (frame_clock->buffering == CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE)
+        {
+          save_in_flight_timings (frame_clock);
+          next_state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED;
+          break;
+        }
+
+      frame_clock->pending_reschedule = TRUE;
+      return;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
       frame_clock->pending_reschedule = TRUE;
       return;
     }
@@ -868,7 +1302,13 @@ clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
 
   frame_clock->next_update_time_us = next_update_time_us;
   g_source_set_ready_time (frame_clock->source, next_update_time_us);
-  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED;
+  frame_clock->state = next_state;
+}
+
+ClutterFrameClockMode
+clutter_frame_clock_get_mode (ClutterFrameClock *frame_clock)
+{
+  return frame_clock->mode;
 }
 
 void
@@ -880,6 +1320,9 @@ clutter_frame_clock_set_mode (ClutterFrameClock     *frame_clock,
 
   frame_clock->mode = mode;
 
+  memset (&frame_clock->lfc, 0, sizeof (frame_clock->lfc));
+  update_buffering (frame_clock);
+
   switch (frame_clock->state)
     {
     case CLUTTER_FRAME_CLOCK_STATE_INIT:
@@ -896,18 +1339,68 @@ clutter_frame_clock_set_mode (ClutterFrameClock     *frame_clock,
       break;
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
       break;
     }
 
   maybe_reschedule_update (frame_clock);
 }
 
+ClutterFrameClockPolicy
+clutter_frame_clock_get_policy (ClutterFrameClock *frame_clock)
+{
+  return frame_clock->policy;
+}
+
+void
+clutter_frame_clock_set_policy (ClutterFrameClock       *frame_clock,
+                                ClutterFrameClockPolicy  policy)
+{
+  if (frame_clock->policy == policy)
+    return;
+
+  frame_clock->policy = policy;
+
+  /* The next update is scheduled according to the new policy; only the
+   * buffering needs to be reconsidered right away. */
+  update_buffering (frame_clock);
+}
+
+static void
+update_source_priority (ClutterFrameClock *frame_clock,
+                        int64_t            ready_time_us,
+                        int64_t            time_us)
+{
+  int64_t max_delay_us;
+  int priority;
+
+  max_delay_us = (int64_t) (frame_clock->refresh_interval_us *
+                            STARVED_DISPATCH_FRACTION);
+
+  if (ready_time_us != -1 && time_us - ready_time_us > max_delay_us)
+    frame_clock->last_starved_dispatch_time_us = time_us;
+
+  if (frame_clock->last_starved_dispatch_time_us &&
+      time_us - frame_clock->last_starved_dispatch_time_us <
+      STARVED_DISPATCH_BOOST_US)
+    priority = CLUTTER_PRIORITY_EVENTS;
+  else
+    priority = CLUTTER_PRIORITY_REDRAW;
+
+  if (g_source_get_priority (frame_clock->source) != priority)
+    g_source_set_priority (frame_clock->source, priority);
+}
+
 static void
 clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
                               int64_t            time_us)
 {
   const ClutterFrameListenerIface *iface = frame_clock->listener.iface;
   g_autoptr (ClutterFrame) frame = NULL;
+  ClutterFrameClockState scheduled_state = frame_clock->state;
   int64_t frame_count;
   ClutterFrameResult result;
   int64_t ideal_dispatch_time_us, lateness_us;
@@ -953,9 +1446,15 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
 #endif
 
   frame_clock->last_dispatch_time_us = time_us;
+  update_source_priority (frame_clock,
+                          g_source_get_ready_time (frame_clock->source),
+                          time_us);
   g_source_set_ready_time (frame_clock->source, -1);
 
-  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_DISPATCHING;
+  if (is_pipelining (frame_clock))
+    frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING;
+  else
+    frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_DISPATCHING;
 
   frame_count = frame_clock->frame_count++;
 
@@ -971,6 +1470,15 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
   frame->has_frame_deadline = frame_clock->has_next_frame_deadline;
   frame->frame_deadline_us = frame_clock->next_frame_deadline_us;
 
+  if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_VARIABLE)
+    {
+      if (scheduled_state == CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW)
+        update_content_cadence (frame_clock, time_us);
+
+      frame->is_repeat = frame_clock->lfc.is_repeat_scheduled;
+    }
+  frame_clock->lfc.is_repeat_scheduled = FALSE;
+
   COGL_TRACE_BEGIN_SCOPED (ClutterFrameClockEvents, "Clutter::FrameListener::before_frame()");
   if (iface->before_frame)
     iface->before_frame (frame_clock, frame, frame_clock->listener.user_data);
@@ -990,6 +1498,9 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
     {
     case CLUTTER_FRAME_CLOCK_STATE_INIT:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_SCHEDULED_NOW:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO:
       g_warn_if_reached ();
       break;
     case CLUTTER_FRAME_CLOCK_STATE_IDLE:
@@ -1001,6 +1512,8 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
         {
         case CLUTTER_FRAME_RESULT_PENDING_PRESENTED:
           frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+          if (frame_clock->buffering == CLUTTER_FRAME_CLOCK_BUFFERING_TRIPLE)
+            maybe_reschedule_update (frame_clock);
           break;
         case CLUTTER_FRAME_RESULT_IDLE:
           frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
@@ -1008,6 +1521,20 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
           break;
         }
       break;
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING:
+      switch (result)
+        {
+        case CLUTTER_FRAME_RESULT_PENDING_PRESENTED:
+          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_TWO;
+          break;
+        case CLUTTER_FRAME_RESULT_IDLE:
+          /* Nothing was drawn, the frame in flight is still the latest one. */
+          restore_in_flight_timings (frame_clock);
+          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+          maybe_reschedule_update (frame_clock);
+          break;
+        }
+      break;
     }
 
 #ifdef HAVE_PROFILER
@@ -1065,10 +1592,27 @@ clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clo
 
   g_string_append_printf (string, "\nVblank duration: %ld µs +",
                           frame_clock->vblank_duration_us);
-  g_string_append_printf (string, "\nUpdate duration: %ld µs +",
-                          max_update_duration_us);
+  g_string_append_printf (string,
+                          "\nUpdate duration: %ld µs "
+                          "(including %ld µs deadline evasion) +",
+                          max_update_duration_us,
+                          frame_clock->deadline_evasion_us);
   g_string_append_printf (string, "\nConstant: %d µs",
                           clutter_max_render_time_constant_us);
+  g_string_append_printf (string, "\nBuffering: %s (%d switches)",
+                          buffering_to_string (frame_clock->buffering),
+                          frame_clock->n_buffering_switches);
+  g_string_append_printf (string, "\nPolicy: %s",
+                          policy_to_string (frame_clock->policy));
+
+  if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_VARIABLE)
+    {
+      g_string_append_printf (string,
+                              "\nContent interval: %ld µs "
+                              "(minimum refresh interval %ld µs)",
+                              frame_clock->lfc.content_interval_us,
+                              frame_clock->minimum_refresh_interval_us);
+    }
 
   return string;
 }
@@ -1219,7 +1763,9 @@ clutter_frame_clock_dispose (GObject *object)
 {
   ClutterFrameClock *frame_clock = CLUTTER_FRAME_CLOCK (object);
 
-  g_warn_if_fail (frame_clock->state != CLUTTER_FRAME_CLOCK_STATE_DISPATCHING);
+  g_warn_if_fail (frame_clock->state != CLUTTER_FRAME_CLOCK_STATE_DISPATCHING &&
+                  frame_clock->state !=
+                  CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED_AND_DISPATCHING);
 
   if (frame_clock->source)
     {
@@ -1229,6 +1775,7 @@ clutter_frame_clock_dispose (GObject *object)
     }
 
   g_clear_pointer (&frame_clock->output_name, g_free);
+  g_clear_weak_pointer (&frame_clock->sync_leader);
 
   G_OBJECT_CLASS (clutter_frame_clock_parent_class)->dispose (object);
 }
@@ -1238,6 +1785,7 @@ clutter_frame_clock_init (ClutterFrameClock *frame_clock)
 {
   frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_INIT;
   frame_clock->mode = CLUTTER_FRAME_CLOCK_MODE_FIXED;
+  frame_clock->buffering = CLUTTER_FRAME_CLOCK_BUFFERING_DOUBLE;
 }
 
 static void
@@ -1263,3 +1811,20 @@ clutter_frame_clock_set_deadline_evasion (ClutterFrameClock *frame_clock,
 {
   frame_clock->deadline_evasion_us = deadline_evasion_us;
 }
+
+/**
+ * clutter_frame_clock_set_sync_leader: (skip)
+ * @frame_clock: a #ClutterFrameClock
+ * @sync_leader: (nullable): the frame clock to follow
+ *
+ * Makes @frame_clock schedule its updates in phase with the presentations
+ * of @sync_leader, as long as both run at the same fixed refresh rate.
+ */
+void
+clutter_frame_clock_set_sync_leader (ClutterFrameClock *frame_clock,
+                                     ClutterFrameClock *sync_leader)
+{
+  g_return_if_fail (sync_leader != frame_clock);
+
+  g_set_weak_pointer (&frame_clock->sync_leader, sync_leader);
+}
@@ -60,6 +60,27 @@ typedef enum _ClutterFrameClockMode
   CLUTTER_FRAME_CLOCK_MODE_VARIABLE,
 } ClutterFrameClockMode;
 
+/**
+ * ClutterFrameClockPolicy:
+ * @CLUTTER_FRAME_CLOCK_POLICY_DEFAULT: Switch between double and triple
+ *   buffering depending on the update duration, and start updating right
+ *   away after an idle period.
+ * @CLUTTER_FRAME_CLOCK_POLICY_LOW_LATENCY: Never use triple buffering, so
+ *   that no frame waits for another one in flight, at the risk of missing
+ *   presentations when updates take long.
+ * @CLUTTER_FRAME_CLOCK_POLICY_FIXED_PHASE: Always start updating at the
+ *   same offset before the presentation, also after an idle period, so that
+ *   updates stay in phase with the refresh cycle.
+ *
+ * How a frame clock in fixed mode schedules its updates.
+ */
+typedef enum _ClutterFrameClockPolicy
+{
+  CLUTTER_FRAME_CLOCK_POLICY_DEFAULT,
+  CLUTTER_FRAME_CLOCK_POLICY_LOW_LATENCY,
+  CLUTTER_FRAME_CLOCK_POLICY_FIXED_PHASE,
+} ClutterFrameClockPolicy;
+
 CLUTTER_EXPORT
 ClutterFrameClock * clutter_frame_clock_new (float                            refresh_rate,
                                              int64_t                          vblank_duration_us,
@@ -74,6 +95,16 @@ CLUTTER_EXPORT
 void clutter_frame_clock_set_mode (ClutterFrameClock     *frame_clock,
                                    ClutterFrameClockMode  mode);
 
+CLUTTER_EXPORT
+ClutterFrameClockMode clutter_frame_clock_get_mode (ClutterFrameClock *frame_clock);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_policy (ClutterFrameClock       *frame_clock,
+                                     ClutterFrameClockPolicy  policy);
+
+CLUTTER_EXPORT
+ClutterFrameClockPolicy clutter_frame_clock_get_policy (ClutterFrameClock *frame_clock);
+
 CLUTTER_EXPORT
 void clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                                            ClutterFrameInfo  *frame_info);
@@ -102,11 +133,20 @@ void clutter_frame_clock_remove_timeline (ClutterFrameClock *frame_clock,
 CLUTTER_EXPORT
 float clutter_frame_clock_get_refresh_rate (ClutterFrameClock *frame_clock);
 
+CLUTTER_EXPORT
+void clutter_frame_clock_set_minimum_refresh_rate (ClutterFrameClock *frame_clock,
+                                                   float              minimum_refresh_rate);
+
 void clutter_frame_clock_record_flip_time (ClutterFrameClock *frame_clock,
                                            int64_t            flip_time_us);
 
+CLUTTER_EXPORT
 GString * clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clock);
 
 CLUTTER_EXPORT
 void clutter_frame_clock_set_deadline_evasion (ClutterFrameClock *frame_clock,
                                                int64_t            deadline_evasion_us);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_sync_leader (ClutterFrameClock *frame_clock,
+                                          ClutterFrameClock *sync_leader);
@@ -34,6 +34,8 @@ struct _ClutterFrame
   gboolean has_frame_deadline;
   int64_t frame_deadline_us;
 
+  gboolean is_repeat;
+
   gboolean has_result;
   ClutterFrameResult result;
 };
@@ -53,6 +53,8 @@ gpointer
   g_ref_count_init (&frame->ref_count);
   frame->release = release;
 
+  COGL_TRACE_ALLOCATION (frame, size);
+
   return frame;
 }
 
@@ -92,6 +94,12 @@ clutter_frame_get_frame_deadline (ClutterFrame *frame,
     }
 }
 
+gboolean
+clutter_frame_is_repeat (ClutterFrame *frame)
+{
+  return frame->is_repeat;
+}
+
 ClutterFrameResult
 clutter_frame_get_result (ClutterFrame *frame)
 {
@@ -47,6 +47,9 @@ CLUTTER_EXPORT
 gboolean clutter_frame_get_frame_deadline (ClutterFrame *frame,
                                            int64_t      *frame_deadline_us);
 
+CLUTTER_EXPORT
+gboolean clutter_frame_is_repeat (ClutterFrame *frame);
+
 CLUTTER_EXPORT
 void clutter_frame_set_result (ClutterFrame       *frame,
                                ClutterFrameResult  result);
@@ -69,6 +69,7 @@ G_DECLARE_FINAL_TYPE (ClutterGridChild,
 typedef struct _ClutterGridAttach       ClutterGridAttach;
 typedef struct _ClutterGridLine         ClutterGridLine;
 typedef struct _ClutterGridLines        ClutterGridLines;
+typedef struct _ClutterGridLineCache    ClutterGridLineCache;
 typedef struct _ClutterGridLineData     ClutterGridLineData;
 typedef struct _ClutterGridRequest      ClutterGridRequest;
 
@@ -100,6 +101,19 @@ struct _ClutterGridLineData
   guint homogeneous : 1;
 };
 
+/* A ClutterGridLineCache struct keeps the non-contextual line
+ * requests of one orientation, which only depend on the children
+ * and not on the size the grid is measured or allocated for.
+ */
+struct _ClutterGridLineCache
+{
+  ClutterGridLine *lines;
+  gint min, max;
+
+  uint64_t relayout_serial;
+  guint valid : 1;
+};
+
 struct _ClutterGridLayout
 {
   ClutterLayoutManager parent_instance;
@@ -108,6 +122,7 @@ struct _ClutterGridLayout
   ClutterOrientation orientation;
 
   ClutterGridLineData linedata[2];
+  ClutterGridLineCache line_cache[2];
 };
 
 #define ROWS(priv)    (&(priv)->linedata[CLUTTER_ORIENTATION_HORIZONTAL])
@@ -884,6 +899,61 @@ clutter_grid_request_run (ClutterGridRequest *request,
   clutter_grid_request_homogeneous (request, orientation);
 }
 
+/* Like clutter_grid_request_run() without context, but reuses the
+ * line requests of the previous run as long as no relayout has been
+ * queued on the container, i.e. none of the children changed, since.
+ */
+static void
+clutter_grid_request_run_cached (ClutterGridRequest *request,
+                                 ClutterOrientation  orientation)
+{
+  ClutterGridLayout *grid = request->grid;
+  ClutterGridLineCache *cache;
+  ClutterGridLines *lines;
+  uint64_t relayout_serial;
+  gint n_lines;
+
+  cache = &grid->line_cache[orientation];
+  lines = &request->lines[orientation];
+  n_lines = lines->max - lines->min;
+  relayout_serial = clutter_actor_get_relayout_serial (grid->container);
+
+  if (cache->valid &&
+      cache->relayout_serial == relayout_serial &&
+      cache->min == lines->min &&
+      cache->max == lines->max)
+    {
+      memcpy (lines->lines, cache->lines, n_lines * sizeof (ClutterGridLine));
+      return;
+    }
+
+  clutter_grid_request_run (request, orientation, FALSE);
+
+  g_clear_pointer (&cache->lines, g_free);
+  cache->valid = FALSE;
+
+  if (n_lines <= 0)
+    return;
+
+  cache->lines = g_memdup2 (lines->lines, n_lines * sizeof (ClutterGridLine));
+  cache->min = lines->min;
+  cache->max = lines->max;
+  cache->relayout_serial = relayout_serial;
+  cache->valid = TRUE;
+}
+
+static void
+clutter_grid_layout_clear_line_cache (ClutterGridLayout *self)
+{
+  int i;
+
+  for (i = 0; i < 2; i++)
+    {
+      g_clear_pointer (&self->line_cache[i].lines, g_free);
+      self->line_cache[i].valid = FALSE;
+    }
+}
+
 typedef struct _RequestedSize
 {
   gpointer data;
@@ -1253,6 +1323,7 @@ clutter_grid_layout_set_container (ClutterLayoutManager *self,
   ClutterLayoutManagerClass *parent_class;
 
   grid->container = container;
+  clutter_grid_layout_clear_line_cache (grid);
 
   if (grid->container != NULL)
     {
@@ -1295,7 +1366,7 @@ clutter_grid_layout_get_size_for_size (ClutterGridLayout  *self,
   lines->lines = g_newa (ClutterGridLine, lines->max - lines->min);
   memset (lines->lines, 0, (lines->max - lines->min) * sizeof (ClutterGridLine));
 
-  clutter_grid_request_run (&request, 1 - orientation, FALSE);
+  clutter_grid_request_run_cached (&request, 1 - orientation);
   clutter_grid_request_sum (&request, 1 - orientation, &min_size, &nat_size);
   clutter_grid_request_allocate (&request, 1 - orientation, MAX (size, nat_size));
 
@@ -1402,7 +1473,7 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
   else
     orientation = CLUTTER_ORIENTATION_VERTICAL;
 
-  clutter_grid_request_run (&request, 1 - orientation, FALSE);
+  clutter_grid_request_run_cached (&request, 1 - orientation);
   clutter_grid_request_allocate (&request, 1 - orientation, GET_SIZE (allocation, 1 - orientation));
   clutter_grid_request_run (&request, orientation, TRUE);
 
@@ -1522,6 +1593,16 @@ clutter_grid_layout_get_property (GObject    *gobject,
     }
 }
 
+static void
+clutter_grid_layout_finalize (GObject *gobject)
+{
+  ClutterGridLayout *self = CLUTTER_GRID_LAYOUT (gobject);
+
+  clutter_grid_layout_clear_line_cache (self);
+
+  G_OBJECT_CLASS (clutter_grid_layout_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 {
@@ -1532,6 +1613,7 @@ clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 
   object_class->set_property = clutter_grid_layout_set_property;
   object_class->get_property = clutter_grid_layout_get_property;
+  object_class->finalize = clutter_grid_layout_finalize;
 
   layout_class->set_container = clutter_grid_layout_set_container;
   layout_class->get_preferred_width = clutter_grid_layout_get_preferred_width;
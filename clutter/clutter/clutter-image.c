@@ -338,6 +338,8 @@ clutter_image_set_bytes (ClutterImage     *image,
  * #ClutterImage will be the equivalent of calling [method@Clutter.Image.set_data].
  *
  * If the image data was successfully loaded, the @image will be invalidated.
+ * When updating an existing texture, only @rect is uploaded, and only the
+ * part of the actors using @image that @rect is painted to is redrawn.
  *
  * In case of error, the @error value will be set, and this function will
  * return %FALSE.
@@ -388,7 +390,12 @@ clutter_image_set_area (ClutterImage        *image,
       if (!res)
         {
           g_clear_object (&priv->texture);
+          return FALSE;
         }
+
+      _clutter_content_invalidate_area (CLUTTER_CONTENT (image), area);
+
+      return TRUE;
     }
 
   if (priv->texture == NULL)
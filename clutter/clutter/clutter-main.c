@@ -833,6 +833,8 @@ _clutter_clear_events_queue (void)
 
   while ((event = g_async_queue_try_pop_unlocked (context->events_queue)))
     clutter_event_free (event);
+  context->coalescable_motion = NULL;
+  g_ptr_array_set_size (context->coalescable_touch_updates, 0);
 
   events_queue = context->events_queue;
   context->events_queue = NULL;
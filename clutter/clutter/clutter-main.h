@@ -62,6 +62,7 @@ typedef enum
 typedef enum
 {
   CLUTTER_DEBUG_NOP_PICKING = 1 << 0,
+  CLUTTER_DEBUG_DISABLE_PICK_CACHE = 1 << 1,
 } ClutterPickDebugFlag;
 
 typedef enum
@@ -77,6 +78,12 @@ typedef enum
   CLUTTER_DEBUG_PAINT_DAMAGE_REGION             = 1 << 8,
   CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME = 1 << 9,
   CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME           = 1 << 10,
+  CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES    = 1 << 11,
+  CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_TILES   = 1 << 12,
+  CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING        = 1 << 13,
+  CLUTTER_DEBUG_BAKE_COLOR_TRANSFORMS           = 1 << 14,
+  CLUTTER_DEBUG_REDRAW_ACTORS                   = 1 << 15,
+  CLUTTER_DEBUG_GPU_PHASES                      = 1 << 16,
 } ClutterDrawDebugFlag;
 
 /**
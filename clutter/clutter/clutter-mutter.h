@@ -26,6 +26,7 @@
 
 #include "clutter/clutter-backend.h"
 #include "clutter/clutter-backend-private.h"
+#include "clutter/clutter-blur-private.h"
 #include "clutter/clutter-damage-history.h"
 #include "clutter/clutter-event-private.h"
 #include "clutter/clutter-frame-private.h"
@@ -82,6 +83,9 @@ gboolean clutter_actor_has_damage (ClutterActor *actor);
 CLUTTER_EXPORT
 gboolean clutter_actor_has_transitions (ClutterActor *actor);
 
+CLUTTER_EXPORT
+void clutter_actor_invalidate_pick (ClutterActor *self);
+
 CLUTTER_EXPORT
 ClutterFrameClock * clutter_actor_pick_frame_clock (ClutterActor  *self,
                                                     ClutterActor **out_actor);
@@ -122,6 +122,13 @@ typedef struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  /* The resource scale and stage size the fbo contents were last painted
+   * with; together with the target size and offset they tell whether the
+   * cached contents can be reused when the actor isn't dirty. */
+  float cached_resource_scale;
+  float cached_stage_width;
+  float cached_stage_height;
+
   gulong purge_handler_id;
 } ClutterOffscreenEffectPrivate;
 
@@ -213,6 +220,33 @@ video_memory_purged (ClutterOffscreenEffect *self)
   g_clear_object (&priv->offscreen);
 }
 
+static void
+clear_offscreen_texture (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+
+  if (priv->texture)
+    cogl_texture_set_evict_func (priv->texture, NULL, NULL);
+  g_clear_object (&priv->texture);
+}
+
+static void
+offscreen_texture_evicted (CoglTexture *texture,
+                           gpointer     user_data)
+{
+  ClutterOffscreenEffect *self = user_data;
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+
+  /* The texture is re-created on the next pre-paint */
+  g_clear_object (&priv->offscreen);
+  g_clear_object (&priv->pipeline);
+  g_clear_object (&priv->texture);
+  priv->target_width = 0;
+  priv->target_height = 0;
+}
+
 static gboolean
 update_fbo (ClutterEffect *effect,
             int            target_width,
@@ -266,7 +300,7 @@ update_fbo (ClutterEffect *effect,
       return TRUE;
     }
 
-  g_clear_object (&priv->texture);
+  clear_offscreen_texture (self);
   g_clear_object (&priv->offscreen);
 
   context = clutter_actor_get_context (priv->actor);
@@ -301,41 +335,41 @@ update_fbo (ClutterEffect *effect,
   g_clear_object (&priv->pipeline);
   priv->pipeline = offscreen_class->create_pipeline (self, priv->texture);
 
+  cogl_texture_set_evict_func (priv->texture, offscreen_texture_evicted, self);
+
   return TRUE;
 }
 
-static gboolean
-clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
-                                    ClutterPaintNode    *node,
-                                    ClutterPaintContext *paint_context)
+typedef struct
+{
+  int fbo_offset_x;
+  int fbo_offset_y;
+  float target_width;
+  float target_height;
+  float stage_width;
+  float stage_height;
+  float resource_scale;
+} OffscreenTarget;
+
+static void
+calculate_target (ClutterOffscreenEffect *self,
+                  OffscreenTarget        *target)
 {
-  ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (effect);
   ClutterOffscreenEffectPrivate *priv =
     clutter_offscreen_effect_get_instance_private (self);
-  CoglFramebuffer *offscreen;
   ClutterActorBox raw_box, box;
   ClutterActor *stage;
-  graphene_matrix_t projection, modelview, transform;
   const ClutterPaintVolume *volume;
-  gfloat stage_width, stage_height;
-  gfloat target_width = -1, target_height = -1;
-  float resource_scale;
   float ceiled_resource_scale;
 
-  if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)))
-    goto disable_effect;
-
-  if (priv->actor == NULL)
-    goto disable_effect;
-
   stage = _clutter_actor_get_stage_internal (priv->actor);
-  clutter_actor_get_size (stage, &stage_width, &stage_height);
+  clutter_actor_get_size (stage, &target->stage_width, &target->stage_height);
 
-  resource_scale = clutter_actor_get_real_resource_scale (priv->actor);
+  target->resource_scale = clutter_actor_get_real_resource_scale (priv->actor);
 
-  ceiled_resource_scale = ceilf (resource_scale);
-  stage_width *= ceiled_resource_scale;
-  stage_height *= ceiled_resource_scale;
+  ceiled_resource_scale = ceilf (target->resource_scale);
+  target->stage_width *= ceiled_resource_scale;
+  target->stage_height *= ceiled_resource_scale;
 
   /* Get the minimal bounding box for what we want to paint, relative to the
    * parent of priv->actor. Note that we may actually be painting a clone of
@@ -355,8 +389,8 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
       box = raw_box;
       _clutter_actor_box_enlarge_for_effects (&box);
 
-      priv->fbo_offset_x = (int) box.x1;
-      priv->fbo_offset_y = (int) box.y1;
+      target->fbo_offset_x = (int) box.x1;
+      target->fbo_offset_y = (int) box.y1;
     }
   else
     {
@@ -365,22 +399,99 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
       box = raw_box;
       _clutter_actor_box_enlarge_for_effects (&box);
 
-      priv->fbo_offset_x = (int) (box.x1 - raw_box.x1);
-      priv->fbo_offset_y = (int) (box.y1 - raw_box.y1);
+      target->fbo_offset_x = (int) (box.x1 - raw_box.x1);
+      target->fbo_offset_y = (int) (box.y1 - raw_box.y1);
     }
 
   clutter_actor_box_scale (&box, ceiled_resource_scale);
-  clutter_actor_box_get_size (&box, &target_width, &target_height);
+  clutter_actor_box_get_size (&box, &target->target_width, &target->target_height);
 
-  target_width = ceilf (target_width);
-  target_height = ceilf (target_height);
+  target->target_width = ceilf (target->target_width);
+  target->target_height = ceilf (target->target_height);
+}
+
+/* Whether the fbo still holds what painting the actor now would produce,
+ * given that the actor itself isn't dirty: the paint volume, the resource
+ * scale and the stage projection must all be unchanged.
+ */
+static gboolean
+is_cached_offscreen_valid (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  OffscreenTarget target;
+
+  if (priv->offscreen == NULL || priv->actor == NULL || priv->stage == NULL)
+    return FALSE;
+
+  if (_clutter_actor_get_stage_internal (priv->actor) != priv->stage)
+    return FALSE;
+
+  calculate_target (self, &target);
+
+  return (target.fbo_offset_x == priv->fbo_offset_x &&
+          target.fbo_offset_y == priv->fbo_offset_y &&
+          (int) target.target_width == priv->target_width &&
+          (int) target.target_height == priv->target_height &&
+          G_APPROX_VALUE (target.resource_scale,
+                          priv->cached_resource_scale, FLT_EPSILON) &&
+          G_APPROX_VALUE (target.stage_width,
+                          priv->cached_stage_width, FLT_EPSILON) &&
+          G_APPROX_VALUE (target.stage_height,
+                          priv->cached_stage_height, FLT_EPSILON));
+}
+
+static gboolean
+clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
+                                    ClutterPaintNode    *node,
+                                    ClutterPaintContext *paint_context)
+{
+  ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (effect);
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  CoglFramebuffer *offscreen;
+  graphene_matrix_t projection, modelview, transform;
+  OffscreenTarget target;
+  gfloat stage_width, stage_height;
+  gfloat target_width, target_height;
+  float resource_scale;
+
+  if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)))
+    goto disable_effect;
+
+  if (priv->actor == NULL)
+    goto disable_effect;
+
+  calculate_target (self, &target);
+
+  priv->fbo_offset_x = target.fbo_offset_x;
+  priv->fbo_offset_y = target.fbo_offset_y;
+  target_width = target.target_width;
+  target_height = target.target_height;
+  stage_width = target.stage_width;
+  stage_height = target.stage_height;
+  resource_scale = target.resource_scale;
 
   /* First assert that the framebuffer is the right size... */
   if (!update_fbo (effect, (int) target_width, (int) target_height, resource_scale))
     goto disable_effect;
 
+  /* Don't stall the frame on compiling the shaders of an effect that is
+   * used for the first time; paint the actor without the effect until
+   * the driver has finished building them in the background.
+   */
+  if (!cogl_pipeline_precompile (priv->pipeline))
+    {
+      clutter_actor_queue_redraw (priv->actor);
+      return FALSE;
+    }
+
   offscreen = COGL_FRAMEBUFFER (priv->offscreen);
 
+  priv->cached_resource_scale = resource_scale;
+  priv->cached_stage_width = stage_width;
+  priv->cached_stage_height = stage_height;
+
   /* We don't want the FBO contents to be transformed. That could waste memory
    * (e.g. during zoom), or result in something that's not rectangular (clipped
    * incorrectly). So drop the modelview matrix of the current paint chain.
@@ -568,12 +679,17 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
     }
 
   /* If we've already got a cached image and the actor hasn't been redrawn
-   * then we can just use the cached image in the FBO.
+   * then we can just use the cached image in the FBO, as long as it was
+   * painted for the same paint volume, resource scale and stage size.
    */
-  if (priv->offscreen == NULL || (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY))
+  if ((flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY) ||
+      !is_cached_offscreen_valid (self))
     parent_class->paint (effect, node, paint_context, flags);
   else
     clutter_offscreen_effect_paint_texture (self, node, paint_context);
+
+  if (priv->texture)
+    cogl_texture_mark_used (priv->texture);
 }
 
 static void
@@ -599,7 +715,7 @@ clutter_offscreen_effect_finalize (GObject *gobject)
     clutter_offscreen_effect_get_instance_private (self);
 
   g_clear_object (&priv->offscreen);
-  g_clear_object (&priv->texture);
+  clear_offscreen_texture (self);
   g_clear_object (&priv->pipeline);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
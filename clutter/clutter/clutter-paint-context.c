@@ -59,6 +59,8 @@ clutter_paint_context_new_for_view (ClutterStageView *view,
 
   paint_context = g_new0 (ClutterPaintContext, 1);
   g_ref_count_init (&paint_context->ref_count);
+
+  COGL_TRACE_ALLOCATION (paint_context, sizeof (ClutterPaintContext));
   paint_context->view = view;
   paint_context->redraw_clip = mtk_region_copy (redraw_clip);
   paint_context->clip_frusta = g_array_ref (clip_frusta);
@@ -90,6 +92,8 @@ clutter_paint_context_new_for_framebuffer (CoglFramebuffer   *framebuffer,
 
   paint_context = g_new0 (ClutterPaintContext, 1);
   g_ref_count_init (&paint_context->ref_count);
+
+  COGL_TRACE_ALLOCATION (paint_context, sizeof (ClutterPaintContext));
   paint_context->paint_flags = paint_flags;
   g_set_object (&paint_context->framebuffer_color_state, color_state);
 
@@ -59,6 +59,46 @@
 
 static inline void      clutter_paint_operation_clear   (ClutterPaintOperation *op);
 
+/* The render graph is rebuilt and thrown away on every frame, so the
+ * arrays backing paint operations are recycled rather than reallocated
+ * each time. Arrays that grew large are not kept, so the pools don't
+ * hold on to memory after an unusually heavy frame.
+ */
+#define MAX_POOLED_ARRAYS 128
+#define MAX_POOLED_ARRAY_LENGTH 256
+
+static GPtrArray *operations_pool = NULL;
+static GPtrArray *coords_pool = NULL;
+
+static GArray *
+acquire_pooled_array (GPtrArray    *pool,
+                      unsigned int  element_size,
+                      unsigned int  reserved_size)
+{
+  if (pool != NULL && pool->len > 0)
+    return g_ptr_array_steal_index_fast (pool, pool->len - 1);
+
+  return g_array_sized_new (FALSE, FALSE, element_size, reserved_size);
+}
+
+static void
+release_pooled_array (GPtrArray **pool,
+                      GArray     *array)
+{
+  if (array->len > MAX_POOLED_ARRAY_LENGTH ||
+      (*pool != NULL && (*pool)->len >= MAX_POOLED_ARRAYS))
+    {
+      g_array_unref (array);
+      return;
+    }
+
+  if (*pool == NULL)
+    *pool = g_ptr_array_new ();
+
+  g_array_set_size (array, 0);
+  g_ptr_array_add (*pool, array);
+}
+
 static void clutter_paint_node_remove_child (ClutterPaintNode *node,
                                              ClutterPaintNode *child);
 
@@ -170,7 +210,8 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
           clutter_paint_operation_clear (op);
         }
 
-      g_array_unref (node->operations);
+      release_pooled_array (&operations_pool,
+                            g_steal_pointer (&node->operations));
     }
 
   iter = node->first_child;
@@ -570,7 +611,8 @@ clutter_paint_operation_clear (ClutterPaintOperation *op)
 
     case PAINT_OP_TEX_RECTS:
     case PAINT_OP_MULTITEX_RECT:
-      g_clear_pointer (&op->coords, g_array_unref);
+      if (op->coords != NULL)
+        release_pooled_array (&coords_pool, g_steal_pointer (&op->coords));
       break;
 
     case PAINT_OP_PRIMITIVE:
@@ -612,7 +654,7 @@ clutter_paint_op_init_tex_rects (ClutterPaintOperation *op,
   clutter_paint_operation_clear (op);
 
   op->opcode = PAINT_OP_TEX_RECTS;
-  op->coords = g_array_sized_new (FALSE, FALSE, sizeof (float), n_floats);
+  op->coords = acquire_pooled_array (coords_pool, sizeof (float), n_floats);
 
   if (use_default_tex_coords)
     {
@@ -640,9 +682,9 @@ clutter_paint_op_init_multitex_rect (ClutterPaintOperation *op,
   clutter_paint_operation_clear (op);
 
   op->opcode = PAINT_OP_MULTITEX_RECT;
-  op->coords = g_array_sized_new (FALSE, FALSE,
-                                  sizeof (float),
-                                  tex_coords_len);
+  op->coords = acquire_pooled_array (coords_pool,
+                                     sizeof (float),
+                                     tex_coords_len);
 
   g_array_append_vals (op->coords, tex_coords, tex_coords_len);
 
@@ -668,8 +710,9 @@ clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
   if (node->operations != NULL)
     return;
 
-  node->operations =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+  node->operations = acquire_pooled_array (operations_pool,
+                                           sizeof (ClutterPaintOperation),
+                                           0);
 }
 
 /**
@@ -892,9 +935,23 @@ clutter_paint_node_paint (ClutterPaintNode    *node,
 gpointer
 _clutter_paint_node_create (GType gtype)
 {
+  GTypeInstance *node;
+
   g_return_val_if_fail (g_type_is_a (gtype, CLUTTER_TYPE_PAINT_NODE), NULL);
 
-  return (gpointer) g_type_create_instance (gtype);
+  node = g_type_create_instance (gtype);
+
+#ifdef HAVE_PROFILER
+  if (cogl_is_tracing_allocations ())
+    {
+      GTypeQuery query;
+
+      g_type_query (gtype, &query);
+      cogl_trace_allocation (g_type_name (gtype), node, query.instance_size);
+    }
+#endif
+
+  return (gpointer) node;
 }
 
 /**
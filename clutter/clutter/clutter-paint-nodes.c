@@ -1582,6 +1582,29 @@ ClutterPaintNode *
 clutter_blur_node_new (unsigned int width,
                        unsigned int height,
                        float        radius)
+{
+  return clutter_blur_node_new_with_mode (width, height, radius,
+                                          CLUTTER_BLUR_MODE_GAUSSIAN);
+}
+
+/**
+ * clutter_blur_node_new_with_mode:
+ * @width width of the blur layer
+ * @height: height of the blur layer
+ * @radius: radius (in pixels) of the blur
+ * @mode: the blur algorithm to use
+ *
+ * Creates a new #ClutterBlurNode, like clutter_blur_node_new(), blurring
+ * with the algorithm given by @mode.
+ *
+ * Return value: (transfer full): the newly created #ClutterBlurNode.
+ *   Use clutter_paint_node_unref() when done.
+ */
+ClutterPaintNode *
+clutter_blur_node_new_with_mode (unsigned int    width,
+                                 unsigned int    height,
+                                 float           radius,
+                                 ClutterBlurMode mode)
 {
   g_autoptr (CoglOffscreen) offscreen = NULL;
   g_autoptr (GError) error = NULL;
@@ -1608,7 +1631,7 @@ clutter_blur_node_new (unsigned int width,
       goto out;
     }
 
-  blur = clutter_blur_new (texture, radius);
+  blur = clutter_blur_new_with_mode (texture, radius, mode);
   blur_node->blur = blur;
 
   if (!blur)
@@ -27,9 +27,20 @@ clutter_pick_context_new_for_view (ClutterStageView         *view,
                                    const graphene_point3d_t *point,
                                    const graphene_ray_t     *ray);
 
+ClutterPickContext *
+clutter_pick_context_new_for_stack (ClutterPickStack *pick_stack,
+                                    ClutterPickMode   mode);
+
 ClutterPickStack *
 clutter_pick_context_steal_stack (ClutterPickContext *pick_context);
 
+void
+clutter_pick_context_begin_actor (ClutterPickContext *pick_context,
+                                  ClutterActor       *actor);
+
+void
+clutter_pick_context_end_actor (ClutterPickContext *pick_context);
+
 gboolean
 clutter_pick_context_intersects_box (ClutterPickContext   *pick_context,
                                      const graphene_box_t *box);
@@ -29,6 +29,8 @@ struct _ClutterPickContext
 
   graphene_ray_t ray;
   graphene_point3d_t point;
+
+  gboolean cull;
 };
 
 G_DEFINE_BOXED_TYPE (ClutterPickContext, clutter_pick_context,
@@ -49,12 +51,32 @@ clutter_pick_context_new_for_view (ClutterStageView         *view,
   pick_context->mode = mode;
   graphene_ray_init_from_ray (&pick_context->ray, ray);
   graphene_point3d_init_from_point (&pick_context->point, point);
+  pick_context->cull = TRUE;
 
   pick_context->pick_stack = clutter_pick_stack_new (cogl_context);
 
   return pick_context;
 }
 
+/*
+ * Creates a context logging into an existing @pick_stack. Nothing is culled,
+ * so the resulting stack can be searched for any point.
+ */
+ClutterPickContext *
+clutter_pick_context_new_for_stack (ClutterPickStack *pick_stack,
+                                    ClutterPickMode   mode)
+{
+  ClutterPickContext *pick_context;
+
+  pick_context = g_new0 (ClutterPickContext, 1);
+  g_ref_count_init (&pick_context->ref_count);
+  pick_context->mode = mode;
+  pick_context->cull = FALSE;
+  pick_context->pick_stack = clutter_pick_stack_ref (pick_stack);
+
+  return pick_context;
+}
+
 ClutterPickContext *
 clutter_pick_context_ref (ClutterPickContext *pick_context)
 {
@@ -203,10 +225,26 @@ clutter_pick_context_pop_transform (ClutterPickContext *pick_context)
   clutter_pick_stack_pop_transform (pick_context->pick_stack);
 }
 
+void
+clutter_pick_context_begin_actor (ClutterPickContext *pick_context,
+                                  ClutterActor       *actor)
+{
+  clutter_pick_stack_begin_actor (pick_context->pick_stack, actor);
+}
+
+void
+clutter_pick_context_end_actor (ClutterPickContext *pick_context)
+{
+  clutter_pick_stack_end_actor (pick_context->pick_stack);
+}
+
 gboolean
 clutter_pick_context_intersects_box (ClutterPickContext   *pick_context,
                                      const graphene_box_t *box)
 {
+  if (!pick_context->cull)
+    return TRUE;
+
   return graphene_box_contains_point (box, &pick_context->point) ||
          graphene_ray_intersects_box (&pick_context->ray, box);
 }
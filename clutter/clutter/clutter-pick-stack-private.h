@@ -38,6 +38,16 @@ void clutter_pick_stack_unref (ClutterPickStack *pick_stack);
 
 void clutter_pick_stack_seal (ClutterPickStack *pick_stack);
 
+gboolean clutter_pick_stack_begin_update (ClutterPickStack *pick_stack,
+                                          ClutterActor     *actor);
+
+void clutter_pick_stack_end_update (ClutterPickStack *pick_stack);
+
+void clutter_pick_stack_begin_actor (ClutterPickStack *pick_stack,
+                                     ClutterActor     *actor);
+
+void clutter_pick_stack_end_actor (ClutterPickStack *pick_stack);
+
 void clutter_pick_stack_log_pick (ClutterPickStack      *pick_stack,
                                   const ClutterActorBox *box,
                                   ClutterActor          *actor);
@@ -21,6 +21,12 @@
 #include "clutter/clutter-pick-stack-private.h"
 #include "clutter/clutter-private.h"
 
+/* Stacks with fewer records than this are searched linearly; building the
+ * index would cost more than it saves.
+ */
+#define PICK_INDEX_MIN_RECORDS 32
+#define PICK_INDEX_MAX_CELLS_PER_AXIS 16
+
 typedef struct
 {
   graphene_point3d_t vertices[4];
@@ -43,6 +49,46 @@ typedef struct
   int prev;
 } PickClipRecord;
 
+/*
+ * The records and clips logged while picking an actor, including its
+ * children. Ranges are stored in pick order, so the ranges of an actor's
+ * descendants directly follow its own range.
+ */
+typedef struct
+{
+  ClutterActor *actor;
+  CoglMatrixEntry *matrix_entry;
+  int clip_index;
+
+  int first_record;
+  int end_record;
+  int parent_range;
+  int end_range;
+} PickActorRange;
+
+/*
+ * Uniform grid over the records' bounds as seen from the camera, i.e. the
+ * projected vertices divided by their depth. A ray from the camera can only
+ * hit a record if its direction falls within these bounds, so only records
+ * overlapping the query's cell need to be tested. Records that can't be
+ * bounded this way (overlaps, or vertices at or behind the camera plane) are
+ * kept in a separate list and always tested.
+ */
+typedef struct
+{
+  float x1, y1;
+  float cell_width, cell_height;
+  int n_columns, n_rows;
+
+  /* Record indices per cell, stored contiguously in ascending order;
+   * cell i spans [cell_offsets[i], cell_offsets[i + 1]) in cell_records.
+   */
+  int *cell_offsets;
+  int *cell_records;
+
+  GArray *unindexed_records;
+} PickIndex;
+
 struct _ClutterPickStack
 {
   grefcount ref_count;
@@ -52,6 +98,24 @@ struct _ClutterPickStack
   GArray *clip_stack;
   int current_clip_stack_top;
 
+  GArray *actor_ranges;
+  int current_range;
+
+  PickIndex *index;
+
+  int n_sealed_clips;
+
+  /* Position and contents of the range being replaced by
+   * clutter_pick_stack_begin_update()
+   */
+  int update_range;
+  int update_parent_range;
+  int update_first_record;
+  int update_old_end_record;
+  int update_old_end_range;
+  GArray *update_tail_records;
+  GArray *update_tail_ranges;
+
   gboolean sealed : 1;
 };
 
@@ -211,14 +275,219 @@ ray_intersects_record (ClutterPickStack         *pick_stack,
   return TRUE;
 }
 
+static gboolean
+get_record_view_bounds (Record          *rec,
+                        graphene_rect_t *bounds)
+{
+  float x1 = G_MAXFLOAT, y1 = G_MAXFLOAT;
+  float x2 = -G_MAXFLOAT, y2 = -G_MAXFLOAT;
+  int i;
+
+  maybe_project_record (rec);
+
+  for (i = 0; i < 4; i++)
+    {
+      const graphene_point3d_t *v = &rec->vertices[i];
+      float x, y;
+
+      /* The camera looks down the negative Z axis */
+      if (v->z > -FLT_EPSILON)
+        return FALSE;
+
+      x = v->x / -v->z;
+      y = v->y / -v->z;
+
+      x1 = MIN (x1, x);
+      y1 = MIN (y1, y);
+      x2 = MAX (x2, x);
+      y2 = MAX (y2, y);
+    }
+
+  /* Pad the bounds a little so that hits right on an edge, which the exact
+   * intersection tests accept within their own tolerance, aren't lost.
+   */
+  graphene_rect_init (bounds, x1, y1, x2 - x1, y2 - y1);
+  graphene_rect_inset (bounds,
+                       -MAX (bounds->size.width, 1.f) * FLT_EPSILON * 16,
+                       -MAX (bounds->size.height, 1.f) * FLT_EPSILON * 16);
+  return TRUE;
+}
+
+static inline void
+pick_index_get_cell_range (PickIndex             *index,
+                           const graphene_rect_t *bounds,
+                           int                   *column1,
+                           int                   *row1,
+                           int                   *column2,
+                           int                   *row2)
+{
+  *column1 = (int) floorf ((bounds->origin.x - index->x1) / index->cell_width);
+  *row1 = (int) floorf ((bounds->origin.y - index->y1) / index->cell_height);
+  *column2 = (int) floorf ((bounds->origin.x + bounds->size.width -
+                            index->x1) / index->cell_width);
+  *row2 = (int) floorf ((bounds->origin.y + bounds->size.height -
+                         index->y1) / index->cell_height);
+
+  *column1 = CLAMP (*column1, 0, index->n_columns - 1);
+  *row1 = CLAMP (*row1, 0, index->n_rows - 1);
+  *column2 = CLAMP (*column2, 0, index->n_columns - 1);
+  *row2 = CLAMP (*row2, 0, index->n_rows - 1);
+}
+
 static void
-add_pick_stack_weak_refs (ClutterPickStack *pick_stack)
+pick_index_free (PickIndex *index)
 {
+  g_free (index->cell_offsets);
+  g_free (index->cell_records);
+  g_clear_pointer (&index->unindexed_records, g_array_unref);
+  g_free (index);
+}
+
+static PickIndex *
+pick_index_new (ClutterPickStack *pick_stack)
+{
+  g_autofree graphene_rect_t *record_bounds = NULL;
+  g_autofree gboolean *is_indexed = NULL;
+  g_autofree int *cell_fill = NULL;
+  graphene_rect_t extents = GRAPHENE_RECT_INIT_ZERO;
+  gboolean has_extents = FALSE;
+  PickIndex *index;
+  int n_records;
+  int n_indexed = 0;
+  int n_cells;
+  int n_cells_per_axis;
   int i;
 
-  g_assert (!pick_stack->sealed);
+  n_records = pick_stack->vertices_stack->len;
+  record_bounds = g_new (graphene_rect_t, n_records);
+  is_indexed = g_new0 (gboolean, n_records);
+
+  index = g_new0 (PickIndex, 1);
+  index->unindexed_records = g_array_new (FALSE, FALSE, sizeof (int));
 
-  for (i = 0; i < pick_stack->vertices_stack->len; i++)
+  for (i = 0; i < n_records; i++)
+    {
+      PickRecord *rec =
+        &g_array_index (pick_stack->vertices_stack, PickRecord, i);
+
+      if (rec->is_overlap)
+        continue;
+
+      if (!get_record_view_bounds (&rec->base, &record_bounds[i]))
+        {
+          g_array_append_val (index->unindexed_records, i);
+          continue;
+        }
+
+      if (has_extents)
+        graphene_rect_union (&extents, &record_bounds[i], &extents);
+      else
+        extents = record_bounds[i];
+
+      has_extents = TRUE;
+      is_indexed[i] = TRUE;
+      n_indexed++;
+    }
+
+  n_cells_per_axis = CLAMP ((int) sqrtf (n_indexed), 1,
+                            PICK_INDEX_MAX_CELLS_PER_AXIS);
+
+  index->x1 = extents.origin.x;
+  index->y1 = extents.origin.y;
+  index->n_columns = n_cells_per_axis;
+  index->n_rows = n_cells_per_axis;
+  index->cell_width = MAX (extents.size.width / n_cells_per_axis, FLT_EPSILON);
+  index->cell_height = MAX (extents.size.height / n_cells_per_axis, FLT_EPSILON);
+
+  n_cells = index->n_columns * index->n_rows;
+  index->cell_offsets = g_new0 (int, n_cells + 1);
+  cell_fill = g_new0 (int, n_cells);
+
+  /* First pass counts the records per cell, second pass fills them in, in
+   * ascending stack order.
+   */
+  for (i = 0; i < n_records; i++)
+    {
+      int column1, row1, column2, row2;
+      int column, row;
+
+      if (!is_indexed[i])
+        continue;
+
+      pick_index_get_cell_range (index, &record_bounds[i],
+                                 &column1, &row1, &column2, &row2);
+
+      for (row = row1; row <= row2; row++)
+        for (column = column1; column <= column2; column++)
+          index->cell_offsets[row * index->n_columns + column + 1]++;
+    }
+
+  for (i = 0; i < n_cells; i++)
+    index->cell_offsets[i + 1] += index->cell_offsets[i];
+
+  index->cell_records = g_new (int, index->cell_offsets[n_cells]);
+
+  for (i = 0; i < n_records; i++)
+    {
+      int column1, row1, column2, row2;
+      int column, row;
+
+      if (!is_indexed[i])
+        continue;
+
+      pick_index_get_cell_range (index, &record_bounds[i],
+                                 &column1, &row1, &column2, &row2);
+
+      for (row = row1; row <= row2; row++)
+        {
+          for (column = column1; column <= column2; column++)
+            {
+              int cell = row * index->n_columns + column;
+
+              index->cell_records[index->cell_offsets[cell] +
+                                  cell_fill[cell]++] = i;
+            }
+        }
+    }
+
+  return index;
+}
+
+static gboolean
+pick_index_lookup_cell (PickIndex                *index,
+                        const graphene_point3d_t *point,
+                        int                      *out_cell)
+{
+  float x, y;
+  int column, row;
+
+  if (point->z > -FLT_EPSILON)
+    return FALSE;
+
+  x = point->x / -point->z;
+  y = point->y / -point->z;
+
+  column = (int) floorf ((x - index->x1) / index->cell_width);
+  row = (int) floorf ((y - index->y1) / index->cell_height);
+
+  if (column < 0 || column >= index->n_columns ||
+      row < 0 || row >= index->n_rows)
+    {
+      *out_cell = -1;
+      return TRUE;
+    }
+
+  *out_cell = row * index->n_columns + column;
+  return TRUE;
+}
+
+static void
+add_pick_stack_weak_refs_from (ClutterPickStack *pick_stack,
+                               int               first_record)
+{
+  int i;
+
+  for (i = first_record; i < pick_stack->vertices_stack->len; i++)
     {
       PickRecord *rec =
         &g_array_index (pick_stack->vertices_stack, PickRecord, i);
@@ -230,11 +499,12 @@ add_pick_stack_weak_refs (ClutterPickStack *pick_stack)
 }
 
 static void
-remove_pick_stack_weak_refs (ClutterPickStack *pick_stack)
+remove_pick_stack_weak_refs_from (ClutterPickStack *pick_stack,
+                                  int               first_record)
 {
   int i;
 
-  for (i = 0; i < pick_stack->vertices_stack->len; i++)
+  for (i = first_record; i < pick_stack->vertices_stack->len; i++)
     {
       PickRecord *rec =
         &g_array_index (pick_stack->vertices_stack, PickRecord, i);
@@ -248,7 +518,9 @@ remove_pick_stack_weak_refs (ClutterPickStack *pick_stack)
 static void
 clutter_pick_stack_dispose (ClutterPickStack *pick_stack)
 {
-  remove_pick_stack_weak_refs (pick_stack);
+  remove_pick_stack_weak_refs_from (pick_stack, 0);
+  g_clear_pointer (&pick_stack->index, pick_index_free);
+  g_clear_pointer (&pick_stack->actor_ranges, g_array_unref);
   g_clear_object (&pick_stack->matrix_stack);
   g_clear_pointer (&pick_stack->vertices_stack, g_array_unref);
   g_clear_pointer (&pick_stack->clip_stack, g_array_unref);
@@ -268,6 +540,13 @@ clear_clip_record (gpointer data)
   g_clear_pointer (&clip->base.matrix_entry, cogl_matrix_entry_unref);
 }
 
+static void
+clear_actor_range (gpointer data)
+{
+  PickActorRange *range = data;
+  g_clear_pointer (&range->matrix_entry, cogl_matrix_entry_unref);
+}
+
 /**
  * clutter_pick_stack_new:
  * @context: a #CoglContext
@@ -287,9 +566,14 @@ clutter_pick_stack_new (CoglContext *context)
   pick_stack->vertices_stack = g_array_new (FALSE, FALSE, sizeof (PickRecord));
   pick_stack->clip_stack = g_array_new (FALSE, FALSE, sizeof (PickClipRecord));
   pick_stack->current_clip_stack_top = -1;
+  pick_stack->actor_ranges = g_array_new (FALSE, FALSE,
+                                          sizeof (PickActorRange));
+  pick_stack->current_range = -1;
+  pick_stack->update_range = -1;
 
   g_array_set_clear_func (pick_stack->vertices_stack, clear_pick_record);
   g_array_set_clear_func (pick_stack->clip_stack, clear_clip_record);
+  g_array_set_clear_func (pick_stack->actor_ranges, clear_actor_range);
 
   return pick_stack;
 }
@@ -330,7 +614,230 @@ void
 clutter_pick_stack_seal (ClutterPickStack *pick_stack)
 {
   g_assert (!pick_stack->sealed);
-  add_pick_stack_weak_refs (pick_stack);
+  add_pick_stack_weak_refs_from (pick_stack, 0);
+
+  if (pick_stack->vertices_stack->len >= PICK_INDEX_MIN_RECORDS)
+    pick_stack->index = pick_index_new (pick_stack);
+
+  pick_stack->n_sealed_clips = pick_stack->clip_stack->len;
+  pick_stack->sealed = TRUE;
+
+  COGL_PERF_COUNTER_ADD (PickRecords, "PickRecords",
+                         "records logged into pick stacks",
+                         pick_stack->vertices_stack->len);
+}
+
+void
+clutter_pick_stack_begin_actor (ClutterPickStack *pick_stack,
+                                ClutterActor     *actor)
+{
+  PickActorRange range;
+
+  g_assert (!pick_stack->sealed);
+
+  range.actor = actor;
+  range.matrix_entry = cogl_matrix_stack_get_entry (pick_stack->matrix_stack);
+  cogl_matrix_entry_ref (range.matrix_entry);
+  range.clip_index = pick_stack->current_clip_stack_top;
+  range.first_record = pick_stack->vertices_stack->len;
+  range.end_record = -1;
+  range.parent_range = pick_stack->current_range;
+  range.end_range = -1;
+
+  g_array_append_val (pick_stack->actor_ranges, range);
+  pick_stack->current_range = pick_stack->actor_ranges->len - 1;
+}
+
+void
+clutter_pick_stack_end_actor (ClutterPickStack *pick_stack)
+{
+  PickActorRange *range;
+
+  g_assert (!pick_stack->sealed);
+  g_assert (pick_stack->current_range >= 0);
+
+  range = &g_array_index (pick_stack->actor_ranges, PickActorRange,
+                          pick_stack->current_range);
+  range->end_record = pick_stack->vertices_stack->len;
+  range->end_range = pick_stack->actor_ranges->len;
+
+  pick_stack->current_range = range->parent_range;
+}
+
+static int
+find_actor_range (ClutterPickStack *pick_stack,
+                  ClutterActor     *actor)
+{
+  int i;
+
+  for (i = 0; i < pick_stack->actor_ranges->len; i++)
+    {
+      PickActorRange *range =
+        &g_array_index (pick_stack->actor_ranges, PickActorRange, i);
+
+      if (range->actor == actor)
+        return i;
+    }
+
+  return -1;
+}
+
+/**
+ * clutter_pick_stack_begin_update:
+ * @pick_stack: A sealed #ClutterPickStack
+ * @actor: The actor to log again
+ *
+ * Prepares @pick_stack for replacing everything that was logged while
+ * picking @actor, including its children. On success, the stack is unsealed
+ * and its transform and clip state restored to what @actor was picked with,
+ * so that picking @actor again logs the new records in place.
+ * clutter_pick_stack_end_update() must be called once done.
+ *
+ * Returns: %FALSE if @actor hasn't been logged, or the stack can't be
+ *   updated in place
+ */
+gboolean
+clutter_pick_stack_begin_update (ClutterPickStack *pick_stack,
+                                 ClutterActor     *actor)
+{
+  PickActorRange *range;
+  graphene_matrix_t matrix;
+  int range_index;
+  int n_tail;
+
+  g_assert (pick_stack->sealed);
+  g_assert (pick_stack->update_range == -1);
+
+  /* Clips logged for the replaced records are never freed individually, so
+   * give up once too many of them piled up.
+   */
+  if (pick_stack->clip_stack->len > 2 * pick_stack->n_sealed_clips + 64)
+    return FALSE;
+
+  range_index = find_actor_range (pick_stack, actor);
+  if (range_index < 0)
+    return FALSE;
+
+  range = &g_array_index (pick_stack->actor_ranges, PickActorRange,
+                          range_index);
+
+  g_clear_pointer (&pick_stack->index, pick_index_free);
+  remove_pick_stack_weak_refs_from (pick_stack, range->first_record);
+
+  /* Move everything logged after the actor aside, and drop what was logged
+   * for the actor itself. Lengths are truncated by hand so the moved
+   * elements aren't cleared.
+   */
+  n_tail = pick_stack->vertices_stack->len - range->end_record;
+  pick_stack->update_tail_records =
+    g_array_sized_new (FALSE, FALSE, sizeof (PickRecord), n_tail);
+  g_array_append_vals (pick_stack->update_tail_records,
+                       &g_array_index (pick_stack->vertices_stack, PickRecord,
+                                       range->end_record),
+                       n_tail);
+  pick_stack->vertices_stack->len = range->end_record;
+  g_array_set_size (pick_stack->vertices_stack, range->first_record);
+
+  n_tail = pick_stack->actor_ranges->len - range->end_range;
+  pick_stack->update_tail_ranges =
+    g_array_sized_new (FALSE, FALSE, sizeof (PickActorRange), n_tail);
+  g_array_append_vals (pick_stack->update_tail_ranges,
+                       &g_array_index (pick_stack->actor_ranges,
+                                       PickActorRange,
+                                       range->end_range),
+                       n_tail);
+
+  pick_stack->update_range = range_index;
+  pick_stack->update_parent_range = range->parent_range;
+  pick_stack->update_first_record = range->first_record;
+  pick_stack->update_old_end_record = range->end_record;
+  pick_stack->update_old_end_range = range->end_range;
+  pick_stack->current_clip_stack_top = range->clip_index;
+  pick_stack->current_range = range->parent_range;
+
+  cogl_matrix_entry_get (range->matrix_entry, &matrix);
+  cogl_matrix_stack_push (pick_stack->matrix_stack);
+  cogl_matrix_stack_set (pick_stack->matrix_stack, &matrix);
+
+  pick_stack->actor_ranges->len = range->end_range;
+  g_array_set_size (pick_stack->actor_ranges, range_index);
+
+  pick_stack->sealed = FALSE;
+
+  return TRUE;
+}
+
+/**
+ * clutter_pick_stack_end_update:
+ * @pick_stack: A #ClutterPickStack
+ *
+ * Finishes an update started with clutter_pick_stack_begin_update(),
+ * putting back everything logged after the updated actor, and seals the
+ * stack again.
+ */
+void
+clutter_pick_stack_end_update (ClutterPickStack *pick_stack)
+{
+  int record_delta, range_delta;
+  int first_tail_range;
+  int parent_range;
+  int i;
+
+  g_assert (!pick_stack->sealed);
+  g_assert (pick_stack->update_range >= 0);
+  g_assert (pick_stack->current_range == pick_stack->update_parent_range);
+
+  cogl_matrix_stack_pop (pick_stack->matrix_stack);
+
+  record_delta = pick_stack->vertices_stack->len -
+                 pick_stack->update_old_end_record;
+  range_delta = pick_stack->actor_ranges->len -
+                pick_stack->update_old_end_range;
+  first_tail_range = pick_stack->actor_ranges->len;
+
+  g_array_append_vals (pick_stack->vertices_stack,
+                       pick_stack->update_tail_records->data,
+                       pick_stack->update_tail_records->len);
+  g_array_append_vals (pick_stack->actor_ranges,
+                       pick_stack->update_tail_ranges->data,
+                       pick_stack->update_tail_ranges->len);
+  g_clear_pointer (&pick_stack->update_tail_records, g_array_unref);
+  g_clear_pointer (&pick_stack->update_tail_ranges, g_array_unref);
+
+  for (i = first_tail_range; i < pick_stack->actor_ranges->len; i++)
+    {
+      PickActorRange *range =
+        &g_array_index (pick_stack->actor_ranges, PickActorRange, i);
+
+      range->first_record += record_delta;
+      range->end_record += record_delta;
+      range->end_range += range_delta;
+      if (range->parent_range >= pick_stack->update_range)
+        range->parent_range += range_delta;
+    }
+
+  /* Ancestors of the updated actor grow or shrink along with it */
+  parent_range = pick_stack->update_parent_range;
+  while (parent_range >= 0)
+    {
+      PickActorRange *range =
+        &g_array_index (pick_stack->actor_ranges, PickActorRange,
+                        parent_range);
+
+      range->end_record += record_delta;
+      range->end_range += range_delta;
+      parent_range = range->parent_range;
+    }
+
+  add_pick_stack_weak_refs_from (pick_stack, pick_stack->update_first_record);
+
+  pick_stack->current_range = -1;
+  pick_stack->current_clip_stack_top = -1;
+  pick_stack->update_range = -1;
+
+  if (pick_stack->vertices_stack->len >= PICK_INDEX_MIN_RECORDS)
+    pick_stack->index = pick_index_new (pick_stack);
+
   pick_stack->sealed = TRUE;
 }
 
@@ -519,17 +1026,75 @@ calculate_clear_area (ClutterPickStack  *pick_stack,
   g_clear_pointer (&area, mtk_region_unref);
 }
 
+static ClutterActor *
+search_actor_indexed (ClutterPickStack          *pick_stack,
+                      PickIndex                 *index,
+                      int                        cell,
+                      const graphene_point3d_t  *point,
+                      const graphene_ray_t      *ray,
+                      MtkRegion                **clear_area)
+{
+  int cell_pos, cell_start;
+  int unindexed_pos;
+
+  if (cell >= 0)
+    {
+      cell_start = index->cell_offsets[cell];
+      cell_pos = index->cell_offsets[cell + 1] - 1;
+    }
+  else
+    {
+      cell_start = 0;
+      cell_pos = -1;
+    }
+
+  unindexed_pos = index->unindexed_records->len - 1;
+
+  /* Merge the cell's candidates with the unindexed records, front to back */
+  while (cell_pos >= cell_start || unindexed_pos >= 0)
+    {
+      PickRecord *rec;
+      int i;
+
+      if (unindexed_pos < 0 ||
+          (cell_pos >= cell_start &&
+           index->cell_records[cell_pos] >
+           g_array_index (index->unindexed_records, int, unindexed_pos)))
+        i = index->cell_records[cell_pos--];
+      else
+        i = g_array_index (index->unindexed_records, int, unindexed_pos--);
+
+      rec = &g_array_index (pick_stack->vertices_stack, PickRecord, i);
+
+      if (rec->actor && ray_intersects_record (pick_stack, rec, point, ray))
+        {
+          if (clear_area)
+            calculate_clear_area (pick_stack, rec, i, clear_area);
+          return rec->actor;
+        }
+    }
+
+  return NULL;
+}
+
 ClutterActor *
 clutter_pick_stack_search_actor (ClutterPickStack          *pick_stack,
                                  const graphene_point3d_t  *point,
                                  const graphene_ray_t      *ray,
                                  MtkRegion                **clear_area)
 {
+  int cell;
   int i;
 
+  if (pick_stack->index &&
+      pick_index_lookup_cell (pick_stack->index, point, &cell))
+    {
+      return search_actor_indexed (pick_stack, pick_stack->index, cell,
+                                   point, ray, clear_area);
+    }
+
   /* Search all "painted" pickable actors from front to back. A linear search
-   * is required, and also performs fine since there is typically only
-   * on the order of dozens of actors in the list (on screen) at a time.
+   * is fine for small stacks, larger ones go through the index above.
    */
   for (i = pick_stack->vertices_stack->len - 1; i >= 0; i--)
     {
@@ -32,6 +32,7 @@
 
 #include "clutter/clutter-property-transition.h"
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-interval.h"
@@ -43,6 +44,10 @@ typedef struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* Set when the property can be animated without going through the
+   * ClutterAnimatable interface */
+  GParamSpec *direct_pspec;
 } ClutterPropertyTransitionPrivate;
 
 enum
@@ -109,6 +114,13 @@ clutter_property_transition_attached (ClutterTransition *transition,
   if (priv->pspec == NULL)
     return;
 
+  if (CLUTTER_IS_ACTOR (animatable))
+    {
+      priv->direct_pspec =
+        clutter_actor_find_direct_animatable_property (CLUTTER_ACTOR (animatable),
+                                                       priv->property_name);
+    }
+
   interval = clutter_transition_get_interval (transition);
   if (interval == NULL)
     return;
@@ -125,6 +137,89 @@ clutter_property_transition_detached (ClutterTransition *transition,
     clutter_property_transition_get_instance_private (self);
 
   priv->pspec = NULL;
+  priv->direct_pspec = NULL;
+}
+
+/*
+ * Most animations are of float, point and size actor properties, and
+ * run in large numbers at once, e.g. when entering the overview. Those
+ * are interpolated here and set on the actor directly, skipping the
+ * property lookups and type checks done through ClutterAnimatable and
+ * ClutterInterval on every frame.
+ */
+static gboolean
+maybe_compute_value_direct (ClutterPropertyTransition *self,
+                            ClutterAnimatable         *animatable,
+                            ClutterInterval           *interval,
+                            double                     progress)
+{
+  ClutterPropertyTransitionPrivate *priv =
+    clutter_property_transition_get_instance_private (self);
+  GType value_type;
+  const GValue *initial;
+  const GValue *final;
+  GValue value = G_VALUE_INIT;
+
+  if (!priv->direct_pspec ||
+      G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL)
+    return FALSE;
+
+  value_type = G_PARAM_SPEC_VALUE_TYPE (priv->direct_pspec);
+  if (clutter_interval_get_value_type (interval) != value_type)
+    return FALSE;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  if (value_type == G_TYPE_FLOAT)
+    {
+      double a = g_value_get_float (initial);
+      double b = g_value_get_float (final);
+
+      g_value_init (&value, G_TYPE_FLOAT);
+      g_value_set_float (&value, (float) ((progress * (b - a)) + a));
+      clutter_actor_set_animated_property (CLUTTER_ACTOR (animatable),
+                                           priv->direct_pspec,
+                                           &value);
+    }
+  else if (value_type == GRAPHENE_TYPE_POINT)
+    {
+      graphene_point_t point;
+
+      graphene_point_interpolate (g_value_get_boxed (initial),
+                                  g_value_get_boxed (final),
+                                  progress,
+                                  &point);
+
+      g_value_init (&value, GRAPHENE_TYPE_POINT);
+      g_value_set_static_boxed (&value, &point);
+      clutter_actor_set_animated_property (CLUTTER_ACTOR (animatable),
+                                           priv->direct_pspec,
+                                           &value);
+    }
+  else if (value_type == GRAPHENE_TYPE_SIZE)
+    {
+      graphene_size_t size;
+
+      graphene_size_interpolate (g_value_get_boxed (initial),
+                                 g_value_get_boxed (final),
+                                 progress,
+                                 &size);
+
+      g_value_init (&value, GRAPHENE_TYPE_SIZE);
+      g_value_set_static_boxed (&value, &size);
+      clutter_actor_set_animated_property (CLUTTER_ACTOR (animatable),
+                                           priv->direct_pspec,
+                                           &value);
+    }
+  else
+    {
+      return FALSE;
+    }
+
+  g_value_unset (&value);
+
+  return TRUE;
 }
 
 static void
@@ -146,6 +241,9 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  if (maybe_compute_value_direct (self, animatable, interval, progress))
+    return;
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -338,6 +436,7 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
   g_free (priv->property_name);
   priv->property_name = g_strdup (property_name);
   priv->pspec = NULL;
+  priv->direct_pspec = NULL;
 
   animatable =
     clutter_transition_get_animatable (CLUTTER_TRANSITION (transition));
@@ -345,6 +444,13 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
     {
       priv->pspec = clutter_animatable_find_property (animatable,
                                                       priv->property_name);
+
+      if (priv->pspec && CLUTTER_IS_ACTOR (animatable))
+        {
+          priv->direct_pspec =
+            clutter_actor_find_direct_animatable_property (CLUTTER_ACTOR (animatable),
+                                                           priv->property_name);
+        }
     }
 
   g_object_notify_by_pspec (G_OBJECT (transition),
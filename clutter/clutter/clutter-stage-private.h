@@ -89,6 +89,9 @@ void     _clutter_stage_queue_event                       (ClutterStage *stage,
                                                            gboolean      copy_event);
 void     _clutter_stage_process_queued_events             (ClutterStage *stage);
 
+int64_t clutter_stage_consume_input_time (ClutterStage *stage,
+                                          unsigned int *input_serial);
+
 void            clutter_stage_presented                 (ClutterStage      *stage,
                                                          ClutterStageView  *view,
                                                          ClutterFrameInfo  *frame_info);
@@ -133,8 +136,12 @@ void clutter_stage_notify_action_implicit_grab (ClutterStage         *self,
                                                 ClutterEventSequence *sequence);
 
 void clutter_stage_add_to_redraw_clip (ClutterStage       *self,
+                                       ClutterActor       *actor,
                                        ClutterPaintVolume *clip);
 
+void clutter_stage_invalidate_pick (ClutterStage *self,
+                                    ClutterActor *actor);
+
 CLUTTER_EXPORT
 ClutterGrab * clutter_stage_grab_input_only_inactive (ClutterStage        *self,
                                                       ClutterEventHandler  handler,
@@ -21,6 +21,91 @@
 #include "clutter/clutter-types.h"
 #include "mtk/mtk.h"
 
+/**
+ * ClutterFrameLatency:
+ * @input_time_us: time of the oldest input event handled before the frame,
+ *   or 0 if there was none
+ * @dispatch_time_us: when the frame clock dispatched the frame
+ * @layout_time_us: when the stage layout was finished
+ * @submit_time_us: when painting, flushing and handing the frame to the
+ *   backend was done
+ * @presentation_time_us: when the frame was presented, or 0 if unknown
+ *
+ * Timestamps, in microseconds on CLOCK_MONOTONIC, of the stages a
+ * presented frame went through.
+ */
+typedef struct _ClutterFrameLatency
+{
+  int64_t input_time_us;
+  int64_t dispatch_time_us;
+  int64_t layout_time_us;
+  int64_t submit_time_us;
+  int64_t presentation_time_us;
+} ClutterFrameLatency;
+
+typedef enum _ClutterFrameStatsFlag
+{
+  CLUTTER_FRAME_STATS_FLAG_NONE = 0,
+  CLUTTER_FRAME_STATS_FLAG_PRESENTED = 1 << 0,
+  CLUTTER_FRAME_STATS_FLAG_MISSED_DEADLINE = 1 << 1,
+  CLUTTER_FRAME_STATS_FLAG_MISSED_VBLANK = 1 << 2,
+} ClutterFrameStatsFlag;
+
+/**
+ * ClutterFrameStats:
+ * @dispatch_time_us: when the frame clock dispatched the frame
+ * @layout_time_us: when the stage layout was finished
+ * @paint_time_us: when the stage was painted and the buffer swapped
+ * @flush_time_us: when the frame was handed over to the backend
+ * @gpu_time_ns: GPU rendering duration if it could be measured, or 0
+ * @target_presentation_time_us: when the frame clock expected the frame
+ *   to be presented, or 0 if unknown
+ * @presentation_time_us: when the frame was presented, or 0 if unknown
+ * @flags: a #ClutterFrameStatsFlag mask
+ *
+ * Timings of a painted frame, kept in a per view ring of the most
+ * recent frames. Timestamps are in microseconds on CLOCK_MONOTONIC.
+ */
+typedef struct _ClutterFrameStats
+{
+  int64_t dispatch_time_us;
+  int64_t layout_time_us;
+  int64_t paint_time_us;
+  int64_t flush_time_us;
+  int64_t gpu_time_ns;
+  int64_t target_presentation_time_us;
+  int64_t presentation_time_us;
+  ClutterFrameStatsFlag flags;
+} ClutterFrameStats;
+
+/**
+ * ClutterGpuPhase:
+ * @CLUTTER_GPU_PHASE_STAGE: the whole stage paint
+ * @CLUTTER_GPU_PHASE_BACKGROUND: background actors
+ * @CLUTTER_GPU_PHASE_WINDOWS: window actors
+ * @CLUTTER_GPU_PHASE_EFFECTS: actors painted through effects
+ * @CLUTTER_GPU_PHASE_VIEW_OFFSCREEN: painting the view offscreen, used for
+ *   transforms and color conversion, onto the onscreen
+ * @CLUTTER_GPU_PHASE_SHADOWFB: copying the shadow framebuffer
+ *
+ * Paint phases whose GPU time is measured with timestamp queries. Phases
+ * may nest, e.g. effects of window actors count for both phases.
+ */
+typedef enum _ClutterGpuPhase
+{
+  CLUTTER_GPU_PHASE_STAGE,
+  CLUTTER_GPU_PHASE_BACKGROUND,
+  CLUTTER_GPU_PHASE_WINDOWS,
+  CLUTTER_GPU_PHASE_EFFECTS,
+  CLUTTER_GPU_PHASE_VIEW_OFFSCREEN,
+  CLUTTER_GPU_PHASE_SHADOWFB,
+
+  CLUTTER_N_GPU_PHASES
+} ClutterGpuPhase;
+
+typedef void (* ClutterFrameStatsFunc) (const ClutterFrameStats *stats,
+                                        gpointer                 user_data);
+
 CLUTTER_EXPORT
 void clutter_stage_view_after_paint (ClutterStageView *view,
                                      MtkRegion        *redraw_clip);
@@ -73,6 +158,28 @@ void clutter_stage_view_notify_presented (ClutterStageView *view,
 CLUTTER_EXPORT
 void clutter_stage_view_notify_ready (ClutterStageView *view);
 
+CLUTTER_EXPORT
+const ClutterFrameLatency * clutter_stage_view_peek_frame_latency (ClutterStageView *view);
+
+CLUTTER_EXPORT
+void clutter_stage_view_begin_gpu_phase (ClutterStageView *view,
+                                         ClutterGpuPhase   phase,
+                                         CoglFramebuffer  *framebuffer);
+
+CLUTTER_EXPORT
+void clutter_stage_view_end_gpu_phase (ClutterStageView *view,
+                                       ClutterGpuPhase   phase,
+                                       CoglFramebuffer  *framebuffer);
+
+CLUTTER_EXPORT
+void clutter_stage_view_foreach_frame_stats (ClutterStageView      *view,
+                                             ClutterFrameStatsFunc  func,
+                                             gpointer               user_data);
+
+CLUTTER_EXPORT
+void clutter_stage_view_capture_next_frame (ClutterStageView *view,
+                                            const char       *path);
+
 void clutter_stage_view_invalidate_input_devices (ClutterStageView *view);
 
 CLUTTER_EXPORT
@@ -83,5 +190,15 @@ CLUTTER_EXPORT
 void clutter_stage_view_set_output_color_state (ClutterStageView  *view,
                                                 ClutterColorState *color_state);
 
+CLUTTER_EXPORT
+void clutter_stage_view_set_color_transform_offloaded (ClutterStageView *view,
+                                                       gboolean          offloaded);
+
+CLUTTER_EXPORT
+gboolean clutter_stage_view_is_color_transform_offloaded (ClutterStageView *view);
+
+CLUTTER_EXPORT
+ClutterColorState * clutter_stage_view_get_onscreen_color_state (ClutterStageView *view);
+
 CLUTTER_EXPORT
 const char * clutter_stage_view_get_name (ClutterStageView *view);
@@ -23,9 +23,11 @@
 #include "clutter/clutter-stage-view-private.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "clutter/clutter-context-private.h"
 #include "clutter/clutter-damage-history.h"
+#include "clutter/clutter-debug.h"
 #include "clutter/clutter-frame-clock.h"
 #include "clutter/clutter-frame-private.h"
 #include "clutter/clutter-mutter.h"
@@ -53,6 +55,31 @@ enum
 
 static GParamSpec *obj_props[PROP_LAST];
 
+#define FRAME_STATS_RING_SIZE 256
+
+/* Bounds the number of timestamp queries issued per frame */
+#define MAX_GPU_PHASE_SPANS 64
+
+typedef struct _GpuPhaseSpan
+{
+  ClutterGpuPhase phase;
+  CoglTimestampQuery *begin_query;
+  CoglTimestampQuery *end_query;
+} GpuPhaseSpan;
+
+static const char *gpu_phase_names[] = {
+  [CLUTTER_GPU_PHASE_STAGE] = "stage",
+  [CLUTTER_GPU_PHASE_BACKGROUND] = "background",
+  [CLUTTER_GPU_PHASE_WINDOWS] = "windows",
+  [CLUTTER_GPU_PHASE_EFFECTS] = "effects",
+  [CLUTTER_GPU_PHASE_VIEW_OFFSCREEN] = "view offscreen",
+  [CLUTTER_GPU_PHASE_SHADOWFB] = "shadowfb",
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (gpu_phase_names) == CLUTTER_N_GPU_PHASES);
+
+#define SHADOWFB_TILE_SIZE 32
+
 enum
 {
   DESTROY,
@@ -73,6 +100,7 @@ typedef struct _ClutterStageViewPrivate
   CoglFramebuffer *framebuffer;
   ClutterColorState *color_state;
   ClutterColorState *output_color_state;
+  gboolean color_transform_offloaded;
 
   guint ensure_offscreen_idle_id;
   CoglOffscreen *offscreen;
@@ -81,12 +109,24 @@ typedef struct _ClutterStageViewPrivate
   gboolean use_shadowfb;
   struct {
     CoglOffscreen *framebuffer;
+    ClutterDamageHistory *damage_history;
+
+    struct {
+      gboolean enabled;
+      gboolean valid;
+      CoglPixelFormat format;
+      int bpp;
+      int stride;
+      uint8_t *pixels;
+      uint8_t *scratch;
+    } tiles;
   } shadow;
 
   CoglScanout *next_scanout;
 
   gboolean has_redraw_clip;
-  MtkRegion *redraw_clip;
+  gboolean has_full_redraw_clip;
+  MtkRegionBuilder redraw_clip;
   gboolean has_accumulated_redraw_clip;
   MtkRegion *accumulated_redraw_clip;
 
@@ -102,6 +142,36 @@ typedef struct _ClutterStageViewPrivate
     int64_t worst_draw_time_us;
   } frame_timings;
 
+  struct {
+    unsigned int input_serial;
+    /* Up to two frames may be in flight with triple buffering. */
+    int n_pending;
+    ClutterFrameLatency pending[2];
+    gboolean has_presented;
+    ClutterFrameLatency presented;
+  } frame_latency;
+
+  struct {
+    ClutterFrameStats ring[FRAME_STATS_RING_SIZE];
+    /* Index of the next record to write */
+    unsigned int next;
+    unsigned int n_frames;
+    /* Painted frames at the end of the ring still waiting for presentation */
+    unsigned int n_pending;
+  } frame_stats;
+
+  struct {
+    gboolean enabled;
+    int depth[CLUTTER_N_GPU_PHASES];
+    int open_span[CLUTTER_N_GPU_PHASES];
+    GArray *current;
+    int n_pending;
+    GArray *pending[2];
+  } gpu_phases;
+
+  /* Where to write a capture of the next painted frame, if requested */
+  char *capture_path;
+
   guint dirty_viewport   : 1;
   guint dirty_projection : 1;
   guint needs_update_devices : 1;
@@ -320,9 +390,12 @@ ensure_stage_view_offscreen_pipeline (ClutterStageView *view)
       cogl_pipeline_set_layer_matrix (pipeline, 0, &matrix);
     }
 
-  clutter_color_state_add_pipeline_transform (priv->color_state,
-                                              priv->output_color_state,
-                                              pipeline);
+  if (!priv->color_transform_offloaded)
+    {
+      clutter_color_state_add_pipeline_transform (priv->color_state,
+                                                  priv->output_color_state,
+                                                  pipeline);
+    }
 
   g_set_object (&priv->offscreen_pipeline, g_steal_pointer (&pipeline));
 }
@@ -354,7 +427,9 @@ clutter_stage_view_invalidate_offscreen (ClutterStageView *view)
     }
 
   if (priv->transform == MTK_MONITOR_TRANSFORM_NORMAL &&
-      clutter_color_state_equals (priv->color_state, priv->output_color_state))
+      (priv->color_transform_offloaded ||
+       clutter_color_state_equals (priv->color_state,
+                                   priv->output_color_state)))
     {
       g_clear_object (&priv->offscreen_pipeline);
       g_clear_object (&priv->offscreen);
@@ -405,6 +480,61 @@ clutter_stage_view_set_output_color_state (ClutterStageView  *view,
   set_color_state (view, &priv->output_color_state, color_state);
 }
 
+/**
+ * clutter_stage_view_set_color_transform_offloaded:
+ * @view: a #ClutterStageView
+ * @offloaded: whether the color transform is offloaded
+ *
+ * Sets whether the transform from the color state of @view to its output
+ * color state is applied after the view has been painted, e.g. by the display
+ * hardware. If so, the view is presented in its color state as is, without
+ * an additional offscreen pass for the transform.
+ */
+void
+clutter_stage_view_set_color_transform_offloaded (ClutterStageView *view,
+                                                  gboolean          offloaded)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (priv->color_transform_offloaded == offloaded)
+    return;
+
+  priv->color_transform_offloaded = offloaded;
+
+  clutter_stage_view_invalidate_offscreen (view);
+}
+
+gboolean
+clutter_stage_view_is_color_transform_offloaded (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  return priv->color_transform_offloaded;
+}
+
+/**
+ * clutter_stage_view_get_onscreen_color_state:
+ * @view: a #ClutterStageView
+ *
+ * Gets the color state of the content presented on the onscreen of @view,
+ * i.e. the color state a buffer must be in to be scanned out directly.
+ *
+ * Returns: (transfer none): the onscreen color state
+ */
+ClutterColorState *
+clutter_stage_view_get_onscreen_color_state (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (priv->color_transform_offloaded)
+    return priv->color_state;
+  else
+    return priv->output_color_state;
+}
+
 static void
 clutter_stage_view_ensure_color_states (ClutterStageView *view)
 {
@@ -533,7 +663,37 @@ init_shadowfb (ClutterStageView *view)
     }
 
   priv->shadow.framebuffer = offscreen;
-  return;
+  priv->shadow.damage_history = clutter_damage_history_new ();
+
+  if (!(clutter_paint_debug_flags &
+        CLUTTER_DEBUG_DISABLE_SHADOWFB_DAMAGE_TILES) &&
+      cogl_pixel_format_get_n_planes (format) == 1)
+    {
+      int bpp;
+
+      bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+      priv->shadow.tiles.enabled = TRUE;
+      priv->shadow.tiles.format = format;
+      priv->shadow.tiles.bpp = bpp;
+      priv->shadow.tiles.stride = width * bpp;
+      priv->shadow.tiles.pixels = g_malloc (height * width * bpp);
+      priv->shadow.tiles.scratch = g_malloc (height * width * bpp);
+    }
+}
+
+static void
+clear_shadowfb (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  g_clear_pointer (&priv->shadow.tiles.pixels, g_free);
+  g_clear_pointer (&priv->shadow.tiles.scratch, g_free);
+  priv->shadow.tiles.enabled = FALSE;
+  priv->shadow.tiles.valid = FALSE;
+  g_clear_pointer (&priv->shadow.damage_history,
+                   clutter_damage_history_free);
+  g_clear_object (&priv->shadow.framebuffer);
 }
 
 void
@@ -547,26 +707,178 @@ clutter_stage_view_after_paint (ClutterStageView *view,
 
   if (priv->offscreen)
     {
+      CoglFramebuffer *dst_framebuffer;
+
       if (priv->shadow.framebuffer)
+        dst_framebuffer = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
+      else
+        dst_framebuffer = priv->framebuffer;
+
+      clutter_stage_view_begin_gpu_phase (view,
+                                          CLUTTER_GPU_PHASE_VIEW_OFFSCREEN,
+                                          dst_framebuffer);
+      paint_transformed_framebuffer (view,
+                                     priv->offscreen_pipeline,
+                                     priv->offscreen,
+                                     dst_framebuffer,
+                                     redraw_clip);
+      clutter_stage_view_end_gpu_phase (view,
+                                        CLUTTER_GPU_PHASE_VIEW_OFFSCREEN,
+                                        dst_framebuffer);
+    }
+}
+
+static gboolean
+is_tile_dirty (const uint8_t *current,
+               int            current_stride,
+               const uint8_t *prev,
+               int            prev_stride,
+               int            row_length,
+               int            n_rows)
+{
+  int y;
+
+  for (y = 0; y < n_rows; y++)
+    {
+      if (memcmp (current + y * current_stride,
+                  prev + y * prev_stride,
+                  row_length) != 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+copy_tile (const uint8_t *current,
+           int            current_stride,
+           uint8_t       *prev,
+           int            prev_stride,
+           int            row_length,
+           int            n_rows)
+{
+  int y;
+
+  for (y = 0; y < n_rows; y++)
+    {
+      memcpy (prev + y * prev_stride,
+              current + y * current_stride,
+              row_length);
+    }
+}
+
+/*
+ * Compares the damaged part of the shadow framebuffer against what was
+ * copied to the onscreen the last time, tile by tile, and returns the
+ * part of @damage_region that actually changed. Damage is frequently
+ * over-reported (e.g. full stage redraws, or actors repainting unchanged
+ * content), and with a slow to write to scanout buffer skipping
+ * unchanged tiles is a lot cheaper than copying them.
+ */
+static MtkRegion *
+find_damaged_tiles (ClutterStageView *view,
+                    const MtkRegion  *damage_region)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
+  int width = cogl_framebuffer_get_width (shadowfb);
+  int height = cogl_framebuffer_get_height (shadowfb);
+  int bpp = priv->shadow.tiles.bpp;
+  int stride = priv->shadow.tiles.stride;
+  MtkRegionBuilder aligned_builder;
+  MtkRegionBuilder tile_builder;
+  g_autoptr (MtkRegion) aligned_region = NULL;
+  MtkRegion *tile_region;
+  int i;
+
+  COGL_TRACE_BEGIN_SCOPED (FindDamagedTiles,
+                           "Clutter::StageView::find_damaged_tiles()");
+
+  mtk_region_builder_init (&aligned_builder);
+  for (i = 0; i < mtk_region_num_rectangles (damage_region); i++)
+    {
+      MtkRectangle rect;
+      int x1, y1, x2, y2;
+
+      rect = mtk_region_get_rectangle (damage_region, i);
+
+      x1 = (rect.x / SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      y1 = (rect.y / SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      x2 = ((rect.x + rect.width + SHADOWFB_TILE_SIZE - 1) /
+            SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      y2 = ((rect.y + rect.height + SHADOWFB_TILE_SIZE - 1) /
+            SHADOWFB_TILE_SIZE) * SHADOWFB_TILE_SIZE;
+      x2 = MIN (x2, width);
+      y2 = MIN (y2, height);
+
+      if (x2 > x1 && y2 > y1)
+        mtk_region_builder_add_rectangle (&aligned_builder,
+                                          x1, y1, x2 - x1, y2 - y1);
+    }
+  aligned_region = mtk_region_builder_finish (&aligned_builder);
+
+  mtk_region_builder_init (&tile_builder);
+  for (i = 0; i < mtk_region_num_rectangles (aligned_region); i++)
+    {
+      uint8_t *current = priv->shadow.tiles.scratch;
+      MtkRectangle rect;
+      int current_stride;
+      int tile_x, tile_y;
+
+      rect = mtk_region_get_rectangle (aligned_region, i);
+      current_stride = rect.width * bpp;
+
+      if (!cogl_framebuffer_read_pixels (shadowfb,
+                                         rect.x, rect.y,
+                                         rect.width, rect.height,
+                                         priv->shadow.tiles.format,
+                                         current))
         {
-          CoglFramebuffer *shadowfb =
-            COGL_FRAMEBUFFER (priv->shadow.framebuffer);
-
-          paint_transformed_framebuffer (view,
-                                         priv->offscreen_pipeline,
-                                         priv->offscreen,
-                                         shadowfb,
-                                         redraw_clip);
+          g_warning ("Failed to read back shadow framebuffer");
+          mtk_region_builder_clear (&tile_builder);
+          priv->shadow.tiles.valid = FALSE;
+          return NULL;
         }
-      else
+
+      for (tile_y = 0; tile_y < rect.height; tile_y += SHADOWFB_TILE_SIZE)
         {
-          paint_transformed_framebuffer (view,
-                                         priv->offscreen_pipeline,
-                                         priv->offscreen,
-                                         priv->framebuffer,
-                                         redraw_clip);
+          for (tile_x = 0; tile_x < rect.width; tile_x += SHADOWFB_TILE_SIZE)
+            {
+              int tile_width = MIN (SHADOWFB_TILE_SIZE, rect.width - tile_x);
+              int tile_height = MIN (SHADOWFB_TILE_SIZE, rect.height - tile_y);
+              const uint8_t *current_tile;
+              uint8_t *prev_tile;
+
+              current_tile = current +
+                             tile_y * current_stride +
+                             tile_x * bpp;
+              prev_tile = priv->shadow.tiles.pixels +
+                          (rect.y + tile_y) * stride +
+                          (rect.x + tile_x) * bpp;
+
+              if (priv->shadow.tiles.valid &&
+                  !is_tile_dirty (current_tile, current_stride,
+                                  prev_tile, stride,
+                                  tile_width * bpp, tile_height))
+                continue;
+
+              copy_tile (current_tile, current_stride,
+                         prev_tile, stride,
+                         tile_width * bpp, tile_height);
+              mtk_region_builder_add_rectangle (&tile_builder,
+                                                rect.x + tile_x,
+                                                rect.y + tile_y,
+                                                tile_width,
+                                                tile_height);
+            }
         }
     }
+
+  tile_region = mtk_region_builder_finish (&tile_builder);
+  mtk_region_intersect (tile_region, damage_region);
+
+  return tile_region;
 }
 
 static void
@@ -575,29 +887,91 @@ copy_shadowfb_to_onscreen (ClutterStageView *view,
 {
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
+  CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
+  CoglContext *context = cogl_framebuffer_get_context (priv->framebuffer);
   g_autoptr (MtkRegion) damage_region = NULL;
+  g_autoptr (MtkRegion) copy_region = NULL;
+  MtkRectangle full_damage = {
+    .width = cogl_framebuffer_get_width (priv->framebuffer),
+    .height = cogl_framebuffer_get_height (priv->framebuffer),
+  };
   int i;
 
-  if (mtk_region_is_empty (swap_region))
+  if (mtk_region_is_empty (swap_region) ||
+      (priv->shadow.tiles.enabled && !priv->shadow.tiles.valid))
+    damage_region = mtk_region_create_rectangle (&full_damage);
+  else
+    damage_region = mtk_region_copy (swap_region);
+
+  if (priv->shadow.tiles.enabled)
     {
-      MtkRectangle full_damage = {
-        .width = cogl_framebuffer_get_width (priv->framebuffer),
-        .height = cogl_framebuffer_get_height (priv->framebuffer),
-      };
-      damage_region = mtk_region_create_rectangle (&full_damage);
+      g_autoptr (MtkRegion) changed_region = NULL;
+
+      changed_region = find_damaged_tiles (view, damage_region);
+      if (changed_region)
+        {
+          g_clear_pointer (&damage_region, mtk_region_unref);
+          damage_region = g_steal_pointer (&changed_region);
+          priv->shadow.tiles.valid = TRUE;
+        }
+    }
+
+  /* The shadow framebuffer always has up to date contents, but the
+   * onscreen back buffer we are about to copy into may be several frames
+   * old. Repair everything that changed since then, and fall back to a
+   * full copy if we can't tell what that is.
+   */
+  if (COGL_IS_ONSCREEN (priv->framebuffer) &&
+      cogl_context_has_winsys_feature (context,
+                                       COGL_WINSYS_FEATURE_BUFFER_AGE))
+    {
+      ClutterDamageHistory *damage_history = priv->shadow.damage_history;
+      int buffer_age;
+
+      buffer_age =
+        cogl_onscreen_get_buffer_age (COGL_ONSCREEN (priv->framebuffer));
+
+      clutter_damage_history_record (damage_history, damage_region);
+
+      if (clutter_damage_history_is_age_valid (damage_history, buffer_age))
+        {
+          int age;
+
+          copy_region = mtk_region_copy (damage_region);
+          for (age = 1; age <= buffer_age; age++)
+            {
+              const MtkRegion *old_damage;
+
+              old_damage =
+                clutter_damage_history_lookup (damage_history, age);
+              mtk_region_union (copy_region, old_damage);
+            }
+        }
+      else
+        {
+          copy_region = mtk_region_create_rectangle (&full_damage);
+        }
+
+      clutter_damage_history_step (damage_history);
+    }
+  else if (COGL_IS_ONSCREEN (priv->framebuffer) &&
+           mtk_region_is_empty (swap_region))
+    {
+      /* A full swap without buffer age leaves us with undefined back
+       * buffer contents. */
+      copy_region = mtk_region_create_rectangle (&full_damage);
     }
   else
     {
-      damage_region = mtk_region_copy (swap_region);
+      copy_region = g_steal_pointer (&damage_region);
     }
 
-  for (i = 0; i < mtk_region_num_rectangles (damage_region); i++)
+  for (i = 0; i < mtk_region_num_rectangles (copy_region); i++)
     {
-      CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
       g_autoptr (GError) error = NULL;
       MtkRectangle rect;
 
-      rect = mtk_region_get_rectangle (damage_region, i);
+      rect = mtk_region_get_rectangle (copy_region, i);
 
       if (!cogl_blit_framebuffer (shadowfb,
                                   priv->framebuffer,
@@ -623,7 +997,15 @@ clutter_stage_view_before_swap_buffer (ClutterStageView *view,
                            "Clutter::StageView::before_swap_buffer()");
 
   if (priv->shadow.framebuffer)
-    copy_shadowfb_to_onscreen (view, swap_region);
+    {
+      clutter_stage_view_begin_gpu_phase (view,
+                                          CLUTTER_GPU_PHASE_SHADOWFB,
+                                          priv->framebuffer);
+      copy_shadowfb_to_onscreen (view, swap_region);
+      clutter_stage_view_end_gpu_phase (view,
+                                        CLUTTER_GPU_PHASE_SHADOWFB,
+                                        priv->framebuffer);
+    }
 }
 
 float
@@ -790,12 +1172,13 @@ clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
-  if (priv->has_redraw_clip && !priv->redraw_clip)
+  if (priv->has_full_redraw_clip)
     return;
 
   if (!clip)
     {
-      g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+      mtk_region_builder_clear (&priv->redraw_clip);
+      priv->has_full_redraw_clip = TRUE;
       priv->has_redraw_clip = TRUE;
       return;
     }
@@ -803,15 +1186,18 @@ clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
   if (clip->width == 0 || clip->height == 0)
     return;
 
-  if (!priv->redraw_clip)
+  if (mtk_rectangle_equal (&priv->layout, clip))
     {
-      if (!mtk_rectangle_equal (&priv->layout, clip))
-        priv->redraw_clip = mtk_region_create_rectangle (clip);
+      mtk_region_builder_clear (&priv->redraw_clip);
+      priv->has_full_redraw_clip = TRUE;
     }
   else
     {
-      mtk_region_union_rectangle (priv->redraw_clip, clip);
-      maybe_mark_full_redraw (view, &priv->redraw_clip);
+      /* Clips are only collected here and turned into a region once per
+       * frame, in clutter_stage_view_accumulate_redraw_clip(). */
+      mtk_region_builder_add_rectangle (&priv->redraw_clip,
+                                        clip->x, clip->y,
+                                        clip->width, clip->height);
     }
 
   priv->has_redraw_clip = TRUE;
@@ -832,7 +1218,7 @@ clutter_stage_view_has_full_redraw_clip (ClutterStageView *view)
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
-  return priv->has_redraw_clip && !priv->redraw_clip;
+  return priv->has_full_redraw_clip;
 }
 
 MtkRegion *
@@ -857,22 +1243,26 @@ clutter_stage_view_accumulate_redraw_clip (ClutterStageView *view)
 
   g_return_if_fail (priv->has_redraw_clip);
 
-  if (priv->redraw_clip && priv->accumulated_redraw_clip)
+  if (!priv->has_full_redraw_clip && priv->accumulated_redraw_clip)
     {
-      mtk_region_union (priv->accumulated_redraw_clip, priv->redraw_clip);
+      mtk_region_builder_finish_into (&priv->redraw_clip,
+                                      priv->accumulated_redraw_clip);
       maybe_mark_full_redraw (view, &priv->accumulated_redraw_clip);
     }
-  else if (priv->redraw_clip && !priv->has_accumulated_redraw_clip)
+  else if (!priv->has_full_redraw_clip && !priv->has_accumulated_redraw_clip)
     {
-      priv->accumulated_redraw_clip = g_steal_pointer (&priv->redraw_clip);
+      priv->accumulated_redraw_clip =
+        mtk_region_builder_finish (&priv->redraw_clip);
+      maybe_mark_full_redraw (view, &priv->accumulated_redraw_clip);
     }
   else
     {
       g_clear_pointer (&priv->accumulated_redraw_clip, mtk_region_unref);
     }
 
-  g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+  mtk_region_builder_clear (&priv->redraw_clip);
   priv->has_accumulated_redraw_clip = TRUE;
+  priv->has_full_redraw_clip = FALSE;
   priv->has_redraw_clip = FALSE;
 }
 
@@ -956,7 +1346,7 @@ clutter_stage_view_has_shadowfb (ClutterStageView *view)
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
-  return priv->use_shadowfb;
+  return priv->shadow.framebuffer != NULL;
 }
 
 static void
@@ -1035,6 +1425,350 @@ end_frame_timing_measurement (ClutterStageView *view)
     }
 }
 
+static ClutterFrameStats *
+get_frame_stats (ClutterStageView *view,
+                 unsigned int      age)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  unsigned int index;
+
+  index = (priv->frame_stats.next + FRAME_STATS_RING_SIZE - 1 - age) %
+          FRAME_STATS_RING_SIZE;
+  return &priv->frame_stats.ring[index];
+}
+
+static void
+record_frame_stats (ClutterStageView        *view,
+                    ClutterFrame            *frame,
+                    const ClutterFrameStats *stats)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  ClutterFrameStats *record;
+  int64_t frame_deadline_us;
+
+  record = &priv->frame_stats.ring[priv->frame_stats.next];
+  *record = *stats;
+
+  clutter_frame_get_target_presentation_time (frame,
+                                              &record->target_presentation_time_us);
+  if (clutter_frame_get_frame_deadline (frame, &frame_deadline_us) &&
+      record->flush_time_us > frame_deadline_us)
+    record->flags |= CLUTTER_FRAME_STATS_FLAG_MISSED_DEADLINE;
+
+  priv->frame_stats.next =
+    (priv->frame_stats.next + 1) % FRAME_STATS_RING_SIZE;
+  priv->frame_stats.n_frames = MIN (priv->frame_stats.n_frames + 1,
+                                    FRAME_STATS_RING_SIZE);
+
+  /* Same as for the latency records, at most two frames are in flight */
+  priv->frame_stats.n_pending = MIN (priv->frame_stats.n_pending + 1,
+                                     G_N_ELEMENTS (priv->frame_latency.pending));
+}
+
+static void
+update_presented_frame_stats (ClutterStageView *view,
+                              ClutterFrameInfo *frame_info)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  ClutterFrameStats *record;
+
+  if (!priv->frame_stats.n_pending)
+    return;
+
+  record = get_frame_stats (view, --priv->frame_stats.n_pending);
+  record->flags |= CLUTTER_FRAME_STATS_FLAG_PRESENTED;
+  record->presentation_time_us = frame_info->presentation_time;
+
+  if (frame_info->has_valid_gpu_rendering_duration)
+    record->gpu_time_ns = frame_info->gpu_rendering_duration_ns;
+
+  if (record->target_presentation_time_us &&
+      record->presentation_time_us &&
+      frame_info->refresh_rate > 1.0f)
+    {
+      int64_t refresh_interval_us;
+
+      refresh_interval_us = (int64_t) (G_USEC_PER_SEC /
+                                       frame_info->refresh_rate);
+      if (record->presentation_time_us - record->target_presentation_time_us >
+          refresh_interval_us / 2)
+        record->flags |= CLUTTER_FRAME_STATS_FLAG_MISSED_VBLANK;
+    }
+}
+
+static void
+free_gpu_phase_spans (ClutterStageView *view,
+                      GArray           *spans)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
+  unsigned int i;
+
+  for (i = 0; i < spans->len; i++)
+    {
+      GpuPhaseSpan *span = &g_array_index (spans, GpuPhaseSpan, i);
+
+      cogl_context_free_timestamp_query (cogl_context, span->begin_query);
+      if (span->end_query)
+        cogl_context_free_timestamp_query (cogl_context, span->end_query);
+    }
+
+  g_array_free (spans, TRUE);
+}
+
+static void
+begin_gpu_phases (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
+  gboolean wanted;
+  int i;
+
+  wanted = G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_GPU_PHASES);
+#ifdef HAVE_PROFILER
+  wanted = wanted || cogl_is_tracing_enabled ();
+#endif
+
+  priv->gpu_phases.enabled =
+    wanted &&
+    cogl_context_has_feature (cogl_context, COGL_FEATURE_ID_TIMESTAMP_QUERY);
+
+  if (!priv->gpu_phases.enabled)
+    return;
+
+  for (i = 0; i < CLUTTER_N_GPU_PHASES; i++)
+    {
+      priv->gpu_phases.depth[i] = 0;
+      priv->gpu_phases.open_span[i] = -1;
+    }
+
+  g_warn_if_fail (!priv->gpu_phases.current);
+  priv->gpu_phases.current = g_array_new (FALSE, FALSE, sizeof (GpuPhaseSpan));
+}
+
+static void
+end_gpu_phases (ClutterStageView *view,
+                gboolean          painted)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  GArray *spans;
+
+  spans = g_steal_pointer (&priv->gpu_phases.current);
+  priv->gpu_phases.enabled = FALSE;
+
+  if (!spans)
+    return;
+
+  if (!painted || spans->len == 0)
+    {
+      free_gpu_phase_spans (view, spans);
+      return;
+    }
+
+  if (priv->gpu_phases.n_pending == G_N_ELEMENTS (priv->gpu_phases.pending))
+    {
+      free_gpu_phase_spans (view, priv->gpu_phases.pending[0]);
+      priv->gpu_phases.pending[0] = priv->gpu_phases.pending[1];
+      priv->gpu_phases.n_pending--;
+    }
+  priv->gpu_phases.pending[priv->gpu_phases.n_pending++] = spans;
+}
+
+static void
+report_gpu_phases (ClutterStageView *view,
+                   const int64_t    *durations_ns)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  g_autoptr (GString) description = NULL;
+  int i;
+
+  COGL_TRACE_BEGIN_SCOPED (GpuPhases, "Clutter::StageView::gpu_phases()");
+
+  description = g_string_new (priv->name);
+  g_string_append (description, ":");
+  for (i = 0; i < CLUTTER_N_GPU_PHASES; i++)
+    {
+      if (!durations_ns[i])
+        continue;
+
+      g_string_append_printf (description, " %s %ld µs,",
+                              gpu_phase_names[i],
+                              durations_ns[i] / 1000);
+    }
+  g_string_truncate (description, description->len - 1);
+
+  COGL_TRACE_DESCRIBE (GpuPhases, description->str);
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_GPU_PHASES))
+    g_message ("GPU time %s", description->str);
+}
+
+static void
+collect_gpu_phases (ClutterStageView *view,
+                    ClutterFrameInfo *frame_info)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
+  int64_t durations_ns[CLUTTER_N_GPU_PHASES] = { 0 };
+  int64_t first_begin_ns = INT64_MAX;
+  int64_t last_end_ns = INT64_MIN;
+  GArray *spans;
+  unsigned int i;
+
+  if (!priv->gpu_phases.n_pending)
+    return;
+
+  spans = priv->gpu_phases.pending[0];
+  priv->gpu_phases.pending[0] = priv->gpu_phases.pending[1];
+  priv->gpu_phases.pending[1] = NULL;
+  priv->gpu_phases.n_pending--;
+
+  /* The frame was presented, so the queries are available without
+   * stalling the pipeline.
+   */
+  for (i = 0; i < spans->len; i++)
+    {
+      GpuPhaseSpan *span = &g_array_index (spans, GpuPhaseSpan, i);
+      int64_t begin_ns, end_ns;
+
+      if (!span->end_query)
+        continue;
+
+      begin_ns = cogl_context_timestamp_query_get_time_ns (cogl_context,
+                                                           span->begin_query);
+      end_ns = cogl_context_timestamp_query_get_time_ns (cogl_context,
+                                                         span->end_query);
+
+      durations_ns[span->phase] += end_ns - begin_ns;
+      first_begin_ns = MIN (first_begin_ns, begin_ns);
+      last_end_ns = MAX (last_end_ns, end_ns);
+    }
+
+  free_gpu_phase_spans (view, spans);
+
+  if (last_end_ns <= first_begin_ns)
+    return;
+
+  /* The whole frame duration is measured from the buffer swap on, which
+   * misses rendering the GPU already went through while painting was
+   * still being submitted. Let the frame clock see the longer of both.
+   */
+  if (!frame_info->has_valid_gpu_rendering_duration ||
+      frame_info->gpu_rendering_duration_ns < last_end_ns - first_begin_ns)
+    {
+      frame_info->has_valid_gpu_rendering_duration = TRUE;
+      frame_info->gpu_rendering_duration_ns = last_end_ns - first_begin_ns;
+    }
+
+  report_gpu_phases (view, durations_ns);
+}
+
+/**
+ * clutter_stage_view_begin_gpu_phase: (skip)
+ * @view: a #ClutterStageView
+ * @phase: the paint phase that begins
+ * @framebuffer: the framebuffer being painted to
+ *
+ * Marks the beginning of a paint phase whose GPU time should be measured.
+ * Only the outermost of nested begin and end pairs of a phase is measured.
+ * Does nothing unless the view is painting a frame while tracing or the
+ * "gpu-phases" paint debug flag is enabled.
+ */
+void
+clutter_stage_view_begin_gpu_phase (ClutterStageView *view,
+                                    ClutterGpuPhase   phase,
+                                    CoglFramebuffer  *framebuffer)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  GpuPhaseSpan span;
+
+  if (!priv->gpu_phases.enabled)
+    return;
+
+  if (priv->gpu_phases.depth[phase]++ > 0)
+    return;
+
+  if (priv->gpu_phases.current->len >= MAX_GPU_PHASE_SPANS)
+    return;
+
+  span = (GpuPhaseSpan) {
+    .phase = phase,
+    .begin_query = cogl_framebuffer_create_timestamp_query (framebuffer),
+  };
+  if (!span.begin_query)
+    return;
+
+  priv->gpu_phases.open_span[phase] = priv->gpu_phases.current->len;
+  g_array_append_val (priv->gpu_phases.current, span);
+}
+
+/**
+ * clutter_stage_view_end_gpu_phase: (skip)
+ * @view: a #ClutterStageView
+ * @phase: the paint phase that ends
+ * @framebuffer: the framebuffer being painted to
+ *
+ * Marks the end of a paint phase previously begun with
+ * clutter_stage_view_begin_gpu_phase().
+ */
+void
+clutter_stage_view_end_gpu_phase (ClutterStageView *view,
+                                  ClutterGpuPhase   phase,
+                                  CoglFramebuffer  *framebuffer)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  GpuPhaseSpan *span;
+  int index;
+
+  if (!priv->gpu_phases.enabled)
+    return;
+
+  g_return_if_fail (priv->gpu_phases.depth[phase] > 0);
+
+  if (--priv->gpu_phases.depth[phase] > 0)
+    return;
+
+  index = priv->gpu_phases.open_span[phase];
+  if (index < 0)
+    return;
+
+  span = &g_array_index (priv->gpu_phases.current, GpuPhaseSpan, index);
+  span->end_query = cogl_framebuffer_create_timestamp_query (framebuffer);
+  priv->gpu_phases.open_span[phase] = -1;
+}
+
+static void
+begin_capture (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  cogl_context_start_capture (cogl_framebuffer_get_context (priv->framebuffer));
+}
+
+static void
+end_capture (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
+  g_autofree char *path = g_steal_pointer (&priv->capture_path);
+  g_autoptr (GError) error = NULL;
+
+  if (!cogl_context_stop_capture (cogl_context, path, &error))
+    g_warning ("Failed to write frame capture: %s", error->message);
+}
+
 static ClutterFrameResult
 handle_frame_clock_frame (ClutterFrameClock *frame_clock,
                           ClutterFrame      *frame,
@@ -1046,6 +1780,9 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   ClutterStage *stage = priv->stage;
   ClutterStageWindow *stage_window = _clutter_stage_get_window (stage);
   ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
+  ClutterFrameLatency frame_latency = { 0 };
+  ClutterFrameStats frame_stats = { 0 };
+  gboolean painted = FALSE;
 
   if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
     return CLUTTER_FRAME_RESULT_IDLE;
@@ -1056,9 +1793,13 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   if (!clutter_actor_is_mapped (CLUTTER_ACTOR (stage)))
     return CLUTTER_FRAME_RESULT_IDLE;
 
+  frame_latency.dispatch_time_us = g_get_monotonic_time ();
+
   if (clutter_context_get_show_fps (context))
     begin_frame_timing_measurement (view);
 
+  begin_gpu_phases (view);
+
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_PRE_PAINT);
   clutter_stage_emit_before_update (stage, view, frame);
 
@@ -1066,17 +1807,40 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
 
   clutter_stage_finish_layout (stage);
 
+  frame_latency.layout_time_us = g_get_monotonic_time ();
+
   _clutter_stage_window_prepare_frame (stage_window, view, frame);
   clutter_stage_emit_prepare_frame (stage, view, frame);
 
   if (clutter_stage_view_has_redraw_clip (view))
     {
+      frame_latency.input_time_us =
+        clutter_stage_consume_input_time (stage,
+                                          &priv->frame_latency.input_serial);
+
       clutter_stage_emit_before_paint (stage, view, frame);
 
+      if (G_UNLIKELY (priv->capture_path))
+        begin_capture (view);
+
       _clutter_stage_window_redraw_view (stage_window, view, frame);
 
+      if (G_UNLIKELY (priv->capture_path))
+        end_capture (view);
+
+      frame_latency.submit_time_us = g_get_monotonic_time ();
+      painted = TRUE;
       clutter_frame_clock_record_flip_time (frame_clock,
-                                            g_get_monotonic_time ());
+                                            frame_latency.submit_time_us);
+
+      if (priv->frame_latency.n_pending ==
+          G_N_ELEMENTS (priv->frame_latency.pending))
+        {
+          priv->frame_latency.pending[0] = priv->frame_latency.pending[1];
+          priv->frame_latency.n_pending--;
+        }
+      priv->frame_latency.pending[priv->frame_latency.n_pending++] =
+        frame_latency;
 
       clutter_stage_emit_after_paint (stage, view, frame);
 
@@ -1086,6 +1850,19 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
 
   _clutter_stage_window_finish_frame (stage_window, view, frame);
 
+  end_gpu_phases (view, painted);
+
+  if (painted)
+    {
+      frame_stats.dispatch_time_us = frame_latency.dispatch_time_us;
+      frame_stats.layout_time_us = frame_latency.layout_time_us;
+      frame_stats.paint_time_us = frame_latency.submit_time_us;
+      frame_stats.flush_time_us = g_get_monotonic_time ();
+      record_frame_stats (view, frame, &frame_stats);
+    }
+
+  cogl_perf_counters_end_frame ();
+
   if (priv->needs_update_devices)
     {
       clutter_stage_update_devices_in_view (stage, view);
@@ -1117,6 +1894,52 @@ static const ClutterFrameListenerIface frame_clock_listener_iface = {
   .new_frame = handle_frame_clock_new_frame,
 };
 
+static void
+trace_frame_latency (ClutterStageView *view)
+{
+#ifdef HAVE_PROFILER
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  const ClutterFrameLatency *latency = &priv->frame_latency.presented;
+  CoglTraceHead trace_head;
+  g_autoptr (GString) description = NULL;
+
+  if (G_LIKELY (!cogl_is_tracing_enabled ()))
+    return;
+
+  /* Only frames answering to input are interesting for latency */
+  if (!latency->input_time_us)
+    return;
+
+  description = g_string_new (priv->name);
+  g_string_append_printf (description,
+                          ": input to dispatch %ld µs, "
+                          "dispatch to layout %ld µs, "
+                          "layout to submit %ld µs",
+                          latency->dispatch_time_us - latency->input_time_us,
+                          latency->layout_time_us - latency->dispatch_time_us,
+                          latency->submit_time_us - latency->layout_time_us);
+
+  if (latency->presentation_time_us)
+    {
+      g_string_append_printf (description,
+                              ", submit to presentation %ld µs, "
+                              "input to presentation %ld µs",
+                              latency->presentation_time_us -
+                              latency->submit_time_us,
+                              latency->presentation_time_us -
+                              latency->input_time_us);
+    }
+
+  trace_head = (CoglTraceHead) {
+    .begin_time = latency->input_time_us * 1000,
+    .name = "Clutter::StageView::frame_latency()",
+  };
+  cogl_trace_describe (&trace_head, description->str);
+  cogl_trace_end (&trace_head);
+#endif
+}
+
 void
 clutter_stage_view_notify_presented (ClutterStageView *view,
                                      ClutterFrameInfo *frame_info)
@@ -1124,10 +1947,88 @@ clutter_stage_view_notify_presented (ClutterStageView *view,
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
+  priv->frame_latency.has_presented = priv->frame_latency.n_pending > 0;
+  if (priv->frame_latency.n_pending > 0)
+    {
+      priv->frame_latency.presented = priv->frame_latency.pending[0];
+      priv->frame_latency.presented.presentation_time_us =
+        frame_info->presentation_time;
+      priv->frame_latency.pending[0] = priv->frame_latency.pending[1];
+      priv->frame_latency.n_pending--;
+
+      trace_frame_latency (view);
+    }
+
+  collect_gpu_phases (view, frame_info);
+  update_presented_frame_stats (view, frame_info);
+
   clutter_stage_presented (priv->stage, view, frame_info);
   clutter_frame_clock_notify_presented (priv->frame_clock, frame_info);
 }
 
+/**
+ * clutter_stage_view_peek_frame_latency:
+ * @view: a #ClutterStageView
+ *
+ * Returns: (nullable): the latency record of the frame that was most
+ *   recently presented, or %NULL if it wasn't painted by the stage
+ */
+const ClutterFrameLatency *
+clutter_stage_view_peek_frame_latency (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (!priv->frame_latency.has_presented)
+    return NULL;
+
+  return &priv->frame_latency.presented;
+}
+
+/**
+ * clutter_stage_view_foreach_frame_stats: (skip)
+ * @view: a #ClutterStageView
+ * @func: function called for each record
+ * @user_data: user data passed to @func
+ *
+ * Calls @func for the timings of the most recently painted frames, from
+ * the oldest to the newest one.
+ */
+void
+clutter_stage_view_foreach_frame_stats (ClutterStageView      *view,
+                                        ClutterFrameStatsFunc  func,
+                                        gpointer               user_data)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  int age;
+
+  for (age = (int) priv->frame_stats.n_frames - 1; age >= 0; age--)
+    func (get_frame_stats (view, age), user_data);
+}
+
+/**
+ * clutter_stage_view_capture_next_frame:
+ * @view: a #ClutterStageView
+ * @path: the file to write the capture to
+ *
+ * Schedules a full redraw of @view, and records the Cogl drawing of it
+ * into a capture written to @path, to be replayed offline.
+ */
+void
+clutter_stage_view_capture_next_frame (ClutterStageView *view,
+                                       const char       *path)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  g_free (priv->capture_path);
+  priv->capture_path = g_strdup (path);
+
+  clutter_stage_view_add_redraw_clip (view, NULL);
+  clutter_stage_view_schedule_update (view);
+}
+
 void
 clutter_stage_view_notify_ready (ClutterStageView *view)
 {
@@ -1329,16 +2230,25 @@ clutter_stage_view_dispose (GObject *object)
 
   g_clear_pointer (&priv->name, g_free);
 
-  g_clear_object (&priv->shadow.framebuffer);
+  clear_shadowfb (view);
 
   g_clear_object (&priv->color_state);
   g_clear_object (&priv->offscreen);
   g_clear_object (&priv->offscreen_pipeline);
-  g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+  mtk_region_builder_clear (&priv->redraw_clip);
   g_clear_pointer (&priv->accumulated_redraw_clip, mtk_region_unref);
   g_clear_pointer (&priv->frame_clock, clutter_frame_clock_destroy);
   g_clear_handle_id (&priv->ensure_offscreen_idle_id, g_source_remove);
 
+  if (priv->gpu_phases.current)
+    free_gpu_phase_spans (view, g_steal_pointer (&priv->gpu_phases.current));
+  while (priv->gpu_phases.n_pending > 0)
+    {
+      priv->gpu_phases.n_pending--;
+      free_gpu_phase_spans (view,
+                            priv->gpu_phases.pending[priv->gpu_phases.n_pending]);
+    }
+
   G_OBJECT_CLASS (clutter_stage_view_parent_class)->dispose (object);
 }
 
@@ -1350,6 +2260,7 @@ clutter_stage_view_finalize (GObject *object)
     clutter_stage_view_get_instance_private (view);
 
   g_clear_object (&priv->framebuffer);
+  g_clear_pointer (&priv->capture_path, g_free);
 
   G_OBJECT_CLASS (clutter_stage_view_parent_class)->finalize (object);
 }
@@ -1362,6 +2273,7 @@ clutter_stage_view_init (ClutterStageView *view)
 
   priv->dirty_viewport = TRUE;
   priv->dirty_projection = TRUE;
+  mtk_region_builder_init (&priv->redraw_clip);
   priv->scale = 1.0;
   priv->refresh_rate = 60.0;
 }
@@ -101,6 +101,10 @@ typedef struct _PointerDeviceEntry
   ClutterActor *current_actor;
   MtkRegion *clear_area;
 
+  /* pick generation current_actor was picked at, if it was picked */
+  unsigned int pick_generation;
+  gboolean pick_valid;
+
   unsigned int press_count;
   ClutterActor *implicit_grab_actor;
   GArray *event_emission_chain;
@@ -123,6 +127,10 @@ typedef struct _ClutterStagePrivate
   ClutterGrabState grab_state;
 
   GQueue *event_queue;
+
+  /* Oldest input event of the last processed batch, for frame latency */
+  int64_t input_time_us;
+  unsigned int input_serial;
   GPtrArray *cur_event_actors;
   GArray *cur_event_emission_chain;
 
@@ -132,11 +140,25 @@ typedef struct _ClutterStagePrivate
 
   gboolean update_scheduled;
 
+  /* The view whose frame is currently being dispatched, if any */
+  ClutterStageView *updating_view;
+
   GHashTable *pointer_devices;
   GHashTable *touch_sequences;
 
   GPtrArray *all_active_gestures;
 
+  /* Unculled pick stack reused while the scene doesn't change, and the
+   * actor whose subtree changed since it was last updated.
+   */
+  ClutterPickStack *pick_cache;
+  ClutterPickMode pick_cache_mode;
+  ClutterActor *pick_cache_dirty_root;
+  gboolean pick_cache_wanted;
+
+  /* Bumped whenever anything that can change a pick result changes */
+  unsigned int pick_generation;
+
   guint actor_needs_immediate_relayout : 1;
   gboolean is_active;
 } ClutterStagePrivate;
@@ -234,15 +256,41 @@ clutter_stage_get_preferred_height (ClutterActor *self,
     *natural_height_p = geom.height;
 }
 
+static void
+report_redraw_actor (ClutterStageView   *view,
+                     ClutterActor       *actor,
+                     const MtkRectangle *clip)
+{
+  const char *actor_name =
+    actor ? _clutter_actor_get_debug_name (actor) : "<unknown>";
+
+  if (clip)
+    {
+      g_message ("Redraw of view %s (%d,%d %dx%d) caused by %s",
+                 clutter_stage_view_get_name (view),
+                 clip->x, clip->y, clip->width, clip->height,
+                 actor_name);
+    }
+  else
+    {
+      g_message ("Full redraw of view %s caused by %s",
+                 clutter_stage_view_get_name (view),
+                 actor_name);
+    }
+}
+
 static void
 clutter_stage_add_redraw_clip (ClutterStage *stage,
+                               ClutterActor *actor,
                                MtkRectangle *clip)
 {
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   GList *l;
 
   for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
     {
       ClutterStageView *view = l->data;
+      MtkRectangle intersection;
 
       if (!clip)
         {
@@ -251,13 +299,25 @@ clutter_stage_add_redraw_clip (ClutterStage *stage,
       else
         {
           MtkRectangle view_layout;
-          MtkRectangle intersection;
 
           clutter_stage_view_get_layout (view, &view_layout);
-          if (mtk_rectangle_intersect (&view_layout, clip,
-                                       &intersection))
-            clutter_stage_view_add_redraw_clip (view, &intersection);
+          if (!mtk_rectangle_intersect (&view_layout, clip,
+                                        &intersection))
+            continue;
+
+          clutter_stage_view_add_redraw_clip (view, &intersection);
         }
+
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_ACTORS))
+        report_redraw_actor (view, actor, clip ? &intersection : NULL);
+
+      /* Actors only schedule updates of the views they were on when the
+       * redraw was queued, so make sure views they moved onto since then
+       * get updated too. The view being dispatched consumes its redraw
+       * clip in the current frame already.
+       */
+      if (view != priv->updating_view)
+        clutter_stage_view_schedule_update (view);
     }
 }
 
@@ -279,7 +339,7 @@ queue_full_redraw (ClutterStage *stage)
   if (stage_window == NULL)
     return;
 
-  clutter_stage_add_redraw_clip (stage, NULL);
+  clutter_stage_add_redraw_clip (stage, NULL, NULL);
 }
 
 static void
@@ -495,6 +555,10 @@ clutter_stage_emit_before_update (ClutterStage     *stage,
                                   ClutterStageView *view,
                                   ClutterFrame     *frame)
 {
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  priv->updating_view = view;
+
   g_signal_emit (stage, stage_signals[BEFORE_UPDATE], 0, view, frame);
 }
 
@@ -532,6 +596,7 @@ clutter_stage_after_update (ClutterStage     *stage,
   g_signal_emit (stage, stage_signals[AFTER_UPDATE], 0, view, frame);
 
   priv->update_scheduled = FALSE;
+  priv->updating_view = NULL;
 }
 
 static gboolean
@@ -746,6 +811,7 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
   GList *events, *l;
+  int64_t input_time_us = 0;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
@@ -773,10 +839,16 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
       ClutterInputDevice *device;
       ClutterInputDevice *next_device;
       gboolean check_device = FALSE;
+      int64_t event_time_us;
 
       event = l->data;
       next_event = l->next ? l->next->data : NULL;
 
+      event_time_us = clutter_event_get_time_us (event);
+      if (event_time_us > 0 &&
+          (!input_time_us || event_time_us < input_time_us))
+        input_time_us = event_time_us;
+
       COGL_TRACE_BEGIN_SCOPED (ProcessEvent,
                                "Clutter::Stage::process_queued_events#event()");
       COGL_TRACE_DESCRIBE (ProcessEvent, clutter_event_get_name (event));
@@ -846,9 +918,36 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 
   g_list_free (events);
 
+  if (input_time_us)
+    {
+      priv->input_time_us = input_time_us;
+      priv->input_serial++;
+    }
+
   g_object_unref (stage);
 }
 
+/*
+ * clutter_stage_consume_input_time:
+ * @stage: a #ClutterStage
+ * @input_serial: (inout): serial of the last consumed event batch
+ *
+ * Returns: the time of the oldest input event processed since the batch
+ *   identified by @input_serial, or 0 if there was none.
+ */
+int64_t
+clutter_stage_consume_input_time (ClutterStage *stage,
+                                  unsigned int *input_serial)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  if (*input_serial == priv->input_serial)
+    return 0;
+
+  *input_serial = priv->input_serial;
+  return priv->input_time_us;
+}
+
 void
 clutter_stage_queue_actor_relayout (ClutterStage *stage,
                                     ClutterActor *actor)
@@ -932,8 +1031,11 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
 
       CLUTTER_SET_PRIVATE_FLAGS (queued_actor, CLUTTER_IN_RELAYOUT);
 
-      clutter_actor_get_fixed_position (queued_actor, &x, &y);
-      clutter_actor_allocate_preferred_size (queued_actor, x, y);
+      if (!clutter_actor_reallocate_relayout_boundary (queued_actor))
+        {
+          clutter_actor_get_fixed_position (queued_actor, &x, &y);
+          clutter_actor_allocate_preferred_size (queued_actor, x, y);
+        }
 
       CLUTTER_UNSET_PRIVATE_FLAGS (queued_actor, CLUTTER_IN_RELAYOUT);
 
@@ -1040,6 +1142,140 @@ setup_ray_for_coordinates (ClutterStage       *stage,
   graphene_point3d_init_from_point (point, &p);
 }
 
+static void
+clear_pick_cache (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  g_clear_pointer (&priv->pick_cache, clutter_pick_stack_unref);
+  g_clear_object (&priv->pick_cache_dirty_root);
+  priv->pick_cache_wanted = FALSE;
+}
+
+void
+clutter_stage_invalidate_pick (ClutterStage *stage,
+                               ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  ClutterActor *root;
+
+  priv->pick_generation++;
+
+  if (!priv->pick_cache)
+    {
+      priv->pick_cache_wanted = FALSE;
+      return;
+    }
+
+  if (actor == CLUTTER_ACTOR (stage))
+    {
+      clear_pick_cache (stage);
+      return;
+    }
+
+  if (!priv->pick_cache_dirty_root)
+    {
+      priv->pick_cache_dirty_root = g_object_ref (actor);
+      return;
+    }
+
+  /* Only a single subtree is logged again, so widen it until it contains
+   * every changed actor.
+   */
+  root = priv->pick_cache_dirty_root;
+  while (root && !clutter_actor_contains (root, actor))
+    root = clutter_actor_get_parent (root);
+
+  if (!root || root == CLUTTER_ACTOR (stage))
+    {
+      clear_pick_cache (stage);
+      return;
+    }
+
+  g_set_object (&priv->pick_cache_dirty_root, root);
+}
+
+static gboolean
+update_pick_cache (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  g_autoptr (ClutterActor) root = NULL;
+  ClutterPickContext *pick_context;
+
+  COGL_TRACE_BEGIN_SCOPED (ClutterStageUpdatePickCache,
+                           "Clutter::Stage::update_pick_cache()");
+
+  root = g_steal_pointer (&priv->pick_cache_dirty_root);
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (root))
+    return FALSE;
+
+  if (!clutter_pick_stack_begin_update (priv->pick_cache, root))
+    return FALSE;
+
+  pick_context = clutter_pick_context_new_for_stack (priv->pick_cache,
+                                                     priv->pick_cache_mode);
+  clutter_actor_pick (root, pick_context);
+  clutter_pick_context_destroy (pick_context);
+
+  clutter_pick_stack_end_update (priv->pick_cache);
+
+  return TRUE;
+}
+
+static ClutterPickStack *
+ensure_pick_cache (ClutterStage    *stage,
+                   ClutterPickMode  mode)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  ClutterContext *context;
+  ClutterBackend *backend;
+  CoglContext *cogl_context;
+  ClutterPickContext *pick_context;
+  ClutterPickStack *pick_stack;
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_DISABLE_PICK_CACHE))
+    return NULL;
+
+  if (priv->pick_cache && priv->pick_cache_mode != mode)
+    clear_pick_cache (stage);
+
+  if (priv->pick_cache && priv->pick_cache_dirty_root &&
+      !update_pick_cache (stage))
+    clear_pick_cache (stage);
+
+  if (priv->pick_cache)
+    return clutter_pick_stack_ref (priv->pick_cache);
+
+  /* An unculled stack costs more to build than picking a single point, so
+   * only build one once the scene stayed the same for a second pick.
+   */
+  if (!priv->pick_cache_wanted || priv->pick_cache_mode != mode)
+    {
+      priv->pick_cache_wanted = TRUE;
+      priv->pick_cache_mode = mode;
+      return NULL;
+    }
+
+  COGL_TRACE_BEGIN_SCOPED (ClutterStageBuildPickCache,
+                           "Clutter::Stage::build_pick_cache()");
+
+  context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
+  backend = clutter_context_get_backend (context);
+  cogl_context = clutter_backend_get_cogl_context (backend);
+
+  pick_stack = clutter_pick_stack_new (cogl_context);
+  pick_context = clutter_pick_context_new_for_stack (pick_stack, mode);
+  clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
+  clutter_pick_context_destroy (pick_context);
+  clutter_pick_stack_seal (pick_stack);
+
+  priv->pick_cache = pick_stack;
+  priv->pick_cache_mode = mode;
+
+  return clutter_pick_stack_ref (pick_stack);
+}
+
 static ClutterActor *
 _clutter_stage_do_pick_on_view (ClutterStage      *stage,
                                 float              x,
@@ -1061,14 +1297,19 @@ _clutter_stage_do_pick_on_view (ClutterStage      *stage,
 
   setup_ray_for_coordinates (stage, x, y, &p, &ray);
 
-  context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
-  backend = clutter_context_get_backend (context);
-  cogl_context = clutter_backend_get_cogl_context (backend);
-  pick_context = clutter_pick_context_new_for_view (view, cogl_context, mode, &p, &ray);
-
-  clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
-  pick_stack = clutter_pick_context_steal_stack (pick_context);
-  clutter_pick_context_destroy (pick_context);
+  pick_stack = ensure_pick_cache (stage, mode);
+  if (!pick_stack)
+    {
+      context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
+      backend = clutter_context_get_backend (context);
+      cogl_context = clutter_backend_get_cogl_context (backend);
+      pick_context = clutter_pick_context_new_for_view (view, cogl_context,
+                                                        mode, &p, &ray);
+
+      clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
+      pick_stack = clutter_pick_context_steal_stack (pick_context);
+      clutter_pick_context_destroy (pick_context);
+    }
 
   actor = clutter_pick_stack_search_actor (pick_stack, &p, &ray, clear_area);
   return actor ? actor : CLUTTER_ACTOR (stage);
@@ -1336,6 +1577,8 @@ clutter_stage_dispose (GObject *object)
   g_hash_table_remove_all (priv->pointer_devices);
   g_hash_table_remove_all (priv->touch_sequences);
 
+  clear_pick_cache (stage);
+
   G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
 }
 
@@ -2490,6 +2733,7 @@ clutter_stage_schedule_update (ClutterStage *stage)
 
 void
 clutter_stage_add_to_redraw_clip (ClutterStage       *stage,
+                                  ClutterActor       *actor,
                                   ClutterPaintVolume *redraw_clip)
 {
   ClutterStageWindow *stage_window;
@@ -2509,7 +2753,7 @@ clutter_stage_add_to_redraw_clip (ClutterStage       *stage,
 
   if (redraw_clip == NULL)
     {
-      clutter_stage_add_redraw_clip (stage, NULL);
+      clutter_stage_add_redraw_clip (stage, actor, NULL);
       return;
     }
 
@@ -2540,7 +2784,7 @@ clutter_stage_add_to_redraw_clip (ClutterStage       *stage,
   stage_clip.width = (int) (intersection_box.x2 - stage_clip.x);
   stage_clip.height = (int) (intersection_box.y2 - stage_clip.y);
 
-  clutter_stage_add_redraw_clip (stage, &stage_clip);
+  clutter_stage_add_redraw_clip (stage, actor, &stage_clip);
 }
 
 int64_t
@@ -3042,6 +3286,8 @@ clutter_stage_update_device_entry (ClutterStage         *self,
   g_clear_pointer (&entry->clear_area, mtk_region_unref);
   if (clear_area)
     entry->clear_area = mtk_region_ref (clear_area);
+
+  entry->pick_valid = FALSE;
 }
 
 void
@@ -3478,14 +3724,21 @@ clutter_stage_update_device (ClutterStage         *stage,
     }
 }
 
+/* Whether the actor last picked for the device is still the one at
+ * @point. Without @ignore_cache, being within the clear area of the last
+ * pick is enough. Otherwise nothing may have changed in the scene since
+ * that pick, which the pick generation tells.
+ */
 static gboolean
 clutter_stage_check_in_clear_area (ClutterStage         *stage,
                                    ClutterInputDevice   *device,
                                    ClutterEventSequence *sequence,
-                                   graphene_point_t      point)
+                                   graphene_point_t      point,
+                                   gboolean              ignore_cache)
 {
   ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   PointerDeviceEntry *entry = NULL;
+  gboolean scene_unchanged;
 
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
   g_return_val_if_fail (device != NULL, FALSE);
@@ -3497,6 +3750,16 @@ clutter_stage_check_in_clear_area (ClutterStage         *stage,
 
   if (!entry)
     return FALSE;
+
+  scene_unchanged = entry->pick_valid &&
+                    entry->pick_generation == priv->pick_generation;
+
+  if (ignore_cache && !scene_unchanged)
+    return FALSE;
+
+  if (scene_unchanged && graphene_point_equal (&entry->coords, &point))
+    return TRUE;
+
   if (!entry->clear_area)
     return FALSE;
 
@@ -3504,6 +3767,26 @@ clutter_stage_check_in_clear_area (ClutterStage         *stage,
                                     (int) point.x, (int) point.y);
 }
 
+static void
+clutter_stage_mark_device_picked (ClutterStage         *stage,
+                                  ClutterInputDevice   *device,
+                                  ClutterEventSequence *sequence)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  PointerDeviceEntry *entry = NULL;
+
+  if (sequence != NULL)
+    entry = g_hash_table_lookup (priv->touch_sequences, sequence);
+  else
+    entry = g_hash_table_lookup (priv->pointer_devices, device);
+
+  if (!entry)
+    return;
+
+  entry->pick_generation = priv->pick_generation;
+  entry->pick_valid = TRUE;
+}
+
 static ClutterActor *
 clutter_stage_pick_and_update_device (ClutterStage             *stage,
                                       ClutterInputDevice       *device,
@@ -3523,15 +3806,12 @@ clutter_stage_pick_and_update_device (ClutterStage             *stage,
       device != clutter_seat_get_pointer (seat) ||
       clutter_seat_is_unfocus_inhibited (seat))
     {
-      if ((flags & CLUTTER_DEVICE_UPDATE_IGNORE_CACHE) == 0)
+      if (clutter_stage_check_in_clear_area (stage, device, sequence, point,
+                                             !!(flags & CLUTTER_DEVICE_UPDATE_IGNORE_CACHE)))
         {
-          if (clutter_stage_check_in_clear_area (stage, device,
-                                                 sequence, point))
-            {
-              clutter_stage_set_device_coords (stage, device,
-                                               sequence, point);
-              return clutter_stage_get_device_actor (stage, device, sequence);
-            }
+          clutter_stage_set_device_coords (stage, device,
+                                           sequence, point);
+          return clutter_stage_get_device_actor (stage, device, sequence);
         }
 
       new_actor = _clutter_stage_do_pick (stage,
@@ -3553,6 +3833,9 @@ clutter_stage_pick_and_update_device (ClutterStage             *stage,
                                clear_area,
                                !!(flags & CLUTTER_DEVICE_UPDATE_EMIT_CROSSING));
 
+  if (new_actor)
+    clutter_stage_mark_device_picked (stage, device, sequence);
+
   g_clear_pointer (&clear_area, mtk_region_unref);
 
   return new_actor;
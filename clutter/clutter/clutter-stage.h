@@ -109,6 +109,11 @@ typedef enum
    * happen.
    */
   CLUTTER_FRAME_INFO_FLAG_VSYNC = 1 << 2,
+  /*
+   * The presentation timestamp comes from a completion event delivered by the
+   * display hardware, e.g. a page flip event, rather than being estimated.
+   */
+  CLUTTER_FRAME_INFO_FLAG_HW_COMPLETION = 1 << 3,
 } ClutterFrameInfoFlag;
 
 /**
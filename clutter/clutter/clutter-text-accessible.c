@@ -125,7 +125,8 @@ static void                 _cally_text_delete_text_cb           (ClutterText *c
                                                                   gint         start_pos,
                                                                   gint         end_pos,
                                                                   gpointer     data);
-static gboolean             _idle_notify_insert                  (gpointer data);
+static gboolean             _idle_notify_changes                 (gpointer data);
+static void                 _queue_notify_changes                (ClutterTextAccessible *cally_text);
 static void                 _notify_insert                       (ClutterTextAccessible *cally_text);
 static void                 _notify_delete                       (ClutterTextAccessible *cally_text);
 
@@ -214,7 +215,12 @@ struct _ClutterTextAccessible
   const gchar *signal_name_insert;
   gint position_insert;
   gint length_insert;
-  guint insert_idle_handler;
+
+  /* text_caret_moved and text_selection_changed stuff */
+  gboolean caret_moved;
+  gboolean selection_changed;
+
+  guint notify_idle_handler;
 
   /* text_changed::delete stuff */
   const gchar *signal_name_delete;
@@ -258,7 +264,9 @@ clutter_text_accessible_init (ClutterTextAccessible *self)
   self->signal_name_insert = NULL;
   self->position_insert = -1;
   self->length_insert = -1;
-  self->insert_idle_handler = 0;
+  self->caret_moved = FALSE;
+  self->selection_changed = FALSE;
+  self->notify_idle_handler = 0;
 
   self->signal_name_delete = NULL;
   self->position_delete = -1;
@@ -271,7 +279,7 @@ cally_text_finalize   (GObject *obj)
 {
   ClutterTextAccessible *self = CLUTTER_TEXT_ACCESSIBLE (obj);
 
-  g_clear_handle_id (&self->insert_idle_handler, g_source_remove);
+  g_clear_handle_id (&self->notify_idle_handler, g_source_remove);
   g_clear_handle_id (&self->action_idle_handler, g_source_remove);
   g_clear_pointer (&self->action_queue, g_queue_free);
 
@@ -1563,6 +1571,9 @@ _cally_text_delete_text_cb (ClutterText *clutter_text,
 
   self = CLUTTER_TEXT_ACCESSIBLE (data);
 
+  /* Keep the order of the changes */
+  _notify_insert (self);
+
   if (!self->signal_name_delete)
     {
       self->signal_name_delete = "text_changed::delete";
@@ -1586,20 +1597,24 @@ _cally_text_insert_text_cb (ClutterText *clutter_text,
 
   self = CLUTTER_TEXT_ACCESSIBLE (data);
 
-  if (!self->signal_name_insert)
+  /* Insertions right after the pending one, as when typing, are merged
+   * into a single change; anything else flushes the pending one first.
+   */
+  if (self->signal_name_insert &&
+      *position == self->position_insert + self->length_insert)
+    {
+      self->length_insert += g_utf8_strlen (new_text, new_text_length);
+    }
+  else
     {
+      _notify_insert (self);
+
       self->signal_name_insert = "text_changed::insert";
       self->position_insert = *position;
       self->length_insert = g_utf8_strlen (new_text, new_text_length);
     }
 
-  /*
-   * The signal will be emitted when the cursor position is updated,
-   * or in an idle handler if it not updated.
-   */
-  if (self->insert_idle_handler == 0)
-    self->insert_idle_handler = clutter_threads_add_idle (_idle_notify_insert,
-                                                          self);
+  _queue_notify_changes (self);
 }
 
 /***** atkeditabletext.h ******/
@@ -1697,15 +1712,18 @@ cally_text_notify_clutter (GObject    *obj,
     {
       /* the selection can change also for the cursor position */
       if (_check_for_selection_change (self, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        self->selection_changed = TRUE;
 
-      g_signal_emit_by_name (atk_obj, "text_caret_moved",
-                             clutter_text_get_cursor_position (clutter_text));
+      self->caret_moved = TRUE;
+      _queue_notify_changes (self);
     }
   else if (g_strcmp0 (pspec->name, "selection-bound") == 0)
     {
       if (_check_for_selection_change (self, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        {
+          self->selection_changed = TRUE;
+          _queue_notify_changes (self);
+        }
     }
   else if (g_strcmp0 (pspec->name, "activatable") == 0)
     {
@@ -1749,17 +1767,51 @@ _check_for_selection_change (ClutterTextAccessible *self,
   return ret_val;
 }
 
+/*
+ * Text insertions, caret movements and selection changes are emitted
+ * together from an idle, so that a burst of edits (typing, pasting,
+ * key repeat) is reported once per main loop iteration rather than
+ * once per character. Deletions are still emitted right away, while
+ * the deleted text can be retrieved.
+ */
 static gboolean
-_idle_notify_insert (gpointer data)
+_idle_notify_changes (gpointer data)
 {
   ClutterTextAccessible *self = CLUTTER_TEXT_ACCESSIBLE (data);
-  self->insert_idle_handler = 0;
+  ClutterActor *actor;
+
+  self->notify_idle_handler = 0;
 
   _notify_insert (self);
 
+  actor = CLUTTER_ACTOR_FROM_ACCESSIBLE (self);
+  if (actor == NULL) /* State is defunct */
+    return FALSE;
+
+  if (self->selection_changed)
+    {
+      self->selection_changed = FALSE;
+      g_signal_emit_by_name (self, "text_selection_changed");
+    }
+
+  if (self->caret_moved)
+    {
+      self->caret_moved = FALSE;
+      g_signal_emit_by_name (self, "text_caret_moved",
+                             clutter_text_get_cursor_position (CLUTTER_TEXT (actor)));
+    }
+
   return FALSE;
 }
 
+static void
+_queue_notify_changes (ClutterTextAccessible *self)
+{
+  if (self->notify_idle_handler == 0)
+    self->notify_idle_handler = clutter_threads_add_idle (_idle_notify_changes,
+                                                          self);
+}
+
 static void
 _notify_insert (ClutterTextAccessible *self)
 {
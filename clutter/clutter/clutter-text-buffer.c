@@ -75,6 +75,13 @@ typedef struct _ClutterTextBufferPrivate
   gsize normal_text_size;
   gsize normal_text_bytes;
   guint normal_text_chars;
+
+  /* A known character offset to byte offset mapping, usually the end of
+   * the last edit. Edits tend to happen next to each other, so walking
+   * from here is much shorter than walking from the start of long text.
+   */
+  guint normal_hint_chars;
+  gsize normal_hint_bytes;
 } ClutterTextBufferPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterTextBuffer, clutter_text_buffer, G_TYPE_OBJECT)
@@ -97,6 +104,53 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+static gsize
+clutter_text_buffer_normal_offset_to_bytes (ClutterTextBufferPrivate *pv,
+                                            guint                     position)
+{
+  const gchar *p;
+  guint chars;
+
+  if (position == pv->normal_text_chars)
+    return pv->normal_text_bytes;
+
+  if (pv->normal_hint_chars > pv->normal_text_chars)
+    {
+      pv->normal_hint_chars = 0;
+      pv->normal_hint_bytes = 0;
+    }
+
+  if (position >= pv->normal_hint_chars)
+    {
+      if (position - pv->normal_hint_chars <= pv->normal_text_chars - position)
+        {
+          return (g_utf8_offset_to_pointer (pv->normal_text + pv->normal_hint_bytes,
+                                            position - pv->normal_hint_chars) -
+                  pv->normal_text);
+        }
+
+      p = pv->normal_text + pv->normal_text_bytes;
+      chars = pv->normal_text_chars;
+    }
+  else
+    {
+      if (position <= pv->normal_hint_chars - position)
+        return g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+
+      p = pv->normal_text + pv->normal_hint_bytes;
+      chars = pv->normal_hint_chars;
+    }
+
+  /* Walk backwards to the position */
+  while (chars > position)
+    {
+      p = g_utf8_prev_char (p);
+      chars--;
+    }
+
+  return p - pv->normal_text;
+}
+
 static const gchar*
 clutter_text_buffer_normal_get_text (ClutterTextBuffer *buffer,
                                      gsize             *n_bytes)
@@ -171,7 +225,7 @@ clutter_text_buffer_normal_insert_text (ClutterTextBuffer *buffer,
     }
 
   /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
+  at = clutter_text_buffer_normal_offset_to_bytes (pv, position);
   memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
   memcpy (pv->normal_text + at, chars, n_bytes);
 
@@ -179,6 +233,8 @@ clutter_text_buffer_normal_insert_text (ClutterTextBuffer *buffer,
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
   pv->normal_text[pv->normal_text_bytes] = '\0';
+  pv->normal_hint_chars = position + n_chars;
+  pv->normal_hint_bytes = at + n_bytes;
 
   clutter_text_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -200,12 +256,14 @@ clutter_text_buffer_normal_delete_text (ClutterTextBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      start = clutter_text_buffer_normal_offset_to_bytes (pv, position);
+      end = g_utf8_offset_to_pointer (pv->normal_text + start, n_chars) - pv->normal_text;
 
       memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
       pv->normal_text_chars -= n_chars;
       pv->normal_text_bytes -= (end - start);
+      pv->normal_hint_chars = position;
+      pv->normal_hint_bytes = start;
 
       /*
        * Could be a password, make sure we don't leave anything sensitive after
@@ -273,6 +331,8 @@ clutter_text_buffer_finalize (GObject *obj)
       pv->normal_text = NULL;
       pv->normal_text_bytes = pv->normal_text_size = 0;
       pv->normal_text_chars = 0;
+      pv->normal_hint_chars = 0;
+      pv->normal_hint_bytes = 0;
     }
 
   G_OBJECT_CLASS (clutter_text_buffer_parent_class)->finalize (obj);
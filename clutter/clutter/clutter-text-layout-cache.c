@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A cache of shaped PangoLayouts shared by all ClutterText actors.
+ *
+ * Laying out text is the expensive part of creating a layout, so
+ * ClutterText builds a fresh, not yet laid out layout and looks up an
+ * equivalent one here before using it. Layouts are considered
+ * equivalent if they would produce the same lines, that is, if they
+ * have the same text, font, attributes, size, wrapping and ellipsizing
+ * configuration, and their context has the same base direction.
+ *
+ * Layouts in the cache are shared, so they must never be modified.
+ */
+
+#include "config.h"
+
+#include "clutter/clutter-text-layout-cache.h"
+
+#include "clutter/clutter-debug.h"
+
+#define MAX_CACHED_LAYOUTS 256
+
+#define STATS_INTERVAL 256
+
+typedef struct _ClutterTextLayoutCacheEntry
+{
+  PangoLayout *layout;
+
+  /* link in the lru queue, most recently used first */
+  GList link;
+} ClutterTextLayoutCacheEntry;
+
+struct _ClutterTextLayoutCache
+{
+  ClutterBackend *backend;
+  gulong resolution_changed_id;
+  gulong font_changed_id;
+
+  GHashTable *entries;
+  GQueue lru;
+
+  unsigned int n_hits;
+  unsigned int n_misses;
+};
+
+static guint
+layout_hash (gconstpointer data)
+{
+  PangoLayout *layout = (PangoLayout *) data;
+  const PangoFontDescription *font_desc;
+  guint hash;
+
+  hash = g_str_hash (pango_layout_get_text (layout));
+
+  font_desc = pango_layout_get_font_description (layout);
+  if (font_desc)
+    hash = hash * 31 + pango_font_description_hash (font_desc);
+
+  hash = hash * 31 + pango_layout_get_width (layout);
+  hash = hash * 31 + pango_layout_get_height (layout);
+  hash = hash * 31 + pango_layout_get_ellipsize (layout);
+
+  return hash;
+}
+
+static gboolean
+font_description_equal (const PangoFontDescription *a,
+                        const PangoFontDescription *b)
+{
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  return pango_font_description_equal (a, b);
+}
+
+static gboolean
+attr_list_equal (PangoAttrList *a,
+                 PangoAttrList *b)
+{
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  return pango_attr_list_equal (a, b);
+}
+
+static gboolean
+layout_equal (gconstpointer data_a,
+              gconstpointer data_b)
+{
+  PangoLayout *a = (PangoLayout *) data_a;
+  PangoLayout *b = (PangoLayout *) data_b;
+  PangoContext *context_a = pango_layout_get_context (a);
+  PangoContext *context_b = pango_layout_get_context (b);
+
+  return (pango_layout_get_width (a) == pango_layout_get_width (b) &&
+          pango_layout_get_height (a) == pango_layout_get_height (b) &&
+          pango_layout_get_ellipsize (a) == pango_layout_get_ellipsize (b) &&
+          pango_layout_get_wrap (a) == pango_layout_get_wrap (b) &&
+          pango_layout_get_alignment (a) == pango_layout_get_alignment (b) &&
+          pango_layout_get_justify (a) == pango_layout_get_justify (b) &&
+          pango_layout_get_single_paragraph_mode (a) ==
+          pango_layout_get_single_paragraph_mode (b) &&
+          pango_layout_get_auto_dir (a) == pango_layout_get_auto_dir (b) &&
+          pango_layout_get_indent (a) == pango_layout_get_indent (b) &&
+          pango_layout_get_spacing (a) == pango_layout_get_spacing (b) &&
+          pango_context_get_base_dir (context_a) ==
+          pango_context_get_base_dir (context_b) &&
+          pango_context_get_font_map (context_a) ==
+          pango_context_get_font_map (context_b) &&
+          g_str_equal (pango_layout_get_text (a), pango_layout_get_text (b)) &&
+          font_description_equal (pango_layout_get_font_description (a),
+                                  pango_layout_get_font_description (b)) &&
+          font_description_equal (pango_context_get_font_description (context_a),
+                                  pango_context_get_font_description (context_b)) &&
+          attr_list_equal (pango_layout_get_attributes (a),
+                           pango_layout_get_attributes (b)));
+}
+
+static void
+clutter_text_layout_cache_entry_free (ClutterTextLayoutCacheEntry *entry)
+{
+  g_object_unref (entry->layout);
+  g_free (entry);
+}
+
+static void
+maybe_print_stats (ClutterTextLayoutCache *cache)
+{
+  unsigned int n_lookups = cache->n_hits + cache->n_misses;
+
+  if (n_lookups % STATS_INTERVAL != 0)
+    return;
+
+  CLUTTER_NOTE (PANGO,
+                "Text layout cache: %u hits, %u misses (%.1f%% hit rate), "
+                "%u cached layouts",
+                cache->n_hits,
+                cache->n_misses,
+                100.0 * cache->n_hits / n_lookups,
+                g_hash_table_size (cache->entries));
+}
+
+/*
+ * clutter_text_layout_cache_get_layout:
+ * @cache: a #ClutterTextLayoutCache
+ * @layout: a #PangoLayout that hasn't been laid out yet
+ *
+ * Looks up a cached layout equivalent to @layout, or adds @layout to
+ * the cache if there is none.
+ *
+ * Return value: (transfer full): the cached layout
+ */
+PangoLayout *
+clutter_text_layout_cache_get_layout (ClutterTextLayoutCache *cache,
+                                      PangoLayout            *layout)
+{
+  ClutterTextLayoutCacheEntry *entry;
+
+  entry = g_hash_table_lookup (cache->entries, layout);
+  if (entry)
+    {
+      cache->n_hits++;
+      maybe_print_stats (cache);
+
+      g_queue_unlink (&cache->lru, &entry->link);
+      g_queue_push_head_link (&cache->lru, &entry->link);
+
+      return g_object_ref (entry->layout);
+    }
+
+  cache->n_misses++;
+  maybe_print_stats (cache);
+
+  if (g_hash_table_size (cache->entries) >= MAX_CACHED_LAYOUTS)
+    {
+      GList *oldest = g_queue_pop_tail_link (&cache->lru);
+      ClutterTextLayoutCacheEntry *oldest_entry = oldest->data;
+
+      g_hash_table_remove (cache->entries, oldest_entry->layout);
+    }
+
+  entry = g_new0 (ClutterTextLayoutCacheEntry, 1);
+  entry->layout = g_object_ref (layout);
+  entry->link.data = entry;
+
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  g_hash_table_insert (cache->entries, entry->layout, entry);
+
+  return g_object_ref (layout);
+}
+
+void
+clutter_text_layout_cache_clear (ClutterTextLayoutCache *cache)
+{
+  g_queue_init (&cache->lru);
+  g_hash_table_remove_all (cache->entries);
+}
+
+ClutterTextLayoutCache *
+clutter_text_layout_cache_new (ClutterBackend *backend)
+{
+  ClutterTextLayoutCache *cache;
+
+  cache = g_new0 (ClutterTextLayoutCache, 1);
+  cache->backend = backend;
+  cache->entries =
+    g_hash_table_new_full (layout_hash, layout_equal,
+                           NULL,
+                           (GDestroyNotify) clutter_text_layout_cache_entry_free);
+  g_queue_init (&cache->lru);
+
+  /* The cached layouts were laid out for the old font options and
+   * resolution of their contexts */
+  cache->resolution_changed_id =
+    g_signal_connect_swapped (backend, "resolution-changed",
+                              G_CALLBACK (clutter_text_layout_cache_clear),
+                              cache);
+  cache->font_changed_id =
+    g_signal_connect_swapped (backend, "font-changed",
+                              G_CALLBACK (clutter_text_layout_cache_clear),
+                              cache);
+
+  return cache;
+}
+
+void
+clutter_text_layout_cache_free (ClutterTextLayoutCache *cache)
+{
+  g_clear_signal_handler (&cache->resolution_changed_id, cache->backend);
+  g_clear_signal_handler (&cache->font_changed_id, cache->backend);
+
+  clutter_text_layout_cache_clear (cache);
+  g_hash_table_unref (cache->entries);
+
+  g_free (cache);
+}
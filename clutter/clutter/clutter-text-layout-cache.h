@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <pango/pango.h>
+
+#include "clutter/clutter-backend.h"
+
+typedef struct _ClutterTextLayoutCache ClutterTextLayoutCache;
+
+ClutterTextLayoutCache * clutter_text_layout_cache_new (ClutterBackend *backend);
+
+void clutter_text_layout_cache_free (ClutterTextLayoutCache *cache);
+
+PangoLayout * clutter_text_layout_cache_get_layout (ClutterTextLayoutCache *cache,
+                                                    PangoLayout            *layout);
+
+void clutter_text_layout_cache_clear (ClutterTextLayoutCache *cache);
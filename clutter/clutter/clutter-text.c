@@ -52,6 +52,7 @@
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-backend-private.h"
 #include "clutter/clutter-binding-pool.h"
+#include "clutter/clutter-context-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-enum-types.h"
 #include "clutter/clutter-keysyms.h"
@@ -917,6 +918,10 @@ clutter_text_create_layout (ClutterText *text,
                             gfloat       allocation_height)
 {
   ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (text));
+  ClutterTextLayoutCache *layout_cache =
+    clutter_context_get_text_layout_cache (context);
+  g_autoptr (PangoLayout) layout = NULL;
   LayoutCache *oldest_cache = priv->cached_layouts;
   gboolean found_free_cache = FALSE;
   gint width = -1;
@@ -1067,12 +1072,16 @@ clutter_text_create_layout (ClutterText *text,
                 allocation_height);
 
   /* If we make it here then we didn't have a cached version so we
-     need to recreate the layout */
+   * need to recreate the layout. Creating it is cheap, laying it out
+   * isn't, so reuse an equivalent one laid out for another actor or
+   * an earlier allocation if there is one.
+   */
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
+  layout = clutter_text_create_layout_no_cache (text, width, height, ellipsize);
   oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+    clutter_text_layout_cache_get_layout (layout_cache, layout);
 
   clutter_ensure_glyph_cache_for_layout (oldest_cache->layout);
 
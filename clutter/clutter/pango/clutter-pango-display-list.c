@@ -67,6 +67,14 @@ typedef struct _PangoDisplayListNode
 
   CoglPipeline *pipeline;
 
+  /* The pipeline last used to draw the node, which is reused as long as
+     the color and color states don't change, instead of copying the
+     pipeline and setting up the color transformation on every paint */
+  CoglPipeline *draw_pipeline;
+  CoglColor draw_color;
+  ClutterColorState *draw_color_state;
+  ClutterColorState *draw_target_color_state;
+
   union
   {
     struct
@@ -240,6 +248,14 @@ clutter_pango_display_list_add_trapezoid (ClutterPangoDisplayList *dl,
   clutter_pango_display_list_append_node (dl, node);
 }
 
+static void
+clutter_pango_display_list_node_clear_draw_pipeline (PangoDisplayListNode *node)
+{
+  g_clear_object (&node->draw_pipeline);
+  g_clear_object (&node->draw_color_state);
+  g_clear_object (&node->draw_target_color_state);
+}
+
 static void
 emit_rectangles_through_journal (CoglFramebuffer *fb,
                                  CoglPipeline *pipeline,
@@ -402,21 +418,7 @@ clutter_pango_display_list_render (CoglFramebuffer          *fb,
     {
       PangoDisplayListNode *node = l->data;
       CoglColor draw_color;
-      g_autoptr (CoglPipeline) pipeline = NULL;
-
-      if (node->pipeline == NULL)
-        {
-          if (node->type == PANGO_DISPLAY_LIST_TEXTURE)
-            node->pipeline =
-              clutter_pango_pipeline_cache_get (dl->pipeline_cache,
-                                                node->d.texture.texture);
-          else
-            node->pipeline =
-              clutter_pango_pipeline_cache_get (dl->pipeline_cache,
-                                                NULL);
-        }
-
-      pipeline = cogl_pipeline_copy (node->pipeline);
+      CoglPipeline *pipeline;
 
       if (node->color_override)
         /* Use the override color but preserve the alpha from the
@@ -431,12 +433,41 @@ clutter_pango_display_list_render (CoglFramebuffer          *fb,
         draw_color = *color;
       cogl_color_premultiply (&draw_color);
 
-      cogl_pipeline_set_color (pipeline, &draw_color);
+      if (node->draw_pipeline == NULL ||
+          !cogl_color_equal (&node->draw_color, &draw_color) ||
+          node->draw_color_state != color_state ||
+          node->draw_target_color_state != target_color_state)
+        clutter_pango_display_list_node_clear_draw_pipeline (node);
 
+      if (node->draw_pipeline == NULL)
+        {
+          if (node->pipeline == NULL)
+            {
+              if (node->type == PANGO_DISPLAY_LIST_TEXTURE)
+                node->pipeline =
+                  clutter_pango_pipeline_cache_get (dl->pipeline_cache,
+                                                    node->d.texture.texture);
+              else
+                node->pipeline =
+                  clutter_pango_pipeline_cache_get (dl->pipeline_cache,
+                                                    NULL);
+            }
+
+          /* Never modify a pipeline that was drawn with, as that would
+             flush the journal entries still referencing it; build a new
+             one instead */
+          node->draw_pipeline = cogl_pipeline_copy (node->pipeline);
+          cogl_pipeline_set_color (node->draw_pipeline, &draw_color);
+          clutter_color_state_add_pipeline_transform (color_state,
+                                                      target_color_state,
+                                                      node->draw_pipeline);
+
+          node->draw_color = draw_color;
+          g_set_object (&node->draw_color_state, color_state);
+          g_set_object (&node->draw_target_color_state, target_color_state);
+        }
 
-      clutter_color_state_add_pipeline_transform (color_state,
-                                                  target_color_state,
-                                                  pipeline);
+      pipeline = node->draw_pipeline;
 
       switch (node->type)
         {
@@ -465,6 +496,8 @@ clutter_pango_display_list_render (CoglFramebuffer          *fb,
 static void
 clutter_pango_display_list_node_free (PangoDisplayListNode *node)
 {
+  clutter_pango_display_list_node_clear_draw_pipeline (node);
+
   if (node->type == PANGO_DISPLAY_LIST_TEXTURE)
     {
       g_array_free (node->d.texture.rectangles, TRUE);
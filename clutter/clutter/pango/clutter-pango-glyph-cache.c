@@ -36,6 +36,11 @@
 #include "clutter/pango/clutter-pango-glyph-cache.h"
 #include "clutter/pango/clutter-pango-private.h"
 
+/* Default budget for the glyphs in the global atlas, in bytes. It can
+ * be overridden in KiB through the CLUTTER_GLYPH_CACHE_SIZE environment
+ * variable. */
+#define DEFAULT_MAX_BYTES (8 * 1024 * 1024)
+
 struct _ClutterPangoGlyphCache
 {
   CoglContext *ctx;
@@ -59,12 +64,29 @@ struct _ClutterPangoGlyphCache
      optimization in clutter_pango_glyph_cache_set_dirty_glyphs to avoid
      iterating the hash table if we know none of them are dirty */
   gboolean has_dirty_glyphs;
+
+  /* Glyphs stored in the global atlas, most recently used first. Only
+     these can be evicted, as space in the local atlases can't be given
+     back */
+  GQueue lru;
+
+  /* Size of the glyphs in the lru queue and the budget for it */
+  size_t n_bytes;
+  size_t max_bytes;
+
+  /* Incremented each time glyphs are ensured for a layout */
+  unsigned int age;
 };
 
 typedef struct _PangoGlyphCacheKey
 {
   PangoFont  *font;
   PangoGlyph glyph;
+
+  /* Only used for glyphs in the global atlas */
+  GList lru_link;
+  size_t size;
+  unsigned int age;
 } PangoGlyphCacheKey;
 
 static void
@@ -111,6 +133,7 @@ ClutterPangoGlyphCache *
 clutter_pango_glyph_cache_new (CoglContext *ctx)
 {
   ClutterPangoGlyphCache *cache;
+  const char *env_string;
 
   cache = g_malloc (sizeof (ClutterPangoGlyphCache));
 
@@ -131,6 +154,23 @@ clutter_pango_glyph_cache_new (CoglContext *ctx)
 
   cache->using_global_atlas = FALSE;
 
+  g_queue_init (&cache->lru);
+  cache->n_bytes = 0;
+  cache->max_bytes = DEFAULT_MAX_BYTES;
+  cache->age = 0;
+
+  env_string = g_getenv ("CLUTTER_GLYPH_CACHE_SIZE");
+  if (env_string != NULL)
+    {
+      guint64 size_kib;
+
+      if (g_ascii_string_to_unsigned (env_string, 10, 1, G_MAXSIZE / 1024,
+                                      &size_kib, NULL))
+        cache->max_bytes = size_kib * 1024;
+      else
+        g_warning ("Invalid CLUTTER_GLYPH_CACHE_SIZE '%s'", env_string);
+    }
+
   return cache;
 }
 
@@ -156,6 +196,7 @@ clutter_pango_glyph_cache_free (ClutterPangoGlyphCache *cache)
   g_clear_pointer (&cache->atlases, g_slist_free);
   cache->has_dirty_glyphs = FALSE;
 
+  g_queue_init (&cache->lru);
   g_hash_table_remove_all (cache->hash_table);
   g_clear_pointer (&cache->hash_table, g_hash_table_unref);
 
@@ -289,17 +330,26 @@ clutter_pango_glyph_cache_lookup (ClutterPangoGlyphCache *cache,
                                   PangoGlyph              glyph)
 {
   PangoGlyphCacheKey lookup_key;
-  PangoGlyphCacheValue *value;
+  PangoGlyphCacheKey *key = NULL;
+  PangoGlyphCacheValue *value = NULL;
 
   lookup_key.font = font;
   lookup_key.glyph = glyph;
 
-  value = g_hash_table_lookup (cache->hash_table, &lookup_key);
-
-  if (create && value == NULL)
+  if (g_hash_table_lookup_extended (cache->hash_table, &lookup_key,
+                                    (gpointer *) &key, (gpointer *) &value))
+    {
+      if (key->lru_link.data != NULL)
+        {
+          key->age = cache->age;
+          g_queue_unlink (&cache->lru, &key->lru_link);
+          g_queue_push_head_link (&cache->lru, &key->lru_link);
+        }
+    }
+  else if (create)
     {
-      PangoGlyphCacheKey *key;
       PangoRectangle ink_rect;
+      gboolean in_global_atlas = FALSE;
 
       value = g_new0 (PangoGlyphCacheValue, 1);
       value->texture = NULL;
@@ -319,16 +369,17 @@ clutter_pango_glyph_cache_lookup (ClutterPangoGlyphCache *cache,
       else
         {
           /* Try adding the glyph to the global atlas... */
-          if (!clutter_pango_glyph_cache_add_to_global_atlas (cache,
-                                                              font,
-                                                              glyph,
-                                                              value) &&
-              /* If it fails try the local atlas */
-              !clutter_pango_glyph_cache_add_to_local_atlas (cache,
-                                                             context,
+          if (clutter_pango_glyph_cache_add_to_global_atlas (cache,
                                                              font,
                                                              glyph,
                                                              value))
+            in_global_atlas = TRUE;
+          /* If it fails try the local atlas */
+          else if (!clutter_pango_glyph_cache_add_to_local_atlas (cache,
+                                                                  context,
+                                                                  font,
+                                                                  glyph,
+                                                                  value))
             {
               clutter_pango_glyph_cache_value_free (value);
               return NULL;
@@ -342,12 +393,71 @@ clutter_pango_glyph_cache_lookup (ClutterPangoGlyphCache *cache,
       key->font = g_object_ref (font);
       key->glyph = glyph;
 
+      if (in_global_atlas)
+        {
+          CoglPixelFormat format = cogl_texture_get_format (value->texture);
+
+          key->size = (value->draw_width * value->draw_height *
+                       cogl_pixel_format_get_bytes_per_pixel (format, 0));
+          key->age = cache->age;
+          key->lru_link.data = key;
+          g_queue_push_head_link (&cache->lru, &key->lru_link);
+          cache->n_bytes += key->size;
+        }
+
       g_hash_table_insert (cache->hash_table, key, value);
     }
 
   return value;
 }
 
+/*
+ * clutter_pango_glyph_cache_trim:
+ * @cache: a #ClutterPangoGlyphCache
+ *
+ * Evicts the least recently used glyphs in the global atlas until they
+ * fit in the budget again, and starts a new age. Glyphs used since the
+ * last trim are kept, as they may still be needed to build the display
+ * list of the layout they were ensured for.
+ *
+ * Layouts whose display list is already built keep a reference on the
+ * textures they use, so they are not affected by the eviction.
+ */
+void
+clutter_pango_glyph_cache_trim (ClutterPangoGlyphCache *cache)
+{
+  unsigned int n_evicted = 0;
+
+  while (cache->n_bytes > cache->max_bytes)
+    {
+      GList *link = g_queue_peek_tail_link (&cache->lru);
+      PangoGlyphCacheKey *key;
+
+      if (link == NULL)
+        break;
+
+      key = link->data;
+      if (key->age == cache->age)
+        break;
+
+      g_queue_unlink (&cache->lru, link);
+      cache->n_bytes -= key->size;
+      n_evicted++;
+
+      g_hash_table_remove (cache->hash_table, key);
+    }
+
+  if (n_evicted > 0)
+    {
+      CLUTTER_NOTE (PANGO,
+                    "Evicted %u glyphs, %zu of %zu bytes used in the "
+                    "global atlas",
+                    n_evicted, cache->n_bytes, cache->max_bytes);
+    }
+
+  cache->age++;
+}
+
 static gboolean
 font_has_color_glyphs (const PangoFont *font)
 {
@@ -81,4 +81,6 @@ void clutter_pango_glyph_cache_remove_reorganize_callback (ClutterPangoGlyphCach
 
 void clutter_pango_glyph_cache_set_dirty_glyphs (ClutterPangoGlyphCache *cache);
 
+void clutter_pango_glyph_cache_trim (ClutterPangoGlyphCache *cache);
+
 G_END_DECLS
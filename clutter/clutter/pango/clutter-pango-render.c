@@ -397,6 +397,9 @@ clutter_ensure_glyph_cache_for_layout (PangoLayout *layout)
 
   g_return_if_fail (PANGO_IS_LAYOUT (layout));
 
+  /* Make room for the glyphs of this layout before reserving them */
+  clutter_pango_glyph_cache_trim (renderer->glyph_cache);
+
   if ((iter = pango_layout_get_iter (layout)) == NULL)
     return;
 
@@ -45,6 +45,12 @@
 
 #include <stdlib.h>
 
+/* Reorganizing an atlas migrates all of its contents into a new
+ * texture, which stalls longer the bigger the atlas gets. Instead of
+ * growing an atlas beyond this size we fail to reserve the space so
+ * that the user starts another atlas. */
+#define MAX_MIGRATION_SIZE_BYTES (4 * 1024 * 1024)
+
 G_DEFINE_TYPE (CoglAtlas, cogl_atlas, G_TYPE_OBJECT);
 
 static void
@@ -231,11 +237,20 @@ _cogl_atlas_get_initial_size (CoglContext *ctx,
   *map_height = size;
 }
 
+static unsigned int
+_cogl_atlas_get_max_migration_area (CoglAtlas *atlas)
+{
+  int bpp = cogl_pixel_format_get_bytes_per_pixel (atlas->texture_format, 0);
+
+  return MAX_MIGRATION_SIZE_BYTES / bpp;
+}
+
 static CoglRectangleMap *
 _cogl_atlas_create_map (CoglContext             *ctx,
                         CoglPixelFormat          format,
                         unsigned int             map_width,
                         unsigned int             map_height,
+                        unsigned int             max_area,
                         unsigned int             n_textures,
                         CoglAtlasRepositionData *textures)
 {
@@ -251,7 +266,8 @@ _cogl_atlas_create_map (CoglContext             *ctx,
 
   /* Keep trying increasingly larger atlases until we can fit all of
      the textures */
-  while (ctx->texture_driver->size_supported (ctx,
+  while ((max_area == 0 || map_width * map_height <= max_area) &&
+         ctx->texture_driver->size_supported (ctx,
                                               GL_TEXTURE_2D,
                                               gl_intformat,
                                               gl_format,
@@ -326,6 +342,8 @@ _cogl_atlas_create_texture (CoglAtlas *atlas,
 
       _cogl_texture_set_internal_format (tex,
                                          atlas->texture_format);
+      cogl_texture_set_memory_category (tex,
+                                        COGL_TEXTURE_MEMORY_CATEGORY_ATLAS);
 
       if (!cogl_texture_allocate (tex, &ignore_error))
         {
@@ -344,6 +362,8 @@ _cogl_atlas_create_texture (CoglAtlas *atlas,
 
       _cogl_texture_set_internal_format (tex,
                                          atlas->texture_format);
+      cogl_texture_set_memory_category (tex,
+                                        COGL_TEXTURE_MEMORY_CATEGORY_ATLAS);
 
       if (!cogl_texture_allocate (tex, &ignore_error))
         {
@@ -370,6 +390,31 @@ _cogl_atlas_compare_size_cb (const void *a,
   return a_size < b_size ? 1 : a_size > b_size ? -1 : 0;
 }
 
+static void
+_cogl_atlas_note_occupancy (CoglAtlas *atlas)
+{
+  unsigned int area, remaining, largest_free;
+
+  if (!COGL_DEBUG_ENABLED (COGL_DEBUG_ATLAS))
+    return;
+
+  area = (_cogl_rectangle_map_get_width (atlas->map) *
+          _cogl_rectangle_map_get_height (atlas->map));
+  remaining = _cogl_rectangle_map_get_remaining_space (atlas->map);
+  largest_free = _cogl_rectangle_map_get_largest_free_area (atlas->map);
+
+  /* Fragmentation is the part of the free space that isn't available
+     in the single largest free rectangle */
+  COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste, "
+             "%i%% of which is fragmented",
+             atlas,
+             _cogl_rectangle_map_get_width (atlas->map),
+             _cogl_rectangle_map_get_height (atlas->map),
+             _cogl_rectangle_map_get_n_rectangles (atlas->map),
+             remaining * 100 / area,
+             remaining ? (remaining - largest_free) * 100 / remaining : 0);
+}
+
 static void
 _cogl_atlas_notify_pre_reorganize (CoglAtlas *atlas)
 {
@@ -392,6 +437,7 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
   CoglRectangleMap *new_map;
   CoglTexture *new_tex;
   unsigned int map_width = 0, map_height = 0;
+  unsigned int max_area = 0;
   gboolean ret;
   MtkRectangle new_position;
 
@@ -401,15 +447,7 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
                                user_data,
                                &new_position))
     {
-      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-                 atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 /* waste as a percentage */
-                 _cogl_rectangle_map_get_remaining_space (atlas->map) *
-                 100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                        _cogl_rectangle_map_get_height (atlas->map)));
+      _cogl_atlas_note_occupancy (atlas);
 
       atlas->update_position_cb (user_data,
                                  atlas->texture,
@@ -418,6 +456,38 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
       return TRUE;
     }
 
+  if (atlas->map)
+    {
+      map_width = _cogl_rectangle_map_get_width (atlas->map);
+      map_height = _cogl_rectangle_map_get_height (atlas->map);
+
+      /* If there is enough space in for the new rectangle in the
+         existing atlas with at least 6% waste we'll start with the
+         same size, otherwise we'll immediately double it */
+      if ((map_width * map_height -
+           _cogl_rectangle_map_get_remaining_space (atlas->map) +
+           width * height) * 53 / 50 >
+          map_width * map_height)
+        _cogl_atlas_get_next_size (&map_width, &map_height);
+
+      /* Don't bother reorganizing if the atlas would have to grow
+         beyond what we are willing to migrate; the caller will start
+         a new atlas instead */
+      max_area = _cogl_atlas_get_max_migration_area (atlas);
+      if (map_width * map_height > max_area)
+        {
+          COGL_NOTE (ATLAS, "%p: Atlas is full at %ix%i",
+                     atlas,
+                     _cogl_rectangle_map_get_width (atlas->map),
+                     _cogl_rectangle_map_get_height (atlas->map));
+          return FALSE;
+        }
+    }
+  else
+    _cogl_atlas_get_initial_size (atlas->context,
+                                  atlas->texture_format,
+                                  &map_width, &map_height);
+
   /* If we make it here then we need to reorganize the atlas. First
      we'll notify any users of the atlas that this is going to happen
      so that for example in CoglAtlasTexture it can notify that the
@@ -455,28 +525,10 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
          _cogl_atlas_compare_size_cb);
 
   /* Try to create a new atlas that can contain all of the textures */
-  if (atlas->map)
-    {
-      map_width = _cogl_rectangle_map_get_width (atlas->map);
-      map_height = _cogl_rectangle_map_get_height (atlas->map);
-
-      /* If there is enough space in for the new rectangle in the
-         existing atlas with at least 6% waste we'll start with the
-         same size, otherwise we'll immediately double it */
-      if ((map_width * map_height -
-           _cogl_rectangle_map_get_remaining_space (atlas->map) +
-           width * height) * 53 / 50 >
-          map_width * map_height)
-        _cogl_atlas_get_next_size (&map_width, &map_height);
-    }
-  else
-    _cogl_atlas_get_initial_size (atlas->context,
-                                  atlas->texture_format,
-                                  &map_width, &map_height);
-
   new_map = _cogl_atlas_create_map (atlas->context,
                                     atlas->texture_format,
                                     map_width, map_height,
+                                    max_area,
                                     data.n_textures, data.textures);
 
   /* If we can't create a map with the texture then give up */
@@ -497,8 +549,6 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
     }
   else
     {
-      int waste;
-
       COGL_NOTE (ATLAS,
                  "%p: Atlas %s with size %ix%i",
                  atlas,
@@ -534,16 +584,7 @@ cogl_atlas_reserve_space (CoglAtlas             *atlas,
       atlas->map = new_map;
       atlas->texture = new_tex;
 
-      waste = (_cogl_rectangle_map_get_remaining_space (atlas->map) *
-               100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                      _cogl_rectangle_map_get_height (atlas->map)));
-
-      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-                 atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 waste);
+      _cogl_atlas_note_occupancy (atlas);
 
       ret = TRUE;
     }
@@ -565,14 +606,7 @@ _cogl_atlas_remove (CoglAtlas          *atlas,
              atlas,
              rectangle->width,
              rectangle->height);
-  COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-             atlas,
-             _cogl_rectangle_map_get_width (atlas->map),
-             _cogl_rectangle_map_get_height (atlas->map),
-             _cogl_rectangle_map_get_n_rectangles (atlas->map),
-             _cogl_rectangle_map_get_remaining_space (atlas->map) *
-             100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                    _cogl_rectangle_map_get_height (atlas->map)));
+  _cogl_atlas_note_occupancy (atlas);
 };
 
 static CoglTexture *
@@ -36,6 +36,7 @@
 #include "cogl/cogl-attribute-buffer.h"
 #include "cogl/cogl-attribute-buffer-private.h"
 #include "cogl/cogl-context-private.h"
+#include "cogl/cogl-trace.h"
 
 G_DEFINE_FINAL_TYPE (CoglAttributeBuffer, cogl_attribute_buffer, COGL_TYPE_BUFFER)
 
@@ -62,6 +63,8 @@ cogl_attribute_buffer_new_with_size (CoglContext *context,
                          "update-hint", COGL_BUFFER_UPDATE_HINT_STATIC,
                          NULL);
 
+  COGL_TRACE_ALLOCATION (buffer, bytes);
+
   return buffer;
 }
 
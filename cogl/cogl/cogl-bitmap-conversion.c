@@ -35,9 +35,25 @@
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-half-float.h"
+#include "cogl/cogl-cpu-caps.h"
 
 #include <string.h>
 
+#if defined (__SSE2__) && (defined (__x86_64) || defined (__i386))
+#define COGL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined (__GNUC__) && defined (__x86_64)
+#define COGL_USE_X86_RUNTIME_DISPATCH
+#include <immintrin.h>
+#endif
+
+#ifdef __aarch64__
+#define COGL_USE_NEON
+#include <arm_neon.h>
+#endif
+
 typedef enum
 {
   MEDIUM_TYPE_8,
@@ -194,35 +210,6 @@ unpack_flt (uint32_t b)
 
 /* (Un)Premultiplication */
 
-inline static void
-_cogl_unpremult_alpha_0 (uint8_t *dst)
-{
-  dst[0] = 0;
-  dst[1] = 0;
-  dst[2] = 0;
-  dst[3] = 0;
-}
-
-inline static void
-_cogl_unpremult_alpha_last (uint8_t *dst)
-{
-  uint8_t alpha = dst[3];
-
-  dst[0] = (dst[0] * 255) / alpha;
-  dst[1] = (dst[1] * 255) / alpha;
-  dst[2] = (dst[2] * 255) / alpha;
-}
-
-inline static void
-_cogl_unpremult_alpha_first (uint8_t *dst)
-{
-  uint8_t alpha = dst[0];
-
-  dst[1] = (dst[1] * 255) / alpha;
-  dst[2] = (dst[2] * 255) / alpha;
-  dst[3] = (dst[3] * 255) / alpha;
-}
-
 /* No division form of floor((c*a + 128)/255) (I first encountered
  * this in the RENDER implementation in the X server.) Being exact
  * is important for a == 255 - we want to get exactly c.
@@ -260,101 +247,66 @@ _cogl_premult_alpha_first (uint8_t *dst)
 
 #undef MULT
 
-/* Use the SSE optimized version to premult four pixels at once when
-   it is available. The same assembler code works for x86 and x86-64
-   because it doesn't refer to any non-SSE registers directly */
-#if defined(__SSE2__) && defined(__GNUC__) \
-  && (defined(__x86_64) || defined(__i386))
-#define COGL_USE_PREMULT_SSE2
-#endif
-
-#ifdef COGL_USE_PREMULT_SSE2
+#ifdef COGL_USE_SSE2
 
+/* Premultiplies four pixels at once using the same rounding as MULT.
+ * Each register only holds two pixels because we need to work with
+ * 16-bit intermediate values; the intermediate values can't overflow
+ * because 255 * 255 + 128 + 255 fits in 16 bits. */
 inline static void
-_cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
-{
-  /* 8 copies of 128 used below */
-  static const int16_t eight_halves[8] __attribute__ ((aligned (16))) =
-    { 128, 128, 128, 128, 128, 128, 128, 128 };
-  /* Mask of the rgb components of the four pixels */
-  static const int8_t just_rgb[16] __attribute__ ((aligned (16))) =
-    { 0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00 };
-  /* Each SSE register only holds two pixels because we need to work
-     with 16-bit intermediate values. We still do four pixels by
-     interleaving two registers in the hope that it will pipeline
-     better */
-  asm (/* Load eight_halves into xmm5 for later */
-       "movdqa (%1), %%xmm5\n"
-       /* Clear xmm3 */
-       "pxor %%xmm3, %%xmm3\n"
-       /* Load two pixels from p into the low half of xmm0 */
-       "movlps (%0), %%xmm0\n"
-       /* Load the next set of two pixels from p into the low half of xmm1 */
-       "movlps 8(%0), %%xmm1\n"
-       /* Unpack 8 bytes from the low quad-words in each register to 8
-          16-bit values */
-       "punpcklbw %%xmm3, %%xmm0\n"
-       "punpcklbw %%xmm3, %%xmm1\n"
-       /* Copy alpha values of the first pixel in xmm0 to all
-          components of the first pixel in xmm2 */
-       "pshuflw $255, %%xmm0, %%xmm2\n"
-       /* same for xmm1 and xmm3 */
-       "pshuflw $255, %%xmm1, %%xmm3\n"
-       /* The above also copies the second pixel directly so we now
-          want to replace the RGB components with copies of the alpha
-          components */
-       "pshufhw $255, %%xmm2, %%xmm2\n"
-       "pshufhw $255, %%xmm3, %%xmm3\n"
-       /* Multiply the rgb components by the alpha */
-       "pmullw %%xmm2, %%xmm0\n"
-       "pmullw %%xmm3, %%xmm1\n"
-       /* Add 128 to each component */
-       "paddw %%xmm5, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Copy the results to temporary registers xmm4 and xmm5 */
-       "movdqa %%xmm0, %%xmm4\n"
-       "movdqa %%xmm1, %%xmm5\n"
-       /* Divide the results by 256 */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Add the temporaries back in */
-       "paddw %%xmm4, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Divide again */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Pack the results back as bytes */
-       "packuswb %%xmm1, %%xmm0\n"
-       /* Load just_rgb into xmm3 for later */
-       "movdqa (%2), %%xmm3\n"
-       /* Reload all four pixels into xmm2 */
-       "movups (%0), %%xmm2\n"
-       /* Mask out the alpha from the results */
-       "andps %%xmm3, %%xmm0\n"
-       /* Mask out the RGB from the original four pixels */
-       "andnps %%xmm2, %%xmm3\n"
-       /* Combine the two to get the right alpha values */
-       "orps %%xmm3, %%xmm0\n"
-       /* Write to memory */
-       "movdqu %%xmm0, (%0)\n"
-       : /* no outputs */
-       : "r" (p), "r" (eight_halves), "r" (just_rgb)
-       : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5");
-}
-
-#endif /* COGL_USE_PREMULT_SSE2 */
+_cogl_premult_four_pixels_sse2 (uint8_t  *p,
+                                gboolean  alpha_first)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i half = _mm_set1_epi16 (128);
+  __m128i pixels, lo, hi, alpha_lo, alpha_hi, alpha_mask;
+
+  pixels = _mm_loadu_si128 ((const __m128i *) p);
+  lo = _mm_unpacklo_epi8 (pixels, zero);
+  hi = _mm_unpackhi_epi8 (pixels, zero);
+
+  /* Copy the alpha value of each pixel to all of its components */
+  if (alpha_first)
+    {
+      alpha_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (lo, 0x00), 0x00);
+      alpha_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (hi, 0x00), 0x00);
+      alpha_mask = _mm_set1_epi32 (0x000000ff);
+    }
+  else
+    {
+      alpha_lo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (lo, 0xff), 0xff);
+      alpha_hi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (hi, 0xff), 0xff);
+      alpha_mask = _mm_set1_epi32 ((int) 0xff000000);
+    }
 
+  lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, alpha_lo), half);
+  hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, alpha_hi), half);
+  lo = _mm_srli_epi16 (_mm_add_epi16 (_mm_srli_epi16 (lo, 8), lo), 8);
+  hi = _mm_srli_epi16 (_mm_add_epi16 (_mm_srli_epi16 (hi, 8), hi), 8);
+
+  /* Keep the original alpha values */
+  pixels = _mm_or_si128 (_mm_andnot_si128 (alpha_mask,
+                                           _mm_packus_epi16 (lo, hi)),
+                         _mm_and_si128 (alpha_mask, pixels));
+
+  _mm_storeu_si128 ((__m128i *) p, pixels);
+}
+
+#endif /* COGL_USE_SSE2 */
+
+/* Premultiplies a span of 8-bit pixels with four components in place.
+ * The alpha component is either the first or the last one. */
 static void
-_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
-                                      int width)
+_cogl_bitmap_premult_span_8 (uint8_t  *data,
+                             int       width,
+                             gboolean  alpha_first)
 {
-#ifdef COGL_USE_PREMULT_SSE2
+#ifdef COGL_USE_SSE2
 
   /* Process 4 pixels at a time */
   while (width >= 4)
     {
-      _cogl_premult_alpha_last_four_pixels_sse2 (data);
+      _cogl_premult_four_pixels_sse2 (data, alpha_first);
       data += 4 * 4;
       width -= 4;
     }
@@ -362,31 +314,85 @@ _cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
   /* If there are any pixels left we will fall through and
      handle them below */
 
-#endif /* COGL_USE_PREMULT_SSE2 */
+#endif /* COGL_USE_SSE2 */
 
-  while (width-- > 0)
+  if (alpha_first)
     {
-      _cogl_premult_alpha_last (data);
-      data += 4;
+      while (width-- > 0)
+        {
+          _cogl_premult_alpha_first (data);
+          data += 4;
+        }
+    }
+  else
+    {
+      while (width-- > 0)
+        {
+          _cogl_premult_alpha_last (data);
+          data += 4;
+        }
     }
 }
 
+/* Unpremultiplying needs (c * 255) / a, which is the slowest part of
+ * reading back premultiplied data. Instead of dividing, multiply by
+ * ceil(2^24 / a); for every c * 255 <= 255 * 255 and a <= 255 this
+ * gives exactly the same truncated result. */
+static const uint32_t *
+get_unpremult_reciprocals (void)
+{
+  static uint32_t reciprocals[256];
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      int alpha;
+
+      reciprocals[0] = 0;
+      for (alpha = 1; alpha < 256; alpha++)
+        reciprocals[alpha] = ((1 << 24) + alpha - 1) / alpha;
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return reciprocals;
+}
+
+#define UNPREMULT(c,r) ((uint8_t) (((uint64_t) (c) * 255 * (r)) >> 24))
+
+/* Unpremultiplies a span of 8-bit pixels with four components in
+ * place. The alpha component is either the first or the last one. */
 static void
-_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
-                                        int width)
+_cogl_bitmap_unpremult_span_8 (uint8_t  *data,
+                               int       width,
+                               gboolean  alpha_first)
 {
-  int x;
+  const uint32_t *reciprocals = get_unpremult_reciprocals ();
+  int alpha_index = alpha_first ? 0 : 3;
+  int color_index = alpha_first ? 1 : 0;
 
-  for (x = 0; x < width; x++)
+  while (width-- > 0)
     {
-      if (data[3] == 0)
-        _cogl_unpremult_alpha_0 (data);
-      else
-        _cogl_unpremult_alpha_last (data);
+      uint8_t alpha = data[alpha_index];
+
+      if (alpha == 0)
+        memset (data, 0, 4);
+      else if (alpha != 255)
+        {
+          uint32_t r = reciprocals[alpha];
+          uint8_t *color = data + color_index;
+
+          color[0] = UNPREMULT (color[0], r);
+          color[1] = UNPREMULT (color[1], r);
+          color[2] = UNPREMULT (color[2], r);
+        }
+
       data += 4;
     }
 }
 
+#undef UNPREMULT
+
 static void
 _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
                                          int width)
@@ -403,6 +409,8 @@ _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
           data[1] = (data[1] * 65535) / alpha;
           data[2] = (data[2] * 65535) / alpha;
         }
+
+      data += 4;
     }
 }
 
@@ -417,6 +425,8 @@ _cogl_bitmap_premult_unpacked_span_16 (uint16_t *data,
       data[0] = (data[0] * alpha) / 65535;
       data[1] = (data[1] * alpha) / 65535;
       data[2] = (data[2] * alpha) / 65535;
+
+      data += 4;
     }
 }
 
@@ -436,6 +446,8 @@ _cogl_bitmap_unpremult_unpacked_span_float (float *data,
           data[1] = data[1] / alpha;
           data[2] = data[2] / alpha;
         }
+
+      data += 4;
     }
 }
 
@@ -450,6 +462,8 @@ _cogl_bitmap_premult_unpacked_span_float (float *data,
       data[0] = data[0] * alpha;
       data[1] = data[1] * alpha;
       data[2] = data[2] * alpha;
+
+      data += 4;
     }
 }
 
@@ -469,6 +483,355 @@ _cogl_bitmap_can_fast_premult (CoglPixelFormat format)
     }
 }
 
+/* Direct conversions between formats with four 8-bit or half float
+ * components. These are the formats used for screenshots, shm buffers
+ * and screen cast readback, so instead of going through the generic
+ * unpack/pack path we convert them with a single byte shuffle. */
+
+typedef struct
+{
+  /* Byte offset of the red, green, blue and alpha components */
+  uint8_t offsets[4];
+  gboolean has_alpha;
+} Cogl8888Layout;
+
+static gboolean
+get_8888_layout (CoglPixelFormat  format,
+                 Cogl8888Layout  *layout)
+{
+  static const Cogl8888Layout rgba = { { 0, 1, 2, 3 } };
+  static const Cogl8888Layout bgra = { { 2, 1, 0, 3 } };
+  static const Cogl8888Layout argb = { { 1, 2, 3, 0 } };
+  static const Cogl8888Layout abgr = { { 3, 2, 1, 0 } };
+
+  switch (format & ~(COGL_PREMULT_BIT | COGL_A_BIT))
+    {
+    case COGL_PIXEL_FORMAT_RGBX_8888:
+    case COGL_PIXEL_FORMAT_RGBX_FP_16161616:
+      *layout = rgba;
+      break;
+    case COGL_PIXEL_FORMAT_BGRX_8888:
+    case COGL_PIXEL_FORMAT_BGRX_FP_16161616:
+      *layout = bgra;
+      break;
+    case COGL_PIXEL_FORMAT_XRGB_8888:
+    case COGL_PIXEL_FORMAT_XRGB_FP_16161616:
+      *layout = argb;
+      break;
+    case COGL_PIXEL_FORMAT_XBGR_8888:
+    case COGL_PIXEL_FORMAT_XBGR_FP_16161616:
+      *layout = abgr;
+      break;
+    default:
+      return FALSE;
+    }
+
+  layout->has_alpha = !!(format & COGL_A_BIT);
+
+  return TRUE;
+}
+
+static gboolean
+is_8888_format (CoglPixelFormat format)
+{
+  switch (format & ~(COGL_PREMULT_BIT | COGL_A_BIT))
+    {
+    case COGL_PIXEL_FORMAT_RGBX_8888:
+    case COGL_PIXEL_FORMAT_BGRX_8888:
+    case COGL_PIXEL_FORMAT_XRGB_8888:
+    case COGL_PIXEL_FORMAT_XBGR_8888:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+is_fp_16161616_format (CoglPixelFormat format)
+{
+  switch (format & ~(COGL_PREMULT_BIT | COGL_A_BIT))
+    {
+    case COGL_PIXEL_FORMAT_RGBX_FP_16161616:
+    case COGL_PIXEL_FORMAT_BGRX_FP_16161616:
+    case COGL_PIXEL_FORMAT_XRGB_FP_16161616:
+    case COGL_PIXEL_FORMAT_XBGR_FP_16161616:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+typedef struct
+{
+  /* For each destination byte, the source byte to copy */
+  uint8_t indices[4];
+  /* Bytes to OR into each destination pixel, used to make the alpha
+   * component opaque when either side doesn't have one */
+  uint8_t fill[4];
+} CoglSwizzle;
+
+static void
+init_swizzle (CoglSwizzle          *swizzle,
+              const Cogl8888Layout *src_layout,
+              const Cogl8888Layout *dst_layout)
+{
+  int i;
+
+  memset (swizzle->fill, 0, sizeof (swizzle->fill));
+
+  for (i = 0; i < 4; i++)
+    swizzle->indices[dst_layout->offsets[i]] = src_layout->offsets[i];
+
+  if (!src_layout->has_alpha || !dst_layout->has_alpha)
+    swizzle->fill[dst_layout->offsets[3]] = 0xff;
+}
+
+#ifdef COGL_USE_X86_RUNTIME_DISPATCH
+
+__attribute__ ((target ("ssse3")))
+static int
+swizzle_span_ssse3 (const uint8_t     *src,
+                    uint8_t           *dst,
+                    int                width,
+                    const CoglSwizzle *swizzle)
+{
+  __m128i shuffle, fill;
+  int x;
+
+  shuffle = _mm_setr_epi8 (swizzle->indices[0], swizzle->indices[1],
+                           swizzle->indices[2], swizzle->indices[3],
+                           swizzle->indices[0] + 4, swizzle->indices[1] + 4,
+                           swizzle->indices[2] + 4, swizzle->indices[3] + 4,
+                           swizzle->indices[0] + 8, swizzle->indices[1] + 8,
+                           swizzle->indices[2] + 8, swizzle->indices[3] + 8,
+                           swizzle->indices[0] + 12, swizzle->indices[1] + 12,
+                           swizzle->indices[2] + 12, swizzle->indices[3] + 12);
+  fill = _mm_set1_epi32 ((int) (swizzle->fill[0] |
+                                swizzle->fill[1] << 8 |
+                                swizzle->fill[2] << 16 |
+                                (uint32_t) swizzle->fill[3] << 24));
+
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) (src + x * 4));
+
+      pixels = _mm_or_si128 (_mm_shuffle_epi8 (pixels, shuffle), fill);
+      _mm_storeu_si128 ((__m128i *) (dst + x * 4), pixels);
+    }
+
+  return x;
+}
+
+#endif /* COGL_USE_X86_RUNTIME_DISPATCH */
+
+#ifdef COGL_USE_NEON
+
+static int
+swizzle_span_neon (const uint8_t     *src,
+                   uint8_t           *dst,
+                   int                width,
+                   const CoglSwizzle *swizzle)
+{
+  uint8_t shuffle_bytes[16], fill_bytes[16];
+  uint8x16_t shuffle, fill;
+  int i, x;
+
+  for (i = 0; i < 16; i++)
+    {
+      shuffle_bytes[i] = swizzle->indices[i % 4] + (i / 4) * 4;
+      fill_bytes[i] = swizzle->fill[i % 4];
+    }
+
+  shuffle = vld1q_u8 (shuffle_bytes);
+  fill = vld1q_u8 (fill_bytes);
+
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      uint8x16_t pixels = vld1q_u8 (src + x * 4);
+
+      pixels = vorrq_u8 (vqtbl1q_u8 (pixels, shuffle), fill);
+      vst1q_u8 (dst + x * 4, pixels);
+    }
+
+  return x;
+}
+
+#endif /* COGL_USE_NEON */
+
+/* Swizzles a span of pixels with four 8-bit components. @src and @dst
+ * may point to the same memory. */
+static void
+swizzle_span (const uint8_t     *src,
+              uint8_t           *dst,
+              int                width,
+              const CoglSwizzle *swizzle)
+{
+  int x = 0;
+
+#ifdef COGL_USE_X86_RUNTIME_DISPATCH
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_SSSE3))
+    x = swizzle_span_ssse3 (src, dst, width, swizzle);
+#elif defined (COGL_USE_NEON)
+  x = swizzle_span_neon (src, dst, width, swizzle);
+#endif
+
+  for (; x < width; x++)
+    {
+      const uint8_t *s = src + x * 4;
+      uint8_t *d = dst + x * 4;
+      uint8_t r = s[swizzle->indices[0]];
+      uint8_t g = s[swizzle->indices[1]];
+      uint8_t b = s[swizzle->indices[2]];
+      uint8_t a = s[swizzle->indices[3]];
+
+      d[0] = r | swizzle->fill[0];
+      d[1] = g | swizzle->fill[1];
+      d[2] = b | swizzle->fill[2];
+      d[3] = a | swizzle->fill[3];
+    }
+}
+
+#ifdef COGL_USE_X86_RUNTIME_DISPATCH
+
+/* Converts half floats to 8-bit components in memory order, clamping
+ * and truncating the same way as UNPACK_SHORT does. */
+__attribute__ ((target ("f16c")))
+static void
+convert_fp16_span_to_8_f16c (const uint8_t *src,
+                             uint8_t       *dst,
+                             int            width)
+{
+  const __m128 zero = _mm_setzero_ps ();
+  const __m128 one = _mm_set1_ps (1.0f);
+  const __m128 scale = _mm_set1_ps (255.0f);
+  int x;
+
+  for (x = 0; x + 2 <= width; x += 2)
+    {
+      __m128i halves = _mm_loadu_si128 ((const __m128i *) (src + x * 8));
+      __m128 lo = _mm_cvtph_ps (halves);
+      __m128 hi = _mm_cvtph_ps (_mm_unpackhi_epi64 (halves, halves));
+      __m128i lo_i, hi_i, bytes;
+
+      /* _mm_min_ps returns the second operand for NaN, which matches
+       * CLAMP_NORM */
+      lo = _mm_max_ps (_mm_min_ps (lo, one), zero);
+      hi = _mm_max_ps (_mm_min_ps (hi, one), zero);
+      lo_i = _mm_cvttps_epi32 (_mm_mul_ps (lo, scale));
+      hi_i = _mm_cvttps_epi32 (_mm_mul_ps (hi, scale));
+
+      bytes = _mm_packs_epi32 (lo_i, hi_i);
+      bytes = _mm_packus_epi16 (bytes, bytes);
+      _mm_storel_epi64 ((__m128i *) (dst + x * 4), bytes);
+    }
+
+  for (; x < width; x++)
+    {
+      const uint16_t *s = (const uint16_t *) (src + x * 8);
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          float f = cogl_half_to_float (s[i]);
+
+          dst[x * 4 + i] = (uint8_t) (MAX (MIN (f, 1.0f), 0.0f) * 255);
+        }
+    }
+}
+
+#endif /* COGL_USE_X86_RUNTIME_DISPATCH */
+
+static gboolean
+can_convert_fp16_span_to_8 (void)
+{
+#ifdef COGL_USE_X86_RUNTIME_DISPATCH
+  return cogl_cpu_has_cap (COGL_CPU_CAP_F16C);
+#else
+  return FALSE;
+#endif
+}
+
+/* Unpacks a span of pixels with four half float components to the
+ * 8-bit RGBA medium format. */
+static void
+unpack_fp16_span_to_8 (CoglPixelFormat  format,
+                       const uint8_t   *src,
+                       uint8_t         *dst,
+                       int              width)
+{
+#ifdef COGL_USE_X86_RUNTIME_DISPATCH
+  static const Cogl8888Layout rgba = { { 0, 1, 2, 3 }, TRUE };
+  Cogl8888Layout layout;
+  CoglSwizzle swizzle;
+
+  get_8888_layout (format, &layout);
+  init_swizzle (&swizzle, &layout, &rgba);
+
+  convert_fp16_span_to_8_f16c (src, dst, width);
+  swizzle_span (dst, dst, width, &swizzle);
+#else
+  g_assert_not_reached ();
+#endif
+}
+
+static gboolean
+convert_8888_into_bitmap (CoglBitmap  *src_bmp,
+                          CoglBitmap  *dst_bmp,
+                          gboolean     need_premult,
+                          GError     **error)
+{
+  CoglPixelFormat src_format = cogl_bitmap_get_format (src_bmp);
+  CoglPixelFormat dst_format = cogl_bitmap_get_format (dst_bmp);
+  int src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
+  int dst_rowstride = cogl_bitmap_get_rowstride (dst_bmp);
+  int width = cogl_bitmap_get_width (src_bmp);
+  int height = cogl_bitmap_get_height (src_bmp);
+  gboolean alpha_first = !!(dst_format & COGL_AFIRST_BIT);
+  Cogl8888Layout src_layout, dst_layout;
+  CoglSwizzle swizzle;
+  uint8_t *src_data;
+  uint8_t *dst_data;
+  int y;
+
+  get_8888_layout (src_format, &src_layout);
+  get_8888_layout (dst_format, &dst_layout);
+  init_swizzle (&swizzle, &src_layout, &dst_layout);
+
+  src_data = _cogl_bitmap_map (src_bmp, COGL_BUFFER_ACCESS_READ, 0, error);
+  if (src_data == NULL)
+    return FALSE;
+  dst_data = _cogl_bitmap_map (dst_bmp,
+                               COGL_BUFFER_ACCESS_WRITE,
+                               COGL_BUFFER_MAP_HINT_DISCARD,
+                               error);
+  if (dst_data == NULL)
+    {
+      _cogl_bitmap_unmap (src_bmp);
+      return FALSE;
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      uint8_t *src = src_data + y * src_rowstride;
+      uint8_t *dst = dst_data + y * dst_rowstride;
+
+      swizzle_span (src, dst, width, &swizzle);
+
+      if (need_premult)
+        {
+          if (dst_format & COGL_PREMULT_BIT)
+            _cogl_bitmap_premult_span_8 (dst, width, alpha_first);
+          else
+            _cogl_bitmap_unpremult_span_8 (dst, width, alpha_first);
+        }
+    }
+
+  _cogl_bitmap_unmap (src_bmp);
+  _cogl_bitmap_unmap (dst_bmp);
+
+  return TRUE;
+}
+
 static gboolean
 determine_medium_size (CoglPixelFormat format)
 {
@@ -575,6 +938,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   MediumType medium_type;
   gboolean need_premult;
+  gboolean use_fp16_unpack;
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -621,6 +985,9 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       return TRUE;
     }
 
+  if (is_8888_format (src_format) && is_8888_format (dst_format))
+    return convert_8888_into_bitmap (src_bmp, dst_bmp, need_premult, error);
+
   src_data = _cogl_bitmap_map (src_bmp, COGL_BUFFER_ACCESS_READ, 0, error);
   if (src_data == NULL)
     return FALSE;
@@ -635,6 +1002,9 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
     }
 
   medium_type = determine_medium_size (dst_format);
+  use_fp16_unpack = (medium_type == MEDIUM_TYPE_8 &&
+                     is_fp_16161616_format (src_format) &&
+                     can_convert_fp16_span_to_8 ());
 
   /* Allocate a buffer to hold a temporary RGBA row */
   tmp_row = g_malloc (width * calculate_medium_size_pixel_size (medium_type));
@@ -648,7 +1018,10 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       switch (medium_type)
         {
         case MEDIUM_TYPE_8:
-          _cogl_unpack_8 (src_format, src, tmp_row, width);
+          if (use_fp16_unpack)
+            unpack_fp16_span_to_8 (src_format, src, tmp_row, width);
+          else
+            _cogl_unpack_8 (src_format, src, tmp_row, width);
           break;
         case MEDIUM_TYPE_16:
           _cogl_unpack_16 (src_format, src, tmp_row, width);
@@ -666,7 +1039,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
               switch (medium_type)
                 {
                 case MEDIUM_TYPE_8:
-                  _cogl_bitmap_premult_unpacked_span_8 (tmp_row, width);
+                  _cogl_bitmap_premult_span_8 (tmp_row, width, FALSE);
                   break;
                 case MEDIUM_TYPE_16:
                   _cogl_bitmap_premult_unpacked_span_16 (tmp_row, width);
@@ -681,7 +1054,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
               switch (medium_type)
                 {
                 case MEDIUM_TYPE_8:
-                  _cogl_bitmap_unpremult_unpacked_span_8 (tmp_row, width);
+                  _cogl_bitmap_unpremult_span_8 (tmp_row, width, FALSE);
                   break;
                 case MEDIUM_TYPE_16:
                   _cogl_bitmap_unpremult_unpacked_span_16 (tmp_row, width);
@@ -834,7 +1207,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -871,19 +1244,8 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
+          _cogl_bitmap_unpremult_span_8 (p, width,
+                                         !!(format & COGL_AFIRST_BIT));
         }
     }
 
@@ -902,7 +1264,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -938,16 +1300,8 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
+          _cogl_bitmap_premult_span_8 (p, width,
+                                       !!(format & COGL_AFIRST_BIT));
         }
     }
 
@@ -0,0 +1,58 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "cogl/cogl-capture.h"
+#include "cogl/cogl-clip-stack.h"
+#include "cogl/cogl-framebuffer.h"
+#include "cogl/cogl-journal-private.h"
+
+typedef struct _CoglCapture CoglCapture;
+
+CoglCapture *
+_cogl_capture_new (void);
+
+void
+_cogl_capture_free (CoglCapture *capture);
+
+void
+_cogl_capture_log_journal (CoglCapture *capture,
+                           CoglJournal *journal);
+
+void
+_cogl_capture_log_clear (CoglCapture     *capture,
+                         CoglFramebuffer *framebuffer,
+                         CoglClipStack   *clip_stack,
+                         unsigned long    buffers,
+                         float            red,
+                         float            green,
+                         float            blue,
+                         float            alpha);
@@ -0,0 +1,578 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "cogl/cogl-capture-private.h"
+#include "cogl/cogl-context-private.h"
+#include "cogl/cogl-framebuffer-private.h"
+#include "cogl/cogl-pipeline-private.h"
+#include "cogl/cogl-pipeline-state-private.h"
+#include "cogl/cogl-onscreen.h"
+
+/* See GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS in cogl-journal.c */
+#define JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS(N_LAYERS) ((N_LAYERS) * 2 + 2)
+
+#define EMPTY_TEXTURE_HASH \
+  "0000000000000000000000000000000000000000000000000000000000000000"
+
+typedef struct _CaptureFramebuffer
+{
+  uint32_t id;
+  gboolean written;
+  float projection[16];
+} CaptureFramebuffer;
+
+struct _CoglCapture
+{
+  GByteArray *data;
+
+  /* The objects that were already written, mapped to their ids. A
+   * reference is held on every key so that a pointer can not be reused
+   * for another object while capturing. */
+  GHashTable *framebuffers;
+  GHashTable *textures;
+  GHashTable *texture_hashes;
+  GHashTable *pipelines;
+  GHashTable *clip_stacks;
+
+  uint32_t next_framebuffer_id;
+  uint32_t next_texture_id;
+  uint32_t next_pipeline_id;
+  uint32_t next_clip_id;
+
+  /* Set while reading back a texture, which may itself draw */
+  gboolean reading_back;
+};
+
+static void
+append_uint32 (GByteArray *data,
+               uint32_t    value)
+{
+  g_byte_array_append (data, (const uint8_t *) &value, sizeof (value));
+}
+
+static void
+append_int32 (GByteArray *data,
+              int32_t     value)
+{
+  g_byte_array_append (data, (const uint8_t *) &value, sizeof (value));
+}
+
+static void
+append_floats (GByteArray  *data,
+               const float *values,
+               int          n_values)
+{
+  g_byte_array_append (data,
+                       (const uint8_t *) values,
+                       n_values * sizeof (float));
+}
+
+static void
+append_matrix (GByteArray              *data,
+               const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+  append_floats (data, values, G_N_ELEMENTS (values));
+}
+
+static void
+append_matrix_entry (GByteArray      *data,
+                     CoglMatrixEntry *entry)
+{
+  graphene_matrix_t matrix;
+  const graphene_matrix_t *direct;
+
+  direct = cogl_matrix_entry_get (entry, &matrix);
+  append_matrix (data, direct ? direct : &matrix);
+}
+
+static size_t
+begin_record (CoglCapture           *capture,
+              CoglCaptureRecordType  type)
+{
+  size_t offset;
+
+  append_uint32 (capture->data, type);
+  offset = capture->data->len;
+  append_uint32 (capture->data, 0);
+
+  return offset;
+}
+
+static void
+end_record (CoglCapture *capture,
+            size_t       size_offset)
+{
+  uint32_t size = capture->data->len - size_offset - sizeof (uint32_t);
+
+  memcpy (capture->data->data + size_offset, &size, sizeof (size));
+}
+
+CoglCapture *
+_cogl_capture_new (void)
+{
+  CoglCapture *capture;
+
+  capture = g_new0 (CoglCapture, 1);
+  capture->data = g_byte_array_new ();
+  capture->framebuffers = g_hash_table_new_full (NULL, NULL,
+                                                 g_object_unref, g_free);
+  capture->textures = g_hash_table_new_full (NULL, NULL,
+                                             g_object_unref, NULL);
+  capture->texture_hashes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free, NULL);
+  capture->pipelines = g_hash_table_new_full (NULL, NULL,
+                                              g_object_unref, NULL);
+  capture->clip_stacks =
+    g_hash_table_new_full (NULL, NULL,
+                           (GDestroyNotify) _cogl_clip_stack_unref, NULL);
+  capture->next_framebuffer_id = 1;
+  capture->next_texture_id = 1;
+  capture->next_pipeline_id = 1;
+  capture->next_clip_id = 1;
+
+  g_byte_array_append (capture->data,
+                       (const uint8_t *) COGL_CAPTURE_MAGIC,
+                       COGL_CAPTURE_MAGIC_LEN);
+  append_uint32 (capture->data, COGL_CAPTURE_VERSION);
+
+  return capture;
+}
+
+void
+_cogl_capture_free (CoglCapture *capture)
+{
+  g_byte_array_unref (capture->data);
+  g_hash_table_destroy (capture->framebuffers);
+  g_hash_table_destroy (capture->textures);
+  g_hash_table_destroy (capture->texture_hashes);
+  g_hash_table_destroy (capture->pipelines);
+  g_hash_table_destroy (capture->clip_stacks);
+  g_free (capture);
+}
+
+static uint32_t
+ensure_framebuffer (CoglCapture     *capture,
+                    CoglFramebuffer *framebuffer)
+{
+  CaptureFramebuffer *capture_framebuffer;
+  graphene_matrix_t projection;
+  float values[16];
+  size_t offset;
+
+  capture_framebuffer = g_hash_table_lookup (capture->framebuffers,
+                                             framebuffer);
+  if (!capture_framebuffer)
+    {
+      capture_framebuffer = g_new0 (CaptureFramebuffer, 1);
+      capture_framebuffer->id = capture->next_framebuffer_id++;
+      g_hash_table_insert (capture->framebuffers,
+                           g_object_ref (framebuffer),
+                           capture_framebuffer);
+    }
+
+  cogl_framebuffer_get_projection_matrix (framebuffer, &projection);
+  graphene_matrix_to_float (&projection, values);
+
+  if (capture_framebuffer->written &&
+      memcmp (capture_framebuffer->projection, values, sizeof (values)) == 0)
+    return capture_framebuffer->id;
+
+  offset = begin_record (capture, COGL_CAPTURE_RECORD_FRAMEBUFFER);
+  append_uint32 (capture->data, capture_framebuffer->id);
+  append_uint32 (capture->data, cogl_framebuffer_get_width (framebuffer));
+  append_uint32 (capture->data, cogl_framebuffer_get_height (framebuffer));
+  append_uint32 (capture->data, COGL_IS_ONSCREEN (framebuffer));
+  append_floats (capture->data, values, G_N_ELEMENTS (values));
+  end_record (capture, offset);
+
+  memcpy (capture_framebuffer->projection, values, sizeof (values));
+  capture_framebuffer->written = TRUE;
+
+  return capture_framebuffer->id;
+}
+
+static uint32_t
+ensure_texture (CoglCapture *capture,
+                CoglTexture *texture)
+{
+  g_autofree uint8_t *pixels = NULL;
+  g_autofree char *hash = NULL;
+  unsigned int width, height;
+  size_t size;
+  gboolean has_pixels;
+  gpointer id;
+  size_t offset;
+
+  if (!texture)
+    return 0;
+
+  if (g_hash_table_lookup_extended (capture->textures, texture, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  width = cogl_texture_get_width (texture);
+  height = cogl_texture_get_height (texture);
+  size = (size_t) width * height * 4;
+
+  /* Reading the texture back flushes any rendering to it, which the
+   * journal already did for its dependencies before logging. Textures
+   * that can't be read back, such as imported ones in formats Cogl can't
+   * convert, are recorded by size only. */
+  pixels = g_malloc (size);
+  capture->reading_back = TRUE;
+  has_pixels = size > 0 &&
+               cogl_texture_get_data (texture,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                      width * 4,
+                                      pixels) > 0;
+  capture->reading_back = FALSE;
+
+  if (has_pixels)
+    {
+      g_autoptr (GChecksum) checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+      g_checksum_update (checksum, (const uint8_t *) &width, sizeof (width));
+      g_checksum_update (checksum, (const uint8_t *) &height, sizeof (height));
+      g_checksum_update (checksum, pixels, size);
+      hash = g_strdup (g_checksum_get_string (checksum));
+
+      if (g_hash_table_lookup_extended (capture->texture_hashes, hash,
+                                        NULL, &id))
+        {
+          g_hash_table_insert (capture->textures, g_object_ref (texture), id);
+          return GPOINTER_TO_UINT (id);
+        }
+    }
+  else
+    {
+      hash = g_strdup (EMPTY_TEXTURE_HASH);
+    }
+
+  id = GUINT_TO_POINTER (capture->next_texture_id++);
+  g_hash_table_insert (capture->textures, g_object_ref (texture), id);
+  if (has_pixels)
+    g_hash_table_insert (capture->texture_hashes, g_strdup (hash), id);
+
+  offset = begin_record (capture, COGL_CAPTURE_RECORD_TEXTURE);
+  append_uint32 (capture->data, GPOINTER_TO_UINT (id));
+  g_byte_array_append (capture->data, (const uint8_t *) hash, 64);
+  append_uint32 (capture->data, width);
+  append_uint32 (capture->data, height);
+  append_uint32 (capture->data, has_pixels);
+  if (has_pixels)
+    g_byte_array_append (capture->data, pixels, size);
+  end_record (capture, offset);
+
+  return GPOINTER_TO_UINT (id);
+}
+
+static gboolean
+collect_layer_cb (CoglPipeline *pipeline,
+                  int           layer_index,
+                  void         *user_data)
+{
+  GArray *layer_indices = user_data;
+
+  g_array_append_val (layer_indices, layer_index);
+
+  return TRUE;
+}
+
+static uint32_t
+ensure_pipeline (CoglCapture  *capture,
+                 CoglPipeline *pipeline)
+{
+  g_autoptr (GArray) layer_indices = NULL;
+  g_autoptr (GArray) texture_ids = NULL;
+  CoglPipeline *blend_authority;
+  CoglPipelineBlendState *blend_state;
+  CoglCapturePipelineFlags flags = 0;
+  CoglColor color;
+  float color_values[4];
+  gpointer id;
+  size_t offset;
+  unsigned int i;
+
+  if (g_hash_table_lookup_extended (capture->pipelines, pipeline, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  layer_indices = g_array_new (FALSE, FALSE, sizeof (int));
+  cogl_pipeline_foreach_layer (pipeline, collect_layer_cb, layer_indices);
+
+  /* Textures get their own records, which can't be nested in this one */
+  texture_ids = g_array_sized_new (FALSE, FALSE, sizeof (uint32_t),
+                                   layer_indices->len);
+  for (i = 0; i < layer_indices->len; i++)
+    {
+      int layer_index = g_array_index (layer_indices, int, i);
+      CoglTexture *texture;
+      uint32_t texture_id;
+
+      texture = cogl_pipeline_get_layer_texture (pipeline, layer_index);
+      texture_id = ensure_texture (capture, texture);
+      g_array_append_val (texture_ids, texture_id);
+    }
+
+  _cogl_pipeline_update_real_blend_enable (pipeline, FALSE);
+  if (pipeline->real_blend_enable)
+    flags |= COGL_CAPTURE_PIPELINE_FLAG_BLEND;
+  if (_cogl_pipeline_has_vertex_snippets (pipeline) ||
+      _cogl_pipeline_has_non_layer_fragment_snippets (pipeline) ||
+      cogl_pipeline_get_user_program (pipeline))
+    flags |= COGL_CAPTURE_PIPELINE_FLAG_SNIPPETS;
+
+  cogl_pipeline_get_color (pipeline, &color);
+  color_values[0] = cogl_color_get_red (&color);
+  color_values[1] = cogl_color_get_green (&color);
+  color_values[2] = cogl_color_get_blue (&color);
+  color_values[3] = cogl_color_get_alpha (&color);
+
+  blend_authority = _cogl_pipeline_get_authority (pipeline,
+                                                  COGL_PIPELINE_STATE_BLEND);
+  blend_state = &blend_authority->big_state->blend_state;
+
+  id = GUINT_TO_POINTER (capture->next_pipeline_id++);
+  g_hash_table_insert (capture->pipelines, g_object_ref (pipeline), id);
+
+  offset = begin_record (capture, COGL_CAPTURE_RECORD_PIPELINE);
+  append_uint32 (capture->data, GPOINTER_TO_UINT (id));
+  append_uint32 (capture->data, flags);
+  append_floats (capture->data, color_values, G_N_ELEMENTS (color_values));
+  append_uint32 (capture->data, blend_state->blend_equation_rgb);
+  append_uint32 (capture->data, blend_state->blend_equation_alpha);
+  append_uint32 (capture->data, blend_state->blend_src_factor_rgb);
+  append_uint32 (capture->data, blend_state->blend_dst_factor_rgb);
+  append_uint32 (capture->data, blend_state->blend_src_factor_alpha);
+  append_uint32 (capture->data, blend_state->blend_dst_factor_alpha);
+  append_uint32 (capture->data, layer_indices->len);
+  for (i = 0; i < layer_indices->len; i++)
+    {
+      int layer_index = g_array_index (layer_indices, int, i);
+      CoglPipelineFilter min_filter, mag_filter;
+
+      cogl_pipeline_get_layer_filters (pipeline, layer_index,
+                                       &min_filter, &mag_filter);
+
+      append_uint32 (capture->data, g_array_index (texture_ids, uint32_t, i));
+      append_uint32 (capture->data, min_filter);
+      append_uint32 (capture->data, mag_filter);
+      append_uint32 (capture->data,
+                     cogl_pipeline_get_layer_wrap_mode_s (pipeline,
+                                                          layer_index));
+      append_uint32 (capture->data,
+                     cogl_pipeline_get_layer_wrap_mode_t (pipeline,
+                                                          layer_index));
+    }
+  end_record (capture, offset);
+
+  return GPOINTER_TO_UINT (id);
+}
+
+static uint32_t
+ensure_clip_stack (CoglCapture   *capture,
+                   CoglClipStack *clip_stack)
+{
+  g_autoptr (GPtrArray) entries = NULL;
+  CoglClipStack *entry;
+  gpointer id;
+  size_t offset;
+  int i;
+
+  if (!clip_stack)
+    return 0;
+
+  if (g_hash_table_lookup_extended (capture->clip_stacks, clip_stack,
+                                    NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  entries = g_ptr_array_new ();
+  for (entry = clip_stack; entry; entry = entry->parent)
+    g_ptr_array_add (entries, entry);
+
+  id = GUINT_TO_POINTER (capture->next_clip_id++);
+  g_hash_table_insert (capture->clip_stacks,
+                       _cogl_clip_stack_ref (clip_stack), id);
+
+  offset = begin_record (capture, COGL_CAPTURE_RECORD_CLIP);
+  append_uint32 (capture->data, GPOINTER_TO_UINT (id));
+  append_uint32 (capture->data, entries->len);
+  for (i = entries->len - 1; i >= 0; i--)
+    {
+      entry = g_ptr_array_index (entries, i);
+
+      switch (entry->type)
+        {
+        case COGL_CLIP_STACK_RECT:
+          {
+            CoglClipStackRect *rect = (CoglClipStackRect *) entry;
+            float coords[4] = { rect->x0, rect->y0, rect->x1, rect->y1 };
+
+            append_uint32 (capture->data, COGL_CLIP_STACK_RECT);
+            append_floats (capture->data, coords, G_N_ELEMENTS (coords));
+            append_matrix_entry (capture->data, rect->matrix_entry);
+          }
+          break;
+        case COGL_CLIP_STACK_REGION:
+          {
+            CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
+            int n_rects = mtk_region_num_rectangles (region->region);
+            int j;
+
+            append_uint32 (capture->data, COGL_CLIP_STACK_REGION);
+            append_uint32 (capture->data, n_rects);
+            for (j = 0; j < n_rects; j++)
+              {
+                MtkRectangle rect = mtk_region_get_rectangle (region->region,
+                                                              j);
+
+                append_int32 (capture->data, rect.x);
+                append_int32 (capture->data, rect.y);
+                append_int32 (capture->data, rect.width);
+                append_int32 (capture->data, rect.height);
+              }
+          }
+          break;
+        }
+    }
+  end_record (capture, offset);
+
+  return GPOINTER_TO_UINT (id);
+}
+
+void
+_cogl_capture_log_journal (CoglCapture *capture,
+                           CoglJournal *journal)
+{
+  uint32_t framebuffer_id;
+  unsigned int i;
+
+  if (capture->reading_back)
+    return;
+
+  framebuffer_id = ensure_framebuffer (capture, journal->framebuffer);
+
+  for (i = 0; i < journal->entries->len; i++)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+      size_t stride = JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      /* Skip the color, which is the one of the pipeline */
+      const float *v =
+        &g_array_index (journal->vertices, float, entry->array_offset) + 1;
+      uint32_t pipeline_id;
+      uint32_t clip_id;
+      size_t offset;
+      int j;
+
+      pipeline_id = ensure_pipeline (capture, entry->pipeline);
+      clip_id = ensure_clip_stack (capture, entry->clip_stack);
+
+      offset = begin_record (capture, COGL_CAPTURE_RECORD_DRAW);
+      append_uint32 (capture->data, framebuffer_id);
+      append_uint32 (capture->data, pipeline_id);
+      append_uint32 (capture->data, clip_id);
+      append_floats (capture->data, entry->viewport, 4);
+      append_matrix_entry (capture->data, entry->modelview_entry);
+      append_uint32 (capture->data, entry->n_layers);
+      append_floats (capture->data, v, 2);
+      append_floats (capture->data, v + stride, 2);
+      for (j = 0; j < entry->n_layers; j++)
+        {
+          append_floats (capture->data, v + 2 + j * 2, 2);
+          append_floats (capture->data, v + stride + 2 + j * 2, 2);
+        }
+      end_record (capture, offset);
+    }
+}
+
+void
+_cogl_capture_log_clear (CoglCapture     *capture,
+                         CoglFramebuffer *framebuffer,
+                         CoglClipStack   *clip_stack,
+                         unsigned long    buffers,
+                         float            red,
+                         float            green,
+                         float            blue,
+                         float            alpha)
+{
+  float color[4] = { red, green, blue, alpha };
+  uint32_t framebuffer_id;
+  uint32_t clip_id;
+  size_t offset;
+
+  if (capture->reading_back)
+    return;
+
+  framebuffer_id = ensure_framebuffer (capture, framebuffer);
+  clip_id = ensure_clip_stack (capture, clip_stack);
+
+  offset = begin_record (capture, COGL_CAPTURE_RECORD_CLEAR);
+  append_uint32 (capture->data, framebuffer_id);
+  append_uint32 (capture->data, clip_id);
+  append_uint32 (capture->data, buffers);
+  append_floats (capture->data, color, G_N_ELEMENTS (color));
+  end_record (capture, offset);
+}
+
+void
+cogl_context_start_capture (CoglContext *ctx)
+{
+  g_return_if_fail (COGL_IS_CONTEXT (ctx));
+  g_return_if_fail (!ctx->capture);
+
+  ctx->capture = _cogl_capture_new ();
+}
+
+gboolean
+cogl_context_stop_capture (CoglContext  *ctx,
+                           const char   *path,
+                           GError      **error)
+{
+  CoglCapture *capture;
+  gboolean ret;
+
+  g_return_val_if_fail (COGL_IS_CONTEXT (ctx), FALSE);
+  g_return_val_if_fail (ctx->capture, FALSE);
+
+  capture = g_steal_pointer (&ctx->capture);
+  ret = g_file_set_contents (path,
+                             (const char *) capture->data->data,
+                             capture->data->len,
+                             error);
+  _cogl_capture_free (capture);
+
+  return ret;
+}
@@ -0,0 +1,115 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A capture is a serialized stream of the drawing Cogl did between
+ * cogl_context_start_capture() and cogl_context_stop_capture(), meant to
+ * be replayed for timing without the application that produced it.
+ *
+ * The file starts with %COGL_CAPTURE_MAGIC followed by a uint32 format
+ * version, and then holds a sequence of records. Each record starts with
+ * a uint32 #CoglCaptureRecordType and the uint32 size of its payload in
+ * bytes. All values are in host byte order; matrices are the 16 floats
+ * of graphene_matrix_to_float().
+ *
+ * Objects are written once, the first time they are used, and are later
+ * referred to by their id. Ids start at 1; 0 means none.
+ *
+ * Pipelines are recorded as the state that matters for the cost of
+ * drawing: the color, blending and the textures, filters and wrap modes
+ * of their layers. Snippets and user programs can not be serialized, and
+ * are only flagged.
+ */
+#define COGL_CAPTURE_MAGIC "COGLCAP\0"
+#define COGL_CAPTURE_MAGIC_LEN 8
+#define COGL_CAPTURE_VERSION 1
+
+typedef enum
+{
+  /*
+   * uint32 id, char[64] hexadecimal SHA-256 of the pixels, uint32 width,
+   * uint32 height, uint32 has_pixels, followed by width * height * 4
+   * bytes of %COGL_PIXEL_FORMAT_RGBA_8888_PRE pixels if has_pixels is
+   * set. Textures with identical contents share one record.
+   */
+  COGL_CAPTURE_RECORD_TEXTURE = 1,
+  /*
+   * uint32 id, uint32 #CoglCapturePipelineFlags, float color[4],
+   * uint32 blend equation rgb and alpha, uint32 blend src and dst factor
+   * rgb and alpha, as GL enums, uint32 n_layers, followed per layer by
+   * uint32 texture id, uint32 #CoglPipelineFilter min and mag filter and
+   * uint32 #CoglPipelineWrapMode s and t.
+   */
+  COGL_CAPTURE_RECORD_PIPELINE = 2,
+  /*
+   * uint32 id, uint32 width, uint32 height, uint32 is_onscreen,
+   * float projection[16]. Written again whenever the projection of the
+   * framebuffer changes.
+   */
+  COGL_CAPTURE_RECORD_FRAMEBUFFER = 3,
+  /*
+   * uint32 id, uint32 n_entries, followed by the entries from the
+   * bottom of the stack up. Rectangle entries are uint32 0, float x0, y0,
+   * x1, y1 and the float modelview[16] the rectangle was pushed with.
+   * Region entries are uint32 1, uint32 n_rects and then int32 x, y,
+   * width and height per rectangle.
+   */
+  COGL_CAPTURE_RECORD_CLIP = 4,
+  /*
+   * uint32 framebuffer id, uint32 clip id, uint32 buffers,
+   * float color[4].
+   */
+  COGL_CAPTURE_RECORD_CLEAR = 5,
+  /*
+   * uint32 framebuffer id, uint32 pipeline id, uint32 clip id,
+   * float viewport[4], float modelview[16], uint32 n_layers, followed by
+   * float x0, y0, x1, y1 and float s0, t0, s1, t1 per layer. One record
+   * is written per journal entry, in submission order.
+   */
+  COGL_CAPTURE_RECORD_DRAW = 6,
+} CoglCaptureRecordType;
+
+typedef enum
+{
+  COGL_CAPTURE_PIPELINE_FLAG_BLEND = 1 << 0,
+  COGL_CAPTURE_PIPELINE_FLAG_SNIPPETS = 1 << 1,
+} CoglCapturePipelineFlags;
+
+G_END_DECLS
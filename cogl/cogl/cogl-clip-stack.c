@@ -327,6 +327,82 @@ _cogl_clip_stack_pop (CoglClipStack *stack)
   return new_top;
 }
 
+static gboolean
+clip_stack_entry_equal (CoglClipStack *entry0,
+                        CoglClipStack *entry1)
+{
+  if (entry0->type != entry1->type ||
+      entry0->bounds_x0 != entry1->bounds_x0 ||
+      entry0->bounds_y0 != entry1->bounds_y0 ||
+      entry0->bounds_x1 != entry1->bounds_x1 ||
+      entry0->bounds_y1 != entry1->bounds_y1)
+    return FALSE;
+
+  switch (entry0->type)
+    {
+    case COGL_CLIP_STACK_RECT:
+      {
+        CoglClipStackRect *rect0 = (CoglClipStackRect *) entry0;
+        CoglClipStackRect *rect1 = (CoglClipStackRect *) entry1;
+        graphene_matrix_t matrix0, matrix1;
+
+        if (rect0->can_be_scissor != rect1->can_be_scissor)
+          return FALSE;
+
+        /* A rectangle that can be scissored is entirely described by
+         * its window space bounds */
+        if (rect0->can_be_scissor)
+          return TRUE;
+
+        if (rect0->x0 != rect1->x0 ||
+            rect0->y0 != rect1->y0 ||
+            rect0->x1 != rect1->x1 ||
+            rect0->y1 != rect1->y1)
+          return FALSE;
+
+        if (rect0->matrix_entry == rect1->matrix_entry)
+          return TRUE;
+
+        cogl_matrix_entry_get (rect0->matrix_entry, &matrix0);
+        cogl_matrix_entry_get (rect1->matrix_entry, &matrix1);
+
+        return graphene_matrix_equal_fast (&matrix0, &matrix1);
+      }
+    case COGL_CLIP_STACK_REGION:
+      {
+        CoglClipStackRegion *region0 = (CoglClipStackRegion *) entry0;
+        CoglClipStackRegion *region1 = (CoglClipStackRegion *) entry1;
+
+        return mtk_region_equal (region0->region, region1->region);
+      }
+    }
+
+  g_assert_not_reached ();
+  return FALSE;
+}
+
+gboolean
+_cogl_clip_stack_equal (CoglClipStack *stack0,
+                        CoglClipStack *stack1)
+{
+  /* Actors pushing the same clip repeatedly end up with distinct but
+   * identical stacks, so this compares the entries rather than just the
+   * pointers. The walk stops as soon as the stacks share an ancestor. */
+  while (stack0 != stack1)
+    {
+      if (stack0 == NULL || stack1 == NULL)
+        return FALSE;
+
+      if (!clip_stack_entry_equal (stack0, stack1))
+        return FALSE;
+
+      stack0 = stack0->parent;
+      stack1 = stack1->parent;
+    }
+
+  return TRUE;
+}
+
 void
 _cogl_clip_stack_get_bounds (CoglClipStack *stack,
                              int *scissor_x0,
@@ -170,6 +170,10 @@ cogl_clip_stack_push_region (CoglClipStack *stack,
 CoglClipStack *
 _cogl_clip_stack_pop (CoglClipStack *stack);
 
+gboolean
+_cogl_clip_stack_equal (CoglClipStack *stack0,
+                        CoglClipStack *stack1);
+
 void
 _cogl_clip_stack_get_bounds (CoglClipStack *stack,
                              int *scissor_x0,
@@ -34,6 +34,7 @@
 #include "cogl/cogl-flags.h"
 
 #include "cogl/cogl-display-private.h"
+#include "cogl/cogl-capture-private.h"
 #include "cogl/cogl-clip-stack.h"
 #include "cogl/cogl-matrix-stack.h"
 #include "cogl/cogl-pipeline-private.h"
@@ -58,6 +59,8 @@ typedef struct
   GLubyte c[4];
 } CoglTextureGLVertex;
 
+#define COGL_UPLOAD_STAGING_RING_SIZE 3
+
 struct _CoglTimestampQuery
 {
   unsigned int id;
@@ -122,6 +125,15 @@ struct _CoglContext
 
   CoglPipelineCache *pipeline_cache;
 
+  /* On-disk cache of linked GLSL program binaries. Disabled while
+   * program_cache_dir is NULL. The driver id is computed lazily and
+   * identifies the GL implementation the binaries were built by. */
+  char             *program_cache_dir;
+  char             *program_cache_driver_id;
+  /* Names of stored program sources left to check by
+   * cogl_context_warm_program_cache(), NULL until it first runs. */
+  GPtrArray        *program_cache_warm_queue;
+
   /* Textures */
   CoglTexture *default_gl_texture_2d_tex;
 
@@ -133,6 +145,11 @@ struct _CoglContext
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
 
+  /* Ring of pixel unpack buffers that bitmap uploads are staged
+   * through when PBOs are available */
+  CoglPixelBuffer  *upload_staging_buffers[COGL_UPLOAD_STAGING_RING_SIZE];
+  int               next_upload_staging_buffer;
+
   /* Some simple caching, to minimize state changes... */
   CoglPipeline     *current_pipeline;
   unsigned long     current_pipeline_changes_since_flush;
@@ -245,6 +262,15 @@ struct _CoglContext
 
   GHashTable *named_pipelines;
 
+  /* Texture memory accounting, see cogl-texture.c */
+  size_t texture_memory[COGL_TEXTURE_MEMORY_N_CATEGORIES];
+  size_t texture_memory_budget;
+  /* Evictable textures, least recently used first */
+  GQueue evictable_textures;
+
+  /* The capture in progress, see cogl-capture.c */
+  CoglCapture *capture;
+
   /* This defines a list of function pointers that Cogl uses from
      either GL or GLES. All functions are accessed indirectly through
      these pointers rather than linking to them directly */
@@ -46,6 +46,7 @@
 #include "cogl/cogl-onscreen-private.h"
 #include "cogl/cogl-attribute-private.h"
 #include "cogl/winsys/cogl-winsys-private.h"
+#include "cogl/driver/gl/cogl-program-cache-gl-private.h"
 
 #include <gio/gio.h>
 #include <string.h>
@@ -72,6 +73,7 @@ cogl_context_dispose (GObject *object)
   CoglContext *context = COGL_CONTEXT (object);
   const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
   const CoglDriverVtable *driver = _cogl_context_get_driver (context);
+  int i;
 
   winsys->context_deinit (context);
 
@@ -92,6 +94,9 @@ cogl_context_dispose (GObject *object)
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
 
+  for (i = 0; i < COGL_UPLOAD_STAGING_RING_SIZE; i++)
+    g_clear_object (&context->upload_staging_buffers[i]);
+
   if (context->rectangle_byte_indices)
     g_object_unref (context->rectangle_byte_indices);
   if (context->rectangle_short_indices)
@@ -124,6 +129,10 @@ cogl_context_dispose (GObject *object)
 
   _cogl_pipeline_cache_free (context->pipeline_cache);
 
+  g_clear_pointer (&context->program_cache_dir, g_free);
+  g_clear_pointer (&context->program_cache_driver_id, g_free);
+  g_clear_pointer (&context->program_cache_warm_queue, g_ptr_array_unref);
+
   _cogl_sampler_cache_free (context->sampler_cache);
 
   g_ptr_array_free (context->uniform_names, TRUE);
@@ -141,6 +150,8 @@ cogl_context_dispose (GObject *object)
   g_hash_table_remove_all (context->named_pipelines);
   g_hash_table_destroy (context->named_pipelines);
 
+  g_clear_pointer (&context->capture, _cogl_capture_free);
+
   G_OBJECT_CLASS (cogl_context_parent_class)->dispose (object);
 }
 
@@ -164,7 +175,11 @@ static void
 _cogl_init_feature_overrides (CoglContext *ctx)
 {
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PBOS)))
-    COGL_FLAGS_SET (ctx->private_features, COGL_PRIVATE_FEATURE_PBOS, FALSE);
+    {
+      COGL_FLAGS_SET (ctx->private_features, COGL_PRIVATE_FEATURE_PBOS, FALSE);
+      COGL_FLAGS_SET (ctx->features,
+                      COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD, FALSE);
+    }
 }
 
 /* For reference: There was some deliberation over whether to have a
@@ -441,6 +456,18 @@ cogl_context_get_latest_sync_fd (CoglContext *context)
   return winsys->get_sync_fd (context);
 }
 
+gboolean
+cogl_context_wait_sync_fd (CoglContext *context,
+                           int          sync_fd)
+{
+  const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
+
+  if (!winsys->wait_sync_fd)
+    return FALSE;
+
+  return winsys->wait_sync_fd (context, sync_fd);
+}
+
 CoglGraphicsResetStatus
 cogl_context_get_graphics_reset_status (CoglContext *context)
 {
@@ -460,6 +487,24 @@ cogl_context_format_supports_upload (CoglContext *ctx,
   return ctx->texture_driver->format_supports_upload (ctx, format);
 }
 
+void
+cogl_context_set_program_cache_dir (CoglContext *ctx,
+                                    const char  *path)
+{
+  g_clear_pointer (&ctx->program_cache_dir, g_free);
+  ctx->program_cache_dir = g_strdup (path);
+  g_clear_pointer (&ctx->program_cache_warm_queue, g_ptr_array_unref);
+}
+
+gboolean
+cogl_context_warm_program_cache (CoglContext *ctx)
+{
+  if (!_cogl_program_cache_gl_is_enabled (ctx))
+    return FALSE;
+
+  return _cogl_program_cache_gl_warm (ctx);
+}
+
 void
 cogl_context_set_named_pipeline (CoglContext     *context,
                                  CoglPipelineKey *key,
@@ -484,6 +529,36 @@ cogl_context_get_named_pipeline (CoglContext     *context,
   return g_hash_table_lookup (context->named_pipelines, key);
 }
 
+void
+cogl_context_set_texture_memory_budget (CoglContext *context,
+                                        size_t       budget)
+{
+  context->texture_memory_budget = budget;
+
+  _cogl_texture_evict_for_budget (context);
+}
+
+size_t
+cogl_context_get_texture_memory_budget (CoglContext *context)
+{
+  return context->texture_memory_budget;
+}
+
+size_t
+cogl_context_evict_textures (CoglContext *context)
+{
+  return _cogl_texture_evict_idle (context);
+}
+
+size_t
+cogl_context_get_texture_memory_usage (CoglContext               *context,
+                                       CoglTextureMemoryCategory  category)
+{
+  g_return_val_if_fail (category < COGL_TEXTURE_MEMORY_N_CATEGORIES, 0);
+
+  return context->texture_memory[category];
+}
+
 /**
  * cogl_context_free_timestamp_query:
  * @context: a #CoglContext object
@@ -181,6 +181,9 @@ cogl_context_get_renderer (CoglContext *context);
  *    cogl_blit_framebuffer() is supported.
  * @COGL_FEATURE_ID_SYNC_FD
  *    cogl_context_get_latest_sync_fd() is supported.
+ * @COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD: Whether textures can be updated
+ *    directly from a #CoglPixelBuffer without the data passing through
+ *    client memory again.
  *
  * All the capabilities that can vary between different GPUs supported
  * by Cogl. Applications that depend on any of these features should explicitly
@@ -201,6 +204,7 @@ typedef enum _CoglFeatureID
   COGL_FEATURE_ID_BLIT_FRAMEBUFFER,
   COGL_FEATURE_ID_TIMESTAMP_QUERY,
   COGL_FEATURE_ID_SYNC_FD,
+  COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD,
 
   /*< private >*/
   _COGL_N_FEATURE_IDS   /*< skip >*/
@@ -306,6 +310,55 @@ COGL_EXPORT CoglPipeline *
 cogl_context_get_named_pipeline (CoglContext     *context,
                                  CoglPipelineKey *key);
 
+/**
+ * cogl_context_set_texture_memory_budget:
+ * @context: a #CoglContext pointer
+ * @budget: the budget in bytes, or 0 for no budget
+ *
+ * Sets how much texture memory @context should try to stay under. When a
+ * texture allocation exceeds the budget, textures made evictable with
+ * cogl_texture_set_evict_func() are evicted, least recently used first.
+ */
+COGL_EXPORT void
+cogl_context_set_texture_memory_budget (CoglContext *context,
+                                        size_t       budget);
+
+/**
+ * cogl_context_get_texture_memory_budget:
+ * @context: a #CoglContext pointer
+ *
+ * Return value: the texture memory budget in bytes, or 0 if there is none
+ */
+COGL_EXPORT size_t
+cogl_context_get_texture_memory_budget (CoglContext *context);
+
+/**
+ * cogl_context_evict_textures:
+ * @context: a #CoglContext pointer
+ *
+ * Evicts all the textures made evictable with cogl_texture_set_evict_func()
+ * that were not used recently, regardless of the texture memory budget.
+ *
+ * Return value: the accounted texture memory that was freed, in bytes
+ */
+COGL_EXPORT size_t
+cogl_context_evict_textures (CoglContext *context);
+
+/**
+ * cogl_context_get_texture_memory_usage:
+ * @context: a #CoglContext pointer
+ * @category: a #CoglTextureMemoryCategory
+ *
+ * Retrieves an estimate of the texture memory allocated by @context for
+ * @category. Only the base level of textures allocated by Cogl itself is
+ * accounted; textures imported from EGLImages are not.
+ *
+ * Return value: the allocated texture memory, in bytes
+ */
+COGL_EXPORT size_t
+cogl_context_get_texture_memory_usage (CoglContext               *context,
+                                       CoglTextureMemoryCategory  category);
+
 /**
  * cogl_context_free_timestamp_query:
  * @context: a #CoglContext pointer
@@ -345,6 +398,22 @@ cogl_context_get_gpu_time_ns (CoglContext *context);
 COGL_EXPORT int
 cogl_context_get_latest_sync_fd (CoglContext *context);
 
+/**
+ * cogl_context_wait_sync_fd
+ * @context: a #CoglContext pointer
+ * @sync_fd: a sync fd
+ *
+ * Makes the GPU wait for the fence of @sync_fd to signal before executing
+ * any commands submitted after this call, without blocking the CPU. The
+ * file descriptor is not consumed.
+ *
+ * Return value: %TRUE if the wait was queued, %FALSE if waiting on sync fds
+ *   is not supported.
+ */
+COGL_EXPORT gboolean
+cogl_context_wait_sync_fd (CoglContext *context,
+                           int          sync_fd);
+
 COGL_EXPORT gboolean
 cogl_context_has_winsys_feature (CoglContext       *context,
                                  CoglWinsysFeature  feature);
@@ -101,6 +101,8 @@ cogl_init_cpu_caps (void)
                  ((xgetbv () & 6) == 6));   /* XMM & YMM */
       if (((regs2[2] >> 29) & 1) && has_avx)
         cogl_cpu_caps |= COGL_CPU_CAP_F16C;
+      if ((regs2[2] >> 9) & 1)
+        cogl_cpu_caps |= COGL_CPU_CAP_SSSE3;
     }
 #endif
 }
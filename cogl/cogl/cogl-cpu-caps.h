@@ -37,6 +37,7 @@
 typedef enum _CoglCpuCaps
 {
   COGL_CPU_CAP_F16C = 1 << 0,
+  COGL_CPU_CAP_SSSE3 = 1 << 1,
 } CoglCpuCaps;
 
 COGL_EXPORT
@@ -39,6 +39,14 @@
 
 typedef struct _CoglDriverVtable CoglDriverVtable;
 
+/* The vtable below is the boundary a non-GL driver (e.g. Vulkan) would
+ * implement, but it isn't yet sufficient on its own: CoglContext embeds
+ * the GL function pointers and current GL program and draw buffer,
+ * pipelines store GL blend enums, textures hand out GL handles and
+ * filters, and onscreens are bound through EGL by the winsys. Those
+ * have to move behind the driver before another one can be added.
+ */
+
 struct _CoglDriverVtable
 {
   gboolean
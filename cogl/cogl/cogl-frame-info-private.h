@@ -55,6 +55,11 @@ typedef enum _CoglFrameInfoFlag
    * happen.
    */
   COGL_FRAME_INFO_FLAG_VSYNC = 1 << 3,
+  /*
+   * The presentation timestamp comes from a completion event delivered by the
+   * display hardware, e.g. a page flip event, rather than being estimated.
+   */
+  COGL_FRAME_INFO_FLAG_HW_COMPLETION = 1 << 4,
 } CoglFrameInfoFlag;
 
 struct _CoglFrameInfo
@@ -124,6 +124,12 @@ cogl_frame_info_is_vsync (CoglFrameInfo *info)
   return !!(info->flags & COGL_FRAME_INFO_FLAG_VSYNC);
 }
 
+gboolean
+cogl_frame_info_is_hw_completion (CoglFrameInfo *info)
+{
+  return !!(info->flags & COGL_FRAME_INFO_FLAG_HW_COMPLETION);
+}
+
 unsigned int
 cogl_frame_info_get_sequence (CoglFrameInfo *info)
 {
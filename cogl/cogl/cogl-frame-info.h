@@ -123,6 +123,9 @@ gboolean cogl_frame_info_is_zero_copy (CoglFrameInfo *info);
 COGL_EXPORT
 gboolean cogl_frame_info_is_vsync (CoglFrameInfo *info);
 
+COGL_EXPORT
+gboolean cogl_frame_info_is_hw_completion (CoglFrameInfo *info);
+
 COGL_EXPORT
 unsigned int cogl_frame_info_get_sequence (CoglFrameInfo *info);
 
@@ -31,7 +31,9 @@
 
 #include "config.h"
 
+#include <glib-unix.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "cogl/cogl-debug.h"
 #include "cogl/cogl-context-private.h"
@@ -569,6 +571,12 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
 
 cleared:
 
+  /* Logged here so that it lands after any journal entries it didn't
+   * discard, which were flushed above */
+  if (G_UNLIKELY (context->capture))
+    _cogl_capture_log_clear (context->capture, framebuffer, clip_stack,
+                             buffers, red, green, blue, alpha);
+
   _cogl_framebuffer_mark_clear_clip_dirty (framebuffer);
 
   if (buffers & COGL_BUFFER_BIT_DEPTH)
@@ -1331,6 +1339,94 @@ cogl_framebuffer_read_pixels_into_bitmap (CoglFramebuffer *framebuffer,
   return status;
 }
 
+typedef struct _CoglReadPixelsData
+{
+  CoglBitmap *bitmap;
+  int sync_fd;
+} CoglReadPixelsData;
+
+static void
+read_pixels_data_free (CoglReadPixelsData *data)
+{
+  g_clear_object (&data->bitmap);
+  if (data->sync_fd >= 0)
+    close (data->sync_fd);
+  g_free (data);
+}
+
+static gboolean
+on_read_pixels_sync_fd_ready (int           fd,
+                              GIOCondition  condition,
+                              gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+
+  g_task_return_boolean (task, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+cogl_framebuffer_read_pixels_into_bitmap_async (CoglFramebuffer     *framebuffer,
+                                                int                  x,
+                                                int                  y,
+                                                CoglReadPixelsFlags  source,
+                                                CoglBitmap          *bitmap,
+                                                GCancellable        *cancellable,
+                                                GAsyncReadyCallback  callback,
+                                                gpointer             user_data)
+{
+  CoglContext *context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (GTask) task = NULL;
+  g_autoptr (GSource) source_fd = NULL;
+  CoglReadPixelsData *data;
+  GError *error = NULL;
+
+  data = g_new0 (CoglReadPixelsData, 1);
+  data->bitmap = g_object_ref (bitmap);
+  data->sync_fd = -1;
+
+  task = g_task_new (framebuffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cogl_framebuffer_read_pixels_into_bitmap_async);
+  g_task_set_task_data (task, data, (GDestroyNotify) read_pixels_data_free);
+
+  if (!_cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  x, y, source, bitmap,
+                                                  &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* Submit the read, which also makes the latest sync fd cover it */
+  cogl_framebuffer_flush (framebuffer);
+
+  data->sync_fd = cogl_context_get_latest_sync_fd (context);
+  if (data->sync_fd < 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  source_fd = g_unix_fd_source_new (data->sync_fd, G_IO_IN);
+  g_source_set_static_name (source_fd, "[cogl] read pixels");
+  g_task_attach_source (task, source_fd,
+                        (GSourceFunc) on_read_pixels_sync_fd_ready);
+}
+
+gboolean
+cogl_framebuffer_read_pixels_into_bitmap_finish (CoglFramebuffer  *framebuffer,
+                                                 GAsyncResult     *result,
+                                                 GError          **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, framebuffer), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                        cogl_framebuffer_read_pixels_into_bitmap_async,
+                        FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 gboolean
 cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
                               int x,
@@ -1487,6 +1583,11 @@ cogl_framebuffer_discard_buffers (CoglFramebuffer *framebuffer,
   CoglFramebufferPrivate *priv =
     cogl_framebuffer_get_instance_private (framebuffer);
 
+  /* The journaled primitives were drawn before the discard was asked
+   * for, so they must reach GL first, or the driver would still have
+   * to store them */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
   cogl_framebuffer_driver_discard_buffers (priv->driver, buffers);
 }
 
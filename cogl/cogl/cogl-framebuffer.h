@@ -40,6 +40,7 @@
 #include "cogl/cogl-texture.h"
 #include "mtk/mtk.h"
 
+#include <gio/gio.h>
 #include <glib-object.h>
 
 #include <graphene.h>
@@ -972,6 +973,56 @@ cogl_framebuffer_read_pixels_into_bitmap (CoglFramebuffer *framebuffer,
                                           CoglReadPixelsFlags source,
                                           CoglBitmap *bitmap);
 
+/**
+ * cogl_framebuffer_read_pixels_into_bitmap_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @source: Identifies which auxiliary buffer you want to read
+ *          (only COGL_READ_PIXELS_COLOR_BUFFER supported currently)
+ * @bitmap: The bitmap to store the results in.
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Callback called when the pixels are available
+ * @user_data: Data passed to @callback
+ *
+ * Like cogl_framebuffer_read_pixels_into_bitmap(), but @callback is
+ * only invoked once the GPU has finished writing the pixels into
+ * @bitmap.
+ *
+ * If @bitmap is backed by a #CoglPixelBuffer and no format conversion
+ * is needed, the read is queued on the GPU without waiting for it, so
+ * that mapping the buffer from @callback doesn't stall either. In
+ * other cases, or if the driver can't signal completion, this
+ * degrades to a synchronous read and @callback is invoked from the
+ * main loop.
+ */
+COGL_EXPORT void
+cogl_framebuffer_read_pixels_into_bitmap_async (CoglFramebuffer     *framebuffer,
+                                                int                  x,
+                                                int                  y,
+                                                CoglReadPixelsFlags  source,
+                                                CoglBitmap          *bitmap,
+                                                GCancellable        *cancellable,
+                                                GAsyncReadyCallback  callback,
+                                                gpointer             user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_into_bitmap_finish:
+ * @framebuffer: A #CoglFramebuffer
+ * @result: The #GAsyncResult passed to the callback
+ * @error: Return location for a #GError
+ *
+ * Finishes a read started with
+ * cogl_framebuffer_read_pixels_into_bitmap_async().
+ *
+ * Return value: %TRUE if the read succeeded and the pixels are
+ *   available in the bitmap, %FALSE otherwise.
+ */
+COGL_EXPORT gboolean
+cogl_framebuffer_read_pixels_into_bitmap_finish (CoglFramebuffer  *framebuffer,
+                                                 GAsyncResult     *result,
+                                                 GError          **error);
+
 /**
  * cogl_framebuffer_read_pixels:
  * @framebuffer: A #CoglFramebuffer
@@ -36,6 +36,7 @@
 #include "cogl/cogl-indices.h"
 #include "cogl/cogl-indices-private.h"
 #include "cogl/cogl-context-private.h"
+#include "cogl/cogl-trace.h"
 
 G_DEFINE_FINAL_TYPE (CoglIndexBuffer, cogl_index_buffer, COGL_TYPE_BUFFER)
 
@@ -64,5 +65,8 @@ cogl_index_buffer_new (CoglContext *context,
                           "default-target", COGL_BUFFER_BIND_TARGET_INDEX_BUFFER,
                           "update-hint", COGL_BUFFER_UPDATE_HINT_STATIC,
                           NULL);
+
+  COGL_TRACE_ALLOCATION (indices, bytes);
+
   return indices;
 }
@@ -48,6 +48,12 @@
 #include <gmodule.h>
 #include <math.h>
 
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /* XXX NB:
  * The data logged in logged_vertices is formatted as follows:
  *
@@ -295,6 +301,9 @@ _cogl_journal_flush_modelview_and_entries (CoglJournalEntry *batch_start,
 
   COGL_TIMER_START (_cogl_uprof_context, time_flush_modelview_and_entries);
 
+  COGL_PERF_COUNTER_ADD (JournalBatches, "JournalBatches",
+                         "journal batches drawn", 1);
+
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING:     modelview batch len = %d\n", batch_len);
 
@@ -1031,7 +1040,7 @@ _cogl_journal_maybe_software_clip_entries (CoglJournalEntry *batch_start,
 static gboolean
 compare_entry_clip_stacks (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
 {
-  return entry0->clip_stack == entry1->clip_stack;
+  return _cogl_clip_stack_equal (entry0->clip_stack, entry1->clip_stack);
 }
 
 static void
@@ -1158,6 +1167,102 @@ create_attribute_buffer (CoglJournal *journal,
   return g_object_ref (vbo);
 }
 
+/* The columns of a modelview matrix needed to transform points with z = 0
+ * and w = 1; the projective row is ignored, as with
+ * cogl_graphene_matrix_transform_points().
+ */
+typedef struct _QuadTransform
+{
+  float x[3];
+  float y[3];
+  float w[3];
+} QuadTransform;
+
+static void
+init_quad_transform (const graphene_matrix_t *modelview,
+                     QuadTransform           *transform)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      transform->x[i] = graphene_matrix_get_value (modelview, 0, i);
+      transform->y[i] = graphene_matrix_get_value (modelview, 1, i);
+      transform->w[i] = graphene_matrix_get_value (modelview, 3, i);
+    }
+}
+
+/* Transforms the four corners of the rectangle (x1, y1), (x2, y2) in the
+ * order the journal emits them, writing 3 components per vertex. Up to
+ * 4 floats per vertex get written, so the caller is expected to fill in
+ * the fourth one afterwards.
+ */
+static inline void
+transform_quad (const QuadTransform *transform,
+                float                x1,
+                float                y1,
+                float                x2,
+                float                y2,
+                float               *vout,
+                size_t               vb_stride)
+{
+#if defined (__SSE2__)
+  __m128 x = _mm_setr_ps (x1, x1, x2, x2);
+  __m128 y = _mm_setr_ps (y1, y2, y2, y1);
+  __m128 c[4];
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      c[i] = _mm_add_ps (_mm_add_ps (_mm_mul_ps (x, _mm_set1_ps (transform->x[i])),
+                                     _mm_mul_ps (y, _mm_set1_ps (transform->y[i]))),
+                         _mm_set1_ps (transform->w[i]));
+    }
+  c[3] = _mm_setzero_ps ();
+
+  _MM_TRANSPOSE4_PS (c[0], c[1], c[2], c[3]);
+
+  for (i = 0; i < 4; i++)
+    _mm_storeu_ps (vout + vb_stride * i, c[i]);
+#elif defined (__ARM_NEON)
+  const float xs[4] = { x1, x1, x2, x2 };
+  const float ys[4] = { y1, y2, y2, y1 };
+  float32x4_t x = vld1q_f32 (xs);
+  float32x4_t y = vld1q_f32 (ys);
+  float32x4x4_t c;
+  float out[16];
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      c.val[i] = vmlaq_n_f32 (vmlaq_n_f32 (vdupq_n_f32 (transform->w[i]),
+                                           x, transform->x[i]),
+                              y, transform->y[i]);
+    }
+  c.val[3] = vdupq_n_f32 (0.f);
+
+  /* Interleave into x, y, z, 0 per vertex */
+  vst4q_f32 (out, c);
+
+  for (i = 0; i < 4; i++)
+    vst1q_f32 (vout + vb_stride * i, vld1q_f32 (out + i * 4));
+#else
+  float xs[4] = { x1, x1, x2, x2 };
+  float ys[4] = { y1, y2, y2, y1 };
+  int i, j;
+
+  for (i = 0; i < 4; i++)
+    {
+      for (j = 0; j < 3; j++)
+        {
+          vout[vb_stride * i + j] = (transform->x[j] * xs[i] +
+                                     transform->y[j] * ys[i] +
+                                     transform->w[j]);
+        }
+    }
+#endif
+}
+
 static CoglAttributeBuffer *
 upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
@@ -1172,7 +1277,7 @@ upload_vertices (CoglJournal *journal,
   int entry_num;
   int i;
   CoglMatrixEntry *last_modelview_entry = NULL;
-  graphene_matrix_t modelview;
+  QuadTransform transform;
 
   g_assert (needed_vbo_len);
 
@@ -1192,11 +1297,9 @@ upload_vertices (CoglJournal *journal,
       size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers);
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      const float *color;
 
-      /* Copy the color to all four of the vertices */
-      for (i = 0; i < 4; i++)
-        memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
-      vin++;
+      color = vin++;
 
       if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
         {
@@ -1211,29 +1314,26 @@ upload_vertices (CoglJournal *journal,
         }
       else
         {
-          float v[8];
+          if (entry->modelview_entry != last_modelview_entry)
+            {
+              graphene_matrix_t modelview;
 
-          v[0] = vin[0];
-          v[1] = vin[1];
-          v[2] = vin[0];
-          v[3] = vin[array_stride + 1];
-          v[4] = vin[array_stride];
-          v[5] = vin[array_stride + 1];
-          v[6] = vin[array_stride];
-          v[7] = vin[1];
+              cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+              init_quad_transform (&modelview, &transform);
+              last_modelview_entry = entry->modelview_entry;
+            }
 
-          if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_graphene_matrix_transform_points (&modelview,
-                                                 2, /* n_components */
-                                                 sizeof (float) * 2, /* stride_in */
-                                                 v, /* points_in */
-                                                 /* strideout */
-                                                 vb_stride * sizeof (float),
-                                                 vout, /* points_out */
-                                                 4 /* n_points */);
+          /* This overwrites the color slot, so it's copied afterwards */
+          transform_quad (&transform,
+                          vin[0], vin[1],
+                          vin[array_stride], vin[array_stride + 1],
+                          vout, vb_stride);
         }
 
+      /* Copy the color to all four of the vertices */
+      for (i = 0; i < 4; i++)
+        memcpy (vout + vb_stride * i + POS_STRIDE, color, 4);
+
       for (i = 0; i < entry->n_layers; i++)
         {
           const float *tin = vin + 2;
@@ -1378,6 +1478,10 @@ _cogl_journal_flush (CoglJournal *journal)
       return;
     }
 
+  COGL_PERF_COUNTER_ADD (JournalQuads, "JournalQuads",
+                         "quads flushed from the journal",
+                         journal->entries->len);
+
   framebuffer = journal->framebuffer;
   ctx = cogl_framebuffer_get_context (framebuffer);
 
@@ -1387,6 +1491,9 @@ _cogl_journal_flush (CoglJournal *journal)
    * this journal... */
   _cogl_framebuffer_flush_dependency_journals (framebuffer);
 
+  if (G_UNLIKELY (ctx->capture))
+    _cogl_capture_log_journal (ctx->capture, journal);
+
   /* Note: we start the timer after flushing dependency journals so
    * that the timer isn't started recursively. */
   COGL_TIMER_START (_cogl_uprof_context, flush_timer);
@@ -1578,6 +1685,10 @@ _cogl_journal_log_quad (CoglJournal  *journal,
   entry->n_layers = n_layers;
   entry->array_offset = next_vert;
 
+  COGL_TRACE_ALLOCATION (entry,
+                         sizeof (CoglJournalEntry) +
+                         (2 * stride + 1) * sizeof (float));
+
   final_pipeline = pipeline;
 
   flush_options.flags = 0;
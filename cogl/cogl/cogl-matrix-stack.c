@@ -333,6 +333,59 @@ cogl_matrix_stack_pop (CoglMatrixStack *stack)
   stack->last_entry = new_top;
 }
 
+/* Runs of translations and scales are accumulated as a scale followed
+ * by a translation and only composed into the matrix once the run
+ * ends, so that they don't each cost a full matrix multiplication. */
+typedef struct _CoglMatrixAffine
+{
+  gboolean pending;
+  float scale[3];
+  float translate[3];
+} CoglMatrixAffine;
+
+static void
+cogl_matrix_affine_init (CoglMatrixAffine *affine)
+{
+  affine->pending = FALSE;
+  affine->scale[0] = affine->scale[1] = affine->scale[2] = 1.0f;
+  affine->translate[0] = affine->translate[1] = affine->translate[2] = 0.0f;
+}
+
+static void
+cogl_matrix_affine_flush (CoglMatrixAffine  *affine,
+                          graphene_matrix_t *matrix,
+                          gboolean          *matrix_is_identity)
+{
+  graphene_matrix_t affine_matrix;
+  float values[16];
+
+  if (!affine->pending)
+    return;
+
+  values[0] = affine->scale[0];
+  values[1] = values[2] = values[3] = 0.0f;
+  values[4] = 0.0f;
+  values[5] = affine->scale[1];
+  values[6] = values[7] = 0.0f;
+  values[8] = values[9] = 0.0f;
+  values[10] = affine->scale[2];
+  values[11] = 0.0f;
+  values[12] = affine->translate[0];
+  values[13] = affine->translate[1];
+  values[14] = affine->translate[2];
+  values[15] = 1.0f;
+
+  graphene_matrix_init_from_float (&affine_matrix, values);
+
+  if (*matrix_is_identity)
+    *matrix = affine_matrix;
+  else
+    graphene_matrix_multiply (matrix, &affine_matrix, matrix);
+
+  *matrix_is_identity = FALSE;
+  cogl_matrix_affine_init (affine);
+}
+
 /* In addition to writing the stack matrix into the give @matrix
  * argument this function *may* sometimes also return a pointer
  * to a matrix too so if we are querying the inverse matrix we
@@ -343,9 +396,12 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
                        graphene_matrix_t *matrix)
 {
   CoglMatrixEntry *current;
+  CoglMatrixAffine affine;
+  gboolean matrix_is_identity = TRUE;
   int depth;
 
   graphene_matrix_init_identity (matrix);
+  cogl_matrix_affine_init (&affine);
 
   for (current = entry, depth = 0;
        current;
@@ -357,14 +413,43 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
           {
             CoglMatrixEntryTranslate *translate =
               (CoglMatrixEntryTranslate *) current;
-            graphene_matrix_translate (matrix, &translate->translate);
-            break;
+            affine.translate[0] += translate->translate.x;
+            affine.translate[1] += translate->translate.y;
+            affine.translate[2] += translate->translate.z;
+            affine.pending = TRUE;
+            continue;
+          }
+        case COGL_MATRIX_OP_SCALE:
+          {
+            CoglMatrixEntryScale *scale =
+              (CoglMatrixEntryScale *) current;
+            affine.scale[0] *= scale->x;
+            affine.scale[1] *= scale->y;
+            affine.scale[2] *= scale->z;
+            affine.translate[0] *= scale->x;
+            affine.translate[1] *= scale->y;
+            affine.translate[2] *= scale->z;
+            affine.pending = TRUE;
+            continue;
           }
+        default:
+          break;
+        }
+
+      cogl_matrix_affine_flush (&affine, matrix, &matrix_is_identity);
+
+      switch (current->op)
+        {
+        case COGL_MATRIX_OP_TRANSLATE:
+        case COGL_MATRIX_OP_SCALE:
+          g_assert_not_reached ();
+          break;
         case COGL_MATRIX_OP_ROTATE:
           {
             CoglMatrixEntryRotate *rotate =
               (CoglMatrixEntryRotate *) current;
             graphene_matrix_rotate (matrix, rotate->angle, &rotate->axis);
+            matrix_is_identity = FALSE;
             break;
           }
         case COGL_MATRIX_OP_ROTATE_EULER:
@@ -372,13 +457,7 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
             CoglMatrixEntryRotateEuler *rotate =
               (CoglMatrixEntryRotateEuler *) current;
             graphene_matrix_rotate_euler (matrix, &rotate->euler);
-            break;
-          }
-        case COGL_MATRIX_OP_SCALE:
-          {
-            CoglMatrixEntryScale *scale =
-              (CoglMatrixEntryScale *) current;
-            graphene_matrix_scale (matrix, scale->x, scale->y, scale->z);
+            matrix_is_identity = FALSE;
             break;
           }
         case COGL_MATRIX_OP_MULTIPLY:
@@ -386,6 +465,7 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
             CoglMatrixEntryMultiply *multiply =
               (CoglMatrixEntryMultiply *) current;
             graphene_matrix_multiply (matrix, &multiply->matrix, matrix);
+            matrix_is_identity = FALSE;
             break;
           }
 
@@ -395,7 +475,10 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
         case COGL_MATRIX_OP_LOAD:
           {
             CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *) current;
-            graphene_matrix_multiply (matrix, &load->matrix, matrix);
+            if (matrix_is_identity)
+              *matrix = load->matrix;
+            else
+              graphene_matrix_multiply (matrix, &load->matrix, matrix);
             goto applied;
           }
         case COGL_MATRIX_OP_SAVE:
@@ -406,12 +489,17 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
                 cogl_matrix_entry_get (current->parent, &save->cache);
                 save->cache_valid = TRUE;
               }
-            graphene_matrix_multiply (matrix, &save->cache, matrix);
+            if (matrix_is_identity)
+              *matrix = save->cache;
+            else
+              graphene_matrix_multiply (matrix, &save->cache, matrix);
             goto applied;
           }
         }
     }
 
+  cogl_matrix_affine_flush (&affine, matrix, &matrix_is_identity);
+
 applied:
 
 #ifdef COGL_ENABLE_DEBUG
@@ -56,5 +56,61 @@ COGL_EXPORT
 gboolean cogl_context_format_supports_upload (CoglContext     *ctx,
                                               CoglPixelFormat  format);
 
+/**
+ * cogl_context_set_program_cache_dir:
+ * @ctx: A #CoglContext
+ * @path: (nullable): Directory to store program binaries in
+ *
+ * Enables caching linked GLSL programs on disk under @path, so that
+ * later instances can skip compiling and linking shaders they have
+ * already seen. Passing %NULL disables the cache. This has no effect
+ * if the driver can not retrieve program binaries.
+ */
+COGL_EXPORT
+void cogl_context_set_program_cache_dir (CoglContext *ctx,
+                                         const char  *path);
+
+/**
+ * cogl_context_warm_program_cache:
+ * @ctx: A #CoglContext
+ *
+ * Links one of the programs whose sources an earlier instance stored in
+ * the program cache, but that has no binary for the current driver yet,
+ * e.g. after a driver update, and stores its binary. Meant to be called
+ * repeatedly while idle, so that the programs are not compiled on demand
+ * in the middle of an animation.
+ *
+ * Returns: %TRUE if there are more programs to check
+ */
+COGL_EXPORT
+gboolean cogl_context_warm_program_cache (CoglContext *ctx);
+
+/**
+ * cogl_context_start_capture:
+ * @ctx: A #CoglContext
+ *
+ * Starts recording everything flushed from the journals of @ctx, and the
+ * framebuffer clears, into a capture that can be replayed offline. See
+ * cogl-capture.h for the format. Only one capture can be in progress.
+ */
+COGL_EXPORT
+void cogl_context_start_capture (CoglContext *ctx);
+
+/**
+ * cogl_context_stop_capture:
+ * @ctx: A #CoglContext
+ * @path: The file to write the capture to
+ * @error: Return location for a #GError
+ *
+ * Stops the capture started with cogl_context_start_capture() and writes
+ * it to @path.
+ *
+ * Return value: %TRUE if the capture was written
+ */
+COGL_EXPORT
+gboolean cogl_context_stop_capture (CoglContext  *ctx,
+                                    const char   *path,
+                                    GError      **error);
+
 COGL_EXPORT
 void cogl_init (void);
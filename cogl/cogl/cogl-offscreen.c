@@ -31,6 +31,7 @@
 #include "cogl/cogl-framebuffer-private.h"
 #include "cogl/cogl-offscreen-private.h"
 #include "cogl/cogl-texture-private.h"
+#include "cogl/cogl-trace.h"
 
 struct _CoglOffscreen
 {
@@ -67,6 +68,8 @@ _cogl_offscreen_new_with_texture_full (CoglTexture       *texture,
   offscreen->texture = g_object_ref (texture);
   offscreen->texture_level = level;
 
+  COGL_TRACE_ALLOCATION (offscreen, sizeof (CoglOffscreen));
+
   fb = COGL_FRAMEBUFFER (offscreen);
 
   /* NB: we can't assume we can query the texture's width yet, since
@@ -37,6 +37,7 @@
 #include "cogl/cogl-pipeline-private.h"
 #include "cogl/cogl-pipeline-hash-table.h"
 #include "cogl/cogl-pipeline-cache.h"
+#include "cogl/cogl-trace.h"
 
 typedef struct
 {
@@ -57,6 +58,10 @@ typedef struct
   /* The number of unique pipelines that had been created when this
    * pipeline was last accessed */
   int age;
+
+  /* The number of times this pipeline was found again after it was
+   * added */
+  unsigned int n_hits;
 } CoglPipelineHashTableEntry;
 
 static void
@@ -101,6 +106,9 @@ _cogl_pipeline_hash_table_init (CoglPipelineHashTable *hash,
   hash->debug_string = debug_string;
   hash->main_state = main_state;
   hash->layer_state = layer_state;
+  hash->n_hits = 0;
+  hash->n_misses = 0;
+  hash->n_evictions = 0;
   /* We'll only start pruning once we get to 16 unique pipelines */
   hash->expected_min_size = 8;
   hash->table = g_hash_table_new_full (entry_hash,
@@ -128,13 +136,20 @@ collect_prunable_entries_cb (void *key,
 }
 
 static int
-compare_pipeline_age_cb (const void *a,
-                         const void *b)
+compare_pipeline_eviction_order_cb (const void *a,
+                                    const void *b)
 {
   const CoglPipelineHashTableEntry *ae = a;
   const CoglPipelineHashTableEntry *be = b;
+  gboolean a_reused = ae->n_hits > 0;
+  gboolean b_reused = be->n_hits > 0;
+
+  /* Pipelines that were only ever looked up once go first, and within
+   * each group the least recently used ones go first */
+  if (a_reused != b_reused)
+    return a_reused - b_reused;
 
-  return be->age - ae->age;
+  return ae->age - be->age;
 }
 
 static void
@@ -150,18 +165,20 @@ prune_old_pipelines (CoglPipelineHashTable *hash)
                         collect_prunable_entries_cb,
                         &entries);
 
-  /* Sort the entries by increasing order of age */
-  entries.head = g_list_sort (entries.head, compare_pipeline_age_cb);
+  /* Sort the entries in the order they should be evicted */
+  entries.head = g_list_sort (entries.head,
+                              compare_pipeline_eviction_order_cb);
 
   /* The +1 is to include the pipeline that we're about to add */
   hash->expected_min_size = (g_hash_table_size (hash->table) -
                              entries.length +
                              1);
 
-  /* Remove oldest half of the prunable pipelines. We still want to
-   * keep some of the prunable entries that are recently used because
-   * it's not unlikely that the application will recreate the same
-   * pipeline */
+  /* Remove half of the prunable pipelines, starting with the ones
+   * that were never reused and then the least recently used ones. We
+   * still want to keep some of the prunable entries that are recently
+   * or frequently used because it's not unlikely that the application
+   * will recreate the same pipeline */
   for (l = entries.head, i = 0; i < entries.length / 2; l = l->next, i++)
     {
       CoglPipelineCacheEntry *entry = l->data;
@@ -169,6 +186,13 @@ prune_old_pipelines (CoglPipelineHashTable *hash)
       g_hash_table_remove (hash->table, entry);
     }
 
+  hash->n_evictions += i;
+
+  COGL_NOTE (PERFORMANCE,
+             "Pruned %d %s, %u hits, %u misses, %u evictions so far",
+             i, hash->debug_string,
+             hash->n_hits, hash->n_misses, hash->n_evictions);
+
   g_list_free (entries.head);
 }
 
@@ -190,9 +214,17 @@ _cogl_pipeline_hash_table_get (CoglPipelineHashTable *hash,
   if (entry)
     {
       entry->age = hash->n_unique_pipelines;
+      entry->n_hits++;
+      hash->n_hits++;
       return &entry->parent;
     }
 
+  hash->n_misses++;
+
+  COGL_PERF_COUNTER_ADD (PipelineCacheMisses, "PipelineCacheMisses",
+                         "pipeline cache lookups that created a new template",
+                         1);
+
   if (hash->n_unique_pipelines == 50)
     g_warning ("Over 50 separate %s have been generated which is very "
                "unusual, so something is probably wrong!\n",
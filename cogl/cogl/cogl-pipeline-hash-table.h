@@ -53,6 +53,11 @@ typedef struct
   unsigned int main_state;
   unsigned int layer_state;
 
+  /* Lookup statistics, only used for debug output */
+  unsigned int n_hits;
+  unsigned int n_misses;
+  unsigned int n_evictions;
+
   GHashTable *table;
 } CoglPipelineHashTable;
 
@@ -46,6 +46,7 @@
 #include "cogl/cogl-profile.h"
 #include "cogl/cogl-depth-state-private.h"
 #include "cogl/cogl-snippet-private.h"
+#include "cogl/cogl-trace.h"
 
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -59,6 +60,7 @@ const CoglPipelineVertend *_cogl_pipeline_vertend;
 const CoglPipelineProgend *_cogl_pipeline_progend;
 
 #include "cogl/driver/gl/cogl-pipeline-fragend-glsl-private.h"
+#include "cogl/driver/gl/cogl-pipeline-opengl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-progend-glsl-private.h"
 
@@ -323,6 +325,8 @@ _cogl_pipeline_copy (CoglPipeline *src, gboolean is_weak)
 {
   CoglPipeline *pipeline = g_object_new (COGL_TYPE_PIPELINE, NULL);
 
+  COGL_TRACE_ALLOCATION (pipeline, sizeof (CoglPipeline));
+
   pipeline->context = src->context;
 
   /* NB: real_blend_enable isn't a sparse property, it's valid for
@@ -2871,3 +2875,11 @@ cogl_pipeline_get_name (CoglPipeline *pipeline)
 {
   return pipeline->name;
 }
+
+gboolean
+cogl_pipeline_precompile (CoglPipeline *pipeline)
+{
+  g_return_val_if_fail (COGL_IS_PIPELINE (pipeline), TRUE);
+
+  return _cogl_pipeline_gl_precompile (pipeline->context, pipeline);
+}
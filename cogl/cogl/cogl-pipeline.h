@@ -180,4 +180,20 @@ cogl_pipeline_set_static_name  (CoglPipeline *pipeline,
 COGL_EXPORT const char *
 cogl_pipeline_get_name (CoglPipeline *pipeline);
 
+/**
+ * cogl_pipeline_precompile:
+ * @pipeline: A #CoglPipeline object
+ *
+ * Starts building the GPU program needed to draw with @pipeline. If
+ * the driver can compile shaders in the background this won't block,
+ * and the caller may choose to draw something simpler until the
+ * program is ready. Call this again on later frames to find out when
+ * it can be used.
+ *
+ * Returns: %TRUE if drawing with @pipeline won't wait for shaders to
+ *   be compiled, %FALSE if they are still being compiled.
+ */
+COGL_EXPORT gboolean
+cogl_pipeline_precompile (CoglPipeline *pipeline);
+
 G_END_DECLS
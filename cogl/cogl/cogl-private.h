@@ -49,6 +49,8 @@ typedef enum
   COGL_PRIVATE_FEATURE_TEXTURE_FORMAT_SIZED_RGBA,
   COGL_PRIVATE_FEATURE_UNPACK_SUBIMAGE,
   COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS,
+  COGL_PRIVATE_FEATURE_PROGRAM_BINARY,
+  COGL_PRIVATE_FEATURE_PARALLEL_SHADER_COMPILE,
   COGL_PRIVATE_FEATURE_READ_PIXELS_ANY_STRIDE,
   COGL_PRIVATE_FEATURE_FORMAT_CONVERSION,
   COGL_PRIVATE_FEATURE_QUERY_FRAMEBUFFER_BITS,
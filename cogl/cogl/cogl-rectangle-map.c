@@ -44,6 +44,11 @@
    structure. The algorithm for this is based on the description here:
 
    http://www.blackpawn.com/texts/lightmaps/default.html
+
+   Each split is a guillotine cut, so rather than taking the first
+   empty leaf that is big enough, new rectangles are put into the leaf
+   that leaves the shortest side over (best short side fit). That keeps
+   large free areas intact for later rectangles of a different size.
 */
 
 typedef struct _CoglRectangleMapNode       CoglRectangleMapNode;
@@ -270,6 +275,8 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   /* Stack of nodes to search in */
   GArray *stack = map->stack;
   CoglRectangleMapNode *found_node = NULL;
+  unsigned int best_short_side = G_MAXUINT;
+  unsigned int best_long_side = G_MAXUINT;
 
   /* Zero-sized rectangles break the algorithm for removing rectangles
      so we'll disallow them */
@@ -279,7 +286,7 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   g_array_set_size (stack, 0);
   _cogl_rectangle_map_stack_push (stack, map->root, FALSE);
 
-  /* Depth-first search for an empty node that is big enough */
+  /* Depth-first search for the empty node that fits best */
   while (stack->len > 0)
     {
       CoglRectangleMapStackEntry *stack_top;
@@ -301,9 +308,23 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
         {
           if (node->type == COGL_RECTANGLE_MAP_EMPTY_LEAF)
             {
-              /* We've found a node we can use */
-              found_node = node;
-              break;
+              unsigned int leftover_width = node->rectangle.width - width;
+              unsigned int leftover_height = node->rectangle.height - height;
+              unsigned int short_side = MIN (leftover_width, leftover_height);
+              unsigned int long_side = MAX (leftover_width, leftover_height);
+
+              if (short_side < best_short_side ||
+                  (short_side == best_short_side &&
+                   long_side < best_long_side))
+                {
+                  found_node = node;
+                  best_short_side = short_side;
+                  best_long_side = long_side;
+
+                  /* Nothing can beat an exact fit */
+                  if (long_side == 0)
+                    break;
+                }
             }
           else if (node->type == COGL_RECTANGLE_MAP_BRANCH)
             {
@@ -472,6 +493,12 @@ _cogl_rectangle_map_get_remaining_space (CoglRectangleMap *map)
   return map->space_remaining;
 }
 
+unsigned int
+_cogl_rectangle_map_get_largest_free_area (CoglRectangleMap *map)
+{
+  return map->root->largest_gap;
+}
+
 unsigned int
 _cogl_rectangle_map_get_n_rectangles (CoglRectangleMap *map)
 {
@@ -64,6 +64,9 @@ _cogl_rectangle_map_get_height (CoglRectangleMap *map);
 unsigned int
 _cogl_rectangle_map_get_remaining_space (CoglRectangleMap *map);
 
+unsigned int
+_cogl_rectangle_map_get_largest_free_area (CoglRectangleMap *map);
+
 unsigned int
 _cogl_rectangle_map_get_n_rectangles (CoglRectangleMap *map);
 
@@ -29,6 +29,8 @@
 
 #include "cogl/cogl-scanout.h"
 
+#include <glib/gstdio.h>
+
 enum
 {
   SCANOUT_FAILED,
@@ -50,6 +52,12 @@ struct _CoglScanout
   graphene_rect_t src_rect;
   gboolean has_dst_rect;
   MtkRectangle dst_rect;
+
+  MtkMonitorTransform transform;
+
+  int sync_fd;
+
+  gboolean allow_tearing;
 };
 
 G_DEFINE_FINAL_TYPE (CoglScanout, cogl_scanout, G_TYPE_OBJECT);
@@ -165,12 +173,53 @@ cogl_scanout_set_dst_rect (CoglScanout        *scanout,
   scanout->has_dst_rect = rect != NULL;
 }
 
+MtkMonitorTransform
+cogl_scanout_get_transform (CoglScanout *scanout)
+{
+  return scanout->transform;
+}
+
+void
+cogl_scanout_set_transform (CoglScanout         *scanout,
+                            MtkMonitorTransform  transform)
+{
+  scanout->transform = transform;
+}
+
+int
+cogl_scanout_get_sync_fd (CoglScanout *scanout)
+{
+  return scanout->sync_fd;
+}
+
+void
+cogl_scanout_set_sync_fd (CoglScanout *scanout,
+                          int          sync_fd)
+{
+  g_clear_fd (&scanout->sync_fd, NULL);
+  scanout->sync_fd = sync_fd;
+}
+
+gboolean
+cogl_scanout_get_allow_tearing (CoglScanout *scanout)
+{
+  return scanout->allow_tearing;
+}
+
+void
+cogl_scanout_set_allow_tearing (CoglScanout *scanout,
+                                gboolean     allow_tearing)
+{
+  scanout->allow_tearing = allow_tearing;
+}
+
 static void
 cogl_scanout_finalize (GObject *object)
 {
   CoglScanout *scanout = COGL_SCANOUT (object);
 
   g_clear_object (&scanout->scanout_buffer);
+  g_clear_fd (&scanout->sync_fd, NULL);
 
   G_OBJECT_CLASS (cogl_scanout_parent_class)->finalize (object);
 }
@@ -194,4 +243,6 @@ cogl_scanout_class_init (CoglScanoutClass *klass)
 static void
 cogl_scanout_init (CoglScanout *scanout)
 {
+  scanout->transform = MTK_MONITOR_TRANSFORM_NORMAL;
+  scanout->sync_fd = -1;
 }
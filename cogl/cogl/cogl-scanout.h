@@ -98,3 +98,50 @@ void cogl_scanout_get_dst_rect (CoglScanout  *scanout,
 COGL_EXPORT
 void cogl_scanout_set_dst_rect (CoglScanout        *scanout,
                                 const MtkRectangle *rect);
+
+/**
+ * cogl_scanout_get_transform:
+ *
+ * Returns: the transform the contents of the scanout buffer were
+ *   pre-transformed with, relative to how they are to be presented
+ */
+COGL_EXPORT
+MtkMonitorTransform cogl_scanout_get_transform (CoglScanout *scanout);
+
+COGL_EXPORT
+void cogl_scanout_set_transform (CoglScanout         *scanout,
+                                 MtkMonitorTransform  transform);
+
+/**
+ * cogl_scanout_get_sync_fd:
+ *
+ * Returns: a sync fd signaling once the scanout buffer is ready to be
+ *   presented, or -1 if it already is
+ */
+COGL_EXPORT
+int cogl_scanout_get_sync_fd (CoglScanout *scanout);
+
+/**
+ * cogl_scanout_set_sync_fd:
+ * @sync_fd: (transfer full): a sync fd, or -1
+ */
+COGL_EXPORT
+void cogl_scanout_set_sync_fd (CoglScanout *scanout,
+                               int          sync_fd);
+
+/**
+ * cogl_scanout_get_allow_tearing:
+ *
+ * Returns: whether the scanout may be presented without waiting for
+ *   vertical blank
+ */
+COGL_EXPORT
+gboolean cogl_scanout_get_allow_tearing (CoglScanout *scanout);
+
+/**
+ * cogl_scanout_set_allow_tearing:
+ * @allow_tearing: whether tearing is allowed
+ */
+COGL_EXPORT
+void cogl_scanout_set_allow_tearing (CoglScanout *scanout,
+                                     gboolean     allow_tearing);
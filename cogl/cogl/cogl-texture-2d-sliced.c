@@ -325,6 +325,7 @@ allocate_slices (CoglTexture2DSliced *tex_2ds,
                                            (int) y_span->size);
 
           _cogl_texture_copy_internal_format (tex, slice);
+          cogl_texture_set_memory_category (slice, tex->memory_category);
 
           g_array_append_val (tex_2ds->slice_textures, slice);
           if (!cogl_texture_allocate (slice, error))
@@ -41,6 +41,7 @@
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-journal-private.h"
 #include "cogl/cogl-framebuffer-private.h"
+#include "cogl/cogl-trace.h"
 #include "cogl/driver/gl/cogl-texture-2d-gl-private.h"
 #ifdef HAVE_EGL
 #include "cogl/winsys/cogl-winsys-egl-private.h"
@@ -94,6 +95,8 @@ _cogl_texture_2d_create_base (CoglContext *ctx,
 
   ctx->driver_vtable->texture_2d_init (tex_2d);
 
+  COGL_TRACE_ALLOCATION (tex_2d, sizeof (CoglTexture2D));
+
   return COGL_TEXTURE (tex_2d);
 }
 
@@ -123,6 +123,14 @@ struct _CoglTexture
   int height;
   gboolean allocated;
 
+  /* Texture memory accounting */
+  size_t memory_size;
+  CoglTextureMemoryCategory memory_category;
+  CoglTextureEvictFunc evict_func;
+  gpointer evict_data;
+  GList evictable_link;
+  int64_t last_used_us;
+
   /*
    * Internal format
    */
@@ -130,6 +138,12 @@ struct _CoglTexture
   unsigned int premultiplied : 1;
 };
 
+void
+_cogl_texture_evict_for_budget (CoglContext *ctx);
+
+size_t
+_cogl_texture_evict_idle (CoglContext *ctx);
+
 struct _CoglTextureClass
 {
   GObjectClass parent_class;
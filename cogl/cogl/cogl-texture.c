@@ -59,6 +59,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+/* Evictable textures used more recently than this are never evicted, so
+ * that textures used by the frame being painted stay around. */
+#define EVICT_MIN_IDLE_US (G_USEC_PER_SEC)
+
 G_DEFINE_ABSTRACT_TYPE (CoglTexture, cogl_texture, G_TYPE_OBJECT)
 
 enum
@@ -97,6 +101,91 @@ _cogl_texture_free_loader (CoglTexture *texture)
     }
 }
 
+static size_t
+get_total_texture_memory (CoglContext *ctx)
+{
+  size_t total = 0;
+  int i;
+
+  for (i = 0; i < COGL_TEXTURE_MEMORY_N_CATEGORIES; i++)
+    total += ctx->texture_memory[i];
+
+  return total;
+}
+
+static void
+evict_textures (CoglContext *ctx,
+                size_t       target)
+{
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+
+  while (get_total_texture_memory (ctx) > target)
+    {
+      GList *link = ctx->evictable_textures.head;
+      CoglTexture *texture;
+      CoglTextureEvictFunc evict_func;
+      gpointer evict_data;
+
+      if (!link)
+        break;
+
+      texture = link->data;
+
+      /* The queue is in least recently used order, so everything after
+       * this one was used even more recently. */
+      if (now_us - texture->last_used_us < EVICT_MIN_IDLE_US)
+        break;
+
+      evict_func = texture->evict_func;
+      evict_data = texture->evict_data;
+
+      g_queue_unlink (&ctx->evictable_textures, link);
+      texture->evict_func = NULL;
+      texture->evict_data = NULL;
+
+      COGL_NOTE (TEXTURES, "Evicting %dx%d texture %p (%zu bytes)",
+                 texture->width, texture->height, texture,
+                 texture->memory_size);
+
+      evict_func (texture, evict_data);
+    }
+}
+
+void
+_cogl_texture_evict_for_budget (CoglContext *ctx)
+{
+  if (ctx->texture_memory_budget == 0)
+    return;
+
+  evict_textures (ctx, ctx->texture_memory_budget);
+}
+
+size_t
+_cogl_texture_evict_idle (CoglContext *ctx)
+{
+  size_t total;
+
+  total = get_total_texture_memory (ctx);
+  evict_textures (ctx, 0);
+
+  return total - get_total_texture_memory (ctx);
+}
+
+static void
+account_texture_memory (CoglTexture *texture)
+{
+  CoglContext *ctx = texture->context;
+  CoglPixelFormat format = cogl_texture_get_format (texture);
+
+  texture->memory_size = ((size_t) texture->width * texture->height *
+                          cogl_pixel_format_get_bytes_per_pixel (format, 0));
+  ctx->texture_memory[texture->memory_category] += texture->memory_size;
+
+  _cogl_texture_evict_for_budget (ctx);
+}
+
 static void
 cogl_texture_dispose (GObject *object)
 {
@@ -104,6 +193,20 @@ cogl_texture_dispose (GObject *object)
 
   _cogl_texture_free_loader (texture);
 
+  if (texture->evict_func)
+    {
+      g_queue_unlink (&texture->context->evictable_textures,
+                      &texture->evictable_link);
+      texture->evict_func = NULL;
+    }
+
+  if (texture->memory_size)
+    {
+      texture->context->texture_memory[texture->memory_category] -=
+        texture->memory_size;
+      texture->memory_size = 0;
+    }
+
   G_OBJECT_CLASS (cogl_texture_parent_class)->dispose (object);
 }
 
@@ -948,6 +1051,10 @@ _cogl_texture_associate_framebuffer (CoglTexture *texture,
    * that would introduce a circular reference. */
   texture->framebuffers = g_list_prepend (texture->framebuffers, framebuffer);
 
+  if (texture->memory_category == COGL_TEXTURE_MEMORY_CATEGORY_OTHER)
+    cogl_texture_set_memory_category (texture,
+                                      COGL_TEXTURE_MEMORY_CATEGORY_OFFSCREEN);
+
   g_signal_connect (framebuffer, "destroy",
                     G_CALLBACK (on_framebuffer_destroy),
                     texture);
@@ -1104,11 +1211,22 @@ gboolean
 cogl_texture_allocate (CoglTexture *texture,
                        GError **error)
 {
+  gboolean account_memory;
+
   g_return_val_if_fail (COGL_IS_TEXTURE (texture), FALSE);
 
   if (texture->allocated)
     return TRUE;
 
+  /* Only account the textures whose storage Cogl allocates itself; sliced
+   * and atlas textures are accounted through the 2D textures backing them,
+   * and imported EGLImages belong to someone else. */
+  account_memory =
+    COGL_IS_TEXTURE_2D (texture) &&
+    texture->loader &&
+    (texture->loader->src_type == COGL_TEXTURE_SOURCE_TYPE_SIZE ||
+     texture->loader->src_type == COGL_TEXTURE_SOURCE_TYPE_BITMAP);
+
   if (texture->components == COGL_TEXTURE_COMPONENTS_RG &&
       !cogl_context_has_feature (texture->context, COGL_FEATURE_ID_TEXTURE_RG))
     g_set_error (error,
@@ -1119,6 +1237,9 @@ cogl_texture_allocate (CoglTexture *texture,
 
   texture->allocated = COGL_TEXTURE_GET_CLASS (texture)->allocate (texture, error);
 
+  if (texture->allocated && account_memory)
+    account_texture_memory (texture);
+
   return texture->allocated;
 }
 
@@ -1303,3 +1424,79 @@ cogl_texture_set_auto_mipmap (CoglTexture *texture,
 
   COGL_TEXTURE_GET_CLASS (texture)->set_auto_mipmap (texture, value);
 }
+
+void
+cogl_texture_set_memory_category (CoglTexture               *texture,
+                                  CoglTextureMemoryCategory  category)
+{
+  CoglContext *ctx;
+
+  g_return_if_fail (COGL_IS_TEXTURE (texture));
+  g_return_if_fail (category < COGL_TEXTURE_MEMORY_N_CATEGORIES);
+
+  ctx = texture->context;
+
+  if (COGL_IS_TEXTURE_2D_SLICED (texture))
+    {
+      CoglTexture2DSliced *tex_2ds = COGL_TEXTURE_2D_SLICED (texture);
+      unsigned int i;
+
+      for (i = 0; tex_2ds->slice_textures && i < tex_2ds->slice_textures->len; i++)
+        {
+          CoglTexture *slice =
+            g_array_index (tex_2ds->slice_textures, CoglTexture *, i);
+
+          cogl_texture_set_memory_category (slice, category);
+        }
+    }
+
+  if (texture->memory_category == category)
+    return;
+
+  ctx->texture_memory[texture->memory_category] -= texture->memory_size;
+  ctx->texture_memory[category] += texture->memory_size;
+  texture->memory_category = category;
+}
+
+void
+cogl_texture_set_evict_func (CoglTexture          *texture,
+                             CoglTextureEvictFunc  func,
+                             gpointer              user_data)
+{
+  CoglContext *ctx;
+
+  g_return_if_fail (COGL_IS_TEXTURE (texture));
+
+  ctx = texture->context;
+
+  if (texture->evict_func)
+    g_queue_unlink (&ctx->evictable_textures, &texture->evictable_link);
+
+  texture->evict_func = func;
+  texture->evict_data = user_data;
+
+  if (func)
+    {
+      texture->evictable_link.data = texture;
+      texture->last_used_us = g_get_monotonic_time ();
+      g_queue_push_tail_link (&ctx->evictable_textures,
+                              &texture->evictable_link);
+    }
+}
+
+void
+cogl_texture_mark_used (CoglTexture *texture)
+{
+  CoglContext *ctx;
+
+  g_return_if_fail (COGL_IS_TEXTURE (texture));
+
+  if (!texture->evict_func)
+    return;
+
+  ctx = texture->context;
+
+  texture->last_used_us = g_get_monotonic_time ();
+  g_queue_unlink (&ctx->evictable_textures, &texture->evictable_link);
+  g_queue_push_tail_link (&ctx->evictable_textures, &texture->evictable_link);
+}
@@ -482,4 +482,56 @@ cogl_texture_get_format (CoglTexture *texture);
 COGL_EXPORT CoglContext *
 cogl_texture_get_context (CoglTexture *texture);
 
+/**
+ * CoglTextureEvictFunc:
+ * @texture: The #CoglTexture being evicted
+ * @user_data: The user data passed to cogl_texture_set_evict_func()
+ *
+ * Called when the texture memory budget is exceeded and @texture is the
+ * least recently used evictable texture. The owner is expected to drop
+ * its references to @texture, and re-create it when it is needed again.
+ */
+typedef void (* CoglTextureEvictFunc) (CoglTexture *texture,
+                                       gpointer     user_data);
+
+/**
+ * cogl_texture_set_memory_category:
+ * @texture: A #CoglTexture
+ * @category: The #CoglTextureMemoryCategory to account @texture under
+ *
+ * Sets what the memory of @texture is accounted as, see
+ * cogl_context_get_texture_memory_usage().
+ */
+COGL_EXPORT void
+cogl_texture_set_memory_category (CoglTexture               *texture,
+                                  CoglTextureMemoryCategory  category);
+
+/**
+ * cogl_texture_set_evict_func:
+ * @texture: A #CoglTexture
+ * @func: (nullable): A #CoglTextureEvictFunc, or %NULL
+ * @user_data: User data passed to @func
+ *
+ * Marks @texture as re-creatable, allowing it to be evicted when the
+ * texture memory budget set with cogl_context_set_texture_memory_budget()
+ * is exceeded. Textures are evicted in least recently used order, see
+ * cogl_texture_mark_used(). Pass %NULL as @func to make @texture no longer
+ * evictable; this must be done before the owner passed as @user_data goes
+ * away.
+ */
+COGL_EXPORT void
+cogl_texture_set_evict_func (CoglTexture          *texture,
+                             CoglTextureEvictFunc  func,
+                             gpointer              user_data);
+
+/**
+ * cogl_texture_mark_used:
+ * @texture: A #CoglTexture
+ *
+ * Marks an evictable @texture as recently used, making it the last
+ * candidate for eviction.
+ */
+COGL_EXPORT void
+cogl_texture_mark_used (CoglTexture *texture);
+
 G_END_DECLS
@@ -34,10 +34,15 @@
 #include <sysprof-capture.h>
 #include <sysprof-capture-writer.h>
 #include <sysprof-clock.h>
+#include <string.h>
 #include <syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
 #define COGL_TRACE_OUTPUT_FILE "cogl-trace-sp-capture.syscap"
 #define BUFFER_LENGTH (4096 * 4)
 
@@ -53,6 +58,8 @@ typedef struct _CoglTraceThreadContext
 {
   int cpu_id;
   GPid pid;
+  pid_t tid;
+  unsigned int n_allocations;
   char *group;
   CoglTraceContext *trace_context;
 } CoglTraceThreadContext;
@@ -63,6 +70,14 @@ typedef struct
   CoglTraceContext *trace_context;
 } TraceData;
 
+typedef struct
+{
+  CoglTraceContext *trace_context;
+  unsigned int counter;
+  int64_t n_allocations;
+  int64_t n_bytes;
+} AllocationSite;
+
 static void cogl_trace_context_unref (CoglTraceContext *trace_context);
 
 static void
@@ -80,6 +95,10 @@ static void cogl_trace_thread_context_free (gpointer data);
 GPrivate cogl_trace_thread_data = G_PRIVATE_INIT (cogl_trace_thread_context_free);
 CoglTraceContext *cogl_trace_context;
 GMutex cogl_trace_mutex;
+unsigned int cogl_trace_allocation_sample_interval;
+
+/* Call site string to AllocationSite, protected by cogl_trace_mutex */
+static GHashTable *cogl_trace_allocation_sites;
 
 static CoglTraceContext *
 cogl_trace_context_new (int         fd,
@@ -171,6 +190,7 @@ cogl_trace_thread_context_new (const char       *group,
   thread_context = g_new0 (CoglTraceThreadContext, 1);
   thread_context->cpu_id = -1;
   thread_context->pid = getpid ();
+  thread_context->tid = tid;
   thread_context->group =
     group ? g_strdup (group) : g_strdup_printf ("t:%d", tid);
   thread_context->trace_context = cogl_trace_context_ref (trace_context);
@@ -502,6 +522,159 @@ cogl_trace_define_counter_double (const char *name,
   return cogl_trace_define_counter (name, description,
                                     SYSPROF_CAPTURE_COUNTER_DOUBLE);
 }
+void
+cogl_set_allocation_tracing (unsigned int sample_interval)
+{
+  g_atomic_int_set (&cogl_trace_allocation_sample_interval, sample_interval);
+}
+
+#ifdef HAVE_EXECINFO_H
+static int
+collect_backtrace (SysprofCaptureAddress *addresses,
+                   unsigned int           n_addresses,
+                   gpointer               user_data)
+{
+  void *frames[64];
+  int n_frames;
+  int i;
+
+  n_frames = backtrace (frames, MIN (n_addresses, G_N_ELEMENTS (frames)));
+
+  /* Skip ourselves and the writer */
+  for (i = 2; i < n_frames; i++)
+    addresses[i - 2] = GPOINTER_TO_SIZE (frames[i]);
+
+  return MAX (n_frames - 2, 0);
+}
+#endif
+
+static AllocationSite *
+ensure_allocation_site (CoglTraceThreadContext *trace_thread_context,
+                        const char             *site,
+                        SysprofTimeStamp        time)
+{
+  CoglTraceContext *trace_context = trace_thread_context->trace_context;
+  AllocationSite *allocation_site;
+  SysprofCaptureCounter counters[2];
+  const char *file;
+
+  if (!cogl_trace_allocation_sites)
+    cogl_trace_allocation_sites = g_hash_table_new_full (NULL, NULL,
+                                                         NULL, g_free);
+
+  allocation_site = g_hash_table_lookup (cogl_trace_allocation_sites, site);
+  if (allocation_site && allocation_site->trace_context == trace_context)
+    return allocation_site;
+
+  if (!allocation_site)
+    {
+      allocation_site = g_new0 (AllocationSite, 1);
+      g_hash_table_insert (cogl_trace_allocation_sites,
+                           (gpointer) site, allocation_site);
+    }
+
+  /* Counters belong to the capture they were defined in, so a new
+   * capture needs them defined again. */
+  allocation_site->trace_context = trace_context;
+  allocation_site->counter =
+    sysprof_capture_writer_request_counter (trace_context->writer, 2);
+  allocation_site->n_allocations = 0;
+  allocation_site->n_bytes = 0;
+
+  file = strrchr (site, '/');
+  file = file ? file + 1 : site;
+
+  memset (counters, 0, sizeof counters);
+  counters[0].id = allocation_site->counter;
+  counters[0].type = SYSPROF_CAPTURE_COUNTER_INT64;
+  g_strlcpy (counters[0].category, CATEGORY " allocations",
+             sizeof counters[0].category);
+  g_snprintf (counters[0].name, sizeof counters[0].name, "%s", file);
+  g_snprintf (counters[0].description, sizeof counters[0].description,
+              "Allocations at %s", file);
+
+  counters[1] = counters[0];
+  counters[1].id = allocation_site->counter + 1;
+  g_strlcpy (counters[1].category, CATEGORY " allocated bytes",
+             sizeof counters[1].category);
+  g_snprintf (counters[1].description, sizeof counters[1].description,
+              "Bytes allocated at %s", file);
+
+  sysprof_capture_writer_define_counters (trace_context->writer,
+                                          time,
+                                          trace_thread_context->cpu_id,
+                                          trace_thread_context->pid,
+                                          counters,
+                                          G_N_ELEMENTS (counters));
+
+  return allocation_site;
+}
+
+void
+cogl_trace_allocation (const char *site,
+                       gpointer    address,
+                       size_t      size)
+{
+  SysprofTimeStamp time;
+  CoglTraceContext *trace_context;
+  CoglTraceThreadContext *trace_thread_context;
+  AllocationSite *allocation_site;
+  unsigned int sample_interval;
+  unsigned int counter_ids[2];
+  SysprofCaptureCounterValue values[2];
+  gboolean ret;
+
+  sample_interval = g_atomic_int_get (&cogl_trace_allocation_sample_interval);
+  if (sample_interval == 0)
+    return;
+
+  trace_thread_context = g_private_get (&cogl_trace_thread_data);
+  if (trace_thread_context->n_allocations++ % sample_interval != 0)
+    return;
+
+  time = g_get_monotonic_time () * 1000;
+  trace_context = trace_thread_context->trace_context;
+
+  g_mutex_lock (&cogl_trace_mutex);
+
+  allocation_site = ensure_allocation_site (trace_thread_context, site, time);
+  allocation_site->n_allocations += sample_interval;
+  allocation_site->n_bytes += (int64_t) size * sample_interval;
+
+  counter_ids[0] = allocation_site->counter;
+  counter_ids[1] = allocation_site->counter + 1;
+  values[0].v64 = allocation_site->n_allocations;
+  values[1].v64 = allocation_site->n_bytes;
+
+  ret = sysprof_capture_writer_set_counters (trace_context->writer,
+                                             time,
+                                             trace_thread_context->cpu_id,
+                                             trace_thread_context->pid,
+                                             counter_ids,
+                                             values,
+                                             G_N_ELEMENTS (counter_ids));
+#ifdef HAVE_EXECINFO_H
+  if (ret)
+    {
+      ret = sysprof_capture_writer_add_allocation (trace_context->writer,
+                                                   time,
+                                                   trace_thread_context->cpu_id,
+                                                   trace_thread_context->pid,
+                                                   trace_thread_context->tid,
+                                                   GPOINTER_TO_SIZE (address),
+                                                   size,
+                                                   collect_backtrace,
+                                                   NULL);
+    }
+#endif
+
+  if (!ret)
+    {
+      if (errno == EPIPE)
+        cogl_set_tracing_disabled_on_thread (g_main_context_get_thread_default ());
+    }
+  g_mutex_unlock (&cogl_trace_mutex);
+}
 
 #else
 
@@ -545,4 +718,134 @@ cogl_set_tracing_disabled_on_thread (void *data)
   fprintf (stderr, "Tracing not enabled");
 }
 
+void
+cogl_set_allocation_tracing (unsigned int sample_interval)
+{
+}
+
 #endif /* HAVE_PROFILER */
+
+struct _CoglPerfCounter
+{
+  char *name;
+  char *description;
+  CoglPerfCounterKind kind;
+
+  int64_t value;
+  int64_t frame_value;
+
+#ifdef HAVE_PROFILER
+  gboolean has_trace_counter;
+  unsigned int trace_counter;
+#endif
+};
+
+static GMutex cogl_perf_counters_mutex;
+static GPtrArray *cogl_perf_counters;
+
+CoglPerfCounter *
+cogl_perf_counter_register (const char          *name,
+                            const char          *description,
+                            CoglPerfCounterKind  kind)
+{
+  CoglPerfCounter *counter;
+  unsigned int i;
+
+  g_mutex_lock (&cogl_perf_counters_mutex);
+
+  if (!cogl_perf_counters)
+    cogl_perf_counters = g_ptr_array_new ();
+
+  for (i = 0; i < cogl_perf_counters->len; i++)
+    {
+      counter = g_ptr_array_index (cogl_perf_counters, i);
+
+      if (g_str_equal (counter->name, name))
+        {
+          g_mutex_unlock (&cogl_perf_counters_mutex);
+          return counter;
+        }
+    }
+
+  counter = g_new0 (CoglPerfCounter, 1);
+  counter->name = g_strdup (name);
+  counter->description = g_strdup (description);
+  counter->kind = kind;
+  g_ptr_array_add (cogl_perf_counters, counter);
+
+  g_mutex_unlock (&cogl_perf_counters_mutex);
+
+  return counter;
+}
+
+void
+cogl_perf_counter_add (CoglPerfCounter *counter,
+                       int64_t          value)
+{
+  g_mutex_lock (&cogl_perf_counters_mutex);
+  counter->value += value;
+  g_mutex_unlock (&cogl_perf_counters_mutex);
+}
+
+void
+cogl_perf_counter_set (CoglPerfCounter *counter,
+                       int64_t          value)
+{
+  g_mutex_lock (&cogl_perf_counters_mutex);
+  counter->value = value;
+  g_mutex_unlock (&cogl_perf_counters_mutex);
+}
+
+void
+cogl_perf_counters_end_frame (void)
+{
+  unsigned int i;
+
+  g_mutex_lock (&cogl_perf_counters_mutex);
+
+  for (i = 0; cogl_perf_counters && i < cogl_perf_counters->len; i++)
+    {
+      CoglPerfCounter *counter = g_ptr_array_index (cogl_perf_counters, i);
+
+      counter->frame_value = counter->value;
+      if (counter->kind == COGL_PERF_COUNTER_KIND_SUM)
+        counter->value = 0;
+
+#ifdef HAVE_PROFILER
+      if (cogl_is_tracing_enabled ())
+        {
+          if (!counter->has_trace_counter)
+            {
+              counter->trace_counter =
+                cogl_trace_define_counter_int (counter->name,
+                                               counter->description);
+              counter->has_trace_counter = TRUE;
+            }
+
+          cogl_trace_set_counter_int (counter->trace_counter,
+                                      counter->frame_value);
+        }
+#endif
+    }
+
+  g_mutex_unlock (&cogl_perf_counters_mutex);
+}
+
+void
+cogl_perf_counters_foreach (CoglPerfCounterFunc func,
+                            gpointer            user_data)
+{
+  unsigned int i;
+
+  g_mutex_lock (&cogl_perf_counters_mutex);
+
+  for (i = 0; cogl_perf_counters && i < cogl_perf_counters->len; i++)
+    {
+      CoglPerfCounter *counter = g_ptr_array_index (cogl_perf_counters, i);
+
+      func (counter->name, counter->description, counter->frame_value,
+            user_data);
+    }
+
+  g_mutex_unlock (&cogl_perf_counters_mutex);
+}
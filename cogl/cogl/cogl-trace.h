@@ -124,6 +124,24 @@ COGL_EXPORT
 unsigned int cogl_trace_define_counter_double (const char *name,
                                                const char *description);
 
+COGL_EXPORT
+unsigned int cogl_trace_allocation_sample_interval;
+
+COGL_EXPORT
+void cogl_set_allocation_tracing (unsigned int sample_interval);
+
+COGL_EXPORT
+void cogl_trace_allocation (const char *site,
+                            gpointer    address,
+                            size_t      size);
+
+static inline gboolean
+cogl_is_tracing_allocations (void)
+{
+  return cogl_trace_allocation_sample_interval > 0 &&
+         cogl_is_tracing_enabled ();
+}
+
 static inline gpointer
 cogl_trace_counter_data_int (gpointer user_data)
 {
@@ -230,6 +248,14 @@ cogl_trace_counter_data_double (gpointer user_data)
   COGL_TRACE_INTERNAL_SET_COUNTER(Name, value, \
                                   cogl_trace_set_counter_double)
 
+#define COGL_TRACE_ALLOCATION(address, size) \
+  G_STMT_START \
+    { \
+      if (cogl_is_tracing_allocations ()) \
+        cogl_trace_allocation (G_STRLOC, address, size); \
+    } \
+  G_STMT_END
+
 #else /* HAVE_PROFILER */
 
 #include <stdio.h>
@@ -244,6 +270,7 @@ cogl_trace_counter_data_double (gpointer user_data)
 #define COGL_TRACE_DEFINE_COUNTER_DOUBLE(Name, name, description) (void) 0
 #define COGL_TRACE_SET_COUNTER_INT(Name, value) (void) 0
 #define COGL_TRACE_SET_COUNTER_DOUBLE(Name, value) (void) 0
+#define COGL_TRACE_ALLOCATION(address, size) (void) 0
 
 COGL_EXPORT
 gboolean cogl_start_tracing_with_path (const char  *filename,
@@ -263,4 +290,74 @@ void cogl_set_tracing_enabled_on_thread (void       *data,
 COGL_EXPORT
 void cogl_set_tracing_disabled_on_thread (void *data);
 
+COGL_EXPORT
+void cogl_set_allocation_tracing (unsigned int sample_interval);
+
 #endif /* HAVE_PROFILER */
+
+/*
+ * Performance counters are available regardless of whether profiling is
+ * built in. They accumulate until cogl_perf_counters_end_frame() takes a
+ * snapshot of their values, which is what cogl_perf_counters_foreach()
+ * reports and what ends up as trace counters while tracing. Updating a
+ * counter takes a lock, so hot paths should add up their values first.
+ */
+typedef struct _CoglPerfCounter CoglPerfCounter;
+
+typedef enum _CoglPerfCounterKind
+{
+  /* Added to during a frame and reset when it ends */
+  COGL_PERF_COUNTER_KIND_SUM,
+  /* Keeps the last value set */
+  COGL_PERF_COUNTER_KIND_VALUE,
+} CoglPerfCounterKind;
+
+typedef void (* CoglPerfCounterFunc) (const char *name,
+                                      const char *description,
+                                      int64_t     value,
+                                      gpointer    user_data);
+
+COGL_EXPORT
+CoglPerfCounter * cogl_perf_counter_register (const char          *name,
+                                              const char          *description,
+                                              CoglPerfCounterKind  kind);
+
+COGL_EXPORT
+void cogl_perf_counter_add (CoglPerfCounter *counter,
+                            int64_t          value);
+
+COGL_EXPORT
+void cogl_perf_counter_set (CoglPerfCounter *counter,
+                            int64_t          value);
+
+COGL_EXPORT
+void cogl_perf_counters_end_frame (void);
+
+COGL_EXPORT
+void cogl_perf_counters_foreach (CoglPerfCounterFunc func,
+                                 gpointer            user_data);
+
+#define COGL_PERF_COUNTER_INTERNAL_UPDATE(Name, name, description, kind, func, value) \
+  G_STMT_START \
+    { \
+      static CoglPerfCounter *CoglPerfCounter##Name = NULL; \
+      if (g_once_init_enter (&CoglPerfCounter##Name)) \
+        { \
+          g_once_init_leave (&CoglPerfCounter##Name, \
+                             cogl_perf_counter_register (name, \
+                                                         description, \
+                                                         kind)); \
+        } \
+      func (CoglPerfCounter##Name, value); \
+    } \
+  G_STMT_END
+
+#define COGL_PERF_COUNTER_ADD(Name, name, description, value) \
+  COGL_PERF_COUNTER_INTERNAL_UPDATE (Name, name, description, \
+                                     COGL_PERF_COUNTER_KIND_SUM, \
+                                     cogl_perf_counter_add, value)
+
+#define COGL_PERF_COUNTER_SET(Name, name, description, value) \
+  COGL_PERF_COUNTER_INTERNAL_UPDATE (Name, name, description, \
+                                     COGL_PERF_COUNTER_KIND_VALUE, \
+                                     cogl_perf_counter_set, value)
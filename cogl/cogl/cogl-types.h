@@ -311,6 +311,29 @@ typedef enum /*< prefix=COGL_READ_PIXELS >*/
   COGL_READ_PIXELS_COLOR_BUFFER = 1L << 0
 } CoglReadPixelsFlags;
 
+/**
+ * CoglTextureMemoryCategory:
+ * @COGL_TEXTURE_MEMORY_CATEGORY_OTHER: Regular textures
+ * @COGL_TEXTURE_MEMORY_CATEGORY_ATLAS: Textures backing a texture atlas
+ * @COGL_TEXTURE_MEMORY_CATEGORY_OFFSCREEN: Textures rendered to through a
+ *   #CoglOffscreen
+ * @COGL_TEXTURE_MEMORY_CATEGORY_CACHE: Textures holding contents that can
+ *   be re-created at any time, such as effect results or mipmaps
+ * @COGL_TEXTURE_MEMORY_N_CATEGORIES: Number of categories
+ *
+ * Categories used to account texture memory, see
+ * cogl_context_get_texture_memory_usage().
+ */
+typedef enum /*< prefix=COGL_TEXTURE_MEMORY >*/
+{
+  COGL_TEXTURE_MEMORY_CATEGORY_OTHER,
+  COGL_TEXTURE_MEMORY_CATEGORY_ATLAS,
+  COGL_TEXTURE_MEMORY_CATEGORY_OFFSCREEN,
+  COGL_TEXTURE_MEMORY_CATEGORY_CACHE,
+
+  COGL_TEXTURE_MEMORY_N_CATEGORIES
+} CoglTextureMemoryCategory;
+
 typedef struct _CoglScanout CoglScanout;
 typedef struct _CoglScanoutBuffer CoglScanoutBuffer;
 
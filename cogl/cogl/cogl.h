@@ -46,6 +46,7 @@
 #include "cogl/cogl-macros.h"
 
 #include "cogl/cogl-bitmap.h"
+#include "cogl/cogl-capture.h"
 #include "cogl/cogl-color.h"
 #include "cogl/cogl-dma-buf-handle.h"
 #include "cogl/cogl-matrix-stack.h"
@@ -247,6 +247,60 @@ add_stencil_clip_region (CoglFramebuffer *framebuffer,
   GE( ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP) );
 }
 
+static MtkRegion *
+intersect_region_with_bounds (MtkRegion *region,
+                              int        x0,
+                              int        y0,
+                              int        x1,
+                              int        y1)
+{
+  MtkRegion *intersection;
+
+  intersection = mtk_region_copy (region);
+  mtk_region_intersect_rectangle (intersection,
+                                  &MTK_RECTANGLE_INIT (x0, y0,
+                                                       MAX (x1 - x0, 0),
+                                                       MAX (y1 - y0, 0)));
+
+  return intersection;
+}
+
+/* A region clip only needs the stencil buffer if what's left of it
+ * within the scissor bounds isn't a single rectangle. Shrink the bounds
+ * to any such rectangle so that it can be handled by scissoring
+ * alone. */
+static void
+tighten_bounds_to_regions (CoglClipStack *stack,
+                           int           *x0,
+                           int           *y0,
+                           int           *x1,
+                           int           *y1)
+{
+  CoglClipStack *entry;
+
+  for (entry = stack; entry; entry = entry->parent)
+    {
+      CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
+      g_autoptr (MtkRegion) intersection = NULL;
+      MtkRectangle extents;
+
+      if (entry->type != COGL_CLIP_STACK_REGION ||
+          mtk_region_num_rectangles (region->region) <= 1)
+        continue;
+
+      intersection = intersect_region_with_bounds (region->region,
+                                                   *x0, *y0, *x1, *y1);
+      if (mtk_region_num_rectangles (intersection) > 1)
+        continue;
+
+      extents = mtk_region_get_extents (intersection);
+      *x0 = extents.x;
+      *y0 = extents.y;
+      *x1 = extents.x + extents.width;
+      *y1 = extents.y + extents.height;
+    }
+}
+
 void
 _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                            CoglFramebuffer *framebuffer)
@@ -293,6 +347,13 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                                &scissor_x0, &scissor_y0,
                                &scissor_x1, &scissor_y1);
 
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
+    {
+      tighten_bounds_to_regions (stack,
+                                 &scissor_x0, &scissor_y0,
+                                 &scissor_x1, &scissor_y1);
+    }
+
   /* Enable scissoring as soon as possible */
   if (scissor_x0 >= scissor_x1 || scissor_y0 >= scissor_y1)
     scissor_x0 = scissor_y0 = scissor_x1 = scissor_y1 = scissor_y_start = 0;
@@ -361,19 +422,58 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
         case COGL_CLIP_STACK_REGION:
             {
               CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
+              g_autoptr (MtkRegion) intersection = NULL;
+              MtkRectangle extents;
 
-              /* If nrectangles <= 1, it can be fully represented with the
-               * scissor clip.
-               */
-              if (mtk_region_num_rectangles (region->region) > 1 ||
-                  G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
+              if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
                 {
                   COGL_NOTE (CLIPPING, "Adding stencil clip for region");
 
                   add_stencil_clip_region (framebuffer, region->region,
                                            using_stencil_buffer);
                   using_stencil_buffer = TRUE;
+                  break;
                 }
+
+              /* If nrectangles <= 1, it can be fully represented with the
+               * scissor clip.
+               */
+              if (mtk_region_num_rectangles (region->region) <= 1)
+                break;
+
+              /* Only the part of the region within the scissor matters,
+               * if that is the scissor rectangle itself, there is nothing
+               * to stencil either.
+               */
+              intersection = intersect_region_with_bounds (region->region,
+                                                           scissor_x0,
+                                                           scissor_y0,
+                                                           scissor_x1,
+                                                           scissor_y1);
+              if (mtk_region_is_empty (intersection))
+                {
+                  /* The scissor is empty as well, nothing can be drawn */
+                  if (scissor_x0 >= scissor_x1 || scissor_y0 >= scissor_y1)
+                    break;
+
+                  g_clear_pointer (&intersection, mtk_region_unref);
+                  intersection = mtk_region_ref (region->region);
+                }
+              else if (mtk_region_num_rectangles (intersection) == 1)
+                {
+                  extents = mtk_region_get_extents (intersection);
+                  if (extents.x == scissor_x0 &&
+                      extents.y == scissor_y0 &&
+                      extents.x + extents.width == scissor_x1 &&
+                      extents.y + extents.height == scissor_y1)
+                    break;
+                }
+
+              COGL_NOTE (CLIPPING, "Adding stencil clip for region");
+
+              add_stencil_clip_region (framebuffer, intersection,
+                                       using_stencil_buffer);
+              using_stencil_buffer = TRUE;
               break;
             }
         }
@@ -174,7 +174,7 @@ cogl_gl_framebuffer_fbo_discard_buffers (CoglFramebufferDriver *driver,
   GLenum attachments[3];
   int i = 0;
 
-  if (!ctx->glDiscardFramebuffer)
+  if (!ctx->glInvalidateFramebuffer && !ctx->glDiscardFramebuffer)
     return;
 
   if (buffers & COGL_BUFFER_BIT_COLOR)
@@ -188,7 +188,10 @@ cogl_gl_framebuffer_fbo_discard_buffers (CoglFramebufferDriver *driver,
                                         framebuffer,
                                         framebuffer,
                                         COGL_FRAMEBUFFER_STATE_BIND);
-  GE (ctx, glDiscardFramebuffer (GL_FRAMEBUFFER, i, attachments));
+  if (ctx->glInvalidateFramebuffer)
+    GE (ctx, glInvalidateFramebuffer (GL_FRAMEBUFFER, i, attachments));
+  else
+    GE (ctx, glDiscardFramebuffer (GL_FRAMEBUFFER, i, attachments));
 }
 
 static void
@@ -39,3 +39,6 @@ extern const CoglPipelineFragend _cogl_pipeline_glsl_fragend;
 
 GLuint
 _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline);
+
+const char *
+_cogl_pipeline_fragend_glsl_get_source_hash (CoglPipeline *pipeline);
@@ -89,6 +89,12 @@ typedef struct
 
   GLuint gl_shader;
   GString *header, *source;
+
+  /* Compiling is deferred until the progend actually needs the
+   * shader, which it may not if the program comes from the program
+   * binary cache. */
+  gboolean gl_shader_compiled;
+  char *source_hash;
   UnitState *unit_state;
 
   /* List of layers that we haven't generated code for yet. These are
@@ -160,6 +166,8 @@ destroy_shader_state (void *user_data)
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
 
+      g_free (shader_state->source_hash);
+
       g_free (shader_state->unit_state);
 
       g_free (shader_state);
@@ -200,15 +208,57 @@ dirty_shader_state (CoglPipeline *pipeline)
                            NULL);
 }
 
+static void
+ensure_shader_compiled (CoglContext                    *ctx,
+                        CoglPipelineFragendShaderState *shader_state)
+{
+  GLint compile_status;
+
+  if (shader_state->gl_shader_compiled)
+    return;
+
+  GE( ctx, glCompileShader (shader_state->gl_shader) );
+  GE( ctx, glGetShaderiv (shader_state->gl_shader,
+                          GL_COMPILE_STATUS, &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader_state->gl_shader,
+                              GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader_state->gl_shader,
+                                   len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+
+  shader_state->gl_shader_compiled = TRUE;
+}
+
 GLuint
 _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineFragendShaderState *shader_state = get_shader_state (pipeline);
 
-  if (shader_state)
-    return shader_state->gl_shader;
-  else
+  if (!shader_state || !shader_state->gl_shader)
     return 0;
+
+  ensure_shader_compiled (pipeline->context, shader_state);
+
+  return shader_state->gl_shader;
+}
+
+const char *
+_cogl_pipeline_fragend_glsl_get_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineFragendShaderState *shader_state = get_shader_state (pipeline);
+
+  if (shader_state && shader_state->gl_shader)
+    return shader_state->source_hash;
+  else
+    return NULL;
 }
 
 static CoglPipelineSnippetList *
@@ -992,7 +1042,7 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
+      g_autoptr (GChecksum) source_checksum = NULL;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
 
@@ -1054,29 +1104,22 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
       lengths[1] = shader_state->source->len;
       source_strings[1] = shader_state->source->str;
 
+      source_checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
       _cogl_glsl_shader_set_source_with_boilerplate (ctx,
                                                      shader, GL_FRAGMENT_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     source_checksum);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
       shader_state->gl_shader = shader;
+      shader_state->gl_shader_compiled = FALSE;
+      g_free (shader_state->source_hash);
+      shader_state->source_hash =
+        g_strdup (g_checksum_get_string (source_checksum));
     }
 
   return TRUE;
@@ -149,6 +149,10 @@ _cogl_pipeline_flush_gl_state (CoglContext *context,
                                gboolean skip_gl_state,
                                gboolean unknown_color_alpha);
 
+gboolean
+_cogl_pipeline_gl_precompile (CoglContext  *ctx,
+                              CoglPipeline *pipeline);
+
 void
 _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                GLuint shader_gl_handle,
@@ -156,7 +160,8 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in);
+                                               const GLint *lengths_in,
+                                               GChecksum *source_checksum);
 
 void
 _cogl_sampler_gl_init (CoglContext *context,
@@ -1152,6 +1152,73 @@ done:
   COGL_TIMER_STOP (_cogl_uprof_context, pipeline_flush_timer);
 }
 
+/*
+ * _cogl_pipeline_gl_precompile:
+ *
+ * Generates the shaders for @pipeline and starts linking its program
+ * without touching any of the GL state used for drawing. Returns
+ * whether the program can be used without waiting for the driver.
+ * Linking is only asynchronous if the driver supports
+ * GL_KHR_parallel_shader_compile; otherwise this always returns %TRUE
+ * and the work is left to the next flush.
+ */
+gboolean
+_cogl_pipeline_gl_precompile (CoglContext  *ctx,
+                              CoglPipeline *pipeline)
+{
+  const CoglPipelineProgend *progend = _cogl_pipeline_progend;
+  const CoglPipelineVertend *vertend = _cogl_pipeline_vertend;
+  const CoglPipelineFragend *fragend = _cogl_pipeline_fragend;
+  CoglPipelineAddLayerState state;
+  unsigned long *layer_differences;
+  int n_layers;
+
+  if (!_cogl_has_private_feature (ctx,
+                                  COGL_PRIVATE_FEATURE_PARALLEL_SHADER_COMPILE))
+    return TRUE;
+
+  /* Legacy user programs are compiled synchronously when flushed */
+  if (cogl_pipeline_get_user_program (pipeline))
+    return TRUE;
+
+  n_layers = cogl_pipeline_get_n_layers (pipeline);
+  layer_differences = g_alloca (sizeof (unsigned long) * MAX (n_layers, 1));
+  memset (layer_differences, 0xff, sizeof (unsigned long) * MAX (n_layers, 1));
+
+  if (G_UNLIKELY (!progend->start (pipeline)))
+    return TRUE;
+
+  vertend->start (pipeline, n_layers, COGL_PIPELINE_STATE_ALL);
+
+  state.framebuffer = NULL;
+  state.vertend = vertend;
+  state.fragend = fragend;
+  state.pipeline = pipeline;
+  state.layer_differences = layer_differences;
+  state.error_adding_layer = FALSE;
+  state.added_layer = FALSE;
+
+  _cogl_pipeline_foreach_layer_internal (pipeline,
+                                         vertend_add_layer_cb,
+                                         &state);
+
+  if (G_UNLIKELY (state.error_adding_layer) ||
+      G_UNLIKELY (!vertend->end (pipeline, COGL_PIPELINE_STATE_ALL)))
+    return TRUE;
+
+  fragend->start (pipeline, n_layers, COGL_PIPELINE_STATE_ALL);
+
+  _cogl_pipeline_foreach_layer_internal (pipeline,
+                                         fragend_add_layer_cb,
+                                         &state);
+
+  if (G_UNLIKELY (state.error_adding_layer) ||
+      G_UNLIKELY (!fragend->end (pipeline, COGL_PIPELINE_STATE_ALL)))
+    return TRUE;
+
+  return _cogl_pipeline_progend_glsl_is_program_ready (pipeline);
+}
+
 void
 _cogl_gl_set_uniform (CoglContext *ctx,
                       GLint location,
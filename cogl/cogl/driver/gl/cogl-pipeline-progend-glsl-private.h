@@ -41,3 +41,6 @@ extern const CoglPipelineProgend _cogl_pipeline_glsl_progend;
 int
 _cogl_pipeline_progend_glsl_get_attrib_location (CoglPipeline *pipeline,
                                                  int name_index);
+
+gboolean
+_cogl_pipeline_progend_glsl_is_program_ready (CoglPipeline *pipeline);
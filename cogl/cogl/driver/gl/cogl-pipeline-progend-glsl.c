@@ -50,9 +50,14 @@
 #include "cogl/driver/gl/cogl-pipeline-fragend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-progend-glsl-private.h"
+#include "cogl/driver/gl/cogl-program-cache-gl-private.h"
 #include "deprecated/cogl-program-private.h"
 #include "deprecated/cogl-shader-private.h"
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 /* These are used to generalise updating some uniforms that are
    required when building for drivers missing some fixed function
    state that we use */
@@ -105,6 +110,17 @@ typedef struct
 
   GLuint program;
 
+  /* TRUE if glLinkProgram() has been called for the program but its
+   * result hasn't been checked yet. With GL_KHR_parallel_shader_compile
+   * this lets the driver link in the background. */
+  gboolean link_pending;
+  /* TRUE if the program was (re)created and the uniform and attribute
+   * locations need to be queried again before it can be used */
+  gboolean program_changed;
+  /* Program binary cache key to store the program under once it has
+   * been linked, if the cache is enabled */
+  char *program_cache_key;
+
   unsigned long dirty_builtin_uniforms;
   GLint builtin_uniform_locations[G_N_ELEMENTS (builtin_uniforms)];
 
@@ -311,6 +327,8 @@ destroy_program_state (void *user_data)
 
       g_hash_table_destroy (program_state->uniform_values);
 
+      g_free (program_state->program_cache_key);
+
       g_free (program_state);
     }
 
@@ -352,13 +370,11 @@ dirty_program_state (CoglPipeline *pipeline)
 }
 
 static void
-link_program (CoglContext *ctx,
-              GLint        gl_program)
+check_link_status (CoglContext *ctx,
+                   GLint        gl_program)
 {
   GLint link_status;
 
-  GE( ctx, glLinkProgram (gl_program) );
-
   GE( ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status) );
 
   if (!link_status)
@@ -751,6 +767,7 @@ _cogl_shader_compile_real (CoglShader   *shader,
                                                  1,
                                                  (const char **)
                                                   &shader->source,
+                                                 NULL,
                                                  NULL);
   GE (ctx, glCompileShader (shader->gl_handle));
 
@@ -774,13 +791,26 @@ _cogl_shader_compile_real (CoglShader   *shader,
 }
 
 static void
-_cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
-                                 unsigned long pipelines_difference)
+finish_link (CoglContext              *ctx,
+             CoglPipelineProgramState *program_state)
+{
+  check_link_status (ctx, program_state->program);
+
+  if (program_state->program_cache_key)
+    {
+      _cogl_program_cache_gl_save (ctx,
+                                   program_state->program_cache_key,
+                                   program_state->program);
+      g_clear_pointer (&program_state->program_cache_key, g_free);
+    }
+
+  program_state->link_pending = FALSE;
+}
+
+static CoglPipelineProgramState *
+ensure_program (CoglPipeline *pipeline)
 {
   CoglPipelineProgramState *program_state;
-  GLuint gl_program;
-  gboolean program_changed = FALSE;
-  UpdateUniformsState state;
   CoglProgram *user_program;
   CoglPipelineCacheEntry *cache_entry = NULL;
   CoglContext *ctx = pipeline->context;
@@ -846,6 +876,40 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
     {
       GE( ctx, glDeleteProgram (program_state->program) );
       program_state->program = 0;
+      program_state->link_pending = FALSE;
+      g_clear_pointer (&program_state->program_cache_key, g_free);
+    }
+
+  if (program_state->program == 0 && !user_program &&
+      _cogl_program_cache_gl_is_enabled (ctx))
+    {
+      const char *vertex_hash =
+        _cogl_pipeline_vertend_glsl_get_source_hash (pipeline);
+      const char *fragment_hash =
+        _cogl_pipeline_fragend_glsl_get_source_hash (pipeline);
+
+      if (vertex_hash && fragment_hash)
+        {
+          g_autofree char *program_cache_key = NULL;
+
+          program_cache_key = _cogl_program_cache_gl_get_key (ctx,
+                                                              vertex_hash,
+                                                              fragment_hash);
+
+          GE_RET( program_state->program, ctx, glCreateProgram () );
+
+          if (_cogl_program_cache_gl_load (ctx,
+                                           program_cache_key,
+                                           program_state->program))
+            program_state->program_changed = TRUE;
+          else
+            {
+              GE( ctx, glDeleteProgram (program_state->program) );
+              program_state->program = 0;
+              program_state->program_cache_key =
+                g_steal_pointer (&program_cache_key);
+            }
+        }
     }
 
   if (program_state->program == 0)
@@ -884,11 +948,61 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE( ctx, glBindAttribLocation (program_state->program,
                                      0, "cogl_position_in"));
 
-      link_program (ctx, program_state->program);
+      /* The link status is only checked in finish_link() so that the
+       * driver can link in parallel if it supports it */
+      GE( ctx, glLinkProgram (program_state->program) );
+      program_state->link_pending = TRUE;
 
-      program_changed = TRUE;
+      program_state->program_changed = TRUE;
     }
 
+  return program_state;
+}
+
+gboolean
+_cogl_pipeline_progend_glsl_is_program_ready (CoglPipeline *pipeline)
+{
+  CoglContext *ctx = pipeline->context;
+  CoglPipelineProgramState *program_state;
+  GLint completion_status = GL_FALSE;
+
+  program_state = ensure_program (pipeline);
+
+  if (!program_state->link_pending)
+    return TRUE;
+
+  GE( ctx, glGetProgramiv (program_state->program,
+                           GL_COMPLETION_STATUS_KHR,
+                           &completion_status) );
+  if (!completion_status)
+    return FALSE;
+
+  finish_link (ctx, program_state);
+
+  return TRUE;
+}
+
+static void
+_cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
+                                 unsigned long pipelines_difference)
+{
+  CoglPipelineProgramState *program_state;
+  GLuint gl_program;
+  gboolean program_changed;
+  UpdateUniformsState state;
+  CoglProgram *user_program;
+  CoglContext *ctx = pipeline->context;
+
+  user_program = cogl_pipeline_get_user_program (pipeline);
+
+  program_state = ensure_program (pipeline);
+
+  if (program_state->link_pending)
+    finish_link (ctx, program_state);
+
+  program_changed = program_state->program_changed;
+  program_state->program_changed = FALSE;
+
   gl_program = program_state->program;
 
   if (ctx->current_gl_program != gl_program)
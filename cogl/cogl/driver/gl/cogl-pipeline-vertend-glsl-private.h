@@ -42,5 +42,8 @@ extern const CoglPipelineVertend _cogl_pipeline_glsl_vertend;
 GLuint
 _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline);
 
+const char *
+_cogl_pipeline_vertend_glsl_get_source_hash (CoglPipeline *pipeline);
+
 COGL_EXPORT_TEST
 CoglPipelineVertendShaderState * cogl_pipeline_vertend_glsl_get_shader_state (CoglPipeline *pipeline);
@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2024 Red Hat
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "cogl/cogl-debug.h"
+#include "cogl/cogl-private.h"
+#include "cogl/driver/gl/cogl-util-gl-private.h"
+#include "cogl/driver/gl/cogl-program-cache-gl-private.h"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#ifndef GL_SHADER_SOURCE_LENGTH
+#define GL_SHADER_SOURCE_LENGTH 0x8B88
+#endif
+
+#define PROGRAM_CACHE_MAGIC 0x42504743 /* "CGPB" */
+#define PROGRAM_SOURCES_MAGIC 0x53504743 /* "CGPS" */
+
+#define PROGRAM_SOURCES_DIR "sources"
+
+/* Cache files are a small header followed by the blob returned by
+ * glGetProgramBinary(). They are only ever read back by the same
+ * driver build, so the header is stored in native byte order. */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t binary_format;
+} ProgramCacheHeader;
+
+/* Next to the binaries, the full sources of every program are kept in a
+ * driver independent file: a magic number followed by the NUL terminated
+ * vertex and fragment shader sources. They are what lets the binaries be
+ * recreated ahead of time when the driver changes. */
+typedef struct
+{
+  uint32_t magic;
+} ProgramSourcesHeader;
+
+gboolean
+_cogl_program_cache_gl_is_enabled (CoglContext *ctx)
+{
+  return (ctx->program_cache_dir &&
+          _cogl_has_private_feature (ctx,
+                                     COGL_PRIVATE_FEATURE_PROGRAM_BINARY) &&
+          !COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES));
+}
+
+static const char *
+get_driver_id (CoglContext *ctx)
+{
+  if (!ctx->program_cache_driver_id)
+    {
+      const char *vendor, *renderer, *version;
+
+      vendor = (const char *) ctx->glGetString (GL_VENDOR);
+      renderer = (const char *) ctx->glGetString (GL_RENDERER);
+      version = (const char *) ctx->glGetString (GL_VERSION);
+
+      ctx->program_cache_driver_id =
+        g_strdup_printf ("%s\n%s\n%s\n%s",
+                         VERSION,
+                         vendor ? vendor : "",
+                         renderer ? renderer : "",
+                         version ? version : "");
+    }
+
+  return ctx->program_cache_driver_id;
+}
+
+char *
+_cogl_program_cache_gl_get_key (CoglContext *ctx,
+                                const char  *vertex_source_hash,
+                                const char  *fragment_source_hash)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) get_driver_id (ctx), -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+  g_checksum_update (checksum, (const guchar *) vertex_source_hash, -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+  g_checksum_update (checksum, (const guchar *) fragment_source_hash, -1);
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+gboolean
+_cogl_program_cache_gl_load (CoglContext *ctx,
+                             const char  *key,
+                             GLuint       gl_program)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  ProgramCacheHeader header;
+  gsize length;
+  GLint link_status = GL_FALSE;
+
+  path = g_build_filename (ctx->program_cache_dir, key, NULL);
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (length <= sizeof (header))
+    return FALSE;
+
+  memcpy (&header, contents, sizeof (header));
+  if (header.magic != PROGRAM_CACHE_MAGIC)
+    return FALSE;
+
+  /* The driver is allowed to reject any binary, e.g. after an update
+   * that kept the version string, so errors here are not fatal. */
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glProgramBinary (gl_program,
+                        header.binary_format,
+                        contents + sizeof (header),
+                        length - sizeof (header));
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR)
+    return FALSE;
+
+  GE (ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status));
+
+  if (!link_status)
+    {
+      g_debug ("Discarding stale program binary %s", path);
+      g_unlink (path);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static char *
+get_sources_key (const char *vertex_source,
+                 const char *fragment_source)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) vertex_source, -1);
+  g_checksum_update (checksum, (const guchar *) "\0", 1);
+  g_checksum_update (checksum, (const guchar *) fragment_source, -1);
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+static char *
+get_shader_source (CoglContext *ctx,
+                   GLuint       gl_shader)
+{
+  GLint source_length = 0;
+  char *source;
+
+  GE (ctx, glGetShaderiv (gl_shader, GL_SHADER_SOURCE_LENGTH, &source_length));
+  if (source_length <= 0)
+    return NULL;
+
+  source = g_malloc (source_length);
+  GE (ctx, glGetShaderSource (gl_shader, source_length, NULL, source));
+  source[source_length - 1] = '\0';
+
+  return source;
+}
+
+static void
+save_sources (CoglContext *ctx,
+              GLuint       gl_program)
+{
+  g_autofree char *vertex_source = NULL;
+  g_autofree char *fragment_source = NULL;
+  g_autofree char *sources_dir = NULL;
+  g_autofree char *sources_key = NULL;
+  g_autofree char *path = NULL;
+  g_autoptr (GString) contents = NULL;
+  g_autoptr (GError) error = NULL;
+  ProgramSourcesHeader header;
+  GLuint gl_shaders[2];
+  GLsizei n_shaders = 0;
+  int i;
+
+  GE (ctx, glGetAttachedShaders (gl_program, G_N_ELEMENTS (gl_shaders),
+                                 &n_shaders, gl_shaders));
+
+  for (i = 0; i < n_shaders; i++)
+    {
+      GLint shader_type = 0;
+
+      GE (ctx, glGetShaderiv (gl_shaders[i], GL_SHADER_TYPE, &shader_type));
+
+      if (shader_type == GL_VERTEX_SHADER)
+        vertex_source = get_shader_source (ctx, gl_shaders[i]);
+      else if (shader_type == GL_FRAGMENT_SHADER)
+        fragment_source = get_shader_source (ctx, gl_shaders[i]);
+    }
+
+  if (!vertex_source || !fragment_source)
+    return;
+
+  sources_dir = g_build_filename (ctx->program_cache_dir,
+                                  PROGRAM_SOURCES_DIR,
+                                  NULL);
+  sources_key = get_sources_key (vertex_source, fragment_source);
+  path = g_build_filename (sources_dir, sources_key, NULL);
+
+  if (g_file_test (path, G_FILE_TEST_EXISTS))
+    return;
+
+  if (g_mkdir_with_parents (sources_dir, 0700) != 0)
+    return;
+
+  header.magic = PROGRAM_SOURCES_MAGIC;
+
+  contents = g_string_new_len ((const char *) &header, sizeof (header));
+  g_string_append_len (contents, vertex_source, strlen (vertex_source) + 1);
+  g_string_append_len (contents, fragment_source, strlen (fragment_source) + 1);
+
+  if (!g_file_set_contents_full (path,
+                                 contents->str, contents->len,
+                                 G_FILE_SET_CONTENTS_CONSISTENT,
+                                 0600,
+                                 &error))
+    g_debug ("Failed to store program sources: %s", error->message);
+}
+
+void
+_cogl_program_cache_gl_save (CoglContext *ctx,
+                             const char  *key,
+                             GLuint       gl_program)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  g_autoptr (GError) error = NULL;
+  ProgramCacheHeader header;
+  GLint link_status = GL_FALSE;
+  GLint binary_length = 0;
+  GLsizei length = 0;
+  GLenum binary_format = 0;
+
+  GE (ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status));
+  if (!link_status)
+    return;
+
+  GE (ctx, glGetProgramiv (gl_program, GL_PROGRAM_BINARY_LENGTH,
+                           &binary_length));
+  if (binary_length <= 0)
+    return;
+
+  contents = g_malloc (sizeof (header) + binary_length);
+
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glGetProgramBinary (gl_program,
+                           binary_length,
+                           &length,
+                           &binary_format,
+                           contents + sizeof (header));
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR || length <= 0)
+    return;
+
+  header.magic = PROGRAM_CACHE_MAGIC;
+  header.binary_format = binary_format;
+  memcpy (contents, &header, sizeof (header));
+
+  if (g_mkdir_with_parents (ctx->program_cache_dir, 0700) != 0)
+    {
+      g_warning ("Failed to create program cache directory %s: %s",
+                 ctx->program_cache_dir, g_strerror (errno));
+      g_clear_pointer (&ctx->program_cache_dir, g_free);
+      return;
+    }
+
+  path = g_build_filename (ctx->program_cache_dir, key, NULL);
+
+  if (!g_file_set_contents_full (path,
+                                 contents, sizeof (header) + length,
+                                 G_FILE_SET_CONTENTS_CONSISTENT,
+                                 0600,
+                                 &error))
+    {
+      g_debug ("Failed to store program binary: %s", error->message);
+      return;
+    }
+
+  save_sources (ctx, gl_program);
+}
+
+static GLuint
+compile_shader (CoglContext *ctx,
+                GLenum       shader_type,
+                const char  *source)
+{
+  GLuint gl_shader;
+  GLint compile_status = GL_FALSE;
+
+  GE_RET (gl_shader, ctx, glCreateShader (shader_type));
+  GE (ctx, glShaderSource (gl_shader, 1, &source, NULL));
+  GE (ctx, glCompileShader (gl_shader));
+  GE (ctx, glGetShaderiv (gl_shader, GL_COMPILE_STATUS, &compile_status));
+
+  if (!compile_status)
+    {
+      GE (ctx, glDeleteShader (gl_shader));
+      return 0;
+    }
+
+  return gl_shader;
+}
+
+/* Returns TRUE if a program was compiled, i.e. the time slice is used up */
+static gboolean
+warm_program (CoglContext *ctx,
+              const char  *sources_key)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  g_autofree char *vertex_hash = NULL;
+  g_autofree char *fragment_hash = NULL;
+  g_autofree char *key = NULL;
+  g_autofree char *binary_path = NULL;
+  ProgramSourcesHeader header;
+  const char *vertex_source;
+  const char *vertex_source_end;
+  const char *fragment_source;
+  GLuint gl_vertex_shader;
+  GLuint gl_fragment_shader;
+  GLuint gl_program;
+  gsize length;
+
+  path = g_build_filename (ctx->program_cache_dir,
+                           PROGRAM_SOURCES_DIR,
+                           sources_key,
+                           NULL);
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (length <= sizeof (header) || contents[length - 1] != '\0')
+    goto invalid;
+
+  memcpy (&header, contents, sizeof (header));
+  if (header.magic != PROGRAM_SOURCES_MAGIC)
+    goto invalid;
+
+  vertex_source = contents + sizeof (header);
+  vertex_source_end = memchr (vertex_source, '\0',
+                              length - sizeof (header) - 1);
+  if (!vertex_source_end)
+    goto invalid;
+
+  fragment_source = vertex_source_end + 1;
+
+  vertex_hash = g_compute_checksum_for_string (G_CHECKSUM_SHA256,
+                                               vertex_source, -1);
+  fragment_hash = g_compute_checksum_for_string (G_CHECKSUM_SHA256,
+                                                 fragment_source, -1);
+  key = _cogl_program_cache_gl_get_key (ctx, vertex_hash, fragment_hash);
+  binary_path = g_build_filename (ctx->program_cache_dir, key, NULL);
+
+  if (g_file_test (binary_path, G_FILE_TEST_EXISTS))
+    return FALSE;
+
+  gl_vertex_shader = compile_shader (ctx, GL_VERTEX_SHADER, vertex_source);
+  gl_fragment_shader = compile_shader (ctx, GL_FRAGMENT_SHADER,
+                                       fragment_source);
+
+  if (gl_vertex_shader && gl_fragment_shader)
+    {
+      GE_RET (gl_program, ctx, glCreateProgram ());
+      GE (ctx, glAttachShader (gl_program, gl_vertex_shader));
+      GE (ctx, glAttachShader (gl_program, gl_fragment_shader));
+      GE (ctx, glBindAttribLocation (gl_program, 0, "cogl_position_in"));
+      GE (ctx, glLinkProgram (gl_program));
+
+      _cogl_program_cache_gl_save (ctx, key, gl_program);
+
+      GE (ctx, glDeleteProgram (gl_program));
+    }
+  else
+    {
+      /* The sources no longer build, e.g. because the GLSL version
+       * changed, so the programs will look different from now on. */
+      g_debug ("Discarding program sources %s that failed to compile", path);
+      g_unlink (path);
+    }
+
+  if (gl_vertex_shader)
+    GE (ctx, glDeleteShader (gl_vertex_shader));
+  if (gl_fragment_shader)
+    GE (ctx, glDeleteShader (gl_fragment_shader));
+
+  return TRUE;
+
+invalid:
+  g_unlink (path);
+  return FALSE;
+}
+
+gboolean
+_cogl_program_cache_gl_warm (CoglContext *ctx)
+{
+  GPtrArray *queue;
+
+  if (!ctx->program_cache_warm_queue)
+    {
+      g_autofree char *sources_dir = NULL;
+      GDir *dir;
+
+      queue = g_ptr_array_new_with_free_func (g_free);
+      ctx->program_cache_warm_queue = queue;
+
+      sources_dir = g_build_filename (ctx->program_cache_dir,
+                                      PROGRAM_SOURCES_DIR,
+                                      NULL);
+      dir = g_dir_open (sources_dir, 0, NULL);
+      if (dir)
+        {
+          const char *name;
+
+          while ((name = g_dir_read_name (dir)))
+            g_ptr_array_add (queue, g_strdup (name));
+
+          g_dir_close (dir);
+        }
+    }
+
+  queue = ctx->program_cache_warm_queue;
+
+  while (queue->len > 0)
+    {
+      g_autofree char *sources_key = NULL;
+
+      sources_key = g_ptr_array_steal_index_fast (queue, queue->len - 1);
+      if (warm_program (ctx, sources_key))
+        break;
+    }
+
+  return queue->len > 0;
+}
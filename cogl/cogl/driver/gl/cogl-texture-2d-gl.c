@@ -39,6 +39,7 @@
 #include "cogl/cogl-private.h"
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-texture-2d-private.h"
+#include "cogl/cogl-trace.h"
 #include "cogl/driver/gl/cogl-texture-2d-gl-private.h"
 #include "cogl/driver/gl/cogl-texture-gl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-opengl-private.h"
@@ -187,6 +188,17 @@ allocate_with_size (CoglTexture2D *tex_2d,
   return TRUE;
 }
 
+static void
+count_uploaded_bytes (CoglPixelFormat format,
+                      int             width,
+                      int             height)
+{
+  COGL_PERF_COUNTER_ADD (TextureBytesUploaded, "TextureBytesUploaded",
+                         "bytes of pixel data uploaded to textures",
+                         (int64_t) width * height *
+                         cogl_pixel_format_get_bytes_per_pixel (format, 0));
+}
+
 static gboolean
 allocate_from_bitmap (CoglTexture2D *tex_2d,
                       CoglTextureLoader *loader,
@@ -250,6 +262,8 @@ allocate_from_bitmap (CoglTexture2D *tex_2d,
       return FALSE;
     }
 
+  count_uploaded_bytes (cogl_bitmap_get_format (upload_bmp), width, height);
+
   tex_2d->gl_internal_format = gl_intformat;
 
   g_object_unref (upload_bmp);
@@ -553,6 +567,117 @@ _cogl_texture_2d_gl_generate_mipmap (CoglTexture2D *tex_2d)
   _cogl_texture_gl_generate_mipmaps (COGL_TEXTURE (tex_2d));
 }
 
+/* Uploads smaller than this aren't worth the extra map and unmap, and
+ * larger ones would keep too much memory around in the staging ring */
+#define MIN_STAGED_UPLOAD_SIZE_BYTES (16 * 1024)
+#define MAX_STAGED_UPLOAD_SIZE_BYTES (16 * 1024 * 1024)
+
+static CoglPixelBuffer *
+get_upload_staging_buffer (CoglContext *ctx,
+                           size_t       size)
+{
+  CoglPixelBuffer **slot;
+
+  slot = &ctx->upload_staging_buffers[ctx->next_upload_staging_buffer];
+  ctx->next_upload_staging_buffer = ((ctx->next_upload_staging_buffer + 1) %
+                                     COGL_UPLOAD_STAGING_RING_SIZE);
+
+  if (*slot && cogl_buffer_get_size (COGL_BUFFER (*slot)) < size)
+    g_clear_object (slot);
+
+  if (!*slot)
+    {
+      size_t buffer_size = MIN_STAGED_UPLOAD_SIZE_BYTES;
+
+      while (buffer_size < size)
+        buffer_size *= 2;
+
+      *slot = cogl_pixel_buffer_new (ctx, buffer_size, NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (*slot),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+    }
+
+  return *slot;
+}
+
+/* Copies the uploaded region of @bmp into a pixel unpack buffer, so that the
+ * texture upload can be sourced from GPU visible memory instead of making the
+ * driver copy out of client memory, potentially synchronously. Returns %NULL
+ * when the upload should just go straight from @bmp.
+ */
+static CoglBitmap *
+stage_bitmap_for_upload (CoglContext *ctx,
+                         CoglBitmap  *bmp,
+                         int          src_x,
+                         int          src_y,
+                         int          width,
+                         int          height)
+{
+  CoglPixelFormat format = cogl_bitmap_get_format (bmp);
+  CoglPixelBuffer *staging_buffer;
+  CoglBitmap *staged_bmp;
+  g_autoptr (GError) error = NULL;
+  const uint8_t *src;
+  uint8_t *dst;
+  int src_rowstride;
+  int rowstride;
+  size_t size;
+  int bpp;
+  int y;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PBOS))
+    return NULL;
+
+  /* Already sourced from a buffer object */
+  if (cogl_bitmap_get_buffer (bmp))
+    return NULL;
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+  rowstride = (width * bpp + 3) & ~3;
+  size = (size_t) rowstride * height;
+
+  if (size < MIN_STAGED_UPLOAD_SIZE_BYTES ||
+      size > MAX_STAGED_UPLOAD_SIZE_BYTES)
+    return NULL;
+
+  staging_buffer = get_upload_staging_buffer (ctx, size);
+
+  /* Discarding the previous contents lets the driver hand out fresh
+   * storage if an earlier upload from this slot is still in flight,
+   * rather than stalling until the GPU has consumed it. */
+  dst = cogl_buffer_map_range (COGL_BUFFER (staging_buffer),
+                               0, size,
+                               COGL_BUFFER_ACCESS_WRITE,
+                               COGL_BUFFER_MAP_HINT_DISCARD,
+                               &error);
+  if (!dst)
+    return NULL;
+
+  src = _cogl_bitmap_map (bmp, COGL_BUFFER_ACCESS_READ, 0, &error);
+  if (!src)
+    {
+      cogl_buffer_unmap (COGL_BUFFER (staging_buffer));
+      return NULL;
+    }
+
+  src_rowstride = cogl_bitmap_get_rowstride (bmp);
+  src += src_y * src_rowstride + src_x * bpp;
+
+  for (y = 0; y < height; y++)
+    memcpy (dst + y * rowstride, src + y * src_rowstride, width * bpp);
+
+  _cogl_bitmap_unmap (bmp);
+  cogl_buffer_unmap (COGL_BUFFER (staging_buffer));
+
+  staged_bmp = cogl_bitmap_new_from_buffer (COGL_BUFFER (staging_buffer),
+                                            format,
+                                            width, height,
+                                            rowstride,
+                                            0 /* offset */);
+
+  return staged_bmp;
+}
+
 gboolean
 _cogl_texture_2d_gl_copy_from_bitmap (CoglTexture2D *tex_2d,
                                       int src_x,
@@ -568,6 +693,7 @@ _cogl_texture_2d_gl_copy_from_bitmap (CoglTexture2D *tex_2d,
   CoglTexture *tex = COGL_TEXTURE (tex_2d);
   CoglContext *ctx = cogl_texture_get_context (tex);
   CoglBitmap *upload_bmp;
+  CoglBitmap *staged_bmp;
   CoglPixelFormat upload_format;
   GLenum gl_format;
   GLenum gl_type;
@@ -596,6 +722,16 @@ _cogl_texture_2d_gl_copy_from_bitmap (CoglTexture2D *tex_2d,
   if (cogl_texture_get_max_level_set (tex) < level)
     cogl_texture_gl_set_max_level (tex, level);
 
+  staged_bmp = stage_bitmap_for_upload (ctx, upload_bmp,
+                                        src_x, src_y,
+                                        width, height);
+  if (staged_bmp)
+    {
+      g_object_unref (upload_bmp);
+      upload_bmp = staged_bmp;
+      src_x = src_y = 0;
+    }
+
   status = ctx->texture_driver->upload_subregion_to_gl (ctx,
                                                         tex,
                                                         src_x, src_y,
@@ -606,6 +742,8 @@ _cogl_texture_2d_gl_copy_from_bitmap (CoglTexture2D *tex_2d,
                                                         gl_format,
                                                         gl_type,
                                                         error);
+  if (status)
+    count_uploaded_bytes (upload_format, width, height);
 
   g_object_unref (upload_bmp);
 
@@ -44,6 +44,10 @@
 #include "cogl/driver/gl/cogl-buffer-gl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-opengl-private.h"
 
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 static gboolean
 _cogl_driver_gl_real_context_init (CoglContext *context)
 {
@@ -528,6 +532,7 @@ _cogl_driver_update_features (CoglContext  *ctx,
   COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_BLIT_FRAMEBUFFER, TRUE);
 
   COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_PBOS, TRUE);
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD, TRUE);
 
   COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_MAP_BUFFER_FOR_READ, TRUE);
   COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE, TRUE);
@@ -543,6 +548,20 @@ _cogl_driver_update_features (CoglContext  *ctx,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (ctx->glGetProgramBinary)
+    {
+      GLint n_formats = 0;
+
+      GE (ctx, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+      if (n_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
+  if (ctx->glMaxShaderCompilerThreads)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_PARALLEL_SHADER_COMPILE, TRUE);
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 3) ||
       _cogl_check_extension ("GL_ARB_texture_swizzle", gl_extensions) ||
       _cogl_check_extension ("GL_EXT_texture_swizzle", gl_extensions))
@@ -44,6 +44,9 @@
 #include "cogl/driver/gl/cogl-buffer-gl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-opengl-private.h"
 
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
 #ifndef GL_UNSIGNED_INT_24_8
 #define GL_UNSIGNED_INT_24_8 0x84FA
 #endif
@@ -751,6 +754,20 @@ _cogl_driver_update_features (CoglContext  *context,
   if (context->glGenSamplers)
     COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (context->glGetProgramBinary)
+    {
+      GLint n_formats = 0;
+
+      GE (context, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+      if (n_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
+  if (context->glMaxShaderCompilerThreads)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_PARALLEL_SHADER_COMPILE, TRUE);
+
   if (context->glBlitFramebuffer)
     COGL_FLAGS_SET (context->features,
                     COGL_FEATURE_ID_BLIT_FRAMEBUFFER, TRUE);
@@ -778,6 +795,15 @@ _cogl_driver_update_features (CoglContext  *context,
                      COGL_FEATURE_ID_MAP_BUFFER_FOR_READ, TRUE);
     }
 
+  /* Pixel unpack buffers are core in ES3 */
+  if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) &&
+      context->glMapBufferRange)
+    {
+      COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_PBOS, TRUE);
+      COGL_FLAGS_SET (context->features,
+                      COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD, TRUE);
+    }
+
   if (context->glEGLImageTargetTexture2D)
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE, TRUE);
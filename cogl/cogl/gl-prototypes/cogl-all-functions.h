@@ -142,6 +142,19 @@ COGL_EXT_FUNCTION (void, glDiscardFramebuffer,
                     const GLenum    *attachments))
 COGL_EXT_END ()
 
+/* Unlike glDiscardFramebuffer this is core since GL 4.3 and GLES 3.0,
+ * so tilers that don't expose the EXT extension can still skip
+ * storing attachments nobody is going to read back */
+COGL_EXT_BEGIN (invalidate_subdata, 4, 3,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "invalidate_subdata\0")
+COGL_EXT_FUNCTION (void, glInvalidateFramebuffer,
+                   (GLenum           target,
+                    GLsizei          numAttachments,
+                    const GLenum    *attachments))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (IMG_multisampled_render_to_texture, 255, 255,
                 0, /* not in either GLES */
                 "\0",
@@ -184,6 +197,31 @@ COGL_EXT_FUNCTION (void, glSamplerParameterf,
                     GLfloat param))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program,
+                    GLsizei buf_size,
+                    GLsizei *length,
+                    GLenum *binary_format,
+                    void *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program,
+                    GLenum binary_format,
+                    const void *binary,
+                    GLsizei length))
+COGL_EXT_END ()
+
+COGL_EXT_BEGIN (parallel_shader_compile, 255, 255,
+                0,
+                "KHR\0ARB\0",
+                "parallel_shader_compile\0")
+COGL_EXT_FUNCTION (void, glMaxShaderCompilerThreads,
+                   (GLuint count))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (only_gl3, 3, 0,
                 COGL_EXT_IN_GLES3,
                 "\0",
@@ -246,7 +284,7 @@ COGL_EXT_END ()
 
 COGL_EXT_BEGIN (robustness, 255, 255,
                 0,
-                "ARB\0",
+                "ARB\0EXT\0KHR\0",
                 "robustness\0")
 COGL_EXT_FUNCTION (GLenum, glGetGraphicsResetStatus,
                    (void))
@@ -93,6 +93,16 @@ COGL_EXT_FUNCTION (void, glGetProgramiv,
                    (GLuint                program,
                     GLenum                pname,
                     GLint                *params))
+COGL_EXT_FUNCTION (void, glGetAttachedShaders,
+                   (GLuint                program,
+                    GLsizei               maxCount,
+                    GLsizei              *count,
+                    GLuint               *shaders))
+COGL_EXT_FUNCTION (void, glGetShaderSource,
+                   (GLuint                shader,
+                    GLsizei               bufSize,
+                    GLsizei              *length,
+                    char                 *source))
 COGL_EXT_END ()
 
 /* These functions are provided by GL_ARB_shader_objects or are in GL
@@ -43,6 +43,7 @@
 #include "cogl/cogl-texture-private.h"
 #include "cogl/winsys/cogl-texture-pixmap-x11.h"
 #include "mtk/mtk-rectangle.h"
+#include "mtk/mtk-region.h"
 
 /* For stereo, there are a pair of textures, but we want to share most
  * other state (the GLXPixmap, visual, etc.) The way we do this is that
@@ -79,6 +80,9 @@ struct _CoglTexturePixmapX11
   CoglTexturePixmapX11ReportLevel damage_report_level;
   gboolean damage_owned;
   MtkRectangle damage_rect;
+  /* The individual damaged rectangles within damage_rect, or NULL if
+     there were too many of them to be worth tracking */
+  MtkRegion *damage_region;
 
   void *winsys;
 
@@ -74,6 +74,48 @@ _cogl_texture_pixmap_x11_get_winsys (CoglTexturePixmapX11 *tex_pixmap)
   return ctx->display->renderer->winsys_vtable;
 }
 
+/* Fetching damaged rectangles separately costs a round trip each, so
+   only do it for a few rectangles, and only if it saves at least about
+   this many pixels per rectangle compared to fetching the bounding box */
+#define MAX_UPDATE_RECTS 16
+#define UPDATE_RECT_COST_PIXELS (64 * 64)
+
+static void
+add_damage (CoglTexturePixmapX11 *tex_pixmap,
+            const MtkRectangle   *rect)
+{
+  if (rect->width <= 0 || rect->height <= 0)
+    return;
+
+  if (tex_pixmap->damage_rect.width == 0 ||
+      tex_pixmap->damage_rect.height == 0)
+    {
+      tex_pixmap->damage_rect = *rect;
+      g_clear_pointer (&tex_pixmap->damage_region, mtk_region_unref);
+      tex_pixmap->damage_region = mtk_region_create_rectangle (rect);
+      return;
+    }
+
+  mtk_rectangle_union (&tex_pixmap->damage_rect,
+                       rect,
+                       &tex_pixmap->damage_rect);
+
+  if (tex_pixmap->damage_region)
+    {
+      mtk_region_union_rectangle (tex_pixmap->damage_region, rect);
+      if (mtk_region_num_rectangles (tex_pixmap->damage_region) >
+          MAX_UPDATE_RECTS)
+        g_clear_pointer (&tex_pixmap->damage_region, mtk_region_unref);
+    }
+}
+
+static void
+clear_damage (CoglTexturePixmapX11 *tex_pixmap)
+{
+  memset (&tex_pixmap->damage_rect, 0, sizeof (MtkRectangle));
+  g_clear_pointer (&tex_pixmap->damage_region, mtk_region_unref);
+}
+
 static int
 _cogl_xlib_get_damage_base (CoglContext *ctx)
 {
@@ -95,6 +137,7 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
   const CoglWinsysVtable *winsys;
   CoglContext *ctx;
   MtkRectangle damage_rect;
+  int i;
 
   ctx = cogl_texture_get_context (COGL_TEXTURE (tex_pixmap));
   display = cogl_xlib_renderer_get_display (ctx->display->renderer);
@@ -156,13 +199,19 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
                                              parts,
                                              &r_count,
                                              &r_bounds);
-      damage_rect = MTK_RECTANGLE_INIT (r_bounds.x, r_bounds.y,
-                                        r_bounds.width, r_bounds.height);
-      mtk_rectangle_union (&tex_pixmap->damage_rect,
-                           &damage_rect,
-                           &tex_pixmap->damage_rect);
       if (r_damage)
-        XFree (r_damage);
+        {
+          for (i = 0; i < r_count; i++)
+            {
+              damage_rect = MTK_RECTANGLE_INIT (r_damage[i].x,
+                                                r_damage[i].y,
+                                                r_damage[i].width,
+                                                r_damage[i].height);
+              add_damage (tex_pixmap, &damage_rect);
+            }
+
+          XFree (r_damage);
+        }
 
       XFixesDestroyRegion (display, parts);
     }
@@ -177,9 +226,7 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
                                         damage_event->area.y,
                                         damage_event->area.width,
                                         damage_event->area.height);
-      mtk_rectangle_union (&tex_pixmap->damage_rect,
-                           &damage_rect,
-                           &tex_pixmap->damage_rect);
+      add_damage (tex_pixmap, &damage_rect);
     }
 
   if (tex_pixmap->winsys)
@@ -261,6 +308,7 @@ cogl_texture_pixmap_x11_dispose (GObject *object)
   display = cogl_xlib_renderer_get_display (ctx->display->renderer);
 
   set_damage_object_internal (ctx, tex_pixmap, 0, 0);
+  clear_damage (tex_pixmap);
 
   if (tex_pixmap->image)
     XDestroyImage (tex_pixmap->image);
@@ -542,7 +590,8 @@ _cogl_util_pixel_format_from_masks (unsigned long r_mask,
 }
 
 static void
-_cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
+update_image_texture_rect (CoglTexturePixmapX11 *tex_pixmap,
+                           const MtkRectangle   *rect)
 {
   CoglTexture *tex = COGL_TEXTURE (tex_pixmap);
   Display *display;
@@ -560,40 +609,13 @@ _cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
   display = cogl_xlib_renderer_get_display (ctx->display->renderer);
   visual = tex_pixmap->visual;
 
-  /* If the damage region is empty then there's nothing to do */
-  if (tex_pixmap->damage_rect.x == tex_pixmap->damage_rect.width)
-    return;
-
-  x = tex_pixmap->damage_rect.x;
-  y = tex_pixmap->damage_rect.y;
-  width = tex_pixmap->damage_rect.width;
-  height = tex_pixmap->damage_rect.height;
-
-  /* We lazily create the texture the first time it is needed in case
-     this texture can be entirely handled using the GLX texture
-     instead */
-  if (tex_pixmap->tex == NULL)
-    {
-      CoglPixelFormat texture_format;
-
-      texture_format = (tex_pixmap->depth >= 32
-                        ? COGL_PIXEL_FORMAT_RGBA_8888_PRE
-                        : COGL_PIXEL_FORMAT_RGB_888);
-
-      tex_pixmap->tex = create_fallback_texture (ctx,
-                                                 cogl_texture_get_width (tex),
-                                                 cogl_texture_get_height (tex),
-                                                 texture_format);
-    }
+  x = rect->x;
+  y = rect->y;
+  width = rect->width;
+  height = rect->height;
 
   if (tex_pixmap->image == NULL)
     {
-      /* If we also haven't got a shm segment then this must be the
-         first time we've tried to update, so lets try allocating shm
-         first */
-      if (tex_pixmap->shm_info.shmid == -1)
-        try_alloc_shm (tex_pixmap);
-
       if (tex_pixmap->shm_info.shmid == -1)
         {
           COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using XGetImage", tex_pixmap);
@@ -679,8 +701,96 @@ _cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
      temporary one with no data allocated so we can just XFree it */
   if (tex_pixmap->shm_info.shmid != -1)
     XFree (image);
+}
 
-  memset (&tex_pixmap->damage_rect, 0, sizeof (MtkRectangle));
+static gboolean
+should_update_rects_separately (CoglTexturePixmapX11 *tex_pixmap)
+{
+  int n_rects;
+  int64_t rects_area = 0;
+  int i;
+
+  if (!tex_pixmap->damage_region)
+    return FALSE;
+
+  n_rects = mtk_region_num_rectangles (tex_pixmap->damage_region);
+  if (n_rects <= 1)
+    return FALSE;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (tex_pixmap->damage_region, i);
+      rects_area += mtk_rectangle_area (&rect) + UPDATE_RECT_COST_PIXELS;
+    }
+
+  return rects_area < mtk_rectangle_area (&tex_pixmap->damage_rect);
+}
+
+static void
+_cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
+{
+  CoglTexture *tex = COGL_TEXTURE (tex_pixmap);
+  CoglContext *ctx;
+
+  ctx = cogl_texture_get_context (COGL_TEXTURE (tex_pixmap));
+
+  /* If the damage region is empty then there's nothing to do */
+  if (tex_pixmap->damage_rect.width == 0 ||
+      tex_pixmap->damage_rect.height == 0)
+    return;
+
+  /* We lazily create the texture the first time it is needed in case
+     this texture can be entirely handled using the GLX texture
+     instead */
+  if (tex_pixmap->tex == NULL)
+    {
+      CoglPixelFormat texture_format;
+
+      texture_format = (tex_pixmap->depth >= 32
+                        ? COGL_PIXEL_FORMAT_RGBA_8888_PRE
+                        : COGL_PIXEL_FORMAT_RGB_888);
+
+      tex_pixmap->tex = create_fallback_texture (ctx,
+                                                 cogl_texture_get_width (tex),
+                                                 cogl_texture_get_height (tex),
+                                                 texture_format);
+    }
+
+  /* If we haven't got an image nor a shm segment then this must be the
+     first time we've tried to update, so lets try allocating shm
+     first */
+  if (tex_pixmap->image == NULL && tex_pixmap->shm_info.shmid == -1)
+    try_alloc_shm (tex_pixmap);
+
+  /* A few small rectangles far apart, e.g. a blinking cursor and a
+     clock, are cheaper to fetch one by one than through their
+     bounding box. Without shm, the first update downloads the whole
+     pixmap anyway. */
+  if ((tex_pixmap->image || tex_pixmap->shm_info.shmid != -1) &&
+      should_update_rects_separately (tex_pixmap))
+    {
+      int n_rects = mtk_region_num_rectangles (tex_pixmap->damage_region);
+      int i;
+
+      COGL_NOTE (TEXTURE_PIXMAP, "Updating %d rectangles of %p separately",
+                 n_rects, tex_pixmap);
+
+      for (i = 0; i < n_rects; i++)
+        {
+          MtkRectangle rect;
+
+          rect = mtk_region_get_rectangle (tex_pixmap->damage_region, i);
+          update_image_texture_rect (tex_pixmap, &rect);
+        }
+    }
+  else
+    {
+      update_image_texture_rect (tex_pixmap, &tex_pixmap->damage_rect);
+    }
+
+  clear_damage (tex_pixmap);
 }
 
 static void
@@ -1172,9 +1282,7 @@ cogl_texture_pixmap_x11_update_area (CoglTexturePixmapX11 *tex_pixmap,
       winsys = _cogl_texture_pixmap_x11_get_winsys (tex_pixmap);
       winsys->texture_pixmap_x11_damage_notify (tex_pixmap);
     }
-  mtk_rectangle_union (&tex_pixmap->damage_rect,
-                       area,
-                       &tex_pixmap->damage_rect);
+  add_damage (tex_pixmap, area);
 }
 
 gboolean
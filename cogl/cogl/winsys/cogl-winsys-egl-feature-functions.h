@@ -99,6 +99,12 @@ COGL_WINSYS_FEATURE_BEGIN (create_context,
                            COGL_EGL_WINSYS_FEATURE_CREATE_CONTEXT)
 COGL_WINSYS_FEATURE_END ()
 
+COGL_WINSYS_FEATURE_BEGIN (create_context_robustness,
+                           "EXT\0",
+                           "create_context_robustness\0",
+                           COGL_EGL_WINSYS_FEATURE_CREATE_CONTEXT_ROBUSTNESS)
+COGL_WINSYS_FEATURE_END ()
+
 COGL_WINSYS_FEATURE_BEGIN (no_config_context,
                            "KHR\0",
                            "no_config_context\0",
@@ -171,6 +177,16 @@ COGL_WINSYS_FEATURE_FUNCTION (EGLint, eglDupNativeFenceFD,
                               (EGLDisplay dpy,
                                EGLSyncKHR sync))
 COGL_WINSYS_FEATURE_END ()
+
+COGL_WINSYS_FEATURE_BEGIN (wait_sync,
+                           "KHR\0",
+                           "wait_sync\0",
+                           COGL_EGL_WINSYS_FEATURE_WAIT_SYNC)
+COGL_WINSYS_FEATURE_FUNCTION (EGLint, eglWaitSync,
+                              (EGLDisplay dpy,
+                               EGLSyncKHR sync,
+                               EGLint flags))
+COGL_WINSYS_FEATURE_END ()
 #endif
 
 COGL_WINSYS_FEATURE_BEGIN (surfaceless_context,
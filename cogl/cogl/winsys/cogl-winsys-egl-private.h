@@ -103,6 +103,8 @@ typedef enum _CoglEGLWinsysFeature
   COGL_EGL_WINSYS_FEATURE_CONTEXT_PRIORITY              = 1L << 7,
   COGL_EGL_WINSYS_FEATURE_NO_CONFIG_CONTEXT             = 1L << 8,
   COGL_EGL_WINSYS_FEATURE_NATIVE_FENCE_SYNC             = 1L << 9,
+  COGL_EGL_WINSYS_FEATURE_WAIT_SYNC                     = 1L << 10,
+  COGL_EGL_WINSYS_FEATURE_CREATE_CONTEXT_ROBUSTNESS     = 1L << 11,
 } CoglEGLWinsysFeature;
 
 typedef struct _CoglRendererEGL
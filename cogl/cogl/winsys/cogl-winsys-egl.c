@@ -50,6 +50,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 
 #ifndef EGL_KHR_create_context
@@ -68,6 +69,11 @@
 #define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR 0x00000002
 #endif
 
+#ifndef EGL_EXT_create_context_robustness
+#define EGL_CONTEXT_OPENGL_RESET_NOTIFICATION_STRATEGY_EXT 0x3138
+#define EGL_LOSE_CONTEXT_ON_RESET_EXT           0x31BF
+#endif
+
 #ifndef EGL_IMG_context_priority
 #define EGL_CONTEXT_PRIORITY_LEVEL_IMG          0x3100
 #define EGL_CONTEXT_PRIORITY_HIGH_IMG           0x3101
@@ -294,6 +300,23 @@ cleanup_context (CoglDisplay *display)
     egl_renderer->platform_vtable->cleanup_context (display);
 }
 
+static EGLContext
+create_egl_context (CoglDisplay  *display,
+                    EGLConfig     config,
+                    const EGLint *attribs)
+{
+  CoglRendererEGL *egl_renderer = display->renderer->winsys;
+
+  if (egl_renderer->private_features &
+      COGL_EGL_WINSYS_FEATURE_NO_CONFIG_CONTEXT)
+    config = EGL_NO_CONFIG_KHR;
+
+  return eglCreateContext (egl_renderer->edpy,
+                           config,
+                           EGL_NO_CONTEXT,
+                           attribs);
+}
+
 static gboolean
 try_create_context (CoglDisplay *display,
                     GError **error)
@@ -301,12 +324,12 @@ try_create_context (CoglDisplay *display,
   CoglRenderer *renderer = display->renderer;
   CoglDisplayEGL *egl_display = display->winsys;
   CoglRendererEGL *egl_renderer = renderer->winsys;
-  EGLDisplay edpy;
   EGLConfig config;
-  EGLint attribs[11];
+  EGLint attribs[13];
   EGLint cfg_attribs[MAX_EGL_CONFIG_ATTRIBS];
   GError *config_error = NULL;
   const char *error_message;
+  int robustness_index = -1;
   int i = 0;
 
   g_return_val_if_fail (egl_display->egl_context == NULL, TRUE);
@@ -316,8 +339,6 @@ try_create_context (CoglDisplay *display,
   cogl_display_egl_determine_attributes (display,
                                          cfg_attribs);
 
-  edpy = egl_renderer->edpy;
-
   if (!egl_renderer->platform_vtable->choose_config (display,
                                                      cfg_attribs,
                                                      &config,
@@ -364,22 +385,28 @@ try_create_context (CoglDisplay *display,
       attribs[i++] = EGL_CONTEXT_PRIORITY_HIGH_IMG;
     }
 
-  attribs[i++] = EGL_NONE;
-
+  /* Ask to be notified of GPU resets, so that they can be detected with
+   * cogl_context_get_graphics_reset_status() instead of the driver
+   * aborting. Like with GLX, robust buffer access is not enabled. */
   if (egl_renderer->private_features &
-      COGL_EGL_WINSYS_FEATURE_NO_CONFIG_CONTEXT)
+      COGL_EGL_WINSYS_FEATURE_CREATE_CONTEXT_ROBUSTNESS)
     {
-      egl_display->egl_context = eglCreateContext (edpy,
-                                                   EGL_NO_CONFIG_KHR,
-                                                   EGL_NO_CONTEXT,
-                                                   attribs);
+      robustness_index = i;
+      attribs[i++] = EGL_CONTEXT_OPENGL_RESET_NOTIFICATION_STRATEGY_EXT;
+      attribs[i++] = EGL_LOSE_CONTEXT_ON_RESET_EXT;
     }
-  else
+
+  attribs[i++] = EGL_NONE;
+
+  egl_display->egl_context = create_egl_context (display, config, attribs);
+
+  if (egl_display->egl_context == EGL_NO_CONTEXT && robustness_index >= 0)
     {
-      egl_display->egl_context = eglCreateContext (edpy,
-                                                   config,
-                                                   EGL_NO_CONTEXT,
-                                                   attribs);
+      COGL_NOTE (WINSYS, "Failed to create a context with reset "
+                 "notifications, retrying without");
+
+      attribs[robustness_index] = EGL_NONE;
+      egl_display->egl_context = create_egl_context (display, config, attribs);
     }
 
   if (egl_display->egl_context == EGL_NO_CONTEXT)
@@ -562,6 +589,43 @@ _cogl_winsys_update_sync (CoglContext *context)
   renderer->sync = renderer->pf_eglCreateSync (renderer->edpy,
         EGL_SYNC_NATIVE_FENCE_ANDROID, NULL);
 }
+
+static gboolean
+_cogl_winsys_wait_sync_fd (CoglContext *context,
+                           int          sync_fd)
+{
+  CoglRendererEGL *renderer = context->display->renderer->winsys;
+  EGLSyncKHR sync;
+  EGLint attribs[] = {
+    EGL_SYNC_NATIVE_FENCE_FD_ANDROID, -1,
+    EGL_NONE
+  };
+
+  if (!renderer->pf_eglCreateSync ||
+      !renderer->pf_eglDestroySync ||
+      !renderer->pf_eglDupNativeFenceFD ||
+      !renderer->pf_eglWaitSync)
+    return FALSE;
+
+  attribs[1] = fcntl (sync_fd, F_DUPFD_CLOEXEC, 0);
+  if (attribs[1] < 0)
+    return FALSE;
+
+  /* The sync takes ownership of the file descriptor on success */
+  sync = renderer->pf_eglCreateSync (renderer->edpy,
+                                     EGL_SYNC_NATIVE_FENCE_ANDROID,
+                                     attribs);
+  if (sync == EGL_NO_SYNC_KHR)
+    {
+      close (attribs[1]);
+      return FALSE;
+    }
+
+  renderer->pf_eglWaitSync (renderer->edpy, sync, 0);
+  renderer->pf_eglDestroySync (renderer->edpy, sync);
+
+  return TRUE;
+}
 #endif
 
 static CoglWinsysVtable _cogl_winsys_vtable =
@@ -583,6 +647,7 @@ static CoglWinsysVtable _cogl_winsys_vtable =
 #if defined(EGL_KHR_fence_sync) || defined(EGL_KHR_reusable_sync)
     .get_sync_fd = _cogl_winsys_get_sync_fd,
     .update_sync = _cogl_winsys_update_sync,
+    .wait_sync_fd = _cogl_winsys_wait_sync_fd,
 #endif
   };
 
@@ -156,6 +156,10 @@ typedef struct _CoglWinsysVtable
   int
   (*get_sync_fd) (CoglContext *ctx);
 
+  gboolean
+  (*wait_sync_fd) (CoglContext *ctx,
+                   int          sync_fd);
+
 } CoglWinsysVtable;
 
 typedef const CoglWinsysVtable *(*CoglWinsysVtableGetter) (void);
@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <pixman.h>
+#include <string.h>
 
 #include "mtk/mtk-region.h"
 
@@ -32,6 +33,59 @@ struct _MtkRegion
   pixman_region32_t inner_region;
 };
 
+static inline pixman_box32_t
+box_from_rectangle (const MtkRectangle *rect)
+{
+  return (pixman_box32_t) {
+    .x1 = rect->x,
+    .y1 = rect->y,
+    .x2 = rect->x + rect->width,
+    .y2 = rect->y + rect->height,
+  };
+}
+
+static inline gboolean
+box_is_empty (const pixman_box32_t *box)
+{
+  return box->x1 >= box->x2 || box->y1 >= box->y2;
+}
+
+static inline gboolean
+box_contains_box (const pixman_box32_t *box,
+                  const pixman_box32_t *other)
+{
+  return (box->x1 <= other->x1 && box->y1 <= other->y1 &&
+          box->x2 >= other->x2 && box->y2 >= other->y2);
+}
+
+static inline gboolean
+box_overlaps_box (const pixman_box32_t *box,
+                  const pixman_box32_t *other)
+{
+  return (box->x1 < other->x2 && box->x2 > other->x1 &&
+          box->y1 < other->y2 && box->y2 > other->y1);
+}
+
+static inline gboolean
+region_is_empty (const MtkRegion *region)
+{
+  return !pixman_region32_not_empty (&region->inner_region);
+}
+
+/* Whether the region consists of exactly one rectangle, i.e. is equal
+ * to its extents */
+static inline gboolean
+region_is_rectangle (const MtkRegion *region)
+{
+  return pixman_region32_n_rects (&region->inner_region) == 1;
+}
+
+static inline const pixman_box32_t *
+region_extents (const MtkRegion *region)
+{
+  return pixman_region32_extents (&region->inner_region);
+}
+
 /**
  * mtk_region_ref:
  * @region: A region
@@ -121,7 +175,7 @@ mtk_region_is_empty (const MtkRegion *region)
 {
   g_return_val_if_fail (region != NULL, TRUE);
 
-  return !pixman_region32_not_empty (&region->inner_region);
+  return region_is_empty (region);
 }
 
 MtkRectangle
@@ -173,6 +227,21 @@ mtk_region_union (MtkRegion       *region,
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
+  if (region == other || region_is_empty (other))
+    return;
+
+  if (region_is_empty (region) ||
+      (region_is_rectangle (other) &&
+       box_contains_box (region_extents (other), region_extents (region))))
+    {
+      pixman_region32_copy (&region->inner_region, &other->inner_region);
+      return;
+    }
+
+  if (region_is_rectangle (region) &&
+      box_contains_box (region_extents (region), region_extents (other)))
+    return;
+
   pixman_region32_union (&region->inner_region,
                          &region->inner_region,
                          &other->inner_region);
@@ -182,18 +251,30 @@ void
 mtk_region_union_rectangle (MtkRegion          *region,
                             const MtkRectangle *rect)
 {
-  pixman_region32_t pixman_region;
+  pixman_box32_t box;
 
   g_return_if_fail (region != NULL);
   g_return_if_fail (rect != NULL);
 
-  pixman_region32_init_rect (&pixman_region,
-                             rect->x, rect->y,
-                             rect->width, rect->height);
-  pixman_region32_union (&region->inner_region,
-                         &region->inner_region,
-                         &pixman_region);
-  pixman_region32_fini (&pixman_region);
+  box = box_from_rectangle (rect);
+  if (box_is_empty (&box))
+    return;
+
+  if (region_is_empty (region) ||
+      box_contains_box (&box, region_extents (region)))
+    {
+      pixman_region32_reset (&region->inner_region, &box);
+      return;
+    }
+
+  if (region_is_rectangle (region) &&
+      box_contains_box (region_extents (region), &box))
+    return;
+
+  pixman_region32_union_rect (&region->inner_region,
+                              &region->inner_region,
+                              rect->x, rect->y,
+                              rect->width, rect->height);
 }
 
 void
@@ -203,6 +284,24 @@ mtk_region_subtract (MtkRegion       *region,
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
+  if (region == other)
+    {
+      pixman_region32_clear (&region->inner_region);
+      return;
+    }
+
+  if (region_is_empty (region) ||
+      region_is_empty (other) ||
+      !box_overlaps_box (region_extents (region), region_extents (other)))
+    return;
+
+  if (region_is_rectangle (other) &&
+      box_contains_box (region_extents (other), region_extents (region)))
+    {
+      pixman_region32_clear (&region->inner_region);
+      return;
+    }
+
   pixman_region32_subtract (&region->inner_region,
                             &region->inner_region,
                             &other->inner_region);
@@ -212,10 +311,23 @@ void
 mtk_region_subtract_rectangle (MtkRegion          *region,
                                const MtkRectangle *rect)
 {
+  pixman_region32_t pixman_region;
+  pixman_box32_t box;
+
   g_return_if_fail (region != NULL);
   g_return_if_fail (rect != NULL);
 
-  pixman_region32_t pixman_region;
+  box = box_from_rectangle (rect);
+  if (box_is_empty (&box) ||
+      !box_overlaps_box (&box, region_extents (region)))
+    return;
+
+  if (box_contains_box (&box, region_extents (region)))
+    {
+      pixman_region32_clear (&region->inner_region);
+      return;
+    }
+
   pixman_region32_init_rect (&pixman_region,
                              rect->x, rect->y,
                              rect->width, rect->height);
@@ -233,6 +345,27 @@ mtk_region_intersect (MtkRegion       *region,
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
+  if (region == other || region_is_empty (region))
+    return;
+
+  if (region_is_empty (other) ||
+      !box_overlaps_box (region_extents (region), region_extents (other)))
+    {
+      pixman_region32_clear (&region->inner_region);
+      return;
+    }
+
+  if (region_is_rectangle (other) &&
+      box_contains_box (region_extents (other), region_extents (region)))
+    return;
+
+  if (region_is_rectangle (region) &&
+      box_contains_box (region_extents (region), region_extents (other)))
+    {
+      pixman_region32_copy (&region->inner_region, &other->inner_region);
+      return;
+    }
+
   pixman_region32_intersect (&region->inner_region,
                              &region->inner_region,
                              &other->inner_region);
@@ -243,8 +376,38 @@ mtk_region_intersect_rectangle (MtkRegion          *region,
                                 const MtkRectangle *rect)
 {
   pixman_region32_t pixman_region;
+  const pixman_box32_t *extents;
+  pixman_box32_t box;
 
   g_return_if_fail (region != NULL);
+  g_return_if_fail (rect != NULL);
+
+  if (region_is_empty (region))
+    return;
+
+  box = box_from_rectangle (rect);
+  extents = region_extents (region);
+  if (box_is_empty (&box) || !box_overlaps_box (&box, extents))
+    {
+      pixman_region32_clear (&region->inner_region);
+      return;
+    }
+
+  if (box_contains_box (&box, extents))
+    return;
+
+  if (region_is_rectangle (region))
+    {
+      pixman_box32_t intersection = {
+        .x1 = MAX (box.x1, extents->x1),
+        .y1 = MAX (box.y1, extents->y1),
+        .x2 = MIN (box.x2, extents->x2),
+        .y2 = MIN (box.y2, extents->y2),
+      };
+
+      pixman_region32_reset (&region->inner_region, &intersection);
+      return;
+    }
 
   pixman_region32_init_rect (&pixman_region,
                              rect->x, rect->y,
@@ -282,51 +445,55 @@ mtk_region_create_rectangle (const MtkRectangle *rect)
   return region;
 }
 
-MtkRegion *
-mtk_region_create_rectangles (const MtkRectangle *rects,
-                              int                 n_rects)
+static gboolean
+init_pixman_region_from_rectangles (pixman_region32_t  *pixman_region,
+                                    const MtkRectangle *rects,
+                                    int                 n_rects)
 {
   pixman_box32_t stack_boxes[512 * sizeof (int) / sizeof (pixman_box32_t)];
   pixman_box32_t *boxes = stack_boxes;
+  gboolean success;
   int i;
-  g_autoptr (MtkRegion) region = NULL;
-
-  g_return_val_if_fail (rects != NULL, NULL);
-  g_return_val_if_fail (n_rects != 0, NULL);
-
-  region = g_atomic_rc_box_new0 (MtkRegion);
 
   if (n_rects == 1)
     {
-      pixman_region32_init_rect (&region->inner_region,
+      pixman_region32_init_rect (pixman_region,
                                  rects->x, rects->y,
                                  rects->width, rects->height);
-
-      return g_steal_pointer (&region);
+      return TRUE;
     }
 
-  if (n_rects > sizeof (stack_boxes) / sizeof (stack_boxes[0]))
+  if (n_rects > G_N_ELEMENTS (stack_boxes))
     {
       boxes = g_new0 (pixman_box32_t, n_rects);
       if (G_UNLIKELY (boxes == NULL))
-        return NULL;
+        return FALSE;
     }
 
   for (i = 0; i < n_rects; i++)
-    {
-      boxes[i].x1 = rects[i].x;
-      boxes[i].y1 = rects[i].y;
-      boxes[i].x2 = rects[i].x + rects[i].width;
-      boxes[i].y2 = rects[i].y + rects[i].height;
-    }
+    boxes[i] = box_from_rectangle (&rects[i]);
 
-  i = pixman_region32_init_rects (&region->inner_region,
-                                  boxes, n_rects);
+  success = pixman_region32_init_rects (pixman_region, boxes, n_rects);
 
   if (boxes != stack_boxes)
-    free (boxes);
+    g_free (boxes);
+
+  return success;
+}
 
-  if (G_UNLIKELY (i == 0))
+MtkRegion *
+mtk_region_create_rectangles (const MtkRectangle *rects,
+                              int                 n_rects)
+{
+  g_autoptr (MtkRegion) region = NULL;
+
+  g_return_val_if_fail (rects != NULL, NULL);
+  g_return_val_if_fail (n_rects != 0, NULL);
+
+  region = g_atomic_rc_box_new0 (MtkRegion);
+
+  if (G_UNLIKELY (!init_pixman_region_from_rectangles (&region->inner_region,
+                                                       rects, n_rects)))
     return NULL;
 
   return g_steal_pointer (&region);
@@ -516,32 +683,66 @@ mtk_region_iterator_next (MtkRegionIterator *iter)
     }
 }
 
-/* Various algorithms in this file require unioning together a set of rectangles
- * that are unsorted or overlap; unioning such a set of rectangles 1-by-1
- * using mtk_region_union_rectangle() produces O(N^2) behavior (if the union
- * adds or removes rectangles in the middle of the region, then it has to
- * move all the rectangles after that.) To avoid this behavior, MtkRegionBuilder
- * creates regions for small groups of rectangles and merges them together in
- * a binary tree.
- *
- * Possible improvement: From a glance at the code, accumulating all the rectangles
- *  into a flat array and then calling the (not usefully documented)
- *  mtk_region_create_rectangles() would have the same behavior and would be
- *  simpler and a bit more efficient.
+/* Various algorithms require unioning together a set of rectangles that are
+ * unsorted or overlap; unioning such a set of rectangles 1-by-1 using
+ * mtk_region_union_rectangle() produces O(N^2) behavior (if the union adds or
+ * removes rectangles in the middle of the region, then it has to move all the
+ * rectangles after that.) To avoid this behavior, MtkRegionBuilder accumulates
+ * the rectangles into a flat list and creates the region from all of them at
+ * once, which lets pixman sort them and build the bands in a single pass.
  */
 
-/* Optimium performance seems to be with MAX_CHUNK_RECTANGLES=4; 8 is about 10% slower.
- * But using 8 may be more robust to systems with slow malloc(). */
-#define MAX_CHUNK_RECTANGLES 8
+static inline MtkRectangle *
+builder_get_rectangles (MtkRegionBuilder *builder)
+{
+  return builder->rectangles ? builder->rectangles : builder->preallocated;
+}
 
 void
 mtk_region_builder_init (MtkRegionBuilder *builder)
 {
-  int i;
+  builder->rectangles = NULL;
+  builder->n_rectangles = 0;
+  builder->size = MTK_REGION_BUILDER_N_PREALLOCATED_RECTANGLES;
+}
 
-  for (i = 0; i < MTK_REGION_BUILDER_MAX_LEVELS; i++)
-    builder->levels[i] = NULL;
-  builder->n_levels = 1;
+/**
+ * mtk_region_builder_clear:
+ * @builder: A region builder
+ *
+ * Drops all the rectangles added so far and frees any memory used by
+ * @builder. The builder can be used again afterwards.
+ */
+void
+mtk_region_builder_clear (MtkRegionBuilder *builder)
+{
+  g_clear_pointer (&builder->rectangles, g_free);
+  mtk_region_builder_init (builder);
+}
+
+static void
+builder_append (MtkRegionBuilder   *builder,
+                const MtkRectangle *rect)
+{
+  if (builder->n_rectangles == builder->size)
+    {
+      builder->size *= 2;
+
+      if (builder->rectangles)
+        {
+          builder->rectangles = g_renew (MtkRectangle,
+                                         builder->rectangles,
+                                         builder->size);
+        }
+      else
+        {
+          builder->rectangles = g_new (MtkRectangle, builder->size);
+          memcpy (builder->rectangles, builder->preallocated,
+                  sizeof (builder->preallocated));
+        }
+    }
+
+  builder_get_rectangles (builder)[builder->n_rectangles++] = *rect;
 }
 
 void
@@ -551,68 +752,101 @@ mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                   int               width,
                                   int               height)
 {
-  MtkRectangle rect;
-  int i;
+  if (width <= 0 || height <= 0)
+    return;
 
-  if (builder->levels[0] == NULL)
-    builder->levels[0] = mtk_region_create ();
+  builder_append (builder, &MTK_RECTANGLE_INIT (x, y, width, height));
+}
 
-  rect.x = x;
-  rect.y = y;
-  rect.width = width;
-  rect.height = height;
+/**
+ * mtk_region_builder_add_region:
+ * @builder: A region builder
+ * @region: The region to add
+ *
+ * Adds all the rectangles of @region to @builder.
+ */
+void
+mtk_region_builder_add_region (MtkRegionBuilder *builder,
+                               const MtkRegion  *region)
+{
+  pixman_box32_t *boxes;
+  int n_boxes, i;
+
+  g_return_if_fail (region != NULL);
 
-  mtk_region_union_rectangle (builder->levels[0], &rect);
-  if (mtk_region_num_rectangles (builder->levels[0]) >= MAX_CHUNK_RECTANGLES)
+  boxes = pixman_region32_rectangles (&region->inner_region, &n_boxes);
+  for (i = 0; i < n_boxes; i++)
     {
-      for (i = 1; i < builder->n_levels + 1; i++)
-        {
-          if (builder->levels[i] == NULL)
-            {
-              if (i < MTK_REGION_BUILDER_MAX_LEVELS)
-                {
-                  builder->levels[i] = builder->levels[i - 1];
-                  builder->levels[i - 1] = NULL;
-                  if (i == builder->n_levels)
-                    builder->n_levels++;
-                }
-
-              break;
-            }
-          else
-            {
-              mtk_region_union (builder->levels[i], builder->levels[i - 1]);
-              mtk_region_unref (builder->levels[i - 1]);
-              builder->levels[i - 1] = NULL;
-            }
-        }
+      builder_append (builder,
+                      &MTK_RECTANGLE_INIT (boxes[i].x1,
+                                           boxes[i].y1,
+                                           boxes[i].x2 - boxes[i].x1,
+                                           boxes[i].y2 - boxes[i].y1));
     }
 }
 
-MtkRegion *
-mtk_region_builder_finish (MtkRegionBuilder *builder)
+gboolean
+mtk_region_builder_is_empty (const MtkRegionBuilder *builder)
 {
-  MtkRegion *result = NULL;
-  int i;
+  return builder->n_rectangles == 0;
+}
 
-  for (i = 0; i < builder->n_levels; i++)
+/**
+ * mtk_region_builder_finish_into:
+ * @builder: A region builder
+ * @region: The region to add the rectangles to
+ *
+ * Unions all the rectangles added to @builder into @region in place, and
+ * clears @builder. Unlike calling mtk_region_union_rectangle() for each
+ * rectangle, this only merges the rectangles into @region once.
+ */
+void
+mtk_region_builder_finish_into (MtkRegionBuilder *builder,
+                                MtkRegion        *region)
+{
+  MtkRectangle *rects = builder_get_rectangles (builder);
+  int n_rects = builder->n_rectangles;
+
+  g_return_if_fail (region != NULL);
+
+  if (n_rects == 1)
     {
-      if (builder->levels[i])
+      mtk_region_union_rectangle (region, &rects[0]);
+    }
+  else if (n_rects > 1)
+    {
+      if (region_is_empty (region))
         {
-          if (result == NULL)
-            {
-              result = builder->levels[i];
-            }
-          else
+          pixman_region32_fini (&region->inner_region);
+          if (!init_pixman_region_from_rectangles (&region->inner_region,
+                                                   rects, n_rects))
+            pixman_region32_init (&region->inner_region);
+        }
+      else
+        {
+          pixman_region32_t pixman_region;
+
+          if (init_pixman_region_from_rectangles (&pixman_region,
+                                                  rects, n_rects))
             {
-              mtk_region_union (result, builder->levels[i]);
-              mtk_region_unref (builder->levels[i]);
+              pixman_region32_union (&region->inner_region,
+                                     &region->inner_region,
+                                     &pixman_region);
+              pixman_region32_fini (&pixman_region);
             }
         }
     }
 
-  if (result == NULL)
-    result = mtk_region_create ();
+  mtk_region_builder_clear (builder);
+}
+
+MtkRegion *
+mtk_region_builder_finish (MtkRegionBuilder *builder)
+{
+  MtkRegion *region;
+
+  region = mtk_region_create ();
+  mtk_region_builder_finish_into (builder, region);
 
-  return result;
+  return region;
 }
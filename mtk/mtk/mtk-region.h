@@ -179,26 +179,25 @@ void mtk_region_iterator_next (MtkRegionIterator *iter);
 
 typedef struct _MtkRegionBuilder MtkRegionBuilder;
 
-#define MTK_REGION_BUILDER_MAX_LEVELS 16
+#define MTK_REGION_BUILDER_N_PREALLOCATED_RECTANGLES 32
 
 struct _MtkRegionBuilder {
-  /* To merge regions in binary tree order, we need to keep track of
-   * the regions that we've already merged together at different
-   * levels of the tree. We fill in an array in the pattern:
-   *
-   * |a  |
-   * |b  |a  |
-   * |c  |   |ab |
-   * |d  |c  |ab |
-   * |e  |   |   |abcd|
-   */
-  MtkRegion *levels[MTK_REGION_BUILDER_MAX_LEVELS];
-  int n_levels;
+  /*< private >*/
+  /* Rectangles are accumulated into a flat list, which is only turned
+   * into a region once, when finishing the builder. Small lists don't
+   * need any heap allocation at all. */
+  MtkRectangle preallocated[MTK_REGION_BUILDER_N_PREALLOCATED_RECTANGLES];
+  MtkRectangle *rectangles;
+  int n_rectangles;
+  int size;
 };
 
 MTK_EXPORT
 void mtk_region_builder_init (MtkRegionBuilder *builder);
 
+MTK_EXPORT
+void mtk_region_builder_clear (MtkRegionBuilder *builder);
+
 MTK_EXPORT
 void mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                        int               x,
@@ -206,5 +205,16 @@ void mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                        int               width,
                                        int               height);
 
+MTK_EXPORT
+void mtk_region_builder_add_region (MtkRegionBuilder *builder,
+                                    const MtkRegion  *region);
+
+MTK_EXPORT
+gboolean mtk_region_builder_is_empty (const MtkRegionBuilder *builder);
+
 MTK_EXPORT
 MtkRegion * mtk_region_builder_finish (MtkRegionBuilder *builder);
+
+MTK_EXPORT
+void mtk_region_builder_finish_into (MtkRegionBuilder *builder,
+                                     MtkRegion        *region);
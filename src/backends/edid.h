@@ -97,6 +97,9 @@ META_EXPORT_TEST
 MetaEdidInfo *meta_edid_info_new_parse (const uint8_t *edid,
                                         size_t size);
 
+META_EXPORT_TEST
+MetaEdidInfo *meta_edid_info_copy (const MetaEdidInfo *info);
+
 META_EXPORT_TEST
 void meta_edid_info_free (MetaEdidInfo *info);
 
@@ -33,6 +33,8 @@
 #include "backends/meta-egl.h"
 #include "backends/meta-input-mapper-private.h"
 #include "backends/meta-input-settings-private.h"
+#include "backends/meta-keymap-cache.h"
+#include "backends/meta-memory-pressure.h"
 #include "backends/meta-monitor-manager-private.h"
 #include "backends/meta-pointer-constraint.h"
 #include "backends/meta-renderer.h"
@@ -65,6 +67,7 @@ struct _MetaBackendClass
   MetaMonitorManager * (* create_monitor_manager) (MetaBackend *backend,
                                                    GError     **error);
   MetaColorManager * (* create_color_manager) (MetaBackend *backend);
+  MetaOrientationManager * (* create_orientation_manager) (MetaBackend *backend);
   MetaCursorRenderer * (* get_cursor_renderer) (MetaBackend        *backend,
                                                 ClutterInputDevice *device);
   MetaCursorTracker * (* create_cursor_tracker) (MetaBackend *backend);
@@ -189,6 +192,10 @@ gboolean meta_backend_is_stage_views_scaled (MetaBackend *backend);
 MetaInputMapper *meta_backend_get_input_mapper (MetaBackend *backend);
 MetaInputSettings *meta_backend_get_input_settings (MetaBackend *backend);
 
+MetaKeymapCache * meta_backend_get_keymap_cache (MetaBackend *backend);
+
+MetaMemoryPressure * meta_backend_get_memory_pressure (MetaBackend *backend);
+
 void meta_backend_notify_keymap_changed (MetaBackend *backend);
 
 void meta_backend_notify_keymap_layout_group_changed (MetaBackend *backend,
@@ -69,6 +69,7 @@
 #include "backends/meta-stage-private.h"
 #include "clutter/clutter-mutter.h"
 #include "clutter/clutter-seat-private.h"
+#include "cogl/cogl-mutter.h"
 #include "compositor/meta-dnd-private.h"
 #include "core/meta-context-private.h"
 #include "meta/main.h"
@@ -153,6 +154,9 @@ struct _MetaBackendPrivate
   MetaRemoteDesktop *remote_desktop;
 #endif
   MetaInputCapture *input_capture;
+  MetaKeymapCache *keymap_cache;
+  MetaMemoryPressure *memory_pressure;
+  unsigned int keymap_trimmer_id;
 
 #ifdef HAVE_LIBWACOM
   WacomDeviceDatabase *wacom_db;
@@ -172,6 +176,9 @@ struct _MetaBackendPrivate
 
   guint device_update_idle_id;
 
+  gulong program_cache_after_paint_handler_id;
+  guint program_cache_warm_id;
+
   ClutterInputDevice *current_device;
 
   MetaPointerConstraint *client_pointer_constraint;
@@ -250,10 +257,21 @@ meta_backend_dispose (GObject *object)
   g_clear_object (&priv->upower_proxy);
 
   g_clear_handle_id (&priv->device_update_idle_id, g_source_remove);
+  g_clear_handle_id (&priv->program_cache_warm_id, g_source_remove);
 
   g_clear_object (&priv->settings);
+  if (priv->keymap_trimmer_id)
+    {
+      meta_memory_pressure_remove_trimmer (priv->memory_pressure,
+                                           priv->keymap_trimmer_id);
+      priv->keymap_trimmer_id = 0;
+    }
+  g_clear_object (&priv->keymap_cache);
 
   g_clear_pointer (&priv->default_seat, clutter_seat_destroy);
+  if (priv->stage)
+    g_clear_signal_handler (&priv->program_cache_after_paint_handler_id,
+                            priv->stage);
   g_clear_pointer (&priv->stage, clutter_actor_destroy);
   g_clear_pointer (&priv->idle_manager, meta_idle_manager_free);
   g_clear_object (&priv->renderer);
@@ -265,6 +283,7 @@ meta_backend_dispose (GObject *object)
 #endif
   g_clear_pointer (&priv->clutter_context, clutter_context_destroy);
   g_clear_list (&priv->gpus, g_object_unref);
+  g_clear_object (&priv->memory_pressure);
 
   G_OBJECT_CLASS (meta_backend_parent_class)->dispose (object);
 }
@@ -655,6 +674,12 @@ meta_backend_real_create_cursor_tracker (MetaBackend *backend)
                        NULL);
 }
 
+static MetaOrientationManager *
+meta_backend_real_create_orientation_manager (MetaBackend *backend)
+{
+  return g_object_new (META_TYPE_ORIENTATION_MANAGER, NULL);
+}
+
 static gboolean
 meta_backend_real_is_headless (MetaBackend *backend)
 {
@@ -842,11 +867,24 @@ meta_backend_constructed (GObject *object)
   MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
   MetaBackendClass *backend_class =
    META_BACKEND_GET_CLASS (backend);
+  g_autofree char *keymap_cache_dir = NULL;
 
   g_assert (priv->context);
 
   priv->settings = meta_settings_new (backend);
 
+  keymap_cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                       "mutter", "keymaps",
+                                       NULL);
+  priv->keymap_cache = meta_keymap_cache_new (keymap_cache_dir);
+
+  priv->memory_pressure = meta_memory_pressure_new ();
+  priv->keymap_trimmer_id =
+    meta_memory_pressure_add_trimmer (priv->memory_pressure,
+                                      "keymaps",
+                                      (MetaMemoryTrimFunc) meta_keymap_cache_trim,
+                                      priv->keymap_cache);
+
 #ifdef HAVE_LIBWACOM
   priv->wacom_db = libwacom_database_new ();
   if (!priv->wacom_db)
@@ -933,6 +971,8 @@ meta_backend_class_init (MetaBackendClass *klass)
   klass->select_stage_events = meta_backend_real_select_stage_events;
   klass->is_lid_closed = meta_backend_real_is_lid_closed;
   klass->create_cursor_tracker = meta_backend_real_create_cursor_tracker;
+  klass->create_orientation_manager =
+    meta_backend_real_create_orientation_manager;
   klass->is_headless = meta_backend_real_is_headless;
 
   obj_props[PROP_CONTEXT] =
@@ -1012,6 +1052,12 @@ meta_backend_create_color_manager (MetaBackend *backend)
   return META_BACKEND_GET_CLASS (backend)->create_color_manager (backend);
 }
 
+static MetaOrientationManager *
+meta_backend_create_orientation_manager (MetaBackend *backend)
+{
+  return META_BACKEND_GET_CLASS (backend)->create_orientation_manager (backend);
+}
+
 static MetaRenderer *
 meta_backend_create_renderer (MetaBackend *backend,
                               GError     **error)
@@ -1245,13 +1291,91 @@ init_clutter (MetaBackend  *backend,
   return TRUE;
 }
 
+static void
+maybe_enable_program_binary_cache (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+  ClutterBackend *clutter_backend;
+  CoglContext *cogl_context;
+  g_autofree char *cache_dir = NULL;
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        priv->settings,
+        META_EXPERIMENTAL_FEATURE_PROGRAM_BINARY_CACHE))
+    return;
+
+  clutter_backend = meta_backend_get_clutter_backend (backend);
+  cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+
+  cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                "mutter", "program-binaries",
+                                NULL);
+  cogl_context_set_program_cache_dir (cogl_context, cache_dir);
+}
+
+static gboolean
+warm_program_binary_cache (gpointer user_data)
+{
+  MetaBackend *backend = user_data;
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+
+  if (cogl_context_warm_program_cache (cogl_context))
+    return G_SOURCE_CONTINUE;
+
+  priv->program_cache_warm_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_first_stage_paint (ClutterStage     *stage,
+                      ClutterStageView *view,
+                      ClutterFrame     *frame,
+                      MetaBackend      *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  g_clear_signal_handler (&priv->program_cache_after_paint_handler_id, stage);
+
+  /* Build the binaries that went missing, e.g. because of a driver update,
+   * one at a time when there is nothing else to do, instead of when an
+   * animation first needs them. */
+  priv->program_cache_warm_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                 warm_program_binary_cache,
+                                                 backend, NULL);
+  g_source_set_name_by_id (priv->program_cache_warm_id,
+                           "[mutter] warm_program_binary_cache");
+}
+
+static void
+maybe_warm_program_binary_cache (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        priv->settings,
+        META_EXPERIMENTAL_FEATURE_PROGRAM_BINARY_CACHE))
+    return;
+
+  priv->program_cache_after_paint_handler_id =
+    g_signal_connect (priv->stage, "after-paint",
+                      G_CALLBACK (on_first_stage_paint),
+                      backend);
+}
+
 static void
 meta_backend_post_init (MetaBackend *backend)
 {
   MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
 
+  maybe_enable_program_binary_cache (backend);
+
   META_BACKEND_GET_CLASS (backend)->post_init (backend);
 
+  maybe_warm_program_binary_cache (backend);
+
   meta_settings_post_init (priv->settings);
 }
 
@@ -1263,15 +1387,23 @@ meta_backend_initable_init (GInitable     *initable,
   MetaBackend *backend = META_BACKEND (initable);
   MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
 
-  priv->orientation_manager = g_object_new (META_TYPE_ORIENTATION_MANAGER, NULL);
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInit, "Meta::Backend::init()");
+
+  priv->orientation_manager = meta_backend_create_orientation_manager (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendCreateMonitorManager,
+                           "Meta::Backend::create_monitor_manager()");
   priv->monitor_manager = meta_backend_create_monitor_manager (backend, error);
+  COGL_TRACE_END (MetaBackendCreateMonitorManager);
   if (!priv->monitor_manager)
     return FALSE;
 
   priv->color_manager = meta_backend_create_color_manager (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendCreateRenderer,
+                           "Meta::Backend::create_renderer()");
   priv->renderer = meta_backend_create_renderer (backend, error);
+  COGL_TRACE_END (MetaBackendCreateRenderer);
   if (!priv->renderer)
     return FALSE;
 
@@ -1286,10 +1418,16 @@ meta_backend_initable_init (GInitable     *initable,
              system_bus_gotten_cb,
              backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitClutter,
+                           "Meta::Backend::init_clutter()");
   if (!init_clutter (backend, error))
     return FALSE;
+  COGL_TRACE_END (MetaBackendInitClutter);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendPostInit,
+                           "Meta::Backend::post_init()");
   meta_backend_post_init (backend);
+  COGL_TRACE_END (MetaBackendPostInit);
 
   while (TRUE)
     {
@@ -1464,6 +1602,22 @@ meta_backend_get_settings (MetaBackend *backend)
   return priv->settings;
 }
 
+MetaKeymapCache *
+meta_backend_get_keymap_cache (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  return priv->keymap_cache;
+}
+
+MetaMemoryPressure *
+meta_backend_get_memory_pressure (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  return priv->memory_pressure;
+}
+
 MetaDbusSessionWatcher *
 meta_backend_get_dbus_session_watcher (MetaBackend *backend)
 {
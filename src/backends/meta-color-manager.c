@@ -73,6 +73,7 @@ enum
   PROP_0,
 
   PROP_BACKEND,
+  PROP_USE_COLORD,
 
   N_PROPS
 };
@@ -82,6 +83,7 @@ static GParamSpec *obj_props[N_PROPS];
 typedef struct _MetaColorManagerPrivate
 {
   MetaBackend *backend;
+  gboolean use_colord;
 
   MetaColorStore *color_store;
 
@@ -403,8 +405,12 @@ meta_color_manager_constructed (GObject *object)
   priv->temperature = DEFAULT_TEMPERATURE;
 
   priv->cd_client = cd_client_new ();
-  cd_client_connect (priv->cd_client, priv->cancellable, cd_client_connect_cb,
-                     color_manager);
+  if (priv->use_colord)
+    {
+      cd_client_connect (priv->cd_client, priv->cancellable,
+                         cd_client_connect_cb,
+                         color_manager);
+    }
 
   meta_dbus_settings_daemon_color_proxy_new_for_bus (
     G_BUS_TYPE_SESSION,
@@ -461,6 +467,9 @@ meta_color_manager_set_property (GObject      *object,
     case PROP_BACKEND:
       priv->backend = g_value_get_object (value);
       break;
+    case PROP_USE_COLORD:
+      priv->use_colord = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -482,6 +491,9 @@ meta_color_manager_get_property (GObject    *object,
     case PROP_BACKEND:
       g_value_set_object (value, priv->backend);
       break;
+    case PROP_USE_COLORD:
+      g_value_set_boolean (value, priv->use_colord);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -504,6 +516,12 @@ meta_color_manager_class_init (MetaColorManagerClass *klass)
                          G_PARAM_READWRITE |
                          G_PARAM_CONSTRUCT_ONLY |
                          G_PARAM_STATIC_STRINGS);
+  obj_props[PROP_USE_COLORD] =
+    g_param_spec_boolean ("use-colord", NULL, NULL,
+                          TRUE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_CONSTRUCT_ONLY |
+                          G_PARAM_STATIC_STRINGS);
   g_object_class_install_properties (object_class, N_PROPS, obj_props);
 
   signals[DEVICE_CALIBRATION_CHANGED] =
@@ -37,6 +37,7 @@ struct _MetaCursorSpriteXcursor
 
   int current_frame;
   XcursorImages *xcursor_images;
+  unsigned int xcursor_images_serial;
 
   int theme_scale;
   gboolean theme_dirty;
@@ -288,6 +289,23 @@ meta_cursor_sprite_xcursor_get_current_image (MetaCursorSpriteXcursor *sprite_xc
   return sprite_xcursor->xcursor_images->images[sprite_xcursor->current_frame];
 }
 
+int
+meta_cursor_sprite_xcursor_get_current_frame (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->current_frame;
+}
+
+/*
+ * Changes every time the cursor images are reloaded, e.g. because of a
+ * theme or size change, so that data derived from the frames can be
+ * invalidated.
+ */
+unsigned int
+meta_cursor_sprite_xcursor_get_images_serial (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->xcursor_images_serial;
+}
+
 static void
 meta_cursor_sprite_xcursor_tick_frame (MetaCursorSprite *sprite)
 {
@@ -337,6 +355,7 @@ load_cursor_from_theme (MetaCursorSprite *sprite)
   sprite_xcursor->xcursor_images =
     load_cursor_on_client (sprite_xcursor->cursor,
                            sprite_xcursor->theme_scale);
+  sprite_xcursor->xcursor_images_serial++;
 
   load_from_current_xcursor_image (sprite_xcursor);
 }
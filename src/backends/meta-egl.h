@@ -159,6 +159,13 @@ gboolean meta_egl_swap_buffers (MetaEgl   *egl,
                                 EGLSurface surface,
                                 GError   **error);
 
+gboolean meta_egl_query_surface (MetaEgl     *egl,
+                                 EGLDisplay   display,
+                                 EGLSurface   surface,
+                                 EGLint       attribute,
+                                 EGLint      *value,
+                                 GError     **error);
+
 gboolean meta_egl_bind_wayland_display (MetaEgl            *egl,
                                         EGLDisplay          display,
                                         struct wl_display  *wayland_display,
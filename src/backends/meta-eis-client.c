@@ -41,6 +41,19 @@ struct _MetaEisDevice
 
   guchar button_state[(MAX_BUTTON + 7) / 8];
   guchar key_state[(MAX_KEY + 7) / 8];
+
+  /* Motion coalesced until the client's pending events are drained */
+  struct {
+    gboolean pending;
+    double dx;
+    double dy;
+  } relative_motion;
+
+  struct {
+    gboolean pending;
+    double x;
+    double y;
+  } absolute_motion;
 };
 
 struct _MetaEisClient
@@ -183,42 +196,40 @@ configure_keyboard (MetaEisClient     *client,
                     struct eis_device *eis_device,
                     gpointer           user_data)
 {
+  MetaBackend *backend = meta_eis_get_backend (client->eis);
   size_t len;
   MetaAnonymousFile *f;
-  int fd = -1;
-  char *data;
+  int fd;
   struct xkb_keymap *xkb_keymap;
+  struct eis_keymap *eis_keymap;
 
   eis_device_configure_capability (eis_device, EIS_DEVICE_CAP_KEYBOARD);
 
-  xkb_keymap =
-    meta_backend_get_keymap (meta_eis_get_backend (client->eis));
+  xkb_keymap = meta_backend_get_keymap (backend);
   if (!xkb_keymap)
     return;
 
-  data = xkb_keymap_get_as_string (xkb_keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
-  if (!data)
+  f = meta_keymap_cache_get_file (meta_backend_get_keymap_cache (backend),
+                                  xkb_keymap);
+  if (!f)
     return;
 
-  len = strlen (data);
-  f = meta_anonymous_file_new (len, (uint8_t*)data);
-  if (f)
-    fd = meta_anonymous_file_open_fd (f, META_ANONYMOUS_FILE_MAPMODE_SHARED);
-
-  g_free (data);
-  if (fd != -1)
+  len = meta_anonymous_file_size (f);
+  fd = meta_anonymous_file_open_fd (f, META_ANONYMOUS_FILE_MAPMODE_SHARED);
+  if (fd == -1)
     {
-      struct eis_keymap *eis_keymap;
-
-      eis_keymap = eis_device_new_keymap (eis_device, EIS_KEYMAP_TYPE_XKB,
-                                          fd, len);
-      /* libeis dup()s the fd */
-      meta_anonymous_file_close_fd (fd);
-      /* The memfile must be kept alive while the device is alive */
-      eis_keymap_set_user_data (eis_keymap, f);
-      eis_keymap_add (eis_keymap);
-      eis_keymap_unref (eis_keymap);
+      meta_anonymous_file_free (f);
+      return;
     }
+
+  eis_keymap = eis_device_new_keymap (eis_device, EIS_KEYMAP_TYPE_XKB,
+                                      fd, len);
+  /* libeis dup()s the fd */
+  meta_anonymous_file_close_fd (fd);
+  /* The memfile must be kept alive while the device is alive */
+  eis_keymap_set_user_data (eis_keymap, f);
+  eis_keymap_add (eis_keymap);
+  eis_keymap_unref (eis_keymap);
 }
 
 static gboolean
@@ -371,6 +382,32 @@ add_device (MetaEisClient           *client,
   return device;
 }
 
+static void
+flush_device_motion (MetaEisDevice *device)
+{
+  if (!device->device)
+    return;
+
+  if (device->relative_motion.pending)
+    {
+      clutter_virtual_input_device_notify_relative_motion (device->device,
+                                                           g_get_monotonic_time (),
+                                                           device->relative_motion.dx,
+                                                           device->relative_motion.dy);
+    }
+
+  if (device->absolute_motion.pending)
+    {
+      clutter_virtual_input_device_notify_absolute_motion (device->device,
+                                                           g_get_monotonic_time (),
+                                                           device->absolute_motion.x,
+                                                           device->absolute_motion.y);
+    }
+
+  device->relative_motion.pending = FALSE;
+  device->absolute_motion.pending = FALSE;
+}
+
 static void
 handle_motion_relative (MetaEisClient	 *client,
                         struct eis_event *event)
@@ -382,9 +419,18 @@ handle_motion_relative (MetaEisClient	 *client,
   dx = eis_event_pointer_get_dx (event);
   dy = eis_event_pointer_get_dy (event);
 
-  clutter_virtual_input_device_notify_relative_motion (device->device,
-                                                       g_get_monotonic_time (),
-                                                       dx, dy);
+  if (device->absolute_motion.pending)
+    flush_device_motion (device);
+
+  if (!device->relative_motion.pending)
+    {
+      device->relative_motion.pending = TRUE;
+      device->relative_motion.dx = 0.0;
+      device->relative_motion.dy = 0.0;
+    }
+
+  device->relative_motion.dx += dx;
+  device->relative_motion.dy += dy;
 }
 
 static MetaEisViewport *
@@ -425,9 +471,12 @@ handle_motion_absolute (MetaEisClient    *client,
   if (!meta_eis_viewport_transform_coordinate (viewport, x, y, &x, &y))
     return;
 
-  clutter_virtual_input_device_notify_absolute_motion (device->device,
-                                                       g_get_monotonic_time (),
-                                                       x, y);
+  if (device->relative_motion.pending)
+    flush_device_motion (device);
+
+  device->absolute_motion.pending = TRUE;
+  device->absolute_motion.x = x;
+  device->absolute_motion.y = y;
 }
 
 static void
@@ -678,6 +727,17 @@ add_abs_pointer_devices (MetaEisClient *client)
     propagate_device (shared_device);
 }
 
+void
+meta_eis_client_flush_events (MetaEisClient *client)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, client->eis_devices);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    flush_device_motion (value);
+}
+
 gboolean
 meta_eis_client_process_event (MetaEisClient    *client,
                                struct eis_event *event)
@@ -685,6 +745,18 @@ meta_eis_client_process_event (MetaEisClient    *client,
   enum eis_event_type type = eis_event_get_type (event);
   struct eis_seat *eis_seat;
 
+  /* Coalesced motion must not be reordered with any other event. */
+  switch (type)
+    {
+    case EIS_EVENT_POINTER_MOTION:
+    case EIS_EVENT_POINTER_MOTION_ABSOLUTE:
+    case EIS_EVENT_FRAME:
+      break;
+    default:
+      meta_eis_client_flush_events (client);
+      break;
+    }
+
   switch (type)
     {
     case EIS_EVENT_SEAT_BIND:
@@ -744,7 +816,7 @@ meta_eis_client_process_event (MetaEisClient    *client,
       handle_key (client, event);
       break;
     case EIS_EVENT_FRAME:
-      /* FIXME: we should be accumulating the above events */
+      /* Motion is flushed once all pending events have been processed */
       break;
     case EIS_EVENT_DEVICE_START_EMULATING:
       break;
@@ -36,3 +36,5 @@ MetaEisClient *meta_eis_client_new (MetaEis           *eis,
 
 gboolean meta_eis_client_process_event (MetaEisClient    *client,
                                         struct eis_event *eis_event);
+
+void meta_eis_client_flush_events (MetaEisClient *client);
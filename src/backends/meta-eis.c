@@ -122,12 +122,18 @@ static void
 process_events (MetaEis *eis)
 {
   struct eis_event *e;
+  GHashTableIter iter;
+  gpointer value;
 
   while ((e = eis_get_event (eis->eis)))
     {
       process_event (eis, e);
       eis_event_unref (e);
     }
+
+  g_hash_table_iter_init (&iter, eis->eis_clients);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    meta_eis_client_flush_events (value);
 }
 
 static MetaEventSource *
@@ -34,7 +34,7 @@ typedef struct
   GDestroyNotify            notify;
   guint64                   timeout_msec;
   int                       idle_source_id;
-  GSource                  *timeout_source;
+  uint64_t                  fired_idle_period;
 } MetaIdleMonitorWatch;
 
 struct _MetaIdleMonitorClass
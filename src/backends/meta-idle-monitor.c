@@ -59,6 +59,17 @@ struct _MetaIdleMonitor
   GHashTable *watches;
   ClutterInputDevice *device;
   int64_t last_event_time;
+
+  /* Idle watches sorted by timeout. They all count from the same
+   * last_event_time, so they expire in this order, and a single source
+   * only ever needs to wait for the first one that has not fired yet.
+   * Input activity starts a new idle period, which re-arms every watch
+   * at once without touching them. */
+  GPtrArray *idle_watches;
+  uint64_t idle_period;
+  GSource *timeout_source;
+
+  unsigned int n_user_active_watches;
 };
 
 G_DEFINE_TYPE (MetaIdleMonitor, meta_idle_monitor, G_TYPE_OBJECT)
@@ -93,6 +104,12 @@ meta_idle_monitor_dispose (GObject *object)
   MetaIdleMonitor *monitor = META_IDLE_MONITOR (object);
 
   g_clear_pointer (&monitor->watches, g_hash_table_destroy);
+  g_clear_pointer (&monitor->idle_watches, g_ptr_array_unref);
+  if (monitor->timeout_source)
+    {
+      g_source_destroy (monitor->timeout_source);
+      g_clear_pointer (&monitor->timeout_source, g_source_unref);
+    }
   g_clear_object (&monitor->session_proxy);
 
   G_OBJECT_CLASS (meta_idle_monitor_parent_class)->dispose (object);
@@ -170,34 +187,60 @@ free_watch (gpointer data)
   if (watch->notify != NULL)
     watch->notify (watch->user_data);
 
-  if (watch->timeout_source != NULL)
-    g_source_destroy (watch->timeout_source);
+  if (watch->timeout_msec == 0)
+    monitor->n_user_active_watches--;
+  else if (monitor->idle_watches)
+    g_ptr_array_remove (monitor->idle_watches, watch);
 
   g_object_unref (monitor);
   g_free (watch);
 }
 
-static void
-update_inhibited_watch (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
+static MetaIdleMonitorWatch *
+get_next_idle_watch (MetaIdleMonitor *monitor)
 {
-  MetaIdleMonitor *monitor = user_data;
-  MetaIdleMonitorWatch *watch = value;
+  unsigned int i;
 
-  if (!watch->timeout_source)
-    return;
+  for (i = 0; i < monitor->idle_watches->len; i++)
+    {
+      MetaIdleMonitorWatch *watch = g_ptr_array_index (monitor->idle_watches, i);
+
+      if (watch->fired_idle_period != monitor->idle_period)
+        return watch;
+    }
+
+  return NULL;
+}
+
+static void
+update_timeout (MetaIdleMonitor *monitor)
+{
+  MetaIdleMonitorWatch *watch;
 
   if (monitor->inhibited)
     {
-      g_source_set_ready_time (watch->timeout_source, -1);
+      g_source_set_ready_time (monitor->timeout_source, -1);
+      return;
     }
-  else
+
+  watch = get_next_idle_watch (monitor);
+  if (watch)
     {
-      g_source_set_ready_time (watch->timeout_source,
+      g_source_set_ready_time (monitor->timeout_source,
                                monitor->last_event_time +
                                watch->timeout_msec * 1000);
     }
+  else
+    {
+      g_source_set_ready_time (monitor->timeout_source, -1);
+    }
+}
+
+static void
+start_idle_period (MetaIdleMonitor *monitor)
+{
+  monitor->last_event_time = g_get_monotonic_time ();
+  monitor->idle_period++;
 }
 
 static void
@@ -209,9 +252,7 @@ update_inhibited (MetaIdleMonitor *monitor,
 
   monitor->inhibited = inhibited;
 
-  g_hash_table_foreach (monitor->watches,
-                        update_inhibited_watch,
-                        monitor);
+  update_timeout (monitor);
 }
 
 static void
@@ -232,19 +273,72 @@ meta_idle_monitor_inhibited_actions_changed (GDBusProxy  *session,
       g_variant_unref (v);
 
       if (!inhibited)
-        monitor->last_event_time = g_get_monotonic_time ();
+        start_idle_period (monitor);
       update_inhibited (monitor, inhibited);
     }
 }
 
+static gboolean
+idle_monitor_dispatch_timeout (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaIdleMonitor *monitor = META_IDLE_MONITOR (user_data);
+  int64_t now;
+  int64_t ready_time;
+
+  now = g_source_get_time (source);
+  ready_time = g_source_get_ready_time (source);
+  if (ready_time > now)
+    return G_SOURCE_CONTINUE;
+
+  g_object_ref (monitor);
+
+  /* Callbacks may add or remove watches, or reset the idle time, so look
+   * for the next expired watch again after each of them. */
+  while (monitor->idle_watches && !monitor->inhibited)
+    {
+      MetaIdleMonitorWatch *watch;
+
+      watch = get_next_idle_watch (monitor);
+      if (!watch ||
+          monitor->last_event_time + watch->timeout_msec * 1000 > now)
+        break;
+
+      watch->fired_idle_period = monitor->idle_period;
+      meta_idle_monitor_watch_fire (watch);
+    }
+
+  if (monitor->timeout_source)
+    update_timeout (monitor);
+
+  g_object_unref (monitor);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs idle_monitor_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = idle_monitor_dispatch_timeout,
+  .finalize = NULL,
+};
+
 static void
 meta_idle_monitor_init (MetaIdleMonitor *monitor)
 {
   GVariant *v;
 
   monitor->watches = g_hash_table_new_full (NULL, NULL, NULL, free_watch);
+  monitor->idle_watches = g_ptr_array_new ();
   monitor->last_event_time = g_get_monotonic_time ();
 
+  monitor->timeout_source = g_source_new (&idle_monitor_source_funcs,
+                                          sizeof (GSource));
+  g_source_set_name (monitor->timeout_source, "[mutter] Idle monitor");
+  g_source_set_callback (monitor->timeout_source, NULL, monitor, NULL);
+  g_source_attach (monitor->timeout_source, NULL);
+
   /* Monitor inhibitors */
   monitor->session_proxy =
     g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
@@ -283,34 +377,6 @@ get_next_watch_serial (void)
   return serial;
 }
 
-static gboolean
-idle_monitor_dispatch_timeout (GSource     *source,
-                               GSourceFunc  callback,
-                               gpointer     user_data)
-{
-  MetaIdleMonitorWatch *watch = (MetaIdleMonitorWatch *) user_data;
-  int64_t now;
-  int64_t ready_time;
-
-  now = g_source_get_time (source);
-  ready_time = g_source_get_ready_time (source);
-  if (ready_time > now)
-    return G_SOURCE_CONTINUE;
-
-  g_source_set_ready_time (watch->timeout_source, -1);
-
-  meta_idle_monitor_watch_fire (watch);
-
-  return G_SOURCE_CONTINUE;
-}
-
-static GSourceFuncs idle_monitor_source_funcs = {
-  .prepare = NULL,
-  .check = NULL,
-  .dispatch = idle_monitor_dispatch_timeout,
-  .finalize = NULL,
-};
-
 static MetaIdleMonitorWatch *
 make_watch (MetaIdleMonitor           *monitor,
             guint64                    timeout_msec,
@@ -331,21 +397,24 @@ make_watch (MetaIdleMonitor           *monitor,
 
   if (timeout_msec != 0)
     {
-      GSource *source = g_source_new (&idle_monitor_source_funcs,
-                                      sizeof (GSource));
-      g_source_set_name (source, "[mutter] Idle monitor");
+      unsigned int i;
 
-      g_source_set_callback (source, NULL, watch, NULL);
-      if (!monitor->inhibited)
+      for (i = 0; i < monitor->idle_watches->len; i++)
         {
-          g_source_set_ready_time (source,
-                                   monitor->last_event_time +
-                                   timeout_msec * 1000);
+          MetaIdleMonitorWatch *other =
+            g_ptr_array_index (monitor->idle_watches, i);
+
+          if (other->timeout_msec > timeout_msec)
+            break;
         }
-      g_source_attach (source, NULL);
-      g_source_unref (source);
 
-      watch->timeout_source = source;
+      watch->fired_idle_period = monitor->idle_period - 1;
+      g_ptr_array_insert (monitor->idle_watches, i, watch);
+      update_timeout (monitor);
+    }
+  else
+    {
+      monitor->n_user_active_watches++;
     }
 
   g_hash_table_insert (monitor->watches,
@@ -470,7 +539,11 @@ meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
 {
   GList *node, *watch_ids;
 
-  monitor->last_event_time = g_get_monotonic_time ();
+  start_idle_period (monitor);
+  update_timeout (monitor);
+
+  if (monitor->n_user_active_watches == 0)
+    return;
 
   watch_ids = g_hash_table_get_keys (monitor->watches);
 
@@ -485,22 +558,7 @@ meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
         continue;
 
       if (watch->timeout_msec == 0)
-        {
-          meta_idle_monitor_watch_fire (watch);
-        }
-      else
-        {
-          if (monitor->inhibited)
-            {
-              g_source_set_ready_time (watch->timeout_source, -1);
-            }
-          else
-            {
-              g_source_set_ready_time (watch->timeout_source,
-                                       monitor->last_event_time +
-                                       watch->timeout_msec * 1000);
-            }
-        }
+        meta_idle_monitor_watch_fire (watch);
     }
 
   g_list_free (watch_ids);
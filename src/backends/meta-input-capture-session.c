@@ -24,6 +24,7 @@
 #include <libeis.h>
 #include <stdint.h>
 
+#include "backends/meta-backend-private.h"
 #include "backends/meta-dbus-session-watcher.h"
 #include "backends/meta-dbus-session-manager.h"
 #include "backends/meta-fd-source.h"
@@ -231,9 +232,8 @@ ensure_xkb_keymap_file (MetaInputCaptureSession  *session,
 {
   MetaBackend *backend =
     meta_dbus_session_manager_get_backend (session->session_manager);
+  MetaKeymapCache *keymap_cache = meta_backend_get_keymap_cache (backend);
   struct xkb_keymap *keymap;
-  g_autofree char *keymap_string = NULL;
-  size_t keymap_size;
 
   if (session->keymap_file)
     return session->keymap_file;
@@ -246,11 +246,13 @@ ensure_xkb_keymap_file (MetaInputCaptureSession  *session,
       return NULL;
     }
 
-  keymap_string = xkb_keymap_get_as_string (keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
-  keymap_size = strlen (keymap_string) + 1;
-
-  session->keymap_file =
-    meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
+  session->keymap_file = meta_keymap_cache_get_file (keymap_cache, keymap);
+  if (!session->keymap_file)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create keymap file");
+      return NULL;
+    }
 
   return session->keymap_file;
 }
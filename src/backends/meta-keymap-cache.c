@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compiling a keymap from RMLVO names means resolving the rules and
+ * parsing a good part of the xkb data, which takes long enough to be
+ * noticeable with several layouts. The cache keeps the recently used
+ * keymaps together with their serialized form and the read-only file
+ * handed to clients, so that the seat, the Wayland keyboard and the
+ * other keymap consumers share a single compilation and a single file.
+ *
+ * The serialized keymaps are also written to disk, named after a digest
+ * of the names and of the modification times of the xkb data
+ * directories, and compiled from that on later sessions, which skips
+ * the rules resolution altogether.
+ *
+ * The cache must only be used from the main thread. Keymaps for other
+ * threads are compiled separately with meta_keymap_cache_compile_keymap(),
+ * since xkb keymaps and contexts are not thread safe.
+ */
+
+#include "config.h"
+
+#include "backends/meta-keymap-cache.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "backends/meta-keymap-utils.h"
+#include "meta/meta-debug.h"
+#include "meta/util.h"
+
+#define MAX_CACHED_KEYMAPS 8
+
+typedef struct _MetaKeymapCacheEntry
+{
+  /* NULL for keymaps that were not compiled from names by the cache */
+  char *key;
+
+  struct xkb_keymap *keymap;
+  char *string;
+  MetaAnonymousFile *file;
+} MetaKeymapCacheEntry;
+
+struct _MetaKeymapCache
+{
+  GObject parent;
+
+  char *cache_dir;
+  struct xkb_context *xkb_context;
+
+  /* Most recently used first */
+  GQueue entries;
+};
+
+G_DEFINE_FINAL_TYPE (MetaKeymapCache, meta_keymap_cache, G_TYPE_OBJECT)
+
+static const char * const xkb_data_dirs[] = {
+  "rules", "keycodes", "types", "compat", "symbols",
+};
+
+static const char * const xkb_default_env_vars[] = {
+  "XKB_DEFAULT_RULES", "XKB_DEFAULT_MODEL", "XKB_DEFAULT_LAYOUT",
+  "XKB_DEFAULT_VARIANT", "XKB_DEFAULT_OPTIONS",
+};
+
+static void
+meta_keymap_cache_entry_free (MetaKeymapCacheEntry *entry)
+{
+  g_free (entry->key);
+  xkb_keymap_unref (entry->keymap);
+  g_free (entry->string);
+  g_clear_pointer (&entry->file, meta_anonymous_file_free);
+  g_free (entry);
+}
+
+static void
+checksum_update_name (GChecksum  *checksum,
+                      const char *name)
+{
+  /* NULL and empty names pick different defaults */
+  if (name)
+    g_checksum_update (checksum, (const guchar *) name, strlen (name) + 1);
+  else
+    g_checksum_update (checksum, (const guchar *) "-", 1);
+}
+
+/*
+ * Packages replace the xkb data files rather than modifying them, which
+ * updates the modification time of their directory.
+ */
+static void
+checksum_update_xkb_data (GChecksum          *checksum,
+                          struct xkb_context *xkb_context)
+{
+  unsigned int n_include_paths;
+  unsigned int i;
+  size_t j;
+
+  n_include_paths = xkb_context_num_include_paths (xkb_context);
+  for (i = 0; i < n_include_paths; i++)
+    {
+      const char *include_path =
+        xkb_context_include_path_get (xkb_context, i);
+
+      checksum_update_name (checksum, include_path);
+
+      for (j = 0; j < G_N_ELEMENTS (xkb_data_dirs); j++)
+        {
+          g_autofree char *path = NULL;
+          g_autofree char *stamp = NULL;
+          GStatBuf stat_buf;
+
+          path = g_build_filename (include_path, xkb_data_dirs[j], NULL);
+          if (g_stat (path, &stat_buf) != 0)
+            continue;
+
+          stamp = g_strdup_printf ("%s:%" G_GINT64_FORMAT ".%ld",
+                                   xkb_data_dirs[j],
+                                   (int64_t) stat_buf.st_mtim.tv_sec,
+                                   stat_buf.st_mtim.tv_nsec);
+          checksum_update_name (checksum, stamp);
+        }
+    }
+}
+
+static char *
+compute_key (MetaKeymapCache             *cache,
+             const struct xkb_rule_names *names)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+  size_t i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  checksum_update_name (checksum, names->rules);
+  checksum_update_name (checksum, names->model);
+  checksum_update_name (checksum, names->layout);
+  checksum_update_name (checksum, names->variant);
+  checksum_update_name (checksum, names->options);
+
+  for (i = 0; i < G_N_ELEMENTS (xkb_default_env_vars); i++)
+    checksum_update_name (checksum, g_getenv (xkb_default_env_vars[i]));
+
+  checksum_update_xkb_data (checksum, cache->xkb_context);
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+static void
+add_entry (MetaKeymapCache      *cache,
+           MetaKeymapCacheEntry *entry)
+{
+  g_queue_push_head (&cache->entries, entry);
+
+  while (cache->entries.length > MAX_CACHED_KEYMAPS)
+    meta_keymap_cache_entry_free (g_queue_pop_tail (&cache->entries));
+}
+
+static MetaKeymapCacheEntry *
+use_entry (MetaKeymapCache *cache,
+           GList           *l)
+{
+  g_queue_unlink (&cache->entries, l);
+  g_queue_push_head_link (&cache->entries, l);
+
+  return l->data;
+}
+
+static MetaKeymapCacheEntry *
+find_entry_for_key (MetaKeymapCache *cache,
+                    const char      *key)
+{
+  GList *l;
+
+  for (l = cache->entries.head; l; l = l->next)
+    {
+      MetaKeymapCacheEntry *entry = l->data;
+
+      if (g_strcmp0 (entry->key, key) == 0)
+        return use_entry (cache, l);
+    }
+
+  return NULL;
+}
+
+static MetaKeymapCacheEntry *
+ensure_entry_for_keymap (MetaKeymapCache   *cache,
+                         struct xkb_keymap *keymap)
+{
+  MetaKeymapCacheEntry *entry;
+  char *string;
+  GList *l;
+
+  for (l = cache->entries.head; l; l = l->next)
+    {
+      entry = l->data;
+
+      if (entry->keymap == keymap)
+        return use_entry (cache, l);
+    }
+
+  string = xkb_keymap_get_as_string (keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+  if (!string)
+    return NULL;
+
+  entry = g_new0 (MetaKeymapCacheEntry, 1);
+  entry->keymap = xkb_keymap_ref (keymap);
+  entry->string = g_strdup (string);
+  free (string);
+
+  add_entry (cache, entry);
+
+  return entry;
+}
+
+static char *
+load_keymap_string (MetaKeymapCache *cache,
+                    const char      *key)
+{
+  g_autofree char *path = NULL;
+  g_autoptr (GError) error = NULL;
+  char *string;
+
+  path = g_build_filename (cache->cache_dir, key, NULL);
+  if (!g_file_get_contents (path, &string, NULL, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        {
+          meta_topic (META_DEBUG_INPUT,
+                      "Failed to read cached keymap: %s", error->message);
+        }
+      return NULL;
+    }
+
+  return string;
+}
+
+static void
+save_keymap_string (MetaKeymapCache *cache,
+                    const char      *key,
+                    const char      *string)
+{
+  g_autofree char *path = NULL;
+  g_autoptr (GError) error = NULL;
+
+  if (g_mkdir_with_parents (cache->cache_dir, 0700) != 0)
+    {
+      meta_topic (META_DEBUG_INPUT,
+                  "Failed to create keymap cache directory '%s': %s",
+                  cache->cache_dir, g_strerror (errno));
+      return;
+    }
+
+  path = g_build_filename (cache->cache_dir, key, NULL);
+  if (!g_file_set_contents (path, string, -1, &error))
+    {
+      meta_topic (META_DEBUG_INPUT,
+                  "Failed to write cached keymap: %s", error->message);
+    }
+}
+
+/**
+ * meta_keymap_cache_get_keymap:
+ * @cache: A #MetaKeymapCache
+ * @names: The RMLVO names of the keymap
+ *
+ * Returns: (transfer full) (nullable): The keymap compiled from @names,
+ *   shared with the other main thread users, or %NULL if it could not be
+ *   compiled
+ */
+struct xkb_keymap *
+meta_keymap_cache_get_keymap (MetaKeymapCache             *cache,
+                              const struct xkb_rule_names *names)
+{
+  MetaKeymapCacheEntry *entry;
+  g_autofree char *key = NULL;
+  struct xkb_keymap *keymap = NULL;
+  char *string;
+
+  key = compute_key (cache, names);
+
+  entry = find_entry_for_key (cache, key);
+  if (entry)
+    return xkb_keymap_ref (entry->keymap);
+
+  string = load_keymap_string (cache, key);
+  if (string)
+    {
+      keymap = xkb_keymap_new_from_string (cache->xkb_context, string,
+                                           XKB_KEYMAP_FORMAT_TEXT_V1,
+                                           XKB_KEYMAP_COMPILE_NO_FLAGS);
+      if (!keymap)
+        {
+          meta_topic (META_DEBUG_INPUT,
+                      "Discarding invalid cached keymap %s", key);
+          g_clear_pointer (&string, g_free);
+        }
+    }
+
+  if (!keymap)
+    {
+      char *xkb_string;
+
+      keymap = xkb_keymap_new_from_names (cache->xkb_context, names,
+                                          XKB_KEYMAP_COMPILE_NO_FLAGS);
+      if (!keymap)
+        return NULL;
+
+      xkb_string = xkb_keymap_get_as_string (keymap,
+                                             XKB_KEYMAP_FORMAT_TEXT_V1);
+      if (!xkb_string)
+        return keymap;
+
+      string = g_strdup (xkb_string);
+      free (xkb_string);
+
+      save_keymap_string (cache, key, string);
+    }
+
+  entry = g_new0 (MetaKeymapCacheEntry, 1);
+  entry->key = g_steal_pointer (&key);
+  entry->keymap = xkb_keymap_ref (keymap);
+  entry->string = string;
+  add_entry (cache, entry);
+
+  return keymap;
+}
+
+/**
+ * meta_keymap_cache_compile_keymap:
+ * @cache: A #MetaKeymapCache
+ * @keymap: A keymap
+ *
+ * Compiles a separate copy of @keymap from its serialized form, for use
+ * outside of the main thread.
+ *
+ * Returns: (transfer full) (nullable): The new keymap
+ */
+struct xkb_keymap *
+meta_keymap_cache_compile_keymap (MetaKeymapCache   *cache,
+                                  struct xkb_keymap *keymap)
+{
+  MetaKeymapCacheEntry *entry;
+  struct xkb_context *xkb_context;
+  struct xkb_keymap *copy;
+
+  entry = ensure_entry_for_keymap (cache, keymap);
+  if (!entry)
+    return NULL;
+
+  xkb_context = meta_create_xkb_context ();
+  copy = xkb_keymap_new_from_string (xkb_context, entry->string,
+                                     XKB_KEYMAP_FORMAT_TEXT_V1,
+                                     XKB_KEYMAP_COMPILE_NO_FLAGS);
+  xkb_context_unref (xkb_context);
+
+  return copy;
+}
+
+/**
+ * meta_keymap_cache_get_file:
+ * @cache: A #MetaKeymapCache
+ * @keymap: A keymap
+ *
+ * Returns: (transfer full) (nullable): A read-only file holding @keymap
+ *   serialized as a NUL-terminated string, shared by everyone asking for
+ *   the same keymap. Release it with meta_anonymous_file_free().
+ */
+MetaAnonymousFile *
+meta_keymap_cache_get_file (MetaKeymapCache   *cache,
+                            struct xkb_keymap *keymap)
+{
+  MetaKeymapCacheEntry *entry;
+
+  entry = ensure_entry_for_keymap (cache, keymap);
+  if (!entry)
+    return NULL;
+
+  if (!entry->file)
+    {
+      entry->file = meta_anonymous_file_new (strlen (entry->string) + 1,
+                                             (const uint8_t *) entry->string);
+      if (!entry->file)
+        return NULL;
+    }
+
+  return meta_anonymous_file_ref (entry->file);
+}
+
+/**
+ * meta_keymap_cache_trim:
+ * @cache: a #MetaKeymapCache
+ *
+ * Drops every cached keymap but the most recently used one. Keymaps and
+ * files still held by their users stay alive until released.
+ *
+ * Returns: the size of the serialized keymaps that were dropped
+ */
+size_t
+meta_keymap_cache_trim (MetaKeymapCache *cache)
+{
+  size_t n_bytes = 0;
+
+  while (cache->entries.length > 1)
+    {
+      MetaKeymapCacheEntry *entry = g_queue_pop_tail (&cache->entries);
+
+      n_bytes += strlen (entry->string) + 1;
+      meta_keymap_cache_entry_free (entry);
+    }
+
+  return n_bytes;
+}
+
+static void
+meta_keymap_cache_finalize (GObject *object)
+{
+  MetaKeymapCache *cache = META_KEYMAP_CACHE (object);
+
+  g_queue_clear_full (&cache->entries,
+                      (GDestroyNotify) meta_keymap_cache_entry_free);
+  g_clear_pointer (&cache->xkb_context, xkb_context_unref);
+  g_free (cache->cache_dir);
+
+  G_OBJECT_CLASS (meta_keymap_cache_parent_class)->finalize (object);
+}
+
+static void
+meta_keymap_cache_class_init (MetaKeymapCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_keymap_cache_finalize;
+}
+
+static void
+meta_keymap_cache_init (MetaKeymapCache *cache)
+{
+  g_queue_init (&cache->entries);
+}
+
+MetaKeymapCache *
+meta_keymap_cache_new (const char *cache_dir)
+{
+  MetaKeymapCache *cache;
+
+  cache = g_object_new (META_TYPE_KEYMAP_CACHE, NULL);
+  cache->cache_dir = g_strdup (cache_dir);
+  cache->xkb_context = meta_create_xkb_context ();
+
+  return cache;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include <xkbcommon/xkbcommon.h>
+
+#include "core/meta-anonymous-file.h"
+
+#define META_TYPE_KEYMAP_CACHE (meta_keymap_cache_get_type ())
+G_DECLARE_FINAL_TYPE (MetaKeymapCache, meta_keymap_cache,
+                      META, KEYMAP_CACHE, GObject)
+
+MetaKeymapCache * meta_keymap_cache_new (const char *cache_dir);
+
+struct xkb_keymap * meta_keymap_cache_get_keymap (MetaKeymapCache             *cache,
+                                                  const struct xkb_rule_names *names);
+
+struct xkb_keymap * meta_keymap_cache_compile_keymap (MetaKeymapCache   *cache,
+                                                      struct xkb_keymap *keymap);
+
+MetaAnonymousFile * meta_keymap_cache_get_file (MetaKeymapCache   *cache,
+                                                struct xkb_keymap *keymap);
+
+size_t meta_keymap_cache_trim (MetaKeymapCache *cache);
@@ -47,6 +47,7 @@
 typedef struct _MetaLogicalMonitorPrivate
 {
   MetaLogicalMonitorId *id;
+  char *sync_group;
 } MetaLogicalMonitorPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaLogicalMonitor,
@@ -79,9 +80,11 @@ meta_logical_monitor_new (MetaMonitorManager       *monitor_manager,
                           int                       monitor_number)
 {
   MetaLogicalMonitor *logical_monitor;
+  MetaLogicalMonitorPrivate *priv;
   GList *monitor_configs;
 
   logical_monitor = g_object_new (META_TYPE_LOGICAL_MONITOR, NULL);
+  priv = meta_logical_monitor_get_instance_private (logical_monitor);
 
   monitor_configs = logical_monitor_config->monitor_configs;
 
@@ -90,6 +93,7 @@ meta_logical_monitor_new (MetaMonitorManager       *monitor_manager,
   logical_monitor->transform = logical_monitor_config->transform;
   logical_monitor->in_fullscreen = -1;
   logical_monitor->rect = logical_monitor_config->layout;
+  priv->sync_group = g_strdup (logical_monitor_config->sync_group);
 
   logical_monitor->is_presentation = TRUE;
   g_list_foreach (monitor_configs, (GFunc) add_monitor_from_config,
@@ -304,6 +308,7 @@ meta_logical_monitor_dispose (GObject *object)
     }
 
   g_clear_pointer (&priv->id, meta_logical_monitor_id_free);
+  g_clear_pointer (&priv->sync_group, g_free);
 
   G_OBJECT_CLASS (meta_logical_monitor_parent_class)->dispose (object);
 }
@@ -392,3 +397,19 @@ meta_logical_monitor_dup_id (MetaLogicalMonitor *logical_monitor)
 
   return meta_logical_monitor_id_dup (priv->id);
 }
+
+/**
+ * meta_logical_monitor_get_sync_group:
+ * @logical_monitor: a #MetaLogicalMonitor
+ *
+ * Returns: (nullable): the name of the group of logical monitors whose
+ *   frames are presented in lockstep, as configured in monitors.xml
+ */
+const char *
+meta_logical_monitor_get_sync_group (MetaLogicalMonitor *logical_monitor)
+{
+  MetaLogicalMonitorPrivate *priv =
+    meta_logical_monitor_get_instance_private (logical_monitor);
+
+  return priv->sync_group;
+}
@@ -103,3 +103,5 @@ gboolean meta_logical_monitor_id_equal (const MetaLogicalMonitorId *id,
 const MetaLogicalMonitorId * meta_logical_monitor_get_id (MetaLogicalMonitor *logical_monitor);
 
 MetaLogicalMonitorId * meta_logical_monitor_dup_id (MetaLogicalMonitor *logical_monitor);
+
+const char * meta_logical_monitor_get_sync_group (MetaLogicalMonitor *logical_monitor);
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Caches that keep memory around only to avoid re-creating things later
+ * register a trimmer here. When the system runs low on memory, as
+ * reported by GMemoryMonitor (which watches the kernel pressure stall
+ * information, or the portal inside a sandbox), every trimmer is asked
+ * to free what it can, and the heap is handed back to the kernel, so
+ * that the compositor shrinks before the OOM killer picks a victim.
+ */
+
+#include "config.h"
+
+#include "backends/meta-memory-pressure.h"
+
+#ifdef HAVE_MALLOC_TRIM
+#include <malloc.h>
+#endif
+
+#include "meta/meta-debug.h"
+#include "meta/util.h"
+
+typedef struct _MetaMemoryTrimmer
+{
+  unsigned int id;
+  char *name;
+  MetaMemoryTrimFunc func;
+  gpointer user_data;
+} MetaMemoryTrimmer;
+
+struct _MetaMemoryPressure
+{
+  GObject parent;
+
+  GMemoryMonitor *memory_monitor;
+
+  GPtrArray *trimmers;
+  unsigned int last_trimmer_id;
+};
+
+G_DEFINE_FINAL_TYPE (MetaMemoryPressure, meta_memory_pressure, G_TYPE_OBJECT)
+
+static void
+meta_memory_trimmer_free (MetaMemoryTrimmer *trimmer)
+{
+  g_free (trimmer->name);
+  g_free (trimmer);
+}
+
+static void
+on_low_memory_warning (GMemoryMonitor             *memory_monitor,
+                       GMemoryMonitorWarningLevel  level,
+                       MetaMemoryPressure         *pressure)
+{
+  size_t n_bytes;
+
+  n_bytes = meta_memory_pressure_trim (pressure, NULL);
+
+  meta_topic (META_DEBUG_BACKEND,
+              "Trimmed caches on low memory warning (level %d), "
+              "%zu bytes freed",
+              level, n_bytes);
+}
+
+/**
+ * meta_memory_pressure_add_trimmer:
+ * @pressure: a #MetaMemoryPressure
+ * @name: name of the cache, used in reports
+ * @func: function freeing the memory the cache can do without
+ * @user_data: data passed to @func
+ *
+ * Returns: an id to pass to meta_memory_pressure_remove_trimmer() before
+ *   @user_data goes away
+ */
+unsigned int
+meta_memory_pressure_add_trimmer (MetaMemoryPressure *pressure,
+                                  const char         *name,
+                                  MetaMemoryTrimFunc  func,
+                                  gpointer            user_data)
+{
+  MetaMemoryTrimmer *trimmer;
+
+  trimmer = g_new0 (MetaMemoryTrimmer, 1);
+  trimmer->id = ++pressure->last_trimmer_id;
+  trimmer->name = g_strdup (name);
+  trimmer->func = func;
+  trimmer->user_data = user_data;
+  g_ptr_array_add (pressure->trimmers, trimmer);
+
+  return trimmer->id;
+}
+
+void
+meta_memory_pressure_remove_trimmer (MetaMemoryPressure *pressure,
+                                     unsigned int        trimmer_id)
+{
+  unsigned int i;
+
+  for (i = 0; i < pressure->trimmers->len; i++)
+    {
+      MetaMemoryTrimmer *trimmer = g_ptr_array_index (pressure->trimmers, i);
+
+      if (trimmer->id == trimmer_id)
+        {
+          g_ptr_array_remove_index (pressure->trimmers, i);
+          return;
+        }
+    }
+
+  g_warn_if_reached ();
+}
+
+/**
+ * meta_memory_pressure_trim:
+ * @pressure: a #MetaMemoryPressure
+ * @report: (nullable): an "a{st}" builder to add the bytes freed by each
+ *   cache to
+ *
+ * Asks every registered cache to free what it can, and returns as much
+ * of the heap as possible to the kernel.
+ *
+ * Returns: the total number of bytes the caches freed
+ */
+size_t
+meta_memory_pressure_trim (MetaMemoryPressure *pressure,
+                           GVariantBuilder    *report)
+{
+  size_t total = 0;
+  unsigned int i;
+
+  for (i = 0; i < pressure->trimmers->len; i++)
+    {
+      MetaMemoryTrimmer *trimmer = g_ptr_array_index (pressure->trimmers, i);
+      size_t n_bytes;
+
+      n_bytes = trimmer->func (trimmer->user_data);
+
+      meta_topic (META_DEBUG_BACKEND, "Trimmed %zu bytes from %s",
+                  n_bytes, trimmer->name);
+
+      if (report)
+        g_variant_builder_add (report, "{st}", trimmer->name, (uint64_t) n_bytes);
+
+      total += n_bytes;
+    }
+
+#ifdef HAVE_MALLOC_TRIM
+  malloc_trim (0);
+#endif
+
+  return total;
+}
+
+MetaMemoryPressure *
+meta_memory_pressure_new (void)
+{
+  return g_object_new (META_TYPE_MEMORY_PRESSURE, NULL);
+}
+
+static void
+meta_memory_pressure_dispose (GObject *object)
+{
+  MetaMemoryPressure *pressure = META_MEMORY_PRESSURE (object);
+
+  if (pressure->memory_monitor)
+    {
+      g_signal_handlers_disconnect_by_func (pressure->memory_monitor,
+                                            on_low_memory_warning,
+                                            pressure);
+      g_clear_object (&pressure->memory_monitor);
+    }
+
+  G_OBJECT_CLASS (meta_memory_pressure_parent_class)->dispose (object);
+}
+
+static void
+meta_memory_pressure_finalize (GObject *object)
+{
+  MetaMemoryPressure *pressure = META_MEMORY_PRESSURE (object);
+
+  g_ptr_array_unref (pressure->trimmers);
+
+  G_OBJECT_CLASS (meta_memory_pressure_parent_class)->finalize (object);
+}
+
+static void
+meta_memory_pressure_class_init (MetaMemoryPressureClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = meta_memory_pressure_dispose;
+  object_class->finalize = meta_memory_pressure_finalize;
+}
+
+static void
+meta_memory_pressure_init (MetaMemoryPressure *pressure)
+{
+  pressure->trimmers =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) meta_memory_trimmer_free);
+
+  pressure->memory_monitor = g_memory_monitor_dup_default ();
+  g_signal_connect (pressure->memory_monitor, "low-memory-warning",
+                    G_CALLBACK (on_low_memory_warning), pressure);
+}
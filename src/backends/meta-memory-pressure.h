@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+/*
+ * Frees what the cache can re-create later, and returns the number of
+ * bytes that were freed.
+ */
+typedef size_t (* MetaMemoryTrimFunc) (gpointer user_data);
+
+#define META_TYPE_MEMORY_PRESSURE (meta_memory_pressure_get_type ())
+G_DECLARE_FINAL_TYPE (MetaMemoryPressure, meta_memory_pressure,
+                      META, MEMORY_PRESSURE, GObject)
+
+MetaMemoryPressure * meta_memory_pressure_new (void);
+
+unsigned int meta_memory_pressure_add_trimmer (MetaMemoryPressure *pressure,
+                                               const char         *name,
+                                               MetaMemoryTrimFunc  func,
+                                               gpointer            user_data);
+
+void meta_memory_pressure_remove_trimmer (MetaMemoryPressure *pressure,
+                                          unsigned int        trimmer_id);
+
+size_t meta_memory_pressure_trim (MetaMemoryPressure *pressure,
+                                  GVariantBuilder    *report);
@@ -1467,6 +1467,7 @@ meta_logical_monitor_config_free (MetaLogicalMonitorConfig *logical_monitor_conf
 {
   g_list_free_full (logical_monitor_config->monitor_configs,
                     (GDestroyNotify) meta_monitor_config_free);
+  g_free (logical_monitor_config->sync_group);
   g_free (logical_monitor_config);
 }
 
@@ -1528,17 +1529,17 @@ meta_monitors_config_key_hash (gconstpointer data)
 {
   const MetaMonitorsConfigKey *config_key = data;
   GList *l;
-  unsigned long hash;
+  unsigned int hash;
 
+  /* The monitor specs are sorted, so mix them in order; XOR-ing them
+   * made the same monitors plugged into swapped connectors, as is
+   * common with docking stations, all collide. */
   hash = config_key->layout_mode;
   for (l = config_key->monitor_specs; l; l = l->next)
     {
       MetaMonitorSpec *monitor_spec = l->data;
 
-      hash ^= (g_str_hash (monitor_spec->connector) ^
-               g_str_hash (monitor_spec->vendor) ^
-               g_str_hash (monitor_spec->product) ^
-               g_str_hash (monitor_spec->serial));
+      hash = hash * 31 + meta_monitor_spec_hash (monitor_spec);
     }
 
   return hash;
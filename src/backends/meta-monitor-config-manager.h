@@ -44,6 +44,7 @@ typedef struct _MetaLogicalMonitorConfig
   float scale;
   gboolean is_primary;
   gboolean is_presentation;
+  char *sync_group;
 } MetaLogicalMonitorConfig;
 
 typedef struct _MetaMonitorsConfigKey
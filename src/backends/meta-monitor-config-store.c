@@ -138,6 +138,7 @@ typedef enum
   STATE_LOGICAL_MONITOR_Y,
   STATE_LOGICAL_MONITOR_PRIMARY,
   STATE_LOGICAL_MONITOR_PRESENTATION,
+  STATE_LOGICAL_MONITOR_SYNC_GROUP,
   STATE_LOGICAL_MONITOR_SCALE,
   STATE_TRANSFORM,
   STATE_TRANSFORM_ROTATION,
@@ -371,6 +372,10 @@ handle_start_element (GMarkupParseContext  *context,
           {
             parser->state = STATE_LOGICAL_MONITOR_PRESENTATION;
           }
+        else if (g_str_equal (element_name, "syncgroup"))
+          {
+            parser->state = STATE_LOGICAL_MONITOR_SYNC_GROUP;
+          }
         else if (g_str_equal (element_name, "transform"))
           {
             parser->state = STATE_TRANSFORM;
@@ -396,6 +401,7 @@ handle_start_element (GMarkupParseContext  *context,
     case STATE_LOGICAL_MONITOR_SCALE:
     case STATE_LOGICAL_MONITOR_PRIMARY:
     case STATE_LOGICAL_MONITOR_PRESENTATION:
+    case STATE_LOGICAL_MONITOR_SYNC_GROUP:
       {
         g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_UNKNOWN_ELEMENT,
                      "Invalid logical monitor element '%s'", element_name);
@@ -1282,6 +1288,7 @@ handle_end_element (GMarkupParseContext  *context,
     case STATE_LOGICAL_MONITOR_SCALE:
     case STATE_LOGICAL_MONITOR_PRIMARY:
     case STATE_LOGICAL_MONITOR_PRESENTATION:
+    case STATE_LOGICAL_MONITOR_SYNC_GROUP:
       {
         parser->state = STATE_LOGICAL_MONITOR;
         return;
@@ -1848,6 +1855,14 @@ handle_text (GMarkupParseContext *context,
         return;
       }
 
+    case STATE_LOGICAL_MONITOR_SYNC_GROUP:
+      {
+        g_free (parser->current_logical_monitor_config->sync_group);
+        parser->current_logical_monitor_config->sync_group =
+          g_strndup (text, text_len);
+        return;
+      }
+
     case STATE_TRANSFORM_ROTATION:
       {
         if (text_equals (text, text_len, "normal"))
@@ -2268,6 +2283,14 @@ append_logical_monitor_xml (GString                  *buffer,
     g_string_append (buffer, "      <primary>yes</primary>\n");
   if (logical_monitor_config->is_presentation)
     g_string_append (buffer, "      <presentation>yes</presentation>\n");
+  if (logical_monitor_config->sync_group)
+    {
+      g_autofree char *escaped =
+        g_markup_escape_text (logical_monitor_config->sync_group, -1);
+
+      g_string_append_printf (buffer, "      <syncgroup>%s</syncgroup>\n",
+                              escaped);
+    }
   append_transform (buffer, logical_monitor_config->transform);
   append_monitors (buffer, logical_monitor_config->monitor_configs);
   g_string_append (buffer, "    </logicalmonitor>\n");
@@ -62,6 +62,8 @@ meta_logical_monitor_config_copy (MetaLogicalMonitorConfig *logical_monitor_conf
                sizeof (MetaLogicalMonitorConfig));
   new_logical_monitor_config->monitor_configs =
     meta_clone_monitor_config_list (logical_monitor_config->monitor_configs);
+  new_logical_monitor_config->sync_group =
+    g_strdup (logical_monitor_config->sync_group);
 
   return new_logical_monitor_config;
 }
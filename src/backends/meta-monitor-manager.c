@@ -120,6 +120,7 @@ typedef struct _MetaMonitorManagerPrivate
 
   guint reload_monitor_manager_id;
   guint switch_config_handle_id;
+  guint emit_monitors_changed_id;
 
   uint32_t backlight_serial;
 } MetaMonitorManagerPrivate;
@@ -1229,6 +1230,37 @@ update_has_external_monitor (MetaMonitorManager *monitor_manager)
                                                      has_external_monitor);
 }
 
+static void
+emit_dbus_monitors_changed (MetaMonitorManager *manager)
+{
+  MetaMonitorManagerPrivate *priv =
+    meta_monitor_manager_get_instance_private (manager);
+
+  priv->emit_monitors_changed_id = 0;
+
+  meta_dbus_display_config_emit_monitors_changed (manager->display_config);
+}
+
+/*
+ * Configuration changes often come in bursts, e.g. an applied config
+ * directly followed by privacy screen updates. Clients refetch the whole
+ * state for every MonitorsChanged, so emit it once the burst is over.
+ */
+static void
+queue_dbus_monitors_changed (MetaMonitorManager *manager)
+{
+  MetaMonitorManagerPrivate *priv =
+    meta_monitor_manager_get_instance_private (manager);
+
+  if (priv->emit_monitors_changed_id)
+    return;
+
+  priv->emit_monitors_changed_id =
+    g_idle_add_once ((GSourceOnceFunc) emit_dbus_monitors_changed, manager);
+  g_source_set_name_by_id (priv->emit_monitors_changed_id,
+                           "[mutter] emit_dbus_monitors_changed");
+}
+
 static void
 meta_monitor_manager_notify_monitors_changed (MetaMonitorManager *manager)
 {
@@ -1240,7 +1272,7 @@ meta_monitor_manager_notify_monitors_changed (MetaMonitorManager *manager)
   g_signal_emit (manager, signals[MONITORS_CHANGED_INTERNAL], 0);
   g_signal_emit (manager, signals[MONITORS_CHANGED], 0);
 
-  meta_dbus_display_config_emit_monitors_changed (manager->display_config);
+  queue_dbus_monitors_changed (manager);
 }
 
 void
@@ -1375,6 +1407,7 @@ meta_monitor_manager_dispose (GObject *object)
   g_clear_handle_id (&manager->restore_config_id, g_source_remove);
   g_clear_handle_id (&priv->switch_config_handle_id, g_source_remove);
   g_clear_handle_id (&priv->reload_monitor_manager_id, g_source_remove);
+  g_clear_handle_id (&priv->emit_monitors_changed_id, g_source_remove);
 
   G_OBJECT_CLASS (meta_monitor_manager_parent_class)->dispose (object);
 }
@@ -1641,7 +1674,7 @@ meta_monitor_manager_maybe_emit_privacy_screen_change (MetaMonitorManager *manag
         META_PRIVACY_SCREEN_ENABLED);
     }
 
-  meta_dbus_display_config_emit_monitors_changed (manager->display_config);
+  queue_dbus_monitors_changed (manager);
   manager->privacy_screen_change_state = META_PRIVACY_SCREEN_CHANGE_STATE_NONE;
 }
 
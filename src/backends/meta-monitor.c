@@ -118,11 +118,14 @@ guint
 meta_monitor_spec_hash (gconstpointer key)
 {
   const MetaMonitorSpec *monitor_spec = key;
+  unsigned int hash;
 
-  return (g_str_hash (monitor_spec->connector) +
-          g_str_hash (monitor_spec->vendor) +
-          g_str_hash (monitor_spec->product) +
-          g_str_hash (monitor_spec->serial));
+  hash = g_str_hash (monitor_spec->connector);
+  hash = hash * 31 + g_str_hash (monitor_spec->vendor);
+  hash = hash * 31 + g_str_hash (monitor_spec->product);
+  hash = hash * 31 + g_str_hash (monitor_spec->serial);
+
+  return hash;
 }
 
 gboolean
@@ -47,6 +47,7 @@ enum
   PROP_0,
 
   PROP_HAS_ACCELEROMETER,
+  PROP_WATCH_SENSORS,
 
   PROP_LAST
 };
@@ -66,6 +67,7 @@ struct _MetaOrientationManager
   MetaOrientation curr_orientation;
   MetaOrientation effective_orientation;
   guint has_accel : 1;
+  guint watch_sensors : 1;
 
   GSettings *settings;
 };
@@ -305,14 +307,6 @@ meta_orientation_manager_init (MetaOrientationManager *self)
   GSettingsSchemaSource *schema_source = g_settings_schema_source_get_default ();
   g_autoptr (GSettingsSchema) schema = NULL;
 
-  self->iio_watch_id = g_bus_watch_name (G_BUS_TYPE_SYSTEM,
-                                         "net.hadess.SensorProxy",
-                                         G_BUS_NAME_WATCHER_FLAGS_NONE,
-                                         iio_sensor_appeared_cb,
-                                         iio_sensor_vanished_cb,
-                                         self,
-                                         NULL);
-
   schema = g_settings_schema_source_lookup (schema_source, CONF_SCHEMA, TRUE);
   if (schema != NULL)
     {
@@ -325,6 +319,44 @@ meta_orientation_manager_init (MetaOrientationManager *self)
   self->effective_orientation = META_ORIENTATION_UNDEFINED;
 }
 
+static void
+meta_orientation_manager_constructed (GObject *object)
+{
+  MetaOrientationManager *self = META_ORIENTATION_MANAGER (object);
+
+  if (self->watch_sensors)
+    {
+      self->iio_watch_id = g_bus_watch_name (G_BUS_TYPE_SYSTEM,
+                                             "net.hadess.SensorProxy",
+                                             G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                             iio_sensor_appeared_cb,
+                                             iio_sensor_vanished_cb,
+                                             self,
+                                             NULL);
+    }
+
+  G_OBJECT_CLASS (meta_orientation_manager_parent_class)->constructed (object);
+}
+
+static void
+meta_orientation_manager_set_property (GObject      *object,
+                                       guint         prop_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+  MetaOrientationManager *self = META_ORIENTATION_MANAGER (object);
+
+  switch (prop_id)
+    {
+    case PROP_WATCH_SENSORS:
+      self->watch_sensors = g_value_get_boolean (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 meta_orientation_manager_get_property (GObject    *object,
                                        guint       prop_id,
@@ -338,6 +370,9 @@ meta_orientation_manager_get_property (GObject    *object,
     case PROP_HAS_ACCELEROMETER:
       g_value_set_boolean (value, self->has_accel);
       break;
+    case PROP_WATCH_SENSORS:
+      g_value_set_boolean (value, self->watch_sensors);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -352,7 +387,7 @@ meta_orientation_manager_finalize (GObject *object)
   g_cancellable_cancel (self->cancellable);
   g_clear_object (&self->cancellable);
 
-  g_bus_unwatch_name (self->iio_watch_id);
+  g_clear_handle_id (&self->iio_watch_id, g_bus_unwatch_name);
   g_clear_handle_id (&self->sync_idle_id, g_source_remove);
   g_clear_object (&self->iio_proxy);
 
@@ -366,7 +401,9 @@ meta_orientation_manager_class_init (MetaOrientationManagerClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
+  gobject_class->constructed = meta_orientation_manager_constructed;
   gobject_class->finalize = meta_orientation_manager_finalize;
+  gobject_class->set_property = meta_orientation_manager_set_property;
   gobject_class->get_property = meta_orientation_manager_get_property;
 
   signals[ORIENTATION_CHANGED] =
@@ -383,6 +420,12 @@ meta_orientation_manager_class_init (MetaOrientationManagerClass *klass)
                           G_PARAM_READABLE |
                           G_PARAM_EXPLICIT_NOTIFY |
                           G_PARAM_STATIC_STRINGS);
+  props[PROP_WATCH_SENSORS] =
+    g_param_spec_boolean ("watch-sensors", NULL, NULL,
+                          TRUE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_CONSTRUCT_ONLY |
+                          G_PARAM_STATIC_STRINGS);
   g_object_class_install_properties (gobject_class, PROP_LAST, props);
 }
 
@@ -47,6 +47,23 @@ enum
 
 static guint signals[N_SIGNALS];
 
+/*
+ * Outputs are recreated on every hotplug and resume, with the same EDID
+ * for the same monitor, so keep what was parsed out of the EDID blobs
+ * seen so far around. The number of distinct monitors connected during
+ * a session is small, but the cache is still bounded, in case a broken
+ * connector reports a different blob every time.
+ */
+#define MAX_CACHED_EDIDS 32
+
+typedef struct _MetaCachedEdid
+{
+  char *checksum_md5;
+  MetaEdidInfo *edid_info;
+} MetaCachedEdid;
+
+static GHashTable *edid_cache;
+
 typedef struct _MetaOutputPrivate
 {
   uint64_t id;
@@ -360,27 +377,64 @@ set_output_details_from_edid (MetaOutputInfo *output_info,
     }
 }
 
+static void
+meta_cached_edid_free (MetaCachedEdid *cached_edid)
+{
+  g_free (cached_edid->checksum_md5);
+  g_clear_pointer (&cached_edid->edid_info, meta_edid_info_free);
+  g_free (cached_edid);
+}
+
+static MetaCachedEdid *
+ensure_cached_edid (GBytes *edid)
+{
+  MetaCachedEdid *cached_edid;
+  size_t size;
+  gconstpointer data;
+
+  if (!edid_cache)
+    {
+      edid_cache =
+        g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                               (GDestroyNotify) g_bytes_unref,
+                               (GDestroyNotify) meta_cached_edid_free);
+    }
+
+  cached_edid = g_hash_table_lookup (edid_cache, edid);
+  if (cached_edid)
+    return cached_edid;
+
+  if (g_hash_table_size (edid_cache) >= MAX_CACHED_EDIDS)
+    g_hash_table_remove_all (edid_cache);
+
+  data = g_bytes_get_data (edid, &size);
+
+  cached_edid = g_new0 (MetaCachedEdid, 1);
+  cached_edid->checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
+                                                           data, size);
+  cached_edid->edid_info = meta_edid_info_new_parse (data, size);
+  g_hash_table_insert (edid_cache, g_bytes_ref (edid), cached_edid);
+
+  return cached_edid;
+}
+
 void
 meta_output_info_parse_edid (MetaOutputInfo *output_info,
                              GBytes         *edid)
 {
-  MetaEdidInfo *edid_info;
-  size_t size;
-  gconstpointer data;
+  MetaCachedEdid *cached_edid;
 
   g_return_if_fail (!output_info->edid_info);
   g_return_if_fail (edid);
 
-  data = g_bytes_get_data (edid, &size);
-  edid_info = meta_edid_info_new_parse (data, size);
+  cached_edid = ensure_cached_edid (edid);
 
-  output_info->edid_checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-                                                                data, size);
+  output_info->edid_checksum_md5 = g_strdup (cached_edid->checksum_md5);
 
-  if (edid_info)
+  if (cached_edid->edid_info)
     {
-      output_info->edid_info = edid_info;
-      set_output_details_from_edid (output_info, edid_info);
+      output_info->edid_info = meta_edid_info_copy (cached_edid->edid_info);
+      set_output_details_from_edid (output_info, output_info->edid_info);
     }
 }
 
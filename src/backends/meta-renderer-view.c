@@ -110,6 +110,9 @@ set_color_states (MetaRendererView *view)
                                       view_color_state);
   clutter_stage_view_set_output_color_state (clutter_stage_view,
                                              output_color_state);
+
+  if (META_RENDERER_VIEW_GET_CLASS (view)->color_states_changed)
+    META_RENDERER_VIEW_GET_CLASS (view)->color_states_changed (view);
 }
 
 static void
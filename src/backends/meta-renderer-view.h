@@ -30,6 +30,8 @@ G_DECLARE_DERIVABLE_TYPE (MetaRendererView, meta_renderer_view,
 struct _MetaRendererViewClass
 {
   MetaStageViewClass parent_class;
+
+  void (* color_states_changed) (MetaRendererView *view);
 };
 
 META_EXPORT_TEST
@@ -46,6 +46,7 @@
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-logical-monitor.h"
+#include "core/meta-debug-control-private.h"
 
 enum
 {
@@ -129,6 +130,34 @@ meta_renderer_rebuild_views (MetaRenderer *renderer)
   return META_RENDERER_GET_CLASS (renderer)->rebuild_views (renderer);
 }
 
+typedef struct
+{
+  MetaRenderer *renderer;
+  GHashTable *sync_leaders;
+} CreateCrtcViewData;
+
+static void
+maybe_sync_view_frame_clock (MetaRendererView   *view,
+                             MetaLogicalMonitor *logical_monitor,
+                             GHashTable         *sync_leaders)
+{
+  const char *sync_group;
+  ClutterFrameClock *frame_clock;
+  ClutterFrameClock *sync_leader;
+
+  sync_group = meta_logical_monitor_get_sync_group (logical_monitor);
+  if (!sync_group)
+    return;
+
+  /* The first view of a sync group drives the frame clocks of the others */
+  frame_clock = clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (view));
+  sync_leader = g_hash_table_lookup (sync_leaders, sync_group);
+  if (sync_leader)
+    clutter_frame_clock_set_sync_leader (frame_clock, sync_leader);
+  else
+    g_hash_table_insert (sync_leaders, (gpointer) sync_group, frame_clock);
+}
+
 static void
 create_crtc_view (MetaLogicalMonitor *logical_monitor,
                   MetaMonitor        *monitor,
@@ -136,7 +165,8 @@ create_crtc_view (MetaLogicalMonitor *logical_monitor,
                   MetaCrtc           *crtc,
                   gpointer            user_data)
 {
-  MetaRenderer *renderer = user_data;
+  CreateCrtcViewData *data = user_data;
+  MetaRenderer *renderer = data->renderer;
   MetaRendererView *view;
   g_autoptr (GError) error = NULL;
 
@@ -152,7 +182,10 @@ create_crtc_view (MetaLogicalMonitor *logical_monitor,
                  meta_monitor_get_display_name (monitor),
                  meta_output_get_name (output),
                  error->message);
+      return;
     }
+
+  maybe_sync_view_frame_clock (view, logical_monitor, data->sync_leaders);
 }
 
 static void
@@ -162,10 +195,18 @@ meta_renderer_real_rebuild_views (MetaRenderer *renderer)
   MetaBackend *backend = priv->backend;
   MetaMonitorManager *monitor_manager =
     meta_backend_get_monitor_manager (backend);
+  g_autoptr (GHashTable) sync_leaders = NULL;
+  CreateCrtcViewData data;
   GList *logical_monitors, *l;
 
   g_clear_list (&priv->views, (GDestroyNotify) clutter_stage_view_destroy);
 
+  sync_leaders = g_hash_table_new (g_str_hash, g_str_equal);
+  data = (CreateCrtcViewData) {
+    .renderer = renderer,
+    .sync_leaders = sync_leaders,
+  };
+
   logical_monitors =
     meta_monitor_manager_get_logical_monitors (monitor_manager);
 
@@ -188,7 +229,7 @@ meta_renderer_real_rebuild_views (MetaRenderer *renderer)
 
       meta_logical_monitor_foreach_crtc (logical_monitor,
                                          create_crtc_view,
-                                         renderer);
+                                         &data);
     }
 }
 
@@ -261,6 +302,37 @@ meta_renderer_get_views_for_monitor (MetaRenderer *renderer,
                                                                     monitor);
 }
 
+static MetaDebugControl *
+get_debug_control (MetaRenderer *renderer)
+{
+  MetaRendererPrivate *priv = meta_renderer_get_instance_private (renderer);
+  MetaContext *context = meta_backend_get_context (priv->backend);
+
+  return meta_context_get_debug_control (context);
+}
+
+static void
+update_frame_clock_policy (MetaRenderer     *renderer,
+                           MetaRendererView *view)
+{
+  ClutterFrameClock *frame_clock =
+    clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (view));
+  ClutterFrameClockPolicy policy;
+
+  policy = meta_debug_control_get_frame_clock_policy (get_debug_control (renderer));
+  clutter_frame_clock_set_policy (frame_clock, policy);
+}
+
+static void
+on_frame_clock_policy_changed (MetaRenderer *renderer)
+{
+  MetaRendererPrivate *priv = meta_renderer_get_instance_private (renderer);
+  GList *l;
+
+  for (l = priv->views; l; l = l->next)
+    update_frame_clock_policy (renderer, l->data);
+}
+
 void
 meta_renderer_add_view (MetaRenderer     *renderer,
                         MetaRendererView *view)
@@ -269,6 +341,8 @@ meta_renderer_add_view (MetaRenderer     *renderer,
 
   priv->views = g_list_append (priv->views, view);
 
+  update_frame_clock_policy (renderer, view);
+
   if (priv->is_paused)
     {
       ClutterFrameClock *frame_clock =
@@ -390,6 +464,20 @@ meta_renderer_set_property (GObject      *object,
     }
 }
 
+static void
+meta_renderer_constructed (GObject *object)
+{
+  MetaRenderer *renderer = META_RENDERER (object);
+
+  g_signal_connect_object (get_debug_control (renderer),
+                           "notify::frame-clock-policy",
+                           G_CALLBACK (on_frame_clock_policy_changed),
+                           renderer,
+                           G_CONNECT_SWAPPED);
+
+  G_OBJECT_CLASS (meta_renderer_parent_class)->constructed (object);
+}
+
 static void
 meta_renderer_dispose (GObject *object)
 {
@@ -413,6 +501,7 @@ meta_renderer_class_init (MetaRendererClass *klass)
 
   object_class->get_property = meta_renderer_get_property;
   object_class->set_property = meta_renderer_set_property;
+  object_class->constructed = meta_renderer_constructed;
   object_class->dispose = meta_renderer_dispose;
 
   klass->rebuild_views = meta_renderer_real_rebuild_views;
@@ -35,6 +35,8 @@
 #include "clutter/clutter-mutter.h"
 #include "core/boxes-private.h"
 
+#define MAX_DAMAGE_BLITS 16
+
 struct _MetaScreenCastMonitorStreamSrc
 {
   MetaScreenCastStreamSrc parent;
@@ -55,6 +57,10 @@ struct _MetaScreenCastMonitorStreamSrc
   gulong stage_prepare_frame_handler_id;
 
   guint maybe_record_idle_id;
+
+  CoglOffscreen *scanout_offscreen;
+
+  MetaScreenCastSharedFrame *shared_frame;
 };
 
 static void
@@ -106,6 +112,37 @@ get_monitor (MetaScreenCastMonitorStreamSrc *monitor_src)
   return meta_screen_cast_monitor_stream_get_monitor (monitor_stream);
 }
 
+static MetaScreenCast *
+get_screen_cast (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+
+  return meta_screen_cast_session_get_screen_cast (session);
+}
+
+static ClutterPaintFlag
+get_paint_flags (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+
+  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+    {
+    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
+    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
+      paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
+      break;
+    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
+      paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
+      break;
+    }
+
+  return paint_flags;
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_get_specs (MetaScreenCastStreamSrc *src,
                                                int                     *width,
@@ -154,6 +191,51 @@ maybe_record_frame_on_idle (gpointer user_data)
   return G_SOURCE_REMOVE;
 }
 
+static MtkRegion *
+create_stream_damage (MetaScreenCastMonitorStreamSrc *monitor_src,
+                      const MtkRegion                *redraw_clip)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  MtkRectangle logical_monitor_layout;
+  MtkRegionBuilder builder;
+  float view_scale;
+  int n_rects, i;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  if (meta_backend_is_stage_views_scaled (backend))
+    view_scale = meta_logical_monitor_get_scale (logical_monitor);
+  else
+    view_scale = 1.0;
+
+  mtk_region_builder_init (&builder);
+
+  n_rects = mtk_region_num_rectangles (redraw_clip);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (redraw_clip, i);
+      if (!mtk_rectangle_intersect (&rect, &logical_monitor_layout, &rect))
+        continue;
+
+      rect.x -= logical_monitor_layout.x;
+      rect.y -= logical_monitor_layout.y;
+      mtk_rectangle_scale_double (&rect, view_scale,
+                                  MTK_ROUNDING_STRATEGY_GROW,
+                                  &rect);
+      mtk_region_builder_add_rectangle (&builder,
+                                        rect.x, rect.y,
+                                        rect.width, rect.height);
+    }
+
+  return mtk_region_builder_finish (&builder);
+}
+
 static void
 stage_painted (MetaStage        *stage,
                ClutterStageView *view,
@@ -179,12 +261,16 @@ stage_painted (MetaStage        *stage,
       MetaScreenCastRecordFlag flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
       MetaScreenCastPaintPhase paint_phase =
         META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER;
+      g_autoptr (MtkRegion) stream_damage = NULL;
+
+      if (redraw_clip)
+        stream_damage = create_stream_damage (monitor_src, redraw_clip);
 
       record_result =
         meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (src,
                                                                        flags,
                                                                        paint_phase,
-                                                                       NULL,
+                                                                       stream_damage,
                                                                        presentation_time_us);
     }
 
@@ -214,9 +300,6 @@ before_stage_painted (MetaStage        *stage,
   if (monitor_src->maybe_record_idle_id)
     return;
 
-  if (!meta_screen_cast_stream_src_uses_dma_bufs (src))
-    return;
-
   if (!clutter_stage_view_peek_scanout (view))
     return;
 
@@ -493,6 +576,11 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
       break;
     }
 
+  monitor_src->shared_frame =
+    meta_screen_cast_acquire_shared_frame (get_screen_cast (monitor_src),
+                                           get_monitor (monitor_src),
+                                           get_paint_flags (monitor_src));
+
   reattach_watches (monitor_src);
   g_signal_connect_object (monitor_manager, "monitors-changed-internal",
                            G_CALLBACK (on_monitors_changed),
@@ -535,6 +623,14 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
                           stage);
 
   g_clear_handle_id (&monitor_src->maybe_record_idle_id, g_source_remove);
+  g_clear_object (&monitor_src->scanout_offscreen);
+
+  if (monitor_src->shared_frame)
+    {
+      meta_screen_cast_release_shared_frame (get_screen_cast (monitor_src),
+                                             monitor_src->shared_frame);
+      monitor_src->shared_frame = NULL;
+    }
 
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
     {
@@ -547,6 +643,169 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
     }
 }
 
+static ClutterStageView *
+get_single_stage_view (MetaScreenCastMonitorStreamSrc *monitor_src,
+                       int                            *out_x,
+                       int                            *out_y)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  MetaRendererView *renderer_view;
+  MtkRectangle logical_monitor_layout;
+  MtkRectangle view_layout;
+  MetaCrtc *crtc;
+  float view_scale;
+  GList *outputs;
+
+  monitor = get_monitor (monitor_src);
+  outputs = meta_monitor_get_outputs (monitor);
+  if (outputs->next)
+    return NULL;
+
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  if (meta_backend_is_stage_views_scaled (backend))
+    view_scale = meta_logical_monitor_get_scale (logical_monitor);
+  else
+    view_scale = 1.0;
+
+  crtc = meta_output_get_assigned_crtc (outputs->data);
+  renderer_view = meta_renderer_get_view_for_crtc (renderer, crtc);
+
+  g_assert (renderer_view != NULL);
+
+  clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (renderer_view),
+                                 &view_layout);
+
+  *out_x = (int) roundf ((view_layout.x - logical_monitor_layout.x) * view_scale);
+  *out_y = (int) roundf ((view_layout.y - logical_monitor_layout.y) * view_scale);
+
+  return CLUTTER_STAGE_VIEW (renderer_view);
+}
+
+static gboolean
+ensure_scanout_offscreen (MetaScreenCastMonitorStreamSrc  *monitor_src,
+                          int                              width,
+                          int                              height,
+                          GError                         **error)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  if (monitor_src->scanout_offscreen)
+    {
+      CoglFramebuffer *framebuffer =
+        COGL_FRAMEBUFFER (monitor_src->scanout_offscreen);
+
+      if (cogl_framebuffer_get_width (framebuffer) == width &&
+          cogl_framebuffer_get_height (framebuffer) == height)
+        return TRUE;
+
+      g_clear_object (&monitor_src->scanout_offscreen);
+    }
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_texture_set_auto_mipmap (texture, FALSE);
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  monitor_src->scanout_offscreen = g_steal_pointer (&offscreen);
+  return TRUE;
+}
+
+static gboolean
+record_scanout_to_buffer (MetaScreenCastMonitorStreamSrc  *monitor_src,
+                          int                              width,
+                          int                              height,
+                          int                              stride,
+                          uint8_t                         *data,
+                          GError                         **error)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  CoglFramebuffer *framebuffer;
+  ClutterStageView *view;
+  CoglScanout *scanout;
+  int x, y;
+
+  view = get_single_stage_view (monitor_src, &x, &y);
+  if (!view)
+    return FALSE;
+
+  scanout = clutter_stage_view_peek_scanout (view);
+  if (!scanout)
+    return FALSE;
+
+  if (!ensure_scanout_offscreen (monitor_src, width, height, error))
+    return FALSE;
+
+  framebuffer = COGL_FRAMEBUFFER (monitor_src->scanout_offscreen);
+  if (!cogl_scanout_blit_to_framebuffer (scanout, framebuffer, x, y, error))
+    return FALSE;
+
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     width, height,
+                                     COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                     stride,
+                                     data);
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to read back scanout buffer");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static CoglFramebuffer *
+maybe_paint_shared_frame (MetaScreenCastMonitorStreamSrc *monitor_src,
+                          MetaScreenCastPaintPhase        paint_phase,
+                          int                             width,
+                          int                             height)
+{
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *framebuffer;
+
+  /* Only streams recording right after the same stage frame was painted are
+   * guaranteed to see identical content. */
+  if (paint_phase != META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER)
+    return NULL;
+
+  if (!monitor_src->shared_frame ||
+      !meta_screen_cast_shared_frame_is_shared (monitor_src->shared_frame))
+    return NULL;
+
+  framebuffer = meta_screen_cast_shared_frame_paint (monitor_src->shared_frame,
+                                                     width, height,
+                                                     &error);
+  if (!framebuffer)
+    {
+      g_warning ("Failed to paint shared screencast frame: %s",
+                 error->message);
+      return NULL;
+    }
+
+  return framebuffer;
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc   *src,
                                                       MetaScreenCastPaintPhase   paint_phase,
@@ -558,13 +817,54 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
-  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
   MetaBackend *backend = get_backend (monitor_src);
+  CoglFramebuffer *shared_framebuffer;
   ClutterStage *stage;
   MetaMonitor *monitor;
   MetaLogicalMonitor *logical_monitor;
   float scale;
-  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+
+  if (paint_phase == META_SCREEN_CAST_PAINT_PHASE_PRE_PAINT)
+    {
+      g_autoptr (GError) local_error = NULL;
+
+      if (record_scanout_to_buffer (monitor_src,
+                                    width, height,
+                                    stride,
+                                    data,
+                                    &local_error))
+        return TRUE;
+
+      if (local_error)
+        {
+          g_warning ("Failed to record scanout to screencast buffer: %s",
+                     local_error->message);
+        }
+    }
+
+  shared_framebuffer = maybe_paint_shared_frame (monitor_src, paint_phase,
+                                                 width, height);
+  if (shared_framebuffer)
+    {
+      ClutterBackend *clutter_backend =
+        meta_backend_get_clutter_backend (backend);
+      CoglContext *cogl_context =
+        clutter_backend_get_cogl_context (clutter_backend);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                         width, height,
+                                         COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                         stride,
+                                         data);
+      if (cogl_framebuffer_read_pixels_into_bitmap (shared_framebuffer,
+                                                    0, 0,
+                                                    COGL_READ_PIXELS_COLOR_BUFFER,
+                                                    bitmap))
+        return TRUE;
+
+      g_warning ("Failed to read back shared screencast frame");
+    }
 
   monitor = get_monitor (monitor_src);
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
@@ -575,28 +875,71 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
   else
     scale = 1.0;
 
-  switch (meta_screen_cast_stream_get_cursor_mode (stream))
-    {
-    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
-    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-      paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
-      break;
-    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-      paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
-      break;
-    }
-
   if (!clutter_stage_paint_to_buffer (stage, &logical_monitor->rect, scale,
                                       data,
                                       stride,
                                       COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
-                                      paint_flags,
+                                      get_paint_flags (monitor_src),
                                       error))
     return FALSE;
 
   return TRUE;
 }
 
+static gboolean
+blit_damage (CoglFramebuffer  *view_framebuffer,
+             CoglFramebuffer  *framebuffer,
+             int               x,
+             int               y,
+             const MtkRegion  *damage,
+             GError          **error)
+{
+  MtkRectangle view_rect;
+  int n_rects, i;
+
+  view_rect = (MtkRectangle) {
+    .x = x,
+    .y = y,
+    .width = cogl_framebuffer_get_width (view_framebuffer),
+    .height = cogl_framebuffer_get_height (view_framebuffer),
+  };
+
+  /* Avoid issuing lots of tiny blits for fragmented damage. */
+  n_rects = mtk_region_num_rectangles (damage);
+  if (n_rects > MAX_DAMAGE_BLITS)
+    {
+      MtkRectangle extents = mtk_region_get_extents (damage);
+
+      if (!mtk_rectangle_intersect (&extents, &view_rect, &extents))
+        return TRUE;
+
+      return cogl_blit_framebuffer (view_framebuffer,
+                                    framebuffer,
+                                    extents.x - x, extents.y - y,
+                                    extents.x, extents.y,
+                                    extents.width, extents.height,
+                                    error);
+    }
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (damage, i);
+
+      if (!mtk_rectangle_intersect (&rect, &view_rect, &rect))
+        continue;
+
+      if (!cogl_blit_framebuffer (view_framebuffer,
+                                  framebuffer,
+                                  rect.x - x, rect.y - y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc   *src,
                                                            MetaScreenCastPaintPhase   paint_phase,
@@ -605,21 +948,15 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
-  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
   MetaBackend *backend = get_backend (monitor_src);
-  MetaRenderer *renderer = meta_backend_get_renderer (backend);
   ClutterStage *stage = get_stage (monitor_src);
   g_autoptr (GError) local_error = NULL;
   MetaMonitor *monitor;
   MetaLogicalMonitor *logical_monitor;
-  MetaRendererView *renderer_view;
   ClutterStageView *view;
   MtkRectangle logical_monitor_layout;
-  MtkRectangle view_layout;
-  MetaCrtc *crtc;
   gboolean do_stage_paint = TRUE;
   float view_scale;
-  GList *outputs;
   int x, y;
 
   monitor = get_monitor (monitor_src);
@@ -634,21 +971,10 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
   if (paint_phase == META_SCREEN_CAST_PAINT_PHASE_DETACHED)
     goto stage_paint;
 
-  outputs = meta_monitor_get_outputs (monitor);
-  if (outputs->next)
+  view = get_single_stage_view (monitor_src, &x, &y);
+  if (!view)
     goto stage_paint;
 
-  crtc = meta_output_get_assigned_crtc (outputs->data);
-  renderer_view = meta_renderer_get_view_for_crtc (renderer, crtc);
-
-  g_assert (renderer_view != NULL);
-
-  view = CLUTTER_STAGE_VIEW (renderer_view);
-  clutter_stage_view_get_layout (view, &view_layout);
-
-  x = (int) roundf ((view_layout.x - logical_monitor_layout.x) * view_scale);
-  y = (int) roundf ((view_layout.y - logical_monitor_layout.y) * view_scale);
-
   switch (paint_phase)
     {
     case META_SCREEN_CAST_PAINT_PHASE_PRE_PAINT:
@@ -669,14 +995,27 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
       {
         CoglFramebuffer *view_framebuffer =
           clutter_stage_view_get_framebuffer (view);
+        const MtkRegion *buffer_damage =
+          meta_screen_cast_stream_src_get_buffer_damage (src);
 
-        cogl_blit_framebuffer (view_framebuffer,
-                               framebuffer,
-                               0, 0,
-                               x, y,
-                               cogl_framebuffer_get_width (view_framebuffer),
-                               cogl_framebuffer_get_height (view_framebuffer),
-                               &local_error);
+        if (buffer_damage)
+          {
+            blit_damage (view_framebuffer,
+                         framebuffer,
+                         x, y,
+                         buffer_damage,
+                         &local_error);
+          }
+        else
+          {
+            cogl_blit_framebuffer (view_framebuffer,
+                                   framebuffer,
+                                   0, 0,
+                                   x, y,
+                                   cogl_framebuffer_get_width (view_framebuffer),
+                                   cogl_framebuffer_get_height (view_framebuffer),
+                                   &local_error);
+          }
       }
       break;
 
@@ -695,25 +1034,39 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
 stage_paint:
   if (do_stage_paint)
     {
-      ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+      int width = cogl_framebuffer_get_width (framebuffer);
+      int height = cogl_framebuffer_get_height (framebuffer);
+      CoglFramebuffer *shared_framebuffer;
 
-      switch (meta_screen_cast_stream_get_cursor_mode (stream))
+      shared_framebuffer = maybe_paint_shared_frame (monitor_src, paint_phase,
+                                                     width, height);
+      if (shared_framebuffer)
         {
-        case META_SCREEN_CAST_CURSOR_MODE_METADATA:
-        case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-          paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
-          break;
-
-        case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-          paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
-          break;
+          g_clear_error (&local_error);
+          if (cogl_blit_framebuffer (shared_framebuffer,
+                                     framebuffer,
+                                     0, 0,
+                                     0, 0,
+                                     width, height,
+                                     &local_error))
+            {
+              do_stage_paint = FALSE;
+            }
+          else
+            {
+              g_warning ("Error blitting shared screencast frame: %s",
+                         local_error->message);
+            }
         }
+    }
 
+  if (do_stage_paint)
+    {
       clutter_stage_paint_to_framebuffer (stage,
                                           framebuffer,
                                           &logical_monitor_layout,
                                           view_scale,
-                                          paint_flags);
+                                          get_paint_flags (monitor_src));
     }
 
   cogl_framebuffer_flush (framebuffer);
@@ -74,6 +74,13 @@
 
 #define DEFAULT_COGL_PIXEL_FORMAT COGL_PIXEL_FORMAT_BGRX_8888
 
+/* When the consumer doesn't return buffers in time, the capture interval is
+ * doubled, down to this rate. */
+#define THROTTLE_MAX_INTERVAL_US (G_USEC_PER_SEC / 5)
+/* Throttling ends once the interval is back below this one. */
+#define THROTTLE_RECOVERY_INTERVAL_US (G_USEC_PER_SEC / 120)
+#define THROTTLE_DEFAULT_INTERVAL_US (G_USEC_PER_SEC / 60)
+
 enum
 {
   PROP_0,
@@ -120,12 +127,22 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   int64_t last_frame_timestamp_us;
   guint follow_up_frame_source_id;
 
+  /* Minimum capture interval imposed due to a slow consumer, or 0 */
+  int64_t throttle_interval_us;
+
   int buffer_count;
   gboolean needs_follow_up_with_buffers;
 
   gboolean uses_dma_bufs;
   GHashTable *dmabuf_handles;
 
+  /* Keys: DMA buffer file descriptors
+   * Values: Damage the buffer has missed since it was last recorded into
+   */
+  GHashTable *dmabuf_damage;
+  /* Region of the buffer currently recorded into that needs updating */
+  MtkRegion *buffer_damage;
+
   /* Keys: File descriptors
    * Values: MetaDrmTimeline object pointers
    *
@@ -142,6 +159,12 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   MtkRegion *redraw_clip;
 
   GHashTable *modifiers;
+
+  struct {
+    CoglOffscreen *rgb_offscreen;
+    CoglOffscreen *yuv_offscreen;
+    CoglPipeline *pipeline;
+  } nv12;
 } MetaScreenCastStreamSrcPrivate;
 
 static const struct {
@@ -152,6 +175,38 @@ static const struct {
   { COGL_PIXEL_FORMAT_BGRA_8888_PRE, SPA_VIDEO_FORMAT_BGRA },
 };
 
+/*
+ * NV12 is rendered into a single channel framebuffer laid out like the
+ * NV12 memory, i.e. the Y plane followed by the interleaved, subsampled UV
+ * plane with the same stride, using BT.709 limited range coefficients.
+ * Chroma is sampled in between each 2x2 block, letting linear filtering
+ * average it.
+ */
+static const char nv12_declarations[] =
+  "uniform vec2 source_size;                                                \n"
+  "uniform vec2 dest_size;                                                  \n";
+
+static const char nv12_shader[] =
+  "vec2 pos = floor (cogl_tex_coord0_in.st * dest_size);                    \n"
+  "vec3 rgb;                                                                \n"
+  "float value;                                                             \n"
+  "if (pos.y < source_size.y)                                               \n"
+  "  {                                                                      \n"
+  "    rgb = texture2D (cogl_sampler0, (pos + 0.5) / source_size).rgb;      \n"
+  "    value = dot (rgb, vec3 (0.1826, 0.6142, 0.0620)) + 16.0 / 255.0;     \n"
+  "  }                                                                      \n"
+  "else                                                                     \n"
+  "  {                                                                      \n"
+  "    vec2 block = vec2 (floor (pos.x / 2.0), pos.y - source_size.y);      \n"
+  "    rgb = texture2D (cogl_sampler0,                                      \n"
+  "                     (block * 2.0 + 1.0) / source_size).rgb;             \n"
+  "    if (mod (pos.x, 2.0) < 1.0)                                          \n"
+  "      value = dot (rgb, vec3 (-0.1006, -0.3386, 0.4392)) + 128.0 / 255.0;\n"
+  "    else                                                                 \n"
+  "      value = dot (rgb, vec3 (0.4392, -0.3989, -0.0403)) + 128.0 / 255.0;\n"
+  "  }                                                                      \n"
+  "cogl_color_out = vec4 (value, value, value, 1.0);                        \n";
+
 
 #ifdef HAVE_NATIVE_BACKEND
 
@@ -212,6 +267,41 @@ cogl_pixel_format_from_spa_video_format (enum spa_video_format  spa_format,
   return FALSE;
 }
 
+static gboolean
+is_nv12_format (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  return priv->video_format.format == SPA_VIDEO_FORMAT_NV12;
+}
+
+static int
+get_nv12_chroma_height (int height)
+{
+  return (height + 1) / 2;
+}
+
+static CoglContext *
+cogl_context_from_src (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+  MetaBackend *backend = meta_screen_cast_get_backend (screen_cast);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static gboolean
+supports_nv12 (MetaScreenCastStreamSrc *src)
+{
+  return cogl_context_has_feature (cogl_context_from_src (src),
+                                   COGL_FEATURE_ID_TEXTURE_RG);
+}
+
 static struct spa_pod *
 push_format_object (enum spa_video_format   format,
                     uint64_t               *modifiers,
@@ -634,6 +724,9 @@ meta_screen_cast_stream_src_calculate_stride (MetaScreenCastStreamSrc *src,
       return cogl_dma_buf_handle_get_stride (dmabuf_handle);
     }
 
+  if (is_nv12_format (src))
+    return SPA_ROUND_UP_N (priv->video_format.size.width, 4);
+
   if (!cogl_pixel_format_from_spa_video_format (priv->video_format.format,
                                                 &cogl_format))
     g_assert_not_reached ();
@@ -694,6 +787,239 @@ maybe_set_sync_points (MetaScreenCastStreamSrc *src,
 #endif /* HAVE_NATIVE_BACKEND */
 }
 
+static MtkRegion *
+create_full_damage (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MtkRectangle rect;
+
+  rect = (MtkRectangle) {
+    .width = priv->video_format.size.width,
+    .height = priv->video_format.size.height,
+  };
+  return mtk_region_create_rectangle (&rect);
+}
+
+static void
+prepare_buffer_damage (MetaScreenCastStreamSrc *src,
+                       struct spa_data         *spa_data)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MtkRegion *missed_damage;
+
+  g_clear_pointer (&priv->buffer_damage, mtk_region_unref);
+
+  if (spa_data->type != SPA_DATA_DmaBuf || !priv->redraw_clip)
+    return;
+
+  missed_damage = g_hash_table_lookup (priv->dmabuf_damage,
+                                       GINT_TO_POINTER (spa_data->fd));
+  if (!missed_damage)
+    return;
+
+  priv->buffer_damage = mtk_region_copy (missed_damage);
+  mtk_region_union (priv->buffer_damage, priv->redraw_clip);
+}
+
+static void
+update_missed_damage (MetaScreenCastStreamSrc *src,
+                      struct spa_data         *spa_data,
+                      gboolean                 recorded)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_clear_pointer (&priv->buffer_damage, mtk_region_unref);
+
+  if (spa_data->type != SPA_DATA_DmaBuf)
+    return;
+
+  g_hash_table_iter_init (&iter, priv->dmabuf_damage);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      MtkRegion *missed_damage = value;
+
+      if (GPOINTER_TO_INT (key) == spa_data->fd)
+        {
+          if (recorded)
+            g_hash_table_iter_replace (&iter, mtk_region_create ());
+          else
+            g_hash_table_iter_replace (&iter, create_full_damage (src));
+        }
+      else if (priv->redraw_clip)
+        {
+          mtk_region_union (missed_damage, priv->redraw_clip);
+        }
+      else
+        {
+          g_hash_table_iter_replace (&iter, create_full_damage (src));
+        }
+    }
+}
+
+static void
+clear_nv12_converter (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  g_clear_object (&priv->nv12.rgb_offscreen);
+  g_clear_object (&priv->nv12.yuv_offscreen);
+  g_clear_object (&priv->nv12.pipeline);
+}
+
+static CoglOffscreen *
+create_offscreen (CoglContext      *cogl_context,
+                  int               width,
+                  int               height,
+                  CoglPixelFormat   format,
+                  GError          **error)
+{
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  if (format == COGL_PIXEL_FORMAT_ANY)
+    texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  else
+    texture = cogl_texture_2d_new_with_format (cogl_context, width, height,
+                                               format);
+  cogl_texture_set_auto_mipmap (texture, FALSE);
+  if (!cogl_texture_allocate (texture, error))
+    return NULL;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  return g_steal_pointer (&offscreen);
+}
+
+static gboolean
+ensure_nv12_converter (MetaScreenCastStreamSrc  *src,
+                       int                       width,
+                       int                       height,
+                       int                       stride,
+                       GError                  **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglContext *cogl_context = cogl_context_from_src (src);
+  g_autoptr (CoglSnippet) snippet = NULL;
+  CoglTexture *rgb_texture;
+  float source_size[2];
+  float dest_size[2];
+  int dest_height;
+
+  if (priv->nv12.pipeline)
+    return TRUE;
+
+  dest_height = height + get_nv12_chroma_height (height);
+
+  priv->nv12.rgb_offscreen = create_offscreen (cogl_context,
+                                               width, height,
+                                               COGL_PIXEL_FORMAT_ANY,
+                                               error);
+  if (!priv->nv12.rgb_offscreen)
+    goto err;
+
+  priv->nv12.yuv_offscreen = create_offscreen (cogl_context,
+                                               stride, dest_height,
+                                               COGL_PIXEL_FORMAT_R_8,
+                                               error);
+  if (!priv->nv12.yuv_offscreen)
+    goto err;
+
+  rgb_texture = cogl_offscreen_get_texture (priv->nv12.rgb_offscreen);
+
+  priv->nv12.pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (priv->nv12.pipeline,
+                                 "MetaScreenCastStreamSrc (nv12)");
+  cogl_pipeline_set_layer_texture (priv->nv12.pipeline, 0, rgb_texture);
+  cogl_pipeline_set_layer_filters (priv->nv12.pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_layer_wrap_mode (priv->nv12.pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                              nv12_declarations,
+                              nv12_shader);
+  cogl_pipeline_add_snippet (priv->nv12.pipeline, snippet);
+
+  source_size[0] = (float) width;
+  source_size[1] = (float) height;
+  dest_size[0] = (float) stride;
+  dest_size[1] = (float) dest_height;
+  cogl_pipeline_set_uniform_float (priv->nv12.pipeline,
+                                   cogl_pipeline_get_uniform_location (priv->nv12.pipeline,
+                                                                       "source_size"),
+                                   2, 1, source_size);
+  cogl_pipeline_set_uniform_float (priv->nv12.pipeline,
+                                   cogl_pipeline_get_uniform_location (priv->nv12.pipeline,
+                                                                       "dest_size"),
+                                   2, 1, dest_size);
+
+  return TRUE;
+
+err:
+  clear_nv12_converter (src);
+  return FALSE;
+}
+
+static gboolean
+record_nv12_to_buffer (MetaScreenCastStreamSrc   *src,
+                       MetaScreenCastPaintPhase   paint_phase,
+                       int                        width,
+                       int                        height,
+                       int                        stride,
+                       uint8_t                   *data,
+                       GError                   **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglContext *cogl_context = cogl_context_from_src (src);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  CoglFramebuffer *yuv_framebuffer;
+  int dest_height;
+
+  if (!ensure_nv12_converter (src, width, height, stride, error))
+    return FALSE;
+
+  if (!meta_screen_cast_stream_src_record_to_framebuffer (src,
+                                                          paint_phase,
+                                                          COGL_FRAMEBUFFER (priv->nv12.rgb_offscreen),
+                                                          error))
+    return FALSE;
+
+  yuv_framebuffer = COGL_FRAMEBUFFER (priv->nv12.yuv_offscreen);
+  cogl_framebuffer_draw_textured_rectangle (yuv_framebuffer,
+                                            priv->nv12.pipeline,
+                                            -1, 1, 1, -1,
+                                            0, 0, 1, 1);
+
+  dest_height = height + get_nv12_chroma_height (height);
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     stride, dest_height,
+                                     COGL_PIXEL_FORMAT_R_8,
+                                     stride,
+                                     data);
+  if (!cogl_framebuffer_read_pixels_into_bitmap (yuv_framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to read back NV12 frame");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 do_record_frame (MetaScreenCastStreamSrc   *src,
                  MetaScreenCastRecordFlag   flags,
@@ -711,6 +1037,20 @@ do_record_frame (MetaScreenCastStreamSrc   *src,
       int height = priv->video_format.size.height;
       int stride = meta_screen_cast_stream_src_calculate_stride (src, spa_data);
 
+      if (is_nv12_format (src))
+        {
+          COGL_TRACE_BEGIN_SCOPED (RecordNv12ToBuffer,
+                                   "Meta::ScreenCastStreamSrc::record_nv12_to_buffer()");
+
+          return record_nv12_to_buffer (src,
+                                        paint_phase,
+                                        width,
+                                        height,
+                                        stride,
+                                        spa_data->data,
+                                        error);
+        }
+
       COGL_TRACE_BEGIN_SCOPED (RecordToBuffer,
                                "Meta::ScreenCastStreamSrc::record_to_buffer()");
 
@@ -794,6 +1134,9 @@ maybe_add_damaged_regions_metadata (MetaScreenCastStreamSrc *src,
   MetaScreenCastStreamSrcPrivate *priv;
   struct spa_meta *spa_meta_video_damage;
   struct spa_meta_region *meta_region;
+  int n_slots;
+  int n_rectangles;
+  int i;
 
   spa_meta_video_damage =
     spa_buffer_find_meta (spa_buffer, SPA_META_VideoDamage);
@@ -801,58 +1144,76 @@ maybe_add_damaged_regions_metadata (MetaScreenCastStreamSrc *src,
     return;
 
   priv = meta_screen_cast_stream_src_get_instance_private (src);
-  if (!priv->redraw_clip)
+
+  n_slots = 0;
+  spa_meta_for_each (meta_region, spa_meta_video_damage)
+    n_slots++;
+
+  if (n_slots == 0)
     {
-      spa_meta_for_each (meta_region, spa_meta_video_damage)
-      {
-        meta_region->region = SPA_REGION (0, 0, priv->video_format.size.width,
-                                          priv->video_format.size.height);
-        break;
-      }
+      g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+      return;
     }
+
+  if (priv->redraw_clip)
+    n_rectangles = mtk_region_num_rectangles (priv->redraw_clip);
   else
-    {
-      int i;
-      int n_rectangles;
-      int num_buffers_available;
+    n_rectangles = 0;
 
-      i = 0;
-      n_rectangles = mtk_region_num_rectangles (priv->redraw_clip);
-      num_buffers_available = 0;
+  /* Encoders consuming the stream use the damage to limit what they need
+   * to process, so rather than falling back to damaging the whole frame
+   * when running out of slots, let the last slot cover the extents of the
+   * remaining rectangles. Unused slots are terminated with an empty region.
+   */
+  i = 0;
+  spa_meta_for_each (meta_region, spa_meta_video_damage)
+  {
+    MtkRectangle rect;
 
-      spa_meta_for_each (meta_region, spa_meta_video_damage)
+    if (!priv->redraw_clip)
+      {
+        if (i == 0)
+          {
+            rect = (MtkRectangle) {
+              .width = priv->video_format.size.width,
+              .height = priv->video_format.size.height,
+            };
+          }
+        else
+          {
+            rect = (MtkRectangle) { 0 };
+          }
+      }
+    else if (i >= n_rectangles)
       {
-        ++num_buffers_available;
+        rect = (MtkRectangle) { 0 };
       }
+    else if (i == n_slots - 1 && n_rectangles > n_slots)
+      {
+        int j;
 
-      if (num_buffers_available < n_rectangles)
-        {
-          spa_meta_for_each (meta_region, spa_meta_video_damage)
+        rect = mtk_region_get_rectangle (priv->redraw_clip, i);
+        for (j = i + 1; j < n_rectangles; j++)
           {
-            g_warning ("Not enough buffers (%d) to accommodate damaged "
-                       "regions (%d)", num_buffers_available, n_rectangles);
-            meta_region->region = SPA_REGION (0, 0,
-                                              priv->video_format.size.width,
-                                              priv->video_format.size.height);
+            MtkRectangle other;
 
-            break;
+            other = mtk_region_get_rectangle (priv->redraw_clip, j);
+            mtk_rectangle_union (&rect, &other, &rect);
           }
-        }
-      else
-        {
-          spa_meta_for_each (meta_region, spa_meta_video_damage)
-          {
-            MtkRectangle rect;
+      }
+    else
+      {
+        rect = mtk_region_get_rectangle (priv->redraw_clip, i);
+      }
 
-            rect = mtk_region_get_rectangle (priv->redraw_clip, i);
-            meta_region->region = SPA_REGION (rect.x, rect.y,
-                                              rect.width, rect.height);
+    meta_region->region = SPA_REGION (rect.x, rect.y,
+                                      rect.width, rect.height);
 
-            if (++i == n_rectangles)
-              break;
-          }
-        }
-    }
+    if (rect.width == 0 || rect.height == 0)
+      break;
+
+    i++;
+  }
 
   g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
 }
@@ -977,6 +1338,87 @@ dequeue_pw_buffer (MetaScreenCastStreamSrc  *src,
   return buffer;
 }
 
+static int64_t
+get_min_frame_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->video_format.max_framerate.num == 0)
+    return 0;
+
+  return ((G_USEC_PER_SEC * ((int64_t) priv->video_format.max_framerate.denom)) /
+          ((int64_t) priv->video_format.max_framerate.num));
+}
+
+static void
+set_throttle_interval (MetaScreenCastStreamSrc *src,
+                       int64_t                  throttle_interval_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  gboolean was_throttled = priv->throttle_interval_us != 0;
+  gboolean is_throttled = throttle_interval_us != 0;
+
+  priv->throttle_interval_us = throttle_interval_us;
+
+  if (was_throttled == is_throttled)
+    return;
+
+  meta_topic (META_DEBUG_SCREEN_CAST,
+              "%s capture rate on stream %u",
+              is_throttled ? "Throttling" : "Restoring",
+              priv->node_id);
+
+  meta_screen_cast_stream_set_throttled (priv->stream, is_throttled);
+}
+
+static void
+throttle_frames (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t throttle_interval_us;
+
+  if (priv->throttle_interval_us)
+    {
+      throttle_interval_us = priv->throttle_interval_us * 2;
+    }
+  else
+    {
+      throttle_interval_us = MAX (get_min_frame_interval_us (src),
+                                  THROTTLE_DEFAULT_INTERVAL_US) * 2;
+    }
+
+  set_throttle_interval (src, MIN (throttle_interval_us,
+                                   THROTTLE_MAX_INTERVAL_US));
+
+  /* The dropped frame still needs to reach the consumer eventually. */
+  maybe_schedule_follow_up_frame (src, priv->throttle_interval_us);
+}
+
+static void
+maybe_unthrottle_frames (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t throttle_interval_us;
+  int64_t recovery_interval_us;
+
+  if (!priv->throttle_interval_us)
+    return;
+
+  throttle_interval_us = (priv->throttle_interval_us -
+                          priv->throttle_interval_us / 16);
+  recovery_interval_us = MAX (get_min_frame_interval_us (src),
+                              THROTTLE_RECOVERY_INTERVAL_US);
+
+  if (throttle_interval_us <= recovery_interval_us)
+    throttle_interval_us = 0;
+
+  set_throttle_interval (src, throttle_interval_us);
+}
+
 MetaScreenCastRecordResult
 meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStreamSrc  *src,
                                                                MetaScreenCastRecordFlag  flags,
@@ -995,6 +1437,7 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
   struct spa_buffer *spa_buffer;
   struct spa_meta_header *header;
   struct spa_data *spa_data;
+  int64_t min_interval_us;
   g_autoptr (GError) error = NULL;
 
   COGL_TRACE_BEGIN_SCOPED (MaybeRecordFrame,
@@ -1031,16 +1474,13 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       return record_result;
     }
 
-  if (priv->video_format.max_framerate.num > 0 &&
+  min_interval_us = MAX (get_min_frame_interval_us (src),
+                         priv->throttle_interval_us);
+  if (min_interval_us > 0 &&
       priv->last_frame_timestamp_us != 0)
     {
-      int64_t min_interval_us;
       int64_t time_since_last_frame_us;
 
-      min_interval_us =
-        ((G_USEC_PER_SEC * ((int64_t) priv->video_format.max_framerate.denom)) /
-         ((int64_t) priv->video_format.max_framerate.num));
-
       time_since_last_frame_us = frame_timestamp_us - priv->last_frame_timestamp_us;
       if (time_since_last_frame_us < min_interval_us)
         {
@@ -1069,6 +1509,7 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
       meta_topic (META_DEBUG_SCREEN_CAST,
                   "Couldn't dequeue a buffer from pipewire stream: %s",
                   error->message);
+      throttle_frames (src);
       return record_result;
     }
 
@@ -1092,12 +1533,23 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
   if (!(flags & META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY))
     {
       g_clear_handle_id (&priv->follow_up_frame_source_id, g_source_remove);
+      prepare_buffer_damage (src, spa_data);
       if (do_record_frame (src, flags, paint_phase, spa_buffer, &error))
         {
+          update_missed_damage (src, spa_data, TRUE);
           maybe_add_damaged_regions_metadata (src, spa_buffer);
+          g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
           struct spa_meta_region *spa_meta_video_crop;
 
-          spa_data->chunk->size = spa_data->maxsize;
+          if (is_nv12_format (src))
+            {
+              spa_data->chunk->size =
+                spa_data->chunk->stride * priv->video_format.size.height;
+            }
+          else
+            {
+              spa_data->chunk->size = spa_data->maxsize;
+            }
           spa_data->chunk->flags = SPA_CHUNK_FLAG_NONE;
 
           /* Update VideoCrop if needed */
@@ -1125,9 +1577,11 @@ meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (MetaScreenCastStr
             }
 
           record_result |= META_SCREEN_CAST_RECORD_RESULT_RECORDED_FRAME;
+          maybe_unthrottle_frames (src);
         }
       else
         {
+          update_missed_damage (src, spa_data, FALSE);
           if (error)
             g_warning ("Failed to record screen cast frame: %s", error->message);
           spa_data->chunk->size = 0;
@@ -1301,6 +1755,24 @@ build_format_params (MetaScreenCastStreamSrc *src,
         0);
       g_ptr_array_add (params, g_steal_pointer (&pod));
     }
+
+  if (supports_nv12 (src))
+    {
+      pod = push_format_object (
+        SPA_VIDEO_FORMAT_NV12, NULL, 0, FALSE,
+        SPA_FORMAT_VIDEO_size, SPA_POD_CHOICE_RANGE_Rectangle (&default_size,
+                                                               &min_size,
+                                                               &max_size),
+        SPA_FORMAT_VIDEO_framerate, SPA_POD_Fraction (&SPA_FRACTION (0, 1)),
+        SPA_FORMAT_VIDEO_maxFramerate,
+        SPA_POD_CHOICE_RANGE_Fraction (&default_framerate,
+                                       &min_framerate,
+                                       &max_framerate),
+        SPA_FORMAT_VIDEO_colorRange, SPA_POD_Id (SPA_VIDEO_COLOR_RANGE_16_235),
+        SPA_FORMAT_VIDEO_colorMatrix, SPA_POD_Id (SPA_VIDEO_COLOR_MATRIX_BT709),
+        0);
+      g_ptr_array_add (params, g_steal_pointer (&pod));
+    }
 }
 
 static void
@@ -1393,6 +1865,7 @@ on_stream_param_changed (void                 *data,
   struct spa_pod_frame pod_frame;
   g_autoptr (GPtrArray) params = NULL;
   int buffer_types;
+  int n_blocks;
   const struct spa_pod_prop *prop_modifier;
 
   if (!format || id != SPA_PARAM_Format)
@@ -1403,6 +1876,9 @@ on_stream_param_changed (void                 *data,
   spa_format_video_raw_parse (format,
                               &priv->video_format);
 
+  clear_nv12_converter (src);
+  n_blocks = is_nv12_format (src) ? 2 : 1;
+
   prop_modifier = spa_pod_find_prop (format, NULL, SPA_FORMAT_VIDEO_modifier);
 
   if (prop_modifier)
@@ -1489,7 +1965,7 @@ on_stream_param_changed (void                 *data,
   spa_pod_builder_add (
     &pod_builder.b,
     SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (16, 2, 16),
-    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (3),
+    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (n_blocks + 2),
     SPA_PARAM_BUFFERS_align, SPA_POD_Int (16),
     SPA_PARAM_BUFFERS_dataType, SPA_POD_CHOICE_FLAGS_Int (buffer_types),
     0);
@@ -1504,7 +1980,7 @@ on_stream_param_changed (void                 *data,
     &pod_builder.b,
     SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
     SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (16, 2, 16),
-    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (1),
+    SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (n_blocks),
     SPA_PARAM_BUFFERS_align, SPA_POD_Int (16),
     SPA_PARAM_BUFFERS_dataType, SPA_POD_CHOICE_FLAGS_Int (buffer_types));
   g_ptr_array_add (params, g_steal_pointer (&pod));
@@ -1633,6 +2109,7 @@ on_stream_add_buffer (void             *data,
   struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = &spa_buffer->datas[0];
   int stride;
+  int height;
 
   priv->buffer_count++;
 
@@ -1692,6 +2169,9 @@ on_stream_add_buffer (void             *data,
       g_hash_table_insert (priv->dmabuf_handles,
                            GINT_TO_POINTER (spa_data->fd),
                            dmabuf_handle);
+      g_hash_table_insert (priv->dmabuf_damage,
+                           GINT_TO_POINTER (spa_data->fd),
+                           create_full_damage (src));
 
       stride = meta_screen_cast_stream_src_calculate_stride (src, spa_data);
       spa_data->maxsize = stride * priv->video_format.size.height;
@@ -1727,7 +2207,20 @@ on_stream_add_buffer (void             *data,
         }
 
       stride = meta_screen_cast_stream_src_calculate_stride (src, spa_data);
-      spa_data->maxsize = stride * priv->video_format.size.height;
+      height = priv->video_format.size.height;
+      if (is_nv12_format (src))
+        {
+          if (spa_buffer->n_datas < 2)
+            {
+              close (spa_data->fd);
+              spa_data->fd = -1;
+              g_critical ("Not enough data blocks for NV12 buffers");
+              return;
+            }
+
+          height += get_nv12_chroma_height (height);
+        }
+      spa_data->maxsize = stride * height;
 
       if (ftruncate (spa_data->fd, spa_data->maxsize) < 0)
         {
@@ -1754,6 +2247,24 @@ on_stream_add_buffer (void             *data,
           g_critical ("Failed to mmap memory: %m");
           return;
         }
+
+      if (is_nv12_format (src))
+        {
+          struct spa_data *spa_data_uv = &spa_buffer->datas[1];
+
+          /* The UV plane shares the memfd, following the Y plane. */
+          spa_data_uv->type = SPA_DATA_MemFd;
+          spa_data_uv->flags = SPA_DATA_FLAG_READWRITE;
+          spa_data_uv->fd = spa_data->fd;
+          spa_data_uv->mapoffset = 0;
+          spa_data_uv->maxsize = spa_data->maxsize;
+          spa_data_uv->data = spa_data->data;
+          spa_data_uv->chunk->offset = stride * priv->video_format.size.height;
+          spa_data_uv->chunk->size =
+            stride * get_nv12_chroma_height (priv->video_format.size.height);
+          spa_data_uv->chunk->stride = stride;
+          spa_data_uv->chunk->flags = SPA_CHUNK_FLAG_NONE;
+        }
     }
   spa_data->chunk->stride = stride;
 
@@ -1810,6 +2321,7 @@ on_stream_remove_buffer (void             *data,
 
       if (!g_hash_table_remove (priv->dmabuf_handles, GINT_TO_POINTER (spa_data->fd)))
         g_critical ("Failed to remove non-exported DMA buffer");
+      g_hash_table_remove (priv->dmabuf_damage, GINT_TO_POINTER (spa_data->fd));
     }
   else if (spa_data->type == SPA_DATA_MemFd)
     {
@@ -2065,9 +2577,12 @@ meta_screen_cast_stream_src_dispose (GObject *object)
     g_array_free (value, TRUE);
 
   g_clear_pointer (&priv->modifiers, g_hash_table_destroy);
+  clear_nv12_converter (src);
   g_clear_pointer (&priv->pipewire_stream, pw_stream_destroy);
   g_clear_pointer (&priv->timelines, g_hash_table_destroy);
   g_clear_pointer (&priv->dmabuf_handles, g_hash_table_destroy);
+  g_clear_pointer (&priv->dmabuf_damage, g_hash_table_destroy);
+  g_clear_pointer (&priv->buffer_damage, mtk_region_unref);
   g_clear_pointer (&priv->pipewire_core, pw_core_disconnect);
   g_clear_pointer (&priv->pipewire_context, pw_context_destroy);
   g_clear_pointer (&priv->pipewire_source, g_source_destroy);
@@ -2134,6 +2649,9 @@ meta_screen_cast_stream_src_init (MetaScreenCastStreamSrc *src)
   priv->dmabuf_handles =
     g_hash_table_new_full (NULL, NULL, NULL,
                            (GDestroyNotify) cogl_dma_buf_handle_free);
+  priv->dmabuf_damage =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) mtk_region_unref);
 
   priv->timelines =
     g_hash_table_new_full (NULL, NULL, close_fd, g_object_unref);
@@ -2194,4 +2712,13 @@ meta_screen_cast_stream_src_get_preferred_format (MetaScreenCastStreamSrc *src)
   return klass->get_preferred_format (src);
 }
 
+const MtkRegion *
+meta_screen_cast_stream_src_get_buffer_damage (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  return priv->buffer_damage;
+}
+
 #pragma GCC diagnostic pop
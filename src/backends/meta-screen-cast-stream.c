@@ -235,6 +235,15 @@ meta_screen_cast_stream_get_mapping_id (MetaScreenCastStream *stream)
   return priv->mapping_id;
 }
 
+void
+meta_screen_cast_stream_set_throttled (MetaScreenCastStream *stream,
+                                       gboolean              throttled)
+{
+  MetaDBusScreenCastStream *skeleton = META_DBUS_SCREEN_CAST_STREAM (stream);
+
+  meta_dbus_screen_cast_stream_set_throttled (skeleton, throttled);
+}
+
 gboolean
 meta_screen_cast_stream_is_configured (MetaScreenCastStream *stream)
 {
@@ -70,6 +70,9 @@ MetaScreenCastFlag meta_screen_cast_stream_get_flags (MetaScreenCastStream *stre
 
 const char * meta_screen_cast_stream_get_mapping_id (MetaScreenCastStream *stream);
 
+void meta_screen_cast_stream_set_throttled (MetaScreenCastStream *stream,
+                                            gboolean              throttled);
+
 gboolean meta_screen_cast_stream_is_configured (MetaScreenCastStream *stream);
 
 void meta_screen_cast_stream_notify_is_configured (MetaScreenCastStream *stream);
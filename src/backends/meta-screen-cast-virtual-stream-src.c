@@ -59,6 +59,10 @@ struct _MetaScreenCastVirtualStreamSrc
   gulong prepare_frame_handler_id;
 
   gulong monitors_changed_handler_id;
+
+  gboolean is_streaming;
+  ClutterFrameClock *inhibited_frame_clock;
+  gulong inhibit_monitors_changed_handler_id;
 };
 
 static void
@@ -134,6 +138,45 @@ meta_screen_cast_virtual_stream_src_logical_monitor (MetaScreenCastVirtualStream
   return meta_monitor_get_logical_monitor (monitor);
 }
 
+/*
+ * Nothing consumes what the virtual monitor shows while the stream isn't
+ * streaming, so don't let its view paint anything until it is.
+ */
+static void
+update_frame_clock_inhibition (MetaScreenCastVirtualStreamSrc *virtual_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (virtual_src);
+  ClutterFrameClock *frame_clock = NULL;
+
+  if (!virtual_src->is_streaming && virtual_src->virtual_monitor)
+    {
+      MetaBackend *backend = backend_from_src (src);
+      MetaRenderer *renderer = meta_backend_get_renderer (backend);
+      MetaCrtc *crtc =
+        meta_virtual_monitor_get_crtc (virtual_src->virtual_monitor);
+      MetaRendererView *view;
+
+      view = meta_renderer_get_view_for_crtc (renderer, crtc);
+      if (view)
+        frame_clock = clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (view));
+    }
+
+  if (frame_clock == virtual_src->inhibited_frame_clock)
+    return;
+
+  if (virtual_src->inhibited_frame_clock)
+    {
+      clutter_frame_clock_uninhibit (virtual_src->inhibited_frame_clock);
+      g_clear_object (&virtual_src->inhibited_frame_clock);
+    }
+
+  if (frame_clock)
+    {
+      clutter_frame_clock_inhibit (frame_clock);
+      virtual_src->inhibited_frame_clock = g_object_ref (frame_clock);
+    }
+}
+
 static void
 sync_cursor_state (MetaScreenCastVirtualStreamSrc *virtual_src)
 {
@@ -337,6 +380,9 @@ meta_screen_cast_virtual_stream_src_enable (MetaScreenCastStreamSrc *src)
       break;
     }
 
+  virtual_src->is_streaming = TRUE;
+  update_frame_clock_inhibition (virtual_src);
+
   init_record_callbacks (virtual_src);
   clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (stage_from_src (src)),
                                         NULL);
@@ -384,6 +430,9 @@ meta_screen_cast_virtual_stream_src_disable (MetaScreenCastStreamSrc *src)
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
       break;
     }
+
+  virtual_src->is_streaming = FALSE;
+  update_frame_clock_inhibition (virtual_src);
 }
 
 static gboolean
@@ -672,6 +721,13 @@ create_virtual_monitor (MetaScreenCastVirtualStreamSrc  *virtual_src,
                                                       error);
 }
 
+static void
+on_monitors_changed_update_inhibition (MetaMonitorManager             *monitor_manager,
+                                       MetaScreenCastVirtualStreamSrc *virtual_src)
+{
+  update_frame_clock_inhibition (virtual_src);
+}
+
 static void
 ensure_virtual_monitor (MetaScreenCastVirtualStreamSrc *virtual_src,
                         struct spa_video_info_raw      *video_format)
@@ -716,6 +772,11 @@ ensure_virtual_monitor (MetaScreenCastVirtualStreamSrc *virtual_src,
     }
   virtual_src->virtual_monitor = virtual_monitor;
 
+  virtual_src->inhibit_monitors_changed_handler_id =
+    g_signal_connect (monitor_manager, "monitors-changed-internal",
+                      G_CALLBACK (on_monitors_changed_update_inhibition),
+                      virtual_src);
+
   meta_monitor_manager_reload (monitor_manager);
 }
 
@@ -762,9 +823,21 @@ meta_screen_cast_virtual_stream_src_dispose (GObject *object)
   GObjectClass *parent_class =
     G_OBJECT_CLASS (meta_screen_cast_virtual_stream_src_parent_class);
 
+  if (virtual_src->inhibit_monitors_changed_handler_id)
+    {
+      MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (virtual_src);
+      MetaBackend *backend = backend_from_src (src);
+      MetaMonitorManager *monitor_manager =
+        meta_backend_get_monitor_manager (backend);
+
+      g_clear_signal_handler (&virtual_src->inhibit_monitors_changed_handler_id,
+                              monitor_manager);
+    }
+
   parent_class->dispose (object);
 
   g_clear_object (&virtual_src->virtual_monitor);
+  update_frame_clock_inhibition (virtual_src);
 }
 
 static void
@@ -41,6 +41,8 @@ struct _MetaScreenCastWindowStreamSrc
 
   gboolean cursor_bitmap_invalid;
 
+  MtkRectangle last_buffer_bounds;
+
   struct {
     gboolean set;
     int x;
@@ -378,12 +380,39 @@ screen_cast_window_damaged (MetaWindowActor               *actor,
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
   MetaScreenCastPaintPhase paint_phase;
   MetaScreenCastRecordFlag flags;
+  const MtkRegion *damage;
+  g_autoptr (MtkRegion) redraw_clip = NULL;
+  MtkRectangle buffer_bounds;
+
+  meta_screen_cast_window_get_buffer_bounds (window_src->screen_cast_window,
+                                             &buffer_bounds);
+
+  damage = meta_screen_cast_window_get_damage (window_src->screen_cast_window);
+
+  /* Damage doesn't cover what a resized window no longer occupies. */
+  if (damage &&
+      mtk_rectangle_equal (&buffer_bounds, &window_src->last_buffer_bounds))
+    {
+      redraw_clip = mtk_region_copy (damage);
+    }
+  else
+    {
+      MtkRectangle stream_rect;
+
+      stream_rect = (MtkRectangle) {
+        .width = get_stream_width (window_src),
+        .height = get_stream_height (window_src),
+      };
+      redraw_clip = mtk_region_create_rectangle (&stream_rect);
+    }
+
+  window_src->last_buffer_bounds = buffer_bounds;
 
   flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
   paint_phase = META_SCREEN_CAST_PAINT_PHASE_DETACHED;
   meta_screen_cast_stream_src_maybe_record_frame (src, flags,
                                                   paint_phase,
-                                                  NULL);
+                                                  redraw_clip);
 }
 
 static void
@@ -532,7 +561,8 @@ meta_screen_cast_window_stream_src_record_to_framebuffer (MetaScreenCastStreamSr
 {
   MetaScreenCastWindowStreamSrc *window_src =
     META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
-  MetaScreenCastStream *stream;
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  const MtkRegion *clip = NULL;
   MtkRectangle stream_rect;
 
   stream_rect.x = 0;
@@ -540,8 +570,15 @@ meta_screen_cast_window_stream_src_record_to_framebuffer (MetaScreenCastStreamSr
   stream_rect.width = cogl_framebuffer_get_width (framebuffer);
   stream_rect.height = cogl_framebuffer_get_height (framebuffer);
 
+  /* A reused buffer only needs the damaged part of the window repainted,
+   * unless the cursor is painted in, as it leaves traces when moved. */
+  if (meta_screen_cast_stream_get_cursor_mode (stream) !=
+      META_SCREEN_CAST_CURSOR_MODE_EMBEDDED)
+    clip = meta_screen_cast_stream_src_get_buffer_damage (src);
+
   if (!meta_screen_cast_window_blit_to_framebuffer (window_src->screen_cast_window,
                                                     &stream_rect,
+                                                    clip,
                                                     framebuffer))
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
@@ -549,7 +586,6 @@ meta_screen_cast_window_stream_src_record_to_framebuffer (MetaScreenCastStreamSr
       return FALSE;
     }
 
-  stream = meta_screen_cast_stream_src_get_stream (src);
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
     {
     case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
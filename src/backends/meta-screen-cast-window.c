@@ -81,12 +81,14 @@ meta_screen_cast_window_capture_into (MetaScreenCastWindow *screen_cast_window,
 gboolean
 meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                              MtkRectangle         *bounds,
+                                             const MtkRegion      *clip,
                                              CoglFramebuffer      *framebuffer)
 {
   MetaScreenCastWindowInterface *iface =
     META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window);
 
-  return iface->blit_to_framebuffer (screen_cast_window, bounds, framebuffer);
+  return iface->blit_to_framebuffer (screen_cast_window, bounds, clip,
+                                     framebuffer);
 }
 
 gboolean
@@ -98,6 +100,19 @@ meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window)
   return iface->has_damage (screen_cast_window);
 }
 
+/*
+ * Returns the region, in buffer coordinates, damaged since the last time the
+ * window was reported as damaged, or NULL if it isn't known.
+ */
+const MtkRegion *
+meta_screen_cast_window_get_damage (MetaScreenCastWindow *screen_cast_window)
+{
+  MetaScreenCastWindowInterface *iface =
+    META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window);
+
+  return iface->get_damage (screen_cast_window);
+}
+
 void
 meta_screen_cast_window_inc_usage (MetaScreenCastWindow *screen_cast_window)
 {
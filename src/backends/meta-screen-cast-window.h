@@ -56,10 +56,13 @@ struct _MetaScreenCastWindowInterface
 
   gboolean (*blit_to_framebuffer) (MetaScreenCastWindow *screen_cast_window,
                                    MtkRectangle         *bounds,
+                                   const MtkRegion      *clip,
                                    CoglFramebuffer      *framebuffer);
 
   gboolean (*has_damage) (MetaScreenCastWindow *screen_cast_window);
 
+  const MtkRegion * (*get_damage) (MetaScreenCastWindow *screen_cast_window);
+
   void (*inc_usage) (MetaScreenCastWindow *screen_cast_window);
   void (*dec_usage) (MetaScreenCastWindow *screen_cast_window);
 };
@@ -86,10 +89,13 @@ void meta_screen_cast_window_capture_into (MetaScreenCastWindow *screen_cast_win
 
 gboolean meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                                       MtkRectangle         *bounds,
+                                                      const MtkRegion      *clip,
                                                       CoglFramebuffer      *framebuffer);
 
 gboolean meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window);
 
+const MtkRegion * meta_screen_cast_window_get_damage (MetaScreenCastWindow *screen_cast_window);
+
 void meta_screen_cast_window_inc_usage (MetaScreenCastWindow *screen_cast_window);
 void meta_screen_cast_window_dec_usage (MetaScreenCastWindow *screen_cast_window);
 
@@ -25,8 +25,11 @@
 #include <pipewire/pipewire.h>
 
 #include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-monitor.h"
 #include "backends/meta-remote-desktop-session.h"
 #include "backends/meta-screen-cast-session.h"
+#include "clutter/clutter-mutter.h"
 
 #ifdef HAVE_NATIVE_BACKEND
 #include "backends/native/meta-drm-buffer.h"
@@ -40,9 +43,31 @@
 #define META_SCREEN_CAST_DBUS_PATH "/org/gnome/Mutter/ScreenCast"
 #define META_SCREEN_CAST_API_VERSION 4
 
+/*
+ * A stage paint of a monitor that can be reused by every stream capturing
+ * the same monitor with the same paint flags, as long as the stage didn't
+ * present a new frame in between.
+ */
+struct _MetaScreenCastSharedFrame
+{
+  MetaScreenCast *screen_cast;
+  int users;
+
+  MetaMonitor *monitor;
+  ClutterPaintFlag paint_flags;
+
+  CoglOffscreen *offscreen;
+  gboolean is_valid;
+  int64_t frame_counter;
+  MtkRectangle layout;
+  float scale;
+};
+
 struct _MetaScreenCast
 {
   MetaDbusSessionManager parent;
+
+  GList *shared_frames;
 };
 
 G_DEFINE_TYPE (MetaScreenCast, meta_screen_cast,
@@ -300,6 +325,166 @@ meta_screen_cast_create_dma_buf_handle (MetaScreenCast  *screen_cast,
 #endif
 }
 
+MetaScreenCastSharedFrame *
+meta_screen_cast_acquire_shared_frame (MetaScreenCast   *screen_cast,
+                                       MetaMonitor      *monitor,
+                                       ClutterPaintFlag  paint_flags)
+{
+  MetaScreenCastSharedFrame *shared_frame;
+  GList *l;
+
+  for (l = screen_cast->shared_frames; l; l = l->next)
+    {
+      shared_frame = l->data;
+
+      if (shared_frame->monitor == monitor &&
+          shared_frame->paint_flags == paint_flags)
+        {
+          shared_frame->users++;
+          return shared_frame;
+        }
+    }
+
+  shared_frame = g_new0 (MetaScreenCastSharedFrame, 1);
+  shared_frame->screen_cast = screen_cast;
+  shared_frame->users = 1;
+  shared_frame->monitor = g_object_ref (monitor);
+  shared_frame->paint_flags = paint_flags;
+
+  screen_cast->shared_frames = g_list_prepend (screen_cast->shared_frames,
+                                               shared_frame);
+
+  return shared_frame;
+}
+
+void
+meta_screen_cast_release_shared_frame (MetaScreenCast            *screen_cast,
+                                       MetaScreenCastSharedFrame *shared_frame)
+{
+  g_return_if_fail (shared_frame->users > 0);
+
+  shared_frame->users--;
+  if (shared_frame->users > 0)
+    return;
+
+  screen_cast->shared_frames = g_list_remove (screen_cast->shared_frames,
+                                              shared_frame);
+
+  g_clear_object (&shared_frame->offscreen);
+  g_clear_object (&shared_frame->monitor);
+  g_free (shared_frame);
+}
+
+gboolean
+meta_screen_cast_shared_frame_is_shared (MetaScreenCastSharedFrame *shared_frame)
+{
+  return shared_frame->users > 1;
+}
+
+static gboolean
+ensure_shared_frame_offscreen (MetaScreenCastSharedFrame  *shared_frame,
+                               int                         width,
+                               int                         height,
+                               GError                    **error)
+{
+  MetaBackend *backend = meta_screen_cast_get_backend (shared_frame->screen_cast);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  if (shared_frame->offscreen)
+    {
+      CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (shared_frame->offscreen);
+
+      if (cogl_framebuffer_get_width (framebuffer) == width &&
+          cogl_framebuffer_get_height (framebuffer) == height)
+        return TRUE;
+
+      g_clear_object (&shared_frame->offscreen);
+    }
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_texture_set_auto_mipmap (texture, FALSE);
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  shared_frame->offscreen = g_steal_pointer (&offscreen);
+  return TRUE;
+}
+
+/*
+ * Returns a framebuffer with the monitor painted as it is in the current
+ * stage frame. The stage is only painted by the first caller of a frame; the
+ * others get the same framebuffer back to copy from.
+ */
+CoglFramebuffer *
+meta_screen_cast_shared_frame_paint (MetaScreenCastSharedFrame  *shared_frame,
+                                     int                         width,
+                                     int                         height,
+                                     GError                    **error)
+{
+  MetaBackend *backend = meta_screen_cast_get_backend (shared_frame->screen_cast);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  MetaLogicalMonitor *logical_monitor;
+  CoglFramebuffer *framebuffer;
+  MtkRectangle layout;
+  int64_t frame_counter;
+  float scale;
+
+  logical_monitor = meta_monitor_get_logical_monitor (shared_frame->monitor);
+  if (!logical_monitor)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Monitor is not active");
+      return NULL;
+    }
+
+  layout = meta_logical_monitor_get_layout (logical_monitor);
+  if (meta_backend_is_stage_views_scaled (backend))
+    scale = meta_logical_monitor_get_scale (logical_monitor);
+  else
+    scale = 1.0;
+
+  frame_counter = clutter_stage_get_frame_counter (stage);
+
+  if (shared_frame->offscreen && shared_frame->is_valid)
+    {
+      framebuffer = COGL_FRAMEBUFFER (shared_frame->offscreen);
+
+      if (shared_frame->frame_counter == frame_counter &&
+          shared_frame->scale == scale &&
+          mtk_rectangle_equal (&shared_frame->layout, &layout) &&
+          cogl_framebuffer_get_width (framebuffer) == width &&
+          cogl_framebuffer_get_height (framebuffer) == height)
+        return framebuffer;
+    }
+
+  shared_frame->is_valid = FALSE;
+
+  if (!ensure_shared_frame_offscreen (shared_frame, width, height, error))
+    return NULL;
+
+  framebuffer = COGL_FRAMEBUFFER (shared_frame->offscreen);
+  clutter_stage_paint_to_framebuffer (stage,
+                                      framebuffer,
+                                      &layout,
+                                      scale,
+                                      shared_frame->paint_flags);
+
+  shared_frame->is_valid = TRUE;
+  shared_frame->frame_counter = frame_counter;
+  shared_frame->layout = layout;
+  shared_frame->scale = scale;
+
+  return framebuffer;
+}
+
 static MetaRemoteDesktopSession *
 find_remote_desktop_session (MetaDbusSessionManager  *session_manager,
                              const char              *remote_desktop_session_id,
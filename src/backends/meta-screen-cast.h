@@ -42,6 +42,8 @@ typedef enum _MetaScreenCastFlag
   META_SCREEN_CAST_FLAG_IS_PLATFORM = 1 << 1,
 } MetaScreenCastFlag;
 
+typedef struct _MetaScreenCastSharedFrame MetaScreenCastSharedFrame;
+
 #define META_TYPE_SCREEN_CAST (meta_screen_cast_get_type ())
 G_DECLARE_FINAL_TYPE (MetaScreenCast, meta_screen_cast,
                       META, SCREEN_CAST,
@@ -65,4 +67,18 @@ CoglDmaBufHandle * meta_screen_cast_create_dma_buf_handle (MetaScreenCast  *scre
                                                            int              width,
                                                            int              height);
 
+MetaScreenCastSharedFrame * meta_screen_cast_acquire_shared_frame (MetaScreenCast   *screen_cast,
+                                                                   MetaMonitor      *monitor,
+                                                                   ClutterPaintFlag  paint_flags);
+
+void meta_screen_cast_release_shared_frame (MetaScreenCast            *screen_cast,
+                                            MetaScreenCastSharedFrame *shared_frame);
+
+gboolean meta_screen_cast_shared_frame_is_shared (MetaScreenCastSharedFrame *shared_frame);
+
+CoglFramebuffer * meta_screen_cast_shared_frame_paint (MetaScreenCastSharedFrame  *shared_frame,
+                                                       int                         width,
+                                                       int                         height,
+                                                       GError                    **error);
+
 MetaScreenCast * meta_screen_cast_new (MetaBackend *backend);
@@ -33,6 +33,10 @@ typedef enum _MetaExperimentalFeature
   META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND  = (1 << 2),
   META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE = (1 << 3),
   META_EXPERIMENTAL_FEATURE_XWAYLAND_NATIVE_SCALING  = (1 << 4),
+  META_EXPERIMENTAL_FEATURE_PROGRAM_BINARY_CACHE = (1 << 5),
+  META_EXPERIMENTAL_FEATURE_SHM_DAMAGE_REFINEMENT = (1 << 6),
+  META_EXPERIMENTAL_FEATURE_XWAYLAND_PREWARM = (1 << 7),
+  META_EXPERIMENTAL_FEATURE_KMS_COLOR_TRANSFORM = (1 << 8),
 } MetaExperimentalFeature;
 
 typedef enum _MetaXwaylandExtension
@@ -49,6 +49,10 @@ static GDebugKey experimental_feature_keys[] = {
   { "autoclose-xwayland", META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND },
   { "variable-refresh-rate", META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE },
   { "xwayland-native-scaling", META_EXPERIMENTAL_FEATURE_XWAYLAND_NATIVE_SCALING },
+  { "program-binary-cache", META_EXPERIMENTAL_FEATURE_PROGRAM_BINARY_CACHE },
+  { "shm-damage-refinement", META_EXPERIMENTAL_FEATURE_SHM_DAMAGE_REFINEMENT },
+  { "xwayland-prewarm", META_EXPERIMENTAL_FEATURE_XWAYLAND_PREWARM },
+  { "kms-color-transform", META_EXPERIMENTAL_FEATURE_KMS_COLOR_TRANSFORM },
 };
 
 static guint signals[N_SIGNALS];
@@ -310,6 +314,14 @@ experimental_features_handler (GVariant *features_variant,
         feature = META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE;
       else if (g_str_equal (feature_str, "xwayland-native-scaling"))
         feature = META_EXPERIMENTAL_FEATURE_XWAYLAND_NATIVE_SCALING;
+      else if (g_str_equal (feature_str, "program-binary-cache"))
+        feature = META_EXPERIMENTAL_FEATURE_PROGRAM_BINARY_CACHE;
+      else if (g_str_equal (feature_str, "shm-damage-refinement"))
+        feature = META_EXPERIMENTAL_FEATURE_SHM_DAMAGE_REFINEMENT;
+      else if (g_str_equal (feature_str, "xwayland-prewarm"))
+        feature = META_EXPERIMENTAL_FEATURE_XWAYLAND_PREWARM;
+      else if (g_str_equal (feature_str, "kms-color-transform"))
+        feature = META_EXPERIMENTAL_FEATURE_KMS_COLOR_TRANSFORM;
 
       if (feature)
         g_message ("Enabling experimental feature '%s'", feature_str);
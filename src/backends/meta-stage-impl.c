@@ -404,14 +404,23 @@ static void
 paint_stage (MetaStageImpl    *stage_impl,
              ClutterStageView *stage_view,
              MtkRegion        *redraw_clip,
+             MtkRegion        *blit_clip,
              ClutterFrame     *frame)
 {
   ClutterStage *stage = stage_impl->wrapper;
+  CoglFramebuffer *framebuffer =
+    clutter_stage_view_get_framebuffer (stage_view);
 
   _clutter_stage_maybe_setup_viewport (stage, stage_view);
+  clutter_stage_view_begin_gpu_phase (stage_view,
+                                      CLUTTER_GPU_PHASE_STAGE,
+                                      framebuffer);
   clutter_stage_paint_view (stage, stage_view, redraw_clip, frame);
+  clutter_stage_view_end_gpu_phase (stage_view,
+                                    CLUTTER_GPU_PHASE_STAGE,
+                                    framebuffer);
 
-  clutter_stage_view_after_paint (stage_view, redraw_clip);
+  clutter_stage_view_after_paint (stage_view, blit_clip);
 }
 
 static MtkRegion *
@@ -497,10 +506,15 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
   MtkRectangle view_rect;
   gboolean is_full_redraw;
   gboolean use_clipped_redraw;
+  gboolean use_clipped_swap;
   gboolean buffer_has_valid_damage_history = FALSE;
   gboolean has_buffer_age;
+  gboolean has_shadowfb;
+  gboolean has_view_offscreen;
   gboolean swap_with_damage;
   g_autoptr (MtkRegion) redraw_clip = NULL;
+  g_autoptr (MtkRegion) blit_clip = NULL;
+  g_autoptr (MtkRegion) fb_blit_region = NULL;
   g_autoptr (MtkRegion) queued_redraw_clip = NULL;
   g_autoptr (MtkRegion) fb_clip_region = NULL;
   g_autoptr (MtkRegion) swap_region = NULL;
@@ -524,6 +538,8 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
   has_buffer_age =
     COGL_IS_ONSCREEN (onscreen) &&
     cogl_context_has_winsys_feature (context, COGL_WINSYS_FEATURE_BUFFER_AGE);
+  has_shadowfb = clutter_stage_view_has_shadowfb (stage_view);
+  has_view_offscreen = fb != onscreen && !has_shadowfb;
 
   redraw_clip = clutter_stage_view_take_accumulated_redraw_clip (stage_view);
 
@@ -535,7 +551,11 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
 
   damage_history = meta_stage_view_get_damage_history (view);
 
-  if (has_buffer_age)
+  /* The shadow framebuffer retains its contents between frames, and the
+   * stage view repairs the onscreen back buffer itself when copying, so
+   * the onscreen buffer age only matters when painting to it directly.
+   */
+  if (has_buffer_age && !has_shadowfb)
     {
       buffer_age = cogl_onscreen_get_buffer_age (COGL_ONSCREEN (onscreen));
       buffer_has_valid_damage_history =
@@ -545,14 +565,36 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
 
   meta_get_clutter_debug_flags (NULL, &paint_debug_flags, NULL);
 
+  /* Shadow framebuffers and view offscreens retain their contents, so the
+   * stage can always be painted clipped into them, whatever state the
+   * onscreen back buffer is in. Whether the onscreen buffer can be updated
+   * partially is decided separately, unless the shadow framebuffer copy
+   * takes care of the back buffer age already.
+   */
   use_clipped_redraw =
     should_use_clipped_redraw (is_full_redraw,
                                has_buffer_age,
                                buffer_has_valid_damage_history,
                                paint_debug_flags,
-                               onscreen,
+                               has_shadowfb || has_view_offscreen ? fb : onscreen,
                                stage_window);
 
+  if (use_clipped_redraw &&
+      (has_view_offscreen || (has_shadowfb && !has_buffer_age)))
+    {
+      use_clipped_swap =
+        should_use_clipped_redraw (is_full_redraw,
+                                   has_buffer_age,
+                                   buffer_has_valid_damage_history,
+                                   paint_debug_flags,
+                                   onscreen,
+                                   stage_window);
+    }
+  else
+    {
+      use_clipped_swap = use_clipped_redraw;
+    }
+
   if (use_clipped_redraw)
     {
       fb_clip_region = offset_scale_and_clamp_region (redraw_clip,
@@ -597,35 +639,53 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
    * artefacts.
    */
   /* swap_region does not need damage history, set it up before that */
-  if (!use_clipped_redraw)
+  if (!use_clipped_swap)
     swap_region = mtk_region_create ();
-  else if (clutter_stage_view_has_shadowfb (stage_view))
-    swap_region = mtk_region_ref (fb_clip_region);
   else
     swap_region = mtk_region_copy (fb_clip_region);
 
+  /* The view offscreen is painted onto the onscreen buffer within this
+   * region, which also has to repair what the back buffer is missing.
+   */
+  if (has_view_offscreen && use_clipped_swap)
+    fb_blit_region = mtk_region_copy (fb_clip_region);
+
   swap_with_damage = FALSE;
-  if (has_buffer_age)
+  if (has_buffer_age && has_shadowfb)
+    {
+      swap_with_damage = TRUE;
+    }
+  else if (has_buffer_age)
     {
       clutter_damage_history_record (damage_history, fb_clip_region);
 
-      if (use_clipped_redraw)
+      if (use_clipped_swap)
         {
+          MtkRegion *repair_region;
           int age;
 
+          /* Only the onscreen buffer is out of date when painting through
+           * a view offscreen, so there is no need to paint the stage again
+           * for the old damage.
+           */
+          if (has_view_offscreen)
+            repair_region = fb_blit_region;
+          else
+            repair_region = fb_clip_region;
+
           for (age = 1; age <= buffer_age; age++)
             {
               const MtkRegion *old_damage;
 
               old_damage =
                 clutter_damage_history_lookup (damage_history, age);
-              mtk_region_union (fb_clip_region, old_damage);
+              mtk_region_union (repair_region, old_damage);
             }
 
           meta_topic (META_DEBUG_BACKEND,
                       "Reusing back buffer(age=%d) - repairing region: num rects: %d",
                       buffer_age,
-                      mtk_region_num_rectangles (fb_clip_region));
+                      mtk_region_num_rectangles (repair_region));
 
           swap_with_damage = TRUE;
         }
@@ -650,20 +710,43 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
                                                    view_rect.y);
     }
 
+  if (fb_blit_region)
+    {
+      blit_clip = scale_offset_and_clamp_region (fb_blit_region,
+                                                 1.0f / fb_scale,
+                                                 view_rect.x,
+                                                 view_rect.y);
+    }
+  else if (use_clipped_swap || has_shadowfb)
+    {
+      blit_clip = mtk_region_ref (redraw_clip);
+    }
+  else
+    {
+      blit_clip = mtk_region_create_rectangle (&view_rect);
+    }
+
   if (paint_debug_flags & CLUTTER_DEBUG_PAINT_DAMAGE_REGION)
     {
       g_autoptr (MtkRegion) debug_redraw_clip = NULL;
 
       debug_redraw_clip = mtk_region_create_rectangle (&view_rect);
-      paint_stage (stage_impl, stage_view, debug_redraw_clip, frame);
+      paint_stage (stage_impl, stage_view,
+                   debug_redraw_clip, debug_redraw_clip,
+                   frame);
     }
   else if (use_clipped_redraw)
     {
-      queue_damage_region (stage_window, stage_view, fb_clip_region);
+      if (use_clipped_swap)
+        {
+          queue_damage_region (stage_window, stage_view,
+                               fb_blit_region ? fb_blit_region
+                                              : fb_clip_region);
+        }
 
       cogl_framebuffer_push_region_clip (fb, fb_clip_region);
 
-      paint_stage (stage_impl, stage_view, redraw_clip, frame);
+      paint_stage (stage_impl, stage_view, redraw_clip, blit_clip, frame);
 
       cogl_framebuffer_pop_clip (fb);
     }
@@ -671,7 +754,24 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     {
       meta_topic (META_DEBUG_BACKEND, "Unclipped stage paint");
 
-      paint_stage (stage_impl, stage_view, redraw_clip, frame);
+      paint_stage (stage_impl, stage_view, redraw_clip, blit_clip, frame);
+    }
+
+  if (redraw_clip)
+    {
+      int n_rectangles, i;
+      int64_t area = 0;
+
+      n_rectangles = mtk_region_num_rectangles (redraw_clip);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (redraw_clip, i);
+
+          area += mtk_rectangle_area (&rect);
+        }
+
+      COGL_PERF_COUNTER_ADD (RedrawClipArea, "RedrawClipArea",
+                             "area of the redraw clips painted", area);
     }
 
 #ifdef HAVE_PROFILER
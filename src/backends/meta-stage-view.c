@@ -70,6 +70,9 @@ frame_cb (CoglOnscreen  *onscreen,
       if (cogl_frame_info_is_vsync (frame_info))
         flags |= CLUTTER_FRAME_INFO_FLAG_VSYNC;
 
+      if (cogl_frame_info_is_hw_completion (frame_info))
+        flags |= CLUTTER_FRAME_INFO_FLAG_HW_COMPLETION;
+
       clutter_frame_info = (ClutterFrameInfo) {
         .frame_counter = cogl_frame_info_get_global_frame_counter (frame_info),
         .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
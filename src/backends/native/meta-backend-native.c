@@ -232,8 +232,27 @@ meta_backend_native_create_monitor_manager (MetaBackend *backend,
 static MetaColorManager *
 meta_backend_native_create_color_manager (MetaBackend *backend)
 {
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaBackendNativePrivate *priv =
+    meta_backend_native_get_instance_private (backend_native);
+
+  /* Headless instances only ever have virtual monitors, which never get a
+   * colord device, so don't keep a system bus connection around for it. */
   return g_object_new (META_TYPE_COLOR_MANAGER,
                        "backend", backend,
+                       "use-colord", priv->mode != META_BACKEND_NATIVE_MODE_HEADLESS,
+                       NULL);
+}
+
+static MetaOrientationManager *
+meta_backend_native_create_orientation_manager (MetaBackend *backend)
+{
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaBackendNativePrivate *priv =
+    meta_backend_native_get_instance_private (backend_native);
+
+  return g_object_new (META_TYPE_ORIENTATION_MANAGER,
+                       "watch-sensors", priv->mode != META_BACKEND_NATIVE_MODE_HEADLESS,
                        NULL);
 }
 
@@ -845,6 +864,8 @@ meta_backend_native_class_init (MetaBackendNativeClass *klass)
 
   backend_class->create_monitor_manager = meta_backend_native_create_monitor_manager;
   backend_class->create_color_manager = meta_backend_native_create_color_manager;
+  backend_class->create_orientation_manager =
+    meta_backend_native_create_orientation_manager;
   backend_class->get_cursor_renderer = meta_backend_native_get_cursor_renderer;
   backend_class->create_renderer = meta_backend_native_create_renderer;
   backend_class->get_input_settings = meta_backend_native_get_input_settings;
@@ -42,6 +42,14 @@ struct _MetaBarrierManagerNative
 {
   GHashTable *barriers;
   GMutex mutex;
+
+  /* Horizontal barriers sorted by y, and vertical barriers sorted by x,
+   * so that a motion only needs to look at the barriers it can cross.
+   * Rebuilt on the next motion after barriers are added or removed. */
+  GPtrArray *horizontal_barriers;
+  GPtrArray *vertical_barriers;
+  gboolean barrier_index_dirty;
+
   MetaBarrierImplNative *pointer_trap;
 };
 
@@ -231,6 +239,84 @@ maybe_release_barriers (MetaBarrierManagerNative *manager,
                         &motion);
 }
 
+static float
+get_barrier_position (MetaBarrierImplNative *self)
+{
+  MetaBorder *border = meta_barrier_get_border (self->barrier);
+
+  if (is_barrier_horizontal (self->barrier))
+    return border->line.a.y;
+  else
+    return border->line.a.x;
+}
+
+static int
+compare_barrier_position (gconstpointer a,
+                          gconstpointer b)
+{
+  float position_a =
+    get_barrier_position (*(MetaBarrierImplNative **) a);
+  float position_b =
+    get_barrier_position (*(MetaBarrierImplNative **) b);
+
+  if (position_a < position_b)
+    return -1;
+  else if (position_a > position_b)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+ensure_barrier_index (MetaBarrierManagerNative *manager)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  if (!manager->barrier_index_dirty)
+    return;
+
+  g_ptr_array_set_size (manager->horizontal_barriers, 0);
+  g_ptr_array_set_size (manager->vertical_barriers, 0);
+
+  g_hash_table_iter_init (&iter, manager->barriers);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      MetaBarrierImplNative *self = key;
+
+      if (is_barrier_horizontal (self->barrier))
+        g_ptr_array_add (manager->horizontal_barriers, self);
+      else
+        g_ptr_array_add (manager->vertical_barriers, self);
+    }
+
+  g_ptr_array_sort (manager->horizontal_barriers, compare_barrier_position);
+  g_ptr_array_sort (manager->vertical_barriers, compare_barrier_position);
+
+  manager->barrier_index_dirty = FALSE;
+}
+
+/* Returns the index of the first barrier positioned at or after @position. */
+static unsigned int
+find_first_barrier_from (GPtrArray *barriers,
+                         float      position)
+{
+  unsigned int low = 0;
+  unsigned int high = barriers->len;
+
+  while (low < high)
+    {
+      unsigned int mid = low + (high - low) / 2;
+
+      if (get_barrier_position (g_ptr_array_index (barriers, mid)) < position)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
 typedef struct _MetaClosestBarrierData
 {
   struct
@@ -292,6 +378,27 @@ update_closest_barrier (gpointer key,
     }
 }
 
+static void
+update_closest_barrier_in_range (GPtrArray              *barriers,
+                                 float                   min_position,
+                                 float                   max_position,
+                                 MetaClosestBarrierData *data)
+{
+  unsigned int i;
+
+  for (i = find_first_barrier_from (barriers, min_position);
+       i < barriers->len;
+       i++)
+    {
+      MetaBarrierImplNative *self = g_ptr_array_index (barriers, i);
+
+      if (get_barrier_position (self) > max_position)
+        break;
+
+      update_closest_barrier (self, NULL, data);
+    }
+}
+
 static gboolean
 get_closest_barrier (MetaBarrierManagerNative *manager,
                      float                     prev_x,
@@ -319,9 +426,14 @@ get_closest_barrier (MetaBarrierManagerNative *manager,
     },
   };
 
-  g_hash_table_foreach (manager->barriers,
-                        update_closest_barrier,
-                        &closest_barrier_data);
+  /* Only horizontal barriers between the two y coordinates of the motion,
+   * and vertical ones between its two x coordinates, can intersect it. */
+  update_closest_barrier_in_range (manager->horizontal_barriers,
+                                   MIN (prev_y, y), MAX (prev_y, y),
+                                   &closest_barrier_data);
+  update_closest_barrier_in_range (manager->vertical_barriers,
+                                   MIN (prev_x, x), MAX (prev_x, x),
+                                   &closest_barrier_data);
 
   if (closest_barrier_data.out.barrier_impl != NULL)
     {
@@ -567,6 +679,8 @@ meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
 
   g_mutex_lock (&manager->mutex);
 
+  ensure_barrier_index (manager);
+
   /* Get the direction of the motion vector. */
   if (prev_x < *x)
     motion_dir |= META_BARRIER_DIRECTION_POSITIVE_X;
@@ -654,6 +768,7 @@ meta_barrier_impl_native_destroy (MetaBarrierImpl *impl)
   if (self->manager->pointer_trap == self)
     self->manager->pointer_trap = NULL;
   g_hash_table_remove (self->manager->barriers, self);
+  self->manager->barrier_index_dirty = TRUE;
   g_mutex_unlock (&self->manager->mutex);
   g_main_context_unref (self->main_context);
   self->is_active = FALSE;
@@ -677,6 +792,7 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
   self->manager = manager;
   g_mutex_lock (&manager->mutex);
   g_hash_table_add (manager->barriers, self);
+  manager->barrier_index_dirty = TRUE;
   g_mutex_unlock (&manager->mutex);
 
   return META_BARRIER_IMPL (self);
@@ -705,6 +821,8 @@ meta_barrier_manager_native_new (void)
   manager = g_new0 (MetaBarrierManagerNative, 1);
 
   manager->barriers = g_hash_table_new (NULL, NULL);
+  manager->horizontal_barriers = g_ptr_array_new ();
+  manager->vertical_barriers = g_ptr_array_new ();
   g_mutex_init (&manager->mutex);
 
   return manager;
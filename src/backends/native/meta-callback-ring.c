@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * A single producer, single consumer queue of callbacks, invoked on the
+ * main context the ring was created for. Pushing is lock-free as long as
+ * the consumer keeps up; only if the ring is full are entries put on a
+ * locked overflow list, keeping the order they were pushed in. The
+ * consumer is woken up through an eventfd, once per batch of entries.
+ */
+
+#include "config.h"
+
+#include "backends/native/meta-callback-ring.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#define RING_SIZE 256
+
+G_STATIC_ASSERT ((RING_SIZE & (RING_SIZE - 1)) == 0);
+
+typedef struct _MetaCallbackRingEntry
+{
+  GSourceFunc func;
+  gpointer user_data;
+  GDestroyNotify destroy_notify;
+} MetaCallbackRingEntry;
+
+struct _MetaCallbackRing
+{
+  GSource base;
+
+  int eventfd;
+  int wakeup_pending;
+
+  MetaCallbackRingEntry entries[RING_SIZE];
+  unsigned int head; /* Only written by the consumer */
+  unsigned int tail; /* Only written by the producer */
+
+  GMutex overflow_mutex;
+  int overflowing;
+  GQueue overflow;
+};
+
+static void
+invoke_entry (MetaCallbackRingEntry *entry)
+{
+  entry->func (entry->user_data);
+
+  if (entry->destroy_notify)
+    entry->destroy_notify (entry->user_data);
+}
+
+static void
+drain_ring (MetaCallbackRing *ring)
+{
+  unsigned int head = ring->head;
+  unsigned int tail = g_atomic_int_get (&ring->tail);
+
+  while (head != tail)
+    {
+      MetaCallbackRingEntry entry = ring->entries[head % RING_SIZE];
+
+      head++;
+      g_atomic_int_set (&ring->head, head);
+
+      invoke_entry (&entry);
+    }
+}
+
+static void
+drain_overflow (MetaCallbackRing *ring)
+{
+  GQueue overflow;
+  MetaCallbackRingEntry *entry;
+
+  g_mutex_lock (&ring->overflow_mutex);
+  overflow = ring->overflow;
+  g_queue_init (&ring->overflow);
+  g_atomic_int_set (&ring->overflowing, FALSE);
+  g_mutex_unlock (&ring->overflow_mutex);
+
+  while ((entry = g_queue_pop_head (&overflow)))
+    {
+      invoke_entry (entry);
+      g_free (entry);
+    }
+}
+
+static gboolean
+callback_ring_dispatch (GSource     *source,
+                        GSourceFunc  callback,
+                        gpointer     user_data)
+{
+  MetaCallbackRing *ring = (MetaCallbackRing *) source;
+  uint64_t value;
+
+  if (read (ring->eventfd, &value, sizeof (value)) == -1 &&
+      errno != EAGAIN)
+    {
+      g_warning ("Failed to read from callback ring eventfd: %s",
+                 g_strerror (errno));
+    }
+
+  g_atomic_int_set (&ring->wakeup_pending, FALSE);
+
+  drain_ring (ring);
+
+  if (g_atomic_int_get (&ring->overflowing))
+    {
+      /* The producer stops using the ring once it overflowed, so drain
+       * what it managed to push before that first. */
+      drain_ring (ring);
+      drain_overflow (ring);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+callback_ring_finalize (GSource *source)
+{
+  MetaCallbackRing *ring = (MetaCallbackRing *) source;
+  MetaCallbackRingEntry *entry;
+
+  while (ring->head != ring->tail)
+    {
+      entry = &ring->entries[ring->head % RING_SIZE];
+      if (entry->destroy_notify)
+        entry->destroy_notify (entry->user_data);
+      ring->head++;
+    }
+
+  while ((entry = g_queue_pop_head (&ring->overflow)))
+    {
+      if (entry->destroy_notify)
+        entry->destroy_notify (entry->user_data);
+      g_free (entry);
+    }
+
+  g_mutex_clear (&ring->overflow_mutex);
+  g_clear_fd (&ring->eventfd, NULL);
+}
+
+static GSourceFuncs callback_ring_source_funcs = {
+  .dispatch = callback_ring_dispatch,
+  .finalize = callback_ring_finalize,
+};
+
+MetaCallbackRing *
+meta_callback_ring_new (GMainContext  *main_context,
+                        const char    *name,
+                        GError       **error)
+{
+  GSource *source;
+  MetaCallbackRing *ring;
+  int fd;
+
+  fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd == -1)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "Failed to create eventfd: %s", g_strerror (errno));
+      return NULL;
+    }
+
+  source = g_source_new (&callback_ring_source_funcs,
+                         sizeof (MetaCallbackRing));
+  g_source_set_name (source, name);
+  g_source_set_priority (source, G_PRIORITY_HIGH);
+
+  ring = (MetaCallbackRing *) source;
+  ring->eventfd = fd;
+  g_mutex_init (&ring->overflow_mutex);
+  g_queue_init (&ring->overflow);
+
+  g_source_add_unix_fd (source, fd, G_IO_IN);
+  g_source_attach (source, main_context);
+
+  return ring;
+}
+
+void
+meta_callback_ring_free (MetaCallbackRing *ring)
+{
+  GSource *source = (GSource *) ring;
+
+  g_source_destroy (source);
+  g_source_unref (source);
+}
+
+static void
+push_overflow (MetaCallbackRing      *ring,
+               MetaCallbackRingEntry *entry)
+{
+  g_mutex_lock (&ring->overflow_mutex);
+  g_queue_push_tail (&ring->overflow,
+                     g_memdup2 (entry, sizeof (MetaCallbackRingEntry)));
+  g_atomic_int_set (&ring->overflowing, TRUE);
+  g_mutex_unlock (&ring->overflow_mutex);
+}
+
+/*
+ * meta_callback_ring_push:
+ *
+ * Queues @func to be invoked once on the ring's main context, followed by
+ * @destroy_notify. Must only be called from a single thread.
+ */
+void
+meta_callback_ring_push (MetaCallbackRing *ring,
+                         GSourceFunc       func,
+                         gpointer          user_data,
+                         GDestroyNotify    destroy_notify)
+{
+  MetaCallbackRingEntry entry = {
+    .func = func,
+    .user_data = user_data,
+    .destroy_notify = destroy_notify,
+  };
+  unsigned int tail = ring->tail;
+
+  if (G_UNLIKELY (g_atomic_int_get (&ring->overflowing)) ||
+      G_UNLIKELY (tail - g_atomic_int_get (&ring->head) == RING_SIZE))
+    {
+      push_overflow (ring, &entry);
+    }
+  else
+    {
+      ring->entries[tail % RING_SIZE] = entry;
+      g_atomic_int_set (&ring->tail, tail + 1);
+    }
+
+  if (!g_atomic_int_exchange (&ring->wakeup_pending, TRUE))
+    {
+      uint64_t value = 1;
+
+      if (write (ring->eventfd, &value, sizeof (value)) == -1)
+        {
+          g_warning ("Failed to write to callback ring eventfd: %s",
+                     g_strerror (errno));
+        }
+    }
+}
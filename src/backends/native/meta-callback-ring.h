@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+
+typedef struct _MetaCallbackRing MetaCallbackRing;
+
+MetaCallbackRing * meta_callback_ring_new (GMainContext  *main_context,
+                                           const char    *name,
+                                           GError       **error);
+
+void meta_callback_ring_free (MetaCallbackRing *ring);
+
+void meta_callback_ring_push (MetaCallbackRing *ring,
+                              GSourceFunc       func,
+                              gpointer          user_data,
+                              GDestroyNotify    destroy_notify);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaCallbackRing, meta_callback_ring_free)
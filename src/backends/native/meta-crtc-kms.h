@@ -41,6 +41,8 @@ MetaKmsPlane * meta_crtc_kms_get_assigned_primary_plane (MetaCrtcKms *crtc_kms);
 
 MetaKmsPlane * meta_crtc_kms_get_assigned_cursor_plane (MetaCrtcKms *crtc_kms);
 
+MetaKmsPlane * meta_crtc_kms_get_assigned_overlay_plane (MetaCrtcKms *crtc_kms);
+
 void meta_crtc_kms_assign_planes (MetaCrtcKms  *crtc_kms,
                                   MetaKmsPlane *primary_plane,
                                   MetaKmsPlane *cursor_plane);
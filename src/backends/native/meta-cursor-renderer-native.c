@@ -50,6 +50,7 @@
 #include "backends/native/meta-kms.h"
 #include "backends/native/meta-renderer-native.h"
 #include "backends/native/meta-seat-native.h"
+#include "clutter/clutter-mutter.h"
 #include "common/meta-cogl-drm-formats.h"
 #include "core/boxes-private.h"
 #include "meta/boxes.h"
@@ -100,19 +101,51 @@ typedef struct _MetaCursorRendererNativeGpuData
   uint64_t cursor_height;
 } MetaCursorRendererNativeGpuData;
 
-typedef struct _MetaCursorNativePrivate
+/* Upper bound of preprocessed frames kept per cursor sprite; enough for
+ * the animated theme cursors on a few differently scaled or rotated
+ * monitors.
+ */
+#define MAX_PREPROCESSED_CURSOR_FRAMES 64
+
+typedef struct _PreprocessedCursorFrame
 {
-  GHashTable *gpu_states;
+  int frame;
+  float scale;
+  MtkMonitorTransform transform;
+  ClutterColorState *target_color_state;
+
+  GBytes *pixels;
+  int width;
+  int height;
+  int rowstride;
+} PreprocessedCursorFrame;
 
-  struct {
-    gboolean can_preprocess;
-    float current_relative_scale;
-    MtkMonitorTransform current_relative_transform;
-  } preprocess_state;
+typedef struct _MetaCursorNativePrivate
+{
+  unsigned int images_serial;
+  GPtrArray *preprocessed_frames;
 } MetaCursorNativePrivate;
 
+/* The cursor buffers of every frame of the animated cursor shown on a CRTC,
+ * so that cycling through the frames only swaps the cursor plane buffer.
+ */
+typedef struct _CursorFrameRing
+{
+  MetaCursorSprite *cursor_sprite;
+  unsigned int images_serial;
+  float scale;
+  MtkMonitorTransform transform;
+  ClutterColorState *target_color_state;
+
+  GPtrArray *buffers;
+} CursorFrameRing;
+
+/* Animated cursors with more frames than this are not kept around */
+#define MAX_CURSOR_FRAME_RING_SIZE 64
+
 static GQuark quark_cursor_renderer_native_gpu_data = 0;
 static GQuark quark_cursor_stage_view = 0;
+static GQuark quark_cursor_frame_ring = 0;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaCursorRendererNative, meta_cursor_renderer_native, META_TYPE_CURSOR_RENDERER);
 
@@ -173,6 +206,210 @@ meta_create_cursor_renderer_native_gpu_data (MetaGpuKms *gpu_kms)
   return cursor_renderer_gpu_data;
 }
 
+static void
+preprocessed_cursor_frame_free (PreprocessedCursorFrame *preprocessed_frame)
+{
+  g_clear_object (&preprocessed_frame->target_color_state);
+  g_clear_pointer (&preprocessed_frame->pixels, g_bytes_unref);
+  g_free (preprocessed_frame);
+}
+
+static void
+cursor_native_private_free (MetaCursorNativePrivate *cursor_priv)
+{
+  g_clear_pointer (&cursor_priv->preprocessed_frames, g_ptr_array_unref);
+  g_free (cursor_priv);
+}
+
+static MetaCursorNativePrivate *
+ensure_cursor_native_private (MetaCursorSprite *cursor_sprite)
+{
+  MetaCursorNativePrivate *cursor_priv;
+
+  cursor_priv = g_object_get_qdata (G_OBJECT (cursor_sprite),
+                                    quark_cursor_sprite);
+  if (!cursor_priv)
+    {
+      cursor_priv = g_new0 (MetaCursorNativePrivate, 1);
+      cursor_priv->preprocessed_frames =
+        g_ptr_array_new_with_free_func ((GDestroyNotify) preprocessed_cursor_frame_free);
+      g_object_set_qdata_full (G_OBJECT (cursor_sprite),
+                               quark_cursor_sprite,
+                               cursor_priv,
+                               (GDestroyNotify) cursor_native_private_free);
+    }
+
+  return cursor_priv;
+}
+
+/*
+ * Only the frames of theme cursors are cached, as they are immutable until
+ * the theme is reloaded; client cursors change content with every commit.
+ */
+static PreprocessedCursorFrame *
+lookup_preprocessed_cursor_frame (MetaCursorSprite    *cursor_sprite,
+                                  ClutterColorState   *target_color_state,
+                                  float                scale,
+                                  MtkMonitorTransform  transform)
+{
+  MetaCursorSpriteXcursor *sprite_xcursor;
+  MetaCursorNativePrivate *cursor_priv;
+  int frame;
+  unsigned int i;
+
+  if (!META_IS_CURSOR_SPRITE_XCURSOR (cursor_sprite))
+    return NULL;
+
+  cursor_priv = g_object_get_qdata (G_OBJECT (cursor_sprite),
+                                    quark_cursor_sprite);
+  if (!cursor_priv)
+    return NULL;
+
+  sprite_xcursor = META_CURSOR_SPRITE_XCURSOR (cursor_sprite);
+  if (cursor_priv->images_serial !=
+      meta_cursor_sprite_xcursor_get_images_serial (sprite_xcursor))
+    return NULL;
+
+  frame = meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor);
+
+  for (i = 0; i < cursor_priv->preprocessed_frames->len; i++)
+    {
+      PreprocessedCursorFrame *preprocessed_frame =
+        g_ptr_array_index (cursor_priv->preprocessed_frames, i);
+
+      if (preprocessed_frame->frame == frame &&
+          G_APPROX_VALUE (preprocessed_frame->scale, scale, FLT_EPSILON) &&
+          preprocessed_frame->transform == transform &&
+          clutter_color_state_equals (preprocessed_frame->target_color_state,
+                                      target_color_state))
+        return preprocessed_frame;
+    }
+
+  return NULL;
+}
+
+static void
+store_preprocessed_cursor_frame (MetaCursorSprite    *cursor_sprite,
+                                 ClutterColorState   *target_color_state,
+                                 float                scale,
+                                 MtkMonitorTransform  transform,
+                                 GBytes              *pixels,
+                                 int                  width,
+                                 int                  height,
+                                 int                  rowstride)
+{
+  MetaCursorSpriteXcursor *sprite_xcursor;
+  MetaCursorNativePrivate *cursor_priv;
+  PreprocessedCursorFrame *preprocessed_frame;
+  unsigned int images_serial;
+
+  if (!META_IS_CURSOR_SPRITE_XCURSOR (cursor_sprite))
+    return;
+
+  sprite_xcursor = META_CURSOR_SPRITE_XCURSOR (cursor_sprite);
+  cursor_priv = ensure_cursor_native_private (cursor_sprite);
+
+  images_serial = meta_cursor_sprite_xcursor_get_images_serial (sprite_xcursor);
+  if (cursor_priv->images_serial != images_serial)
+    {
+      g_ptr_array_set_size (cursor_priv->preprocessed_frames, 0);
+      cursor_priv->images_serial = images_serial;
+    }
+
+  if (cursor_priv->preprocessed_frames->len >= MAX_PREPROCESSED_CURSOR_FRAMES)
+    g_ptr_array_remove_index (cursor_priv->preprocessed_frames, 0);
+
+  preprocessed_frame = g_new0 (PreprocessedCursorFrame, 1);
+  preprocessed_frame->frame =
+    meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor);
+  preprocessed_frame->scale = scale;
+  preprocessed_frame->transform = transform;
+  preprocessed_frame->target_color_state = g_object_ref (target_color_state);
+  preprocessed_frame->pixels = g_bytes_ref (pixels);
+  preprocessed_frame->width = width;
+  preprocessed_frame->height = height;
+  preprocessed_frame->rowstride = rowstride;
+  g_ptr_array_add (cursor_priv->preprocessed_frames, preprocessed_frame);
+}
+
+static void
+cursor_frame_buffer_free (MetaDrmBuffer *buffer)
+{
+  if (buffer)
+    g_object_unref (buffer);
+}
+
+static void
+cursor_frame_ring_free (CursorFrameRing *ring)
+{
+  g_clear_weak_pointer (&ring->cursor_sprite);
+  g_clear_object (&ring->target_color_state);
+  g_clear_pointer (&ring->buffers, g_ptr_array_unref);
+  g_free (ring);
+}
+
+static CursorFrameRing *
+get_cursor_frame_ring (MetaCrtcKms      *crtc_kms,
+                       MetaCursorSprite *cursor_sprite)
+{
+  CursorFrameRing *ring;
+
+  ring = g_object_get_qdata (G_OBJECT (crtc_kms), quark_cursor_frame_ring);
+  if (!ring || ring->cursor_sprite != cursor_sprite)
+    return NULL;
+
+  return ring;
+}
+
+/*
+ * Makes sure the CRTC has a frame ring matching the animated theme cursor
+ * and how it's preprocessed for the CRTC, discarding the buffers of any
+ * previous cursor or configuration.
+ */
+static CursorFrameRing *
+ensure_cursor_frame_ring (MetaCrtcKms             *crtc_kms,
+                          MetaCursorSpriteXcursor *sprite_xcursor,
+                          ClutterColorState       *target_color_state,
+                          float                    scale,
+                          MtkMonitorTransform      transform)
+{
+  MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
+  CursorFrameRing *ring;
+  unsigned int images_serial;
+
+  images_serial = meta_cursor_sprite_xcursor_get_images_serial (sprite_xcursor);
+
+  ring = get_cursor_frame_ring (crtc_kms, cursor_sprite);
+  if (ring &&
+      ring->images_serial == images_serial &&
+      G_APPROX_VALUE (ring->scale, scale, FLT_EPSILON) &&
+      ring->transform == transform &&
+      clutter_color_state_equals (ring->target_color_state,
+                                  target_color_state))
+    return ring;
+
+  ring = g_new0 (CursorFrameRing, 1);
+  g_set_weak_pointer (&ring->cursor_sprite, cursor_sprite);
+  ring->images_serial = images_serial;
+  ring->scale = scale;
+  ring->transform = transform;
+  ring->target_color_state = g_object_ref (target_color_state);
+  ring->buffers =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) cursor_frame_buffer_free);
+  g_object_set_qdata_full (G_OBJECT (crtc_kms),
+                           quark_cursor_frame_ring,
+                           ring,
+                           (GDestroyNotify) cursor_frame_ring_free);
+
+  return ring;
+}
+
+static void
+clear_cursor_frame_ring (MetaCrtcKms *crtc_kms)
+{
+  g_object_set_qdata (G_OBJECT (crtc_kms), quark_cursor_frame_ring, NULL);
+}
+
 static void
 meta_cursor_renderer_native_finalize (GObject *object)
 {
@@ -333,8 +570,12 @@ meta_cursor_renderer_native_update_cursor (MetaCursorRenderer *cursor_renderer,
       cursor_stage_view = get_cursor_stage_view (view);
       g_assert (cursor_stage_view);
 
+      /* With the color transform offloaded to the CRTC, the cursor plane is
+       * transformed too, and 8 bit per channel isn't enough to hold the
+       * cursor in the view color state. */
       if (!META_IS_CRTC_KMS (crtc) ||
-          !meta_crtc_native_is_hw_cursor_supported (crtc_native))
+          !meta_crtc_native_is_hw_cursor_supported (crtc_native) ||
+          clutter_stage_view_is_color_transform_offloaded (CLUTTER_STAGE_VIEW (view)))
         {
           if (cursor_stage_view->has_hw_cursor)
             {
@@ -714,6 +955,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
   g_autoptr (MetaDeviceFile) device_file = NULL;
   g_autoptr (GError) error = NULL;
   graphene_point_t hotspot;
+  CursorFrameRing *ring;
 
   if (!get_optimal_cursor_size (crtc_kms,
                                 width, height,
@@ -758,6 +1000,24 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                                          buffer,
                                          transform,
                                          &hotspot);
+
+  ring = get_cursor_frame_ring (crtc_kms, cursor_sprite);
+  if (ring)
+    {
+      MetaCursorSpriteXcursor *sprite_xcursor =
+        META_CURSOR_SPRITE_XCURSOR (cursor_sprite);
+      int frame = meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor);
+
+      if (frame < MAX_CURSOR_FRAME_RING_SIZE)
+        {
+          if (ring->buffers->len <= (unsigned int) frame)
+            g_ptr_array_set_size (ring->buffers, frame + 1);
+
+          cursor_frame_buffer_free (g_ptr_array_index (ring->buffers, frame));
+          g_ptr_array_index (ring->buffers, frame) = g_object_ref (buffer);
+        }
+    }
+
   return TRUE;
 }
 
@@ -861,48 +1121,81 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
       const MetaFormatInfo *format_info;
       g_autoptr (GError) error = NULL;
       g_autoptr (CoglTexture) texture = NULL;
-      g_autofree uint8_t *cursor_data = NULL;
-      int bpp;
+      g_autoptr (GBytes) cursor_bytes = NULL;
+      PreprocessedCursorFrame *preprocessed_frame;
       int cursor_width, cursor_height, cursor_rowstride;
 
-      format_info = meta_format_info_from_drm_format (gbm_format);
-      if (!format_info)
-        return FALSE;
-
-      texture = scale_and_transform_cursor_sprite_cpu (native,
-                                                       target_color_state,
-                                                       cursor_sprite,
-                                                       data,
-                                                       format_info->cogl_format,
-                                                       width,
-                                                       height,
-                                                       rowstride,
-                                                       relative_scale,
-                                                       relative_transform,
-                                                       &error);
-      if (!texture)
+      /* Animated theme cursors cycle through the same frames, so reuse the
+       * result of preprocessing them instead of rendering and reading back
+       * every frame again.
+       */
+      preprocessed_frame = lookup_preprocessed_cursor_frame (cursor_sprite,
+                                                             target_color_state,
+                                                             relative_scale,
+                                                             relative_transform);
+      if (preprocessed_frame)
         {
-          g_warning ("Failed to preprocess cursor sprite: %s",
-                     error->message);
-          return FALSE;
+          cursor_bytes = g_bytes_ref (preprocessed_frame->pixels);
+          cursor_width = preprocessed_frame->width;
+          cursor_height = preprocessed_frame->height;
+          cursor_rowstride = preprocessed_frame->rowstride;
         }
+      else
+        {
+          uint8_t *cursor_data;
+          int bpp;
+
+          format_info = meta_format_info_from_drm_format (gbm_format);
+          if (!format_info)
+            return FALSE;
+
+          texture = scale_and_transform_cursor_sprite_cpu (native,
+                                                           target_color_state,
+                                                           cursor_sprite,
+                                                           data,
+                                                           format_info->cogl_format,
+                                                           width,
+                                                           height,
+                                                           rowstride,
+                                                           relative_scale,
+                                                           relative_transform,
+                                                           &error);
+          if (!texture)
+            {
+              g_warning ("Failed to preprocess cursor sprite: %s",
+                         error->message);
+              return FALSE;
+            }
 
-      bpp =
-        cogl_pixel_format_get_bytes_per_pixel (COGL_PIXEL_FORMAT_BGRA_8888_PRE,
-                                               0);
-      cursor_width = cogl_texture_get_width (texture);
-      cursor_height = cogl_texture_get_height (texture);
-      cursor_rowstride = cursor_width * bpp;
-      cursor_data = g_malloc (cursor_height * cursor_rowstride);
-      cogl_texture_get_data (texture, COGL_PIXEL_FORMAT_BGRA_8888_PRE,
-                             cursor_rowstride,
-                             cursor_data);
+          bpp =
+            cogl_pixel_format_get_bytes_per_pixel (COGL_PIXEL_FORMAT_BGRA_8888_PRE,
+                                                   0);
+          cursor_width = cogl_texture_get_width (texture);
+          cursor_height = cogl_texture_get_height (texture);
+          cursor_rowstride = cursor_width * bpp;
+          cursor_data = g_malloc (cursor_height * cursor_rowstride);
+          cogl_texture_get_data (texture, COGL_PIXEL_FORMAT_BGRA_8888_PRE,
+                                 cursor_rowstride,
+                                 cursor_data);
+          cursor_bytes = g_bytes_new_take (cursor_data,
+                                           cursor_height * cursor_rowstride);
+
+          store_preprocessed_cursor_frame (cursor_sprite,
+                                           target_color_state,
+                                           relative_scale,
+                                           relative_transform,
+                                           cursor_bytes,
+                                           cursor_width,
+                                           cursor_height,
+                                           cursor_rowstride);
+        }
 
       retval =
         load_cursor_sprite_gbm_buffer_for_crtc (native,
                                                 crtc_kms,
                                                 cursor_sprite,
-                                                cursor_data,
+                                                (uint8_t *) g_bytes_get_data (cursor_bytes,
+                                                                              NULL),
                                                 cursor_width,
                                                 cursor_height,
                                                 cursor_rowstride,
@@ -1136,6 +1429,48 @@ realize_cursor_sprite_from_xcursor_for_crtc (MetaCursorRenderer      *renderer,
         meta_cursor_sprite_get_texture_transform (cursor_sprite)),
       meta_monitor_logical_to_crtc_transform (monitor, logical_transform));
 
+  if (meta_cursor_sprite_is_animated (cursor_sprite))
+    {
+      CursorFrameRing *ring;
+      MetaDrmBuffer *buffer = NULL;
+      int frame;
+
+      ring = ensure_cursor_frame_ring (crtc_kms,
+                                       sprite_xcursor,
+                                       target_color_state,
+                                       relative_scale,
+                                       relative_transform);
+
+      frame = meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor);
+      if ((unsigned int) frame < ring->buffers->len)
+        buffer = g_ptr_array_index (ring->buffers, frame);
+
+      if (buffer)
+        {
+          MetaBackendNative *backend_native =
+            META_BACKEND_NATIVE (priv->backend);
+          MetaKms *kms = meta_backend_native_get_kms (backend_native);
+          MetaKmsCursorManager *kms_cursor_manager =
+            meta_kms_get_cursor_manager (kms);
+          graphene_point_t hotspot;
+
+          calculate_crtc_cursor_hotspot (cursor_sprite,
+                                         relative_scale,
+                                         relative_transform,
+                                         &hotspot);
+          meta_kms_cursor_manager_update_sprite (kms_cursor_manager,
+                                                 meta_crtc_kms_get_kms_crtc (crtc_kms),
+                                                 buffer,
+                                                 relative_transform,
+                                                 &hotspot);
+          return TRUE;
+        }
+    }
+  else
+    {
+      clear_cursor_frame_ring (crtc_kms);
+    }
+
   xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
 
   return load_scaled_and_transformed_cursor_sprite (native,
@@ -1167,6 +1502,9 @@ realize_cursor_sprite_for_crtc (MetaCursorRenderer *renderer,
 
   COGL_TRACE_BEGIN_SCOPED (CursorRendererNativeRealize,
                            "Meta::CursorRendererNative::realize_cursor_sprite_for_crtc()");
+
+  if (!get_cursor_frame_ring (crtc_kms, cursor_sprite))
+    clear_cursor_frame_ring (crtc_kms);
   if (META_IS_CURSOR_SPRITE_XCURSOR (cursor_sprite))
     {
       MetaCursorSpriteXcursor *sprite_xcursor =
@@ -1209,6 +1547,8 @@ meta_cursor_renderer_native_class_init (MetaCursorRendererNativeClass *klass)
     g_quark_from_static_string ("-meta-cursor-renderer-native-gpu-data");
   quark_cursor_stage_view =
     g_quark_from_static_string ("-meta-cursor-stage-view-native");
+  quark_cursor_frame_ring =
+    g_quark_from_static_string ("-meta-cursor-frame-ring-native");
 }
 
 static void
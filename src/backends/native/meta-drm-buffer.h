@@ -64,3 +64,5 @@ int meta_drm_buffer_get_offset (MetaDrmBuffer *buffer,
                                 int            plane);
 
 uint64_t meta_drm_buffer_get_modifier (MetaDrmBuffer *buffer);
+
+MetaDrmBufferFlags meta_drm_buffer_get_flags (MetaDrmBuffer *buffer);
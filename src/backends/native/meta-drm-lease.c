@@ -146,23 +146,55 @@ is_plane_assigned (MetaKmsDevice *kms_device,
       MetaKmsCrtc *kms_crtc = l->data;
       MetaCrtcKms *crtc_kms = meta_crtc_kms_from_kms_crtc (kms_crtc);
 
-      if (meta_crtc_kms_get_assigned_primary_plane (crtc_kms) == kms_plane)
+      if (meta_crtc_kms_get_assigned_primary_plane (crtc_kms) == kms_plane ||
+          meta_crtc_kms_get_assigned_cursor_plane (crtc_kms) == kms_plane ||
+          meta_crtc_kms_get_assigned_overlay_plane (crtc_kms) == kms_plane)
         return TRUE;
     }
 
   return FALSE;
 }
 
+static int
+count_usable_crtcs (MetaKmsDevice *kms_device,
+                    MetaKmsPlane  *kms_plane)
+{
+  GList *l;
+  int n_crtcs = 0;
+
+  for (l = meta_kms_device_get_crtcs (kms_device); l; l = l->next)
+    {
+      MetaKmsCrtc *kms_crtc = l->data;
+
+      if (meta_kms_crtc_is_leased (kms_crtc))
+        continue;
+
+      if (meta_kms_plane_is_usable_with (kms_plane, kms_crtc))
+        n_crtcs++;
+    }
+
+  return n_crtcs;
+}
+
+/*
+ * Among the free planes usable with the CRTC, pick the one the fewest other
+ * CRTCs could use, so that the planes left to the compositor for cursors
+ * and overlays on its own outputs are the ones reaching the most of them.
+ */
 static MetaKmsPlane *
 find_plane_to_lease (MetaKmsCrtc      *kms_crtc,
-                     MetaKmsPlaneType  plane_type)
+                     MetaKmsPlaneType  plane_type,
+                     GList            *planes)
 {
   MetaKmsDevice *kms_device = meta_kms_crtc_get_device (kms_crtc);
+  MetaKmsPlane *best_plane = NULL;
+  int best_n_crtcs = G_MAXINT;
   GList *l;
 
   for (l = meta_kms_device_get_planes (kms_device); l; l = l->next)
     {
       MetaKmsPlane *kms_plane = l->data;
+      int n_crtcs;
 
       if (meta_kms_plane_get_plane_type (kms_plane) != plane_type)
         continue;
@@ -173,10 +205,18 @@ find_plane_to_lease (MetaKmsCrtc      *kms_crtc,
       if (is_plane_assigned (kms_device, kms_plane))
         continue;
 
-      return kms_plane;
+      if (g_list_find (planes, kms_plane))
+        continue;
+
+      n_crtcs = count_usable_crtcs (kms_device, kms_plane);
+      if (n_crtcs < best_n_crtcs)
+        {
+          best_plane = kms_plane;
+          best_n_crtcs = n_crtcs;
+        }
     }
 
-  return NULL;
+  return best_plane;
 }
 
 static gboolean
@@ -265,7 +305,8 @@ find_resources_to_lease (MetaDrmLeaseManager  *lease_manager,
 
       crtcs = g_list_append (crtcs, crtc);
 
-      primary_plane = find_plane_to_lease (crtc, META_KMS_PLANE_TYPE_PRIMARY);
+      primary_plane = find_plane_to_lease (crtc, META_KMS_PLANE_TYPE_PRIMARY,
+                                           planes);
       if (!primary_plane)
         {
           g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
@@ -278,7 +319,8 @@ find_resources_to_lease (MetaDrmLeaseManager  *lease_manager,
 
       planes = g_list_append (planes, primary_plane);
 
-      cursor_plane = find_plane_to_lease (crtc, META_KMS_PLANE_TYPE_CURSOR);
+      cursor_plane = find_plane_to_lease (crtc, META_KMS_PLANE_TYPE_CURSOR,
+                                          planes);
       if (!cursor_plane)
         {
           g_warning ("Failed to find cursor plane "
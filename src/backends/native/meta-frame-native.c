@@ -29,6 +29,7 @@ struct _MetaFrameNative
 
   MetaDrmBuffer *buffer;
   CoglScanout *scanout;
+  CoglScanout *overlay_scanout;
 
   MetaKmsUpdate *kms_update;
 };
@@ -40,6 +41,7 @@ meta_frame_native_release (ClutterFrame *frame)
 
   g_clear_object (&frame_native->buffer);
   g_clear_object (&frame_native->scanout);
+  g_clear_object (&frame_native->overlay_scanout);
 
   g_return_if_fail (!frame_native->kms_update);
 }
@@ -108,3 +110,16 @@ meta_frame_native_get_scanout (MetaFrameNative *frame_native)
 {
   return frame_native->scanout;
 }
+
+void
+meta_frame_native_set_overlay_scanout (MetaFrameNative *frame_native,
+                                       CoglScanout     *scanout)
+{
+  g_set_object (&frame_native->overlay_scanout, scanout);
+}
+
+CoglScanout *
+meta_frame_native_get_overlay_scanout (MetaFrameNative *frame_native)
+{
+  return frame_native->overlay_scanout;
+}
@@ -730,6 +730,7 @@ out:
 
 static void
 state_set_blobs (MetaKmsConnectorState *state,
+                 MetaKmsConnectorState *current_state,
                  MetaKmsConnector      *connector,
                  MetaKmsImplDevice     *impl_device,
                  drmModeConnector      *drm_connector)
@@ -739,7 +740,21 @@ state_set_blobs (MetaKmsConnectorState *state,
 
   prop = &props[META_KMS_CONNECTOR_PROP_EDID];
   if (prop->prop_id && prop->value)
-    state_set_edid (state, connector, impl_device, prop->value);
+    {
+      /* The kernel replaces the EDID blob whenever the EDID changes, so an
+       * unchanged blob ID means the EDID we already have is still valid. */
+      if (current_state && current_state->edid_data &&
+          prop->value == connector->edid_blob_id)
+        state->edid_data = g_bytes_ref (current_state->edid_data);
+      else
+        state_set_edid (state, connector, impl_device, prop->value);
+
+      connector->edid_blob_id = state->edid_data ? prop->value : 0;
+    }
+  else
+    {
+      connector->edid_blob_id = 0;
+    }
 
   prop = &props[META_KMS_CONNECTOR_PROP_TILE];
   if (prop->prop_id && prop->value)
@@ -1036,7 +1051,8 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 
   state = meta_kms_connector_state_new ();
 
-  state_set_blobs (state, connector, impl_device, drm_connector);
+  state_set_blobs (state, current_state, connector, impl_device,
+                   drm_connector);
 
   state_set_properties (state, impl_device, connector, drm_connector);
 
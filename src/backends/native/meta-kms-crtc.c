@@ -20,6 +20,9 @@
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-crtc-private.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "backends/native/meta-kms-device-private.h"
 #include "backends/native/meta-kms-impl-device.h"
 #include "backends/native/meta-kms-impl-device-atomic.h"
@@ -30,6 +33,10 @@
 
 #define DEADLINE_EVASION_CONSTANT_US 200
 
+#define DISPATCH_DURATION_HISTORY_SIZE 128
+#define DISPATCH_DURATION_PERCENTILE 99
+#define MAX_DISPATCH_OVERRUNS 2
+
 #define MINIMUM_REFRESH_RATE 30.f
 
 typedef struct _MetaKmsCrtcPropTable
@@ -52,6 +59,11 @@ struct _MetaKmsCrtc
 
   gboolean is_leased;
 
+  int64_t dispatch_durations_us[DISPATCH_DURATION_HISTORY_SIZE];
+  int n_dispatch_durations;
+  int next_dispatch_duration;
+  int n_dispatch_overruns;
+
   int64_t shortterm_max_dispatch_duration_us;
   int64_t deadline_evasion_us;
   int64_t deadline_evasion_update_time_us;
@@ -299,6 +311,10 @@ meta_kms_crtc_read_state (MetaKmsCrtc             *crtc,
 
   read_gamma_state (crtc, &crtc_state, impl_device, drm_crtc);
 
+  prop = &crtc->prop_table.props[META_KMS_CRTC_PROP_CTM];
+  if (prop->prop_id && META_IS_KMS_IMPL_DEVICE_ATOMIC (impl_device))
+    crtc_state.ctm.supported = TRUE;
+
   if (!crtc_state.is_active)
     {
       if (crtc->current_state.is_active)
@@ -480,6 +496,11 @@ init_properties (MetaKmsCrtc       *crtc,
           .name = "VRR_ENABLED",
           .type = DRM_MODE_PROP_RANGE,
         },
+      [META_KMS_CRTC_PROP_CTM] =
+        {
+          .name = "CTM",
+          .type = DRM_MODE_PROP_BLOB,
+        },
     }
   };
 }
@@ -566,11 +587,39 @@ get_crtc_type_bitmask (MetaKmsCrtc *crtc)
     }
 }
 
+static int
+compare_durations (const void *a,
+                   const void *b)
+{
+  int64_t duration_a = *(const int64_t *) a;
+  int64_t duration_b = *(const int64_t *) b;
+
+  return (duration_a > duration_b) - (duration_a < duration_b);
+}
+
+static int64_t
+calculate_dispatch_duration_percentile (MetaKmsCrtc *crtc)
+{
+  int64_t durations_us[DISPATCH_DURATION_HISTORY_SIZE];
+  int n_durations = crtc->n_dispatch_durations;
+  int idx;
+
+  memcpy (durations_us, crtc->dispatch_durations_us,
+          n_durations * sizeof (int64_t));
+  qsort (durations_us, n_durations, sizeof (int64_t), compare_durations);
+
+  idx = (n_durations * DISPATCH_DURATION_PERCENTILE + 99) / 100 - 1;
+
+  return durations_us[CLAMP (idx, 0, n_durations - 1)];
+}
+
 static void
 maybe_update_deadline_evasion (MetaKmsCrtc *crtc,
                                int64_t      next_presentation_time_us)
 {
-  /* Do not update long-term max if there has been no measurement */
+  int64_t percentile_us;
+
+  /* Do not update long-term evasion if there has been no measurement */
   if (!crtc->shortterm_max_dispatch_duration_us)
     return;
 
@@ -578,17 +627,30 @@ maybe_update_deadline_evasion (MetaKmsCrtc *crtc,
       G_USEC_PER_SEC)
     return;
 
-  if (crtc->deadline_evasion_us > crtc->shortterm_max_dispatch_duration_us)
+  percentile_us = calculate_dispatch_duration_percentile (crtc);
+
+  if (crtc->deadline_evasion_us > percentile_us)
     {
-      /* Exponential drop-off toward the clamped short-term max */
+      /* Exponential drop-off toward the dispatch duration percentile */
       crtc->deadline_evasion_us -=
-        (crtc->deadline_evasion_us - crtc->shortterm_max_dispatch_duration_us) / 2;
+        (crtc->deadline_evasion_us - percentile_us) / 2;
     }
   else
     {
-      crtc->deadline_evasion_us = crtc->shortterm_max_dispatch_duration_us;
+      crtc->deadline_evasion_us = percentile_us;
     }
 
+  meta_topic (META_DEBUG_KMS_DEADLINE,
+              "CRTC %u deadline evasion %"G_GINT64_FORMAT "µs, "
+              "p%d dispatch duration %"G_GINT64_FORMAT "µs over %d samples, "
+              "short-term max %"G_GINT64_FORMAT "µs",
+              crtc->id,
+              crtc->deadline_evasion_us,
+              DISPATCH_DURATION_PERCENTILE,
+              percentile_us,
+              crtc->n_dispatch_durations,
+              crtc->shortterm_max_dispatch_duration_us);
+
   crtc->shortterm_max_dispatch_duration_us = 0;
   crtc->deadline_evasion_update_time_us = next_presentation_time_us;
 }
@@ -695,8 +757,8 @@ meta_kms_crtc_determine_deadline (MetaKmsCrtc  *crtc,
 }
 
 void
-meta_kms_crtc_update_shortterm_max_dispatch_duration (MetaKmsCrtc *crtc,
-                                                      int64_t      duration_us)
+meta_kms_crtc_record_dispatch_duration (MetaKmsCrtc *crtc,
+                                        int64_t      duration_us)
 {
   int64_t refresh_interval_us;
 
@@ -706,14 +768,33 @@ meta_kms_crtc_update_shortterm_max_dispatch_duration (MetaKmsCrtc *crtc,
   if (crtc->current_state.vrr.enabled)
     return;
 
-  if (duration_us <= crtc->shortterm_max_dispatch_duration_us)
-    return;
-
   refresh_interval_us =
     (int64_t) (0.5 + G_USEC_PER_SEC /
                meta_calculate_drm_mode_refresh_rate (&crtc->current_state.drm_mode));
+  duration_us = CLAMP (duration_us, 0, refresh_interval_us);
+
+  crtc->dispatch_durations_us[crtc->next_dispatch_duration] = duration_us;
+  crtc->next_dispatch_duration =
+    (crtc->next_dispatch_duration + 1) % DISPATCH_DURATION_HISTORY_SIZE;
+  crtc->n_dispatch_durations = MIN (crtc->n_dispatch_durations + 1,
+                                    DISPATCH_DURATION_HISTORY_SIZE);
+
+  crtc->shortterm_max_dispatch_duration_us =
+    MAX (crtc->shortterm_max_dispatch_duration_us, duration_us);
+
+  /* Don't wait for the next percentile update if the current evasion is
+   * repeatedly too tight, as every overrun is a missed flip. */
+  if (crtc->deadline_evasion_us &&
+      duration_us > crtc->deadline_evasion_us + DEADLINE_EVASION_CONSTANT_US)
+    crtc->n_dispatch_overruns++;
+  else
+    crtc->n_dispatch_overruns = 0;
 
-  crtc->shortterm_max_dispatch_duration_us = MIN (duration_us, refresh_interval_us);
+  if (crtc->n_dispatch_overruns >= MAX_DISPATCH_OVERRUNS)
+    {
+      crtc->deadline_evasion_us = crtc->shortterm_max_dispatch_duration_us;
+      crtc->n_dispatch_overruns = 0;
+    }
 }
 
 int64_t
@@ -721,8 +802,10 @@ meta_kms_crtc_get_deadline_evasion (MetaKmsCrtc *crtc)
 {
   int64_t deadline_evasion_us;
 
-  deadline_evasion_us =
-    MAX (crtc->shortterm_max_dispatch_duration_us, crtc->deadline_evasion_us);
+  /* Until the first percentile update, go by the short-term max */
+  deadline_evasion_us = crtc->deadline_evasion_us;
+  if (!deadline_evasion_us)
+    deadline_evasion_us = crtc->shortterm_max_dispatch_duration_us;
 
   if (!deadline_evasion_us)
     return 0;
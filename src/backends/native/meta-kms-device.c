@@ -38,6 +38,8 @@
 #include "backends/native/meta-kms-plane.h"
 #include "backends/native/meta-kms-private.h"
 #include "backends/native/meta-kms-update-private.h"
+#include "core/meta-debug-control-private.h"
+#include "meta/meta-context.h"
 
 enum
 {
@@ -304,6 +306,51 @@ process_sync_update_in_impl (MetaThreadImpl  *thread_impl,
   return meta_kms_impl_device_process_update (impl_device, update, data->flags);
 }
 
+void
+meta_kms_device_get_test_cache_stats (MetaKmsDevice *device,
+                                      unsigned int  *hits,
+                                      unsigned int  *misses)
+{
+  if (META_IS_KMS_IMPL_DEVICE_ATOMIC (device->impl_device))
+    {
+      MetaKmsImplDeviceAtomic *impl_device_atomic =
+        META_KMS_IMPL_DEVICE_ATOMIC (device->impl_device);
+
+      meta_kms_impl_device_atomic_get_test_cache_stats (impl_device_atomic,
+                                                        hits, misses);
+    }
+  else
+    {
+      *hits = 0;
+      *misses = 0;
+    }
+}
+
+static void
+update_test_cache_stats (MetaKms *kms)
+{
+  MetaBackend *backend = meta_kms_get_backend (kms);
+  MetaContext *context = meta_backend_get_context (backend);
+  MetaDebugControl *debug_control = meta_context_get_debug_control (context);
+  unsigned int total_hits = 0;
+  unsigned int total_misses = 0;
+  GList *l;
+
+  for (l = meta_kms_get_devices (kms); l; l = l->next)
+    {
+      MetaKmsDevice *device = l->data;
+      unsigned int hits;
+      unsigned int misses;
+
+      meta_kms_device_get_test_cache_stats (device, &hits, &misses);
+      total_hits += hits;
+      total_misses += misses;
+    }
+
+  meta_debug_control_set_kms_test_cache_stats (debug_control,
+                                               total_hits, total_misses);
+}
+
 MetaKmsFeedback *
 meta_kms_device_process_update_sync (MetaKmsDevice     *device,
                                      MetaKmsUpdate     *update,
@@ -311,13 +358,19 @@ meta_kms_device_process_update_sync (MetaKmsDevice     *device,
 {
   MetaKms *kms = META_KMS (meta_kms_device_get_kms (device));
   PostUpdateData data;
+  MetaKmsFeedback *feedback;
 
   data = (PostUpdateData) {
     .update = update,
     .flags = flags,
   };
-  return meta_kms_run_impl_task_sync (kms, process_sync_update_in_impl,
-                                      &data, NULL);
+  feedback = meta_kms_run_impl_task_sync (kms, process_sync_update_in_impl,
+                                          &data, NULL);
+
+  if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
+    update_test_cache_stats (kms);
+
+  return feedback;
 }
 
 static gpointer
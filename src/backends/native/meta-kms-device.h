@@ -65,6 +65,11 @@ gboolean meta_kms_device_has_cursor_plane_for (MetaKmsDevice*device,
 
 GList * meta_kms_device_get_fallback_modes (MetaKmsDevice *device);
 
+META_EXPORT_TEST
+void meta_kms_device_get_test_cache_stats (MetaKmsDevice *device,
+                                           unsigned int  *hits,
+                                           unsigned int  *misses);
+
 META_EXPORT_TEST
 MetaKmsFeedback * meta_kms_device_process_update_sync (MetaKmsDevice     *device,
                                                        MetaKmsUpdate     *update,
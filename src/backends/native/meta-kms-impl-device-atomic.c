@@ -19,6 +19,8 @@
 
 #include "backends/native/meta-kms-impl-device-atomic.h"
 
+#include <math.h>
+
 #include "backends/native/meta-backend-native-private.h"
 #include "backends/native/meta-kms-connector-private.h"
 #include "backends/native/meta-kms-crtc-private.h"
@@ -36,11 +38,34 @@ typedef gboolean (* MetaKmsAtomicProcessFunc) (MetaKmsImplDevice  *impl_device,
                                                gpointer            user_data,
                                                GError            **error);
 
+/* Upper bound of remembered TEST_ONLY outcomes; the cache is flushed when
+ * reached, as only the configurations of the last few frames matter. */
+#define MAX_TEST_CACHE_ENTRIES 64
+
+typedef struct _TestCacheKeyEntry
+{
+  uint32_t plane_id;
+  uint32_t crtc_id;
+  uint32_t has_buffer;
+  uint32_t format;
+  uint64_t modifier;
+  int32_t width;
+  int32_t height;
+  MetaFixed16Rectangle src_rect;
+  MtkRectangle dst_rect;
+  uint32_t rotation;
+  uint32_t flags;
+} TestCacheKeyEntry;
+
 struct _MetaKmsImplDeviceAtomic
 {
   MetaKmsImplDevice parent;
 
   GHashTable *page_flip_datas;
+
+  GHashTable *test_cache;
+  unsigned int test_cache_hits;
+  unsigned int test_cache_misses;
 };
 
 static GInitableIface *initable_parent_iface;
@@ -403,34 +428,56 @@ process_mode_set (MetaKmsImplDevice  *impl_device,
   mode = (MetaKmsMode *) mode_set->mode;
   if (mode)
     {
-      uint32_t mode_id;
+      const MetaKmsCrtcState *crtc_state =
+        meta_kms_crtc_get_current_state (crtc);
       GList *l;
 
-      mode_id = meta_kms_mode_create_blob_id (mode, error);
-      if (mode_id == 0)
-        return FALSE;
+      /* Reconfiguring the monitors, e.g. on hotplug, sets the mode of
+       * every CRTC again. Leave the mode of CRTCs that already drive it
+       * alone, so that drivers treating a new mode blob as a mode
+       * change don't blank monitors that didn't change.
+       */
+      if (crtc_state->is_active &&
+          crtc_state->is_drm_mode_valid &&
+          meta_drm_mode_equal (&crtc_state->drm_mode,
+                               meta_kms_mode_get_drm_mode (mode)))
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Keeping mode %s of CRTC %u (%s)",
+                      meta_kms_mode_get_name (mode),
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          uint32_t mode_id;
 
-      g_array_append_val (blob_ids, mode_id);
+          mode_id = meta_kms_mode_create_blob_id (mode, error);
+          if (mode_id == 0)
+            return FALSE;
 
-      meta_topic (META_DEBUG_KMS,
-                  "[atomic] Setting mode of CRTC %u (%s) to %s",
-                  meta_kms_crtc_get_id (crtc),
-                  meta_kms_impl_device_get_path (impl_device),
-                  meta_kms_mode_get_name (mode));
+          g_array_append_val (blob_ids, mode_id);
 
-      if (!add_crtc_property (impl_device,
-                              crtc, req,
-                              META_KMS_CRTC_PROP_MODE_ID,
-                              mode_id,
-                              error))
-        return FALSE;
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting mode of CRTC %u (%s) to %s",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device),
+                      meta_kms_mode_get_name (mode));
 
-      if (!add_crtc_property (impl_device,
-                              crtc, req,
-                              META_KMS_CRTC_PROP_ACTIVE,
-                              1,
-                              error))
-        return FALSE;
+          if (!add_crtc_property (impl_device,
+                                  crtc, req,
+                                  META_KMS_CRTC_PROP_MODE_ID,
+                                  mode_id,
+                                  error))
+            return FALSE;
+
+          if (!add_crtc_property (impl_device,
+                                  crtc, req,
+                                  META_KMS_CRTC_PROP_ACTIVE,
+                                  1,
+                                  error))
+            return FALSE;
+        }
 
       for (l = mode_set->connectors; l; l = l->next)
         {
@@ -760,6 +807,20 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static uint64_t
+float_to_s31_32 (float value)
+{
+  uint64_t magnitude;
+
+  /* The CTM uses sign-magnitude fixed point values */
+  magnitude = (uint64_t) (fabs ((double) value) * (double) (1ULL << 32));
+
+  if (value < 0.0f)
+    return magnitude | (1ULL << 63);
+  else
+    return magnitude;
+}
+
 static gboolean
 process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
                             MetaKmsUpdate      *update,
@@ -821,6 +882,47 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
+  if (color_update->ctm.has_update)
+    {
+      uint32_t ctm_blob_id = 0;
+
+      if (color_update->ctm.enabled)
+        {
+          struct drm_color_ctm drm_ctm;
+          int i;
+
+          for (i = 0; i < G_N_ELEMENTS (drm_ctm.matrix); i++)
+            drm_ctm.matrix[i] = float_to_s31_32 (color_update->ctm.matrix[i]);
+
+          ctm_blob_id = store_new_blob (impl_device,
+                                        blob_ids,
+                                        &drm_ctm,
+                                        sizeof (drm_ctm),
+                                        error);
+          if (!ctm_blob_id)
+            return FALSE;
+
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) CTM",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) CTM to bypass",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_CTM,
+                              ctm_blob_id,
+                              error))
+        return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -947,7 +1049,7 @@ static const char *
 commit_flags_string (uint32_t commit_flags)
 {
   static char static_commit_flags_string[255];
-  const char *commit_flag_strings[4] = { NULL };
+  const char *commit_flag_strings[6] = { NULL };
   int i = 0;
   g_autofree char *commit_flags_string = NULL;
 
@@ -959,6 +1061,8 @@ commit_flags_string (uint32_t commit_flags)
     commit_flag_strings[i++] = "PAGE_FLIP_EVENT";
   if (commit_flags & DRM_MODE_ATOMIC_TEST_ONLY)
     commit_flag_strings[i++] = "TEST_ONLY";
+  if (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC)
+    commit_flag_strings[i++] = "PAGE_FLIP_ASYNC";
 
   commit_flags_string = g_strjoinv ("|", (char **) commit_flag_strings);
   strncpy (static_commit_flags_string, commit_flags_string,
@@ -1060,15 +1164,157 @@ disable_planes_and_connectors (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+/*
+ * Only updates that consist purely of plane assignments are cached, which is
+ * what direct scanout and overlay plane candidates are tested with. The key
+ * describes everything the driver validates about each plane, but not the
+ * buffer itself, so a new buffer with the same layout hits the cache.
+ */
+static GBytes *
+create_test_cache_key (MetaKmsUpdate *update)
+{
+  g_autoptr (GByteArray) key = NULL;
+  GList *plane_assignments;
+  GList *l;
+
+  if (meta_kms_update_get_mode_sets (update) ||
+      meta_kms_update_get_connector_updates (update) ||
+      meta_kms_update_get_crtc_updates (update) ||
+      meta_kms_update_get_crtc_color_updates (update))
+    return NULL;
+
+  plane_assignments = meta_kms_update_get_plane_assignments (update);
+  if (!plane_assignments)
+    return NULL;
+
+  key = g_byte_array_new ();
+
+  for (l = plane_assignments; l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+      MetaDrmBuffer *buffer = plane_assignment->buffer;
+      TestCacheKeyEntry entry;
+
+      if (plane_assignment->cursor_hotspot.has_update)
+        return NULL;
+
+      memset (&entry, 0, sizeof (entry));
+      entry.plane_id = meta_kms_plane_get_id (plane_assignment->plane);
+      entry.crtc_id = meta_kms_crtc_get_id (plane_assignment->crtc);
+      entry.rotation = plane_assignment->rotation;
+      entry.flags = plane_assignment->flags;
+
+      if (buffer)
+        {
+          entry.has_buffer = TRUE;
+          entry.format = meta_drm_buffer_get_format (buffer);
+          entry.modifier = meta_drm_buffer_get_modifier (buffer);
+          entry.width = meta_drm_buffer_get_width (buffer);
+          entry.height = meta_drm_buffer_get_height (buffer);
+          entry.src_rect = plane_assignment->src_rect;
+          entry.dst_rect = plane_assignment->dst_rect;
+        }
+
+      g_byte_array_append (key, (const uint8_t *) &entry, sizeof (entry));
+    }
+
+  return g_byte_array_free_to_bytes (g_steal_pointer (&key));
+}
+
+static gboolean
+lookup_test_cache (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                   GBytes                  *key,
+                   int                     *ret)
+{
+  gpointer value;
+
+  if (!g_hash_table_lookup_extended (impl_device_atomic->test_cache,
+                                     key, NULL, &value))
+    return FALSE;
+
+  *ret = GPOINTER_TO_INT (value);
+  return TRUE;
+}
+
+static void
+store_test_cache (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                  GBytes                  *key,
+                  int                      ret)
+{
+  if (g_hash_table_size (impl_device_atomic->test_cache) >=
+      MAX_TEST_CACHE_ENTRIES)
+    g_hash_table_remove_all (impl_device_atomic->test_cache);
+
+  g_hash_table_insert (impl_device_atomic->test_cache,
+                       g_bytes_ref (key),
+                       GINT_TO_POINTER (ret));
+}
+
+static void
+invalidate_test_cache (MetaKmsImplDeviceAtomic *impl_device_atomic)
+{
+  if (g_hash_table_size (impl_device_atomic->test_cache) == 0)
+    return;
+
+  meta_topic (META_DEBUG_KMS, "[atomic] Invalidating TEST_ONLY cache");
+
+  g_hash_table_remove_all (impl_device_atomic->test_cache);
+}
+
+/*
+ * The kernel only accepts asynchronous atomic commits that do nothing but
+ * change the framebuffer of the primary plane, so anything else, including a
+ * cursor plane update, results in a synchronous page flip.
+ */
+static gboolean
+can_commit_async (MetaKmsImplDevice *impl_device,
+                  MetaKmsUpdate     *update,
+                  MetaKmsUpdateFlag  flags)
+{
+  const MetaKmsDeviceCaps *caps = meta_kms_impl_device_get_caps (impl_device);
+  GList *plane_assignments;
+  MetaKmsPlaneAssignment *plane_assignment;
+
+  if (!meta_kms_update_get_allow_tearing (update))
+    return FALSE;
+
+  if (!caps->atomic_async_page_flip)
+    return FALSE;
+
+  if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
+    return FALSE;
+
+  if (meta_kms_update_get_needs_modeset (update) ||
+      meta_kms_update_get_connector_updates (update) ||
+      meta_kms_update_get_crtc_updates (update) ||
+      meta_kms_update_get_crtc_color_updates (update))
+    return FALSE;
+
+  plane_assignments = meta_kms_update_get_plane_assignments (update);
+  if (!plane_assignments || plane_assignments->next)
+    return FALSE;
+
+  plane_assignment = plane_assignments->data;
+  if (!plane_assignment->buffer ||
+      meta_kms_plane_get_plane_type (plane_assignment->plane) !=
+      META_KMS_PLANE_TYPE_PRIMARY)
+    return FALSE;
+
+  return TRUE;
+}
+
 static MetaKmsFeedback *
 meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
                                             MetaKmsUpdate     *update,
                                             MetaKmsUpdateFlag  flags)
 {
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
   GError *error = NULL;
   GList *failed_planes = NULL;
-  drmModeAtomicReq *req;
+  drmModeAtomicReq *req = NULL;
   g_autoptr (GArray) blob_ids = NULL;
+  g_autoptr (GBytes) test_cache_key = NULL;
   int fd;
   uint32_t commit_flags = 0;
   int ret;
@@ -1077,6 +1323,34 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   meta_topic (META_DEBUG_KMS, "[atomic] Processing update");
 
+  if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
+    {
+      test_cache_key = create_test_cache_key (update);
+      if (test_cache_key &&
+          lookup_test_cache (impl_device_atomic, test_cache_key, &ret))
+        {
+          g_atomic_int_inc (&impl_device_atomic->test_cache_hits);
+
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Using cached TEST_ONLY result");
+
+          if (ret == 0)
+            return meta_kms_feedback_new_passed (NULL);
+
+          g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                       "drmModeAtomicCommit: %s (cached)", g_strerror (-ret));
+          goto err;
+        }
+
+      if (test_cache_key)
+        g_atomic_int_inc (&impl_device_atomic->test_cache_misses);
+    }
+  else if (meta_kms_update_get_mode_sets (update) ||
+           meta_kms_update_get_needs_modeset (update))
+    {
+      invalidate_test_cache (impl_device_atomic);
+    }
+
   req = drmModeAtomicAlloc ();
   if (!req)
     {
@@ -1153,12 +1427,31 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
   if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
     commit_flags |= DRM_MODE_ATOMIC_TEST_ONLY;
 
+  if (can_commit_async (impl_device, update, flags))
+    commit_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
   meta_topic (META_DEBUG_KMS,
               "[atomic] Committing update flags: %s",
               commit_flags_string (commit_flags));
 
   fd = meta_kms_impl_device_get_fd (impl_device);
   ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+
+  if (ret == -EINVAL && (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Asynchronous commit rejected, retrying "
+                  "synchronously");
+
+      commit_flags &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+      ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+    }
+
+  if (test_cache_key)
+    store_test_cache (impl_device_atomic, test_cache_key, MIN (ret, 0));
+  else if (ret < 0 && !(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
+    invalidate_test_cache (impl_device_atomic);
+
   if (ret < 0)
     {
       g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (-ret),
@@ -1276,6 +1569,21 @@ meta_kms_impl_device_atomic_prepare_shutdown (MetaKmsImplDevice *impl_device)
                                impl_device);
 }
 
+static void
+meta_kms_impl_device_atomic_resources_changed (MetaKmsImplDevice *impl_device)
+{
+  invalidate_test_cache (META_KMS_IMPL_DEVICE_ATOMIC (impl_device));
+}
+
+void
+meta_kms_impl_device_atomic_get_test_cache_stats (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                                                  unsigned int            *hits,
+                                                  unsigned int            *misses)
+{
+  *hits = g_atomic_int_get (&impl_device_atomic->test_cache_hits);
+  *misses = g_atomic_int_get (&impl_device_atomic->test_cache_misses);
+}
+
 static void
 meta_kms_impl_device_atomic_finalize (GObject *object)
 {
@@ -1285,6 +1593,7 @@ meta_kms_impl_device_atomic_finalize (GObject *object)
   g_assert (g_hash_table_size (impl_device_atomic->page_flip_datas) == 0);
 
   g_hash_table_unref (impl_device_atomic->page_flip_datas);
+  g_hash_table_unref (impl_device_atomic->test_cache);
 
   G_OBJECT_CLASS (meta_kms_impl_device_atomic_parent_class)->finalize (object);
 }
@@ -1438,6 +1747,9 @@ static void
 meta_kms_impl_device_atomic_init (MetaKmsImplDeviceAtomic *impl_device_atomic)
 {
   impl_device_atomic->page_flip_datas = g_hash_table_new (NULL, NULL);
+  impl_device_atomic->test_cache =
+    g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                           (GDestroyNotify) g_bytes_unref, NULL);
 }
 
 static void
@@ -1471,4 +1783,6 @@ meta_kms_impl_device_atomic_class_init (MetaKmsImplDeviceAtomicClass *klass)
     meta_kms_impl_device_atomic_discard_pending_page_flips;
   impl_device_class->prepare_shutdown =
     meta_kms_impl_device_atomic_prepare_shutdown;
+  impl_device_class->resources_changed =
+    meta_kms_impl_device_atomic_resources_changed;
 }
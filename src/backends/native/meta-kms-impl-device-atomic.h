@@ -23,3 +23,7 @@
 META_EXPORT_TEST
 G_DECLARE_FINAL_TYPE (MetaKmsImplDeviceAtomic, meta_kms_impl_device_atomic,
                       META, KMS_IMPL_DEVICE_ATOMIC, MetaKmsImplDevice)
+
+void meta_kms_impl_device_atomic_get_test_cache_stats (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                                                       unsigned int            *hits,
+                                                       unsigned int            *misses);
@@ -1058,22 +1058,44 @@ dispatch_page_flip (MetaKmsImplDevice    *impl_device,
     }
   else
     {
+      const MetaKmsDeviceCaps *caps =
+        meta_kms_impl_device_get_caps (impl_device);
       uint32_t fb_id;
+      uint32_t flip_flags = DRM_MODE_PAGE_FLIP_EVENT;
 
       fb_id = meta_drm_buffer_get_fb_id (plane_assignment->buffer);
 
+      if (caps->async_page_flip &&
+          meta_kms_update_get_allow_tearing (update))
+        flip_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
       meta_topic (META_DEBUG_KMS,
-                  "[simple] Page flipping CRTC %u (%s) with %u, data: %p",
+                  "[simple] Page flipping CRTC %u (%s) with %u%s, data: %p",
                   meta_kms_crtc_get_id (crtc),
                   meta_kms_impl_device_get_path (impl_device),
                   fb_id,
+                  (flip_flags & DRM_MODE_PAGE_FLIP_ASYNC) ? " (async)" : "",
                   page_flip_data);
 
       ret = drmModePageFlip (fd,
                              meta_kms_crtc_get_id (crtc),
                              fb_id,
-                             DRM_MODE_PAGE_FLIP_EVENT,
+                             flip_flags,
                              page_flip_data);
+
+      if (ret == -EINVAL && (flip_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[simple] Asynchronous page flip rejected on CRTC %u, "
+                      "retrying synchronously",
+                      meta_kms_crtc_get_id (crtc));
+
+          ret = drmModePageFlip (fd,
+                                 meta_kms_crtc_get_id (crtc),
+                                 fb_id,
+                                 DRM_MODE_PAGE_FLIP_EVENT,
+                                 page_flip_data);
+        }
     }
 
   if (ret == -EBUSY)
@@ -35,6 +35,7 @@
 #include "backends/native/meta-kms-crtc-private.h"
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-device-private.h"
+#include "backends/native/meta-kms-impl-device-atomic.h"
 #include "backends/native/meta-kms-impl.h"
 #include "backends/native/meta-kms-mode-private.h"
 #include "backends/native/meta-kms-page-flip-private.h"
@@ -47,6 +48,10 @@
 #include "meta-default-modes.h"
 #include "meta-private-enum-types.h"
 
+#ifndef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+#define DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP 0x15
+#endif
+
 enum
 {
   PROP_0,
@@ -61,6 +66,13 @@ enum
 
 static GParamSpec *obj_props[N_PROPS];
 
+/*
+ * CRTCs expecting to present within this window of each other are driven
+ * off the same vblank, e.g. tiles of a synchronized video wall, and have
+ * their pending updates committed together.
+ */
+#define SYNCHRONIZED_PRESENTATION_WINDOW_US 1000
+
 typedef struct _CrtcDeadline
 {
   MetaKmsImplDevice *impl_device;
@@ -558,6 +570,8 @@ init_caps (MetaKmsImplDevice *impl_device)
   uint64_t prefer_shadow;
   uint64_t uses_monotonic_clock;
   uint64_t addfb2_modifiers;
+  uint64_t async_page_flip;
+  uint64_t atomic_async_page_flip;
 
   fd = meta_device_file_get_fd (priv->device_file);
   if (drmGetCap (fd, DRM_CAP_CURSOR_WIDTH, &cursor_width) == 0 &&
@@ -585,6 +599,17 @@ init_caps (MetaKmsImplDevice *impl_device)
     {
       priv->caps.addfb2_modifiers = (addfb2_modifiers != 0);
     }
+
+  if (drmGetCap (fd, DRM_CAP_ASYNC_PAGE_FLIP, &async_page_flip) == 0)
+    {
+      priv->caps.async_page_flip = (async_page_flip != 0);
+    }
+
+  if (drmGetCap (fd, DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP,
+                 &atomic_async_page_flip) == 0)
+    {
+      priv->caps.atomic_async_page_flip = (atomic_async_page_flip != 0);
+    }
 }
 
 static void
@@ -1103,6 +1128,15 @@ clear_latched_fd_hold (MetaKmsImplDevice *impl_device)
     }
 }
 
+static void
+notify_resources_changed (MetaKmsImplDevice *impl_device)
+{
+  MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
+
+  if (klass->resources_changed)
+    klass->resources_changed (impl_device);
+}
+
 MetaKmsResourceChanges
 meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device,
                                     uint32_t           crtc_id,
@@ -1159,6 +1193,9 @@ meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device,
 
   drmModeFreeResources (drm_resources);
 
+  if (changes != META_KMS_RESOURCE_CHANGE_NONE)
+    notify_resources_changed (impl_device);
+
   return changes;
 
 err:
@@ -1167,6 +1204,8 @@ err:
   g_clear_list (&priv->connectors, g_object_unref);
   g_clear_pointer (&priv->crtc_frames, g_hash_table_unref);
 
+  notify_resources_changed (impl_device);
+
   return META_KMS_RESOURCE_CHANGE_FULL;
 }
 
@@ -1483,6 +1522,101 @@ queue_result_feedback (MetaKmsImplDevice *impl_device,
     }
 }
 
+static gboolean
+can_merge_synchronized_update (MetaKmsUpdate *update)
+{
+  return (!meta_kms_update_get_mode_sets (update) &&
+          !meta_kms_update_get_allow_tearing (update));
+}
+
+static gboolean
+is_crtc_frame_synchronized (CrtcFrame *crtc_frame,
+                            CrtcFrame *other_crtc_frame)
+{
+  int64_t presentation_delta_us;
+
+  if (!other_crtc_frame->pending_update ||
+      other_crtc_frame->await_flush ||
+      other_crtc_frame->pending_page_flip ||
+      !other_crtc_frame->deadline.armed)
+    return FALSE;
+
+  if (!crtc_frame->deadline.has_expected_presentation_time ||
+      !other_crtc_frame->deadline.has_expected_presentation_time)
+    return FALSE;
+
+  if (meta_kms_crtc_get_current_state (crtc_frame->crtc)->vrr.enabled ||
+      meta_kms_crtc_get_current_state (other_crtc_frame->crtc)->vrr.enabled)
+    return FALSE;
+
+  presentation_delta_us =
+    other_crtc_frame->deadline.expected_presentation_time_us -
+    crtc_frame->deadline.expected_presentation_time_us;
+
+  return ABS (presentation_delta_us) <= SYNCHRONIZED_PRESENTATION_WINDOW_US;
+}
+
+/*
+ * Pulls the pending updates of CRTCs presenting on the same vblank as
+ * @crtc_frame into @update, so that a single atomic commit serves all of
+ * them. Returns the CRTC frames that were merged.
+ */
+static GList *
+merge_synchronized_updates (MetaKmsImplDevice *impl_device,
+                            CrtcFrame         *crtc_frame,
+                            MetaKmsUpdate     *update,
+                            MetaKmsUpdateFlag  flags)
+{
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+  MetaKmsImpl *impl = meta_kms_impl_device_get_impl (impl_device);
+  GList *merged_crtc_frames = NULL;
+  GHashTableIter iter;
+  CrtcFrame *other_crtc_frame;
+
+  if (!META_IS_KMS_IMPL_DEVICE_ATOMIC (impl_device))
+    return NULL;
+
+  if (flags != META_KMS_UPDATE_FLAG_NONE ||
+      !can_merge_synchronized_update (update))
+    return NULL;
+
+  g_hash_table_iter_init (&iter, priv->crtc_frames);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &other_crtc_frame))
+    {
+      MetaKmsUpdate *other_update;
+
+      if (other_crtc_frame == crtc_frame ||
+          !is_crtc_frame_synchronized (crtc_frame, other_crtc_frame) ||
+          !can_merge_synchronized_update (other_crtc_frame->pending_update))
+        continue;
+
+      other_update =
+        meta_kms_impl_filter_update (impl,
+                                     other_crtc_frame->crtc,
+                                     g_steal_pointer (&other_crtc_frame->pending_update),
+                                     flags);
+      disarm_crtc_frame_deadline_timer (other_crtc_frame);
+
+      if (!other_update)
+        continue;
+
+      meta_topic (META_DEBUG_KMS,
+                  "Merging update for CRTC %u into commit of CRTC %u (%s)",
+                  meta_kms_crtc_get_id (other_crtc_frame->crtc),
+                  meta_kms_crtc_get_id (crtc_frame->crtc),
+                  priv->path);
+
+      meta_kms_update_merge_from (update, other_update);
+      meta_kms_update_free (other_update);
+
+      merged_crtc_frames = g_list_prepend (merged_crtc_frames,
+                                           other_crtc_frame);
+    }
+
+  return merged_crtc_frames;
+}
+
 static MetaKmsFeedback *
 do_process (MetaKmsImplDevice *impl_device,
             MetaKmsCrtc       *latch_crtc,
@@ -1496,8 +1630,10 @@ do_process (MetaKmsImplDevice *impl_device,
   MetaThreadImpl *thread_impl = META_THREAD_IMPL (impl);
   MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
   CrtcFrame *crtc_frame = NULL;
+  g_autoptr (GList) merged_crtc_frames = NULL;
   MetaKmsFeedback *feedback;
   MetaKmsResourceChanges changes = META_KMS_RESOURCE_CHANGE_NONE;
+  GList *l;
 
   COGL_TRACE_BEGIN_SCOPED (MetaKmsImplDeviceProcess,
                            "Meta::KmsImplDevice::do_process()");
@@ -1540,20 +1676,51 @@ do_process (MetaKmsImplDevice *impl_device,
           GMainContext *thread_context =
             meta_thread_impl_get_main_context (thread_impl);
 
-          meta_kms_update_add_page_flip_listener (update,
-                                                  crtc_frame->crtc,
-                                                  &crtc_page_flip_listener_vtable,
-                                                  thread_context,
-                                                  crtc_frame, NULL);
-          crtc_frame->pending_page_flip = TRUE;
+          merged_crtc_frames = merge_synchronized_updates (impl_device,
+                                                           crtc_frame,
+                                                           update,
+                                                           flags);
+          merged_crtc_frames = g_list_prepend (merged_crtc_frames,
+                                               crtc_frame);
+
+          for (l = merged_crtc_frames; l; l = l->next)
+            {
+              CrtcFrame *merged_crtc_frame = l->data;
+
+              meta_kms_update_add_page_flip_listener (update,
+                                                      merged_crtc_frame->crtc,
+                                                      &crtc_page_flip_listener_vtable,
+                                                      thread_context,
+                                                      merged_crtc_frame, NULL);
+              merged_crtc_frame->pending_page_flip = TRUE;
+            }
         }
     }
 
-  feedback = klass->process_update (impl_device, update, flags);
+  if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
+    {
+      feedback = klass->process_update (impl_device, update, flags);
+    }
+  else
+    {
+      int64_t commit_start_us = g_get_monotonic_time ();
 
-  if (meta_kms_feedback_get_result (feedback) != META_KMS_FEEDBACK_PASSED &&
-      crtc_frame)
-    crtc_frame->pending_page_flip = FALSE;
+      feedback = klass->process_update (impl_device, update, flags);
+
+      COGL_PERF_COUNTER_SET (KmsCommitLatency, "KmsCommitLatency",
+                             "duration of the last KMS commit in µs",
+                             g_get_monotonic_time () - commit_start_us);
+    }
+
+  for (l = merged_crtc_frames; l; l = l->next)
+    {
+      CrtcFrame *merged_crtc_frame = l->data;
+
+      if (meta_kms_feedback_get_result (feedback) != META_KMS_FEEDBACK_PASSED)
+        merged_crtc_frame->pending_page_flip = FALSE;
+      else if (merged_crtc_frame != crtc_frame)
+        merged_crtc_frame->deadline.is_deadline_page_flip = TRUE;
+    }
 
   if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
     changes = meta_kms_impl_device_predict_states (impl_device, update);
@@ -1651,7 +1818,7 @@ crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
         }
     }
 
-  meta_kms_crtc_update_shortterm_max_dispatch_duration (crtc, interval_us);
+  meta_kms_crtc_record_dispatch_duration (crtc, interval_us);
 
   if (meta_kms_feedback_did_pass (feedback))
     crtc_frame->deadline.is_deadline_page_flip = TRUE;
@@ -1899,7 +2066,8 @@ meta_kms_impl_device_handle_update (MetaKmsImplDevice *impl_device,
   crtc_frame->submitted_update.flags = flags;
   crtc_frame->submitted_update.latch_crtc = latch_crtc;
 
-  if (is_using_deadline_timer (impl_device))
+  if (is_using_deadline_timer (impl_device) ||
+      meta_kms_update_is_sync_fd_required (update))
     sync_fd = meta_kms_update_get_sync_fd (update);
 
   if (sync_fd >= 0)
@@ -35,6 +35,12 @@ typedef struct _MetaKmsCrtcColorUpdate
     gboolean has_update;
     MetaGammaLut *state;
   } gamma;
+
+  struct {
+    gboolean has_update;
+    gboolean enabled;
+    float matrix[9];
+  } ctm;
 } MetaKmsCrtcColorUpdate;
 
 typedef struct _MetaKmsFeedback
@@ -55,6 +55,9 @@ struct _MetaKmsUpdate
   MetaKmsImplDevice *impl_device;
 
   int sync_fd;
+  gboolean is_sync_fd_required;
+
+  gboolean allow_tearing;
 };
 
 void
@@ -571,6 +574,34 @@ meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
   update_latch_crtc (update, crtc);
 }
 
+/**
+ * meta_kms_update_set_crtc_ctm:
+ * @update: a #MetaKmsUpdate
+ * @crtc: a #MetaKmsCrtc
+ * @matrix: (nullable): row-major 3x3 color transformation matrix
+ *
+ * Sets the color transformation matrix applied before the gamma LUT of
+ * @crtc, or puts it in bypass if @matrix is %NULL.
+ */
+void
+meta_kms_update_set_crtc_ctm (MetaKmsUpdate *update,
+                              MetaKmsCrtc   *crtc,
+                              const float   *matrix)
+{
+  MetaKmsCrtcColorUpdate *color_update;
+
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+  g_assert (meta_kms_crtc_get_current_state (crtc)->ctm.supported);
+
+  color_update = ensure_color_update (update, crtc);
+  color_update->ctm.has_update = TRUE;
+  color_update->ctm.enabled = matrix != NULL;
+  if (matrix)
+    memcpy (color_update->ctm.matrix, matrix, sizeof (color_update->ctm.matrix));
+
+  update_latch_crtc (update, crtc);
+}
+
 static void
 meta_kms_crtc_color_updates_free (MetaKmsCrtcColorUpdate *color_update)
 {
@@ -1142,6 +1173,8 @@ meta_kms_update_merge_from (MetaKmsUpdate *update,
   merge_result_listeners_from (update, other_update);
 
   meta_kms_update_set_sync_fd (update, g_steal_fd (&other_update->sync_fd));
+  update->is_sync_fd_required = other_update->is_sync_fd_required;
+  update->allow_tearing = other_update->allow_tearing;
 }
 
 gboolean
@@ -1223,6 +1256,45 @@ meta_kms_update_set_sync_fd (MetaKmsUpdate *update,
 
   g_clear_fd (&update->sync_fd, NULL);
   update->sync_fd = sync_fd;
+  update->is_sync_fd_required = FALSE;
+}
+
+/*
+ * Sets a fence the buffers of the update depend on, e.g. the acquire fence
+ * of a directly scanned out client buffer. Unlike the sync fd of composited
+ * updates, which is only waited on with the deadline timer, it is always
+ * waited on before the update is committed.
+ */
+void
+meta_kms_update_set_acquire_sync_fd (MetaKmsUpdate *update,
+                                     int            sync_fd)
+{
+  meta_kms_update_set_sync_fd (update, sync_fd);
+  update->is_sync_fd_required = sync_fd >= 0;
+}
+
+gboolean
+meta_kms_update_is_sync_fd_required (MetaKmsUpdate *update)
+{
+  return update->is_sync_fd_required;
+}
+
+/*
+ * Allows the update to be committed as an asynchronous page flip, i.e. to
+ * tear, if the device supports it and the update only flips the primary
+ * plane. Updates that don't qualify are committed synchronously.
+ */
+void
+meta_kms_update_set_allow_tearing (MetaKmsUpdate *update,
+                                   gboolean       allow_tearing)
+{
+  update->allow_tearing = allow_tearing;
+}
+
+gboolean
+meta_kms_update_get_allow_tearing (MetaKmsUpdate *update)
+{
+  return update->allow_tearing;
 }
 
 gboolean
@@ -84,6 +84,7 @@ void meta_kms_feedback_unref (MetaKmsFeedback *feedback);
 
 MetaKmsFeedbackResult meta_kms_feedback_get_result (const MetaKmsFeedback *feedback);
 
+META_EXPORT_TEST
 gboolean meta_kms_feedback_did_pass (const MetaKmsFeedback *feedback);
 
 GList * meta_kms_feedback_get_failed_planes (const MetaKmsFeedback *feedback);
@@ -157,6 +158,11 @@ void meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
                                      MetaKmsCrtc        *crtc,
                                      const MetaGammaLut *gamma);
 
+META_EXPORT_TEST
+void meta_kms_update_set_crtc_ctm (MetaKmsUpdate *update,
+                                   MetaKmsCrtc   *crtc,
+                                   const float   *matrix);
+
 int
 meta_kms_update_get_sync_fd (MetaKmsUpdate *update);
 
@@ -164,6 +170,20 @@ void
 meta_kms_update_set_sync_fd (MetaKmsUpdate *update,
                              int            sync_fd);
 
+void
+meta_kms_update_set_acquire_sync_fd (MetaKmsUpdate *update,
+                                     int            sync_fd);
+
+gboolean
+meta_kms_update_is_sync_fd_required (MetaKmsUpdate *update);
+
+void
+meta_kms_update_set_allow_tearing (MetaKmsUpdate *update,
+                                   gboolean       allow_tearing);
+
+gboolean
+meta_kms_update_get_allow_tearing (MetaKmsUpdate *update);
+
 void meta_kms_plane_assignment_set_fb_damage (MetaKmsPlaneAssignment *plane_assignment,
                                               const int              *rectangles,
                                               int                     n_rectangles);
@@ -30,8 +30,11 @@
 #include "backends/native/meta-onscreen-native.h"
 
 #include <drm_fourcc.h>
+#include <fcntl.h>
+#include <math.h>
 
 #include "backends/meta-egl-ext.h"
+#include "backends/meta-settings-private.h"
 #include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-device-pool.h"
 #include "backends/native/meta-drm-buffer-dumb.h"
@@ -49,10 +52,15 @@
 #include "backends/native/meta-render-device.h"
 #include "backends/native/meta-renderer-native-gles3.h"
 #include "backends/native/meta-renderer-native-private.h"
+#include "clutter/clutter-mutter.h"
 #include "cogl/cogl.h"
 #include "common/meta-cogl-drm-formats.h"
 #include "common/meta-drm-format-helpers.h"
 
+/* How long to wait for another frame before copying out the last frame an
+ * asynchronous CPU copy left behind in a pixel buffer. */
+#define ASYNC_CPU_COPY_FLUSH_TIMEOUT_MS 50
+
 typedef enum _MetaSharedFramebufferImportStatus
 {
   /* Not tried importing yet. */
@@ -77,8 +85,24 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   struct {
     MetaDrmBufferDumb *current_dumb_fb;
     MetaDrmBufferDumb *dumb_fbs[2];
+    /* Frame each dumb buffer was last updated in, or 0 if never */
+    int64_t dumb_fb_frame_counts[2];
+
+    /* Asynchronous CPU copy: the frame is read back into a pixel buffer,
+     * which is copied into a dumb buffer one frame later. */
+    gboolean async_copy;
+    CoglPixelBuffer *pixel_buffers[2];
+    int64_t pixel_buffer_frame_counts[2];
+    unsigned int current_pixel_buffer;
+    guint flush_source_id;
+    gboolean flush_pending;
   } cpu;
 
+  /* Damage of the frames copied to the secondary GPU, used to only copy
+   * what changed since the destination buffer was last updated. */
+  ClutterDamageHistory *damage_history;
+  int64_t frame_count;
+
   gboolean noted_primary_gpu_copy_ok;
   gboolean noted_primary_gpu_copy_failed;
   MetaSharedFramebufferImportStatus import_status;
@@ -103,10 +127,14 @@ struct _MetaOnscreenNative
   MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state;
 
   ClutterFrame *presented_frame;
+  /* With triple buffering, the frame still waiting for its page flip when
+   * the next one was posted. */
+  ClutterFrame *posted_frame;
   ClutterFrame *next_frame;
 
   struct {
     struct gbm_surface *surface;
+    uint32_t format;
   } gbm;
 
 #ifdef HAVE_EGL_DEVICE
@@ -122,6 +150,15 @@ struct _MetaOnscreenNative
 
   MetaRendererView *view;
 
+  /* Whether the view color transform is applied via the CRTC CTM and gamma
+   * LUT, and whether the CTM is currently programmed. */
+  gboolean color_transform_offloaded;
+  gboolean ctm_active;
+
+  CoglScanout *pending_overlay_scanout;
+  /* The primary plane scanout the overlay scanout was tested with, if any */
+  CoglScanout *pending_overlay_primary_scanout;
+
   union {
     struct {
       KmsProperty gamma_lut;
@@ -148,6 +185,14 @@ meta_onscreen_native_swap_drm_fb (CoglOnscreen *onscreen)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
 
+  if (onscreen_native->posted_frame)
+    {
+      g_clear_pointer (&onscreen_native->presented_frame, clutter_frame_unref);
+      onscreen_native->presented_frame =
+        g_steal_pointer (&onscreen_native->posted_frame);
+      return;
+    }
+
   if (!onscreen_native->next_frame)
     return;
 
@@ -161,7 +206,27 @@ meta_onscreen_native_clear_next_fb (CoglOnscreen *onscreen)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
 
-  g_clear_pointer (&onscreen_native->next_frame, clutter_frame_unref);
+  if (onscreen_native->posted_frame)
+    g_clear_pointer (&onscreen_native->posted_frame, clutter_frame_unref);
+  else
+    g_clear_pointer (&onscreen_native->next_frame, clutter_frame_unref);
+}
+
+static void
+meta_onscreen_native_queue_next_frame (MetaOnscreenNative *onscreen_native,
+                                       ClutterFrame       *frame)
+{
+  /* The frame clock may post a frame while the previous one still waits for
+   * its page flip; the KMS update is then queued behind that page flip. */
+  if (onscreen_native->next_frame)
+    {
+      g_warn_if_fail (!onscreen_native->posted_frame);
+      g_clear_pointer (&onscreen_native->posted_frame, clutter_frame_unref);
+      onscreen_native->posted_frame =
+        g_steal_pointer (&onscreen_native->next_frame);
+    }
+
+  onscreen_native->next_frame = clutter_frame_ref (frame);
 }
 
 static void
@@ -254,7 +319,8 @@ page_flip_feedback_flipped (MetaKmsCrtc  *kms_crtc,
   struct timeval page_flip_time;
   MetaKmsDevice *kms_device;
   int64_t presentation_time_us;
-  CoglFrameInfoFlag flags = COGL_FRAME_INFO_FLAG_VSYNC;
+  CoglFrameInfoFlag flags = (COGL_FRAME_INFO_FLAG_VSYNC |
+                             COGL_FRAME_INFO_FLAG_HW_COMPLETION);
 
   page_flip_time = (struct timeval) {
     .tv_sec = tv_sec,
@@ -350,6 +416,9 @@ page_flip_feedback_discarded (MetaKmsCrtc  *kms_crtc,
 
     g_warning ("Page flip discarded: %s", error->message);
 
+  COGL_PERF_COUNTER_ADD (DroppedFrames, "DroppedFrames",
+                         "frames whose page flip was discarded", 1);
+
   frame_info = cogl_onscreen_peek_head_frame_info (onscreen);
   frame_info->flags |= COGL_FRAME_INFO_FLAG_SYMBOLIC;
 
@@ -441,40 +510,68 @@ meta_onscreen_native_dummy_power_save_page_flip (CoglOnscreen *onscreen)
   meta_onscreen_native_notify_frame_complete (onscreen);
 }
 
-static void
-apply_transform (MetaCrtcKms            *crtc_kms,
-                 MetaKmsPlaneAssignment *kms_plane_assignment,
-                 MetaKmsPlane           *kms_plane)
+/*
+ * Calculates the transform @kms_plane has to apply to present @scanout, or
+ * the onscreen contents if @scanout is NULL. The onscreen contents were
+ * already rendered with whatever part of the CRTC transform the planes
+ * can't handle, while client buffers are only pre-transformed by the
+ * buffer transform of the client.
+ */
+static gboolean
+calculate_plane_transform (MetaCrtcKms         *crtc_kms,
+                           MetaKmsPlane        *kms_plane,
+                           CoglScanout         *scanout,
+                           MtkMonitorTransform *out_transform)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   const MetaCrtcConfig *crtc_config;
   MtkMonitorTransform hw_transform;
+  MtkMonitorTransform inverted_buffer_transform;
 
   crtc_config = meta_crtc_get_config (crtc);
 
-  hw_transform = crtc_config->transform;
-  if (!meta_kms_plane_is_transform_handled (kms_plane, hw_transform))
-    hw_transform = MTK_MONITOR_TRANSFORM_NORMAL;
-  if (!meta_kms_plane_is_transform_handled (kms_plane, hw_transform))
-    return;
+  if (!scanout)
+    {
+      hw_transform = crtc_config->transform;
+      if (!meta_kms_plane_is_transform_handled (kms_plane, hw_transform))
+        hw_transform = MTK_MONITOR_TRANSFORM_NORMAL;
+
+      *out_transform = hw_transform;
+      return TRUE;
+    }
 
-  meta_kms_plane_update_set_rotation (kms_plane,
-                                      kms_plane_assignment,
-                                      hw_transform);
+  /* Only combinations where the order of the two transforms doesn't matter
+   * are considered; that covers everything planes are trusted to handle. */
+  inverted_buffer_transform =
+    mtk_monitor_transform_invert (cogl_scanout_get_transform (scanout));
+  hw_transform = mtk_monitor_transform_transform (crtc_config->transform,
+                                                  inverted_buffer_transform);
+  if (hw_transform !=
+      mtk_monitor_transform_transform (inverted_buffer_transform,
+                                       crtc_config->transform))
+    return FALSE;
+
+  if (hw_transform != MTK_MONITOR_TRANSFORM_NORMAL &&
+      !meta_kms_plane_is_transform_handled (kms_plane, hw_transform))
+    return FALSE;
+
+  *out_transform = hw_transform;
+  return TRUE;
 }
 
 static MetaKmsPlaneAssignment *
-assign_primary_plane (MetaCrtcKms            *crtc_kms,
-                      MetaDrmBuffer          *buffer,
-                      MetaKmsUpdate          *kms_update,
-                      MetaKmsAssignPlaneFlag  flags,
-                      const graphene_rect_t  *src_rect,
-                      const MtkRectangle     *dst_rect)
+assign_plane (MetaCrtcKms            *crtc_kms,
+              MetaKmsPlane           *kms_plane,
+              MetaDrmBuffer          *buffer,
+              MetaKmsUpdate          *kms_update,
+              MetaKmsAssignPlaneFlag  flags,
+              const graphene_rect_t  *src_rect,
+              const MtkRectangle     *dst_rect,
+              MtkMonitorTransform     transform)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   MetaFixed16Rectangle src_rect_fixed16;
   MetaKmsCrtc *kms_crtc;
-  MetaKmsPlane *primary_kms_plane;
   MetaKmsPlaneAssignment *plane_assignment;
 
   src_rect_fixed16 = (MetaFixed16Rectangle) {
@@ -485,27 +582,164 @@ assign_primary_plane (MetaCrtcKms            *crtc_kms,
   };
 
   meta_topic (META_DEBUG_KMS,
-              "Assigning buffer to primary plane update on CRTC "
+              "Assigning buffer to plane %u update on CRTC "
               "(%" G_GUINT64_FORMAT ") with src rect %f,%f %fx%f "
               "and dst rect %d,%d %dx%d",
+              meta_kms_plane_get_id (kms_plane),
               meta_crtc_get_id (crtc), src_rect->origin.x, src_rect->origin.y,
               src_rect->size.width, src_rect->size.height,
               dst_rect->x, dst_rect->y, dst_rect->width, dst_rect->height);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
-  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
   plane_assignment = meta_kms_update_assign_plane (kms_update,
                                                    kms_crtc,
-                                                   primary_kms_plane,
+                                                   kms_plane,
                                                    buffer,
                                                    src_rect_fixed16,
                                                    *dst_rect,
                                                    flags);
-  apply_transform (crtc_kms, plane_assignment, primary_kms_plane);
+  if (meta_kms_plane_is_transform_handled (kms_plane, transform))
+    {
+      meta_kms_plane_update_set_rotation (kms_plane,
+                                          plane_assignment,
+                                          transform);
+    }
 
   return plane_assignment;
 }
 
+static MetaKmsPlaneAssignment *
+assign_primary_plane (MetaCrtcKms            *crtc_kms,
+                      MetaDrmBuffer          *buffer,
+                      MetaKmsUpdate          *kms_update,
+                      MetaKmsAssignPlaneFlag  flags,
+                      const graphene_rect_t  *src_rect,
+                      const MtkRectangle     *dst_rect)
+{
+  MetaKmsPlane *kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  MtkMonitorTransform transform;
+
+  calculate_plane_transform (crtc_kms, kms_plane, NULL, &transform);
+
+  return assign_plane (crtc_kms,
+                       kms_plane,
+                       buffer,
+                       kms_update,
+                       flags,
+                       src_rect,
+                       dst_rect,
+                       transform);
+}
+
+static gboolean
+is_scanout_transform_handled (MetaCrtcKms  *crtc_kms,
+                              MetaKmsPlane *kms_plane,
+                              CoglScanout  *scanout)
+{
+  MtkMonitorTransform transform;
+
+  if (!calculate_plane_transform (crtc_kms, kms_plane, scanout, &transform))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Plane %u can't handle the scanout buffer transform",
+                  meta_kms_plane_get_id (kms_plane));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static MetaKmsPlaneAssignment *
+assign_scanout_plane (MetaCrtcKms            *crtc_kms,
+                      MetaKmsPlane           *kms_plane,
+                      CoglScanout            *scanout,
+                      MetaKmsUpdate          *kms_update,
+                      MetaKmsAssignPlaneFlag  flags)
+{
+  MetaDrmBuffer *buffer;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+  MtkMonitorTransform transform = MTK_MONITOR_TRANSFORM_NORMAL;
+
+  /* Checked by is_scanout_transform_handled() before the scanout was
+   * accepted. */
+  if (!calculate_plane_transform (crtc_kms, kms_plane, scanout, &transform))
+    g_warn_if_reached ();
+
+  cogl_scanout_get_src_rect (scanout, &src_rect);
+  cogl_scanout_get_dst_rect (scanout, &dst_rect);
+
+  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
+  return assign_plane (crtc_kms,
+                       kms_plane,
+                       buffer,
+                       kms_update,
+                       flags,
+                       &src_rect,
+                       &dst_rect,
+                       transform);
+}
+
+static void
+assign_overlay_plane (MetaCrtcKms   *crtc_kms,
+                      CoglScanout   *scanout,
+                      MetaKmsUpdate *kms_update)
+{
+  assign_scanout_plane (crtc_kms,
+                        meta_crtc_kms_get_assigned_overlay_plane (crtc_kms),
+                        scanout,
+                        kms_update,
+                        META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC);
+}
+
+static gboolean
+is_overlay_plane_in_use (MetaOnscreenNative *onscreen_native)
+{
+  MetaFrameNative *frame_native;
+
+  if (!onscreen_native->presented_frame)
+    return FALSE;
+
+  frame_native = meta_frame_native_from_frame (onscreen_native->presented_frame);
+  return !!meta_frame_native_get_overlay_scanout (frame_native);
+}
+
+static void
+update_overlay_plane (MetaOnscreenNative *onscreen_native,
+                      MetaCrtcKms        *crtc_kms,
+                      MetaFrameNative    *frame_native,
+                      MetaKmsUpdate      *kms_update)
+{
+  MetaKmsPlane *overlay_kms_plane;
+  g_autoptr (CoglScanout) overlay_scanout = NULL;
+  g_autoptr (CoglScanout) primary_scanout = NULL;
+
+  overlay_kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_kms_plane)
+    return;
+
+  overlay_scanout = g_steal_pointer (&onscreen_native->pending_overlay_scanout);
+  primary_scanout =
+    g_steal_pointer (&onscreen_native->pending_overlay_primary_scanout);
+
+  /* The overlay scanout was only tested on top of either the composited
+   * frame or a particular client buffer on the primary plane. */
+  if (meta_frame_native_get_scanout (frame_native) != primary_scanout)
+    g_clear_object (&overlay_scanout);
+
+  if (overlay_scanout)
+    {
+      assign_overlay_plane (crtc_kms, overlay_scanout, kms_update);
+      meta_frame_native_set_overlay_scanout (frame_native, overlay_scanout);
+    }
+  else if (is_overlay_plane_in_use (onscreen_native))
+    {
+      MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+
+      meta_kms_update_unassign_plane (kms_update, kms_crtc, overlay_kms_plane);
+    }
+}
+
 static void
 meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
                                 MetaRendererView       *view,
@@ -550,8 +784,17 @@ meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
 
       if (scanout)
         {
-          cogl_scanout_get_src_rect (scanout, &src_rect);
-          cogl_scanout_get_dst_rect (scanout, &dst_rect);
+          MetaKmsPlane *kms_plane =
+            meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+
+          plane_assignment = assign_scanout_plane (crtc_kms,
+                                                   kms_plane,
+                                                   scanout,
+                                                   kms_update,
+                                                   flags);
+
+          if (cogl_scanout_get_allow_tearing (scanout))
+            meta_kms_update_set_allow_tearing (kms_update, TRUE);
         }
       else
         {
@@ -567,20 +810,23 @@ meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
             .width = meta_drm_buffer_get_width (buffer),
             .height = meta_drm_buffer_get_height (buffer)
           };
-        }
 
-      plane_assignment = assign_primary_plane (crtc_kms,
-                                               buffer,
-                                               kms_update,
-                                               flags,
-                                               &src_rect,
-                                               &dst_rect);
+          plane_assignment = assign_primary_plane (crtc_kms,
+                                                   buffer,
+                                                   kms_update,
+                                                   flags,
+                                                   &src_rect,
+                                                   &dst_rect);
+        }
 
       if (rectangles != NULL && n_rectangles != 0)
         {
           meta_kms_plane_assignment_set_fb_damage (plane_assignment,
                                                    rectangles, n_rectangles);
         }
+
+      update_overlay_plane (onscreen_native, crtc_kms, frame_native,
+                            kms_update);
       break;
     case META_RENDERER_NATIVE_MODE_SURFACELESS:
       g_assert_not_reached ();
@@ -763,6 +1009,9 @@ secondary_gpu_release_dumb (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_s
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.pixel_buffers); i++)
+    g_clear_object (&secondary_gpu_state->cpu.pixel_buffers[i]);
 }
 
 static void
@@ -790,6 +1039,11 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
 
   secondary_gpu_release_dumb (secondary_gpu_state);
+  g_clear_handle_id (&secondary_gpu_state->cpu.flush_source_id,
+                     g_source_remove);
+
+  g_clear_pointer (&secondary_gpu_state->damage_history,
+                   clutter_damage_history_free);
 
   g_free (secondary_gpu_state);
 }
@@ -831,6 +1085,128 @@ import_shared_framebuffer (CoglOnscreen                        *onscreen,
   return imported_buffer;
 }
 
+static void
+record_secondary_gpu_damage (CoglOnscreen                        *onscreen,
+                             MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                             const int                           *rectangles,
+                             int                                  n_rectangles)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  g_autoptr (MtkRegion) damage = NULL;
+
+  if (n_rectangles == 0)
+    {
+      MtkRectangle full_rect = {
+        0, 0,
+        cogl_framebuffer_get_width (framebuffer),
+        cogl_framebuffer_get_height (framebuffer),
+      };
+
+      damage = mtk_region_create_rectangle (&full_rect);
+    }
+  else
+    {
+      MtkRectangle *rects = g_newa (MtkRectangle, n_rectangles);
+      int i;
+
+      for (i = 0; i < n_rectangles; i++)
+        {
+          rects[i] = (MtkRectangle) {
+            rectangles[i * 4],
+            rectangles[i * 4 + 1],
+            rectangles[i * 4 + 2],
+            rectangles[i * 4 + 3],
+          };
+        }
+
+      damage = mtk_region_create_rectangles (rects, n_rectangles);
+    }
+
+  if (!secondary_gpu_state->damage_history)
+    secondary_gpu_state->damage_history = clutter_damage_history_new ();
+
+  clutter_damage_history_step (secondary_gpu_state->damage_history);
+  clutter_damage_history_record (secondary_gpu_state->damage_history, damage);
+  secondary_gpu_state->frame_count++;
+}
+
+/* Returns the region that needs to be copied into a secondary GPU buffer
+ * last updated @buffer_age frames ago, or NULL if all of it needs to be. */
+static MtkRegion *
+get_secondary_gpu_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                               int                                  buffer_age)
+{
+  ClutterDamageHistory *damage_history = secondary_gpu_state->damage_history;
+  MtkRegion *copy_region;
+  int age;
+
+  if (!damage_history)
+    return NULL;
+
+  if (buffer_age != 1 &&
+      !clutter_damage_history_is_age_valid (damage_history, buffer_age - 1))
+    return NULL;
+
+  copy_region = mtk_region_copy (clutter_damage_history_lookup (damage_history, 0));
+  for (age = 1; age < buffer_age; age++)
+    {
+      mtk_region_union (copy_region,
+                        clutter_damage_history_lookup (damage_history, age));
+    }
+
+  return copy_region;
+}
+
+/* Returns the region that needs to be copied into a buffer last updated
+ * in frame @frame_count, or NULL if all of it needs to be. */
+static MtkRegion *
+get_copy_region_since (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                       int64_t                              frame_count)
+{
+  int64_t buffer_age;
+
+  if (frame_count == 0)
+    return NULL;
+
+  buffer_age = secondary_gpu_state->frame_count - frame_count;
+  if (buffer_age < 1 || buffer_age > G_MAXINT)
+    return NULL;
+
+  return get_secondary_gpu_copy_region (secondary_gpu_state, (int) buffer_age);
+}
+
+static MtkRegion *
+get_dumb_buffer_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                             MetaDrmBufferDumb                   *buffer_dumb)
+{
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
+    {
+      if (secondary_gpu_state->cpu.dumb_fbs[i] != buffer_dumb)
+        continue;
+
+      return get_copy_region_since (secondary_gpu_state,
+                                    secondary_gpu_state->cpu.dumb_fb_frame_counts[i]);
+    }
+
+  return NULL;
+}
+
+static void
+mark_dumb_buffer_updated (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                          MetaDrmBufferDumb                   *buffer_dumb,
+                          int64_t                              frame_count)
+{
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
+    {
+      if (secondary_gpu_state->cpu.dumb_fbs[i] == buffer_dumb)
+        secondary_gpu_state->cpu.dumb_fb_frame_counts[i] = frame_count;
+    }
+}
+
 static MetaDrmBuffer *
 copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
                              MetaOnscreenNativeSecondaryGpuState  *secondary_gpu_state,
@@ -851,6 +1227,8 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
   MetaDrmBufferFlags flags;
   MetaDrmBufferGbm *buffer_gbm = NULL;
   struct gbm_bo *bo;
+  EGLint buffer_age;
+  g_autoptr (MtkRegion) copy_region = NULL;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferSecondaryGpu,
                            "copy_shared_framebuffer_gpu()");
@@ -872,6 +1250,15 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
       goto done;
     }
 
+  if (meta_egl_query_surface (egl,
+                              egl_display,
+                              secondary_gpu_state->egl_surface,
+                              EGL_BUFFER_AGE_EXT,
+                              &buffer_age,
+                              NULL) &&
+      buffer_age > 0)
+    copy_region = get_secondary_gpu_copy_region (secondary_gpu_state, buffer_age);
+
   buffer_gbm = META_DRM_BUFFER_GBM (primary_gpu_fb);
   bo = meta_drm_buffer_gbm_get_bo (buffer_gbm);
   if (!meta_renderer_native_gles3_blit_shared_bo (egl,
@@ -880,6 +1267,7 @@ copy_shared_framebuffer_gpu (CoglOnscreen                         *onscreen,
                                                   renderer_gpu_data->secondary.egl_context,
                                                   secondary_gpu_state->egl_surface,
                                                   bo,
+                                                  copy_region,
                                                   error))
     {
       g_prefix_error (error, "Failed to blit shared framebuffer: ");
@@ -938,9 +1326,7 @@ secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *seconda
 
 static MetaDrmBuffer *
 copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscreen,
-                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                                     const int                           *rectangles,
-                                     int                                  n_rectangles)
+                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
@@ -954,6 +1340,7 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   CoglFramebuffer *dmabuf_fb;
   int dmabuf_fd;
   g_autoptr (GError) error = NULL;
+  g_autoptr (MtkRegion) copy_region = NULL;
   const MetaFormatInfo *format_info;
   uint64_t modifier;
 
@@ -1012,7 +1399,9 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   /* Limit the number of individual copies to 16 */
 #define MAX_RECTS 16
 
-  if (n_rectangles == 0 || n_rectangles > MAX_RECTS)
+  copy_region = get_dumb_buffer_copy_region (secondary_gpu_state, buffer_dumb);
+
+  if (!copy_region || mtk_region_num_rectangles (copy_region) > MAX_RECTS)
     {
       if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
                                   0, 0, 0, 0,
@@ -1025,15 +1414,17 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
     }
   else
     {
-      int i;
+      int n_rects, i;
 
-      for (i = 0; i < n_rectangles; ++i)
+      n_rects = mtk_region_num_rectangles (copy_region);
+      for (i = 0; i < n_rects; ++i)
         {
+          MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
+
           if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
-                                      rectangles[i * 4], rectangles[i * 4 + 1],
-                                      rectangles[i * 4], rectangles[i * 4 + 1],
-                                      rectangles[i * 4 + 2],
-                                      rectangles[i * 4 + 3],
+                                      rect.x, rect.y,
+                                      rect.x, rect.y,
+                                      rect.width, rect.height,
                                       &error))
             {
               g_object_unref (dmabuf_fb);
@@ -1048,6 +1439,8 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                            g_object_unref);
 
   secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+  mark_dumb_buffer_updated (secondary_gpu_state, buffer_dumb,
+                            secondary_gpu_state->frame_count);
 
   return g_object_ref (buffer);
 }
@@ -1067,6 +1460,9 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   CoglBitmap *dumb_bitmap;
   CoglPixelFormat cogl_format;
   const MetaFormatInfo *format_info;
+  g_autoptr (MtkRegion) copy_region = NULL;
+  int bpp;
+  int n_rects, i;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "copy_shared_framebuffer_cpu()");
@@ -1086,24 +1482,267 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   format_info = meta_format_info_from_drm_format (drm_format);
   g_assert (format_info);
   cogl_format = format_info->cogl_format;
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          stride,
-                                          buffer_data);
+  copy_region = get_dumb_buffer_copy_region (secondary_gpu_state, buffer_dumb);
+  if (!copy_region)
+    {
+      MtkRectangle full_rect = { 0, 0, width, height };
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+      copy_region = mtk_region_create_rectangle (&full_rect);
+    }
 
-  g_object_unref (dumb_bitmap);
+  /* Read back each rectangle straight into its place in the dumb buffer,
+   * leaving the parts that are still up to date untouched. */
+  n_rects = mtk_region_num_rectangles (copy_region);
+  COGL_TRACE_DESCRIBE (CopySharedFramebufferCpu,
+                       n_rects == 1 ? "1 rectangle" : "multiple rectangles");
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
+      uint8_t *rect_data;
+
+      rect_data = (uint8_t *) buffer_data + rect.y * stride + rect.x * bpp;
+      dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                              rect.width,
+                                              rect.height,
+                                              cogl_format,
+                                              stride,
+                                              rect_data);
+
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect.x,
+                                                     rect.y,
+                                                     COGL_READ_PIXELS_COLOR_BUFFER,
+                                                     dumb_bitmap))
+        g_warning ("Failed to CPU-copy to a secondary GPU output");
+
+      g_object_unref (dumb_bitmap);
+    }
 
   secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+  mark_dumb_buffer_updated (secondary_gpu_state, buffer_dumb,
+                            secondary_gpu_state->frame_count);
+
+  return g_object_ref (buffer);
+}
+
+static void
+read_back_into_pixel_buffer (CoglFramebuffer                     *framebuffer,
+                             MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                             unsigned int                         index,
+                             CoglPixelFormat                      cogl_format,
+                             int                                  stride)
+{
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  int width = cogl_framebuffer_get_width (framebuffer);
+  int height = cogl_framebuffer_get_height (framebuffer);
+  int bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+  CoglPixelBuffer *pixel_buffer;
+  g_autoptr (MtkRegion) copy_region = NULL;
+  int n_rects, i;
+
+  pixel_buffer = secondary_gpu_state->cpu.pixel_buffers[index];
+  if (!pixel_buffer)
+    {
+      pixel_buffer = cogl_pixel_buffer_new (cogl_context,
+                                            (size_t) stride * height,
+                                            NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (pixel_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+      secondary_gpu_state->cpu.pixel_buffers[index] = pixel_buffer;
+      secondary_gpu_state->cpu.pixel_buffer_frame_counts[index] = 0;
+    }
+
+  copy_region =
+    get_copy_region_since (secondary_gpu_state,
+                           secondary_gpu_state->cpu.pixel_buffer_frame_counts[index]);
+  if (!copy_region)
+    {
+      MtkRectangle full_rect = { 0, 0, width, height };
+
+      copy_region = mtk_region_create_rectangle (&full_rect);
+    }
+
+  /* The pixel buffer has the same layout as the dumb buffers, and is bound
+   * as the pack buffer during the read back, letting the driver queue the
+   * transfer instead of waiting for rendering to finish. */
+  n_rects = mtk_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (pixel_buffer),
+                                            cogl_format,
+                                            rect.width,
+                                            rect.height,
+                                            stride,
+                                            rect.y * stride + rect.x * bpp);
+
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect.x,
+                                                     rect.y,
+                                                     COGL_READ_PIXELS_COLOR_BUFFER,
+                                                     bitmap))
+        g_warning ("Failed to read back for an asynchronous CPU copy");
+    }
+
+  secondary_gpu_state->cpu.pixel_buffer_frame_counts[index] =
+    secondary_gpu_state->frame_count;
+}
+
+static gboolean
+flush_async_cpu_copy (gpointer user_data)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (user_data);
+  MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state =
+    onscreen_native->secondary_gpu_state;
+  ClutterStageView *view = CLUTTER_STAGE_VIEW (onscreen_native->view);
+  MtkRectangle layout;
+
+  secondary_gpu_state->cpu.flush_source_id = 0;
+  secondary_gpu_state->cpu.flush_pending = TRUE;
+
+  /* The last frame is still only in a pixel buffer; draw another one so it
+   * can be copied out synchronously. */
+  clutter_stage_view_get_layout (view, &layout);
+  clutter_stage_view_add_redraw_clip (view,
+                                      &MTK_RECTANGLE_INIT (layout.x,
+                                                           layout.y,
+                                                           1, 1));
+  clutter_stage_view_schedule_update (view);
+
+  return G_SOURCE_REMOVE;
+}
+
+static MetaDrmBuffer *
+copy_shared_framebuffer_cpu_async (CoglOnscreen                        *onscreen,
+                                   MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                   MetaRendererNativeGpuData           *renderer_gpu_data)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  MetaDrmBufferDumb *buffer_dumb;
+  MetaDrmBuffer *buffer;
+  unsigned int current, previous;
+  CoglBuffer *previous_buffer;
+  int64_t previous_frame_count;
+  int width, height, stride;
+  const MetaFormatInfo *format_info;
+  CoglPixelFormat cogl_format;
+  g_autoptr (MtkRegion) copy_region = NULL;
+  uint8_t *buffer_data;
+  const uint8_t *pixel_data;
+  int bpp;
+  int n_rects, i;
+
+  COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpuAsync,
+                           "copy_shared_framebuffer_cpu_async()");
+
+  g_clear_handle_id (&secondary_gpu_state->cpu.flush_source_id,
+                     g_source_remove);
+
+  if (secondary_gpu_state->cpu.flush_pending)
+    {
+      secondary_gpu_state->cpu.flush_pending = FALSE;
+      return copy_shared_framebuffer_cpu (onscreen,
+                                          secondary_gpu_state,
+                                          renderer_gpu_data);
+    }
+
+  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  buffer = META_DRM_BUFFER (buffer_dumb);
+
+  width = meta_drm_buffer_get_width (buffer);
+  height = meta_drm_buffer_get_height (buffer);
+  stride = meta_drm_buffer_get_stride (buffer);
+  buffer_data = meta_drm_buffer_dumb_get_data (buffer_dumb);
+
+  g_assert (cogl_framebuffer_get_width (framebuffer) == width);
+  g_assert (cogl_framebuffer_get_height (framebuffer) == height);
+
+  format_info =
+    meta_format_info_from_drm_format (meta_drm_buffer_get_format (buffer));
+  g_assert (format_info);
+  cogl_format = format_info->cogl_format;
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+
+  current = secondary_gpu_state->cpu.current_pixel_buffer;
+  previous = (current + 1) % G_N_ELEMENTS (secondary_gpu_state->cpu.pixel_buffers);
+  secondary_gpu_state->cpu.current_pixel_buffer = previous;
+
+  read_back_into_pixel_buffer (framebuffer, secondary_gpu_state, current,
+                               cogl_format, stride);
+
+  /* Nothing was read back the frame before; copy synchronously this once. */
+  previous_buffer = COGL_BUFFER (secondary_gpu_state->cpu.pixel_buffers[previous]);
+  previous_frame_count =
+    secondary_gpu_state->cpu.pixel_buffer_frame_counts[previous];
+  if (!previous_buffer ||
+      previous_frame_count != secondary_gpu_state->frame_count - 1)
+    {
+      return copy_shared_framebuffer_cpu (onscreen,
+                                          secondary_gpu_state,
+                                          renderer_gpu_data);
+    }
+
+  /* The read back into the previous pixel buffer was queued a frame ago,
+   * so mapping it should not have to wait for the GPU. Everything damaged
+   * since the dumb buffer was last updated is copied; that may include
+   * this frame's damage too, which is harmless since the pixel buffer holds
+   * a complete frame. */
+  pixel_data = cogl_buffer_map (previous_buffer,
+                                COGL_BUFFER_ACCESS_READ,
+                                0);
+  if (!pixel_data)
+    {
+      g_warning ("Failed to map pixel buffer for an asynchronous CPU copy");
+      return copy_shared_framebuffer_cpu (onscreen,
+                                          secondary_gpu_state,
+                                          renderer_gpu_data);
+    }
+
+  copy_region = get_dumb_buffer_copy_region (secondary_gpu_state, buffer_dumb);
+  if (!copy_region)
+    {
+      MtkRectangle full_rect = { 0, 0, width, height };
+
+      copy_region = mtk_region_create_rectangle (&full_rect);
+    }
+
+  n_rects = mtk_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
+      size_t offset = (size_t) rect.y * stride + rect.x * bpp;
+      int y;
+
+      if (rect.x == 0 && rect.width == width)
+        {
+          memcpy (buffer_data + offset, pixel_data + offset,
+                  (size_t) rect.height * stride);
+          continue;
+        }
+
+      for (y = 0; y < rect.height; y++)
+        {
+          memcpy (buffer_data + offset, pixel_data + offset,
+                  (size_t) rect.width * bpp);
+          offset += stride;
+        }
+    }
+
+  cogl_buffer_unmap (previous_buffer);
+
+  secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+  mark_dumb_buffer_updated (secondary_gpu_state, buffer_dumb,
+                            previous_frame_count);
+
+  secondary_gpu_state->cpu.flush_source_id =
+    g_timeout_add (ASYNC_CPU_COPY_FLUSH_TIMEOUT_MS,
+                   flush_async_cpu_copy,
+                   onscreen);
 
   return g_object_ref (buffer);
 }
@@ -1128,6 +1767,10 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
 
       renderer_gpu_data = secondary_gpu_state->renderer_gpu_data;
       render_device = renderer_gpu_data->render_device;
+
+      record_secondary_gpu_damage (onscreen, secondary_gpu_state,
+                                   rectangles, n_rectangles);
+
       switch (renderer_gpu_data->secondary.copy_mode)
         {
         case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
@@ -1142,9 +1785,7 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
           G_GNUC_FALLTHROUGH;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
           copy = copy_shared_framebuffer_primary_gpu (onscreen,
-                                                      secondary_gpu_state,
-                                                      rectangles,
-                                                      n_rectangles);
+                                                      secondary_gpu_state);
           if (!copy)
             {
               if (!secondary_gpu_state->noted_primary_gpu_copy_failed)
@@ -1155,9 +1796,18 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
                   secondary_gpu_state->noted_primary_gpu_copy_failed = TRUE;
                 }
 
-              copy = copy_shared_framebuffer_cpu (onscreen,
-                                                  secondary_gpu_state,
-                                                  renderer_gpu_data);
+              if (secondary_gpu_state->cpu.async_copy)
+                {
+                  copy = copy_shared_framebuffer_cpu_async (onscreen,
+                                                            secondary_gpu_state,
+                                                            renderer_gpu_data);
+                }
+              else
+                {
+                  copy = copy_shared_framebuffer_cpu (onscreen,
+                                                      secondary_gpu_state,
+                                                      renderer_gpu_data);
+                }
             }
           else if (!secondary_gpu_state->noted_primary_gpu_copy_ok)
             {
@@ -1246,6 +1896,27 @@ ensure_crtc_modes (CoglOnscreen  *onscreen,
     meta_onscreen_native_set_crtc_mode (onscreen, kms_update, renderer_gpu_data);
 }
 
+static void
+maybe_notify_overlay_failed (CoglOnscreen *onscreen)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaFrameNative *frame_native;
+  CoglScanout *overlay_scanout;
+
+  if (!onscreen_native->next_frame)
+    return;
+
+  frame_native = meta_frame_native_from_frame (onscreen_native->next_frame);
+  overlay_scanout = meta_frame_native_get_overlay_scanout (frame_native);
+  if (!overlay_scanout)
+    return;
+
+  /* The overlay plane passed the test commit but the real one failed; make
+   * sure the buffer isn't offered for scanout again so that the surface
+   * keeps being composited instead. */
+  cogl_scanout_notify_failed (overlay_scanout, onscreen);
+}
+
 static void
 swap_buffer_result_feedback (const MetaKmsFeedback *kms_feedback,
                              gpointer               user_data)
@@ -1266,7 +1937,10 @@ swap_buffer_result_feedback (const MetaKmsFeedback *kms_feedback,
   if (!g_error_matches (error,
                         G_IO_ERROR,
                         G_IO_ERROR_PERMISSION_DENIED))
-    g_warning ("Page flip failed: %s", error->message);
+    {
+      g_warning ("Page flip failed: %s", error->message);
+      maybe_notify_overlay_failed (onscreen);
+    }
 
   frame_info = cogl_onscreen_peek_head_frame_info (onscreen);
   frame_info->flags |= COGL_FRAME_INFO_FLAG_SYMBOLIC;
@@ -1402,8 +2076,7 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen  *onscreen,
 #endif
     }
 
-  g_warn_if_fail (!onscreen_native->next_frame);
-  onscreen_native->next_frame = clutter_frame_ref (frame);
+  meta_onscreen_native_queue_next_frame (onscreen_native, frame);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (onscreen_native->crtc));
   kms_device = meta_kms_crtc_get_device (kms_crtc);
@@ -1522,12 +2195,14 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   MetaGpuKms *gpu_kms;
   MetaKmsDevice *kms_device;
   MetaKmsCrtc *kms_crtc;
+  MetaKmsPlane *kms_plane;
   MetaKmsUpdate *test_update;
-  MetaDrmBuffer *buffer;
   g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
   MetaKmsFeedbackResult result;
-  graphene_rect_t src_rect;
-  MtkRectangle dst_rect;
+
+  kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  if (!is_scanout_transform_handled (crtc_kms, kms_plane, scanout))
+    return FALSE;
 
   gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
   kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
@@ -1535,16 +2210,11 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
 
   test_update = meta_kms_update_new (kms_device);
 
-  cogl_scanout_get_src_rect (scanout, &src_rect);
-  cogl_scanout_get_dst_rect (scanout, &dst_rect);
-
-  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
-  assign_primary_plane (crtc_kms,
-                        buffer,
+  assign_scanout_plane (crtc_kms,
+                        kms_plane,
+                        scanout,
                         test_update,
-                        META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC,
-                        &src_rect,
-                        &dst_rect);
+                        META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC);
 
   meta_topic (META_DEBUG_KMS,
               "Posting direct scanout test update for CRTC %u (%s) synchronously",
@@ -1559,6 +2229,122 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   return result == META_KMS_FEEDBACK_PASSED;
 }
 
+gboolean
+meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                   CoglScanout  *scanout,
+                                                   CoglScanout  *primary_scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaCrtc *crtc = onscreen_native->crtc;
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  MetaFrameNative *presented_frame_native;
+  MetaGpuKms *gpu_kms;
+  MetaKmsDevice *kms_device;
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsPlane *overlay_kms_plane;
+  MetaKmsPlane *primary_kms_plane;
+  MetaKmsUpdate *test_update;
+  MetaDrmBuffer *primary_buffer = NULL;
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  MetaKmsFeedbackResult result;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+
+  overlay_kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_kms_plane)
+    return FALSE;
+
+  renderer_gpu_data =
+    meta_renderer_native_get_gpu_data (renderer_native,
+                                       onscreen_native->render_gpu);
+  if (renderer_gpu_data->mode != META_RENDERER_NATIVE_MODE_GBM)
+    return FALSE;
+
+  if (!is_scanout_transform_handled (crtc_kms, overlay_kms_plane, scanout))
+    return FALSE;
+
+  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  if (primary_scanout)
+    {
+      if (!is_scanout_transform_handled (crtc_kms, primary_kms_plane,
+                                         primary_scanout))
+        return FALSE;
+    }
+  else
+    {
+      /* Without a client buffer to scan out on the primary plane, the
+       * overlay plane is tested together with what the primary plane is
+       * currently showing, as most drivers can't enable an overlay plane on
+       * its own. */
+      if (!onscreen_native->presented_frame)
+        return FALSE;
+
+      presented_frame_native =
+        meta_frame_native_from_frame (onscreen_native->presented_frame);
+      primary_buffer = meta_frame_native_get_buffer (presented_frame_native);
+      if (!primary_buffer ||
+          meta_frame_native_get_scanout (presented_frame_native))
+        return FALSE;
+    }
+
+  gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+  kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
+  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+
+  test_update = meta_kms_update_new (kms_device);
+
+  if (primary_scanout)
+    {
+      assign_scanout_plane (crtc_kms,
+                            primary_kms_plane,
+                            primary_scanout,
+                            test_update,
+                            META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC);
+    }
+  else
+    {
+      src_rect = (graphene_rect_t) {
+        .size.width = meta_drm_buffer_get_width (primary_buffer),
+        .size.height = meta_drm_buffer_get_height (primary_buffer),
+      };
+      dst_rect = (MtkRectangle) {
+        .width = meta_drm_buffer_get_width (primary_buffer),
+        .height = meta_drm_buffer_get_height (primary_buffer),
+      };
+      assign_primary_plane (crtc_kms,
+                            primary_buffer,
+                            test_update,
+                            META_KMS_ASSIGN_PLANE_FLAG_NONE,
+                            &src_rect,
+                            &dst_rect);
+    }
+  assign_overlay_plane (crtc_kms, scanout, test_update);
+
+  meta_topic (META_DEBUG_KMS,
+              "Posting overlay plane test update for CRTC %u (%s) synchronously",
+              meta_kms_crtc_get_id (kms_crtc),
+              meta_kms_device_get_path (kms_device));
+
+  kms_feedback =
+    meta_kms_device_process_update_sync (kms_device, test_update,
+                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+
+  result = meta_kms_feedback_get_result (kms_feedback);
+  return result == META_KMS_FEEDBACK_PASSED;
+}
+
+void
+meta_onscreen_native_set_overlay_scanout (MetaOnscreenNative *onscreen_native,
+                                          CoglScanout        *scanout,
+                                          CoglScanout        *primary_scanout)
+{
+  g_set_object (&onscreen_native->pending_overlay_scanout, scanout);
+  g_set_object (&onscreen_native->pending_overlay_primary_scanout,
+                primary_scanout);
+}
+
 static void
 scanout_result_feedback (const MetaKmsFeedback *kms_feedback,
                          gpointer               user_data)
@@ -1626,6 +2412,7 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
   MetaKmsCrtc *kms_crtc;
   MetaKmsDevice *kms_device;
   MetaKmsUpdate *kms_update;
+  int sync_fd;
 
   power_save_mode = meta_monitor_manager_get_power_save_mode (monitor_manager);
   if (power_save_mode != META_POWER_SAVE_ON)
@@ -1651,14 +2438,14 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
 
   g_warn_if_fail (renderer_gpu_data->mode == META_RENDERER_NATIVE_MODE_GBM);
 
-  g_warn_if_fail (!onscreen_native->next_frame);
-  onscreen_native->next_frame = clutter_frame_ref (frame);
+  meta_onscreen_native_queue_next_frame (onscreen_native, frame);
 
   meta_frame_native_set_scanout (frame_native, scanout);
   meta_frame_native_set_buffer (frame_native,
                                 META_DRM_BUFFER (cogl_scanout_get_buffer (scanout)));
 
   frame_info->cpu_time_before_buffer_swap_us = g_get_monotonic_time ();
+  frame_info->flags |= COGL_FRAME_INFO_FLAG_ZERO_COPY;
 
   if (cogl_context_has_feature (cogl_context, COGL_FEATURE_ID_TIMESTAMP_QUERY))
     frame_info->has_valid_gpu_rendering_duration = TRUE;
@@ -1667,6 +2454,13 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
   kms_device = meta_kms_crtc_get_device (kms_crtc);
   kms_update = meta_frame_native_ensure_kms_update (frame_native, kms_device);
 
+  sync_fd = cogl_scanout_get_sync_fd (scanout);
+  if (sync_fd >= 0)
+    {
+      meta_kms_update_set_acquire_sync_fd (kms_update,
+                                           fcntl (sync_fd, F_DUPFD_CLOEXEC, 0));
+    }
+
   meta_kms_update_add_result_listener (kms_update,
                                        &scanout_result_listener_vtable,
                                        NULL,
@@ -1743,6 +2537,18 @@ maybe_update_frame_sync (MetaOnscreenNative *onscreen_native,
 
   if (frame_sync_enabled != onscreen_native->frame_sync_enabled)
     {
+      const MetaOutputInfo *output_info =
+        meta_output_get_info (onscreen_native->output);
+      int min_refresh_rate;
+
+      if (frame_sync_enabled &&
+          meta_output_info_get_min_refresh_rate (output_info,
+                                                 &min_refresh_rate))
+        {
+          clutter_frame_clock_set_minimum_refresh_rate (frame_clock,
+                                                        min_refresh_rate);
+        }
+
       frame_clock_mode = frame_sync_enabled ? CLUTTER_FRAME_CLOCK_MODE_VARIABLE :
                                               CLUTTER_FRAME_CLOCK_MODE_FIXED;
       clutter_frame_clock_set_mode (frame_clock, frame_clock_mode);
@@ -1774,6 +2580,88 @@ meta_onscreen_native_before_redraw (CoglOnscreen *onscreen,
   maybe_update_frame_sync (onscreen_native, frame);
 }
 
+static uint16_t
+sample_gamma_lut_channel (const uint16_t *channel,
+                          size_t          size,
+                          float           value)
+{
+  float position = value * (size - 1);
+  size_t idx = (size_t) position;
+  float fraction;
+
+  if (idx >= size - 1)
+    return channel[size - 1];
+
+  fraction = position - idx;
+
+  return (uint16_t) roundf (channel[idx] * (1.0f - fraction) +
+                            channel[idx + 1] * fraction);
+}
+
+static void
+set_offloaded_color_transform (MetaOnscreenNative *onscreen_native,
+                               MetaKmsUpdate      *kms_update)
+{
+  ClutterStageView *stage_view = CLUTTER_STAGE_VIEW (onscreen_native->view);
+  ClutterColorState *color_state =
+    clutter_stage_view_get_color_state (stage_view);
+  ClutterColorState *output_color_state =
+    clutter_stage_view_get_output_color_state (stage_view);
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  const MetaKmsCrtcState *crtc_state =
+    meta_kms_crtc_get_current_state (kms_crtc);
+  const MetaGammaLut *calibration;
+  g_autoptr (MetaGammaLut) lut = NULL;
+  g_autofree float *values = NULL;
+  float matrix[9];
+  size_t size;
+  size_t i;
+
+  if (!clutter_color_state_get_separable_transform (color_state,
+                                                    output_color_state,
+                                                    matrix))
+    g_assert_not_reached ();
+
+  size = crtc_state->gamma.size;
+  values = g_new (float, size);
+  for (i = 0; i < size; i++)
+    values[i] = (float) i / (size - 1);
+
+  clutter_color_state_encode (output_color_state, values, size);
+
+  /* Apply the calibration, e.g. night light, on top of the encoding */
+  calibration = meta_crtc_kms_peek_gamma_lut (crtc_kms);
+  lut = meta_gamma_lut_new_sized (size);
+  for (i = 0; i < size; i++)
+    {
+      if (calibration && calibration->size > 0)
+        {
+          lut->red[i] = sample_gamma_lut_channel (calibration->red,
+                                                  calibration->size,
+                                                  values[i]);
+          lut->green[i] = sample_gamma_lut_channel (calibration->green,
+                                                    calibration->size,
+                                                    values[i]);
+          lut->blue[i] = sample_gamma_lut_channel (calibration->blue,
+                                                   calibration->size,
+                                                   values[i]);
+        }
+      else
+        {
+          uint16_t value = (uint16_t) roundf (values[i] * UINT16_MAX);
+
+          lut->red[i] = value;
+          lut->green[i] = value;
+          lut->blue[i] = value;
+        }
+    }
+
+  meta_kms_update_set_crtc_ctm (kms_update, kms_crtc, matrix);
+  meta_kms_update_set_crtc_gamma (kms_update, kms_crtc, lut);
+  onscreen_native->ctm_active = TRUE;
+}
+
 void
 meta_onscreen_native_prepare_frame (CoglOnscreen *onscreen,
                                     ClutterFrame *frame)
@@ -1794,8 +2682,21 @@ meta_onscreen_native_prepare_frame (CoglOnscreen *onscreen,
       kms_update = meta_frame_native_ensure_kms_update (frame_native,
                                                         kms_device);
 
-      gamma = meta_crtc_kms_peek_gamma_lut (crtc_kms);
-      meta_kms_update_set_crtc_gamma (kms_update, kms_crtc, gamma);
+      if (onscreen_native->color_transform_offloaded)
+        {
+          set_offloaded_color_transform (onscreen_native, kms_update);
+        }
+      else
+        {
+          gamma = meta_crtc_kms_peek_gamma_lut (crtc_kms);
+          meta_kms_update_set_crtc_gamma (kms_update, kms_crtc, gamma);
+
+          if (onscreen_native->ctm_active)
+            {
+              meta_kms_update_set_crtc_ctm (kms_update, kms_crtc, NULL);
+              onscreen_native->ctm_active = FALSE;
+            }
+        }
       onscreen_native->property.gamma_lut.invalidated = FALSE;
       onscreen_native->property.gamma_lut.target_frame_counter =
         target_frame_counter;
@@ -1889,6 +2790,112 @@ static const MetaKmsResultListenerVtable finish_frame_result_listener_vtable = {
   .feedback = finish_frame_result_feedback,
 };
 
+/*
+ * Presents the buffers of the last presented frame again, to keep a variable
+ * refresh rate output within its refresh rate range when the content updates
+ * less often.
+ */
+static gboolean
+repeat_presented_frame (CoglOnscreen *onscreen,
+                        ClutterFrame *frame)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaCrtc *crtc = onscreen_native->crtc;
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  MetaKmsDevice *kms_device = meta_kms_crtc_get_device (kms_crtc);
+  MetaFrameNative *frame_native = meta_frame_native_from_frame (frame);
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  MetaFrameNative *presented_frame_native;
+  MetaDrmBuffer *buffer;
+  CoglScanout *scanout;
+  MetaKmsUpdate *kms_update;
+
+  renderer_gpu_data =
+    meta_renderer_native_get_gpu_data (renderer_native,
+                                       onscreen_native->render_gpu);
+  if (renderer_gpu_data->mode != META_RENDERER_NATIVE_MODE_GBM)
+    return FALSE;
+
+  if (!onscreen_native->presented_frame ||
+      onscreen_native->next_frame ||
+      meta_renderer_native_has_pending_mode_set (renderer_native))
+    return FALSE;
+
+  presented_frame_native =
+    meta_frame_native_from_frame (onscreen_native->presented_frame);
+  buffer = meta_frame_native_get_buffer (presented_frame_native);
+  if (!buffer)
+    return FALSE;
+
+  scanout = meta_frame_native_get_scanout (presented_frame_native);
+
+  /* Keep the buffers alive until the repeated frame has been replaced. */
+  meta_frame_native_set_buffer (frame_native, buffer);
+  meta_frame_native_set_scanout (frame_native, scanout);
+  meta_frame_native_set_overlay_scanout (
+    frame_native,
+    meta_frame_native_get_overlay_scanout (presented_frame_native));
+
+  kms_update = meta_kms_update_new (kms_device);
+
+  if (scanout)
+    {
+      assign_scanout_plane (crtc_kms,
+                            meta_crtc_kms_get_assigned_primary_plane (crtc_kms),
+                            scanout,
+                            kms_update,
+                            META_KMS_ASSIGN_PLANE_FLAG_NONE);
+    }
+  else
+    {
+      graphene_rect_t src_rect;
+      MtkRectangle dst_rect;
+
+      src_rect = (graphene_rect_t) {
+        .size.width = meta_drm_buffer_get_width (buffer),
+        .size.height = meta_drm_buffer_get_height (buffer),
+      };
+      dst_rect = (MtkRectangle) {
+        .width = meta_drm_buffer_get_width (buffer),
+        .height = meta_drm_buffer_get_height (buffer),
+      };
+      assign_primary_plane (crtc_kms,
+                            buffer,
+                            kms_update,
+                            META_KMS_ASSIGN_PLANE_FLAG_NONE,
+                            &src_rect,
+                            &dst_rect);
+    }
+
+  meta_onscreen_native_queue_next_frame (onscreen_native, frame);
+
+  meta_kms_update_add_result_listener (kms_update,
+                                       &swap_buffer_result_listener_vtable,
+                                       NULL,
+                                       onscreen_native,
+                                       NULL);
+  meta_kms_update_add_page_flip_listener (kms_update,
+                                          kms_crtc,
+                                          &page_flip_listener_vtable,
+                                          NULL,
+                                          g_object_ref (onscreen_native->view),
+                                          g_object_unref);
+  add_onscreen_frame_info (crtc);
+
+  meta_topic (META_DEBUG_KMS,
+              "Posting repeated frame update for CRTC %u (%s)",
+              meta_kms_crtc_get_id (kms_crtc),
+              meta_kms_device_get_path (kms_device));
+
+  meta_kms_device_post_update (kms_device, kms_update,
+                               META_KMS_UPDATE_FLAG_NONE);
+  clutter_frame_set_result (frame, CLUTTER_FRAME_RESULT_PENDING_PRESENTED);
+
+  return TRUE;
+}
+
 void
 meta_onscreen_native_finish_frame (CoglOnscreen *onscreen,
                                    ClutterFrame *frame)
@@ -1903,6 +2910,10 @@ meta_onscreen_native_finish_frame (CoglOnscreen *onscreen,
   kms_update = meta_frame_native_steal_kms_update (frame_native);
   if (!kms_update)
     {
+      if (clutter_frame_is_repeat (frame) &&
+          repeat_presented_frame (onscreen, frame))
+        return;
+
       if (meta_kms_device_handle_flush (kms_device, kms_crtc))
         {
           kms_update = meta_kms_update_new (kms_device);
@@ -2088,6 +3099,75 @@ get_supported_kms_formats (CoglOnscreen *onscreen)
   return meta_kms_plane_copy_drm_format_list (plane);
 }
 
+static gboolean
+can_offload_color_transform (MetaOnscreenNative *onscreen_native)
+{
+  MetaRenderer *renderer = META_RENDERER (onscreen_native->renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  const MetaKmsCrtcState *crtc_state =
+    meta_kms_crtc_get_current_state (kms_crtc);
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        settings, META_EXPERIMENTAL_FEATURE_KMS_COLOR_TRANSFORM))
+    return FALSE;
+
+  return crtc_state->ctm.supported && crtc_state->gamma.size > 1;
+}
+
+static gboolean
+choose_fp16_egl_config (MetaOnscreenNative *onscreen_native,
+                        MetaEgl            *egl,
+                        EGLDisplay          egl_display,
+                        const EGLint       *attrs,
+                        EGLConfig          *out_config)
+{
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsPlane *kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  static const uint32_t fp16_formats[] = {
+    GBM_FORMAT_XBGR16161616F,
+    GBM_FORMAT_ABGR16161616F,
+  };
+  EGLint fp16_attrs[MAX_EGL_CONFIG_ATTRIBS];
+  g_autoptr (GError) error = NULL;
+  int i;
+
+  if (!meta_egl_has_extensions (egl, egl_display, NULL,
+                                "EGL_EXT_pixel_format_float",
+                                NULL))
+    return FALSE;
+
+  for (i = 0; attrs[i] != EGL_NONE; i += 2)
+    {
+      fp16_attrs[i] = attrs[i];
+      fp16_attrs[i + 1] = attrs[i + 1];
+    }
+
+  g_assert (i + 2 < MAX_EGL_CONFIG_ATTRIBS);
+  fp16_attrs[i++] = EGL_COLOR_COMPONENT_TYPE_EXT;
+  fp16_attrs[i++] = EGL_COLOR_COMPONENT_TYPE_FLOAT_EXT;
+  fp16_attrs[i] = EGL_NONE;
+
+  if (!meta_renderer_native_choose_gbm_format (kms_plane,
+                                               egl,
+                                               egl_display,
+                                               fp16_attrs,
+                                               fp16_formats,
+                                               G_N_ELEMENTS (fp16_formats),
+                                               "surface",
+                                               out_config,
+                                               &error))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Not using half float surface: %s", error->message);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 choose_onscreen_egl_config (CoglOnscreen  *onscreen,
                             EGLConfig     *out_config,
@@ -2124,6 +3204,15 @@ choose_onscreen_egl_config (CoglOnscreen  *onscreen,
   cogl_display_egl_determine_attributes (cogl_display,
                                          attrs);
 
+  if (!should_surface_be_sharable (onscreen) &&
+      can_offload_color_transform (onscreen_native) &&
+      choose_fp16_egl_config (onscreen_native,
+                              egl,
+                              egl_display,
+                              attrs,
+                              out_config))
+    return TRUE;
+
   /* Secondary GPU contexts use GLES3, which doesn't guarantee that 10 bpc
    * formats without alpha are renderable
    */
@@ -2194,6 +3283,7 @@ create_surfaces_gbm (CoglOnscreen        *onscreen,
   format = get_gbm_format_from_egl (egl,
                                     cogl_renderer_egl->edpy,
                                     egl_config);
+  onscreen_native->gbm.format = format;
 
   if (meta_renderer_native_use_modifiers (renderer_native))
     modifiers = get_supported_modifiers (onscreen, format);
@@ -2345,6 +3435,77 @@ create_surfaces_egl_device (CoglOnscreen  *onscreen,
 }
 #endif /* HAVE_EGL_DEVICE */
 
+static ClutterEncodingRequiredFormat
+get_surface_encoding_format (MetaOnscreenNative *onscreen_native)
+{
+  switch (onscreen_native->gbm.format)
+    {
+    case GBM_FORMAT_XBGR16161616F:
+    case GBM_FORMAT_ABGR16161616F:
+      return CLUTTER_ENCODING_REQUIRED_FORMAT_FP16;
+    case GBM_FORMAT_XRGB2101010:
+    case GBM_FORMAT_XBGR2101010:
+    case GBM_FORMAT_RGBX1010102:
+    case GBM_FORMAT_BGRX1010102:
+    case GBM_FORMAT_ARGB2101010:
+    case GBM_FORMAT_ABGR2101010:
+    case GBM_FORMAT_RGBA1010102:
+    case GBM_FORMAT_BGRA1010102:
+      return CLUTTER_ENCODING_REQUIRED_FORMAT_UINT10;
+    default:
+      return CLUTTER_ENCODING_REQUIRED_FORMAT_UINT8;
+    }
+}
+
+/**
+ * meta_onscreen_native_update_color_transform:
+ * @onscreen_native: a #MetaOnscreenNative
+ * @color_state: the color state the view is painted in
+ * @output_color_state: the color state of the output
+ *
+ * Decides whether the transform from @color_state to @output_color_state is
+ * applied by the CRTC color management properties, instead of in an
+ * additional pass when painting the view. That requires the CRTC to expose a
+ * CTM and a gamma LUT, and the surface to be able to hold @color_state
+ * without loss of precision.
+ *
+ * Returns: %TRUE if the color transform is offloaded
+ */
+gboolean
+meta_onscreen_native_update_color_transform (MetaOnscreenNative *onscreen_native,
+                                             ClutterColorState  *color_state,
+                                             ClutterColorState  *output_color_state)
+{
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  float matrix[9];
+  gboolean offloaded;
+
+  offloaded =
+    can_offload_color_transform (onscreen_native) &&
+    !clutter_color_state_equals (color_state, output_color_state) &&
+    clutter_color_state_required_format (color_state) <=
+    get_surface_encoding_format (onscreen_native) &&
+    clutter_color_state_get_separable_transform (color_state,
+                                                 output_color_state,
+                                                 matrix);
+
+  if (offloaded != onscreen_native->color_transform_offloaded)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "%s color transform offloading for CRTC %u",
+                  offloaded ? "Enabling" : "Disabling",
+                  meta_kms_crtc_get_id (kms_crtc));
+    }
+
+  if (offloaded || onscreen_native->color_transform_offloaded)
+    onscreen_native->property.gamma_lut.invalidated = TRUE;
+
+  onscreen_native->color_transform_offloaded = offloaded;
+
+  return offloaded;
+}
+
 void
 meta_onscreen_native_set_view (CoglOnscreen     *onscreen,
                                MetaRendererView *view)
@@ -2568,6 +3729,21 @@ pick_secondary_gpu_framebuffer_format_for_cpu (CoglOnscreen *onscreen)
   return DRM_FORMAT_INVALID;
 }
 
+static gboolean
+should_use_async_cpu_copy (MetaOnscreenNative *onscreen_native)
+{
+  const char *async_connectors_str;
+  g_auto (GStrv) names = NULL;
+
+  async_connectors_str = g_getenv ("MUTTER_DEBUG_ASYNC_CPU_COPY_CONNECTORS");
+  if (!async_connectors_str || *async_connectors_str == '\0')
+    return FALSE;
+
+  names = g_strsplit (async_connectors_str, ":", -1);
+  return g_strv_contains ((const char * const *) names,
+                          meta_output_get_name (onscreen_native->output));
+}
+
 static gboolean
 init_secondary_gpu_state_cpu_copy_mode (MetaRendererNative         *renderer_native,
                                         CoglOnscreen               *onscreen,
@@ -2626,6 +3802,20 @@ init_secondary_gpu_state_cpu_copy_mode (MetaRendererNative         *renderer_nat
       secondary_gpu_state->cpu.dumb_fbs[i] = META_DRM_BUFFER_DUMB (dumb_buffer);
     }
 
+  /*
+   * Pipelining the CPU copy trades one frame of latency for not stalling on
+   * the read back every frame, which is worth it on outputs such as USB
+   * docks that always rely on it.
+   */
+  secondary_gpu_state->cpu.async_copy =
+    should_use_async_cpu_copy (onscreen_native);
+  if (secondary_gpu_state->cpu.async_copy)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Using asynchronous CPU copy for %s",
+                  meta_output_get_name (onscreen_native->output));
+    }
+
   /*
    * This function initializes everything needed for
    * META_SHARED_FRAMEBUFFER_COPY_MODE_ZERO as well.
@@ -2842,7 +4032,10 @@ meta_onscreen_native_dispose (GObject *object)
   meta_onscreen_native_detach (onscreen_native);
 
   g_clear_pointer (&onscreen_native->next_frame, clutter_frame_unref);
+  g_clear_pointer (&onscreen_native->posted_frame, clutter_frame_unref);
   g_clear_pointer (&onscreen_native->presented_frame, clutter_frame_unref);
+  g_clear_object (&onscreen_native->pending_overlay_scanout);
+  g_clear_object (&onscreen_native->pending_overlay_primary_scanout);
 
   renderer_gpu_data =
     meta_renderer_native_get_gpu_data (renderer_native,
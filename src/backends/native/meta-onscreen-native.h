@@ -48,9 +48,21 @@ void meta_onscreen_native_dummy_power_save_page_flip (CoglOnscreen *onscreen);
 gboolean meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
                                                             CoglScanout  *scanout);
 
+gboolean meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                            CoglScanout  *scanout,
+                                                            CoglScanout  *primary_scanout);
+
+void meta_onscreen_native_set_overlay_scanout (MetaOnscreenNative *onscreen_native,
+                                               CoglScanout        *scanout,
+                                               CoglScanout        *primary_scanout);
+
 void meta_onscreen_native_set_view (CoglOnscreen     *onscreen,
                                     MetaRendererView *view);
 
+gboolean meta_onscreen_native_update_color_transform (MetaOnscreenNative *onscreen_native,
+                                                      ClutterColorState  *color_state,
+                                                      ClutterColorState  *output_color_state);
+
 MetaOnscreenNative * meta_onscreen_native_new (MetaRendererNative *renderer_native,
                                                MetaGpuKms         *render_gpu,
                                                MetaOutput         *output,
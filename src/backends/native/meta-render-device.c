@@ -25,6 +25,17 @@
 #include "backends/native/meta-backend-native-types.h"
 #include "backends/native/meta-drm-buffer-dumb.h"
 
+/*
+ * Buffers allocated by the render device are kept track of with a toggle
+ * reference, and once nobody but the render device holds on to them, they
+ * are recycled for later allocations with the same format, modifier and
+ * size. This avoids allocating, mapping and adding framebuffers for e.g.
+ * secondary GPU copy buffers and screen cast buffers that come and go with
+ * mode sets and streams. Idle buffers are only retained for a short while.
+ */
+#define MAX_IDLE_RECYCLED_BUFFERS 4
+#define RECYCLED_BUFFER_EXPIRE_INTERVAL_S 2
+
 enum
 {
   PROP_0,
@@ -37,6 +48,25 @@ enum
 
 static GParamSpec *obj_props[N_PROPS];
 
+typedef enum _MetaRecycledBufferType
+{
+  META_RECYCLED_BUFFER_TYPE_DMA_BUF,
+  META_RECYCLED_BUFFER_TYPE_DUMB,
+} MetaRecycledBufferType;
+
+typedef struct _MetaRecycledBuffer
+{
+  MetaDrmBuffer *buffer;
+  MetaRecycledBufferType type;
+  gboolean has_explicit_modifier;
+
+  /* Set from the toggle notify, which may be called from any thread. */
+  int is_idle;
+
+  /* Whether the buffer was idle on the last expiration tick. */
+  gboolean expiring;
+} MetaRecycledBuffer;
+
 typedef struct _MetaRenderDevicePrivate
 {
   MetaBackend *backend;
@@ -47,6 +77,9 @@ typedef struct _MetaRenderDevicePrivate
   EGLConfig egl_config;
 
   gboolean is_hardware_rendering;
+
+  GList *recycled_buffers;
+  guint recycled_buffers_expire_id;
 } MetaRenderDevicePrivate;
 
 static void
@@ -215,6 +248,202 @@ meta_render_device_set_property (GObject      *object,
     }
 }
 
+static void
+recycled_buffer_toggle_notify (gpointer  user_data,
+                               GObject  *object,
+                               gboolean  is_last_ref)
+{
+  MetaRecycledBuffer *recycled_buffer = user_data;
+
+  g_atomic_int_set (&recycled_buffer->is_idle, is_last_ref);
+}
+
+static void
+recycled_buffer_free (MetaRecycledBuffer *recycled_buffer)
+{
+  g_object_remove_toggle_ref (G_OBJECT (recycled_buffer->buffer),
+                              recycled_buffer_toggle_notify,
+                              recycled_buffer);
+  g_free (recycled_buffer);
+}
+
+static gboolean
+recycled_buffer_is_idle (MetaRecycledBuffer *recycled_buffer)
+{
+  return g_atomic_int_get (&recycled_buffer->is_idle);
+}
+
+static void
+prune_recycled_buffers (MetaRenderDevice *render_device,
+                        gboolean          expire)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  int n_idle = 0;
+  GList *l;
+
+  l = priv->recycled_buffers;
+  while (l)
+    {
+      MetaRecycledBuffer *recycled_buffer = l->data;
+      GList *l_next = l->next;
+
+      if (!recycled_buffer_is_idle (recycled_buffer))
+        {
+          recycled_buffer->expiring = FALSE;
+        }
+      else if (n_idle == MAX_IDLE_RECYCLED_BUFFERS ||
+               (expire && recycled_buffer->expiring))
+        {
+          priv->recycled_buffers =
+            g_list_delete_link (priv->recycled_buffers, l);
+          recycled_buffer_free (recycled_buffer);
+        }
+      else
+        {
+          if (expire)
+            recycled_buffer->expiring = TRUE;
+          n_idle++;
+        }
+
+      l = l_next;
+    }
+}
+
+static gboolean
+expire_recycled_buffers (gpointer user_data)
+{
+  MetaRenderDevice *render_device = META_RENDER_DEVICE (user_data);
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+
+  prune_recycled_buffers (render_device, TRUE);
+
+  if (!priv->recycled_buffers)
+    {
+      priv->recycled_buffers_expire_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+recycled_buffer_matches (MetaRecycledBuffer     *recycled_buffer,
+                         MetaRecycledBufferType  type,
+                         int                     width,
+                         int                     height,
+                         uint32_t                format,
+                         uint64_t               *modifiers,
+                         int                     n_modifiers,
+                         MetaDrmBufferFlags      flags)
+{
+  MetaDrmBuffer *buffer = recycled_buffer->buffer;
+  uint64_t modifier;
+  int i;
+
+  if (recycled_buffer->type != type ||
+      meta_drm_buffer_get_width (buffer) != width ||
+      meta_drm_buffer_get_height (buffer) != height ||
+      meta_drm_buffer_get_format (buffer) != format)
+    return FALSE;
+
+  if (type == META_RECYCLED_BUFFER_TYPE_DUMB)
+    return TRUE;
+
+  if (meta_drm_buffer_get_flags (buffer) != flags)
+    return FALSE;
+
+  if (n_modifiers == 0)
+    return !recycled_buffer->has_explicit_modifier;
+
+  if (!recycled_buffer->has_explicit_modifier)
+    return FALSE;
+
+  modifier = meta_drm_buffer_get_modifier (buffer);
+  for (i = 0; i < n_modifiers; i++)
+    {
+      if (modifiers[i] == modifier)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static MetaDrmBuffer *
+take_recycled_buffer (MetaRenderDevice       *render_device,
+                      MetaRecycledBufferType  type,
+                      int                     width,
+                      int                     height,
+                      uint32_t                format,
+                      uint64_t               *modifiers,
+                      int                     n_modifiers,
+                      MetaDrmBufferFlags      flags)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  GList *l;
+
+  for (l = priv->recycled_buffers; l; l = l->next)
+    {
+      MetaRecycledBuffer *recycled_buffer = l->data;
+
+      if (!recycled_buffer_is_idle (recycled_buffer))
+        continue;
+
+      if (!recycled_buffer_matches (recycled_buffer,
+                                    type,
+                                    width, height,
+                                    format,
+                                    modifiers, n_modifiers,
+                                    flags))
+        continue;
+
+      recycled_buffer->expiring = FALSE;
+
+      meta_topic (META_DEBUG_RENDER,
+                  "Recycling %dx%d buffer on %s",
+                  width, height,
+                  meta_render_device_get_name (render_device));
+
+      return g_object_ref (recycled_buffer->buffer);
+    }
+
+  return NULL;
+}
+
+static void
+track_recycled_buffer (MetaRenderDevice       *render_device,
+                       MetaDrmBuffer          *buffer,
+                       MetaRecycledBufferType  type,
+                       gboolean                has_explicit_modifier)
+{
+  MetaRenderDevicePrivate *priv =
+    meta_render_device_get_instance_private (render_device);
+  MetaRecycledBuffer *recycled_buffer;
+
+  prune_recycled_buffers (render_device, FALSE);
+
+  recycled_buffer = g_new0 (MetaRecycledBuffer, 1);
+  recycled_buffer->buffer = buffer;
+  recycled_buffer->type = type;
+  recycled_buffer->has_explicit_modifier = has_explicit_modifier;
+
+  g_object_add_toggle_ref (G_OBJECT (buffer),
+                           recycled_buffer_toggle_notify,
+                           recycled_buffer);
+  priv->recycled_buffers = g_list_prepend (priv->recycled_buffers,
+                                           recycled_buffer);
+
+  if (!priv->recycled_buffers_expire_id)
+    {
+      priv->recycled_buffers_expire_id =
+        g_timeout_add_seconds (RECYCLED_BUFFER_EXPIRE_INTERVAL_S,
+                               expire_recycled_buffers,
+                               render_device);
+    }
+}
+
 static void
 meta_render_device_dispose (GObject *object)
 {
@@ -223,6 +452,10 @@ meta_render_device_dispose (GObject *object)
     meta_render_device_get_instance_private (render_device);
   MetaEgl *egl = meta_backend_get_egl (priv->backend);
 
+  g_clear_handle_id (&priv->recycled_buffers_expire_id, g_source_remove);
+  g_clear_list (&priv->recycled_buffers,
+                (GDestroyNotify) recycled_buffer_free);
+
   if (priv->egl_display != EGL_NO_DISPLAY)
     {
       meta_egl_terminate (egl, priv->egl_display, NULL);
@@ -354,12 +587,30 @@ meta_render_device_allocate_dma_buf (MetaRenderDevice    *render_device,
 
   if (klass->allocate_dma_buf)
     {
-      return klass->allocate_dma_buf (render_device,
-                                      width, height,
-                                      format,
-                                      modifiers, n_modifiers,
-                                      flags,
-                                      error);
+      MetaDrmBuffer *buffer;
+
+      buffer = take_recycled_buffer (render_device,
+                                     META_RECYCLED_BUFFER_TYPE_DMA_BUF,
+                                     width, height,
+                                     format,
+                                     modifiers, n_modifiers,
+                                     flags);
+      if (buffer)
+        return buffer;
+
+      buffer = klass->allocate_dma_buf (render_device,
+                                        width, height,
+                                        format,
+                                        modifiers, n_modifiers,
+                                        flags,
+                                        error);
+      if (!buffer)
+        return NULL;
+
+      track_recycled_buffer (render_device, buffer,
+                             META_RECYCLED_BUFFER_TYPE_DMA_BUF,
+                             n_modifiers > 0);
+      return buffer;
     }
 
   g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
@@ -396,6 +647,7 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
   MetaRenderDevicePrivate *priv =
     meta_render_device_get_instance_private (render_device);
   MetaDrmBufferDumb *buffer_dumb;
+  MetaDrmBuffer *buffer;
 
   if (!priv->device_file)
     {
@@ -404,6 +656,15 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
       return NULL;
     }
 
+  buffer = take_recycled_buffer (render_device,
+                                 META_RECYCLED_BUFFER_TYPE_DUMB,
+                                 width, height,
+                                 format,
+                                 NULL, 0,
+                                 META_DRM_BUFFER_FLAG_NONE);
+  if (buffer)
+    return buffer;
+
   buffer_dumb = meta_drm_buffer_dumb_new (priv->device_file,
                                           width, height,
                                           format,
@@ -411,5 +672,9 @@ meta_render_device_allocate_dumb_buf (MetaRenderDevice  *render_device,
   if (!buffer_dumb)
     return NULL;
 
-  return META_DRM_BUFFER (buffer_dumb);
+  buffer = META_DRM_BUFFER (buffer_dumb);
+  track_recycled_buffer (render_device, buffer,
+                         META_RECYCLED_BUFFER_TYPE_DUMB,
+                         FALSE);
+  return buffer;
 }
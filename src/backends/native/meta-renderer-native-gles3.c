@@ -348,13 +348,14 @@ paint_egl_image (ContextData *context_data,
 }
 
 gboolean
-meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
-                                           MetaGles3      *gles3,
-                                           EGLDisplay      egl_display,
-                                           EGLContext      egl_context,
-                                           EGLSurface      egl_surface,
-                                           struct gbm_bo  *shared_bo,
-                                           GError        **error)
+meta_renderer_native_gles3_blit_shared_bo (MetaEgl         *egl,
+                                           MetaGles3       *gles3,
+                                           EGLDisplay       egl_display,
+                                           EGLContext       egl_context,
+                                           EGLSurface       egl_surface,
+                                           struct gbm_bo   *shared_bo,
+                                           const MtkRegion *region,
+                                           GError         **error)
 {
   int shared_bo_fd;
   unsigned int width;
@@ -434,10 +435,38 @@ meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
   if (!egl_image)
     return FALSE;
 
-  if (can_blit)
-    blit_egl_image (gles3, egl_image, width, height);
+  if (region)
+    {
+      int n_rects, i;
+
+      /* Both the blit and the draw respect the scissor, so limit them to
+       * each damaged rectangle in turn. */
+      GLBAS (gles3, glEnable, (GL_SCISSOR_TEST));
+
+      n_rects = mtk_region_num_rectangles (region);
+      for (i = 0; i < n_rects; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+          GLBAS (gles3, glScissor, (rect.x, height - rect.y - rect.height,
+                                    rect.width, rect.height));
+
+          if (can_blit)
+            blit_egl_image (gles3, egl_image, width, height);
+          else
+            paint_egl_image (context_data, gles3, egl_image, width, height);
+        }
+
+      GLBAS (gles3, glDisable, (GL_SCISSOR_TEST));
+    }
+  else if (can_blit)
+    {
+      blit_egl_image (gles3, egl_image, width, height);
+    }
   else
-    paint_egl_image (context_data, gles3, egl_image, width, height);
+    {
+      paint_egl_image (context_data, gles3, egl_image, width, height);
+    }
 
   meta_egl_destroy_image (egl, egl_display, egl_image, NULL);
 
@@ -26,6 +26,8 @@
 
 #include "backends/native/meta-crtc-native.h"
 #include "backends/native/meta-frame-native.h"
+#include "backends/native/meta-onscreen-native.h"
+#include "clutter/clutter-mutter.h"
 
 struct _MetaRendererViewNative
 {
@@ -63,6 +65,31 @@ meta_renderer_view_native_constructed (GObject *object)
   update_frame_clock_deadline_evasion (renderer_view);
 }
 
+static void
+meta_renderer_view_native_color_states_changed (MetaRendererView *renderer_view)
+{
+  ClutterStageView *stage_view = CLUTTER_STAGE_VIEW (renderer_view);
+  CoglFramebuffer *onscreen = clutter_stage_view_get_onscreen (stage_view);
+  gboolean use_shadowfb;
+  gboolean offloaded = FALSE;
+
+  g_object_get (stage_view, "use-shadowfb", &use_shadowfb, NULL);
+
+  /* The shadow framebuffer has the precision of the onscreen, but not its
+   * format, so it can't hold the unencoded view contents. */
+  if (META_IS_ONSCREEN_NATIVE (onscreen) && !use_shadowfb)
+    {
+      MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+
+      offloaded = meta_onscreen_native_update_color_transform (
+        onscreen_native,
+        clutter_stage_view_get_color_state (stage_view),
+        clutter_stage_view_get_output_color_state (stage_view));
+    }
+
+  clutter_stage_view_set_color_transform_offloaded (stage_view, offloaded);
+}
+
 static ClutterFrame *
 meta_renderer_view_native_new_frame (ClutterStageView *stage_view)
 {
@@ -82,9 +109,13 @@ meta_renderer_view_native_class_init (MetaRendererViewNativeClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   ClutterStageViewClass *stage_view_class = CLUTTER_STAGE_VIEW_CLASS (klass);
+  MetaRendererViewClass *renderer_view_class = META_RENDERER_VIEW_CLASS (klass);
 
   object_class->constructed = meta_renderer_view_native_constructed;
 
+  renderer_view_class->color_states_changed =
+    meta_renderer_view_native_color_states_changed;
+
   stage_view_class->new_frame = meta_renderer_view_native_new_frame;
   stage_view_class->schedule_update = meta_renderer_view_native_schedule_update;
 }
@@ -278,8 +278,7 @@ keyboard_repeat (gpointer data)
 }
 
 static void
-queue_event (MetaSeatImpl *seat_impl,
-             ClutterEvent *event)
+log_queued_event (ClutterEvent *event)
 {
 #ifdef WITH_VERBOSE_MODE
   if (meta_is_topic_enabled (META_DEBUG_INPUT_EVENTS))
@@ -292,10 +291,40 @@ queue_event (MetaSeatImpl *seat_impl,
                   event_description);
     }
 #endif
+}
+
+static void
+queue_event (MetaSeatImpl *seat_impl,
+             ClutterEvent *event)
+{
+  log_queued_event (event);
 
   _clutter_event_push (event, FALSE);
 }
 
+static void
+queue_motion_event (MetaSeatImpl *seat_impl,
+                    ClutterEvent *event)
+{
+  log_queued_event (event);
+
+  /* High polling rate devices can produce motion far faster than the main
+   * thread dispatches events, so merge it with motion that is still
+   * waiting to be dispatched. */
+  _clutter_event_push_motion (event);
+}
+
+static void
+queue_touch_update_event (MetaSeatImpl *seat_impl,
+                          ClutterEvent *event)
+{
+  log_queued_event (event);
+
+  /* Same for touch points, which multi-finger gestures update all of on
+   * every libinput frame. */
+  _clutter_event_push_touch_update (event);
+}
+
 static int
 update_button_count (MetaSeatImpl *seat_impl,
                      uint32_t      button,
@@ -326,14 +355,8 @@ meta_seat_impl_queue_main_thread_idle (MetaSeatImpl   *seat_impl,
                                        gpointer        user_data,
                                        GDestroyNotify  destroy_notify)
 {
-  GSource *source;
-
-  source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_HIGH);
-  g_source_set_callback (source, func, user_data, destroy_notify);
-
-  g_source_attach (source, seat_impl->main_context);
-  g_source_unref (source);
+  meta_callback_ring_push (seat_impl->main_thread_ring,
+                           func, user_data, destroy_notify);
 }
 
 typedef struct
@@ -739,7 +762,7 @@ meta_seat_impl_notify_relative_motion_in_impl (MetaSeatImpl       *seat_impl,
                                                    dy_constrained),
                               axes);
 
-  queue_event (seat_impl, event);
+  queue_motion_event (seat_impl, event);
 }
 
 void
@@ -1193,7 +1216,10 @@ meta_seat_impl_notify_touch_event_in_impl (MetaSeatImpl       *seat_impl,
                                  GRAPHENE_POINT_INIT ((float) x, (float) y));
     }
 
-  queue_event (seat_impl, event);
+  if (evtype == CLUTTER_TOUCH_UPDATE)
+    queue_touch_update_event (seat_impl, event);
+  else
+    queue_event (seat_impl, event);
 }
 
 void
@@ -3006,6 +3032,13 @@ meta_seat_impl_initable_init (GInitable     *initable,
   seat_impl->main_context = g_main_context_ref_thread_default ();
   g_assert (seat_impl->main_context == g_main_context_default ());
 
+  seat_impl->main_thread_ring =
+    meta_callback_ring_new (seat_impl->main_context,
+                            "[mutter] Input thread callbacks",
+                            error);
+  if (!seat_impl->main_thread_ring)
+    return FALSE;
+
   seat_impl->input_thread =
     g_thread_try_new ("Mutter Input Thread",
                       (GThreadFunc) input_thread,
@@ -3136,6 +3169,8 @@ meta_seat_impl_finalize (GObject *object)
 
   g_free (seat_impl->seat_id);
 
+  g_clear_pointer (&seat_impl->main_thread_ring, meta_callback_ring_free);
+
   g_rw_lock_clear (&seat_impl->state_lock);
 
   G_OBJECT_CLASS (meta_seat_impl_parent_class)->finalize (object);
@@ -34,6 +34,7 @@
 #include "backends/meta-viewport-info.h"
 #include "backends/native/meta-backend-native-types.h"
 #include "backends/native/meta-barrier-native.h"
+#include "backends/native/meta-callback-ring.h"
 #include "backends/native/meta-cursor-renderer-native.h"
 #include "backends/native/meta-keymap-native.h"
 #include "backends/native/meta-pointer-constraint-native.h"
@@ -58,6 +59,7 @@ struct _MetaSeatImpl
   GObject parent_instance;
 
   GMainContext *main_context;
+  MetaCallbackRing *main_thread_ring;
   GMainContext *input_context;
   GMainLoop *input_loop;
   GThread *input_thread;
@@ -29,7 +29,7 @@
 #include "backends/native/meta-seat-native.h"
 
 #include "backends/meta-cursor-tracker-private.h"
-#include "backends/meta-keymap-utils.h"
+#include "backends/meta-backend-private.h"
 #include "backends/native/meta-barrier-native.h"
 #include "backends/native/meta-input-thread.h"
 #include "backends/native/meta-keymap-native.h"
@@ -478,14 +478,15 @@ meta_seat_native_reclaim_devices (MetaSeatNative *seat)
 }
 
 static struct xkb_keymap *
-create_keymap (const char *layouts,
-               const char *variants,
-               const char *options,
-               const char *model)
-{
+create_keymap (MetaSeatNative *seat,
+               const char     *layouts,
+               const char     *variants,
+               const char     *options,
+               const char     *model)
+{
+  MetaKeymapCache *keymap_cache =
+    meta_backend_get_keymap_cache (seat->backend);
   struct xkb_rule_names names;
-  struct xkb_keymap *keymap;
-  struct xkb_context *context;
 
   names.rules = DEFAULT_XKB_RULES_FILE;
   names.model = model;
@@ -493,11 +494,7 @@ create_keymap (const char *layouts,
   names.variant = variants;
   names.options = options;
 
-  context = meta_create_xkb_context ();
-  keymap = xkb_keymap_new_from_names (context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
-  xkb_context_unref (context);
-
-  return keymap;
+  return meta_keymap_cache_get_keymap (keymap_cache, &names);
 }
 
 /**
@@ -517,10 +514,11 @@ meta_seat_native_set_keyboard_map (MetaSeatNative *seat,
                                    const char     *options,
                                    const char     *model)
 {
+  MetaKeymapCache *keymap_cache =
+    meta_backend_get_keymap_cache (seat->backend);
   struct xkb_keymap *keymap, *impl_keymap;
 
-  keymap = create_keymap (layouts, variants, options, model);
-  impl_keymap = create_keymap (layouts, variants, options, model);
+  keymap = create_keymap (seat, layouts, variants, options, model);
 
   if (keymap == NULL)
     {
@@ -530,6 +528,16 @@ meta_seat_native_set_keyboard_map (MetaSeatNative *seat,
       return;
     }
 
+  /* The input thread gets a copy of its own, as keymaps are not thread
+   * safe, but it is compiled from the serialized keymap. */
+  impl_keymap = meta_keymap_cache_compile_keymap (keymap_cache, keymap);
+  if (impl_keymap == NULL)
+    {
+      g_warning ("Unable to copy configured keymap");
+      xkb_keymap_unref (keymap);
+      return;
+    }
+
   if (seat->xkb_keymap)
     xkb_keymap_unref (seat->xkb_keymap);
   seat->xkb_keymap = keymap;
@@ -20,11 +20,15 @@
 #include "backends/native/meta-thread-private.h"
 
 #include <glib.h>
+#include <sched.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-backend-types.h"
 #include "backends/native/meta-thread-impl.h"
+#include "core/meta-debug-control-private.h"
 
 #include "meta-dbus-rtkit1.h"
 #include "meta-private-enum-types.h"
@@ -43,6 +47,46 @@ enum
 
 static GParamSpec *obj_props[N_PROPS];
 
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+#ifndef SCHED_FLAG_RESET_ON_FORK
+#define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+
+/* Matches the kernel's struct sched_attr (SCHED_ATTR_SIZE_VER0) */
+typedef struct _MetaSchedAttr
+{
+  uint32_t size;
+  uint32_t sched_policy;
+  uint64_t sched_flags;
+  int32_t sched_nice;
+  uint32_t sched_priority;
+  uint64_t sched_runtime;
+  uint64_t sched_deadline;
+  uint64_t sched_period;
+} MetaSchedAttr;
+
+typedef enum _MetaThreadSchedulingPolicy
+{
+  META_THREAD_SCHEDULING_POLICY_DEFAULT,
+  META_THREAD_SCHEDULING_POLICY_FIFO,
+  META_THREAD_SCHEDULING_POLICY_DEADLINE,
+} MetaThreadSchedulingPolicy;
+
+typedef struct _MetaThreadScheduling
+{
+  MetaThreadSchedulingPolicy policy;
+  int priority;
+  uint64_t runtime_us;
+  uint64_t deadline_us;
+  uint64_t period_us;
+
+  gboolean has_affinity;
+  cpu_set_t affinity;
+} MetaThreadScheduling;
+
 typedef struct _MetaThreadCallbackData
 {
   MetaThreadCallback callback;
@@ -89,6 +133,8 @@ typedef struct _MetaThreadPrivate
     GMutex init_mutex;
     int realtime_inhibit_count;
     gboolean is_realtime;
+    MetaThreadScheduling scheduling;
+    cpu_set_t default_affinity;
   } kernel;
 } MetaThreadPrivate;
 
@@ -235,6 +281,69 @@ ensure_realtime_kit_proxy (MetaThread  *thread,
   return TRUE;
 }
 
+static gboolean
+request_custom_scheduling (MetaThread  *thread,
+                           GError     **error)
+{
+  MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
+  MetaThreadScheduling *scheduling = &priv->kernel.scheduling;
+
+  switch (scheduling->policy)
+    {
+    case META_THREAD_SCHEDULING_POLICY_DEFAULT:
+      break;
+    case META_THREAD_SCHEDULING_POLICY_FIFO:
+      {
+        struct sched_param param = { .sched_priority = scheduling->priority };
+
+        meta_topic (META_DEBUG_BACKEND,
+                    "Setting '%s' thread to SCHED_FIFO with priority %d",
+                    priv->name, scheduling->priority);
+        if (sched_setscheduler (0, SCHED_FIFO | SCHED_RESET_ON_FORK,
+                                &param) != 0)
+          {
+            g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                         "sched_setscheduler() failed: %s",
+                         g_strerror (errno));
+            return FALSE;
+          }
+
+        return TRUE;
+      }
+    case META_THREAD_SCHEDULING_POLICY_DEADLINE:
+      {
+        MetaSchedAttr attr = {
+          .size = sizeof (MetaSchedAttr),
+          .sched_policy = SCHED_DEADLINE,
+          .sched_flags = SCHED_FLAG_RESET_ON_FORK,
+          .sched_runtime = scheduling->runtime_us * 1000,
+          .sched_deadline = scheduling->deadline_us * 1000,
+          .sched_period = scheduling->period_us * 1000,
+        };
+
+        meta_topic (META_DEBUG_BACKEND,
+                    "Setting '%s' thread to SCHED_DEADLINE with runtime %"
+                    G_GUINT64_FORMAT " us, deadline %" G_GUINT64_FORMAT
+                    " us, period %" G_GUINT64_FORMAT " us",
+                    priv->name,
+                    scheduling->runtime_us,
+                    scheduling->deadline_us,
+                    scheduling->period_us);
+        if (syscall (SYS_sched_setattr, 0, &attr, 0) != 0)
+          {
+            g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                         "sched_setattr() failed: %s",
+                         g_strerror (errno));
+            return FALSE;
+          }
+
+        return TRUE;
+      }
+    }
+
+  g_assert_not_reached ();
+}
+
 static gboolean
 request_realtime_scheduling (MetaThread  *thread,
                              GError     **error)
@@ -245,6 +354,9 @@ request_realtime_scheduling (MetaThread  *thread,
   struct rlimit rl;
   uint32_t priority;
 
+  if (priv->kernel.scheduling.policy != META_THREAD_SCHEDULING_POLICY_DEFAULT)
+    return request_custom_scheduling (thread, error);
+
   if (!ensure_realtime_kit_proxy (thread, error))
     return FALSE;
 
@@ -314,6 +426,23 @@ request_normal_scheduling (MetaThread  *thread,
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
   g_autoptr (GError) local_error = NULL;
 
+  if (priv->kernel.scheduling.policy != META_THREAD_SCHEDULING_POLICY_DEFAULT)
+    {
+      struct sched_param param = { 0 };
+
+      meta_topic (META_DEBUG_BACKEND, "Setting '%s' thread to SCHED_OTHER",
+                  priv->name);
+      if (sched_setscheduler (0, SCHED_OTHER, &param) != 0)
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                       "sched_setscheduler() failed: %s",
+                       g_strerror (errno));
+          return FALSE;
+        }
+
+      return TRUE;
+    }
+
   if (!ensure_realtime_kit_proxy (thread, error))
     return FALSE;
 
@@ -342,7 +471,9 @@ can_use_realtime_scheduling_in_impl (MetaThread *thread)
     case META_THREAD_TYPE_USER:
       return FALSE;
     case META_THREAD_TYPE_KERNEL:
-      return priv->wants_realtime;
+      return (priv->wants_realtime ||
+              priv->kernel.scheduling.policy !=
+              META_THREAD_SCHEDULING_POLICY_DEFAULT);
     }
 
   g_assert_not_reached ();
@@ -397,6 +528,185 @@ sync_realtime_scheduling_in_impl (MetaThread *thread)
     }
 }
 
+static gboolean
+scheduling_policy_equal (const MetaThreadScheduling *scheduling,
+                         const MetaThreadScheduling *other_scheduling)
+{
+  return (scheduling->policy == other_scheduling->policy &&
+          scheduling->priority == other_scheduling->priority &&
+          scheduling->runtime_us == other_scheduling->runtime_us &&
+          scheduling->deadline_us == other_scheduling->deadline_us &&
+          scheduling->period_us == other_scheduling->period_us);
+}
+
+static gpointer
+update_scheduling_in_impl (MetaThreadImpl  *thread_impl,
+                           gpointer         user_data,
+                           GError         **error)
+{
+  MetaThread *thread = meta_thread_impl_get_thread (thread_impl);
+  MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
+  MetaThreadScheduling *scheduling = user_data;
+  const cpu_set_t *affinity;
+
+  if (priv->kernel.is_realtime &&
+      !scheduling_policy_equal (&priv->kernel.scheduling, scheduling))
+    {
+      g_autoptr (GError) local_error = NULL;
+
+      if (!request_normal_scheduling (thread, &local_error))
+        {
+          g_warning ("Failed to make thread '%s' normally scheduled: %s",
+                     priv->name, local_error->message);
+        }
+      else
+        {
+          priv->kernel.is_realtime = FALSE;
+        }
+    }
+
+  priv->kernel.scheduling = *scheduling;
+
+  if (scheduling->has_affinity)
+    affinity = &scheduling->affinity;
+  else
+    affinity = &priv->kernel.default_affinity;
+
+  if (CPU_COUNT (affinity) > 0 &&
+      sched_setaffinity (0, sizeof (cpu_set_t), affinity) != 0)
+    {
+      g_warning ("Failed to set CPU affinity of thread '%s': %s",
+                 priv->name, g_strerror (errno));
+    }
+
+  sync_realtime_scheduling_in_impl (thread);
+
+  return NULL;
+}
+
+static gboolean
+parse_thread_scheduling (GVariant              *options,
+                         MetaThreadScheduling  *scheduling,
+                         GError               **error)
+{
+  g_autoptr (GVariant) affinity = NULL;
+  const char *policy = NULL;
+
+  *scheduling = (MetaThreadScheduling) { 0 };
+
+  if (!options)
+    return TRUE;
+
+  g_variant_lookup (options, "policy", "&s", &policy);
+  if (!policy || g_str_equal (policy, "other"))
+    {
+      scheduling->policy = META_THREAD_SCHEDULING_POLICY_DEFAULT;
+    }
+  else if (g_str_equal (policy, "fifo"))
+    {
+      scheduling->policy = META_THREAD_SCHEDULING_POLICY_FIFO;
+    }
+  else if (g_str_equal (policy, "deadline"))
+    {
+      scheduling->policy = META_THREAD_SCHEDULING_POLICY_DEADLINE;
+    }
+  else
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Unknown scheduling policy '%s'", policy);
+      return FALSE;
+    }
+
+  g_variant_lookup (options, "priority", "i", &scheduling->priority);
+  g_variant_lookup (options, "runtime-us", "t", &scheduling->runtime_us);
+  g_variant_lookup (options, "deadline-us", "t", &scheduling->deadline_us);
+  g_variant_lookup (options, "period-us", "t", &scheduling->period_us);
+
+  affinity = g_variant_lookup_value (options, "affinity",
+                                     G_VARIANT_TYPE ("au"));
+  if (affinity)
+    {
+      const uint32_t *cpus;
+      size_t n_cpus;
+      size_t i;
+
+      cpus = g_variant_get_fixed_array (affinity, &n_cpus, sizeof (uint32_t));
+      for (i = 0; i < n_cpus; i++)
+        {
+          if (cpus[i] >= CPU_SETSIZE)
+            {
+              g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                           "Invalid CPU %u in affinity mask", cpus[i]);
+              return FALSE;
+            }
+
+          CPU_SET (cpus[i], &scheduling->affinity);
+        }
+
+      scheduling->has_affinity = n_cpus > 0;
+    }
+
+  switch (scheduling->policy)
+    {
+    case META_THREAD_SCHEDULING_POLICY_DEFAULT:
+      break;
+    case META_THREAD_SCHEDULING_POLICY_FIFO:
+      if (scheduling->priority < sched_get_priority_min (SCHED_FIFO) ||
+          scheduling->priority > sched_get_priority_max (SCHED_FIFO))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                       "Invalid SCHED_FIFO priority %d",
+                       scheduling->priority);
+          return FALSE;
+        }
+      break;
+    case META_THREAD_SCHEDULING_POLICY_DEADLINE:
+      if (scheduling->deadline_us == 0)
+        scheduling->deadline_us = scheduling->period_us;
+      if (scheduling->period_us == 0)
+        scheduling->period_us = scheduling->deadline_us;
+
+      if (scheduling->runtime_us == 0 ||
+          scheduling->runtime_us > scheduling->deadline_us ||
+          scheduling->deadline_us > scheduling->period_us)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                       "SCHED_DEADLINE requires 0 < runtime <= deadline <= period");
+          return FALSE;
+        }
+      break;
+    }
+
+  return TRUE;
+}
+
+static void
+update_thread_scheduling (MetaThread *thread)
+{
+  MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
+  MetaContext *context = meta_backend_get_context (priv->backend);
+  MetaDebugControl *debug_control = meta_context_get_debug_control (context);
+  g_autoptr (GVariant) options = NULL;
+  g_autofree MetaThreadScheduling *scheduling = NULL;
+  g_autoptr (GError) error = NULL;
+
+  options = meta_debug_control_get_thread_scheduling (debug_control,
+                                                      priv->name);
+
+  scheduling = g_new0 (MetaThreadScheduling, 1);
+  if (!parse_thread_scheduling (options, scheduling, &error))
+    {
+      g_warning ("Invalid scheduling options for thread '%s': %s",
+                 priv->name, error->message);
+      return;
+    }
+
+  meta_thread_post_impl_task (thread,
+                              update_scheduling_in_impl,
+                              g_steal_pointer (&scheduling), g_free,
+                              NULL, NULL);
+}
+
 static gpointer
 thread_impl_func (gpointer user_data)
 {
@@ -423,6 +733,14 @@ thread_impl_func (gpointer user_data)
   priv->kernel.realtime_inhibit_count = 0;
   priv->kernel.is_realtime = FALSE;
 
+  if (sched_getaffinity (0, sizeof (cpu_set_t),
+                         &priv->kernel.default_affinity) != 0)
+    {
+      g_warning ("Failed to get CPU affinity of thread '%s': %s",
+                 priv->name, g_strerror (errno));
+      CPU_ZERO (&priv->kernel.default_affinity);
+    }
+
   meta_thread_impl_setup (impl);
 
   sync_realtime_scheduling_in_impl (thread);
@@ -634,6 +952,24 @@ meta_thread_initable_init (GInitable     *initable,
 
   start_thread (thread);
 
+  if (priv->thread_type == META_THREAD_TYPE_KERNEL)
+    {
+      MetaContext *context = meta_backend_get_context (priv->backend);
+      MetaDebugControl *debug_control =
+        meta_context_get_debug_control (context);
+      g_autoptr (GVariant) options = NULL;
+
+      g_signal_connect_object (debug_control, "notify::thread-scheduling",
+                               G_CALLBACK (update_thread_scheduling),
+                               thread,
+                               G_CONNECT_SWAPPED);
+
+      options = meta_debug_control_get_thread_scheduling (debug_control,
+                                                          priv->name);
+      if (options)
+        update_thread_scheduling (thread);
+    }
+
   return TRUE;
 }
 
@@ -212,6 +212,40 @@ meta_drm_timeline_get_eventfd (MetaDrmTimeline *timeline,
   return g_steal_fd (&fd);
 }
 
+int
+meta_drm_timeline_export_sync_file (MetaDrmTimeline *timeline,
+                                    uint64_t         sync_point,
+                                    GError         **error)
+{
+  uint32_t tmp;
+  int sync_fd = -1;
+
+  if (drmSyncobjCreate (timeline->drm, 0, &tmp) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_SUPPORTED,
+                   "Failed to create temporary syncobj");
+      return -1;
+    }
+
+  /* This fails if no fence was submitted for the point yet */
+  if (drmSyncobjTransfer (timeline->drm, tmp, 0,
+                          timeline->drm_syncobj, sync_point, 0) != 0 ||
+      drmSyncobjExportSyncFile (timeline->drm, tmp, &sync_fd) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to export syncfd at specified point: %s",
+                   g_strerror (errno));
+      sync_fd = -1;
+    }
+
+  drmSyncobjDestroy (timeline->drm, tmp);
+  return sync_fd;
+}
+
 gboolean
 meta_drm_timeline_set_sync_point (MetaDrmTimeline *timeline,
                                   uint64_t         sync_point,
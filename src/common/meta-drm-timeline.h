@@ -41,6 +41,10 @@ int meta_drm_timeline_get_eventfd (MetaDrmTimeline *timeline,
                                    uint64_t         sync_point,
                                    GError         **error);
 
+int meta_drm_timeline_export_sync_file (MetaDrmTimeline *timeline,
+                                        uint64_t         sync_point,
+                                        GError         **error);
+
 gboolean meta_drm_timeline_set_sync_point (MetaDrmTimeline *timeline,
                                            uint64_t         sync_point,
                                            int              sync_fd,
@@ -54,12 +54,15 @@
 
 #include "compositor/compositor-private.h"
 
+#include "backends/meta-backend-private.h"
+#include "backends/meta-idle-manager.h"
 #include "clutter/clutter-mutter.h"
 #include "cogl/cogl.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-later-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "compositor/meta-window-group-private.h"
+#include "core/meta-debug-control-private.h"
 #include "core/util-private.h"
 #include "core/window-private.h"
 #include "meta/compositor-mutter.h"
@@ -68,8 +71,10 @@
 #include "meta/meta-background-actor.h"
 #include "meta/meta-background-group.h"
 #include "meta/meta-context.h"
+#include "meta/meta-workspace-manager.h"
 #include "meta/prefs.h"
 #include "meta/window.h"
+#include "meta/workspace.h"
 
 #ifdef HAVE_WAYLAND
 #include "compositor/meta-window-actor-wayland.h"
@@ -85,9 +90,14 @@
 
 #include "compositor/meta-window-actor-x11.h"
 
+#include "x11/meta-shadow-factory.h"
 #include "x11/meta-x11-display-private.h"
 #endif
 
+/* How often windows on workspaces next to the active one get the damage
+ * deferred while they are hidden uploaded */
+#define WORKSPACE_PREWARM_INTERVAL_MS 1000
+
 enum
 {
   PROP_0,
@@ -137,11 +147,24 @@ typedef struct _MetaCompositorPrivate
 
   gboolean frame_in_progress;
 
+  gboolean graphics_reset;
+
+  guint workspace_prewarm_id;
+
   MetaPluginManager *plugin_mgr;
 
   MetaWindowDrag *current_drag;
 
   MetaLaters *laters;
+
+  unsigned int texture_trimmer_id;
+#ifdef HAVE_X11_CLIENT
+  unsigned int shadow_trimmer_id;
+#endif
+
+  unsigned int idle_compaction_watch_id;
+  unsigned int idle_compaction_wake_watch_id;
+  gulong power_save_mode_changed_id;
 } MetaCompositorPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (MetaCompositor, meta_compositor,
@@ -161,6 +184,69 @@ on_top_window_actor_destroyed (MetaWindowActor *window_actor,
 
 static void sync_actor_stacking (MetaCompositor *compositor);
 
+#ifdef HAVE_WAYLAND
+static gboolean
+prewarm_adjacent_workspaces (gpointer user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaWorkspaceManager *workspace_manager =
+    meta_display_get_workspace_manager (priv->display);
+  int active_index;
+  GList *l;
+
+  if (!workspace_manager ||
+      meta_workspace_manager_get_n_workspaces (workspace_manager) < 2)
+    return G_SOURCE_CONTINUE;
+
+  active_index =
+    meta_workspace_manager_get_active_workspace_index (workspace_manager);
+
+  for (l = priv->windows; l; l = l->next)
+    {
+      MetaWindowActor *window_actor = l->data;
+      MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+      MetaWorkspace *workspace;
+      int index;
+
+      if (!META_IS_WINDOW_ACTOR_WAYLAND (window_actor) || !window->hidden)
+        continue;
+
+      workspace = meta_window_get_workspace (window);
+      if (!workspace)
+        continue;
+
+      index = meta_workspace_index (workspace);
+      if (ABS (index - active_index) != 1)
+        continue;
+
+      meta_window_actor_wayland_prewarm (META_WINDOW_ACTOR_WAYLAND (window_actor));
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+ensure_workspace_prewarm (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  if (priv->workspace_prewarm_id || !meta_is_wayland_compositor ())
+    return;
+
+  priv->workspace_prewarm_id =
+    g_timeout_add_full (G_PRIORITY_LOW,
+                        WORKSPACE_PREWARM_INTERVAL_MS,
+                        prewarm_adjacent_workspaces,
+                        compositor,
+                        NULL);
+  g_source_set_name_by_id (priv->workspace_prewarm_id,
+                           "[mutter] Workspace prewarm");
+}
+#endif
+
 static void
 meta_finish_workspace_switch (MetaCompositor *compositor)
 {
@@ -174,6 +260,11 @@ meta_finish_workspace_switch (MetaCompositor *compositor)
 
   /* Fix up stacking order. */
   sync_actor_stacking (compositor);
+
+#ifdef HAVE_WAYLAND
+  /* The workspaces next to the new one are the likely next targets */
+  ensure_workspace_prewarm (compositor);
+#endif
 }
 
 void
@@ -924,9 +1015,24 @@ on_presented (ClutterStage     *stage,
 {
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
+  MetaContext *context = meta_backend_get_context (priv->backend);
+  MetaDebugControl *debug_control = meta_context_get_debug_control (context);
   int64_t presentation_time = frame_info->presentation_time;
   GList *l;
 
+  if (meta_debug_control_is_frame_latency_tracing_enabled (debug_control))
+    {
+      const ClutterFrameLatency *latency;
+
+      latency = clutter_stage_view_peek_frame_latency (stage_view);
+      if (latency && latency->input_time_us)
+        {
+          meta_debug_control_emit_frame_latency (debug_control,
+                                                 clutter_stage_view_get_name (stage_view),
+                                                 latency);
+        }
+    }
+
   for (l = priv->windows; l; l = l->next)
     {
       ClutterActor *actor = l->data;
@@ -1023,10 +1129,28 @@ meta_compositor_real_after_paint (MetaCompositor     *compositor,
          should destroy the old context and create a new one. Since we
          don't have the necessary plumbing to do this we'll simply
          restart the process. Obviously we can't do this when we are
-         a wayland compositor but in that case we shouldn't get here
-         since we don't enable robustness in that case. */
-      g_assert (!meta_is_wayland_compositor ());
-      meta_restart (NULL, meta_display_get_context (priv->display));
+         a wayland compositor, in which case we exit with an error
+         instead of aborting, so that the session can be brought back
+         by whoever started us. */
+      if (priv->graphics_reset)
+        break;
+
+      priv->graphics_reset = TRUE;
+
+      if (meta_is_wayland_compositor ())
+        {
+          GError *error;
+
+          g_warning ("GPU reset detected (status %d), exiting", status);
+          error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED,
+                               "The graphics context was lost in a GPU reset");
+          meta_context_terminate_with_error (meta_display_get_context (priv->display),
+                                             error);
+        }
+      else
+        {
+          meta_restart (NULL, meta_display_get_context (priv->display));
+        }
       break;
     }
 
@@ -1159,6 +1283,149 @@ meta_compositor_init (MetaCompositor *compositor)
   invalidate_top_window_actor_for_views (compositor);
 }
 
+static void
+on_texture_memory_budget_changed (MetaDebugControl *debug_control,
+                                  GParamSpec       *pspec,
+                                  MetaCompositor   *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  uint64_t budget;
+
+  budget = meta_debug_control_get_texture_memory_budget (debug_control);
+  cogl_context_set_texture_memory_budget (priv->context, (size_t) budget);
+}
+
+#ifdef HAVE_X11_CLIENT
+static void
+on_shadow_cache_budget_changed (MetaDebugControl *debug_control,
+                                GParamSpec       *pspec,
+                                MetaCompositor   *compositor)
+{
+  uint64_t budget;
+
+  budget = meta_debug_control_get_shadow_cache_budget (debug_control);
+  meta_shadow_factory_set_cache_budget (meta_shadow_factory_get_default (),
+                                        (size_t) budget);
+}
+#endif
+
+static MetaIdleMonitor *
+get_core_idle_monitor (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaIdleManager *idle_manager =
+    meta_backend_get_idle_manager (priv->backend);
+
+  return meta_idle_manager_get_core_monitor (idle_manager);
+}
+
+static void
+on_user_active_after_compaction (MetaIdleMonitor *monitor,
+                                 guint            watch_id,
+                                 gpointer         user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterActor *stage = meta_backend_get_stage (priv->backend);
+
+  priv->idle_compaction_wake_watch_id = 0;
+
+  /* Re-create what the visible actors need with the next frame, rather
+   * than with whichever frame first happens to damage them */
+  clutter_actor_queue_redraw (stage);
+}
+
+static void
+compact_resources (MetaCompositor *compositor,
+                   const char     *reason)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaMemoryPressure *memory_pressure =
+    meta_backend_get_memory_pressure (priv->backend);
+  size_t n_bytes;
+
+  if (priv->idle_compaction_wake_watch_id)
+    return;
+
+  n_bytes = meta_memory_pressure_trim (memory_pressure, NULL);
+
+  meta_topic (META_DEBUG_RENDER,
+              "Freed %zu bytes of re-creatable resources (%s)",
+              n_bytes, reason);
+
+  priv->idle_compaction_wake_watch_id =
+    meta_idle_monitor_add_user_active_watch (get_core_idle_monitor (compositor),
+                                             on_user_active_after_compaction,
+                                             compositor,
+                                             NULL);
+}
+
+static void
+on_idle_compaction_timeout (MetaIdleMonitor *monitor,
+                            guint            watch_id,
+                            gpointer         user_data)
+{
+  MetaCompositor *compositor = user_data;
+
+  compact_resources (compositor, "idle");
+}
+
+static void
+on_power_save_mode_changed (MetaMonitorManager        *monitor_manager,
+                            MetaPowerSaveChangeReason  reason,
+                            MetaCompositor            *compositor)
+{
+  if (meta_prefs_get_idle_compaction_timeout () == 0)
+    return;
+
+  if (meta_monitor_manager_get_power_save_mode (monitor_manager) ==
+      META_POWER_SAVE_ON)
+    return;
+
+  compact_resources (compositor, "power save");
+}
+
+static void
+update_idle_compaction_watch (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaIdleMonitor *core_monitor = get_core_idle_monitor (compositor);
+  unsigned int timeout_s;
+
+  if (priv->idle_compaction_watch_id)
+    {
+      meta_idle_monitor_remove_watch (core_monitor,
+                                      priv->idle_compaction_watch_id);
+      priv->idle_compaction_watch_id = 0;
+    }
+
+  timeout_s = meta_prefs_get_idle_compaction_timeout ();
+  if (timeout_s == 0)
+    return;
+
+  priv->idle_compaction_watch_id =
+    meta_idle_monitor_add_idle_watch (core_monitor,
+                                      (uint64_t) timeout_s * 1000,
+                                      on_idle_compaction_timeout,
+                                      compositor,
+                                      NULL);
+}
+
+static void
+prefs_changed_callback (MetaPreference  pref,
+                        gpointer        user_data)
+{
+  MetaCompositor *compositor = user_data;
+
+  if (pref == META_PREF_IDLE_COMPACTION_TIMEOUT)
+    update_idle_compaction_watch (compositor);
+}
+
 static void
 meta_compositor_constructed (GObject *object)
 {
@@ -1170,9 +1437,38 @@ meta_compositor_constructed (GObject *object)
   ClutterActor *stage = meta_backend_get_stage (priv->backend);
   MetaMonitorManager *monitor_manager =
     meta_backend_get_monitor_manager (priv->backend);
+  MetaContext *context = meta_backend_get_context (priv->backend);
+  MetaDebugControl *debug_control = meta_context_get_debug_control (context);
+  MetaMemoryPressure *memory_pressure =
+    meta_backend_get_memory_pressure (priv->backend);
 
   priv->context = clutter_backend->cogl_context;
 
+  g_signal_connect_object (debug_control, "notify::texture-memory-budget",
+                           G_CALLBACK (on_texture_memory_budget_changed),
+                           compositor, 0);
+  on_texture_memory_budget_changed (debug_control, NULL, compositor);
+
+#ifdef HAVE_X11_CLIENT
+  g_signal_connect_object (debug_control, "notify::shadow-cache-budget",
+                           G_CALLBACK (on_shadow_cache_budget_changed),
+                           compositor, 0);
+  on_shadow_cache_budget_changed (debug_control, NULL, compositor);
+#endif
+
+  priv->texture_trimmer_id =
+    meta_memory_pressure_add_trimmer (memory_pressure,
+                                      "textures",
+                                      (MetaMemoryTrimFunc) cogl_context_evict_textures,
+                                      priv->context);
+#ifdef HAVE_X11_CLIENT
+  priv->shadow_trimmer_id =
+    meta_memory_pressure_add_trimmer (memory_pressure,
+                                      "shadows",
+                                      (MetaMemoryTrimFunc) meta_shadow_factory_purge_unused,
+                                      meta_shadow_factory_get_default ());
+#endif
+
   priv->before_paint_handler_id =
     g_signal_connect (stage,
                       "before-paint",
@@ -1196,6 +1492,15 @@ meta_compositor_constructed (GObject *object)
                       G_CALLBACK (on_monitors_changed_internal),
                       compositor);
 
+  priv->power_save_mode_changed_id =
+    g_signal_connect (monitor_manager,
+                      "power-save-mode-changed",
+                      G_CALLBACK (on_power_save_mode_changed),
+                      compositor);
+
+  meta_prefs_add_listener (prefs_changed_callback, compositor);
+  update_idle_compaction_watch (compositor);
+
   priv->laters = meta_laters_new (compositor);
 
   G_OBJECT_CLASS (meta_compositor_parent_class)->constructed (object);
@@ -1210,13 +1515,49 @@ meta_compositor_dispose (GObject *object)
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
   ClutterActor *stage = meta_backend_get_stage (priv->backend);
+  MetaMemoryPressure *memory_pressure =
+    meta_backend_get_memory_pressure (priv->backend);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (priv->backend);
+  MetaIdleMonitor *core_monitor = get_core_idle_monitor (compositor);
 
   g_clear_object (&priv->laters);
 
+  meta_prefs_remove_listener (prefs_changed_callback, compositor);
+  g_clear_signal_handler (&priv->power_save_mode_changed_id, monitor_manager);
+  if (priv->idle_compaction_watch_id)
+    {
+      meta_idle_monitor_remove_watch (core_monitor,
+                                      priv->idle_compaction_watch_id);
+      priv->idle_compaction_watch_id = 0;
+    }
+  if (priv->idle_compaction_wake_watch_id)
+    {
+      meta_idle_monitor_remove_watch (core_monitor,
+                                      priv->idle_compaction_wake_watch_id);
+      priv->idle_compaction_wake_watch_id = 0;
+    }
+
+  if (priv->texture_trimmer_id)
+    {
+      meta_memory_pressure_remove_trimmer (memory_pressure,
+                                           priv->texture_trimmer_id);
+      priv->texture_trimmer_id = 0;
+    }
+#ifdef HAVE_X11_CLIENT
+  if (priv->shadow_trimmer_id)
+    {
+      meta_memory_pressure_remove_trimmer (memory_pressure,
+                                           priv->shadow_trimmer_id);
+      priv->shadow_trimmer_id = 0;
+    }
+#endif
+
   g_clear_signal_handler (&priv->stage_presented_id, stage);
   g_clear_signal_handler (&priv->before_paint_handler_id, stage);
   g_clear_signal_handler (&priv->after_paint_handler_id, stage);
   g_clear_signal_handler (&priv->window_visibility_updated_id, priv->display);
+  g_clear_handle_id (&priv->workspace_prewarm_id, g_source_remove);
 
   g_clear_pointer (&priv->windows, g_list_free);
 
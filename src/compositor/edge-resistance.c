@@ -242,12 +242,19 @@ find_nearest_position (const GArray       *edges,
         }
     }
 
-  /* Now start searching higher than mid */
+  /* Now start searching higher than mid. The edges are sorted by position,
+   * so once past position by more than the best distance found so far, none
+   * of the remaining edges can be any closer; stop there rather than walking
+   * past every edge that doesn't align.
+   */
   for (i = mid + 1; i < (int)edges->len; i++)
     {
       edge = g_array_index (edges, MetaEdge*, i);
       compare = horizontal ? edge->rect.x : edge->rect.y;
 
+      if (compare >= position && compare - position >= best_dist)
+        break;
+
       edges_align = horizontal ?
                     mtk_rectangle_vert_overlap (&edge->rect, new_rect) :
                     mtk_rectangle_horiz_overlap (&edge->rect, new_rect);
@@ -272,6 +279,9 @@ find_nearest_position (const GArray       *edges,
       edge = g_array_index (edges, MetaEdge*, i);
       compare = horizontal ? edge->rect.x : edge->rect.y;
 
+      if (compare <= position && position - compare >= best_dist)
+        break;
+
       edges_align = horizontal ?
                     mtk_rectangle_vert_overlap (&edge->rect, new_rect) :
                     mtk_rectangle_horiz_overlap (&edge->rect, new_rect);
@@ -221,6 +221,9 @@ struct _MetaBackgroundContent
   double vignette_brightness;
   double vignette_sharpness;
 
+  int blur_radius;
+  double blur_brightness;
+
   gboolean has_rounded_clip;
   float rounded_clip_radius;
   gboolean rounded_clip_bounds_set;
@@ -257,6 +260,8 @@ enum
   PROP_VIGNETTE_SHARPNESS,
   PROP_VIGNETTE_BRIGHTNESS,
   PROP_ROUNDED_CLIP_RADIUS,
+  PROP_BLUR_RADIUS,
+  PROP_BLUR_BRIGHTNESS,
   N_PROPS,
 };
 
@@ -426,10 +431,14 @@ setup_pipeline (MetaBackgroundContent *self,
   if (self->changed & CHANGED_BACKGROUND)
     {
       CoglPipelineWrapMode wrap_mode;
-      CoglTexture *texture = meta_background_get_texture (self->background,
-                                                          self->monitor,
-                                                          &self->texture_area,
-                                                          &wrap_mode);
+      CoglTexture *texture;
+
+      texture = meta_background_get_blurred_texture (self->background,
+                                                     self->monitor,
+                                                     self->blur_radius,
+                                                     (float) self->blur_brightness,
+                                                     &self->texture_area,
+                                                     &wrap_mode);
 
       if (texture)
         {
@@ -895,6 +904,16 @@ meta_background_content_set_property (GObject      *object,
       meta_background_content_set_rounded_clip_radius (self,
                                                        g_value_get_float (value));
       break;
+    case PROP_BLUR_RADIUS:
+      meta_background_content_set_blur (self,
+                                        g_value_get_int (value),
+                                        self->blur_brightness);
+      break;
+    case PROP_BLUR_BRIGHTNESS:
+      meta_background_content_set_blur (self,
+                                        self->blur_radius,
+                                        g_value_get_double (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -941,6 +960,12 @@ meta_background_content_get_property (GObject      *object,
     case PROP_ROUNDED_CLIP_RADIUS:
       g_value_set_float (value, self->rounded_clip_radius);
       break;
+    case PROP_BLUR_RADIUS:
+      g_value_set_int (value, self->blur_radius);
+      break;
+    case PROP_BLUR_BRIGHTNESS:
+      g_value_set_double (value, self->blur_brightness);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1008,6 +1033,20 @@ meta_background_content_class_init (MetaBackgroundContentClass *klass)
                         G_PARAM_STATIC_STRINGS |
                         G_PARAM_EXPLICIT_NOTIFY);
 
+  properties[PROP_BLUR_RADIUS] =
+    g_param_spec_int ("blur-radius", NULL, NULL,
+                      0, G_MAXINT, 0,
+                      G_PARAM_READWRITE |
+                      G_PARAM_STATIC_STRINGS |
+                      G_PARAM_EXPLICIT_NOTIFY);
+
+  properties[PROP_BLUR_BRIGHTNESS] =
+    g_param_spec_double ("blur-brightness", NULL, NULL,
+                         0.0, 1.0, 1.0,
+                         G_PARAM_READWRITE |
+                         G_PARAM_STATIC_STRINGS |
+                         G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
@@ -1024,6 +1063,9 @@ meta_background_content_init (MetaBackgroundContent *self)
 
   self->has_rounded_clip = FALSE;
   self->rounded_clip_radius = 0.0;
+
+  self->blur_radius = 0;
+  self->blur_brightness = 1.0;
 }
 
 /**
@@ -1173,6 +1215,48 @@ meta_background_content_set_rounded_clip_radius (MetaBackgroundContent *self,
     }
 }
 
+/**
+ * meta_background_content_set_blur:
+ * @self: The #MetaBackgroundContent
+ * @radius: The blur radius in logical pixels, or 0 to not blur
+ * @brightness: The brightness of the blurred background, from 0 to 1
+ *
+ * Paints a blurred and dimmed version of the background. The blurred
+ * background is rendered once and cached by the #MetaBackground, so it is
+ * not blurred again on every paint.
+ */
+void
+meta_background_content_set_blur (MetaBackgroundContent *self,
+                                  int                    radius,
+                                  double                 brightness)
+{
+  g_return_if_fail (META_IS_BACKGROUND_CONTENT (self));
+  g_return_if_fail (radius >= 0);
+  g_return_if_fail (brightness >= 0. && brightness <= 1.);
+
+  if (radius == self->blur_radius && brightness == self->blur_brightness)
+    return;
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  if (radius != self->blur_radius)
+    {
+      self->blur_radius = radius;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BLUR_RADIUS]);
+    }
+
+  if (brightness != self->blur_brightness)
+    {
+      self->blur_brightness = brightness;
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_BLUR_BRIGHTNESS]);
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
+
+  invalidate_pipeline (self, CHANGED_BACKGROUND);
+  clutter_content_invalidate (CLUTTER_CONTENT (self));
+}
+
 /**
  * meta_background_content_set_rounded_clip_bounds:
  * @self: The #MetaBackgroundContent
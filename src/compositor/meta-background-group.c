@@ -16,6 +16,7 @@
 
 #include "config.h"
 
+#include "clutter/clutter-mutter.h"
 #include "compositor/meta-cullable.h"
 #include "meta/meta-background-group.h"
 
@@ -24,9 +25,35 @@ static void cullable_iface_init (MetaCullableInterface *iface);
 G_DEFINE_TYPE_WITH_CODE (MetaBackgroundGroup, meta_background_group, CLUTTER_TYPE_ACTOR,
                          G_IMPLEMENT_INTERFACE (META_TYPE_CULLABLE, cullable_iface_init));
 
+static void
+meta_background_group_paint (ClutterActor        *actor,
+                             ClutterPaintContext *paint_context)
+{
+  ClutterActorClass *parent_actor_class =
+    CLUTTER_ACTOR_CLASS (meta_background_group_parent_class);
+  ClutterStageView *view = clutter_paint_context_get_stage_view (paint_context);
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+
+  if (view)
+    clutter_stage_view_begin_gpu_phase (view,
+                                        CLUTTER_GPU_PHASE_BACKGROUND,
+                                        framebuffer);
+
+  parent_actor_class->paint (actor, paint_context);
+
+  if (view)
+    clutter_stage_view_end_gpu_phase (view,
+                                      CLUTTER_GPU_PHASE_BACKGROUND,
+                                      framebuffer);
+}
+
 static void
 meta_background_group_class_init (MetaBackgroundGroupClass *klass)
 {
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = meta_background_group_paint;
 }
 
 static void
@@ -60,9 +87,9 @@ meta_background_group_new (void)
 {
   MetaBackgroundGroup *background_group;
 
-  background_group = g_object_new (META_TYPE_BACKGROUND_GROUP,
-                                   "accessible-name", "Background group",
-                                   NULL);
+  background_group = g_object_new (META_TYPE_BACKGROUND_GROUP,
+                                   "accessible-name", "Background group",
+                                   NULL);
 
   return CLUTTER_ACTOR (background_group);
 }
@@ -30,6 +30,13 @@
 #include "clutter/clutter.h"
 #include "compositor/cogl-utils.h"
 
+/*
+ * Large images are uploaded a band of rows at a time, one band per main
+ * loop iteration, so that no single frame has to wait for the whole
+ * transfer.
+ */
+#define UPLOAD_BAND_SIZE (8 * 1024 * 1024)
+
 enum
 {
   LOADED,
@@ -66,6 +73,13 @@ struct _MetaBackgroundImage
   gboolean in_cache;
   gboolean loaded;
   CoglTexture *texture;
+
+  struct {
+    GdkPixbuf *pixbuf;
+    CoglTexture *texture;
+    int next_row;
+    guint idle_id;
+  } upload;
 };
 
 G_DEFINE_TYPE (MetaBackgroundImageCache, meta_background_image_cache, G_TYPE_OBJECT);
@@ -119,6 +133,37 @@ meta_background_image_cache_get_default (void)
   return cache;
 }
 
+static void
+premultiply_pixbuf (GdkPixbuf *pixbuf)
+{
+  int width = gdk_pixbuf_get_width (pixbuf);
+  int height = gdk_pixbuf_get_height (pixbuf);
+  int row_stride = gdk_pixbuf_get_rowstride (pixbuf);
+  guchar *pixels = gdk_pixbuf_get_pixels (pixbuf);
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      guchar *p = pixels + y * row_stride;
+
+      for (x = 0; x < width; x++, p += 4)
+        {
+          unsigned int alpha = p[3];
+          unsigned int t;
+          int i;
+
+          if (alpha == 255)
+            continue;
+
+          for (i = 0; i < 3; i++)
+            {
+              t = p[i] * alpha + 128;
+              p[i] = ((t >> 8) + t) >> 8;
+            }
+        }
+    }
+}
+
 static void
 load_file (GTask               *task,
            MetaBackgroundImage *image,
@@ -126,7 +171,7 @@ load_file (GTask               *task,
            GCancellable        *cancellable)
 {
   GError *error = NULL;
-  GdkPixbuf *pixbuf;
+  GdkPixbuf *pixbuf, *rotated;
   GFileInputStream *stream;
 
   stream = g_file_read (image->file, NULL, &error);
@@ -149,9 +194,74 @@ load_file (GTask               *task,
       return;
     }
 
+  rotated = gdk_pixbuf_apply_embedded_orientation (pixbuf);
+  if (rotated != NULL)
+    {
+      g_object_unref (pixbuf);
+      pixbuf = rotated;
+    }
+
+  /* Textures with alpha are stored premultiplied; doing the conversion here
+   * leaves the upload without any per-pixel work on the main thread.
+   */
+  if (gdk_pixbuf_get_has_alpha (pixbuf))
+    premultiply_pixbuf (pixbuf);
+
   g_task_return_pointer (task, pixbuf, (GDestroyNotify) g_object_unref);
 }
 
+static void
+finish_loading (MetaBackgroundImage *image)
+{
+  image->loaded = TRUE;
+  g_signal_emit (image, signals[LOADED], 0);
+}
+
+static gboolean
+upload_band (gpointer user_data)
+{
+  MetaBackgroundImage *image = META_BACKGROUND_IMAGE (user_data);
+  GdkPixbuf *pixbuf = image->upload.pixbuf;
+  int width, height, row_stride, n_rows;
+  gboolean has_alpha;
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  row_stride = gdk_pixbuf_get_rowstride (pixbuf);
+  has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
+
+  n_rows = MAX (1, UPLOAD_BAND_SIZE / row_stride);
+  n_rows = MIN (n_rows, height - image->upload.next_row);
+
+  if (!cogl_texture_set_region (image->upload.texture,
+                                0, image->upload.next_row,
+                                0, image->upload.next_row,
+                                width, n_rows,
+                                width, height,
+                                has_alpha ? COGL_PIXEL_FORMAT_RGBA_8888_PRE
+                                          : COGL_PIXEL_FORMAT_RGB_888,
+                                row_stride,
+                                gdk_pixbuf_read_pixels (pixbuf)))
+    {
+      g_warning ("Failed to upload texture for background");
+      g_clear_object (&image->upload.texture);
+    }
+  else
+    {
+      image->upload.next_row += n_rows;
+      if (image->upload.next_row < height)
+        return G_SOURCE_CONTINUE;
+    }
+
+  image->upload.idle_id = 0;
+  image->texture = g_steal_pointer (&image->upload.texture);
+  g_clear_object (&image->upload.pixbuf);
+
+  finish_loading (image);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 file_loaded (GObject      *source_object,
              GAsyncResult *result,
@@ -159,12 +269,9 @@ file_loaded (GObject      *source_object,
 {
   MetaBackgroundImage *image = META_BACKGROUND_IMAGE (source_object);
   g_autoptr (GError) error = NULL;
-  g_autoptr (GError) local_error = NULL;
   GTask *task;
   CoglTexture *texture;
-  GdkPixbuf *pixbuf, *rotated;
-  int width, height, row_stride;
-  guchar *pixels;
+  GdkPixbuf *pixbuf;
   gboolean has_alpha;
 
   task = G_TASK (result);
@@ -176,45 +283,37 @@ file_loaded (GObject      *source_object,
       g_warning ("Failed to load background '%s': %s",
                  uri, error->message);
       g_free (uri);
-      goto out;
-    }
-
-  rotated = gdk_pixbuf_apply_embedded_orientation (pixbuf);
-  if (rotated != NULL)
-    {
-      g_object_unref (pixbuf);
-      pixbuf = rotated;
+      finish_loading (image);
+      return;
     }
 
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-  row_stride = gdk_pixbuf_get_rowstride (pixbuf);
-  pixels = gdk_pixbuf_get_pixels (pixbuf);
   has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
 
-  texture = meta_create_texture (width, height,
+  texture = meta_create_texture (gdk_pixbuf_get_width (pixbuf),
+                                 gdk_pixbuf_get_height (pixbuf),
                                  has_alpha ? COGL_TEXTURE_COMPONENTS_RGBA : COGL_TEXTURE_COMPONENTS_RGB,
                                  META_TEXTURE_ALLOW_SLICING);
 
-  if (!cogl_texture_set_data (texture,
-                              has_alpha ? COGL_PIXEL_FORMAT_RGBA_8888 : COGL_PIXEL_FORMAT_RGB_888,
-                              row_stride,
-                              pixels, 0,
-                              &local_error))
+  if (!cogl_texture_allocate (texture, &error))
     {
       g_warning ("Failed to create texture for background: %s",
-                 local_error->message);
-      g_clear_object (&texture);
+                 error->message);
+      g_object_unref (texture);
+      g_object_unref (pixbuf);
+      finish_loading (image);
+      return;
     }
 
-  image->texture = texture;
+  image->upload.pixbuf = pixbuf;
+  image->upload.texture = texture;
+  image->upload.next_row = 0;
 
-out:
-  if (pixbuf != NULL)
-    g_object_unref (pixbuf);
-
-  image->loaded = TRUE;
-  g_signal_emit (image, signals[LOADED], 0);
+  if (upload_band (image) == G_SOURCE_CONTINUE)
+    {
+      image->upload.idle_id = g_idle_add (upload_band, image);
+      g_source_set_name_by_id (image->upload.idle_id,
+                               "[mutter] Background image upload");
+    }
 }
 
 /**
@@ -301,6 +400,10 @@ meta_background_image_finalize (GObject *object)
   if (image->in_cache)
     g_hash_table_remove (image->cache->images, image->file);
 
+  g_clear_handle_id (&image->upload.idle_id, g_source_remove);
+  g_clear_object (&image->upload.texture);
+  g_clear_object (&image->upload.pixbuf);
+
   if (image->texture)
     g_object_unref (image->texture);
   if (image->file)
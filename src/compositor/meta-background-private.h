@@ -9,3 +9,10 @@ CoglTexture * meta_background_get_texture (MetaBackground         *self,
                                            int                     monitor_index,
                                            MtkRectangle           *texture_area,
                                            CoglPipelineWrapMode   *wrap_mode);
+
+CoglTexture * meta_background_get_blurred_texture (MetaBackground         *self,
+                                                   int                     monitor_index,
+                                                   int                     blur_radius,
+                                                   float                   brightness,
+                                                   MtkRectangle           *texture_area,
+                                                   CoglPipelineWrapMode   *wrap_mode);
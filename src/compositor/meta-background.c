@@ -21,9 +21,11 @@
 
 #include "compositor/meta-background-private.h"
 
+#include <float.h>
 #include <string.h>
 
 #include "backends/meta-backend-private.h"
+#include "clutter/clutter-mutter.h"
 #include "compositor/cogl-utils.h"
 #include "meta/display.h"
 #include "meta/meta-background-image.h"
@@ -40,12 +42,28 @@ enum
 static guint signals[LAST_SIGNAL] = { 0 };
 
 typedef struct _MetaBackgroundMonitor MetaBackgroundMonitor;
+typedef struct _MetaBackgroundVariant MetaBackgroundVariant;
 
 struct _MetaBackgroundMonitor
 {
   gboolean dirty;
   CoglTexture *texture;
   CoglFramebuffer *fbo;
+
+  GList *variants;
+};
+
+/* A blurred and/or dimmed copy of the background of a monitor. These are
+ * only rendered when requested, and kept around until the background image
+ * or the monitor layout changes, or until Cogl evicts them to stay within
+ * the texture memory budget.
+ */
+struct _MetaBackgroundVariant
+{
+  MetaBackground *background;
+  int blur_radius;
+  float brightness;
+  CoglTexture *texture;
 };
 
 struct _MetaBackground
@@ -86,11 +104,59 @@ static gboolean texture_has_alpha (CoglTexture *texture);
 
 static GSList *all_backgrounds = NULL;
 
+static void
+meta_background_variant_free (MetaBackgroundVariant *variant)
+{
+  if (variant->texture)
+    cogl_texture_set_evict_func (variant->texture, NULL, NULL);
+  g_clear_object (&variant->texture);
+  g_free (variant);
+}
+
+static void
+free_variants (MetaBackground *self)
+{
+  int i;
+
+  for (i = 0; i < self->n_monitors; i++)
+    {
+      MetaBackgroundMonitor *monitor = &self->monitors[i];
+
+      g_list_free_full (g_steal_pointer (&monitor->variants),
+                        (GDestroyNotify) meta_background_variant_free);
+    }
+}
+
+static void
+variant_texture_evicted (CoglTexture *texture,
+                         gpointer     user_data)
+{
+  MetaBackgroundVariant *variant = user_data;
+  MetaBackground *self = variant->background;
+  int i;
+
+  for (i = 0; i < self->n_monitors; i++)
+    {
+      MetaBackgroundMonitor *monitor = &self->monitors[i];
+      GList *link;
+
+      link = g_list_find (monitor->variants, variant);
+      if (!link)
+        continue;
+
+      monitor->variants = g_list_delete_link (monitor->variants, link);
+      meta_background_variant_free (variant);
+      return;
+    }
+}
+
 static void
 free_fbos (MetaBackground *self)
 {
   int i;
 
+  free_variants (self);
+
   for (i = 0; i < self->n_monitors; i++)
     {
       MetaBackgroundMonitor *monitor = &self->monitors[i];
@@ -206,6 +272,8 @@ mark_changed (MetaBackground *self)
 
   if (!need_prerender (self))
     free_fbos (self);
+  else
+    free_variants (self);
 
   for (i = 0; i < self->n_monitors; i++)
     self->monitors[i].dirty = TRUE;
@@ -945,6 +1013,224 @@ meta_background_get_texture (MetaBackground       *self,
   return monitor->texture;
 }
 
+static CoglTexture *
+create_offscreen_texture (int               width,
+                          int               height,
+                          CoglFramebuffer **fbo)
+{
+  g_autoptr (GError) error = NULL;
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+
+  texture = meta_create_texture (width, height,
+                                 COGL_TEXTURE_COMPONENTS_RGBA,
+                                 META_TEXTURE_FLAGS_NONE);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    {
+      meta_warning ("Failed to allocate background variant: %s",
+                    error->message);
+      g_object_unref (offscreen);
+      g_object_unref (texture);
+      return NULL;
+    }
+
+  cogl_framebuffer_orthographic (COGL_FRAMEBUFFER (offscreen),
+                                 0, 0, width, height,
+                                 -1.0f, 1.0f);
+
+  *fbo = COGL_FRAMEBUFFER (offscreen);
+  return texture;
+}
+
+static CoglTexture *
+create_variant_texture (CoglContext          *cogl_context,
+                        CoglTexture          *texture,
+                        MtkRectangle         *texture_area,
+                        CoglPipelineWrapMode  wrap_mode,
+                        int                   width,
+                        int                   height,
+                        float                 blur_radius,
+                        float                 brightness)
+{
+  g_autoptr (CoglFramebuffer) source_fbo = NULL;
+  g_autoptr (CoglFramebuffer) fbo = NULL;
+  g_autoptr (CoglTexture) source = NULL;
+  CoglTexture *variant;
+  CoglPipeline *pipeline;
+  ClutterBlur *blur = NULL;
+  CoglColor color;
+  float tx1, ty1;
+
+  /* Flatten the monitor background into a texture covering exactly the
+   * monitor, the same way MetaBackgroundContent would paint it, so that
+   * tiled and scaled styles blur the same pixels that would be visible.
+   */
+  source = create_offscreen_texture (width, height, &source_fbo);
+  if (!source)
+    return NULL;
+
+  tx1 = -texture_area->x / (float) texture_area->width;
+  ty1 = -texture_area->y / (float) texture_area->height;
+
+  pipeline = create_pipeline (cogl_context, PIPELINE_REPLACE);
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0, wrap_mode);
+  cogl_pipeline_set_layer_max_mipmap_level (pipeline, 0,
+                                            get_best_mipmap_level (texture,
+                                                                   width,
+                                                                   height));
+  cogl_framebuffer_draw_textured_rectangle (source_fbo, pipeline,
+                                            0, 0, width, height,
+                                            tx1, ty1,
+                                            tx1 + 1.0f, ty1 + 1.0f);
+  g_object_unref (pipeline);
+
+  if (blur_radius > 0.0f)
+    {
+      blur = clutter_blur_new (source, blur_radius);
+      if (!blur)
+        return NULL;
+
+      clutter_blur_apply (blur);
+    }
+
+  variant = create_offscreen_texture (width, height, &fbo);
+  if (!variant)
+    {
+      g_clear_pointer (&blur, clutter_blur_free);
+      return NULL;
+    }
+
+  pipeline = create_pipeline (cogl_context, PIPELINE_REPLACE);
+  cogl_pipeline_set_layer_texture (pipeline, 0,
+                                   blur ? clutter_blur_get_texture (blur) : source);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_color_init_from_4f (&color, brightness, brightness, brightness, 1.0f);
+  cogl_pipeline_set_color (pipeline, &color);
+  cogl_framebuffer_draw_rectangle (fbo, pipeline, 0, 0, width, height);
+  g_object_unref (pipeline);
+
+  g_clear_pointer (&blur, clutter_blur_free);
+
+  return variant;
+}
+
+/*
+ * meta_background_get_blurred_texture:
+ *
+ * Like meta_background_get_texture(), but returns the monitor background
+ * blurred by @blur_radius logical pixels and dimmed by @brightness. The
+ * result is cached alongside the monitor background, so repeated requests
+ * with the same parameters don't render anything until the background or
+ * the monitor layout changes.
+ */
+CoglTexture *
+meta_background_get_blurred_texture (MetaBackground       *self,
+                                     int                   monitor_index,
+                                     int                   blur_radius,
+                                     float                 brightness,
+                                     MtkRectangle         *texture_area,
+                                     CoglPipelineWrapMode *wrap_mode)
+{
+  MetaBackgroundMonitor *monitor;
+  MetaBackgroundVariant *variant;
+  MtkRectangle geometry;
+  MtkRectangle base_area;
+  CoglPipelineWrapMode base_wrap_mode;
+  CoglTexture *texture;
+  CoglTexture *variant_texture;
+  float monitor_scale;
+  float scaled_radius;
+  int width, height;
+  MetaContext *context;
+  MetaBackend *backend;
+  ClutterBackend *clutter_backend;
+  CoglContext *cogl_context;
+  GList *l;
+
+  g_return_val_if_fail (META_IS_BACKGROUND (self), NULL);
+  g_return_val_if_fail (monitor_index >= 0 && monitor_index < self->n_monitors, NULL);
+  g_return_val_if_fail (blur_radius >= 0, NULL);
+
+  if (blur_radius == 0 && G_APPROX_VALUE (brightness, 1.0f, FLT_EPSILON))
+    {
+      return meta_background_get_texture (self, monitor_index,
+                                          texture_area, wrap_mode);
+    }
+
+  monitor = &self->monitors[monitor_index];
+  meta_display_get_monitor_geometry (self->display, monitor_index, &geometry);
+
+  for (l = monitor->variants; l; l = l->next)
+    {
+      variant = l->data;
+
+      if (variant->blur_radius == blur_radius &&
+          G_APPROX_VALUE (variant->brightness, brightness, FLT_EPSILON))
+        goto out;
+    }
+
+  texture = meta_background_get_texture (self, monitor_index,
+                                         &base_area, &base_wrap_mode);
+  if (!texture)
+    return NULL;
+
+  context = meta_display_get_context (self->display);
+  backend = meta_context_get_backend (context);
+  clutter_backend = meta_backend_get_clutter_backend (backend);
+  cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+
+  monitor_scale = meta_display_get_monitor_scale (self->display, monitor_index);
+  if (meta_backend_is_stage_views_scaled (backend))
+    {
+      width = (int) (geometry.width * monitor_scale);
+      height = (int) (geometry.height * monitor_scale);
+      scaled_radius = blur_radius * monitor_scale;
+    }
+  else
+    {
+      width = geometry.width;
+      height = geometry.height;
+      scaled_radius = blur_radius;
+    }
+
+  variant_texture = create_variant_texture (cogl_context,
+                                            texture, &base_area,
+                                            base_wrap_mode,
+                                            width, height,
+                                            scaled_radius, brightness);
+  if (!variant_texture)
+    return NULL;
+
+  variant = g_new0 (MetaBackgroundVariant, 1);
+  variant->background = self;
+  variant->blur_radius = blur_radius;
+  variant->brightness = brightness;
+  variant->texture = variant_texture;
+  monitor->variants = g_list_prepend (monitor->variants, variant);
+
+  cogl_texture_set_memory_category (variant_texture,
+                                    COGL_TEXTURE_MEMORY_CATEGORY_CACHE);
+  cogl_texture_set_evict_func (variant_texture,
+                               variant_texture_evicted, variant);
+
+out:
+  cogl_texture_mark_used (variant->texture);
+
+  if (texture_area)
+    set_texture_area_from_monitor_area (&geometry, texture_area);
+
+  if (wrap_mode)
+    *wrap_mode = COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE;
+  return variant->texture;
+}
+
 MetaBackground *
 meta_background_new (MetaDisplay *display)
 {
@@ -35,6 +35,7 @@
 
 #ifdef HAVE_WAYLAND
 #include "compositor/meta-surface-actor-wayland.h"
+#include "compositor/meta-window-actor-wayland.h"
 #include "wayland/meta-wayland-surface-private.h"
 #endif /* HAVE_WAYLAND */
 
@@ -47,6 +48,7 @@ struct _MetaCompositorViewNative
 
 #ifdef HAVE_WAYLAND
   MetaWaylandSurface *scanout_candidate;
+  MetaWaylandSurface *overlay_candidate;
 #endif /* HAVE_WAYLAND */
 
   MetaSurfaceActor *frame_sync_surface;
@@ -137,31 +139,91 @@ update_scanout_candidate (MetaCompositorViewNative *view_native,
     }
 }
 
+static void
+update_overlay_candidate (MetaCompositorViewNative *view_native,
+                          MetaWaylandSurface       *surface,
+                          MetaCrtc                 *crtc)
+{
+  if (view_native->overlay_candidate &&
+      view_native->overlay_candidate != surface)
+    {
+      meta_wayland_surface_set_overlay_candidate (view_native->overlay_candidate,
+                                                  NULL);
+      g_clear_weak_pointer (&view_native->overlay_candidate);
+    }
+
+  if (surface)
+    {
+      meta_wayland_surface_set_overlay_candidate (surface, crtc);
+      g_set_weak_pointer (&view_native->overlay_candidate,
+                          surface);
+    }
+}
+
+static gboolean
+is_software_cursor_in_rect (MetaCompositorView    *compositor_view,
+                            MetaCompositor        *compositor,
+                            const graphene_rect_t *rect)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaStageView *view = META_STAGE_VIEW (stage_view);
+  MetaBackend *backend = meta_compositor_get_backend (compositor);
+  MetaCursorTracker *cursor_tracker =
+    meta_backend_get_cursor_tracker (backend);
+  CoglTexture *cursor_sprite;
+  graphene_rect_t cursor_rect;
+  graphene_point_t position;
+  float scale;
+  int hotspot_x;
+  int hotspot_y;
+
+  cursor_sprite = meta_cursor_tracker_get_sprite (cursor_tracker);
+  if (!cursor_sprite ||
+      !meta_cursor_tracker_get_pointer_visible (cursor_tracker) ||
+      meta_stage_view_is_cursor_overlay_inhibited (view))
+    return FALSE;
+
+  meta_cursor_tracker_get_pointer (cursor_tracker, &position, NULL);
+  meta_cursor_tracker_get_hot (cursor_tracker, &hotspot_x, &hotspot_y);
+
+  scale = (clutter_stage_view_get_scale (stage_view) *
+           meta_cursor_tracker_get_scale (cursor_tracker));
+
+  graphene_rect_init (&cursor_rect,
+                      position.x - (hotspot_x * scale),
+                      position.y - (hotspot_y * scale),
+                      cogl_texture_get_width (cursor_sprite) * scale,
+                      cogl_texture_get_height (cursor_sprite) * scale);
+
+  return graphene_rect_intersection (rect, &cursor_rect, NULL);
+}
+
 static gboolean
 find_scanout_candidate (MetaCompositorView  *compositor_view,
                         MetaCompositor      *compositor,
                         MetaCrtc           **crtc_out,
                         CoglOnscreen       **onscreen_out,
-                        MetaWaylandSurface **surface_out)
+                        MetaWaylandSurface **surface_out,
+                        MetaWaylandSurface **overlay_surface_out)
 {
   ClutterStageView *stage_view =
     meta_compositor_view_get_stage_view (compositor_view);
   MetaStageView *view = META_STAGE_VIEW (stage_view);
   MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
-  MetaBackend *backend = meta_compositor_get_backend (compositor);
-  MetaCursorTracker *cursor_tracker =
-    meta_backend_get_cursor_tracker (backend);
-  CoglTexture *cursor_sprite;
   MetaCrtc *crtc;
   CoglFramebuffer *framebuffer;
   MetaWindowActor *window_actor;
   MtkRectangle view_rect;
+  graphene_rect_t graphene_view_rect;
   ClutterActorBox actor_box;
   MetaSurfaceActor *surface_actor;
+  MetaSurfaceActor *overlay_surface_actor = NULL;
   MetaSurfaceActorWayland *surface_actor_wayland;
   ClutterColorState *view_color_state;
   ClutterColorState *surface_color_state;
   MetaWaylandSurface *surface;
+  MetaWaylandSurface *overlay_surface = NULL;
 
   if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
     return FALSE;
@@ -175,39 +237,13 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
 
   clutter_stage_view_get_layout (stage_view, &view_rect);
 
-  cursor_sprite = meta_cursor_tracker_get_sprite (cursor_tracker);
-  if (cursor_sprite &&
-      meta_cursor_tracker_get_pointer_visible (cursor_tracker) &&
-      !meta_stage_view_is_cursor_overlay_inhibited (view))
-    {
-      graphene_rect_t graphene_view_rect;
-      graphene_rect_t cursor_rect;
-      graphene_point_t position;
-      float scale;
-      int hotspot_x;
-      int hotspot_y;
-
-      meta_cursor_tracker_get_pointer (cursor_tracker, &position, NULL);
-      meta_cursor_tracker_get_hot (cursor_tracker, &hotspot_x, &hotspot_y);
-
-      scale = (clutter_stage_view_get_scale (stage_view) *
-               meta_cursor_tracker_get_scale (cursor_tracker));
-
-      graphene_rect_init (&cursor_rect,
-                          position.x - (hotspot_x * scale),
-                          position.y - (hotspot_y * scale),
-                          cogl_texture_get_width (cursor_sprite) * scale,
-                          cogl_texture_get_height (cursor_sprite) * scale);
-
-      graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
-      if (graphene_rect_intersection (&graphene_view_rect,
-                                      &cursor_rect,
-                                      NULL))
-        {
-          meta_topic (META_DEBUG_RENDER,
-                      "No direct scanout candidate: using software cursor");
-          return FALSE;
-        }
+  graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
+  if (is_software_cursor_in_rect (compositor_view, compositor,
+                                  &graphene_view_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No direct scanout candidate: using software cursor");
+      return FALSE;
     }
 
   crtc = meta_renderer_view_get_crtc (renderer_view);
@@ -282,6 +318,17 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
     }
 
   surface_actor = meta_window_actor_get_scanout_candidate (window_actor);
+  if (!surface_actor && META_IS_WINDOW_ACTOR_WAYLAND (window_actor) &&
+      meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc)))
+    {
+      MetaWindowActorWayland *window_actor_wayland =
+        META_WINDOW_ACTOR_WAYLAND (window_actor);
+
+      surface_actor =
+        meta_window_actor_wayland_get_scanout_candidate_with_overlay (window_actor_wayland,
+                                                                       &overlay_surface_actor);
+    }
+
   if (!surface_actor)
     {
       meta_topic (META_DEBUG_RENDER,
@@ -290,8 +337,10 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
       return FALSE;
     }
 
+  /* With the view color transform done in an offscreen pass, a scanout
+   * buffer bypasses it, and must already be in the output color state. */
   view_color_state =
-    clutter_stage_view_get_color_state (CLUTTER_STAGE_VIEW (view));
+    clutter_stage_view_get_onscreen_color_state (CLUTTER_STAGE_VIEW (view));
   surface_color_state =
     clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
   if (!clutter_color_state_equals (view_color_state, surface_color_state))
@@ -302,6 +351,29 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
       return FALSE;
     }
 
+  if (overlay_surface_actor)
+    {
+      surface_color_state =
+        clutter_actor_get_color_state (CLUTTER_ACTOR (overlay_surface_actor));
+      if (!clutter_color_state_equals (view_color_state, surface_color_state))
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "No direct scanout candidate: "
+                      "subsurface color state doesn't match the outputs");
+          return FALSE;
+        }
+
+      surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (overlay_surface_actor);
+      overlay_surface =
+        meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+      if (!overlay_surface)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "No direct scanout candidate: no subsurface");
+          return FALSE;
+        }
+    }
+
   if (meta_surface_actor_is_effectively_obscured (surface_actor))
     {
       meta_topic (META_DEBUG_RENDER,
@@ -321,17 +393,20 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
   *crtc_out = crtc;
   *onscreen_out = COGL_ONSCREEN (framebuffer);
   *surface_out = surface;
+  *overlay_surface_out = overlay_surface;
 
   return TRUE;
 }
 
-static void
+static gboolean
 try_assign_next_scanout (MetaCompositorView *compositor_view,
                          CoglOnscreen       *onscreen,
-                         MetaWaylandSurface *surface)
+                         MetaWaylandSurface *surface,
+                         MetaWaylandSurface *overlay_surface)
 {
   ClutterStageView *stage_view;
   g_autoptr (CoglScanout) scanout = NULL;
+  g_autoptr (CoglScanout) overlay_scanout = NULL;
 
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
   scanout = meta_wayland_surface_try_acquire_scanout (surface,
@@ -341,10 +416,218 @@ try_assign_next_scanout (MetaCompositorView *compositor_view,
     {
       meta_topic (META_DEBUG_RENDER,
                   "Could not acquire scanout");
-      return;
+      return FALSE;
+    }
+
+  /* The subsurface is only shown if it makes it onto the overlay plane. */
+  if (overlay_surface)
+    {
+      overlay_scanout =
+        meta_wayland_surface_try_acquire_overlay_scanout (overlay_surface,
+                                                          onscreen,
+                                                          stage_view,
+                                                          scanout);
+      if (!overlay_scanout)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Could not acquire overlay scanout for subsurface");
+          return FALSE;
+        }
+
+      meta_onscreen_native_set_overlay_scanout (META_ONSCREEN_NATIVE (onscreen),
+                                                overlay_scanout,
+                                                scanout);
     }
 
   clutter_stage_view_assign_next_scanout (stage_view, scanout);
+  return TRUE;
+}
+
+static gboolean
+is_painted_over (ClutterActor          *actor,
+                 const graphene_rect_t *rect)
+{
+  ClutterActor *child;
+  ClutterActor *parent;
+
+  if (clutter_actor_has_effects (actor))
+    return TRUE;
+
+  for (child = actor; (parent = clutter_actor_get_parent (child)); child = parent)
+    {
+      ClutterActor *sibling;
+
+      for (sibling = clutter_actor_get_next_sibling (child);
+           sibling;
+           sibling = clutter_actor_get_next_sibling (sibling))
+        {
+          ClutterActorBox sibling_box;
+          graphene_rect_t sibling_rect;
+
+          if (!clutter_actor_is_mapped (sibling))
+            continue;
+
+          /* Anything with unknown extents may end up anywhere. */
+          if (!clutter_actor_get_paint_box (sibling, &sibling_box))
+            return TRUE;
+
+          graphene_rect_init (&sibling_rect,
+                              sibling_box.x1, sibling_box.y1,
+                              sibling_box.x2 - sibling_box.x1,
+                              sibling_box.y2 - sibling_box.y1);
+          if (graphene_rect_intersection (&sibling_rect, rect, NULL))
+            return TRUE;
+        }
+
+      if (clutter_actor_has_effects (parent))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static MetaWaylandSurface *
+find_overlay_candidate (MetaCompositorView *compositor_view,
+                        MetaCompositor     *compositor)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc;
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MetaSurfaceActorWayland *surface_actor_wayland;
+  ClutterActorBox actor_box;
+  graphene_rect_t actor_rect;
+  ClutterColorState *view_color_state;
+  ClutterColorState *surface_color_state;
+
+  if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
+    return NULL;
+
+  if (meta_compositor_is_unredirect_inhibited (compositor))
+    return NULL;
+
+  crtc = meta_renderer_view_get_crtc (renderer_view);
+  if (!META_IS_CRTC_KMS (crtc) ||
+      !meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc)))
+    return NULL;
+
+  if (clutter_stage_view_has_shadowfb (stage_view))
+    return NULL;
+
+  window_actor = meta_compositor_view_get_top_window_actor (compositor_view);
+  if (!window_actor)
+    return NULL;
+
+  if (meta_window_actor_effect_in_progress (window_actor) ||
+      clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: window-actor is animating");
+      return NULL;
+    }
+
+  if (!meta_window_actor_is_single_surface_actor (window_actor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: window-actor has multiple "
+                  "surfaces");
+      return NULL;
+    }
+
+  surface_actor = meta_window_actor_get_surface (window_actor);
+  if (!META_IS_SURFACE_ACTOR_WAYLAND (surface_actor) ||
+      !clutter_actor_is_mapped (CLUTTER_ACTOR (surface_actor)))
+    return NULL;
+
+  /* The overlay plane is blended on top of the composited primary plane,
+   * which already contains the surface; anything translucent would show
+   * up twice. */
+  if (!meta_surface_actor_is_opaque (surface_actor) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (surface_actor)) != 0xff)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor not opaque");
+      return NULL;
+    }
+
+  if (meta_surface_actor_is_effectively_obscured (surface_actor))
+    return NULL;
+
+  view_color_state = clutter_stage_view_get_onscreen_color_state (stage_view);
+  surface_color_state =
+    clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
+  if (!clutter_color_state_equals (view_color_state, surface_color_state))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: "
+                  "surface color state doesn't match the outputs");
+      return NULL;
+    }
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor), &actor_box))
+    return NULL;
+
+  graphene_rect_init (&actor_rect,
+                      actor_box.x1, actor_box.y1,
+                      actor_box.x2 - actor_box.x1,
+                      actor_box.y2 - actor_box.y1);
+
+  /* Nothing may be painted on top of the overlay plane, as it would end up
+   * hidden underneath it. */
+  if (is_painted_over (CLUTTER_ACTOR (surface_actor), &actor_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor is painted over");
+      return NULL;
+    }
+
+  if (is_software_cursor_in_rect (compositor_view, compositor, &actor_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: using software cursor");
+      return NULL;
+    }
+
+  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
+  return meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+}
+
+static MetaWaylandSurface *
+update_overlay_scanout (MetaCompositorView *compositor_view,
+                        MetaCompositor     *compositor,
+                        gboolean            allow_overlay)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  CoglFramebuffer *framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  MetaOnscreenNative *onscreen_native;
+  MetaWaylandSurface *surface = NULL;
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  if (!META_IS_ONSCREEN_NATIVE (framebuffer))
+    return NULL;
+
+  onscreen_native = META_ONSCREEN_NATIVE (framebuffer);
+
+  if (allow_overlay)
+    surface = find_overlay_candidate (compositor_view, compositor);
+
+  if (surface)
+    {
+      scanout =
+        meta_wayland_surface_try_acquire_overlay_scanout (surface,
+                                                          COGL_ONSCREEN (framebuffer),
+                                                          stage_view,
+                                                          NULL);
+      if (!scanout)
+        meta_topic (META_DEBUG_RENDER, "Could not acquire overlay scanout");
+    }
+
+  meta_onscreen_native_set_overlay_scanout (onscreen_native, scanout, NULL);
+
+  return surface;
 }
 
 void
@@ -353,23 +636,48 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
 {
   MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
   MetaCrtc *crtc = NULL;
+  MetaCrtc *overlay_crtc = NULL;
   CoglOnscreen *onscreen = NULL;
   MetaWaylandSurface *surface = NULL;
+  MetaWaylandSurface *overlay_surface = NULL;
   gboolean candidate_found;
+  gboolean scanout_assigned = FALSE;
 
   candidate_found = find_scanout_candidate (compositor_view,
                                             compositor,
                                             &crtc,
                                             &onscreen,
-                                            &surface);
+                                            &surface,
+                                            &overlay_surface);
   if (candidate_found)
     {
-      try_assign_next_scanout (compositor_view,
-                               onscreen,
-                               surface);
+      scanout_assigned = try_assign_next_scanout (compositor_view,
+                                                  onscreen,
+                                                  surface,
+                                                  overlay_surface);
+    }
+
+  if (!scanout_assigned || !overlay_surface)
+    {
+      MetaWaylandSurface *single_overlay_surface;
+
+      single_overlay_surface = update_overlay_scanout (compositor_view,
+                                                       compositor,
+                                                       !scanout_assigned);
+      if (!overlay_surface)
+        overlay_surface = single_overlay_surface;
+    }
+
+  if (overlay_surface)
+    {
+      ClutterStageView *stage_view =
+        meta_compositor_view_get_stage_view (compositor_view);
+
+      overlay_crtc = meta_renderer_view_get_crtc (META_RENDERER_VIEW (stage_view));
     }
 
   update_scanout_candidate (view_native, surface, crtc);
+  update_overlay_candidate (view_native, overlay_surface, overlay_crtc);
 }
 #endif /* HAVE_WAYLAND */
 
@@ -464,6 +772,27 @@ find_frame_sync_candidate (MetaCompositorView *compositor_view,
       return NULL;
     }
 
+#ifdef HAVE_WAYLAND
+  if (META_IS_SURFACE_ACTOR_WAYLAND (surface_actor))
+    {
+      MetaSurfaceActorWayland *surface_actor_wayland =
+        META_SURFACE_ACTOR_WAYLAND (surface_actor);
+      MetaWaylandSurface *surface =
+        meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+
+      /* Still images gain nothing from a variable refresh rate, while
+       * dropping to the lowest rates may flicker on some panels. */
+      if (surface &&
+          meta_wayland_surface_get_content_type (surface) ==
+          META_WAYLAND_CONTENT_TYPE_PHOTO)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "No frame sync candidate: surface shows photo content");
+          return NULL;
+        }
+    }
+#endif /* HAVE_WAYLAND */
+
   return surface_actor;
 }
 
@@ -570,6 +899,7 @@ meta_compositor_view_native_finalize (GObject *object)
   MetaCompositorViewNative *view_native = META_COMPOSITOR_VIEW_NATIVE (object);
 
   g_clear_weak_pointer (&view_native->scanout_candidate);
+  g_clear_weak_pointer (&view_native->overlay_candidate);
 #endif /* HAVE_WAYLAND */
 
   G_OBJECT_CLASS (meta_compositor_view_native_parent_class)->finalize (object);
@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "clutter/clutter-mutter.h"
 #include "compositor/clutter-utils.h"
 #include "compositor/meta-cullable.h"
@@ -55,6 +57,236 @@ region_apply_transform_expand_maybe_ref (MtkRegion         *region,
   return mtk_region_apply_matrix_transform_expand (region, transform);
 }
 
+/* To quickly find children that are completely obscured, the region is
+ * rasterized into a coarse mask of tiles. For each tile, we track whether it
+ * intersects the region at all, and whether it is completely inside one of
+ * its rectangles. A child touching only tiles outside the region is obscured,
+ * and a child fully covering a tile inside the region is not; only when
+ * neither is the case do we need to look at the exact region.
+ *
+ * With only a few rectangles, the region itself is cheaper to query than
+ * rebuilding the mask, so it is only used for more complex regions.
+ */
+#define TILE_SIZE 16
+#define MIN_RECTANGLES_FOR_TILE_MASK 8
+
+typedef struct _TileMask
+{
+  gboolean valid;
+
+  int x_origin;
+  int y_origin;
+  int n_columns;
+  int n_rows;
+  int stride;
+
+  uint64_t *bits;
+  size_t n_bits_allocated;
+} TileMask;
+
+static inline int
+tile_floor (int coordinate)
+{
+  return coordinate >= 0 ? coordinate / TILE_SIZE
+                         : -((TILE_SIZE - 1 - coordinate) / TILE_SIZE);
+}
+
+static inline int
+tile_ceil (int coordinate)
+{
+  return tile_floor (coordinate + TILE_SIZE - 1);
+}
+
+static inline uint64_t *
+tile_mask_get_row (TileMask *mask,
+                   int       plane,
+                   int       row)
+{
+  return mask->bits + (plane * mask->n_rows + row) * mask->stride;
+}
+
+static void
+tile_mask_set_bits (TileMask *mask,
+                    int       plane,
+                    int       x1,
+                    int       y1,
+                    int       x2,
+                    int       y2)
+{
+  int row, column;
+
+  for (row = y1; row <= y2; row++)
+    {
+      uint64_t *bits = tile_mask_get_row (mask, plane, row);
+
+      for (column = x1; column <= x2; column++)
+        bits[column / 64] |= UINT64_C (1) << (column % 64);
+    }
+}
+
+static gboolean
+tile_mask_has_bits (TileMask *mask,
+                    int       plane,
+                    int       x1,
+                    int       y1,
+                    int       x2,
+                    int       y2)
+{
+  int row, word;
+
+  for (row = y1; row <= y2; row++)
+    {
+      uint64_t *bits = tile_mask_get_row (mask, plane, row);
+
+      for (word = x1 / 64; word <= x2 / 64; word++)
+        {
+          uint64_t word_mask = ~UINT64_C (0);
+
+          if (word == x1 / 64)
+            word_mask &= ~UINT64_C (0) << (x1 % 64);
+          if (word == x2 / 64)
+            word_mask &= ~UINT64_C (0) >> (63 - x2 % 64);
+
+          if (bits[word] & word_mask)
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+enum
+{
+  TILE_PLANE_ANY,
+  TILE_PLANE_FULL,
+};
+
+static void
+tile_mask_update (TileMask  *mask,
+                  MtkRegion *region)
+{
+  MtkRectangle extents;
+  size_t n_bits;
+  int n_rects, i;
+
+  extents = mtk_region_get_extents (region);
+  mask->x_origin = tile_floor (extents.x);
+  mask->y_origin = tile_floor (extents.y);
+  mask->n_columns = tile_ceil (extents.x + extents.width) - mask->x_origin;
+  mask->n_rows = tile_ceil (extents.y + extents.height) - mask->y_origin;
+  mask->stride = (mask->n_columns + 63) / 64;
+
+  n_bits = 2 * mask->n_rows * mask->stride;
+  if (n_bits > mask->n_bits_allocated)
+    {
+      mask->bits = g_renew (uint64_t, mask->bits, n_bits);
+      mask->n_bits_allocated = n_bits;
+    }
+  memset (mask->bits, 0, n_bits * sizeof (uint64_t));
+
+  n_rects = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+      int x1, y1, x2, y2;
+
+      x1 = tile_floor (rect.x) - mask->x_origin;
+      y1 = tile_floor (rect.y) - mask->y_origin;
+      x2 = tile_floor (rect.x + rect.width - 1) - mask->x_origin;
+      y2 = tile_floor (rect.y + rect.height - 1) - mask->y_origin;
+      tile_mask_set_bits (mask, TILE_PLANE_ANY, x1, y1, x2, y2);
+
+      x1 = tile_ceil (rect.x) - mask->x_origin;
+      y1 = tile_ceil (rect.y) - mask->y_origin;
+      x2 = tile_floor (rect.x + rect.width) - 1 - mask->x_origin;
+      y2 = tile_floor (rect.y + rect.height) - 1 - mask->y_origin;
+      if (x1 <= x2 && y1 <= y2)
+        tile_mask_set_bits (mask, TILE_PLANE_FULL, x1, y1, x2, y2);
+    }
+
+  mask->valid = TRUE;
+}
+
+static void
+tile_mask_clear (TileMask *mask)
+{
+  g_clear_pointer (&mask->bits, g_free);
+}
+
+static gboolean
+is_rectangle_obscured (TileMask           *mask,
+                       MtkRegion          *region,
+                       const MtkRectangle *rect)
+{
+  MtkRectangle extents, clipped;
+  int x1, y1, x2, y2;
+
+  if (mtk_region_num_rectangles (region) < MIN_RECTANGLES_FOR_TILE_MASK)
+    {
+      return mtk_region_contains_rectangle (region, rect) ==
+             MTK_REGION_OVERLAP_OUT;
+    }
+
+  extents = mtk_region_get_extents (region);
+  if (!mtk_rectangle_intersect (&extents, rect, &clipped))
+    return TRUE;
+
+  if (!mask->valid)
+    tile_mask_update (mask, region);
+
+  x1 = tile_floor (clipped.x) - mask->x_origin;
+  y1 = tile_floor (clipped.y) - mask->y_origin;
+  x2 = tile_floor (clipped.x + clipped.width - 1) - mask->x_origin;
+  y2 = tile_floor (clipped.y + clipped.height - 1) - mask->y_origin;
+  if (!tile_mask_has_bits (mask, TILE_PLANE_ANY, x1, y1, x2, y2))
+    return TRUE;
+
+  x1 = tile_ceil (clipped.x) - mask->x_origin;
+  y1 = tile_ceil (clipped.y) - mask->y_origin;
+  x2 = tile_floor (clipped.x + clipped.width) - 1 - mask->x_origin;
+  y2 = tile_floor (clipped.y + clipped.height) - 1 - mask->y_origin;
+  if (x1 <= x2 && y1 <= y2 &&
+      tile_mask_has_bits (mask, TILE_PLANE_FULL, x1, y1, x2, y2))
+    return FALSE;
+
+  return mtk_region_contains_rectangle (region, &clipped) ==
+         MTK_REGION_OVERLAP_OUT;
+}
+
+/* Whether the child, including everything it paints, is outside of the
+ * region, in which case it doesn't need its own copy of it */
+static gboolean
+is_child_obscured (TileMask          *mask,
+                   MtkRegion         *region,
+                   ClutterActor      *child,
+                   graphene_matrix_t *child_transform)
+{
+  const ClutterPaintVolume *paint_volume;
+  graphene_point3d_t origin;
+  graphene_rect_t bounds;
+  MtkRectangle rect;
+
+  if (mtk_region_is_empty (region))
+    return FALSE;
+
+  paint_volume = clutter_actor_get_paint_volume (child);
+  if (!paint_volume)
+    return FALSE;
+
+  clutter_paint_volume_get_origin (paint_volume, &origin);
+  bounds = GRAPHENE_RECT_INIT (origin.x, origin.y,
+                               clutter_paint_volume_get_width (paint_volume),
+                               clutter_paint_volume_get_height (paint_volume));
+  graphene_matrix_transform_bounds (child_transform, &bounds, &bounds);
+  mtk_rectangle_from_graphene_rect (&bounds, MTK_ROUNDING_STRATEGY_GROW,
+                                    &rect);
+
+  if (rect.width <= 0 || rect.height <= 0)
+    return FALSE;
+
+  return is_rectangle_obscured (mask, region, &rect);
+}
+
 /**
  * MetaCullable:
  *
@@ -85,6 +317,8 @@ cull_out_children_common (MetaCullable    *cullable,
   ClutterActor *actor = CLUTTER_ACTOR (cullable);
   ClutterActor *child;
   ClutterActorIter iter;
+  g_autoptr (MtkRegion) empty_region = NULL;
+  TileMask mask = { 0, };
 
   clutter_actor_iter_init (&iter, actor);
   while (clutter_actor_iter_prev (&iter, &child))
@@ -126,18 +360,32 @@ cull_out_children_common (MetaCullable    *cullable,
 
           clutter_actor_get_transform (child, &actor_transform);
 
-          if (graphene_matrix_is_identity (&actor_transform))
+          if (!graphene_matrix_is_identity (&actor_transform) &&
+              (!graphene_matrix_inverse (&actor_transform,
+                                         &inverted_actor_transform) ||
+               !graphene_matrix_is_2d (&actor_transform)))
             {
-              /* No transformation needed, simply pass through to child */
-              method (META_CULLABLE (child), region);
+              method (META_CULLABLE (child), NULL);
               continue;
             }
 
-          if (!graphene_matrix_inverse (&actor_transform,
-                                        &inverted_actor_transform) ||
-              !graphene_matrix_is_2d (&actor_transform))
+          /* A completely obscured child can't reduce the region any
+           * further, so skip transforming the region back and forth */
+          if (is_child_obscured (&mask, region, child, &actor_transform))
             {
-              method (META_CULLABLE (child), NULL);
+              if (!empty_region)
+                empty_region = mtk_region_create ();
+
+              method (META_CULLABLE (child), empty_region);
+              continue;
+            }
+
+          mask.valid = FALSE;
+
+          if (graphene_matrix_is_identity (&actor_transform))
+            {
+              /* No transformation needed, simply pass through to child */
+              method (META_CULLABLE (child), region);
               continue;
             }
 
@@ -162,6 +410,8 @@ cull_out_children_common (MetaCullable    *cullable,
           method (META_CULLABLE (child), NULL);
         }
     }
+
+  tile_mask_clear (&mask);
 }
 
 /**
@@ -26,6 +26,12 @@
 #include "core/display-private.h"
 #include "meta/meta-later.h"
 
+/*
+ * Time laters may take during a stage update before the deferrable ones
+ * are postponed to the next update.
+ */
+#define LATERS_FRAME_BUDGET_US (ms2us (4))
+
 typedef struct _MetaLater
 {
   MetaLaters *laters;
@@ -33,6 +39,7 @@ typedef struct _MetaLater
   unsigned int id;
   unsigned int ref_count;
   MetaLaterType when;
+  MetaLaterFlags flags;
 
   GSourceFunc func;
   gpointer user_data;
@@ -40,6 +47,7 @@ typedef struct _MetaLater
 
   guint source_id;
   gboolean run_once;
+  gboolean deferred;
 } MetaLater;
 
 #define META_LATER_N_TYPES (META_LATER_IDLE + 1)
@@ -143,10 +151,25 @@ remove_later_from_list (unsigned int   later_id,
   return FALSE;
 }
 
+static gboolean
+should_defer_later (MetaLater *later,
+                    int64_t    deadline_us)
+{
+  if (!(later->flags & META_LATER_FLAG_DEFERRABLE))
+    return FALSE;
+
+  if (later->deferred)
+    return FALSE;
+
+  return g_get_monotonic_time () > deadline_us;
+}
+
 static void
-run_repaint_laters (GSList **laters_list)
+run_repaint_laters (GSList  **laters_list,
+                    int64_t   deadline_us)
 {
   g_autoptr (GSList) laters_copy = NULL;
+  g_autoptr (GSList) deferrable_laters = NULL;
   GSList *l;
 
   for (l = *laters_list; l; l = l->next)
@@ -155,8 +178,23 @@ run_repaint_laters (GSList **laters_list)
 
       if (!later->source_id ||
           (later->when <= META_LATER_BEFORE_REDRAW && !later->run_once))
-        laters_copy = g_slist_prepend (laters_copy, meta_later_ref (later));
+        {
+          if (later->flags & META_LATER_FLAG_DEFERRABLE)
+            {
+              deferrable_laters = g_slist_prepend (deferrable_laters,
+                                                   meta_later_ref (later));
+            }
+          else
+            {
+              laters_copy = g_slist_prepend (laters_copy,
+                                             meta_later_ref (later));
+            }
+        }
     }
+
+  /* Deferrable laters run after the others of the same type */
+  laters_copy = g_slist_concat (deferrable_laters, laters_copy);
+  deferrable_laters = NULL;
   laters_copy = g_slist_reverse (laters_copy);
 
   for (l = laters_copy; l; l = l->next)
@@ -164,9 +202,19 @@ run_repaint_laters (GSList **laters_list)
       MetaLater *later = l->data;
 
       if (!later->func)
-        remove_later_from_list (later->id, laters_list);
-      else if (!meta_later_invoke (later))
-        remove_later_from_list (later->id, laters_list);
+        {
+          remove_later_from_list (later->id, laters_list);
+        }
+      else if (should_defer_later (later, deadline_us))
+        {
+          later->deferred = TRUE;
+        }
+      else
+        {
+          later->deferred = FALSE;
+          if (!meta_later_invoke (later))
+            remove_later_from_list (later->id, laters_list);
+        }
 
       meta_later_unref (later);
     }
@@ -181,9 +229,12 @@ on_before_update (ClutterStage     *stage,
   unsigned int i;
   GSList *l;
   gboolean needs_schedule_update = FALSE;
+  int64_t deadline_us;
+
+  deadline_us = g_get_monotonic_time () + LATERS_FRAME_BUDGET_US;
 
   for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
-    run_repaint_laters (&laters->laters[i]);
+    run_repaint_laters (&laters->laters[i], deadline_us);
 
   for (i = 0; i < G_N_ELEMENTS (laters->laters); i++)
     {
@@ -191,7 +242,7 @@ on_before_update (ClutterStage     *stage,
         {
           MetaLater *later = l->data;
 
-          if (!later->source_id)
+          if (!later->source_id || later->deferred)
             needs_schedule_update = TRUE;
         }
     }
@@ -270,6 +321,33 @@ meta_laters_add (MetaLaters     *laters,
                  GSourceFunc     func,
                  gpointer        user_data,
                  GDestroyNotify  notify)
+{
+  return meta_laters_add_full (laters, when, META_LATER_FLAG_NONE,
+                               func, user_data, notify);
+}
+
+/**
+ * meta_laters_add_full:
+ * @laters: a #MetaLaters
+ * @when: enumeration value determining the phase at which to run the callback
+ * @flags: flags affecting when the callback may be run
+ * @func: callback to run later
+ * @user_data: data to pass to the callback
+ * @notify: function to call to destroy @data when it is no longer in use, or %NULL
+ *
+ * Like meta_laters_add(), but with @flags, e.g. to allow the callback to be
+ * postponed when a stage update is running late.
+ *
+ * Return value: an integer ID (guaranteed to be non-zero) that can be used
+ *  to cancel the callback and prevent it from being run.
+ */
+unsigned int
+meta_laters_add_full (MetaLaters     *laters,
+                      MetaLaterType   when,
+                      MetaLaterFlags  flags,
+                      GSourceFunc     func,
+                      gpointer        user_data,
+                      GDestroyNotify  notify)
 {
   ClutterStage *stage = meta_compositor_get_stage (laters->compositor);
   MetaLater *later = g_new0 (MetaLater, 1);
@@ -278,6 +356,7 @@ meta_laters_add (MetaLaters     *laters,
   later->laters = laters;
   later->ref_count = 1;
   later->when = when;
+  later->flags = flags;
   later->func = func;
   later->user_data = user_data;
   later->destroy_notify = notify;
@@ -35,6 +35,19 @@ typedef struct _MetaMultiTextureFormatInfo
   uint8_t vsub[COGL_PIXEL_FORMAT_MAX_PLANES]; /* vertical subsampling */
 } MetaMultiTextureFormatInfo;
 
+typedef enum _MetaMultiTextureCoefficients
+{
+  META_MULTI_TEXTURE_COEFFICIENTS_BT601,
+  META_MULTI_TEXTURE_COEFFICIENTS_BT709,
+  META_MULTI_TEXTURE_COEFFICIENTS_BT2020,
+} MetaMultiTextureCoefficients;
+
+typedef enum _MetaMultiTextureRange
+{
+  META_MULTI_TEXTURE_RANGE_LIMITED,
+  META_MULTI_TEXTURE_RANGE_FULL,
+} MetaMultiTextureRange;
+
 const char * meta_multi_texture_format_to_string (MetaMultiTextureFormat format);
 
 const MetaMultiTextureFormatInfo * meta_multi_texture_format_get_info (MetaMultiTextureFormat format);
@@ -43,4 +56,9 @@ gboolean meta_multi_texture_format_get_snippets (MetaMultiTextureFormat   format
                                                  CoglSnippet            **fragment_globals_snippet,
                                                  CoglSnippet            **fragment_snippet);
 
+void meta_multi_texture_format_set_conversion_uniforms (MetaMultiTextureFormat        format,
+                                                        CoglPipeline                 *pipeline,
+                                                        MetaMultiTextureCoefficients  coefficients,
+                                                        MetaMultiTextureRange         range);
+
 G_END_DECLS
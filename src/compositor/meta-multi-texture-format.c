@@ -25,16 +25,19 @@
 
 #include "cogl/cogl.h"
 
+#define UNIFORM_NAME_YUV_TO_RGB_MATRIX "yuv_to_rgb_matrix"
+
+/* The conversion matrix folds the matrix coefficients together with the
+ * range expansion, so that the program is the same for every encoding and
+ * only the uniform differs between surfaces. */
 static const char *shader_global_conversions =
+  "uniform mat4 " UNIFORM_NAME_YUV_TO_RGB_MATRIX ";                         \n"
+  "                                                                         \n"
   "vec4 yuv_to_rgb(vec4 yuva)                                               \n"
   "{                                                                        \n"
   "  vec4 res;                                                              \n"
-  "  float Y = 255.0/219.0 * (yuva.x - 16.0/255.0);                         \n"
-  "  float su = yuva.y - 128.0/255.0;                                       \n"
-  "  float sv = yuva.z - 128.0/255.0;                                       \n"
-  "  res.r = Y                   + 1.59602678 * sv;                         \n"
-  "  res.g = Y - 0.39176229 * su - 0.81296764 * sv;                         \n"
-  "  res.b = Y + 2.01723214 * su;                                           \n"
+  "  res.rgb = (" UNIFORM_NAME_YUV_TO_RGB_MATRIX " *                        \n"
+  "             vec4 (yuva.xyz, 1.0)).rgb;                                  \n"
   "  res.rgb *= yuva.w;                                                     \n"
   "  res.a = yuva.w;                                                        \n"
   "  return res;                                                            \n"
@@ -184,6 +187,101 @@ create_format_snippet (gpointer data)
                            multi_format_table[format].rgb_shader);
 }
 
+static void
+get_luma_coefficients (MetaMultiTextureCoefficients  coefficients,
+                       float                        *kr,
+                       float                        *kb)
+{
+  switch (coefficients)
+    {
+    case META_MULTI_TEXTURE_COEFFICIENTS_BT601:
+      *kr = 0.299f;
+      *kb = 0.114f;
+      return;
+    case META_MULTI_TEXTURE_COEFFICIENTS_BT709:
+      *kr = 0.2126f;
+      *kb = 0.0722f;
+      return;
+    case META_MULTI_TEXTURE_COEFFICIENTS_BT2020:
+      *kr = 0.2627f;
+      *kb = 0.0593f;
+      return;
+    }
+
+  g_assert_not_reached ();
+}
+
+void
+meta_multi_texture_format_set_conversion_uniforms (MetaMultiTextureFormat        format,
+                                                   CoglPipeline                 *pipeline,
+                                                   MetaMultiTextureCoefficients  coefficients,
+                                                   MetaMultiTextureRange         range)
+{
+  float kr, kb, kg;
+  float y_scale, y_offset;
+  float c_scale, c_offset;
+  float rv, gu, gv, bu;
+  float matrix[16];
+  int location;
+
+  g_return_if_fail (format < G_N_ELEMENTS (multi_format_table));
+
+  if (multi_format_table[format].rgb_shader == NULL ||
+      multi_format_table[format].rgb_shader == rgba_shader)
+    return;
+
+  get_luma_coefficients (coefficients, &kr, &kb);
+  kg = 1.0f - kr - kb;
+
+  c_offset = 128.0f / 255.0f;
+
+  switch (range)
+    {
+    case META_MULTI_TEXTURE_RANGE_LIMITED:
+      y_scale = 255.0f / 219.0f;
+      y_offset = 16.0f / 255.0f;
+      c_scale = 255.0f / 224.0f;
+      break;
+    case META_MULTI_TEXTURE_RANGE_FULL:
+      y_scale = 1.0f;
+      y_offset = 0.0f;
+      c_scale = 1.0f;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  rv = 2.0f * (1.0f - kr) * c_scale;
+  gu = -2.0f * kb * (1.0f - kb) / kg * c_scale;
+  gv = -2.0f * kr * (1.0f - kr) / kg * c_scale;
+  bu = 2.0f * (1.0f - kb) * c_scale;
+
+  /* Column major, one column per Y, U and V input plus the offsets */
+  matrix[0] = y_scale;
+  matrix[1] = y_scale;
+  matrix[2] = y_scale;
+  matrix[3] = 0.0f;
+
+  matrix[4] = 0.0f;
+  matrix[5] = gu;
+  matrix[6] = bu;
+  matrix[7] = 0.0f;
+
+  matrix[8] = rv;
+  matrix[9] = gv;
+  matrix[10] = 0.0f;
+  matrix[11] = 0.0f;
+
+  matrix[12] = -(y_scale * y_offset + rv * c_offset);
+  matrix[13] = -(y_scale * y_offset + (gu + gv) * c_offset);
+  matrix[14] = -(y_scale * y_offset + bu * c_offset);
+  matrix[15] = 1.0f;
+
+  location = cogl_pipeline_get_uniform_location (pipeline,
+                                                 UNIFORM_NAME_YUV_TO_RGB_MATRIX);
+  cogl_pipeline_set_uniform_matrix (pipeline, location, 4, 1, FALSE, matrix);
+}
+
 gboolean
 meta_multi_texture_format_get_snippets (MetaMultiTextureFormat   format,
                                         CoglSnippet            **fragment_globals_snippet,
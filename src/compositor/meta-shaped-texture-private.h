@@ -73,3 +73,11 @@ void meta_shaped_texture_set_opaque_region (MetaShapedTexture *stex,
 void meta_shaped_texture_ensure_size_valid (MetaShapedTexture *stex);
 
 gboolean meta_shaped_texture_should_get_via_offscreen (MetaShapedTexture *stex);
+
+void meta_shaped_texture_release_mipmaps (MetaShapedTexture *stex);
+
+gboolean meta_shaped_texture_get_image_into (MetaShapedTexture *stex,
+                                             int                width,
+                                             int                height,
+                                             int                stride,
+                                             uint8_t           *data);
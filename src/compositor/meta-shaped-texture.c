@@ -463,6 +463,9 @@ get_combined_pipeline (MetaShapedTexture   *stex,
                                           &fragment_snippet);
   cogl_pipeline_add_snippet (pipeline, fragment_globals_snippet);
   cogl_pipeline_add_snippet (pipeline, fragment_snippet);
+  meta_multi_texture_format_set_conversion_uniforms (format, pipeline,
+                                                     META_MULTI_TEXTURE_COEFFICIENTS_BT601,
+                                                     META_MULTI_TEXTURE_RANGE_LIMITED);
 
   g_clear_object (&fragment_globals_snippet);
   g_clear_object (&fragment_snippet);
@@ -869,6 +872,13 @@ do_paint_content (MetaShapedTexture   *stex,
 
   /* Use nearest-pixel interpolation if the texture is unscaled. This
    * improves performance, especially with software rendering.
+   *
+   * Views are painted straight into framebuffers of their physical size,
+   * also with fractional scaling, so what "unscaled" means is determined
+   * by the final transformation to framebuffer pixels: a buffer from a
+   * fractional scale aware client is sampled 1:1, and only surfaces that
+   * really are resampled, e.g. from clients drawing at an integer scale,
+   * are filtered, within that same single pass.
    */
 
   framebuffer = clutter_paint_node_get_framebuffer (root_node);
@@ -890,7 +900,12 @@ do_paint_content (MetaShapedTexture   *stex,
   if (mtk_monitor_transform_is_rotated (stex->transform))
     flip_ints (&sample_width, &sample_height);
 
-  if (meta_actor_painting_untransformed (framebuffer,
+  /* A single pixel texture, e.g. from a single pixel buffer drawing a solid
+   * color, samples the same texel everywhere, so filtering only costs
+   * without changing the result.
+   */
+  if ((texture_width == 1 && texture_height == 1) ||
+      meta_actor_painting_untransformed (framebuffer,
                                          dst_width, dst_height,
                                          sample_width, sample_height,
                                          &transforms))
@@ -914,8 +929,22 @@ do_paint_content (MetaShapedTexture   *stex,
           texture_width >= 8 &&
           texture_height >= 8)
         {
-          paint_tex = meta_texture_mipmap_get_paint_texture (stex->texture_mipmap);
-          min_filter = COGL_PIPELINE_FILTER_LINEAR_MIPMAP_NEAREST;
+          ClutterFrame *frame = clutter_paint_context_get_frame (paint_context);
+          MetaMultiTexture *mipmap_tex;
+
+          mipmap_tex = meta_texture_mipmap_get_paint_texture (stex->texture_mipmap,
+                                                              frame);
+
+          /* Come back for whatever didn't fit in this frame; until the
+           * mipmap is complete the base texture is used unmipmapped. */
+          if (meta_texture_mipmap_is_pending (stex->texture_mipmap))
+            clutter_content_invalidate (CLUTTER_CONTENT (stex));
+
+          if (mipmap_tex)
+            {
+              paint_tex = mipmap_tex;
+              min_filter = COGL_PIPELINE_FILTER_LINEAR_MIPMAP_NEAREST;
+            }
         }
     }
 
@@ -1186,6 +1215,14 @@ meta_shaped_texture_set_create_mipmaps (MetaShapedTexture *stex,
     }
 }
 
+void
+meta_shaped_texture_release_mipmaps (MetaShapedTexture *stex)
+{
+  g_return_if_fail (META_IS_SHAPED_TEXTURE (stex));
+
+  meta_texture_mipmap_clear (stex->texture_mipmap);
+}
+
 void
 meta_shaped_texture_set_mask_texture (MetaShapedTexture *stex,
                                       CoglTexture       *mask_texture)
@@ -1230,6 +1267,8 @@ meta_shaped_texture_update_area (MetaShapedTexture  *stex,
   if (stex->texture == NULL)
     return FALSE;
 
+  meta_texture_mipmap_invalidate_area (stex->texture_mipmap, area);
+
   /* Pad the actor clip to ensure that pixels affected by linear scaling are accounted for */
   *clip = (MtkRectangle) {
     .x = area->x - 1,
@@ -1319,8 +1358,6 @@ meta_shaped_texture_update_area (MetaShapedTexture  *stex,
                                     clip);
     }
 
-  meta_texture_mipmap_invalidate (stex->texture_mipmap);
-
   return TRUE;
 }
 
@@ -1711,6 +1748,41 @@ meta_shaped_texture_get_image (MetaShapedTexture *stex,
   return surface;
 }
 
+/*
+ * Reads the texture straight into @data, when it can be read without
+ * painting it and is exactly @width x @height pixels, sparing the caller
+ * the image meta_shaped_texture_get_image() would allocate and it would
+ * then copy from.
+ */
+gboolean
+meta_shaped_texture_get_image_into (MetaShapedTexture *stex,
+                                    int                width,
+                                    int                height,
+                                    int                stride,
+                                    uint8_t           *data)
+{
+  CoglTexture *texture;
+
+  if (stex->texture == NULL)
+    return FALSE;
+
+  if (meta_shaped_texture_should_get_via_offscreen (stex))
+    return FALSE;
+
+  if (meta_multi_texture_get_n_planes (stex->texture) > 1)
+    return FALSE;
+
+  texture = meta_multi_texture_get_plane (stex->texture, 0);
+  if (cogl_texture_get_width (texture) != width ||
+      cogl_texture_get_height (texture) != height)
+    return FALSE;
+
+  cogl_texture_get_data (texture, COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                         stride, data);
+
+  return TRUE;
+}
+
 void
 meta_shaped_texture_set_fallback_size (MetaShapedTexture *stex,
                                        int                fallback_width,
@@ -24,6 +24,7 @@
 
 #include "compositor/meta-surface-actor-wayland.h"
 
+#include <float.h>
 #include <math.h>
 
 #include "backends/meta-backend-private.h"
@@ -41,6 +42,8 @@ struct _MetaSurfaceActorWayland
   MetaSurfaceActor parent;
 
   MetaWaylandSurface *surface;
+
+  ClutterStageView *primary_view;
 };
 
 G_DEFINE_TYPE (MetaSurfaceActorWayland,
@@ -62,15 +65,17 @@ meta_surface_actor_wayland_is_opaque (MetaSurfaceActor *actor)
   return meta_shaped_texture_is_opaque (stex);
 }
 
-#define UNOBSCURED_THRESHOLD 0.1
+#define PRIMARY_VIEW_HYSTERESIS 0.1
 
 gboolean
 meta_surface_actor_wayland_is_view_primary (MetaSurfaceActor *actor,
                                             ClutterStageView *stage_view)
 {
+  MetaSurfaceActorWayland *self = META_SURFACE_ACTOR_WAYLAND (actor);
   ClutterStageView *current_primary_view = NULL;
   float highest_refresh_rate = 0.f;
   float biggest_unobscurred_fraction = 0.f;
+  float previous_primary_fraction = -1.f;
   MetaWindowActor *window_actor;
   gboolean is_streaming = FALSE;
   GList *l;
@@ -124,11 +129,21 @@ meta_surface_actor_wayland_is_view_primary (MetaSurfaceActor *actor,
 
   if (!l->next)
     {
-      return !meta_surface_actor_is_obscured_on_stage_view (actor,
-                                                            stage_view,
-                                                            NULL);
+      if (meta_surface_actor_is_obscured_on_stage_view (actor,
+                                                        stage_view,
+                                                        NULL))
+        return FALSE;
+
+      g_set_weak_pointer (&self->primary_view, stage_view);
+      return TRUE;
     }
 
+  /* With the surface spanning multiple views, frame callbacks and
+   * presentation feedback follow the view showing most of it, and
+   * the refresh rate only breaks ties. To not make the client switch
+   * cadence back and forth while the surface is moved, the previous
+   * primary view is kept until another one clearly shows more of it.
+   */
   for (; l; l = l->next)
     {
       ClutterStageView *view = l->data;
@@ -140,13 +155,16 @@ meta_surface_actor_wayland_is_view_primary (MetaSurfaceActor *actor,
                                                         &unobscurred_fraction))
         continue;
 
+      if (view == self->primary_view)
+        previous_primary_fraction = unobscurred_fraction;
+
       refresh_rate = clutter_stage_view_get_refresh_rate (view);
 
-      if ((refresh_rate > highest_refresh_rate &&
-           (biggest_unobscurred_fraction < UNOBSCURED_THRESHOLD ||
-            unobscurred_fraction > UNOBSCURED_THRESHOLD)) ||
-          (biggest_unobscurred_fraction < UNOBSCURED_THRESHOLD &&
-           unobscurred_fraction > UNOBSCURED_THRESHOLD))
+      if (unobscurred_fraction > biggest_unobscurred_fraction ||
+          (G_APPROX_VALUE (unobscurred_fraction,
+                           biggest_unobscurred_fraction,
+                           FLT_EPSILON) &&
+           refresh_rate > highest_refresh_rate))
         {
           current_primary_view = view;
           highest_refresh_rate = refresh_rate;
@@ -154,6 +172,14 @@ meta_surface_actor_wayland_is_view_primary (MetaSurfaceActor *actor,
         }
     }
 
+  if (self->primary_view &&
+      previous_primary_fraction >= 0.f &&
+      previous_primary_fraction + PRIMARY_VIEW_HYSTERESIS >
+      biggest_unobscurred_fraction)
+    current_primary_view = self->primary_view;
+
+  g_set_weak_pointer (&self->primary_view, current_primary_view);
+
   return current_primary_view == stage_view;
 }
 
@@ -287,6 +313,8 @@ meta_surface_actor_wayland_dispose (GObject *object)
       self->surface = NULL;
     }
 
+  g_clear_weak_pointer (&self->primary_view);
+
   G_OBJECT_CLASS (meta_surface_actor_wayland_parent_class)->dispose (object);
 }
 
@@ -20,6 +20,7 @@
 #include "compositor/meta-surface-actor.h"
 
 #include "clutter/clutter.h"
+#include "clutter/clutter-mutter.h"
 #include "compositor/clutter-utils.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-shaped-texture-private.h"
@@ -440,8 +441,13 @@ meta_surface_actor_update_area (MetaSurfaceActor   *self,
 
   if (meta_shaped_texture_update_area (priv->texture, area, &clip))
     {
+      MetaWindowActor *window_actor;
       MtkRegion *unobscured_region;
 
+      window_actor = meta_window_actor_from_actor (CLUTTER_ACTOR (self));
+      if (window_actor && meta_window_actor_is_streaming (window_actor))
+        meta_window_actor_add_screen_cast_damage (window_actor, self, &clip);
+
       unobscured_region = effective_unobscured_region (self);
 
       if (unobscured_region)
@@ -502,6 +508,26 @@ meta_surface_actor_is_effectively_obscured (MetaSurfaceActor *surface_actor)
     return priv->is_obscured;
 }
 
+/*
+ * Whether nothing of the surface actor would currently end up on screen,
+ * either because it is not mapped, or because it was fully culled by the
+ * last paint. Mapped clones always make the surface visible.
+ */
+gboolean
+meta_surface_actor_is_effectively_hidden (MetaSurfaceActor *surface_actor)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (surface_actor);
+  MtkRegion *unobscured_region;
+
+  if (!clutter_actor_is_mapped (actor) &&
+      !clutter_actor_has_mapped_clones (actor))
+    return TRUE;
+
+  unobscured_region = effective_unobscured_region (surface_actor);
+
+  return unobscured_region && mtk_region_is_empty (unobscured_region);
+}
+
 gboolean
 meta_surface_actor_is_obscured_on_stage_view (MetaSurfaceActor *self,
                                               ClutterStageView *stage_view,
@@ -599,6 +625,8 @@ meta_surface_actor_set_input_region (MetaSurfaceActor *self,
     priv->input_region = mtk_region_ref (region);
   else
     priv->input_region = NULL;
+
+  clutter_actor_invalidate_pick (CLUTTER_ACTOR (self));
 }
 
 void
@@ -33,6 +33,8 @@ gboolean meta_surface_actor_is_obscured (MetaSurfaceActor *self);
 
 gboolean meta_surface_actor_is_effectively_obscured (MetaSurfaceActor *self);
 
+gboolean meta_surface_actor_is_effectively_hidden (MetaSurfaceActor *self);
+
 gboolean meta_surface_actor_is_obscured_on_stage_view (MetaSurfaceActor *self,
                                                        ClutterStageView *stage_view,
                                                        float            *unobscurred_fraction);
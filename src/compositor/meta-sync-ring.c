@@ -47,16 +47,24 @@
  * to the next fence in the ring. For each fence we do:
  *
  * 1. fence is XSyncTriggerFence()'d and glWaitSync()'d
- * 2. NUM_SYNCS / 2 frames later, fence should be triggered
+ * 2. MIN_PENDING_SYNCS frames later, fence should be triggered
  * 3. fence is XSyncResetFence()'d
- * 4. NUM_SYNCS / 2 frames later, fence should be reset
+ * 4. by the time the ring wraps around, fence should be reset
  * 5. go back to 1 and re-use fence
  *
  * glClientWaitSync() and XAlarms are used in steps 2 and 4,
  * respectively, to double-check the expectections.
+ *
+ * If the GPU is running behind and the fence isn't triggered yet in
+ * step 2, we don't wait for it, but check again on the following
+ * frames. Only once it is MAX_PENDING_SYNCS frames old, leaving just
+ * enough frames for the reset to complete before the fence is reused,
+ * we block on it.
  */
 
-#define NUM_SYNCS 10
+#define NUM_SYNCS 16
+#define MIN_PENDING_SYNCS (NUM_SYNCS / 2)
+#define MAX_PENDING_SYNCS (NUM_SYNCS - 3)
 #define MAX_SYNC_WAIT_TIME (1 * 1000 * 1000 * 1000) /* one sec */
 #define MAX_REBOOT_ATTEMPTS 2
 
@@ -94,7 +102,7 @@ typedef struct
   MetaSync *syncs_array[NUM_SYNCS];
   guint current_sync_idx;
   MetaSync *current_sync;
-  guint warmup_syncs;
+  guint n_pending_syncs;
 
   guint reboots;
 } MetaSyncRing;
@@ -444,7 +452,7 @@ meta_sync_ring_init (CoglContext *ctx,
 
   ring->current_sync_idx = 0;
   ring->current_sync = ring->syncs_array[0];
-  ring->warmup_syncs = 0;
+  ring->n_pending_syncs = 0;
 
   return TRUE;
 }
@@ -462,7 +470,7 @@ meta_sync_ring_destroy (void)
 
   ring->current_sync_idx = 0;
   ring->current_sync = NULL;
-  ring->warmup_syncs = 0;
+  ring->n_pending_syncs = 0;
 
   for (i = 0; i < NUM_SYNCS; ++i)
     meta_sync_free (ring->syncs_array[i]);
@@ -506,14 +514,20 @@ meta_sync_ring_after_frame (CoglContext *ctx)
 
   g_return_val_if_fail (ring->xdisplay != NULL, FALSE);
 
-  if (ring->warmup_syncs >= NUM_SYNCS / 2)
+  ring->n_pending_syncs += 1;
+
+  while (ring->n_pending_syncs > MIN_PENDING_SYNCS)
     {
-      guint reset_sync_idx = (ring->current_sync_idx + NUM_SYNCS - (NUM_SYNCS / 2)) % NUM_SYNCS;
+      guint reset_sync_idx = (ring->current_sync_idx + NUM_SYNCS -
+                              (ring->n_pending_syncs - 1)) % NUM_SYNCS;
       MetaSync *sync_to_reset = ring->syncs_array[reset_sync_idx];
 
       GLenum status = meta_sync_check_update_finished (sync_to_reset, 0);
       if (status == GL_TIMEOUT_EXPIRED)
         {
+          if (ring->n_pending_syncs <= MAX_PENDING_SYNCS)
+            break;
+
           meta_warning ("MetaSyncRing: We should never wait for a sync -- add more syncs?");
           status = meta_sync_check_update_finished (sync_to_reset, MAX_SYNC_WAIT_TIME);
         }
@@ -525,10 +539,7 @@ meta_sync_ring_after_frame (CoglContext *ctx)
         }
 
       meta_sync_reset (sync_to_reset);
-    }
-  else
-    {
-      ring->warmup_syncs += 1;
+      ring->n_pending_syncs -= 1;
     }
 
   ring->current_sync_idx += 1;
@@ -30,6 +30,10 @@
 #include <math.h>
 #include <string.h>
 
+/* How many mipmap texture pixels may be redrawn per frame, shared between
+ * all mipmaps. Anything beyond that is left for the following frames. */
+#define MIPMAP_FRAME_BUDGET_PIXELS (1920 * 1080)
+
 struct _MetaTextureMipmap
 {
   MetaMultiTexture *base_texture;
@@ -38,8 +42,19 @@ struct _MetaTextureMipmap
   CoglFramebuffer *fb;
   CoglContext *cogl_context;
   gboolean invalid;
+
+  /* Parts of the mipmap texture still to be redrawn */
+  MtkRegion *damage;
+
+  /* Whether the mipmap texture was completely drawn at least once */
+  gboolean ready;
 };
 
+static struct {
+  int64_t frame_count;
+  int64_t pixels_left;
+} frame_budget = { -1, 0 };
+
 /**
  * meta_texture_mipmap_new:
  *
@@ -74,6 +89,7 @@ meta_texture_mipmap_free (MetaTextureMipmap *mipmap)
   g_clear_object (&mipmap->base_texture);
   g_clear_object (&mipmap->mipmap_texture);
   g_clear_object (&mipmap->fb);
+  g_clear_pointer (&mipmap->damage, mtk_region_unref);
 
   g_free (mipmap);
 }
@@ -116,11 +132,71 @@ meta_texture_mipmap_invalidate (MetaTextureMipmap *mipmap)
   mipmap->invalid = TRUE;
 }
 
+/**
+ * meta_texture_mipmap_invalidate_area:
+ * @mipmap: a #MetaTextureMipmap
+ * @area: the changed area of the base texture
+ *
+ * Marks @area of the base texture as changed, so only the part of the
+ * mipmap derived from it gets redrawn.
+ */
+void
+meta_texture_mipmap_invalidate_area (MetaTextureMipmap  *mipmap,
+                                     const MtkRectangle *area)
+{
+  MtkRectangle mipmap_area;
+
+  g_return_if_fail (mipmap != NULL);
+
+  if (mipmap->invalid || !mipmap->mipmap_texture)
+    return;
+
+  /* Each mipmap texture pixel is sampled from a roughly 2x2 block of the
+   * base texture; pad by a pixel for odd sized base textures, where the
+   * blocks don't line up exactly. */
+  mipmap_area = (MtkRectangle) {
+    .x = area->x / 2 - 1,
+    .y = area->y / 2 - 1,
+    .width = (area->x + area->width + 1) / 2 - area->x / 2 + 2,
+    .height = (area->y + area->height + 1) / 2 - area->y / 2 + 2,
+  };
+
+  if (!mipmap->damage)
+    mipmap->damage = mtk_region_create_rectangle (&mipmap_area);
+  else
+    mtk_region_union_rectangle (mipmap->damage, &mipmap_area);
+}
+
+/**
+ * meta_texture_mipmap_is_pending:
+ * @mipmap: a #MetaTextureMipmap
+ *
+ * Return value: %TRUE if parts of the mipmap are not up to date yet,
+ *   because they didn't fit in the budget of the frames they were
+ *   requested in.
+ */
+gboolean
+meta_texture_mipmap_is_pending (MetaTextureMipmap *mipmap)
+{
+  g_return_val_if_fail (mipmap != NULL, FALSE);
+
+  return mipmap->invalid || mipmap->damage != NULL;
+}
+
 static void
 free_mipmaps (MetaTextureMipmap *mipmap)
 {
+  if (mipmap->mipmap_texture)
+    {
+      CoglTexture *tex = meta_multi_texture_get_plane (mipmap->mipmap_texture, 0);
+
+      cogl_texture_set_evict_func (tex, NULL, NULL);
+    }
+
   g_clear_object (&mipmap->fb);
   g_clear_object (&mipmap->mipmap_texture);
+  g_clear_pointer (&mipmap->damage, mtk_region_unref);
+  mipmap->ready = FALSE;
 }
 
 void
@@ -132,7 +208,128 @@ meta_texture_mipmap_clear (MetaTextureMipmap *mipmap)
 }
 
 static void
-ensure_mipmap_texture (MetaTextureMipmap *mipmap)
+ensure_pipeline (MetaTextureMipmap *mipmap)
+{
+  int n_planes, i;
+
+  n_planes = meta_multi_texture_get_n_planes (mipmap->base_texture);
+
+  if (!mipmap->pipeline)
+    {
+      MetaMultiTextureFormat format =
+        meta_multi_texture_get_format (mipmap->base_texture);
+      CoglSnippet *fragment_globals_snippet;
+      CoglSnippet *fragment_snippet;
+
+      mipmap->pipeline = cogl_pipeline_new (mipmap->cogl_context);
+      cogl_pipeline_set_blend (mipmap->pipeline,
+                               "RGBA = ADD (SRC_COLOR, 0)",
+                               NULL);
+
+      for (i = 0; i < n_planes; i++)
+        {
+          cogl_pipeline_set_layer_filters (mipmap->pipeline, i,
+                                           COGL_PIPELINE_FILTER_LINEAR,
+                                           COGL_PIPELINE_FILTER_LINEAR);
+          cogl_pipeline_set_layer_combine (mipmap->pipeline, i,
+                                           "RGBA = REPLACE(TEXTURE)",
+                                           NULL);
+        }
+
+      meta_multi_texture_format_get_snippets (format,
+                                              &fragment_globals_snippet,
+                                              &fragment_snippet);
+      cogl_pipeline_add_snippet (mipmap->pipeline, fragment_globals_snippet);
+      cogl_pipeline_add_snippet (mipmap->pipeline, fragment_snippet);
+      meta_multi_texture_format_set_conversion_uniforms (format,
+                                                         mipmap->pipeline,
+                                                         META_MULTI_TEXTURE_COEFFICIENTS_BT601,
+                                                         META_MULTI_TEXTURE_RANGE_LIMITED);
+
+      g_clear_object (&fragment_globals_snippet);
+      g_clear_object (&fragment_snippet);
+    }
+
+  for (i = 0; i < n_planes; i++)
+    {
+      CoglTexture *plane = meta_multi_texture_get_plane (mipmap->base_texture, i);
+
+      cogl_pipeline_set_layer_texture (mipmap->pipeline, i, plane);
+    }
+}
+
+static void
+draw_rectangle (MetaTextureMipmap  *mipmap,
+                const MtkRectangle *rect,
+                int                 width,
+                int                 height)
+{
+  cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
+                                            mipmap->pipeline,
+                                            rect->x,
+                                            rect->y,
+                                            rect->x + rect->width,
+                                            rect->y + rect->height,
+                                            (float) rect->x / width,
+                                            (float) rect->y / height,
+                                            (float) (rect->x + rect->width) / width,
+                                            (float) (rect->y + rect->height) / height);
+}
+
+/* Redraws the damaged parts of the mipmap texture, at most @budget pixels
+ * of them, and returns how many pixels were drawn. */
+static int64_t
+draw_damage (MetaTextureMipmap *mipmap,
+             int64_t            budget)
+{
+  int width = meta_multi_texture_get_width (mipmap->mipmap_texture);
+  int height = meta_multi_texture_get_height (mipmap->mipmap_texture);
+  MtkRectangle mipmap_rect = { 0, 0, width, height };
+  int64_t drawn = 0;
+
+  mtk_region_intersect_rectangle (mipmap->damage, &mipmap_rect);
+
+  ensure_pipeline (mipmap);
+
+  while (drawn < budget && !mtk_region_is_empty (mipmap->damage))
+    {
+      MtkRectangle rect;
+      int64_t area;
+
+      rect = mtk_region_get_rectangle (mipmap->damage, 0);
+      area = (int64_t) rect.width * rect.height;
+
+      /* Only draw as many rows as still fit, but always make progress */
+      if (drawn + area > budget)
+        rect.height = (int) MAX ((budget - drawn) / rect.width, 1);
+
+      draw_rectangle (mipmap, &rect, width, height);
+      mtk_region_subtract_rectangle (mipmap->damage, &rect);
+      drawn += (int64_t) rect.width * rect.height;
+    }
+
+  if (mtk_region_is_empty (mipmap->damage))
+    {
+      g_clear_pointer (&mipmap->damage, mtk_region_unref);
+      mipmap->ready = TRUE;
+    }
+
+  return drawn;
+}
+
+static void
+mipmap_texture_evicted (CoglTexture *texture,
+                        gpointer     user_data)
+{
+  MetaTextureMipmap *mipmap = user_data;
+
+  /* Painting falls back to the base texture until the mipmap is redrawn */
+  free_mipmaps (mipmap);
+}
+
+static void
+ensure_mipmap_texture (MetaTextureMipmap *mipmap,
+                       int64_t           *budget)
 {
   int width, height;
 
@@ -196,66 +393,29 @@ ensure_mipmap_texture (MetaTextureMipmap *mipmap)
       cogl_framebuffer_orthographic (mipmap->fb,
                                      0, 0, width, height, -1.0, 1.0);
 
+      cogl_texture_set_memory_category (tex, COGL_TEXTURE_MEMORY_CATEGORY_CACHE);
+      cogl_texture_set_evict_func (tex, mipmap_texture_evicted, mipmap);
+
       mipmap->invalid = TRUE;
     }
 
   if (mipmap->invalid)
     {
-      int n_planes, i;
-
-      n_planes = meta_multi_texture_get_n_planes (mipmap->base_texture);
-
-      if (!mipmap->pipeline)
-        {
-          MetaMultiTextureFormat format =
-            meta_multi_texture_get_format (mipmap->base_texture);
-          CoglSnippet *fragment_globals_snippet;
-          CoglSnippet *fragment_snippet;
-
-          mipmap->pipeline = cogl_pipeline_new (mipmap->cogl_context);
-          cogl_pipeline_set_blend (mipmap->pipeline,
-                                   "RGBA = ADD (SRC_COLOR, 0)",
-                                   NULL);
-
-          for (i = 0; i < n_planes; i++)
-            {
-              cogl_pipeline_set_layer_filters (mipmap->pipeline, i,
-                                               COGL_PIPELINE_FILTER_LINEAR,
-                                               COGL_PIPELINE_FILTER_LINEAR);
-              cogl_pipeline_set_layer_combine (mipmap->pipeline, i,
-                                               "RGBA = REPLACE(TEXTURE)",
-                                               NULL);
-            }
-
-          meta_multi_texture_format_get_snippets (format,
-                                                  &fragment_globals_snippet,
-                                                  &fragment_snippet);
-          cogl_pipeline_add_snippet (mipmap->pipeline, fragment_globals_snippet);
-          cogl_pipeline_add_snippet (mipmap->pipeline, fragment_snippet);
-
-          g_clear_object (&fragment_globals_snippet);
-          g_clear_object (&fragment_snippet);
-        }
-
-      for (i = 0; i < n_planes; i++)
-        {
-          CoglTexture *plane = meta_multi_texture_get_plane (mipmap->base_texture, i);
-
-          cogl_pipeline_set_layer_texture (mipmap->pipeline, i, plane);
-        }
-
-      cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
-                                                mipmap->pipeline,
-                                                0, 0, width, height,
-                                                0.0, 0.0, 1.0, 1.0);
+      MtkRectangle mipmap_rect = { 0, 0, width, height };
 
+      g_clear_pointer (&mipmap->damage, mtk_region_unref);
+      mipmap->damage = mtk_region_create_rectangle (&mipmap_rect);
       mipmap->invalid = FALSE;
     }
+
+  if (mipmap->damage)
+    *budget -= draw_damage (mipmap, *budget);
 }
 
 /**
  * meta_texture_tower_get_paint_texture:
  * @mipmap: a #MetaTextureMipmap
+ * @frame: (nullable): the frame being painted
  *
  * Gets the texture from the tower that best matches the current
  * rendering scale. (On the assumption here the texture is going to
@@ -263,15 +423,55 @@ ensure_mipmap_texture (MetaTextureMipmap *mipmap)
  * size in pixels, so a 200x200 texture will be rendered on the
  * rectangle (0, 0, 200, 200).
  *
+ * Redrawing the mipmap is spread over frames: each @frame only gets a
+ * limited budget shared by all mipmaps, and parts that don't fit keep
+ * their previous contents until a later frame, see
+ * meta_texture_mipmap_is_pending(). Without a @frame, e.g. when painting
+ * offscreen, the mipmap is always brought fully up to date.
+ *
  * Return value: the COGL texture handle to use for painting, or
- *  %NULL if no base texture has yet been set.
+ *  %NULL if no base texture has yet been set, or the mipmap was never
+ *  completely drawn yet.
  */
 MetaMultiTexture *
-meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipmap)
+meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipmap,
+                                       ClutterFrame      *frame)
 {
+  int64_t budget;
+
   g_return_val_if_fail (mipmap != NULL, NULL);
 
-  ensure_mipmap_texture (mipmap);
+  if (frame)
+    {
+      int64_t frame_count = clutter_frame_get_count (frame);
+
+      if (frame_budget.frame_count != frame_count)
+        {
+          frame_budget.frame_count = frame_count;
+          frame_budget.pixels_left = MIPMAP_FRAME_BUDGET_PIXELS;
+        }
+
+      budget = MAX (frame_budget.pixels_left, 0);
+    }
+  else
+    {
+      budget = G_MAXINT64;
+    }
+
+  if (budget > 0)
+    {
+      int64_t pixels_left = budget;
+
+      ensure_mipmap_texture (mipmap, &pixels_left);
+
+      if (frame)
+        frame_budget.pixels_left -= budget - pixels_left;
+    }
+
+  if (!mipmap->ready)
+    return NULL;
+
+  cogl_texture_mark_used (meta_multi_texture_get_plane (mipmap->mipmap_texture, 0));
 
   return mipmap->mipmap_texture;
 }
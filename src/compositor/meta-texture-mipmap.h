@@ -44,10 +44,16 @@ void meta_texture_mipmap_free (MetaTextureMipmap *mipmap);
 void meta_texture_mipmap_set_base_texture (MetaTextureMipmap *mipmap,
                                            MetaMultiTexture  *texture);
 
-MetaMultiTexture *meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipmap);
+MetaMultiTexture *meta_texture_mipmap_get_paint_texture (MetaTextureMipmap *mipmap,
+                                                         ClutterFrame      *frame);
 
 void meta_texture_mipmap_invalidate (MetaTextureMipmap *mipmap);
 
+void meta_texture_mipmap_invalidate_area (MetaTextureMipmap  *mipmap,
+                                          const MtkRectangle *area);
+
+gboolean meta_texture_mipmap_is_pending (MetaTextureMipmap *mipmap);
+
 void meta_texture_mipmap_clear (MetaTextureMipmap *mipmap);
 
 G_END_DECLS
@@ -83,6 +83,8 @@ MetaSurfaceActor *meta_window_actor_get_surface (MetaWindowActor *self);
 
 MetaSurfaceActor *meta_window_actor_get_scanout_candidate (MetaWindowActor *self);
 
+gboolean meta_window_actor_is_single_surface_actor (MetaWindowActor *self);
+
 void meta_window_actor_assign_surface_actor (MetaWindowActor  *self,
                                              MetaSurfaceActor *surface_actor);
 
@@ -101,6 +103,10 @@ gboolean meta_window_actor_is_streaming (MetaWindowActor *window_actor);
 
 void meta_window_actor_notify_damaged (MetaWindowActor *window_actor);
 
+void meta_window_actor_add_screen_cast_damage (MetaWindowActor    *window_actor,
+                                               MetaSurfaceActor   *surface_actor,
+                                               const MtkRectangle *area);
+
 gboolean meta_window_actor_is_frozen (MetaWindowActor *self);
 
 gboolean meta_window_actor_is_opaque (MetaWindowActor *self);
@@ -181,14 +181,14 @@ meta_surface_container_actor_wayland_init (MetaSurfaceContainerActorWayland *sel
 }
 
 static gboolean
-get_surface_actor_list (GNode    *node,
-                        gpointer  data)
+get_surface_actor_set (GNode    *node,
+                       gpointer  data)
 {
   MetaWaylandSurface *surface = node->data;
   MetaSurfaceActor *surface_actor = meta_wayland_surface_get_actor (surface);
-  GList **surface_actors = data;
+  GHashTable *surface_actors = data;
 
-  *surface_actors = g_list_prepend (*surface_actors, surface_actor);
+  g_hash_table_add (surface_actors, surface_actor);
   return FALSE;
 }
 
@@ -237,17 +237,18 @@ meta_window_actor_wayland_rebuild_surface_tree (MetaWindowActor *actor)
   MetaWaylandSurface *surface = meta_surface_actor_wayland_get_surface (
     META_SURFACE_ACTOR_WAYLAND (surface_actor));
   GNode *root_node = surface->applied_state.subsurface_branch_node;
-  g_autoptr (GList) surface_actors = NULL;
+  g_autoptr (GHashTable) surface_actors = NULL;
   g_autoptr (GList) children = NULL;
   GList *l;
   SurfaceTreeTraverseData traverse_data;
 
+  surface_actors = g_hash_table_new (NULL, NULL);
   g_node_traverse (root_node,
                    G_IN_ORDER,
                    G_TRAVERSE_LEAVES,
                    -1,
-                   get_surface_actor_list,
-                   &surface_actors);
+                   get_surface_actor_set,
+                   surface_actors);
 
   children =
     clutter_actor_get_children (CLUTTER_ACTOR (self->surface_container));
@@ -255,7 +256,7 @@ meta_window_actor_wayland_rebuild_surface_tree (MetaWindowActor *actor)
     {
       ClutterActor *child_actor = l->data;
 
-      if (!g_list_find (surface_actors, child_actor))
+      if (!g_hash_table_contains (surface_actors, child_actor))
         {
           MetaSurfaceActor *child_surface_actor = META_SURFACE_ACTOR (child_actor);
 
@@ -344,6 +345,23 @@ cullable_iface_init (MetaCullableInterface *iface)
   iface->cull_redraw_clip = meta_window_actor_wayland_cull_redraw_clip;
 }
 
+static gboolean
+surface_actor_covers_window_actor (MetaSurfaceActor *surface_actor,
+                                   MetaWindowActor  *window_actor)
+{
+  ClutterActorBox window_box;
+  ClutterActorBox surface_box;
+
+  return clutter_actor_get_paint_box (CLUTTER_ACTOR (window_actor),
+                                      &window_box) &&
+         clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor),
+                                      &surface_box) &&
+         G_APPROX_VALUE (window_box.x1, surface_box.x1, CLUTTER_COORDINATE_EPSILON) &&
+         G_APPROX_VALUE (window_box.y1, surface_box.y1, CLUTTER_COORDINATE_EPSILON) &&
+         G_APPROX_VALUE (window_box.x2, surface_box.x2, CLUTTER_COORDINATE_EPSILON) &&
+         G_APPROX_VALUE (window_box.y2, surface_box.y2, CLUTTER_COORDINATE_EPSILON);
+}
+
 static MetaSurfaceActor *
 meta_window_actor_wayland_get_scanout_candidate (MetaWindowActor *actor)
 {
@@ -354,8 +372,6 @@ meta_window_actor_wayland_get_scanout_candidate (MetaWindowActor *actor)
   MetaSurfaceActor *topmost_surface_actor = NULL;
   int n_visible_surface_actors = 0;
   MetaWindow *window;
-  ClutterActorBox window_box;
-  ClutterActorBox surface_box;
 
   if (clutter_actor_get_last_child (CLUTTER_ACTOR (self)) != surface_container)
     {
@@ -425,13 +441,7 @@ meta_window_actor_wayland_get_scanout_candidate (MetaWindowActor *actor)
     }
 
   if (meta_surface_actor_is_opaque (topmost_surface_actor) &&
-      clutter_actor_get_paint_box (CLUTTER_ACTOR (actor), &window_box) &&
-      clutter_actor_get_paint_box (CLUTTER_ACTOR (topmost_surface_actor),
-                                   &surface_box) &&
-      G_APPROX_VALUE (window_box.x1, surface_box.x1, CLUTTER_COORDINATE_EPSILON) &&
-      G_APPROX_VALUE (window_box.y1, surface_box.y1, CLUTTER_COORDINATE_EPSILON) &&
-      G_APPROX_VALUE (window_box.x2, surface_box.x2, CLUTTER_COORDINATE_EPSILON) &&
-      G_APPROX_VALUE (window_box.y2, surface_box.y2, CLUTTER_COORDINATE_EPSILON))
+      surface_actor_covers_window_actor (topmost_surface_actor, actor))
     return topmost_surface_actor;
 
   meta_topic (META_DEBUG_RENDER,
@@ -439,6 +449,72 @@ meta_window_actor_wayland_get_scanout_candidate (MetaWindowActor *actor)
   return NULL;
 }
 
+/*
+ * Finds the surface of a fullscreen window that can be scanned out on the
+ * primary plane when the single subsurface shown on top of it, e.g. the
+ * controls of a video player, is put on an overlay plane.
+ */
+MetaSurfaceActor *
+meta_window_actor_wayland_get_scanout_candidate_with_overlay (MetaWindowActorWayland  *self,
+                                                               MetaSurfaceActor       **overlay_surface_actor)
+{
+  MetaWindowActor *actor = META_WINDOW_ACTOR (self);
+  ClutterActor *surface_container = CLUTTER_ACTOR (self->surface_container);
+  MetaSurfaceActor *surface_actors[2];
+  ClutterActor *child_actor;
+  ClutterActorIter iter;
+  int n_visible_surface_actors = 0;
+  MetaWindow *window;
+
+  if (clutter_actor_get_last_child (CLUTTER_ACTOR (self)) != surface_container)
+    return NULL;
+
+  window = meta_window_actor_get_meta_window (actor);
+  if (!window || !meta_window_is_fullscreen (window))
+    return NULL;
+
+  clutter_actor_iter_init (&iter, surface_container);
+  while (clutter_actor_iter_next (&iter, &child_actor))
+    {
+      MetaSurfaceActor *surface_actor;
+
+      if (!clutter_actor_is_mapped (child_actor))
+        continue;
+
+      surface_actor = META_SURFACE_ACTOR (child_actor);
+      if (meta_surface_actor_is_obscured (surface_actor))
+        continue;
+
+      if (n_visible_surface_actors == G_N_ELEMENTS (surface_actors))
+        return NULL;
+
+      surface_actors[n_visible_surface_actors++] = surface_actor;
+    }
+
+  if (n_visible_surface_actors != G_N_ELEMENTS (surface_actors))
+    return NULL;
+
+  if (!meta_surface_actor_is_opaque (surface_actors[0]) ||
+      !surface_actor_covers_window_actor (surface_actors[0], actor))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Bottom surface-actor of window-actor can't be scanned out");
+      return NULL;
+    }
+
+  /* The overlay plane isn't blended with the surface below it. */
+  if (!meta_surface_actor_is_opaque (surface_actors[1]) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (surface_actors[1])) != 0xff)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Top surface-actor of window-actor not opaque");
+      return NULL;
+    }
+
+  *overlay_surface_actor = surface_actors[1];
+  return surface_actors[0];
+}
+
 static void
 meta_window_actor_wayland_assign_surface_actor (MetaWindowActor  *actor,
                                                 MetaSurfaceActor *surface_actor)
@@ -466,10 +542,49 @@ meta_window_actor_wayland_queue_frame_drawn (MetaWindowActor *actor,
 {
 }
 
+static void
+flush_deferred_damage (MetaWindowActorWayland *self,
+                       gboolean                visible_only)
+{
+  ClutterActor *child;
+  ClutterActorIter iter;
+
+  clutter_actor_iter_init (&iter, CLUTTER_ACTOR (self->surface_container));
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      MetaSurfaceActorWayland *surface_actor = META_SURFACE_ACTOR_WAYLAND (child);
+      MetaWaylandSurface *surface;
+
+      if (visible_only &&
+          meta_surface_actor_is_effectively_hidden (META_SURFACE_ACTOR (surface_actor)))
+        continue;
+
+      surface = meta_surface_actor_wayland_get_surface (surface_actor);
+      if (surface)
+        meta_wayland_surface_flush_deferred_damage (surface);
+    }
+}
+
+/*
+ * Uploads the damage deferred while the window was hidden, so that
+ * showing it again, e.g. when switching to its workspace, doesn't have
+ * to upload it all in the first frame.
+ */
+void
+meta_window_actor_wayland_prewarm (MetaWindowActorWayland *self)
+{
+  flush_deferred_damage (self, FALSE);
+}
+
 static void
 meta_window_actor_wayland_before_paint (MetaWindowActor  *actor,
                                         ClutterStageView *stage_view)
 {
+  MetaWindowActorWayland *self = META_WINDOW_ACTOR_WAYLAND (actor);
+
+  /* Culling just happened, so this is the last chance for surfaces that
+   * became visible to upload the damage deferred while they were hidden. */
+  flush_deferred_damage (self, TRUE);
 }
 
 static void
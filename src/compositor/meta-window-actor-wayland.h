@@ -35,3 +35,8 @@ G_DECLARE_FINAL_TYPE (MetaSurfaceContainerActorWayland,
                       ClutterActor)
 
 void meta_window_actor_wayland_rebuild_surface_tree (MetaWindowActor *actor);
+
+void meta_window_actor_wayland_prewarm (MetaWindowActorWayland *self);
+
+MetaSurfaceActor * meta_window_actor_wayland_get_scanout_candidate_with_overlay (MetaWindowActorWayland  *self,
+                                                                                 MetaSurfaceActor       **overlay_surface_actor);
@@ -75,6 +75,18 @@ struct _MetaWindowActorX11
   /* The frame region */
   MtkRegion *frame_bounds;
 
+  /* What the current mask texture was built from, and the shape region
+   * it resulted in, to not build it again when only the frame state or
+   * the client shape generation changed, but not the shape itself. */
+  struct {
+    MetaShapedTexture *stex;
+    int width;
+    int height;
+    MtkRectangle client_area;
+    MtkRegion *input_region;
+    MtkRegion *shape_region;
+  } frame_mask;
+
   /* Extracted size-invariant shape used for shadows */
   MetaWindowShape *shadow_shape;
 
@@ -785,6 +797,26 @@ region_to_cairo_path (MtkRegion *region,
     }
 }
 
+static void
+get_frame_mask_client_area (MetaWindowActorX11 *actor_x11,
+                            MetaShapedTexture  *stex,
+                            MtkRectangle       *client_area)
+{
+  MetaWindow *window =
+    meta_window_actor_get_meta_window (META_WINDOW_ACTOR (actor_x11));
+
+  /* If we update the shape regardless of the frozen state of the actor,
+   * as with Xwayland to avoid the black shadow effect, we ought to base
+   * the frame size on the buffer size rather than the reported window's
+   * frame size, as the buffer may not have been committed yet at this
+   * point.
+   */
+  if (meta_window_x11_always_update_shape (window))
+    get_client_area_rect_from_texture (actor_x11, stex, client_area);
+  else
+    meta_window_get_client_area_rect (window, client_area);
+}
+
 static void
 build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
                            MtkRegion          *shape_region)
@@ -836,24 +868,8 @@ build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
       g_autoptr (MtkRegion) scanned_region = NULL;
       MtkRectangle rect = { 0, 0, tex_width, tex_height };
       MtkRectangle client_area;
-      MtkRectangle frame_rect;
 
-      /* If we update the shape regardless of the frozen state of the actor,
-       * as with Xwayland to avoid the black shadow effect, we ought to base
-       * the frame size on the buffer size rather than the reported window's
-       * frame size, as the buffer may not have been committed yet at this
-       * point.
-       */
-      if (meta_window_x11_always_update_shape (window))
-        {
-          meta_window_x11_surface_rect_to_frame_rect (window, &rect, &frame_rect);
-          get_client_area_rect_from_texture (actor_x11, stex, &client_area);
-        }
-      else
-        {
-          meta_window_get_frame_rect (window, &frame_rect);
-          meta_window_get_client_area_rect (window, &client_area);
-        }
+      get_frame_mask_client_area (actor_x11, stex, &client_area);
 
       /* Make sure we don't paint the frame over the client window. */
       frame_paint_region = mtk_region_create_rectangle (&rect);
@@ -913,6 +929,41 @@ invalidate_shadow (MetaWindowActorX11 *actor_x11)
   clutter_actor_invalidate_paint_volume (CLUTTER_ACTOR (actor_x11));
 }
 
+static void
+clear_frame_mask (MetaWindowActorX11 *actor_x11)
+{
+  g_clear_weak_pointer (&actor_x11->frame_mask.stex);
+  g_clear_pointer (&actor_x11->frame_mask.input_region, mtk_region_unref);
+  g_clear_pointer (&actor_x11->frame_mask.shape_region, mtk_region_unref);
+}
+
+static gboolean
+is_frame_mask_valid (MetaWindowActorX11 *actor_x11,
+                     MtkRegion          *region)
+{
+  MetaSurfaceActor *surface =
+    meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
+  MetaShapedTexture *stex;
+  MtkRectangle client_area;
+
+  if (!actor_x11->frame_mask.shape_region)
+    return FALSE;
+
+  stex = meta_surface_actor_get_texture (surface);
+  if (stex != actor_x11->frame_mask.stex)
+    return FALSE;
+
+  if (meta_shaped_texture_get_width (stex) != actor_x11->frame_mask.width ||
+      meta_shaped_texture_get_height (stex) != actor_x11->frame_mask.height)
+    return FALSE;
+
+  get_frame_mask_client_area (actor_x11, stex, &client_area);
+  if (!mtk_rectangle_equal (&client_area, &actor_x11->frame_mask.client_area))
+    return FALSE;
+
+  return mtk_region_equal (region, actor_x11->frame_mask.input_region);
+}
+
 static void
 update_shape_region (MetaWindowActorX11 *actor_x11)
 {
@@ -943,7 +994,36 @@ update_shape_region (MetaWindowActorX11 *actor_x11)
     }
 
   if (priv->shape_region || frame)
-    build_and_scan_frame_mask (actor_x11, region);
+    {
+      if (is_frame_mask_valid (actor_x11, region))
+        {
+          g_clear_pointer (&region, mtk_region_unref);
+          region = mtk_region_ref (actor_x11->frame_mask.shape_region);
+        }
+      else
+        {
+          MetaSurfaceActor *surface =
+            meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
+          MetaShapedTexture *stex = meta_surface_actor_get_texture (surface);
+          g_autoptr (MtkRegion) input_region = NULL;
+
+          input_region = mtk_region_copy (region);
+          build_and_scan_frame_mask (actor_x11, region);
+
+          clear_frame_mask (actor_x11);
+          g_set_weak_pointer (&actor_x11->frame_mask.stex, stex);
+          actor_x11->frame_mask.width = meta_shaped_texture_get_width (stex);
+          actor_x11->frame_mask.height = meta_shaped_texture_get_height (stex);
+          get_frame_mask_client_area (actor_x11, stex,
+                                      &actor_x11->frame_mask.client_area);
+          actor_x11->frame_mask.input_region = g_steal_pointer (&input_region);
+          actor_x11->frame_mask.shape_region = mtk_region_ref (region);
+        }
+    }
+  else
+    {
+      clear_frame_mask (actor_x11);
+    }
 
   g_clear_pointer (&actor_x11->shape_region, mtk_region_unref);
   actor_x11->shape_region = region;
@@ -1511,6 +1591,7 @@ meta_window_actor_x11_dispose (GObject *object)
   g_clear_pointer (&actor_x11->shape_region, mtk_region_unref);
   g_clear_pointer (&actor_x11->shadow_clip, mtk_region_unref);
   g_clear_pointer (&actor_x11->frame_bounds, mtk_region_unref);
+  clear_frame_mask (actor_x11);
 
   g_clear_pointer (&actor_x11->focused_shadow, meta_shadow_unref);
   g_clear_pointer (&actor_x11->unfocused_shadow, meta_shadow_unref);
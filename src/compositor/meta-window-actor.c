@@ -75,6 +75,9 @@ typedef struct _MetaWindowActorPrivate
   guint             freeze_count;
   guint             screen_cast_usage_count;
 
+  /* Damage in buffer coordinates reported with the next damaged signal */
+  MtkRegion        *screen_cast_damage;
+
   guint		    visible                : 1;
   guint		    disposed               : 1;
 
@@ -243,6 +246,33 @@ window_appears_focused_notify (MetaWindow *mw,
   clutter_actor_queue_redraw (CLUTTER_ACTOR (data));
 }
 
+static void
+release_surface_actor_mipmaps (MetaSurfaceActor *surface_actor)
+{
+  MetaShapedTexture *stex = meta_surface_actor_get_texture (surface_actor);
+
+  meta_shaped_texture_release_mipmaps (stex);
+}
+
+static void
+window_suspend_state_notify (MetaWindow      *window,
+                             GParamSpec      *pspec,
+                             MetaWindowActor *self)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (self);
+
+  /* A suspended window has been hidden for a while; nothing to scale
+   * down is painted until it is shown again, so the mipmaps would only
+   * take texture memory. They are redrawn when next needed. */
+  if (!meta_window_is_suspended (window))
+    return;
+
+  g_ptr_array_foreach (priv->surface_actors,
+                       (GFunc) release_surface_actor_mipmaps,
+                       NULL);
+}
+
 gboolean
 meta_window_actor_is_opaque (MetaWindowActor *self)
 {
@@ -575,6 +605,7 @@ meta_window_actor_dispose (GObject *object)
                        (GFunc) disconnect_surface_actor_from,
                        self);
   g_clear_pointer (&priv->surface_actors, g_ptr_array_unref);
+  g_clear_pointer (&priv->screen_cast_damage, mtk_region_unref);
   g_clear_signal_handler (&priv->stage_views_changed_id, self);
 
   meta_compositor_remove_window_actor (compositor, self);
@@ -602,6 +633,8 @@ meta_window_actor_set_property (GObject      *object,
       priv->window = g_value_dup_object (value);
       g_signal_connect_object (priv->window, "notify::appears-focused",
                                G_CALLBACK (window_appears_focused_notify), self, 0);
+      g_signal_connect_object (priv->window, "notify::suspend-state",
+                               G_CALLBACK (window_suspend_state_notify), self, 0);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1355,6 +1388,8 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
                                 uint8_t              *data)
 {
   MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
   cairo_surface_t *image;
   uint8_t *cr_data;
   int cr_stride;
@@ -1365,6 +1400,19 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
   if (meta_window_actor_is_destroyed (window_actor))
     return;
 
+  if (priv->surface &&
+      bounds->x == 0 && bounds->y == 0 &&
+      meta_window_actor_is_single_surface_actor (window_actor))
+    {
+      MetaShapedTexture *stex = meta_surface_actor_get_texture (priv->surface);
+
+      if (meta_shaped_texture_get_image_into (stex,
+                                              bounds->width, bounds->height,
+                                              bounds->width * bpp,
+                                              data))
+        return;
+    }
+
   image = meta_window_actor_get_image (window_actor, bounds);
   cr_data = cairo_image_surface_get_data (image);
   cr_width = cairo_image_surface_get_width (image);
@@ -1408,6 +1456,7 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
 static gboolean
 meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                        MtkRectangle         *bounds,
+                                       const MtkRegion      *clip,
                                        CoglFramebuffer      *framebuffer)
 {
   MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
@@ -1448,8 +1497,6 @@ meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
 
   clutter_actor_inhibit_culling (actor);
 
-  cogl_color_init_from_4f (&clear_color, 0.0, 0.0, 0.0, 0.0);
-  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
   cogl_framebuffer_orthographic (framebuffer,
                                  0, 0,
                                  unscaled_width, unscaled_height,
@@ -1458,6 +1505,21 @@ meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                  0, 0,
                                  unscaled_width, unscaled_height);
 
+  /* Leave everything outside of the clip as it is in the framebuffer */
+  if (clip)
+    {
+      MtkRectangle clip_extents = mtk_region_get_extents (clip);
+
+      cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                            clip_extents.x,
+                                            clip_extents.y,
+                                            clip_extents.x + clip_extents.width,
+                                            clip_extents.y + clip_extents.height);
+    }
+
+  cogl_color_init_from_4f (&clear_color, 0.0, 0.0, 0.0, 0.0);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+
   scaled_clip = mtk_rectangle_to_graphene_rect (bounds);
   graphene_rect_scale (&scaled_clip,
                        unscaled_width / width,
@@ -1489,6 +1551,9 @@ meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
   cogl_framebuffer_pop_matrix (framebuffer);
   cogl_framebuffer_pop_clip (framebuffer);
 
+  if (clip)
+    cogl_framebuffer_pop_clip (framebuffer);
+
   clutter_actor_uninhibit_culling (actor);
 
   return TRUE;
@@ -1500,6 +1565,16 @@ meta_window_actor_has_damage (MetaScreenCastWindow *screen_cast_window)
   return clutter_actor_has_damage (CLUTTER_ACTOR (screen_cast_window));
 }
 
+static const MtkRegion *
+meta_window_actor_get_damage (MetaScreenCastWindow *screen_cast_window)
+{
+  MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+
+  return priv->screen_cast_damage;
+}
+
 static void
 meta_window_actor_inc_screen_cast_usage (MetaScreenCastWindow *screen_cast_window)
 {
@@ -1529,6 +1604,7 @@ screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface)
   iface->capture_into = meta_window_actor_capture_into;
   iface->blit_to_framebuffer = meta_window_actor_blit_to_framebuffer;
   iface->has_damage = meta_window_actor_has_damage;
+  iface->get_damage = meta_window_actor_get_damage;
   iface->inc_usage = meta_window_actor_inc_screen_cast_usage;
   iface->dec_usage = meta_window_actor_dec_screen_cast_usage;
 }
@@ -1563,7 +1639,68 @@ meta_window_actor_from_actor (ClutterActor *actor)
 void
 meta_window_actor_notify_damaged (MetaWindowActor *window_actor)
 {
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+
   g_signal_emit (window_actor, signals[DAMAGED], 0);
+
+  g_clear_pointer (&priv->screen_cast_damage, mtk_region_unref);
+}
+
+void
+meta_window_actor_add_screen_cast_damage (MetaWindowActor    *window_actor,
+                                          MetaSurfaceActor   *surface_actor,
+                                          const MtkRectangle *area)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+  ClutterActor *actor = CLUTTER_ACTOR (window_actor);
+  graphene_matrix_t surface_to_window;
+  graphene_matrix_t main_surface_to_window;
+  graphene_matrix_t window_to_main_surface;
+  graphene_matrix_t surface_to_main_surface;
+  MetaShapedTexture *stex;
+  graphene_rect_t rect;
+  MtkRectangle damage;
+  float width, height;
+
+  if (!priv->surface)
+    return;
+
+  stex = meta_surface_actor_get_texture (priv->surface);
+  width = meta_shaped_texture_get_width (stex);
+  height = meta_shaped_texture_get_height (stex);
+
+  if (width == 0 || height == 0)
+    return;
+
+  clutter_actor_get_relative_transformation_matrix (CLUTTER_ACTOR (surface_actor),
+                                                    actor,
+                                                    &surface_to_window);
+  clutter_actor_get_relative_transformation_matrix (CLUTTER_ACTOR (priv->surface),
+                                                    actor,
+                                                    &main_surface_to_window);
+  if (!graphene_matrix_inverse (&main_surface_to_window,
+                                &window_to_main_surface))
+    return;
+
+  graphene_matrix_multiply (&surface_to_window,
+                            &window_to_main_surface,
+                            &surface_to_main_surface);
+
+  rect = mtk_rectangle_to_graphene_rect (area);
+  graphene_matrix_transform_bounds (&surface_to_main_surface, &rect, &rect);
+  graphene_rect_scale (&rect,
+                       meta_shaped_texture_get_unscaled_width (stex) / width,
+                       meta_shaped_texture_get_unscaled_height (stex) / height,
+                       &rect);
+  mtk_rectangle_from_graphene_rect (&rect, MTK_ROUNDING_STRATEGY_GROW,
+                                    &damage);
+
+  if (priv->screen_cast_damage)
+    mtk_region_union_rectangle (priv->screen_cast_damage, &damage);
+  else
+    priv->screen_cast_damage = mtk_region_create_rectangle (&damage);
 }
 
 static CoglFramebuffer *
@@ -1623,7 +1760,7 @@ create_framebuffer_from_window_actor (MetaWindowActor  *self,
   return framebuffer;
 }
 
-static gboolean
+gboolean
 meta_window_actor_is_single_surface_actor (MetaWindowActor *self)
 {
   return META_WINDOW_ACTOR_GET_CLASS (self)->is_single_surface_actor (self);
@@ -32,6 +32,10 @@
 #include "x11/window-x11.h"
 #endif
 
+#ifdef HAVE_WAYLAND
+#include "wayland/meta-window-wayland.h"
+#endif
+
 enum {
   PROP_0,
   PROP_WINDOW,
@@ -1517,6 +1521,15 @@ update_resize (MetaWindowDrag          *window_drag,
     return;
 #endif
 
+  /* Likewise, Wayland clients get the next configure once they acked and
+   * drew the previous one, so at most one size is in flight.
+   */
+#ifdef HAVE_WAYLAND
+  if (window->client_type == META_WINDOW_CLIENT_TYPE_WAYLAND &&
+      meta_window_wayland_is_awaiting_configure_ack (window))
+    return;
+#endif
+
   meta_window_get_frame_rect (window, &old_rect);
 
   /* One sided resizing ought to actually be one-sided, despite the fact that
@@ -50,13 +50,34 @@ cullable_iface_init (MetaCullableInterface *iface)
   iface->cull_redraw_clip = meta_window_group_cull_redraw_clip;
 }
 
+static void
+meta_window_group_paint_children (ClutterActor        *actor,
+                                  ClutterPaintContext *paint_context)
+{
+  ClutterActorClass *parent_actor_class =
+    CLUTTER_ACTOR_CLASS (meta_window_group_parent_class);
+  ClutterStageView *view = clutter_paint_context_get_stage_view (paint_context);
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+
+  if (view)
+    clutter_stage_view_begin_gpu_phase (view,
+                                        CLUTTER_GPU_PHASE_WINDOWS,
+                                        framebuffer);
+
+  parent_actor_class->paint (actor, paint_context);
+
+  if (view)
+    clutter_stage_view_end_gpu_phase (view,
+                                      CLUTTER_GPU_PHASE_WINDOWS,
+                                      framebuffer);
+}
+
 static void
 meta_window_group_paint (ClutterActor        *actor,
                          ClutterPaintContext *paint_context)
 {
   MetaWindowGroup *window_group = META_WINDOW_GROUP (actor);
-  ClutterActorClass *parent_actor_class =
-    CLUTTER_ACTOR_CLASS (meta_window_group_parent_class);
   ClutterActor *stage = clutter_actor_get_stage (actor);
   const MtkRegion *redraw_clip;
   g_autoptr (MtkRegion) clip_region = NULL;
@@ -124,14 +145,14 @@ meta_window_group_paint (ClutterActor        *actor,
 
   meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), clip_region);
 
-  parent_actor_class->paint (actor, paint_context);
+  meta_window_group_paint_children (actor, paint_context);
 
   meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), NULL);
 
   return;
 
 fail:
-  parent_actor_class->paint (actor, paint_context);
+  meta_window_group_paint_children (actor, paint_context);
 }
 
 /* Adapted from clutter_actor_update_default_paint_volume() */
@@ -323,6 +323,16 @@ meta_window_constrain (MetaWindow          *window,
                          new);
   place_window_if_needed (window, place_flags, &info);
 
+  /* Interactive moves and resizes mostly stay well within the constraints,
+   * e.g. while dragging a window around in the middle of a monitor. In that
+   * case enforcing every constraint at every priority is a no-op, so check
+   * once whether all of them are already satisfied and skip enforcing them.
+   * Custom placement rules update the placement state as part of being
+   * enforced, so they always take the full path.
+   */
+  if (info.is_user_action && !meta_window_get_placement_rule (window))
+    satisfied = do_all_constraints (window, &info, PRIORITY_MINIMUM, TRUE);
+
   while (!satisfied && priority <= PRIORITY_MAXIMUM) {
     gboolean check_only = TRUE;
 
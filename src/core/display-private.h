@@ -162,7 +162,7 @@ struct _MetaDisplay
   MetaSoundPlayer *sound_player;
 
   MetaSelectionSource *selection_source;
-  GBytes *saved_clipboard;
+  MetaSelectionSource *saved_clipboard;
   gchar *saved_clipboard_mimetype;
   MetaSelection *selection;
   GCancellable *saved_clipboard_cancellable;
@@ -124,17 +124,12 @@ typedef struct
   guint       ping_timeout_id;
 } MetaPingData;
 
-typedef struct
-{
-  MetaDisplay *display;
-  int queue_idx;
-} MetaQueueRunData;
-
 typedef struct _MetaDisplayPrivate
 {
   MetaContext *context;
 
-  guint queue_later_ids[META_N_QUEUE_TYPES];
+  guint queue_later_id;
+  gboolean queue_running;
   GList *queue_windows[META_N_QUEUE_TYPES];
 
   gboolean enable_input_capture;
@@ -2933,6 +2928,11 @@ on_monitors_changed_internal (MetaMonitorManager *monitor_manager,
 {
   meta_workspace_manager_reload_work_areas (display->workspace_manager);
 
+  /* Moving windows to their new monitors changes the layer, and thus the
+   * stack position, of many of them at once; sort and sync the stack
+   * once for all of them rather than once per window. */
+  meta_stack_freeze (display->stack);
+
   /* Fix up monitor for all windows on this display */
   meta_display_foreach_window (display, META_LIST_INCLUDE_OVERRIDE_REDIRECT,
                                (MetaDisplayWindowFunc)
@@ -2942,6 +2942,8 @@ on_monitors_changed_internal (MetaMonitorManager *monitor_manager,
   meta_display_foreach_window (display, META_LIST_DEFAULT,
                                meta_display_resize_func, 0);
 
+  meta_stack_thaw (display->stack);
+
   meta_display_queue_check_fullscreen (display);
 }
 
@@ -3590,13 +3592,19 @@ update_window_visibilities (MetaDisplay *display,
   should_show = g_list_sort (should_show, window_stack_cmp);
   should_show = g_list_reverse (should_show);
 
+  /* Showing a window for the first time adds it to the stack. Keep the stack
+   * frozen while doing so, so that mapping many windows at once, e.g. at
+   * startup or when restoring a session, only sorts and syncs the stack once.
+   * The stack is still sorted on demand while frozen, so placement sees the
+   * current stacking order.
+   */
+  meta_stack_freeze (display->stack);
+
   COGL_TRACE_BEGIN_SCOPED (MetaDisplayShowUnplacedWindows,
                            "Meta::Display::update_window_visibilities#show_unplaced()");
   g_list_foreach (unplaced, (GFunc) meta_window_update_visibility, NULL);
   COGL_TRACE_END (MetaDisplayShowUnplacedWindows);
 
-  meta_stack_freeze (display->stack);
-
   COGL_TRACE_BEGIN_SCOPED (MetaDisplayShowWindows,
                            "Meta::Display::update_window_visibilities#show()");
   g_list_foreach (should_show, (GFunc) meta_window_update_visibility, NULL);
@@ -3634,21 +3642,85 @@ static const WindowQueueFunc window_queue_func[META_N_QUEUE_TYPES] =
   move_resize,
 };
 
+static gboolean
+has_unprocessed_queued_windows (MetaDisplay *display,
+                                GHashTable  **processed)
+{
+  MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
+  int queue_idx;
+
+  for (queue_idx = 0; queue_idx < META_N_QUEUE_TYPES; queue_idx++)
+    {
+      GList *l;
+
+      for (l = priv->queue_windows[queue_idx]; l; l = l->next)
+        {
+          if (!processed ||
+              !g_hash_table_contains (processed[queue_idx], l->data))
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/*
+ * Runs the window queues in order, showing before geometry, as one pass.
+ * Windows queued again by the work done for other windows, e.g. a window
+ * placed when first shown then needing a move-resize, are handled in the
+ * same pass, but each window is processed at most once per queue and
+ * frame; windows queued again after that stay queued for the next frame.
+ */
 static gboolean
 window_queue_run_later_func (gpointer user_data)
 {
-  MetaQueueRunData *run_data = user_data;
-  MetaDisplay *display = run_data->display;
+  MetaDisplay *display = user_data;
   MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
-  g_autoptr (GList) windows = NULL;
-  int queue_idx = run_data->queue_idx;
+  GHashTable *processed[META_N_QUEUE_TYPES];
+  int queue_idx;
+
+  for (queue_idx = 0; queue_idx < META_N_QUEUE_TYPES; queue_idx++)
+    processed[queue_idx] = g_hash_table_new (NULL, NULL);
+
+  priv->queue_running = TRUE;
+
+  while (has_unprocessed_queued_windows (display, processed))
+    {
+      for (queue_idx = 0; queue_idx < META_N_QUEUE_TYPES; queue_idx++)
+        {
+          g_autoptr (GList) windows = NULL;
+          GList *l;
 
-  windows = g_steal_pointer (&priv->queue_windows[queue_idx]);
+          l = priv->queue_windows[queue_idx];
+          while (l)
+            {
+              MetaWindow *window = l->data;
+              GList *next = l->next;
+
+              if (g_hash_table_add (processed[queue_idx], window))
+                {
+                  priv->queue_windows[queue_idx] =
+                    g_list_remove_link (priv->queue_windows[queue_idx], l);
+                  windows = g_list_concat (l, windows);
+                }
+
+              l = next;
+            }
 
-  priv->queue_later_ids[queue_idx] = 0;
+          if (windows)
+            window_queue_func[queue_idx] (display, windows);
+        }
+    }
 
-  window_queue_func[queue_idx] (display, windows);
+  priv->queue_running = FALSE;
+
+  for (queue_idx = 0; queue_idx < META_N_QUEUE_TYPES; queue_idx++)
+    g_hash_table_unref (processed[queue_idx]);
 
+  if (has_unprocessed_queued_windows (display, NULL))
+    return G_SOURCE_CONTINUE;
+
+  priv->queue_later_id = 0;
   return G_SOURCE_REMOVE;
 }
 
@@ -3658,18 +3730,10 @@ meta_display_queue_window (MetaDisplay   *display,
                            MetaQueueType  queue_types)
 {
   MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
-  MetaCompositor *compositor = display->compositor;
-  MetaLaters *laters = meta_compositor_get_laters (compositor);
   int queue_idx;
 
   for (queue_idx = 0; queue_idx < META_N_QUEUE_TYPES; queue_idx++)
     {
-      const MetaLaterType window_queue_later_when[META_N_QUEUE_TYPES] =
-        {
-          META_LATER_CALC_SHOWING,
-          META_LATER_RESIZE,
-        };
-
       if (!(queue_types & 1 << queue_idx))
         continue;
 
@@ -3680,20 +3744,16 @@ meta_display_queue_window (MetaDisplay   *display,
 
       priv->queue_windows[queue_idx] =
         g_list_prepend (priv->queue_windows[queue_idx], window);
+    }
 
-      if (!priv->queue_later_ids[queue_idx])
-        {
-          MetaQueueRunData *run_data;
-
-          run_data = g_new0 (MetaQueueRunData, 1);
-          run_data->display = display;
-          run_data->queue_idx = queue_idx;
-          priv->queue_later_ids[queue_idx] =
-            meta_laters_add (laters,
-                             window_queue_later_when[queue_idx],
-                             window_queue_run_later_func,
-                             run_data, g_free);
-        }
+  if (!priv->queue_later_id)
+    {
+      MetaLaters *laters = meta_compositor_get_laters (display->compositor);
+
+      priv->queue_later_id = meta_laters_add (laters,
+                                              META_LATER_RESIZE,
+                                              window_queue_run_later_func,
+                                              display, NULL);
     }
 }
 
@@ -3719,13 +3779,13 @@ meta_display_unqueue_window (MetaDisplay   *display,
 
       priv->queue_windows[queue_idx] =
         g_list_remove (priv->queue_windows[queue_idx], window);
+    }
 
-      if (!priv->queue_windows[queue_idx] && priv->queue_later_ids[queue_idx])
-        {
-          meta_laters_remove (laters,
-                              priv->queue_later_ids[queue_idx]);
-          priv->queue_later_ids[queue_idx] = 0;
-        }
+  if (priv->queue_later_id && !priv->queue_running &&
+      !has_unprocessed_queued_windows (display, NULL))
+    {
+      meta_laters_remove (laters, priv->queue_later_id);
+      priv->queue_later_id = 0;
     }
 }
 
@@ -30,7 +30,6 @@
 #include "config.h"
 
 #include "backends/meta-backend-private.h"
-#include "backends/meta-keymap-utils.h"
 #include "backends/meta-logical-monitor.h"
 #include "backends/meta-monitor-manager-private.h"
 #include "compositor/compositor-private.h"
@@ -732,11 +731,11 @@ clear_active_keyboard_layouts (MetaKeyBindingManager *keys)
 }
 
 static MetaKeyBindingKeyboardLayout
-create_us_layout (void)
+create_us_layout (MetaKeyBindingManager *keys)
 {
+  MetaKeymapCache *keymap_cache = meta_backend_get_keymap_cache (keys->backend);
   struct xkb_rule_names names;
   struct xkb_keymap *keymap;
-  struct xkb_context *context;
 
   names.rules = DEFAULT_XKB_RULES_FILE;
   names.model = DEFAULT_XKB_MODEL;
@@ -744,9 +743,7 @@ create_us_layout (void)
   names.variant = "";
   names.options = "";
 
-  context = meta_create_xkb_context ();
-  keymap = xkb_keymap_new_from_names (context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
-  xkb_context_unref (context);
+  keymap = meta_keymap_cache_get_keymap (keymap_cache, &names);
 
   return (MetaKeyBindingKeyboardLayout) {
     .keymap = keymap,
@@ -777,7 +774,7 @@ reload_active_keyboard_layouts (MetaKeyBindingManager *keys)
     {
       MetaKeyBindingKeyboardLayout us_layout;
 
-      us_layout = create_us_layout ();
+      us_layout = create_us_layout (keys);
       keys->active_layouts[META_KEY_BINDING_SECONDARY_LAYOUT] = us_layout;
     }
 }
@@ -787,8 +784,6 @@ reload_combos (MetaKeyBindingManager *keys)
 {
   g_hash_table_remove_all (keys->key_bindings_index);
 
-  reload_active_keyboard_layouts (keys);
-
   resolve_key_combo (keys,
                      &keys->overlay_key_combo,
                      &keys->overlay_resolved_key_combo);
@@ -1129,6 +1124,7 @@ reload_keybindings (MetaDisplay *display)
    * even when only the keymap changes */
   reload_modmap (keys);
 
+  reload_active_keyboard_layouts (keys);
   reload_combos (keys);
 
 #ifdef HAVE_X11
@@ -1181,6 +1177,8 @@ prefs_changed_callback (MetaPreference pref,
 #endif
       rebuild_key_binding_table (keys);
       rebuild_special_bindings (keys);
+      /* The keymap didn't change, so the active layouts can be reused;
+       * only the combos need to be resolved again. */
       reload_combos (keys);
 #ifdef HAVE_X11
       meta_x11_keybindings_grab_key_bindings (display);
@@ -2866,6 +2864,7 @@ meta_display_init_keys (MetaDisplay *display)
   rebuild_key_binding_table (keys);
   rebuild_special_bindings (keys);
 
+  reload_active_keyboard_layouts (keys);
   reload_combos (keys);
 
   update_window_grab_modifiers (display);
@@ -22,17 +22,38 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include "core/meta-anonymous-file.h"
 
 struct _MetaAnonymousFile
 {
+  grefcount ref_count;
+
   int fd;
   size_t size;
+  gboolean is_sealed;
 };
 
 #define READONLY_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
 
+/*
+ * Seals can not be removed, so whether the file can be handed out as is
+ * only needs to be checked once.
+ */
+static void
+seal_readonly (MetaAnonymousFile *file)
+{
+#if defined(HAVE_MEMFD_CREATE)
+  int seals;
+
+  fcntl (file->fd, F_ADD_SEALS, READONLY_SEALS);
+
+  seals = fcntl (file->fd, F_GET_SEALS);
+  file->is_sealed = seals != -1 && (seals & READONLY_SEALS) == READONLY_SEALS;
+#endif
+}
+
 static int
 create_tmpfile_cloexec (char *tmpname)
 {
@@ -198,6 +219,7 @@ meta_anonymous_file_new (size_t         size,
       return NULL;
     }
 
+  g_ref_count_init (&file->ref_count);
   file->size = size;
   file->fd = create_anonymous_file (size);
   if (file->fd == -1)
@@ -215,15 +237,13 @@ meta_anonymous_file_new (size_t         size,
       munmap (map, size);
     }
 
-#if defined(HAVE_MEMFD_CREATE)
   /* try to put seals on the file to make it read-only so that we can
    * return the fd later directly when MAPMODE_SHARED is not set.
    * meta_anonymous_file_open_fd can handle the fd even if it is not
    * sealed read-only and will instead create a new anonymous file on
    * each invocation.
    */
-  fcntl (file->fd, F_ADD_SEALS, READONLY_SEALS);
-#endif
+  seal_readonly (file);
 
   return file;
 
@@ -234,16 +254,64 @@ err_free:
   return NULL;
 }
 
+/**
+ * meta_anonymous_file_new_from_fd: (skip)
+ * @fd: A file descriptor from meta_anonymous_file_create_writable_fd()
+ * @size: The size of the contents written to @fd
+ *
+ * Create a new anonymous read-only file from the contents already written
+ * to @fd, without copying them. The returned file takes ownership of @fd,
+ * which must not be written to anymore.
+ *
+ * Returns: The newly created #MetaAnonymousFile. Use
+ *   meta_anonymous_file_free() to free the resources when done.
+ */
+MetaAnonymousFile *
+meta_anonymous_file_new_from_fd (int    fd,
+                                 size_t size)
+{
+  MetaAnonymousFile *file;
+
+  file = g_new0 (MetaAnonymousFile, 1);
+  g_ref_count_init (&file->ref_count);
+  file->fd = fd;
+  file->size = size;
+
+  seal_readonly (file);
+
+  return file;
+}
+
+/**
+ * meta_anonymous_file_ref: (skip)
+ * @file: the #MetaAnonymousFile
+ *
+ * Takes a reference on an anonymous read-only file, so that it can be
+ * shared by several users. Each reference is released with
+ * meta_anonymous_file_free().
+ *
+ * Returns: @file
+ */
+MetaAnonymousFile *
+meta_anonymous_file_ref (MetaAnonymousFile *file)
+{
+  g_ref_count_inc (&file->ref_count);
+  return file;
+}
 
 /**
  * meta_anonymous_file_free: (skip)
  * @file: the #MetaAnonymousFile
  *
- * Free the resources used by an anonymous read-only file.
+ * Release a reference on an anonymous read-only file, and free its
+ * resources when it was the last one.
  */
 void
 meta_anonymous_file_free (MetaAnonymousFile *file)
 {
+  if (!g_ref_count_dec (&file->ref_count))
+    return;
+
   close (file->fd);
   g_free (file);
 }
@@ -296,18 +364,11 @@ meta_anonymous_file_open_fd (MetaAnonymousFile        *file,
   void *src, *dst;
   int fd;
 
-#if defined(HAVE_MEMFD_CREATE)
-  int seals;
-
-  seals = fcntl (file->fd, F_GET_SEALS);
-
   /* file was sealed for read-only and we don't have to support MAP_SHARED
    * so we can simply pass the memfd fd
    */
-  if (seals != -1 && mapmode == META_ANONYMOUS_FILE_MAPMODE_PRIVATE &&
-      (seals & READONLY_SEALS) == READONLY_SEALS)
+  if (file->is_sealed && mapmode == META_ANONYMOUS_FILE_MAPMODE_PRIVATE)
     return file->fd;
-#endif
 
   /* for all other cases we create a new anonymous file that can be mapped
    * with MAP_SHARED and copy the contents to it and return that instead
@@ -373,3 +434,43 @@ meta_anonymous_file_close_fd (int fd)
 
   close (fd);
 }
+
+/**
+ * meta_anonymous_file_open_read_fd: (skip)
+ * @file: the #MetaAnonymousFile to get a file descriptor for
+ *
+ * Returns a new read-only file descriptor for the given file, with a file
+ * offset of its own, so that it can be consumed with read(). Unlike
+ * meta_anonymous_file_open_fd(), the contents are not copied.
+ *
+ * When done using the fd, it must be released using close().
+ *
+ * If this function fails errno is set.
+ *
+ * Returns: A file descriptor for the given file or -1 on failure.
+ */
+int
+meta_anonymous_file_open_read_fd (MetaAnonymousFile *file)
+{
+  g_autofree char *path = NULL;
+
+  path = g_strdup_printf ("/proc/self/fd/%d", file->fd);
+
+  return open (path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * meta_anonymous_file_create_writable_fd: (skip)
+ *
+ * Creates an empty anonymous file to be filled in by the caller, and turned
+ * into a #MetaAnonymousFile using meta_anonymous_file_new_from_fd().
+ *
+ * If this function fails errno is set.
+ *
+ * Returns: A writable file descriptor, or -1 on failure.
+ */
+int
+meta_anonymous_file_create_writable_fd (void)
+{
+  return create_anonymous_file (0);
+}
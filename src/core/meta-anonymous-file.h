@@ -34,6 +34,13 @@ META_EXPORT_TEST
 MetaAnonymousFile * meta_anonymous_file_new (size_t         size,
                                              const uint8_t *data);
 
+META_EXPORT_TEST
+MetaAnonymousFile * meta_anonymous_file_new_from_fd (int    fd,
+                                                     size_t size);
+
+META_EXPORT_TEST
+MetaAnonymousFile * meta_anonymous_file_ref (MetaAnonymousFile *file);
+
 META_EXPORT_TEST
 void meta_anonymous_file_free (MetaAnonymousFile *file);
 
@@ -46,3 +53,9 @@ int meta_anonymous_file_open_fd (MetaAnonymousFile        *file,
 
 META_EXPORT_TEST
 void meta_anonymous_file_close_fd (int fd);
+
+META_EXPORT_TEST
+int meta_anonymous_file_open_read_fd (MetaAnonymousFile *file);
+
+META_EXPORT_TEST
+int meta_anonymous_file_create_writable_fd (void);
@@ -20,8 +20,17 @@
 #include "config.h"
 
 #include "core/meta-clipboard-manager.h"
+
+#include <errno.h>
+#include <gio/gunixoutputstream.h>
+#include <unistd.h>
+
 #include "core/meta-selection-private.h"
-#include "meta/meta-selection-source-memory.h"
+#include "core/meta-selection-source-memory-private.h"
+
+#ifdef HAVE_REMOTE_DESKTOP
+#include "core/meta-selection-source-remote.h"
+#endif
 
 #define MAX_TEXT_SIZE (4 * 1024 * 1024) /* 4MB */
 #define MAX_IMAGE_SIZE (200 * 1024 * 1024) /* 200MB */
@@ -70,18 +79,35 @@ transfer_cb (MetaSelection *selection,
   MetaDisplay *display = meta_selection_get_display (selection);
   g_autoptr (GOutputStream) output = output_stream;
   g_autoptr (GError) error = NULL;
+  MetaAnonymousFile *content;
+  off_t size;
+  int fd;
+
+  fd = g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (output));
 
   if (!meta_selection_transfer_finish (selection, result, &error))
     {
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_warning ("Failed to store clipboard: %s", error->message);
 
+      close (fd);
       return;
     }
 
   g_output_stream_close (output, NULL, NULL);
+
+  size = lseek (fd, 0, SEEK_CUR);
+  if (size < 0)
+    {
+      g_warning ("Failed to store clipboard: %s", g_strerror (errno));
+      close (fd);
+      return;
+    }
+
+  content = meta_anonymous_file_new_from_fd (fd, size);
   display->saved_clipboard =
-    g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+    meta_selection_source_memory_new_for_file (display->saved_clipboard_mimetype,
+                                               content);
 }
 
 static void
@@ -97,6 +123,7 @@ owner_changed_cb (MetaSelection       *selection,
     {
       GOutputStream *output;
       GList *mimetypes, *l;
+      int fd;
       int best_idx = -1;
       const char *best = NULL;
       ssize_t transfer_size = -1;
@@ -108,7 +135,16 @@ owner_changed_cb (MetaSelection       *selection,
       g_clear_object (&display->saved_clipboard_cancellable);
       g_clear_object (&display->selection_source);
       g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
-      g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
+      g_clear_object (&display->saved_clipboard);
+
+#ifdef HAVE_REMOTE_DESKTOP
+      /* Don't pull a copy of a remote desktop client's clipboard across
+       * the network up front. Its contents live on the remote end, and
+       * are only transferred, streamed, when a local client pastes them.
+       */
+      if (META_IS_SELECTION_SOURCE_REMOTE (new_owner))
+        return;
+#endif
 
       mimetypes = meta_selection_get_mimetypes (selection, selection_type);
 
@@ -136,7 +172,18 @@ owner_changed_cb (MetaSelection       *selection,
 
       display->saved_clipboard_mimetype = g_strdup (best);
       g_list_free_full (mimetypes, g_free);
-      output = g_memory_output_stream_new_resizable ();
+
+      /* Store the contents in an anonymous file rather than on the heap, it
+       * is handed out as is once the owner goes away. */
+      fd = meta_anonymous_file_create_writable_fd ();
+      if (fd == -1)
+        {
+          g_warning ("Failed to create clipboard storage: %s",
+                     g_strerror (errno));
+          return;
+        }
+
+      output = g_unix_output_stream_new (fd, FALSE);
       display->saved_clipboard_cancellable = g_cancellable_new ();
       meta_selection_transfer_async (selection,
                                      META_SELECTION_CLIPBOARD,
@@ -149,24 +196,10 @@ owner_changed_cb (MetaSelection       *selection,
     }
   else if (!new_owner && display->saved_clipboard)
     {
-      g_autoptr (GError) error = NULL;
-      g_autoptr (MetaSelectionSource) new_source = NULL;
-
-      g_assert (display->saved_clipboard_mimetype != NULL);
-
       /* Old owner is gone, time to take over */
-      new_source = meta_selection_source_memory_new (display->saved_clipboard_mimetype,
-                                                     display->saved_clipboard,
-                                                     &error);
-      if (!new_source)
-        {
-          g_warning ("MetaClipboardManager failed to create new MetaSelectionSourceMemory: %s",
-                     error->message);
-          return;
-        }
-
-      g_set_object (&display->selection_source, new_source);
-      meta_selection_set_owner (selection, selection_type, new_source);
+      g_set_object (&display->selection_source, display->saved_clipboard);
+      meta_selection_set_owner (selection, selection_type,
+                                display->saved_clipboard);
     }
 }
 
@@ -188,7 +221,7 @@ meta_clipboard_manager_shutdown (MetaDisplay *display)
   g_cancellable_cancel (display->saved_clipboard_cancellable);
   g_clear_object (&display->saved_clipboard_cancellable);
   g_clear_object (&display->selection_source);
-  g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
+  g_clear_object (&display->saved_clipboard);
   g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
   selection = meta_display_get_selection (display);
   g_signal_handlers_disconnect_by_func (selection, owner_changed_cb, display);
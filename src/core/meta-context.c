@@ -108,6 +108,9 @@ typedef struct _MetaContextPrivate
 #endif
 
   MetaDebugControl *debug_control;
+
+  int64_t startup_time_us;
+  gulong first_frame_presented_id;
 } MetaContextPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaContext, meta_context, G_TYPE_OBJECT)
@@ -399,6 +402,8 @@ meta_context_configure (MetaContext   *context,
 
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_INIT);
 
+  priv->startup_time_us = g_get_monotonic_time ();
+
   if (!META_CONTEXT_GET_CLASS (context)->configure (context, argc, argv, error))
     {
       priv->state = META_CONTEXT_STATE_TERMINATED;
@@ -425,6 +430,39 @@ meta_context_configure (MetaContext   *context,
   return TRUE;
 }
 
+static void
+log_startup_phase (MetaContext *context,
+                   const char  *phase,
+                   int64_t      phase_start_us)
+{
+  MetaContextPrivate *priv = meta_context_get_instance_private (context);
+  int64_t now_us = g_get_monotonic_time ();
+
+  meta_topic (META_DEBUG_STARTUP,
+              "%s took %.1f ms, %.1f ms since startup",
+              phase,
+              (now_us - phase_start_us) / 1000.0,
+              (now_us - priv->startup_time_us) / 1000.0);
+}
+
+static void
+on_first_frame_presented (ClutterStage     *stage,
+                          ClutterStageView *stage_view,
+                          ClutterFrameInfo *frame_info,
+                          MetaContext      *context)
+{
+  MetaContextPrivate *priv = meta_context_get_instance_private (context);
+
+  COGL_TRACE_MESSAGE ("Meta::Context::first-frame-presented",
+                      "First frame presented");
+
+  meta_topic (META_DEBUG_STARTUP,
+              "First frame presented %.1f ms after startup",
+              (g_get_monotonic_time () - priv->startup_time_us) / 1000.0);
+
+  g_clear_signal_handler (&priv->first_frame_presented_id, stage);
+}
+
 static const char *
 compositor_type_to_description (MetaCompositorType compositor_type)
 {
@@ -453,11 +491,18 @@ meta_context_real_setup (MetaContext  *context,
 {
   MetaContextPrivate *priv = meta_context_get_instance_private (context);
   MetaBackend *backend;
+  int64_t start_us;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaContextCreateBackend,
+                           "Meta::Context::create_backend()");
 
+  start_us = g_get_monotonic_time ();
   backend = META_CONTEXT_GET_CLASS (context)->create_backend (context, error);
   if (!backend)
     return FALSE;
 
+  log_startup_phase (context, "Backend initialization", start_us);
+
   priv->backend = backend;
   return TRUE;
 }
@@ -473,6 +518,8 @@ meta_context_setup (MetaContext  *context,
 
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_CONFIGURED);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextSetup, "Meta::Context::setup()");
+
   if (!priv->plugin_name && priv->plugin_gtype == G_TYPE_NONE)
     {
       priv->state = META_CONTEXT_STATE_TERMINATED;
@@ -510,11 +557,23 @@ meta_context_start (MetaContext  *context,
                     GError      **error)
 {
   MetaContextPrivate *priv = meta_context_get_instance_private (context);
+  ClutterActor *stage;
+  int64_t start_us;
 
   g_return_val_if_fail (META_IS_CONTEXT (context), FALSE);
 
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_SETUP);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStart, "Meta::Context::start()");
+
+  start_us = g_get_monotonic_time ();
+
+  stage = meta_backend_get_stage (priv->backend);
+  priv->first_frame_presented_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_first_frame_presented),
+                      context);
+
   meta_prefs_init ();
 
 #ifdef HAVE_WAYLAND
@@ -536,6 +595,8 @@ meta_context_start (MetaContext  *context,
 
   priv->main_loop = g_main_loop_new (NULL, FALSE);
 
+  log_startup_phase (context, "Display and compositor start", start_us);
+
   priv->state = META_CONTEXT_STATE_STARTED;
 
   g_signal_emit (context, signals[STARTED], 0);
@@ -846,6 +907,12 @@ meta_context_dispose (GObject *object)
 
   g_signal_emit (context, signals[PREPARE_SHUTDOWN], 0);
 
+  if (priv->backend)
+    {
+      g_clear_signal_handler (&priv->first_frame_presented_id,
+                              meta_backend_get_stage (priv->backend));
+    }
+
 #ifdef HAVE_WAYLAND
   g_clear_object (&priv->service_channel);
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "clutter/clutter-mutter.h"
 #include "meta/meta-debug-control.h"
 
 gboolean meta_debug_control_is_color_management_protocol_enabled (MetaDebugControl *debug_control);
@@ -29,3 +30,22 @@ gboolean meta_debug_control_is_hdr_enabled (MetaDebugControl *debug_control);
 unsigned int meta_debug_control_get_luminance_percentage (MetaDebugControl *debug_control);
 
 gboolean meta_debug_control_is_session_management_protocol_enabled (MetaDebugControl *debug_control);
+
+void meta_debug_control_set_kms_test_cache_stats (MetaDebugControl *debug_control,
+                                                  unsigned int      hits,
+                                                  unsigned int      misses);
+
+GVariant * meta_debug_control_get_thread_scheduling (MetaDebugControl *debug_control,
+                                                     const char       *thread_name);
+
+gboolean meta_debug_control_is_frame_latency_tracing_enabled (MetaDebugControl *debug_control);
+
+ClutterFrameClockPolicy meta_debug_control_get_frame_clock_policy (MetaDebugControl *debug_control);
+
+void meta_debug_control_emit_frame_latency (MetaDebugControl          *debug_control,
+                                            const char                *view_name,
+                                            const ClutterFrameLatency *latency);
+
+uint64_t meta_debug_control_get_texture_memory_budget (MetaDebugControl *debug_control);
+
+uint64_t meta_debug_control_get_shadow_cache_budget (MetaDebugControl *debug_control);
@@ -20,10 +20,21 @@
 
 #include "core/meta-debug-control-private.h"
 
+#include "backends/meta-backend-private.h"
 #include "core/util-private.h"
 #include "meta/meta-backend.h"
 #include "meta/meta-context.h"
 
+#ifdef HAVE_X11_CLIENT
+#include "x11/meta-shadow-factory.h"
+#endif
+
+#ifdef HAVE_WAYLAND
+#include "wayland/meta-wayland-client-private.h"
+#endif
+
+#define DEFAULT_SHADOW_CACHE_BUDGET_MIB 8
+
 enum
 {
   PROP_0,
@@ -57,9 +68,240 @@ G_DEFINE_TYPE_WITH_CODE (MetaDebugControl,
                          G_IMPLEMENT_INTERFACE (META_DBUS_TYPE_DEBUG_CONTROL,
                                                 meta_dbus_debug_control_iface_init))
 
+static gboolean
+handle_get_texture_memory_usage (MetaDBusDebugControl  *dbus_debug_control,
+                                 GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterBackend *clutter_backend;
+  CoglContext *cogl_context;
+  g_autoptr (GEnumClass) enum_class = NULL;
+  GVariantBuilder builder;
+  int i;
+
+  clutter_backend = meta_backend_get_clutter_backend (backend);
+  cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+
+  enum_class = g_type_class_ref (COGL_TYPE_TEXTURE_MEMORY_CATEGORY);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{st}"));
+  for (i = 0; i < COGL_TEXTURE_MEMORY_N_CATEGORIES; i++)
+    {
+      GEnumValue *enum_value = g_enum_get_value (enum_class, i);
+      size_t usage;
+
+      usage = cogl_context_get_texture_memory_usage (cogl_context, i);
+      g_variant_builder_add (&builder, "{st}",
+                             enum_value->value_nick, (uint64_t) usage);
+    }
+
+  meta_dbus_debug_control_complete_get_texture_memory_usage (dbus_debug_control,
+                                                             invocation,
+                                                             g_variant_builder_end (&builder));
+  return TRUE;
+}
+
+static gboolean
+handle_get_shadow_cache_stats (MetaDBusDebugControl  *dbus_debug_control,
+                               GDBusMethodInvocation *invocation)
+{
+  unsigned int n_entries = 0;
+  size_t n_bytes = 0;
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+
+#ifdef HAVE_X11_CLIENT
+  meta_shadow_factory_get_cache_stats (meta_shadow_factory_get_default (),
+                                       &n_entries, &n_bytes,
+                                       &hits, &misses);
+#endif
+
+  meta_dbus_debug_control_complete_get_shadow_cache_stats (dbus_debug_control,
+                                                           invocation,
+                                                           n_entries,
+                                                           (uint64_t) n_bytes,
+                                                           hits,
+                                                           misses);
+  return TRUE;
+}
+
+static gboolean
+handle_trim_caches (MetaDBusDebugControl  *dbus_debug_control,
+                    GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  MetaMemoryPressure *memory_pressure =
+    meta_backend_get_memory_pressure (backend);
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{st}"));
+  meta_memory_pressure_trim (memory_pressure, &builder);
+
+  meta_dbus_debug_control_complete_trim_caches (dbus_debug_control,
+                                                invocation,
+                                                g_variant_builder_end (&builder));
+  return TRUE;
+}
+
+static void
+add_perf_counter (const char *name,
+                  const char *description,
+                  int64_t     value,
+                  gpointer    user_data)
+{
+  GVariantBuilder *builder = user_data;
+
+  g_variant_builder_add (builder, "{sx}", name, value);
+}
+
+static gboolean
+handle_get_performance_counters (MetaDBusDebugControl  *dbus_debug_control,
+                                 GDBusMethodInvocation *invocation)
+{
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sx}"));
+  cogl_perf_counters_foreach (add_perf_counter, &builder);
+
+  meta_dbus_debug_control_complete_get_performance_counters (dbus_debug_control,
+                                                             invocation,
+                                                             g_variant_builder_end (&builder));
+  return TRUE;
+}
+
+static void
+add_frame_stats (const ClutterFrameStats *stats,
+                 gpointer                 user_data)
+{
+  GVariantBuilder *builder = user_data;
+
+  g_variant_builder_add (builder, "(xxxxxxxu)",
+                         stats->dispatch_time_us,
+                         stats->layout_time_us,
+                         stats->paint_time_us,
+                         stats->flush_time_us,
+                         stats->gpu_time_ns,
+                         stats->target_presentation_time_us,
+                         stats->presentation_time_us,
+                         stats->flags);
+}
+
+static gboolean
+handle_get_frame_statistics (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa(xxxxxxxu)}"));
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      const char *name = clutter_stage_view_get_name (view);
+      GVariantBuilder frames_builder;
+
+      g_variant_builder_init (&frames_builder,
+                              G_VARIANT_TYPE ("a(xxxxxxxu)"));
+      clutter_stage_view_foreach_frame_stats (view,
+                                              add_frame_stats,
+                                              &frames_builder);
+      g_variant_builder_add (&builder, "{sa(xxxxxxxu)}",
+                             name ? name : "",
+                             &frames_builder);
+    }
+
+  meta_dbus_debug_control_complete_get_frame_statistics (dbus_debug_control,
+                                                         invocation,
+                                                         g_variant_builder_end (&builder));
+  return TRUE;
+}
+
+static gboolean
+handle_get_wayland_client_stats (MetaDBusDebugControl  *dbus_debug_control,
+                                 GDBusMethodInvocation *invocation)
+{
+  GVariant *clients = NULL;
+#ifdef HAVE_WAYLAND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+
+  if (compositor)
+    clients = meta_wayland_client_stats_collect (compositor);
+#endif
+
+  if (!clients)
+    clients = g_variant_new_array (G_VARIANT_TYPE ("(ua{sv})"), NULL, 0);
+
+  meta_dbus_debug_control_complete_get_wayland_client_stats (dbus_debug_control,
+                                                             invocation,
+                                                             clients);
+  return TRUE;
+}
+
+static gboolean
+handle_capture_frame (MetaDBusDebugControl  *dbus_debug_control,
+                      GDBusMethodInvocation *invocation,
+                      const char            *directory)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  g_autoptr (GPtrArray) paths = NULL;
+  GList *l;
+  int i = 0;
+
+  if (!g_path_is_absolute (directory))
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Capture directory must be an absolute path");
+      return TRUE;
+    }
+
+  paths = g_ptr_array_new_with_free_func (g_free);
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      const char *name = clutter_stage_view_get_name (view);
+      g_autofree char *basename = NULL;
+      char *path;
+
+      if (name)
+        basename = g_strdup_printf ("%s.coglcapture", name);
+      else
+        basename = g_strdup_printf ("view-%d.coglcapture", i);
+      g_strdelimit (basename, G_DIR_SEPARATOR_S, '_');
+
+      path = g_build_filename (directory, basename, NULL);
+      clutter_stage_view_capture_next_frame (view, path);
+      g_ptr_array_add (paths, path);
+      i++;
+    }
+  g_ptr_array_add (paths, NULL);
+
+  meta_dbus_debug_control_complete_capture_frame (dbus_debug_control,
+                                                  invocation,
+                                                  (const char * const *) paths->pdata);
+  return TRUE;
+}
+
 static void
 meta_dbus_debug_control_iface_init (MetaDBusDebugControlIface *iface)
 {
+  iface->handle_get_texture_memory_usage = handle_get_texture_memory_usage;
+  iface->handle_get_shadow_cache_stats = handle_get_shadow_cache_stats;
+  iface->handle_trim_caches = handle_trim_caches;
+  iface->handle_get_performance_counters = handle_get_performance_counters;
+  iface->handle_get_frame_statistics = handle_get_frame_statistics;
+  iface->handle_get_wayland_client_stats = handle_get_wayland_client_stats;
+  iface->handle_capture_frame = handle_capture_frame;
 }
 
 static void
@@ -170,6 +412,10 @@ meta_debug_control_init (MetaDebugControl *debug_control)
     META_DBUS_DEBUG_CONTROL (debug_control);
   gboolean enable_hdr, force_linear_blending, color_management_protocol;
   gboolean session_management_protocol;
+  const char *frame_clock_policy;
+  const char *texture_memory_budget;
+  const char *shadow_cache_budget;
+  uint64_t shadow_cache_budget_mib;
 
   color_management_protocol =
     g_strcmp0 (getenv ("MUTTER_DEBUG_COLOR_MANAGEMENT_PROTOCOL"), "1") == 0;
@@ -190,6 +436,36 @@ meta_debug_control_init (MetaDebugControl *debug_control)
     g_strcmp0 (getenv ("MUTTER_DEBUG_SESSION_MANAGEMENT_PROTOCOL"), "1") == 0;
   meta_dbus_debug_control_set_session_management_protocol (dbus_debug_control,
                                                            session_management_protocol);
+
+  meta_dbus_debug_control_set_thread_scheduling (dbus_debug_control,
+                                                 g_variant_new_array (G_VARIANT_TYPE ("{sa{sv}}"),
+                                                                      NULL, 0));
+
+  frame_clock_policy = getenv ("MUTTER_DEBUG_FRAME_CLOCK_POLICY");
+  meta_dbus_debug_control_set_frame_clock_policy (dbus_debug_control,
+                                                  frame_clock_policy ?
+                                                  frame_clock_policy :
+                                                  "default");
+
+  /* In MiB, for convenience */
+  texture_memory_budget = getenv ("MUTTER_DEBUG_TEXTURE_MEMORY_BUDGET");
+  if (texture_memory_budget)
+    {
+      uint64_t budget_mib = g_ascii_strtoull (texture_memory_budget, NULL, 10);
+
+      meta_dbus_debug_control_set_texture_memory_budget (dbus_debug_control,
+                                                         budget_mib * 1024 * 1024);
+    }
+
+  /* In MiB, for convenience */
+  shadow_cache_budget = getenv ("MUTTER_DEBUG_SHADOW_CACHE_BUDGET");
+  if (shadow_cache_budget)
+    shadow_cache_budget_mib = g_ascii_strtoull (shadow_cache_budget, NULL, 10);
+  else
+    shadow_cache_budget_mib = DEFAULT_SHADOW_CACHE_BUDGET_MIB;
+
+  meta_dbus_debug_control_set_shadow_cache_budget (dbus_debug_control,
+                                                   shadow_cache_budget_mib * 1024 * 1024);
 }
 
 gboolean
@@ -237,6 +513,98 @@ meta_debug_control_is_session_management_protocol_enabled (MetaDebugControl *deb
   return meta_dbus_debug_control_get_session_management_protocol (dbus_debug_control);
 }
 
+void
+meta_debug_control_set_kms_test_cache_stats (MetaDebugControl *debug_control,
+                                             unsigned int      hits,
+                                             unsigned int      misses)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  meta_dbus_debug_control_set_kms_test_cache_hits (dbus_debug_control, hits);
+  meta_dbus_debug_control_set_kms_test_cache_misses (dbus_debug_control,
+                                                     misses);
+}
+
+GVariant *
+meta_debug_control_get_thread_scheduling (MetaDebugControl *debug_control,
+                                          const char       *thread_name)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  GVariant *thread_scheduling;
+
+  thread_scheduling =
+    meta_dbus_debug_control_get_thread_scheduling (dbus_debug_control);
+  if (!thread_scheduling)
+    return NULL;
+
+  return g_variant_lookup_value (thread_scheduling,
+                                 thread_name,
+                                 G_VARIANT_TYPE_VARDICT);
+}
+
+gboolean
+meta_debug_control_is_frame_latency_tracing_enabled (MetaDebugControl *debug_control)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  return meta_dbus_debug_control_get_frame_latency_tracing (dbus_debug_control);
+}
+
+ClutterFrameClockPolicy
+meta_debug_control_get_frame_clock_policy (MetaDebugControl *debug_control)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  const char *policy;
+
+  policy = meta_dbus_debug_control_get_frame_clock_policy (dbus_debug_control);
+
+  if (g_strcmp0 (policy, "low-latency") == 0)
+    return CLUTTER_FRAME_CLOCK_POLICY_LOW_LATENCY;
+  else if (g_strcmp0 (policy, "fixed-phase") == 0)
+    return CLUTTER_FRAME_CLOCK_POLICY_FIXED_PHASE;
+  else
+    return CLUTTER_FRAME_CLOCK_POLICY_DEFAULT;
+}
+
+void
+meta_debug_control_emit_frame_latency (MetaDebugControl          *debug_control,
+                                       const char                *view_name,
+                                       const ClutterFrameLatency *latency)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  meta_dbus_debug_control_emit_frame_latency (dbus_debug_control,
+                                              view_name ? view_name : "",
+                                              latency->input_time_us,
+                                              latency->dispatch_time_us,
+                                              latency->layout_time_us,
+                                              latency->submit_time_us,
+                                              latency->presentation_time_us);
+}
+
+uint64_t
+meta_debug_control_get_texture_memory_budget (MetaDebugControl *debug_control)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  return meta_dbus_debug_control_get_texture_memory_budget (dbus_debug_control);
+}
+
+uint64_t
+meta_debug_control_get_shadow_cache_budget (MetaDebugControl *debug_control)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+
+  return meta_dbus_debug_control_get_shadow_cache_budget (dbus_debug_control);
+}
+
 void
 meta_debug_control_set_exported (MetaDebugControl *debug_control,
                                  gboolean          exported)
@@ -76,6 +76,30 @@ thread_info_new (GMainContext *main_context,
   return thread_info;
 }
 
+/*
+ * Allocation sampling is opt-in, as taking a backtrace per sample is far
+ * from free. It is enabled with the "mutter-allocation-sample-interval"
+ * start option, or with MUTTER_PROFILE_ALLOCATIONS, set to N to record
+ * every Nth instrumented allocation on each thread.
+ */
+static unsigned int
+get_allocation_sample_interval (GVariant *options)
+{
+  const char *env_value;
+  unsigned int sample_interval;
+
+  if (options &&
+      g_variant_lookup (options, "mutter-allocation-sample-interval", "u",
+                        &sample_interval))
+    return sample_interval;
+
+  env_value = g_getenv ("MUTTER_PROFILE_ALLOCATIONS");
+  if (env_value)
+    return (unsigned int) g_ascii_strtoull (env_value, NULL, 10);
+
+  return 0;
+}
+
 static gboolean
 handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
               GDBusMethodInvocation    *invocation,
@@ -133,6 +157,7 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
         }
     }
 
+  cogl_set_allocation_tracing (get_allocation_sample_interval (options));
   cogl_set_tracing_enabled_on_thread (main_context, group_name);
 
   g_mutex_lock (&profiler->mutex);
@@ -193,6 +218,7 @@ handle_stop (MetaDBusSysprof3Profiler *dbus_profiler,
     }
   g_mutex_unlock (&profiler->mutex);
 
+  cogl_set_allocation_tracing (0);
   cogl_stop_tracing ();
 
   profiler->running = FALSE;
@@ -305,6 +331,7 @@ meta_profiler_new (const char *trace_file)
         }
       else
         {
+          cogl_set_allocation_tracing (get_allocation_sample_interval (NULL));
           cogl_set_tracing_enabled_on_thread (main_context, group_name);
           profiler->persistent = TRUE;
           profiler->running = TRUE;
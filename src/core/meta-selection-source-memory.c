@@ -19,12 +19,10 @@
 
 #include "config.h"
 
-#include "meta/meta-selection-source-memory.h"
+#include "core/meta-selection-source-memory-private.h"
 
 #include <gio/gunixinputstream.h>
 
-#include "core/meta-anonymous-file.h"
-
 struct _MetaSelectionSourceMemory
 {
   MetaSelectionSource parent_instance;
@@ -114,6 +112,15 @@ meta_selection_source_memory_read_async (MetaSelectionSource *source,
   task = g_task_new (source, cancellable, callback, user_data);
   g_task_set_source_tag (task, meta_selection_source_memory_read_async);
 
+  /* Prefer reading the contents directly over handing out a copy. */
+  fd = meta_anonymous_file_open_read_fd (source_mem->content);
+  if (fd != -1)
+    {
+      stream = g_unix_input_stream_new (fd, TRUE);
+      g_task_return_pointer (task, stream, g_object_unref);
+      return;
+    }
+
   fd = meta_anonymous_file_open_fd (source_mem->content,
                                     META_ANONYMOUS_FILE_MAPMODE_SHARED);
 
@@ -210,3 +217,19 @@ meta_selection_source_memory_new (const char  *mimetype,
 
   return META_SELECTION_SOURCE (source);
 }
+
+MetaSelectionSource *
+meta_selection_source_memory_new_for_file (const char        *mimetype,
+                                           MetaAnonymousFile *content)
+{
+  MetaSelectionSourceMemory *source;
+
+  g_return_val_if_fail (mimetype != NULL, NULL);
+  g_return_val_if_fail (content != NULL, NULL);
+
+  source = g_object_new (META_TYPE_SELECTION_SOURCE_MEMORY, NULL);
+  source->mimetype = g_strdup (mimetype);
+  source->content = content;
+
+  return META_SELECTION_SOURCE (source);
+}
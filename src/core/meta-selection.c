@@ -19,9 +19,17 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gfiledescriptorbased.h>
+#include <poll.h>
+#include <sys/stat.h>
+
 #include "core/meta-selection-private.h"
 #include "meta/meta-selection.h"
 
+#define TRANSFER_CHUNK_SIZE (64 * 1024)
+
 typedef struct TransferRequest TransferRequest;
 
 struct _MetaSelection
@@ -362,13 +370,155 @@ read_selection_source_async (GTask           *task,
                              TransferRequest *request)
 {
   g_input_stream_read_bytes_async (request->istream,
-                                   (gsize) request->len,
+                                   MIN ((gsize) request->len,
+                                        TRANSFER_CHUNK_SIZE),
                                    G_PRIORITY_DEFAULT,
                                    g_task_get_cancellable (task),
                                    (GAsyncReadyCallback) read_cb,
                                    task);
 }
 
+#ifdef HAVE_SPLICE
+static int
+get_stream_fd (GObject *stream)
+{
+  if (!G_IS_FILE_DESCRIPTOR_BASED (stream))
+    return -1;
+
+  return g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (stream));
+}
+
+static gboolean
+is_pipe_fd (int fd)
+{
+  struct stat st;
+
+  return fstat (fd, &st) == 0 && S_ISFIFO (st.st_mode);
+}
+
+static gboolean
+wait_for_fd (int            fd,
+             short          events,
+             GCancellable  *cancellable,
+             GError       **error)
+{
+  struct pollfd fds[2] = { { .fd = fd, .events = events } };
+  GPollFD cancellable_fd;
+  int n_fds = 1;
+  int ret;
+
+  if (g_cancellable_make_pollfd (cancellable, &cancellable_fd))
+    {
+      fds[1].fd = cancellable_fd.fd;
+      fds[1].events = POLLIN;
+      n_fds++;
+    }
+
+  do
+    ret = poll (fds, n_fds, -1);
+  while (ret < 0 && errno == EINTR);
+
+  if (n_fds > 1)
+    g_cancellable_release_fd (cancellable);
+
+  if (ret < 0)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to poll: %s", g_strerror (errsv));
+      return FALSE;
+    }
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+static void
+splice_fds_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *task_cancellable)
+{
+  TransferRequest *request = task_data;
+  GCancellable *cancellable = request->cancellable;
+  GError *error = NULL;
+  int in_fd, out_fd;
+
+  in_fd = get_stream_fd (G_OBJECT (request->istream));
+  out_fd = get_stream_fd (G_OBJECT (request->ostream));
+
+  while (request->len != 0)
+    {
+      size_t chunk_size = TRANSFER_CHUNK_SIZE;
+      ssize_t ret;
+
+      if (request->len > 0)
+        chunk_size = MIN (chunk_size, (size_t) request->len);
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, &error))
+        break;
+
+      ret = splice (in_fd, NULL, out_fd, NULL, chunk_size,
+                    SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (ret == 0)
+        break;
+
+      if (ret < 0)
+        {
+          int errsv = errno;
+
+          if (errsv == EINTR)
+            continue;
+
+          if (errsv == EAGAIN)
+            {
+              /* Either end might be the one not ready */
+              if (!wait_for_fd (in_fd, POLLIN, cancellable, &error) ||
+                  !wait_for_fd (out_fd, POLLOUT, cancellable, &error))
+                break;
+
+              continue;
+            }
+
+          g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                       "Failed to splice: %s", g_strerror (errsv));
+          break;
+        }
+
+      if (request->len > 0)
+        request->len -= ret;
+    }
+
+  if (request->len < 0)
+    {
+      g_input_stream_close (request->istream, NULL,
+                            error ? NULL : &error);
+      g_output_stream_close (request->ostream, NULL,
+                             error ? NULL : &error);
+    }
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+can_splice_fds (TransferRequest *request)
+{
+  int in_fd, out_fd;
+
+  in_fd = get_stream_fd (G_OBJECT (request->istream));
+  out_fd = get_stream_fd (G_OBJECT (request->ostream));
+
+  if (in_fd < 0 || out_fd < 0)
+    return FALSE;
+
+  /* splice() needs a pipe on at least one end */
+  return is_pipe_fd (in_fd) || is_pipe_fd (out_fd);
+}
+#endif /* HAVE_SPLICE */
+
 static void
 source_read_cb (MetaSelectionSource *source,
                 GAsyncResult        *result,
@@ -389,6 +539,18 @@ source_read_cb (MetaSelectionSource *source,
   request = g_task_get_task_data (task);
   request->istream = stream;
 
+#ifdef HAVE_SPLICE
+  if (can_splice_fds (request))
+    {
+      /* Move the contents between the file descriptors in the kernel,
+       * without bouncing them through userspace buffers.
+       */
+      g_task_run_in_thread (task, splice_fds_thread);
+      g_object_unref (task);
+      return;
+    }
+#endif
+
   if (request->len < 0)
     {
       g_output_stream_splice_async (request->ostream,
@@ -28,6 +28,7 @@
 #include <gvdb/gvdb-reader.h>
 
 #include "core/meta-anonymous-file.h"
+#include "meta/util.h"
 
 #define SESSION_FILE_NAME "session.gvdb"
 
@@ -47,6 +48,7 @@ struct _MetaSessionManager
   GMutex mutex;
   GHashTable *sessions; /* Session name -> MetaSessionState */
   GHashTable *deleted_sessions; /* Set of session names */
+  gboolean has_deleted_sessions_changed;
   GvdbTable *gvdb_table;
   char *name;
   int fd;
@@ -327,6 +329,7 @@ meta_session_manager_delete_session (MetaSessionManager *manager,
 {
   g_hash_table_add (manager->deleted_sessions, g_strdup (name));
   g_hash_table_remove (manager->sessions, name);
+  manager->has_deleted_sessions_changed = TRUE;
 }
 
 static void
@@ -444,6 +447,25 @@ save_session_async (GTask        *task,
   g_mutex_unlock (&session_manager->mutex);
 }
 
+static gboolean
+meta_session_manager_is_dirty (MetaSessionManager *manager)
+{
+  MetaSessionState *session_state;
+  GHashTableIter iter;
+
+  if (manager->has_deleted_sessions_changed)
+    return TRUE;
+
+  g_hash_table_iter_init (&iter, manager->sessions);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &session_state))
+    {
+      if (meta_session_state_is_dirty (session_state))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 static MetaSessionData *
 meta_session_manager_snapshot (MetaSessionManager *manager)
 {
@@ -452,6 +474,16 @@ meta_session_manager_snapshot (MetaSessionManager *manager)
   GHashTableIter iter;
   const gchar *name;
 
+  /* Nothing changed since the last save, so the file is up to date */
+  if (!meta_session_manager_is_dirty (manager))
+    {
+      meta_topic (META_DEBUG_SESSION_MANAGEMENT,
+                  "Session state unchanged, not saving");
+      return NULL;
+    }
+
+  manager->has_deleted_sessions_changed = FALSE;
+
   session_data = g_new0 (MetaSessionData, 1);
   session_data->gvdb_table = manager->gvdb_table;
   session_data->new_table = gvdb_hash_table_new (NULL, NULL);
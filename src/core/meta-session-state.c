@@ -36,6 +36,7 @@ typedef struct _MetaSessionStatePrivate MetaSessionStatePrivate;
 struct _MetaSessionStatePrivate
 {
   char *name;
+  gboolean is_dirty;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (MetaSessionState, meta_session_state, G_TYPE_OBJECT)
@@ -49,12 +50,30 @@ meta_session_state_get_name (MetaSessionState *state)
   return priv->name;
 }
 
+/*
+ * Whether windows were saved or removed since the state was last
+ * serialized.
+ */
+gboolean
+meta_session_state_is_dirty (MetaSessionState *state)
+{
+  MetaSessionStatePrivate *priv =
+    meta_session_state_get_instance_private (state);
+
+  return priv->is_dirty;
+}
+
 gboolean
 meta_session_state_serialize (MetaSessionState *state,
                               GHashTable       *gvdb_data)
 {
+  MetaSessionStatePrivate *priv =
+    meta_session_state_get_instance_private (state);
+
   meta_topic (META_DEBUG_SESSION_MANAGEMENT, "Serializing state");
 
+  priv->is_dirty = FALSE;
+
   return META_SESSION_STATE_GET_CLASS (state)->serialize (state, gvdb_data);
 }
 
@@ -73,8 +92,13 @@ meta_session_state_save_window (MetaSessionState *state,
                                 const char       *name,
                                 MetaWindow       *window)
 {
+  MetaSessionStatePrivate *priv =
+    meta_session_state_get_instance_private (state);
+
   meta_topic (META_DEBUG_SESSION_MANAGEMENT, "Saving window %s", name);
 
+  priv->is_dirty = TRUE;
+
   META_SESSION_STATE_GET_CLASS (state)->save_window (state, name, window);
 }
 
@@ -94,8 +118,13 @@ void
 meta_session_state_remove_window (MetaSessionState *state,
                                   const char       *name)
 {
+  MetaSessionStatePrivate *priv =
+    meta_session_state_get_instance_private (state);
+
   meta_topic (META_DEBUG_SESSION_MANAGEMENT, "Removing window %s", name);
 
+  priv->is_dirty = TRUE;
+
   META_SESSION_STATE_GET_CLASS (state)->remove_window (state, name);
 }
 
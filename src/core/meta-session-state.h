@@ -57,6 +57,8 @@ struct _MetaSessionStateClass
 
 const char * meta_session_state_get_name (MetaSessionState *state);
 
+gboolean meta_session_state_is_dirty (MetaSessionState *state);
+
 gboolean meta_session_state_serialize (MetaSessionState *state,
                                        GHashTable       *gvdb_data);
 
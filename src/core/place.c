@@ -431,47 +431,49 @@ avoid_being_obscured_as_second_modal_dialog (MetaWindow    *window,
 }
 
 static gboolean
-rectangle_overlaps_some_window (MtkRectangle *rect,
-                                GList        *windows)
+window_obscures_placement (MetaWindow *window)
 {
-  GList *tmp;
-  MtkRectangle dest;
-
-  tmp = windows;
-  while (tmp != NULL)
+  switch (window->type)
     {
-      MetaWindow *other = tmp->data;
-      MtkRectangle other_rect;
+    case META_WINDOW_DOCK:
+    case META_WINDOW_SPLASHSCREEN:
+    case META_WINDOW_DESKTOP:
+    case META_WINDOW_DIALOG:
+    case META_WINDOW_MODAL_DIALOG:
+    /* override redirect window types: */
+    case META_WINDOW_DROPDOWN_MENU:
+    case META_WINDOW_POPUP_MENU:
+    case META_WINDOW_TOOLTIP:
+    case META_WINDOW_NOTIFICATION:
+    case META_WINDOW_COMBO:
+    case META_WINDOW_DND:
+    case META_WINDOW_OVERRIDE_OTHER:
+      return FALSE;
 
-      switch (other->type)
-        {
-        case META_WINDOW_DOCK:
-        case META_WINDOW_SPLASHSCREEN:
-        case META_WINDOW_DESKTOP:
-        case META_WINDOW_DIALOG:
-        case META_WINDOW_MODAL_DIALOG:
-	/* override redirect window types: */
-	case META_WINDOW_DROPDOWN_MENU:
-	case META_WINDOW_POPUP_MENU:
-	case META_WINDOW_TOOLTIP:
-	case META_WINDOW_NOTIFICATION:
-	case META_WINDOW_COMBO:
-	case META_WINDOW_DND:
-	case META_WINDOW_OVERRIDE_OTHER:
-          break;
+    case META_WINDOW_NORMAL:
+    case META_WINDOW_UTILITY:
+    case META_WINDOW_TOOLBAR:
+    case META_WINDOW_MENU:
+      return TRUE;
+    }
 
-        case META_WINDOW_NORMAL:
-        case META_WINDOW_UTILITY:
-        case META_WINDOW_TOOLBAR:
-        case META_WINDOW_MENU:
-          meta_window_get_frame_rect (other, &other_rect);
+  return FALSE;
+}
 
-          if (mtk_rectangle_intersect (rect, &other_rect, &dest))
-            return TRUE;
-          break;
-        }
+static gboolean
+rectangle_overlaps_some_window (MtkRectangle *rect,
+                                GArray       *obscuring_rects)
+{
+  MtkRectangle dest;
+  unsigned int i;
 
-      tmp = tmp->next;
+  for (i = 0; i < obscuring_rects->len; i++)
+    {
+      MtkRectangle *other_rect =
+        &g_array_index (obscuring_rects, MtkRectangle, i);
+
+      if (mtk_rectangle_intersect (rect, other_rect, &dest))
+        return TRUE;
     }
 
   return FALSE;
@@ -480,16 +482,12 @@ rectangle_overlaps_some_window (MtkRectangle *rect,
 static gint
 leftmost_cmp (gconstpointer a, gconstpointer b)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
+  const MtkRectangle *a_frame = a;
+  const MtkRectangle *b_frame = b;
   int ax, bx;
 
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ax = a_frame.x;
-  bx = b_frame.x;
+  ax = a_frame->x;
+  bx = b_frame->x;
 
   if (ax < bx)
     return -1;
@@ -509,16 +507,12 @@ rightmost_cmp (gconstpointer a,
 static gint
 topmost_cmp (gconstpointer a, gconstpointer b)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
+  const MtkRectangle *a_frame = a;
+  const MtkRectangle *b_frame = b;
   int ay, by;
 
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ay = a_frame.y;
-  by = b_frame.y;
+  ay = a_frame->y;
+  by = b_frame->y;
 
   if (ay < by)
     return -1;
@@ -573,24 +567,54 @@ find_first_fit (MetaWindow         *window,
    * the bottom of each existing window, and then to the right
    * of each existing window, aligned with the left/top of the
    * existing window in each of those cases.
+   *
+   * The frame rects are looked up once up front, as every candidate
+   * position is tested against every window.
    */
   int retval;
+  g_autoptr (GArray) frame_rects = NULL;
+  g_autoptr (GArray) obscuring_rects = NULL;
+  GList *frame_rect_list = NULL;
   GList *below_sorted;
   GList *end_sorted;
   GList *tmp;
   MtkRectangle rect;
   MtkRectangle work_area;
   gboolean ltr = clutter_get_text_direction () == CLUTTER_TEXT_DIRECTION_LTR;
+  unsigned int i;
 
   retval = FALSE;
 
+  frame_rects = g_array_sized_new (FALSE, FALSE, sizeof (MtkRectangle),
+                                   g_list_length (windows));
+  obscuring_rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  for (tmp = windows; tmp; tmp = tmp->next)
+    {
+      MetaWindow *w = tmp->data;
+      MtkRectangle frame_rect;
+
+      meta_window_get_frame_rect (w, &frame_rect);
+      g_array_append_val (frame_rects, frame_rect);
+
+      if (window_obscures_placement (w))
+        g_array_append_val (obscuring_rects, frame_rect);
+    }
+
+  for (i = 0; i < frame_rects->len; i++)
+    {
+      frame_rect_list =
+        g_list_prepend (frame_rect_list,
+                        &g_array_index (frame_rects, MtkRectangle, i));
+    }
+  frame_rect_list = g_list_reverse (frame_rect_list);
+
   /* Below each window */
-  below_sorted = g_list_copy (windows);
+  below_sorted = g_list_copy (frame_rect_list);
   below_sorted = g_list_sort (below_sorted, ltr ? leftmost_cmp : rightmost_cmp);
   below_sorted = g_list_sort (below_sorted, topmost_cmp);
 
   /* To the right of each window */
-  end_sorted = g_list_copy (windows);
+  end_sorted = frame_rect_list;
   end_sorted = g_list_sort (end_sorted, topmost_cmp);
   end_sorted = g_list_sort (end_sorted, ltr ? leftmost_cmp : rightmost_cmp);
 
@@ -615,7 +639,7 @@ find_first_fit (MetaWindow         *window,
   center_tile_rect_in_area (&rect, &work_area);
 
   if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-      !rectangle_overlaps_some_window (&rect, windows))
+      !rectangle_overlaps_some_window (&rect, obscuring_rects))
     {
       *new_x = rect.x;
       *new_y = rect.y;
@@ -629,16 +653,13 @@ find_first_fit (MetaWindow         *window,
   tmp = below_sorted;
   while (tmp != NULL)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
+      MtkRectangle *frame_rect = tmp->data;
 
-      meta_window_get_frame_rect (w, &frame_rect);
-
-      rect.x = frame_rect.x;
-      rect.y = frame_rect.y + frame_rect.height;
+      rect.x = frame_rect->x;
+      rect.y = frame_rect->y + frame_rect->height;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, below_sorted))
+          !rectangle_overlaps_some_window (&rect, obscuring_rects))
         {
           *new_x = rect.x;
           *new_y = rect.y;
@@ -655,19 +676,16 @@ find_first_fit (MetaWindow         *window,
   tmp = end_sorted;
   while (tmp != NULL)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
-
-      meta_window_get_frame_rect (w, &frame_rect);
+      MtkRectangle *frame_rect = tmp->data;
 
       if (ltr)
-        rect.x = frame_rect.x + frame_rect.width;
+        rect.x = frame_rect->x + frame_rect->width;
       else
-        rect.x = frame_rect.x - rect.width;
-      rect.y = frame_rect.y;
+        rect.x = frame_rect->x - rect.width;
+      rect.y = frame_rect->y;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, end_sorted))
+          !rectangle_overlaps_some_window (&rect, obscuring_rects))
         {
           *new_x = rect.x;
           *new_y = rect.y;
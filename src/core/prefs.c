@@ -72,6 +72,9 @@
 #define SETTINGS(s) g_hash_table_lookup (settings_schemas, (s))
 
 static GList *changes = NULL;
+static guint64 pending_changes = 0;
+
+G_STATIC_ASSERT (META_PREF_IDLE_COMPACTION_TIMEOUT < 64);
 static guint changed_idle;
 static GList *listeners = NULL;
 static GHashTable *settings_schemas;
@@ -99,6 +102,7 @@ static gboolean gnome_accessibility = FALSE;
 static gboolean gnome_animations = TRUE;
 static gboolean locate_pointer_is_enabled = FALSE;
 static unsigned int check_alive_timeout = 5000;
+static unsigned int idle_compaction_timeout = 300;
 static char *cursor_theme = NULL;
 /* cursor_size will, when running as an X11 compositing window manager, be the
  * actual cursor size, multiplied with the global window scaling factor. On
@@ -507,6 +511,13 @@ static MetaUintPreference preferences_uint[] =
       },
       &check_alive_timeout,
     },
+    {
+      { "idle-compaction-timeout",
+        SCHEMA_MUTTER,
+        META_PREF_IDLE_COMPACTION_TIMEOUT,
+      },
+      &idle_compaction_timeout,
+    },
     { { NULL, 0, 0 }, NULL },
   };
 
@@ -935,6 +946,7 @@ changed_idle_handler (gpointer data)
 
   g_list_free (changes);
   changes = NULL;
+  pending_changes = 0;
 
   tmp = copy;
   while (tmp != NULL)
@@ -957,8 +969,11 @@ queue_changed (MetaPreference pref)
   meta_topic (META_DEBUG_PREFS, "Queueing change of pref %s",
               meta_preference_to_string (pref));
 
-  if (g_list_find (changes, GINT_TO_POINTER (pref)) == NULL)
-    changes = g_list_prepend (changes, GINT_TO_POINTER (pref));
+  if (!(pending_changes & (G_GUINT64_CONSTANT (1) << pref)))
+    {
+      changes = g_list_prepend (changes, GINT_TO_POINTER (pref));
+      pending_changes |= G_GUINT64_CONSTANT (1) << pref;
+    }
   else
     meta_topic (META_DEBUG_PREFS, "Change of pref %s was already pending",
                 meta_preference_to_string (pref));
@@ -1688,6 +1703,9 @@ meta_preference_to_string (MetaPreference pref)
 
     case META_PREF_CHECK_ALIVE_TIMEOUT:
       return "CHECK_ALIVE_TIMEOUT";
+
+    case META_PREF_IDLE_COMPACTION_TIMEOUT:
+      return "IDLE_COMPACTION_TIMEOUT";
     }
 
   return "(unknown)";
@@ -2040,6 +2058,12 @@ meta_prefs_get_check_alive_timeout (void)
   return check_alive_timeout;
 }
 
+unsigned int
+meta_prefs_get_idle_compaction_timeout (void)
+{
+  return idle_compaction_timeout;
+}
+
 const char *
 meta_prefs_get_iso_next_group_option (void)
 {
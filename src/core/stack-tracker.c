@@ -1327,6 +1327,63 @@ meta_stack_tracker_keep_override_redirect_on_top (MetaStackTracker *tracker)
     }
 }
 
+/*
+ * Marks the entries of @seq that are part of a longest strictly increasing
+ * subsequence, by setting in_place[seq[i]] to TRUE.
+ */
+static void
+mark_longest_increasing_subsequence (const int *seq,
+                                     int        n_seq,
+                                     gboolean  *in_place)
+{
+  g_autofree int *tails = NULL;
+  g_autofree int *prev = NULL;
+  int length = 0;
+  int i;
+
+  if (n_seq == 0)
+    return;
+
+  tails = g_new (int, n_seq);
+  prev = g_new (int, n_seq);
+
+  for (i = 0; i < n_seq; i++)
+    {
+      int low = 0;
+      int high = length;
+
+      while (low < high)
+        {
+          int mid = (low + high) / 2;
+
+          if (seq[tails[mid]] < seq[i])
+            low = mid + 1;
+          else
+            high = mid;
+        }
+
+      prev[i] = low > 0 ? tails[low - 1] : -1;
+      tails[low] = i;
+      if (low == length)
+        length++;
+    }
+
+  for (i = tails[length - 1]; i >= 0; i = prev[i])
+    in_place[seq[i]] = TRUE;
+}
+
+/*
+ * Restacks the managed windows so that they end up in the order given by
+ * @managed (bottom to top), above the guard window.
+ *
+ * Rather than walking the stack and moving every window that doesn't match,
+ * figure out the largest set of managed windows that are already in the
+ * right relative order, i.e. the longest increasing subsequence of their new
+ * positions in the current stack, and leave those alone. Every other window
+ * is moved exactly once, directly below the window that should be above it.
+ * Raising or lowering a single window thus results in a single configure
+ * request, wherever it ends up.
+ */
 void
 meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
                                     const guint64    *managed,
@@ -1335,6 +1392,12 @@ meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
   guint64 *windows;
   int n_windows;
   int old_pos, new_pos;
+  guint64 topmost_id;
+  g_autoptr (GHashTable) new_positions = NULL;
+  g_autofree int *seq = NULL;
+  g_autofree gboolean *in_place = NULL;
+  int n_seq = 0;
+  int i;
 
   COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManaged,
                            "Meta::StackTracker::restack_managed()");
@@ -1359,61 +1422,57 @@ meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
         break;
     }
   g_assert (old_pos >= 0);
+  topmost_id = windows[old_pos];
   COGL_TRACE_END (StackTrackerRestackManagedGet);
 
-  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedRaise,
-                           "Meta::StackTracker::restack_managed#raise()");
-  new_pos = n_managed - 1;
-  if (managed[new_pos] != windows[old_pos])
+  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedDiff,
+                           "Meta::StackTracker::restack_managed#diff()");
+  new_positions = g_hash_table_new (g_int64_hash, g_int64_equal);
+  for (new_pos = 0; new_pos < n_managed; new_pos++)
     {
-      /* Move the first managed window in the new stack above all managed windows */
-      meta_stack_tracker_raise_above (tracker, managed[new_pos], windows[old_pos]);
-      meta_stack_tracker_get_stack (tracker, &windows, &n_windows);
-      /* Moving managed[new_pos] above windows[old_pos], moves the window at old_pos down by one */
+      g_hash_table_insert (new_positions,
+                           (gpointer) &managed[new_pos],
+                           GINT_TO_POINTER (new_pos + 1));
     }
-  COGL_TRACE_END (StackTrackerRestackManagedRaise);
-
-  old_pos--;
-  new_pos--;
 
-  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedRestack,
-                           "Meta::StackTracker::restack_managed#restack()");
-  while (old_pos >= 0 && new_pos >= 0)
+  /* Collect the new positions of the managed windows currently above the
+   * guard window, in their current bottom to top order. */
+  seq = g_new (int, n_managed);
+  for (i = old_pos; i >= 0; i--)
     {
-      if (meta_stack_tracker_is_guard_window (tracker, windows[old_pos]))
+      if (meta_stack_tracker_is_guard_window (tracker, windows[i]))
         break;
+    }
+  for (i = i + 1; i <= old_pos && n_seq < n_managed; i++)
+    {
+      gpointer value;
 
-      if (windows[old_pos] == managed[new_pos])
-        {
-          old_pos--;
-          new_pos--;
-          continue;
-        }
+      value = g_hash_table_lookup (new_positions, &windows[i]);
+      if (value)
+        seq[n_seq++] = GPOINTER_TO_INT (value) - 1;
+    }
 
-      MetaWindow *old_window = meta_display_lookup_stack_id (tracker->display, windows[old_pos]);
-      if (!old_window || old_window->override_redirect || old_window->unmanaging)
-        {
-          old_pos--;
-          continue;
-        }
+  in_place = g_new0 (gboolean, n_managed);
+  mark_longest_increasing_subsequence (seq, n_seq, in_place);
+  COGL_TRACE_END (StackTrackerRestackManagedDiff);
 
-      meta_stack_tracker_lower_below (tracker, managed[new_pos], managed[new_pos + 1]);
-      meta_stack_tracker_get_stack (tracker, &windows, &n_windows);
-      /* Moving managed[new_pos] above windows[old_pos] moves the window at old_pos down by one,
-       * we'll examine it again to see if it matches the next new window */
-      old_pos--;
-      new_pos--;
+  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedRestack,
+                           "Meta::StackTracker::restack_managed#restack()");
+  new_pos = n_managed - 1;
+  if (!in_place[new_pos] && managed[new_pos] != topmost_id)
+    {
+      /* Move the first managed window in the new stack above all managed windows */
+      meta_stack_tracker_raise_above (tracker, managed[new_pos], topmost_id);
     }
-  COGL_TRACE_END (StackTrackerRestackManagedRestack);
 
-  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedLower,
-                           "Meta::StackTracker::restack_managed#lower()");
-  while (new_pos > 0)
+  for (new_pos = n_managed - 2; new_pos >= 0; new_pos--)
     {
-      meta_stack_tracker_lower_below (tracker, managed[new_pos], managed[new_pos - 1]);
-      new_pos--;
+      if (in_place[new_pos])
+        continue;
+
+      meta_stack_tracker_lower_below (tracker, managed[new_pos], managed[new_pos + 1]);
     }
-  COGL_TRACE_END (StackTrackerRestackManagedLower);
+  COGL_TRACE_END (StackTrackerRestackManagedRestack);
 }
 
 void
@@ -966,17 +966,71 @@ meta_stack_windows_cmp (MetaStack  *stack,
     return 0; /* not reached */
 }
 
+#ifdef HAVE_X11_CLIENT
+static MetaGroup *
+get_window_group (MetaWindow *window)
+{
+  if (window->client_type != META_WINDOW_CLIENT_TYPE_X11)
+    return NULL;
+
+  return meta_window_x11_get_group (window);
+}
+#endif
+
+/*
+ * Whether any transiency constraint involves @window. Moving a window that
+ * isn't part of any constraint keeps the relative order of all other windows,
+ * so constraints that were satisfied before the move are still satisfied
+ * after it, and there is no need to rebuild and reapply the constraint graph.
+ */
+static gboolean
+window_has_stack_constraints (MetaStack  *stack,
+                              MetaWindow *window)
+{
+#ifdef HAVE_X11_CLIENT
+  MetaGroup *group;
+#endif
+  GList *l;
+
+  if (window->transient_for)
+    return TRUE;
+
+#ifdef HAVE_X11_CLIENT
+  group = get_window_group (window);
+  if (group && WINDOW_TRANSIENT_FOR_WHOLE_GROUP (window))
+    return TRUE;
+#endif
+
+  for (l = stack->sorted; l; l = l->next)
+    {
+      MetaWindow *w = l->data;
+
+      if (w->transient_for == window)
+        return TRUE;
+
+#ifdef HAVE_X11_CLIENT
+      if (group &&
+          WINDOW_TRANSIENT_FOR_WHOLE_GROUP (w) &&
+          get_window_group (w) == group)
+        return TRUE;
+#endif
+    }
+
+  return FALSE;
+}
+
 void
 meta_window_set_stack_position_no_sync (MetaWindow *window,
                                         int         position)
 {
+  MetaStack *stack = window->display->stack;
   int low, high, delta;
   GList *tmp;
 
-  g_return_if_fail (window->display->stack != NULL);
+  g_return_if_fail (stack != NULL);
   g_return_if_fail (window->stack_position >= 0);
   g_return_if_fail (position >= 0);
-  g_return_if_fail (position < window->display->stack->n_positions);
+  g_return_if_fail (position < stack->n_positions);
 
   if (position == window->stack_position)
     {
@@ -985,8 +1039,10 @@ meta_window_set_stack_position_no_sync (MetaWindow *window,
       return;
     }
 
-  window->display->stack->need_resort = TRUE;
-  window->display->stack->need_constrain = TRUE;
+  stack->need_resort = TRUE;
+  if (!stack->need_constrain &&
+      window_has_stack_constraints (stack, window))
+    stack->need_constrain = TRUE;
 
   if (position < window->stack_position)
     {
@@ -1001,7 +1057,7 @@ meta_window_set_stack_position_no_sync (MetaWindow *window,
       delta = -1;
     }
 
-  tmp = window->display->stack->sorted;
+  tmp = stack->sorted;
   while (tmp != NULL)
     {
       MetaWindow *w = tmp->data;
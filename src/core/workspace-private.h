@@ -55,6 +55,7 @@ struct _MetaWorkspace
   GList  *list_containing_self;
 
   GHashTable *logical_monitor_data;
+  GHashTable *stale_logical_monitor_data;
 
   MtkRectangle work_area_screen;
   GList  *screen_region;
@@ -83,6 +83,10 @@ typedef struct _MetaWorkspaceLogicalMonitorData
 {
   GList *logical_monitor_region;
   MtkRectangle logical_monitor_work_area;
+
+  /* What the region was computed from */
+  MtkRectangle logical_monitor_rect;
+  GSList *struts;
 } MetaWorkspaceLogicalMonitorData;
 
 typedef struct _MetaWorkspaceFocusableAncestorData
@@ -105,6 +109,7 @@ workspace_logical_monitor_data_free (MetaWorkspaceLogicalMonitorData *data)
 {
   g_clear_pointer (&data->logical_monitor_region,
                    meta_rectangle_free_list_and_elements);
+  g_slist_free_full (data->struts, g_free);
   g_free (data);
 }
 
@@ -137,6 +142,7 @@ static void
 meta_workspace_clear_logical_monitor_data (MetaWorkspace *workspace)
 {
   g_clear_pointer (&workspace->logical_monitor_data, g_hash_table_destroy);
+  g_clear_pointer (&workspace->stale_logical_monitor_data, g_hash_table_destroy);
 }
 
 static void
@@ -783,7 +789,12 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
       workspace == workspace->manager->active_workspace)
     meta_window_drag_update_edges (window_drag);
 
-  meta_workspace_clear_logical_monitor_data (workspace);
+  /* Keep the per monitor data around until the work areas are validated
+   * again, so that the regions of monitors whose struts didn't change can be
+   * reused. */
+  g_clear_pointer (&workspace->stale_logical_monitor_data, g_hash_table_destroy);
+  workspace->stale_logical_monitor_data =
+    g_steal_pointer (&workspace->logical_monitor_data);
 
   workspace_free_all_struts (workspace);
 
@@ -827,6 +838,63 @@ copy_strut_list(GSList *original)
   return g_slist_reverse (result);
 }
 
+static GSList *
+copy_struts_overlapping (GSList             *struts,
+                         const MtkRectangle *rect)
+{
+  GSList *result = NULL;
+
+  for (; struts != NULL; struts = struts->next)
+    {
+      MetaStrut *strut = struts->data;
+
+      if (mtk_rectangle_overlap (&strut->rect, rect))
+        result = g_slist_prepend (result, copy_strut (strut));
+    }
+
+  return g_slist_reverse (result);
+}
+
+static gboolean
+strut_lists_equal (GSList *l,
+                   GSList *m)
+{
+  for (; l && m; l = l->next, m = m->next)
+    {
+      MetaStrut *a = l->data;
+      MetaStrut *b = m->data;
+
+      if (a->side != b->side ||
+          !mtk_rectangle_equal (&a->rect, &b->rect))
+        return FALSE;
+    }
+
+  return l == NULL && m == NULL;
+}
+
+static MetaWorkspaceLogicalMonitorData *
+find_stale_logical_monitor_data (MetaWorkspace      *workspace,
+                                 const MtkRectangle *logical_monitor_rect,
+                                 GSList             *struts)
+{
+  GHashTableIter iter;
+  MetaWorkspaceLogicalMonitorData *data;
+
+  if (!workspace->stale_logical_monitor_data)
+    return NULL;
+
+  g_hash_table_iter_init (&iter, workspace->stale_logical_monitor_data);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &data))
+    {
+      if (mtk_rectangle_equal (&data->logical_monitor_rect,
+                               logical_monitor_rect) &&
+          strut_lists_equal (data->struts, struts))
+        return data;
+    }
+
+  return NULL;
+}
+
 static void
 ensure_work_areas_validated (MetaWorkspace *workspace)
 {
@@ -880,17 +948,37 @@ ensure_work_areas_validated (MetaWorkspace *workspace)
     {
       MetaLogicalMonitor *logical_monitor = l->data;
       MetaWorkspaceLogicalMonitorData *data;
+      MetaWorkspaceLogicalMonitorData *stale_data;
 
       g_assert (!meta_workspace_get_logical_monitor_data (workspace,
                                                           logical_monitor));
 
       data = meta_workspace_ensure_logical_monitor_data (workspace,
                                                          logical_monitor);
-      data->logical_monitor_region =
-        meta_rectangle_get_minimal_spanning_set_for_region (
-          &logical_monitor->rect,
-          workspace->all_struts);
+      data->logical_monitor_rect = logical_monitor->rect;
+
+      /* Only struts overlapping the monitor affect its region, so if those
+       * are the same as last time, so is the region. */
+      data->struts = copy_struts_overlapping (workspace->all_struts,
+                                              &logical_monitor->rect);
+
+      stale_data = find_stale_logical_monitor_data (workspace,
+                                                    &logical_monitor->rect,
+                                                    data->struts);
+      if (stale_data)
+        {
+          data->logical_monitor_region =
+            g_steal_pointer (&stale_data->logical_monitor_region);
+        }
+      else
+        {
+          data->logical_monitor_region =
+            meta_rectangle_get_minimal_spanning_set_for_region (
+              &logical_monitor->rect,
+              data->struts);
+        }
     }
+  g_clear_pointer (&workspace->stale_logical_monitor_data, g_hash_table_destroy);
 
   workspace->screen_region =
     meta_rectangle_get_minimal_spanning_set_for_region (
@@ -1021,23 +1109,6 @@ ensure_work_areas_validated (MetaWorkspace *workspace)
   workspace->work_areas_invalid = FALSE;
 }
 
-static gboolean
-strut_lists_equal (GSList *l,
-                   GSList *m)
-{
-  for (; l && m; l = l->next, m = m->next)
-    {
-      MetaStrut *a = l->data;
-      MetaStrut *b = m->data;
-
-      if (a->side != b->side ||
-          !mtk_rectangle_equal (&a->rect, &b->rect))
-        return FALSE;
-    }
-
-  return l == NULL && m == NULL;
-}
-
 /**
  * meta_workspace_set_builtin_struts:
  * @workspace: a #MetaWorkspace
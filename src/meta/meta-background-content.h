@@ -55,6 +55,11 @@ void meta_background_content_set_vignette (MetaBackgroundContent *self,
                                            double                 brightness,
                                            double                 sharpness);
 
+META_EXPORT
+void meta_background_content_set_blur (MetaBackgroundContent *self,
+                                       int                    radius,
+                                       double                 brightness);
+
 META_EXPORT
 void meta_background_content_set_rounded_clip_radius (MetaBackgroundContent *self,
                                                       float                  radius);
@@ -42,6 +42,19 @@ typedef enum
   META_LATER_IDLE
 } MetaLaterType;
 
+/**
+ * MetaLaterFlags:
+ * @META_LATER_FLAG_NONE: no flags
+ * @META_LATER_FLAG_DEFERRABLE: the callback may be postponed to the next
+ *   stage update, when the laters already run during the current one took
+ *   too long. A deferred callback is never postponed twice in a row.
+ **/
+typedef enum
+{
+  META_LATER_FLAG_NONE = 0,
+  META_LATER_FLAG_DEFERRABLE = 1 << 0,
+} MetaLaterFlags;
+
 #define META_TYPE_LATERS (meta_laters_get_type ())
 META_EXPORT
 G_DECLARE_FINAL_TYPE (MetaLaters, meta_laters, META, LATERS, GObject)
@@ -53,6 +66,14 @@ unsigned int meta_laters_add (MetaLaters     *laters,
                               gpointer        user_data,
                               GDestroyNotify  notify);
 
+META_EXPORT
+unsigned int meta_laters_add_full (MetaLaters     *laters,
+                                   MetaLaterType   when,
+                                   MetaLaterFlags  flags,
+                                   GSourceFunc     func,
+                                   gpointer        user_data,
+                                   GDestroyNotify  notify);
+
 META_EXPORT
 void meta_laters_remove (MetaLaters   *laters,
                          unsigned int  later_id);
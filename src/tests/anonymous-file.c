@@ -269,6 +269,20 @@ main (int    argc,
   meta_anonymous_file_close_fd (other_fd);
 #endif
 
+  /* The file must stay usable until the last reference is released */
+  fd = other_fd = -1;
+  meta_anonymous_file_ref (file);
+  meta_anonymous_file_free (file);
+
+  fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  if (fd == -1)
+    goto fail;
+
+  if (!test_read_fd_mmap (fd, teststring))
+    goto fail;
+
+  meta_anonymous_file_close_fd (fd);
+
   meta_anonymous_file_free (file);
   return EXIT_SUCCESS;
 
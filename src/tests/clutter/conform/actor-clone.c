@@ -5,6 +5,94 @@
 
 #include "tests/clutter-test-utils.h"
 
+typedef struct _FooContent      FooContent;
+typedef struct _FooContentClass FooContentClass;
+
+struct _FooContentClass
+{
+  GObjectClass parent_class;
+};
+
+struct _FooContent
+{
+  GObject parent;
+
+  GPtrArray *painted_actors;
+};
+
+GType foo_content_get_type (void) G_GNUC_CONST;
+
+static void clutter_content_iface_init (ClutterContentInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (FooContent, foo_content, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                clutter_content_iface_init))
+
+static void
+foo_content_paint_content (ClutterContent      *content,
+                           ClutterActor        *actor,
+                           ClutterPaintNode    *root,
+                           ClutterPaintContext *paint_context)
+{
+  FooContent *foo_content = (FooContent *) content;
+  g_autoptr (ClutterPaintNode) node = NULL;
+  ClutterActorBox box;
+  CoglColor color;
+
+  g_ptr_array_add (foo_content->painted_actors, actor);
+
+  clutter_actor_get_content_box (actor, &box);
+
+  cogl_color_init_from_4f (&color, 1.f, 0.f, 0.f, 1.f);
+  node = clutter_color_node_new (&color);
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+}
+
+static void
+clutter_content_iface_init (ClutterContentInterface *iface)
+{
+  iface->paint_content = foo_content_paint_content;
+}
+
+static void
+foo_content_finalize (GObject *object)
+{
+  FooContent *foo_content = (FooContent *) object;
+
+  g_ptr_array_unref (foo_content->painted_actors);
+
+  G_OBJECT_CLASS (foo_content_parent_class)->finalize (object);
+}
+
+static void
+foo_content_class_init (FooContentClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = foo_content_finalize;
+}
+
+static void
+foo_content_init (FooContent *self)
+{
+  self->painted_actors = g_ptr_array_new ();
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  g_autoptr (GMainLoop) main_loop = g_main_loop_new (NULL, FALSE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_swapped (stage, "after-paint",
+                                            G_CALLBACK (g_main_loop_quit),
+                                            main_loop);
+
+  clutter_actor_queue_redraw (stage);
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+}
+
 static void
 on_presented (ClutterStage     *stage,
               ClutterStageView *view,
@@ -63,6 +151,68 @@ actor_clone_unmapped (void)
   g_assert_null (container);
 }
 
+static void
+actor_clone_source_content (void)
+{
+  g_autoptr (ClutterContent) content = NULL;
+  FooContent *foo_content;
+  ClutterActor *stage;
+  ClutterActor *actor;
+  ClutterActor *clone;
+  guchar *pixel;
+
+  stage = clutter_test_get_stage ();
+
+  content = g_object_new (foo_content_get_type (), NULL);
+  foo_content = (FooContent *) content;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, 50, 50);
+  clutter_actor_set_content (actor, content);
+  clutter_actor_add_child (stage, actor);
+
+  clone = clutter_clone_new (actor);
+  clutter_actor_set_position (clone, 100, 0);
+  clutter_actor_set_size (clone, 100, 100);
+  clutter_actor_add_child (stage, clone);
+
+  clutter_actor_show (stage);
+
+  /* By default the clone paints the source, which paints the content */
+  g_assert_false (clutter_clone_get_use_source_content (CLUTTER_CLONE (clone)));
+  wait_for_paint (stage);
+  g_ptr_array_set_size (foo_content->painted_actors, 0);
+  wait_for_paint (stage);
+  g_assert_cmpuint (foo_content->painted_actors->len, ==, 2);
+  g_assert_true (g_ptr_array_index (foo_content->painted_actors, 0) == actor);
+  g_assert_true (g_ptr_array_index (foo_content->painted_actors, 1) == actor);
+
+  /* With the source content, the clone paints it for itself */
+  clutter_clone_set_use_source_content (CLUTTER_CLONE (clone), TRUE);
+  g_ptr_array_set_size (foo_content->painted_actors, 0);
+  wait_for_paint (stage);
+  g_assert_cmpuint (foo_content->painted_actors->len, ==, 2);
+  g_assert_true (g_ptr_array_index (foo_content->painted_actors, 0) == actor);
+  g_assert_true (g_ptr_array_index (foo_content->painted_actors, 1) == clone);
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), 190, 90, 1, 1);
+  g_assert_cmpint (pixel[0], ==, 0xff);
+  g_assert_cmpint (pixel[1], ==, 0x00);
+  g_assert_cmpint (pixel[2], ==, 0x00);
+  g_free (pixel);
+
+  /* Sources painting more than their content are painted as usual */
+  clutter_actor_add_child (actor, clutter_actor_new ());
+  g_ptr_array_set_size (foo_content->painted_actors, 0);
+  wait_for_paint (stage);
+  g_assert_cmpuint (foo_content->painted_actors->len, ==, 2);
+  g_assert_true (g_ptr_array_index (foo_content->painted_actors, 1) == actor);
+
+  clutter_actor_destroy (clone);
+  clutter_actor_destroy (actor);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/clone/unmapped", actor_clone_unmapped)
+  CLUTTER_TEST_UNIT ("/actor/clone/source-content", actor_clone_source_content)
 )
@@ -92,7 +92,67 @@ actor_margin_layout (void)
   clutter_actor_destroy (vase);
 }
 
+static void
+on_queue_relayout (ClutterActor *actor,
+                   int          *n_queued)
+{
+  (*n_queued)++;
+}
+
+static void
+actor_relayout_boundary (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *shelf;
+  ClutterActor *vase;
+  ClutterActor *flower[2];
+  graphene_point_t p;
+  int n_queued = 0;
+
+  shelf = clutter_actor_new ();
+  clutter_actor_set_name (shelf, "Shelf");
+  clutter_actor_set_layout_manager (shelf, clutter_box_layout_new ());
+  clutter_actor_add_child (stage, shelf);
+
+  vase = clutter_actor_new ();
+  clutter_actor_set_name (vase, "Vase");
+  clutter_actor_set_size (vase, 300, 100);
+  clutter_actor_set_layout_manager (vase, clutter_flow_layout_new (CLUTTER_ORIENTATION_HORIZONTAL));
+  clutter_actor_add_child (shelf, vase);
+
+  flower[0] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[0], &COGL_COLOR_INIT (255, 0, 0, 255));
+  clutter_actor_set_size (flower[0], 50, 50);
+  clutter_actor_set_name (flower[0], "Red Flower");
+  clutter_actor_add_child (vase, flower[0]);
+
+  flower[1] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[1], &COGL_COLOR_INIT (255, 255, 0, 255));
+  clutter_actor_set_size (flower[1], 50, 50);
+  clutter_actor_set_name (flower[1], "Yellow Flower");
+  clutter_actor_add_child (vase, flower[1]);
+
+  graphene_point_init (&p, 75, 25);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  g_signal_connect (shelf, "queue-relayout",
+                    G_CALLBACK (on_queue_relayout), &n_queued);
+
+  /* The vase has a fixed size, so the shelf doesn't need a new layout */
+  clutter_actor_set_size (flower[0], 100, 50);
+  g_assert_cmpint (n_queued, ==, 0);
+
+  graphene_point_init (&p, 125, 25);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  clutter_actor_set_size (vase, 400, 100);
+  g_assert_cmpint (n_queued, >, 0);
+
+  clutter_actor_destroy (shelf);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/layout/basic", actor_basic_layout)
   CLUTTER_TEST_UNIT ("/actor/layout/margin", actor_margin_layout)
+  CLUTTER_TEST_UNIT ("/actor/layout/relayout-boundary", actor_relayout_boundary)
 )
@@ -0,0 +1,132 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_node_count;
+};
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint_node (ClutterActor        *actor,
+                      ClutterPaintNode    *root,
+                      ClutterPaintContext *paint_context)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  g_autoptr (ClutterPaintNode) node = NULL;
+  ClutterActorBox box;
+  CoglColor color;
+
+  foo_actor->paint_node_count++;
+
+  clutter_actor_get_allocation_box (actor, &box);
+  clutter_actor_box_set_origin (&box, 0.f, 0.f);
+
+  cogl_color_init_from_4f (&color, 1.f, 0.f, 0.f, 1.f);
+  node = clutter_color_node_new (&color);
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint_node = foo_actor_paint_node;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  g_autoptr (GMainLoop) main_loop = g_main_loop_new (NULL, FALSE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_swapped (stage, "after-paint",
+                                            G_CALLBACK (g_main_loop_quit),
+                                            main_loop);
+
+  clutter_actor_queue_redraw (stage);
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+}
+
+static void
+actor_paint_nodes_retained (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  FooActor *foo_actor;
+  ClutterActor *actor;
+  guchar *pixel;
+
+  foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  actor = CLUTTER_ACTOR (foo_actor);
+  clutter_actor_set_size (actor, 100, 100);
+  clutter_actor_add_child (stage, actor);
+  clutter_actor_show (stage);
+
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, >, 0);
+
+  /* Without retaining, every stage redraw builds the nodes again */
+  foo_actor->paint_node_count = 0;
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  clutter_actor_set_retain_paint_nodes (actor, TRUE);
+  g_assert_true (clutter_actor_get_retain_paint_nodes (actor));
+
+  /* The first paint builds the nodes to retain */
+  foo_actor->paint_node_count = 0;
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  /* Unchanged actors replay the retained nodes */
+  foo_actor->paint_node_count = 0;
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 0);
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), 50, 50, 1, 1);
+  g_assert_cmpint (pixel[0], ==, 0xff);
+  g_assert_cmpint (pixel[1], ==, 0x00);
+  g_assert_cmpint (pixel[2], ==, 0x00);
+  g_free (pixel);
+
+  /* Queueing a redraw on the actor drops the retained nodes */
+  foo_actor->paint_node_count = 0;
+  clutter_actor_queue_redraw (actor);
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  /* So does painting it with a different transformation */
+  foo_actor->paint_node_count = 0;
+  clutter_actor_set_position (actor, 10, 10);
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  clutter_actor_destroy (actor);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/paint-nodes/retained", actor_paint_nodes_retained)
+)
@@ -17,6 +17,7 @@ typedef struct _FakeHwClock
 
   int64_t next_presentation_time_us;
   gboolean has_pending_present;
+  int64_t gpu_rendering_duration_us;
 } FakeHwClock;
 
 typedef struct _FrameClockTest
@@ -52,6 +53,13 @@ fake_hw_clock_source_dispatch (GSource     *source,
 
       fake_hw_clock->has_pending_present = FALSE;
       init_frame_info (&frame_info, g_source_get_time (source));
+      if (fake_hw_clock->gpu_rendering_duration_us)
+        {
+          frame_info.has_valid_gpu_rendering_duration = TRUE;
+          frame_info.gpu_rendering_duration_ns =
+            fake_hw_clock->gpu_rendering_duration_us * 1000;
+          frame_info.cpu_time_before_buffer_swap_us = g_get_monotonic_time ();
+        }
       clutter_frame_clock_notify_presented (frame_clock, &frame_info);
       if (callback)
         callback (user_data);
@@ -838,6 +846,188 @@ frame_clock_notify_ready (void)
   clutter_frame_clock_destroy (frame_clock);
 }
 
+typedef struct _TripleBufferingTest
+{
+  FakeHwClock *fake_hw_clock;
+  GMainLoop *main_loop;
+
+  int n_frames_in_flight;
+  int max_frames_in_flight;
+} TripleBufferingTest;
+
+static ClutterFrameResult
+triple_buffering_frame_clock_frame (ClutterFrameClock *frame_clock,
+                                    ClutterFrame      *frame,
+                                    gpointer           user_data)
+{
+  TripleBufferingTest *test = user_data;
+
+  g_assert_cmpint (clutter_frame_get_count (frame), ==, expected_frame_count);
+
+  expected_frame_count++;
+
+  if (test_frame_count == 0)
+    {
+      g_main_loop_quit (test->main_loop);
+      return CLUTTER_FRAME_RESULT_IDLE;
+    }
+
+  test_frame_count--;
+
+  test->n_frames_in_flight++;
+  test->max_frames_in_flight = MAX (test->max_frames_in_flight,
+                                    test->n_frames_in_flight);
+  g_assert_cmpint (test->n_frames_in_flight, <=, 2);
+
+  test->fake_hw_clock->has_pending_present = TRUE;
+  clutter_frame_clock_schedule_update (frame_clock);
+
+  return CLUTTER_FRAME_RESULT_PENDING_PRESENTED;
+}
+
+static const ClutterFrameListenerIface triple_buffering_frame_listener_iface = {
+  .frame = triple_buffering_frame_clock_frame,
+};
+
+static gboolean
+triple_buffering_presented_hw_callback (gpointer user_data)
+{
+  TripleBufferingTest *test = user_data;
+
+  g_assert_cmpint (test->n_frames_in_flight, >, 0);
+
+  test->n_frames_in_flight--;
+  if (test->n_frames_in_flight > 0)
+    test->fake_hw_clock->has_pending_present = TRUE;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+frame_clock_triple_buffering (void)
+{
+  TripleBufferingTest test = { 0 };
+  ClutterFrameClock *frame_clock;
+  FakeHwClock *fake_hw_clock;
+  GSource *source;
+  g_autoptr (GString) debug_info = NULL;
+
+  test_frame_count = 20;
+  expected_frame_count = 0;
+
+  test.main_loop = g_main_loop_new (NULL, FALSE);
+  frame_clock = clutter_frame_clock_new (refresh_rate,
+                                         0,
+                                         NULL,
+                                         &triple_buffering_frame_listener_iface,
+                                         &test);
+
+  fake_hw_clock = fake_hw_clock_new (frame_clock,
+                                     triple_buffering_presented_hw_callback,
+                                     &test);
+  /* Make each frame appear to take longer than a refresh interval. */
+  fake_hw_clock->gpu_rendering_duration_us = (refresh_interval_us * 3) / 2;
+  source = &fake_hw_clock->source;
+  g_source_attach (source, NULL);
+
+  test.fake_hw_clock = fake_hw_clock;
+
+  clutter_frame_clock_schedule_update (frame_clock);
+  g_main_loop_run (test.main_loop);
+
+  g_assert_cmpint (test.max_frames_in_flight, ==, 2);
+
+  debug_info = clutter_frame_clock_get_max_render_time_debug_info (frame_clock);
+  g_assert_nonnull (g_strstr_len (debug_info->str, -1,
+                                  "Buffering: triple"));
+
+  g_main_loop_unref (test.main_loop);
+
+  clutter_frame_clock_destroy (frame_clock);
+  g_source_destroy (source);
+  g_source_unref (source);
+}
+
+typedef struct _FrameRepeatTest
+{
+  GMainLoop *main_loop;
+
+  int n_content_frames;
+  int n_repeated_frames;
+} FrameRepeatTest;
+
+static ClutterFrameResult
+frame_repeat_frame_clock_frame (ClutterFrameClock *frame_clock,
+                                ClutterFrame      *frame,
+                                gpointer           user_data)
+{
+  FrameRepeatTest *test = user_data;
+  ClutterFrameInfo frame_info;
+
+  if (clutter_frame_is_repeat (frame))
+    test->n_repeated_frames++;
+  else
+    test->n_content_frames++;
+
+  if (test->n_content_frames == 10)
+    {
+      g_main_loop_quit (test->main_loop);
+      return CLUTTER_FRAME_RESULT_IDLE;
+    }
+
+  frame_info = (ClutterFrameInfo) {
+    .presentation_time = g_get_monotonic_time (),
+    .refresh_rate = 144.0,
+    .flags = CLUTTER_FRAME_INFO_FLAG_NONE,
+  };
+  clutter_frame_clock_notify_presented (frame_clock, &frame_info);
+
+  return CLUTTER_FRAME_RESULT_PENDING_PRESENTED;
+}
+
+static const ClutterFrameListenerIface frame_repeat_frame_listener_iface = {
+  .frame = frame_repeat_frame_clock_frame,
+};
+
+static gboolean
+schedule_content_update_timeout (gpointer user_data)
+{
+  ClutterFrameClock *frame_clock = user_data;
+
+  clutter_frame_clock_schedule_update_now (frame_clock);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+frame_clock_vrr_frame_repeat (void)
+{
+  FrameRepeatTest test = { 0 };
+  ClutterFrameClock *frame_clock;
+  guint timeout_id;
+
+  test.main_loop = g_main_loop_new (NULL, FALSE);
+  frame_clock = clutter_frame_clock_new (144.0,
+                                         0,
+                                         NULL,
+                                         &frame_repeat_frame_listener_iface,
+                                         &test);
+  clutter_frame_clock_set_mode (frame_clock, CLUTTER_FRAME_CLOCK_MODE_VARIABLE);
+  clutter_frame_clock_set_minimum_refresh_rate (frame_clock, 48.0);
+
+  /* Content updating at about 33 FPS, below the 48 Hz minimum. */
+  timeout_id = g_timeout_add (30, schedule_content_update_timeout, frame_clock);
+
+  clutter_frame_clock_schedule_update_now (frame_clock);
+  g_main_loop_run (test.main_loop);
+
+  g_assert_cmpint (test.n_repeated_frames, >, 0);
+
+  g_source_remove (timeout_id);
+  g_main_loop_unref (test.main_loop);
+  clutter_frame_clock_destroy (frame_clock);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/schedule-update", frame_clock_schedule_update)
   CLUTTER_TEST_UNIT ("/frame-clock/immediate-present", frame_clock_immediate_present)
@@ -849,4 +1039,6 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/reschedule-on-idle", frame_clock_reschedule_on_idle)
   CLUTTER_TEST_UNIT ("/frame-clock/destroy-signal", frame_clock_destroy_signal)
   CLUTTER_TEST_UNIT ("/frame-clock/notify-ready", frame_clock_notify_ready)
+  CLUTTER_TEST_UNIT ("/frame-clock/triple-buffering", frame_clock_triple_buffering)
+  CLUTTER_TEST_UNIT ("/frame-clock/vrr-frame-repeat", frame_clock_vrr_frame_repeat)
 )
@@ -548,6 +548,43 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *text1, *text2;
+  PangoLayout *layout1, *layout2;
+
+  text1 = CLUTTER_TEXT (clutter_text_new_full ("Sans 10", "Shared text", NULL));
+  text2 = CLUTTER_TEXT (clutter_text_new_full ("Sans 10", "Shared text", NULL));
+  g_object_ref_sink (text1);
+  g_object_ref_sink (text2);
+
+  clutter_actor_set_size (CLUTTER_ACTOR (text1), 200, 20);
+  clutter_actor_set_size (CLUTTER_ACTOR (text2), 200, 20);
+
+  /* Equivalent texts share the same laid out layout */
+  layout1 = clutter_text_get_layout (text1);
+  layout2 = clutter_text_get_layout (text2);
+  g_assert_true (layout1 == layout2);
+
+  /* but not once they differ */
+  clutter_text_set_text (text2, "Other text");
+  layout2 = clutter_text_get_layout (text2);
+  g_assert_true (layout1 != layout2);
+  g_assert_cmpstr (pango_layout_get_text (layout1), ==, "Shared text");
+  g_assert_cmpstr (pango_layout_get_text (layout2), ==, "Other text");
+
+  clutter_actor_set_width (CLUTTER_ACTOR (text2), 100);
+  clutter_text_set_text (text2, "Shared text");
+  layout2 = clutter_text_get_layout (text2);
+  g_assert_true (layout1 != layout2);
+  g_assert_cmpint (pango_layout_get_width (layout1), !=,
+                   pango_layout_get_width (layout2));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text1));
+  clutter_actor_destroy (CLUTTER_ACTOR (text2));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -562,4 +599,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
 )
@@ -72,6 +72,56 @@ test_journal_unref_flush (void)
   g_object_unref (texture);
 }
 
+static void
+find_perf_counter (const char *name,
+                   const char *description,
+                   int64_t     value,
+                   gpointer    user_data)
+{
+  int64_t *journal_quads = user_data;
+
+  if (g_str_equal (name, "JournalQuads"))
+    *journal_quads = value;
+}
+
+static void
+test_journal_perf_counters (void)
+{
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+  CoglPipeline *pipeline;
+  int64_t journal_quads = -1;
+
+  texture = cogl_texture_2d_new_with_size (test_ctx, 2, 2);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+
+  /* Drop whatever was counted before */
+  cogl_perf_counters_end_frame ();
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_framebuffer_draw_rectangle (COGL_FRAMEBUFFER (offscreen),
+                                   pipeline,
+                                   -1, -1, 0, 0);
+  cogl_framebuffer_draw_rectangle (COGL_FRAMEBUFFER (offscreen),
+                                   pipeline,
+                                   0, 0, 1, 1);
+  g_object_unref (pipeline);
+
+  cogl_framebuffer_flush (COGL_FRAMEBUFFER (offscreen));
+
+  cogl_perf_counters_end_frame ();
+  cogl_perf_counters_foreach (find_perf_counter, &journal_quads);
+  g_assert_cmpint (journal_quads, ==, 2);
+
+  cogl_perf_counters_end_frame ();
+  cogl_perf_counters_foreach (find_perf_counter, &journal_quads);
+  g_assert_cmpint (journal_quads, ==, 0);
+
+  g_object_unref (offscreen);
+  g_object_unref (texture);
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/journal/unref-flush", test_journal_unref_flush);
+  g_test_add_func ("/journal/perf-counters", test_journal_perf_counters);
 )
@@ -0,0 +1,73 @@
+#include <cogl/cogl.h>
+
+#include "tests/cogl-test-utils.h"
+
+#define BITMAP_SIZE 16
+
+static void
+on_read_pixels (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (source_object);
+  gboolean *done = user_data;
+  g_autoptr (GError) error = NULL;
+  gboolean ret;
+
+  ret = cogl_framebuffer_read_pixels_into_bitmap_finish (framebuffer,
+                                                         result,
+                                                         &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  *done = TRUE;
+}
+
+static void
+test_read_pixels_async (void)
+{
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  CoglPixelBuffer *buffer;
+  gboolean done = FALSE;
+  uint8_t *map;
+  int rowstride;
+  int x, y;
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR,
+                            1.0f, 0.0f, 1.0f, 1.0f);
+
+  bitmap = cogl_bitmap_new_with_size (test_ctx,
+                                      BITMAP_SIZE, BITMAP_SIZE,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  buffer = cogl_bitmap_get_buffer (bitmap);
+  g_assert_true (COGL_IS_PIXEL_BUFFER (buffer));
+
+  cogl_framebuffer_read_pixels_into_bitmap_async (test_fb,
+                                                  0, 0,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER,
+                                                  bitmap,
+                                                  NULL,
+                                                  on_read_pixels,
+                                                  &done);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  rowstride = cogl_bitmap_get_rowstride (bitmap);
+  map = cogl_buffer_map (COGL_BUFFER (buffer),
+                         COGL_BUFFER_ACCESS_READ,
+                         0);
+  g_assert_nonnull (map);
+
+  for (y = 0; y < BITMAP_SIZE; y++)
+    {
+      for (x = 0; x < BITMAP_SIZE; x++)
+        test_utils_compare_pixel (map + y * rowstride + x * 4, 0xff00ffff);
+    }
+
+  cogl_buffer_unmap (COGL_BUFFER (buffer));
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/framebuffer/read-pixels-async", test_read_pixels_async);
+)
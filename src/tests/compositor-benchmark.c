@@ -0,0 +1,623 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless compositor benchmark. A number of continuously redrawing
+ * Wayland clients are mapped, and a set of scripted scenes (an overview
+ * like zoom out, a window drag and an interactive-like resize) are
+ * animated, while frame times, frame intervals, main thread CPU time per
+ * frame phase, and heap growth are recorded. The results are written as
+ * JSON, to stdout or to the file passed with --output.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+#include "backends/meta-monitor-manager-private.h"
+#include "backends/meta-virtual-monitor.h"
+#include "meta-test/meta-context-test.h"
+#include "meta/meta-wayland-compositor.h"
+#include "meta/meta-window-actor.h"
+#include "meta/window.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-driver.h"
+#include "tests/meta-wayland-test-utils.h"
+
+#define MONITOR_WIDTH 1920
+#define MONITOR_HEIGHT 1080
+#define MONITOR_REFRESH_RATE 60.0
+
+typedef struct _FrameStats
+{
+  GArray *frame_times_us;
+  GArray *frame_intervals_us;
+
+  int64_t update_cpu_time_us;
+  int64_t paint_cpu_time_us;
+  int64_t finish_cpu_time_us;
+
+  int64_t frame_start_time_us;
+  int64_t phase_start_cpu_time_us;
+  int64_t last_presentation_time_us;
+
+  size_t heap_size_start;
+  size_t heap_size_end;
+} FrameStats;
+
+typedef struct _BenchmarkScene
+{
+  const char *name;
+  void (* step) (double progress);
+  void (* reset) (void);
+} BenchmarkScene;
+
+static MetaContext *test_context;
+static MetaWaylandTestDriver *test_driver;
+static MetaVirtualMonitor *virtual_monitor;
+static GPtrArray *windows;
+static FrameStats *current_stats;
+
+static int n_clients = 4;
+static char *buffer_type = NULL;
+static char *render_node = NULL;
+static int scene_duration_ms = 3000;
+static char *output_path = NULL;
+
+static const GOptionEntry benchmark_options[] = {
+  {
+    "n-clients", 0, 0, G_OPTION_ARG_INT,
+    &n_clients,
+    "Number of clients to map (default: 4)",
+    "N"
+  },
+  {
+    "buffer-type", 0, 0, G_OPTION_ARG_STRING,
+    &buffer_type,
+    "Client buffer type, 'shm' or 'dma-buf' (default: shm)",
+    "TYPE"
+  },
+  {
+    "render-node", 0, 0, G_OPTION_ARG_FILENAME,
+    &render_node,
+    "Render node clients allocate dma-bufs from "
+    "(default: /dev/dri/renderD128)",
+    "PATH"
+  },
+  {
+    "scene-duration", 0, 0, G_OPTION_ARG_INT,
+    &scene_duration_ms,
+    "Duration of each scene in milliseconds (default: 3000)",
+    "MS"
+  },
+  {
+    "output", 0, 0, G_OPTION_ARG_FILENAME,
+    &output_path,
+    "File to write the JSON results to (default: stdout)",
+    "PATH"
+  },
+  { NULL }
+};
+
+static int64_t
+get_thread_cpu_time_us (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+
+  return ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+static size_t
+get_heap_size (void)
+{
+#ifdef HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2 ();
+
+  return info.uordblks;
+#else
+  return 0;
+#endif
+}
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  ClutterFrame     *frame)
+{
+  if (!current_stats)
+    return;
+
+  current_stats->frame_start_time_us = g_get_monotonic_time ();
+  current_stats->phase_start_cpu_time_us = get_thread_cpu_time_us ();
+}
+
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame)
+{
+  int64_t cpu_time_us;
+
+  if (!current_stats || !current_stats->frame_start_time_us)
+    return;
+
+  cpu_time_us = get_thread_cpu_time_us ();
+  current_stats->update_cpu_time_us +=
+    cpu_time_us - current_stats->phase_start_cpu_time_us;
+  current_stats->phase_start_cpu_time_us = cpu_time_us;
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame)
+{
+  int64_t cpu_time_us;
+
+  if (!current_stats || !current_stats->frame_start_time_us)
+    return;
+
+  cpu_time_us = get_thread_cpu_time_us ();
+  current_stats->paint_cpu_time_us +=
+    cpu_time_us - current_stats->phase_start_cpu_time_us;
+  current_stats->phase_start_cpu_time_us = cpu_time_us;
+}
+
+static void
+on_after_update (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame)
+{
+  int64_t frame_time_us;
+
+  if (!current_stats || !current_stats->frame_start_time_us)
+    return;
+
+  current_stats->finish_cpu_time_us +=
+    get_thread_cpu_time_us () - current_stats->phase_start_cpu_time_us;
+
+  frame_time_us = g_get_monotonic_time () - current_stats->frame_start_time_us;
+  g_array_append_val (current_stats->frame_times_us, frame_time_us);
+
+  current_stats->frame_start_time_us = 0;
+}
+
+static void
+on_presented (ClutterStage     *stage,
+              ClutterStageView *view,
+              ClutterFrameInfo *frame_info)
+{
+  int64_t presentation_time_us = frame_info->presentation_time;
+
+  if (!current_stats || !presentation_time_us)
+    return;
+
+  if (current_stats->last_presentation_time_us)
+    {
+      int64_t interval_us =
+        presentation_time_us - current_stats->last_presentation_time_us;
+
+      g_array_append_val (current_stats->frame_intervals_us, interval_us);
+    }
+
+  current_stats->last_presentation_time_us = presentation_time_us;
+}
+
+static void
+get_stage_size (float *width,
+                float *height)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+
+  clutter_actor_get_size (stage, width, height);
+}
+
+static ClutterActor *
+get_window_actor (MetaWindow *window)
+{
+  return CLUTTER_ACTOR (meta_window_get_compositor_private (window));
+}
+
+static void
+overview_step (double progress)
+{
+  float stage_width, stage_height;
+  int n_columns, n_rows;
+  float cell_width, cell_height;
+  unsigned int i;
+
+  get_stage_size (&stage_width, &stage_height);
+
+  n_columns = (int) ceil (sqrt (windows->len));
+  n_rows = (windows->len + n_columns - 1) / n_columns;
+  cell_width = stage_width / n_columns;
+  cell_height = stage_height / n_rows;
+
+  for (i = 0; i < windows->len; i++)
+    {
+      ClutterActor *actor = get_window_actor (g_ptr_array_index (windows, i));
+      float x, y, width, height;
+      float target_scale, target_x, target_y;
+      float scale;
+
+      clutter_actor_get_position (actor, &x, &y);
+      clutter_actor_get_size (actor, &width, &height);
+
+      target_scale = MIN (cell_width / width, cell_height / height) * 0.9f;
+      target_scale = MIN (target_scale, 1.0f);
+      target_x = (i % n_columns) * cell_width +
+                 (cell_width - width * target_scale) / 2.0f;
+      target_y = (i / n_columns) * cell_height +
+                 (cell_height - height * target_scale) / 2.0f;
+
+      scale = 1.0f + (target_scale - 1.0f) * (float) progress;
+      clutter_actor_set_scale (actor, scale, scale);
+      clutter_actor_set_translation (actor,
+                                     (target_x - x) * (float) progress,
+                                     (target_y - y) * (float) progress,
+                                     0.0f);
+    }
+}
+
+static void
+overview_reset (void)
+{
+  unsigned int i;
+
+  for (i = 0; i < windows->len; i++)
+    {
+      ClutterActor *actor = get_window_actor (g_ptr_array_index (windows, i));
+
+      clutter_actor_set_scale (actor, 1.0, 1.0);
+      clutter_actor_set_translation (actor, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+static void
+window_drag_step (double progress)
+{
+  MetaWindow *window = g_ptr_array_index (windows, 0);
+  float stage_width, stage_height;
+  MtkRectangle rect;
+  double angle = progress * 2 * G_PI;
+  double radius;
+
+  get_stage_size (&stage_width, &stage_height);
+  meta_window_get_frame_rect (window, &rect);
+
+  radius = MIN (stage_width, stage_height) / 3.0;
+  meta_window_move_frame (window, TRUE,
+                          (int) (stage_width / 2 + radius * cos (angle) -
+                                 rect.width / 2.0),
+                          (int) (stage_height / 2 + radius * sin (angle) -
+                                 rect.height / 2.0));
+}
+
+static void
+window_resize_step (double progress)
+{
+  MetaWindow *window = g_ptr_array_index (windows, 0);
+
+  meta_window_resize_frame (window, TRUE,
+                            (int) (400 + 800 * progress),
+                            (int) (300 + 500 * progress));
+}
+
+static void
+window_resize_reset (void)
+{
+  window_resize_step (0.0);
+}
+
+static const BenchmarkScene scenes[] = {
+  { "overview", overview_step, overview_reset },
+  { "window-drag", window_drag_step, NULL },
+  { "window-resize", window_resize_step, window_resize_reset },
+};
+
+static void
+on_scene_new_frame (ClutterTimeline      *timeline,
+                    int                   msecs,
+                    const BenchmarkScene *scene)
+{
+  double progress = clutter_timeline_get_progress (timeline);
+
+  /* Go there and back again */
+  scene->step (1.0 - fabs (2.0 * progress - 1.0));
+}
+
+static void
+on_scene_stopped (ClutterTimeline *timeline,
+                  gboolean         is_finished,
+                  gboolean        *done)
+{
+  *done = TRUE;
+}
+
+static void
+run_scene (const BenchmarkScene *scene,
+           FrameStats           *stats)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  g_autoptr (ClutterTimeline) timeline = NULL;
+  gboolean done = FALSE;
+
+  timeline = clutter_timeline_new_for_actor (stage, scene_duration_ms);
+  g_signal_connect (timeline, "new-frame",
+                    G_CALLBACK (on_scene_new_frame), (gpointer) scene);
+  g_signal_connect (timeline, "stopped",
+                    G_CALLBACK (on_scene_stopped), &done);
+
+  stats->frame_times_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+  stats->frame_intervals_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+  stats->heap_size_start = get_heap_size ();
+
+  current_stats = stats;
+  clutter_timeline_start (timeline);
+
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  current_stats = NULL;
+  stats->heap_size_end = get_heap_size ();
+
+  if (scene->reset)
+    scene->reset ();
+  meta_wait_for_paint (test_context);
+}
+
+static int
+compare_int64 (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t value_a = *(const int64_t *) a;
+  int64_t value_b = *(const int64_t *) b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void
+append_percentiles (GString    *json,
+                    const char *name,
+                    GArray     *values)
+{
+  static const int percentiles[] = { 50, 90, 99 };
+  unsigned int i;
+
+  g_array_sort (values, compare_int64);
+
+  g_string_append_printf (json, "      \"%s\": {", name);
+  for (i = 0; i < G_N_ELEMENTS (percentiles); i++)
+    {
+      int64_t value = 0;
+
+      if (values->len > 0)
+        {
+          unsigned int index = (values->len - 1) * percentiles[i] / 100;
+
+          value = g_array_index (values, int64_t, index);
+        }
+
+      g_string_append_printf (json, "\"p%d\": %" G_GINT64_FORMAT ", ",
+                              percentiles[i], value);
+    }
+  g_string_append_printf (json, "\"max\": %" G_GINT64_FORMAT "},\n",
+                          values->len > 0 ?
+                          g_array_index (values, int64_t, values->len - 1) :
+                          0);
+}
+
+static void
+append_scene_results (GString              *json,
+                      const BenchmarkScene *scene,
+                      FrameStats           *stats,
+                      gboolean              is_last)
+{
+  g_string_append (json, "    {\n");
+  g_string_append_printf (json, "      \"name\": \"%s\",\n", scene->name);
+  g_string_append_printf (json, "      \"frames\": %u,\n",
+                          stats->frame_times_us->len);
+  append_percentiles (json, "frame-time-us", stats->frame_times_us);
+  append_percentiles (json, "frame-interval-us", stats->frame_intervals_us);
+  g_string_append_printf (json,
+                          "      \"cpu-time-us\": {"
+                          "\"update\": %" G_GINT64_FORMAT ", "
+                          "\"paint\": %" G_GINT64_FORMAT ", "
+                          "\"finish\": %" G_GINT64_FORMAT "},\n",
+                          stats->update_cpu_time_us,
+                          stats->paint_cpu_time_us,
+                          stats->finish_cpu_time_us);
+#ifdef HAVE_MALLINFO2
+  g_string_append_printf (json, "      \"heap-growth-bytes\": %" G_GINT64_FORMAT "\n",
+                          (int64_t) stats->heap_size_end -
+                          (int64_t) stats->heap_size_start);
+#else
+  g_string_append (json, "      \"heap-growth-bytes\": null\n");
+#endif
+  g_string_append_printf (json, "    }%s\n", is_last ? "" : ",");
+}
+
+static void
+benchmark_scenes (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  g_autoptr (GPtrArray) clients = NULL;
+  g_autoptr (GString) json = NULL;
+  unsigned int i;
+
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), NULL);
+  g_signal_connect (stage, "before-paint",
+                    G_CALLBACK (on_before_paint), NULL);
+  g_signal_connect_after (stage, "after-paint",
+                          G_CALLBACK (on_after_paint), NULL);
+  g_signal_connect_after (stage, "after-update",
+                          G_CALLBACK (on_after_update), NULL);
+  g_signal_connect (stage, "presented",
+                    G_CALLBACK (on_presented), NULL);
+
+  clients = g_ptr_array_new ();
+  windows = g_ptr_array_new ();
+
+  for (i = 0; i < (unsigned int) n_clients; i++)
+    {
+      g_autofree char *title = g_strdup_printf ("benchmark-client-%u", i);
+      MetaWaylandTestClient *wayland_test_client;
+      MetaWindow *window;
+
+      wayland_test_client =
+        meta_wayland_test_client_new_with_args (test_context,
+                                                "benchmark-client",
+                                                title,
+                                                NULL);
+      g_ptr_array_add (clients, wayland_test_client);
+
+      window = meta_wait_for_client_window (test_context, title);
+      meta_window_move_frame (window, FALSE, 50 + i * 40, 50 + i * 40);
+      g_ptr_array_add (windows, window);
+    }
+
+  meta_wait_for_paint (test_context);
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"n-clients\": %d,\n", n_clients);
+  g_string_append_printf (json, "  \"buffer-type\": \"%s\",\n", buffer_type);
+  g_string_append_printf (json, "  \"scene-duration-ms\": %d,\n",
+                          scene_duration_ms);
+  g_string_append_printf (json, "  \"monitor\": \"%dx%d@%.0f\",\n",
+                          MONITOR_WIDTH, MONITOR_HEIGHT,
+                          MONITOR_REFRESH_RATE);
+  g_string_append (json, "  \"scenes\": [\n");
+
+  for (i = 0; i < G_N_ELEMENTS (scenes); i++)
+    {
+      FrameStats stats = { 0 };
+
+      g_debug ("Running scene '%s'", scenes[i].name);
+
+      run_scene (&scenes[i], &stats);
+      append_scene_results (json, &scenes[i], &stats,
+                            i == G_N_ELEMENTS (scenes) - 1);
+
+      g_array_unref (stats.frame_times_us);
+      g_array_unref (stats.frame_intervals_us);
+    }
+
+  g_string_append (json, "  ]\n}\n");
+
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  for (i = 0; i < clients->len; i++)
+    meta_wayland_test_client_finish (g_ptr_array_index (clients, i));
+
+  g_clear_pointer (&windows, g_ptr_array_unref);
+
+  g_signal_handlers_disconnect_by_func (stage, on_before_update, NULL);
+  g_signal_handlers_disconnect_by_func (stage, on_before_paint, NULL);
+  g_signal_handlers_disconnect_by_func (stage, on_after_paint, NULL);
+  g_signal_handlers_disconnect_by_func (stage, on_after_update, NULL);
+  g_signal_handlers_disconnect_by_func (stage, on_presented, NULL);
+
+  if (output_path)
+    {
+      g_autoptr (GError) error = NULL;
+
+      if (!g_file_set_contents (output_path, json->str, json->len, &error))
+        g_error ("Failed to write results: %s", error->message);
+    }
+  else
+    {
+      g_print ("%s", json->str);
+    }
+}
+
+static void
+on_before_tests (void)
+{
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+
+  test_driver = meta_wayland_test_driver_new (compositor);
+
+  if (g_strcmp0 (buffer_type, "dma-buf") == 0)
+    {
+      meta_wayland_test_driver_set_property (test_driver,
+                                             "gpu-path",
+                                             render_node ?
+                                             render_node :
+                                             "/dev/dri/renderD128");
+    }
+
+  virtual_monitor = meta_create_test_monitor (test_context,
+                                              MONITOR_WIDTH, MONITOR_HEIGHT,
+                                              MONITOR_REFRESH_RATE);
+  meta_monitor_manager_reload (monitor_manager);
+}
+
+static void
+on_after_tests (void)
+{
+  g_clear_object (&test_driver);
+  g_clear_object (&virtual_monitor);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  meta_context_add_option_entries (context, benchmark_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  if (!buffer_type)
+    buffer_type = g_strdup ("shm");
+
+  if (!g_str_equal (buffer_type, "shm") &&
+      !g_str_equal (buffer_type, "dma-buf"))
+    g_error ("Unknown buffer type '%s'", buffer_type);
+
+  if (n_clients < 1)
+    g_error ("At least one client is needed");
+
+  test_context = context;
+
+  g_test_add_func ("/benchmark/scenes", benchmark_scenes);
+
+  g_signal_connect (context, "before-tests",
+                    G_CALLBACK (on_before_tests), NULL);
+  g_signal_connect (context, "after-tests",
+                    G_CALLBACK (on_after_tests), NULL);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -65,6 +65,18 @@
  * env MESA_LOADER_DRIVER_OVERRIDE=swrast MUTTER_REF_TEST_UPDATE='/path/to/test/case`
  * ```
  *
+ * To also measure how long it takes to paint each reference test scene, set
+ * MUTTER_REF_TEST_PERF_FRAMES to the number of frames to paint. The paint
+ * times, from before the paint until the GPU finished it, and the Cogl
+ * performance counters of the last frame, e.g. the number of journal
+ * batches, are written as key files into MUTTER_REF_TEST_RESULT_DIR. If
+ * MUTTER_REF_TEST_PERF_BASELINE_DIR points to a directory with such files
+ * from an earlier run, the median paint time and the counters are compared
+ * against the baseline, and the test fails if any of them grew by more than
+ * MUTTER_REF_TEST_PERF_TOLERANCE percent (default: 20).
+ *
+ * Timings depend on the machine, so baselines are meant to be recorded and
+ * compared on the same one, e.g. before and after an optimization.
  */
 
 #include "config.h"
@@ -73,6 +85,7 @@
 
 #include <cairo.h>
 #include <glib.h>
+#include <stdlib.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-crtc.h"
@@ -341,6 +354,289 @@ capture_view (ClutterStageView *stage_view)
   return data.out_image;
 }
 
+#define DEFAULT_PERF_TOLERANCE_PERCENT 20
+
+typedef struct
+{
+  MetaStageWatch *before_paint_watch;
+  MetaStageWatch *after_paint_watch;
+  GMainLoop *loop;
+
+  int n_frames_left;
+  int64_t paint_start_us;
+  GArray *paint_times_us;
+} MeasureViewData;
+
+static void
+on_perf_before_paint (MetaStage        *stage,
+                      ClutterStageView *view,
+                      const MtkRegion  *redraw_clip,
+                      ClutterFrame     *frame,
+                      gpointer          user_data)
+{
+  MeasureViewData *data = user_data;
+
+  data->paint_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_perf_after_paint (MetaStage        *stage,
+                     ClutterStageView *view,
+                     const MtkRegion  *redraw_clip,
+                     ClutterFrame     *frame,
+                     gpointer          user_data)
+{
+  MeasureViewData *data = user_data;
+  CoglFramebuffer *framebuffer = clutter_stage_view_get_framebuffer (view);
+  int64_t paint_time_us;
+
+  /* Include the time the GPU takes to finish the paint */
+  cogl_framebuffer_finish (framebuffer);
+
+  paint_time_us = g_get_monotonic_time () - data->paint_start_us;
+  g_array_append_val (data->paint_times_us, paint_time_us);
+
+  if (--data->n_frames_left > 0)
+    {
+      clutter_stage_view_add_redraw_clip (view, NULL);
+      clutter_stage_view_schedule_update (view);
+    }
+  else
+    {
+      g_main_loop_quit (data->loop);
+    }
+}
+
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  const int64_t *time_a = a;
+  const int64_t *time_b = b;
+
+  return (*time_a > *time_b) - (*time_a < *time_b);
+}
+
+static GArray *
+measure_view (ClutterStageView *stage_view,
+              int               n_frames)
+{
+  MetaRendererView *view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc = meta_renderer_view_get_crtc (view);
+  MetaBackend *backend = meta_crtc_get_backend (crtc);
+  MetaStage *stage = META_STAGE (meta_backend_get_stage (backend));
+  MetaContext *context = meta_backend_get_context (backend);
+  MetaDisplay *display = meta_context_get_display (context);
+  MeasureViewData data = { 0 };
+
+  meta_disable_unredirect_for_display (display);
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.n_frames_left = n_frames;
+  data.paint_times_us = g_array_sized_new (FALSE, FALSE, sizeof (int64_t),
+                                           n_frames);
+  data.before_paint_watch = meta_stage_watch_view (stage, stage_view,
+                                                   META_STAGE_WATCH_BEFORE_PAINT,
+                                                   on_perf_before_paint,
+                                                   &data);
+  data.after_paint_watch = meta_stage_watch_view (stage, stage_view,
+                                                  META_STAGE_WATCH_AFTER_PAINT,
+                                                  on_perf_after_paint,
+                                                  &data);
+  clutter_stage_view_add_redraw_clip (stage_view, NULL);
+  clutter_stage_view_schedule_update (stage_view);
+
+  g_main_loop_run (data.loop);
+  g_main_loop_unref (data.loop);
+
+  meta_stage_remove_watch (stage, data.before_paint_watch);
+  meta_stage_remove_watch (stage, data.after_paint_watch);
+
+  meta_enable_unredirect_for_display (display);
+
+  g_array_sort (data.paint_times_us, compare_times);
+
+  return data.paint_times_us;
+}
+
+static int
+get_perf_frames (void)
+{
+  const char *perf_frames;
+
+  perf_frames = g_getenv ("MUTTER_REF_TEST_PERF_FRAMES");
+  if (!perf_frames)
+    return 0;
+
+  return MAX (atoi (perf_frames), 0);
+}
+
+static int
+get_perf_tolerance_percent (void)
+{
+  const char *perf_tolerance;
+
+  perf_tolerance = g_getenv ("MUTTER_REF_TEST_PERF_TOLERANCE");
+  if (!perf_tolerance)
+    return DEFAULT_PERF_TOLERANCE_PERCENT;
+
+  return MAX (atoi (perf_tolerance), 0);
+}
+
+static void
+add_perf_counter (const char *name,
+                  const char *description,
+                  int64_t     value,
+                  gpointer    user_data)
+{
+  GKeyFile *key_file = user_data;
+
+  g_key_file_set_int64 (key_file, "counters", name, value);
+}
+
+static gboolean
+exceeds_baseline (int64_t value,
+                  int64_t baseline_value)
+{
+  int64_t max_value;
+
+  max_value = baseline_value +
+              baseline_value * get_perf_tolerance_percent () / 100;
+
+  return value > max_value;
+}
+
+static void
+compare_perf_counters (GKeyFile   *key_file,
+                       GKeyFile   *baseline_key_file,
+                       const char *test_name,
+                       int         test_seq_no,
+                       const char *baseline_path)
+{
+  g_auto (GStrv) names = NULL;
+  int i;
+
+  names = g_key_file_get_keys (baseline_key_file, "counters", NULL, NULL);
+  if (!names)
+    return;
+
+  for (i = 0; names[i]; i++)
+    {
+      int64_t baseline_value;
+      int64_t value;
+
+      if (!g_key_file_has_key (key_file, "counters", names[i], NULL))
+        continue;
+
+      baseline_value = g_key_file_get_int64 (baseline_key_file,
+                                             "counters", names[i], NULL);
+      value = g_key_file_get_int64 (key_file, "counters", names[i], NULL);
+
+      if (exceeds_baseline (value, baseline_value))
+        {
+          g_critical ("%s of %s_%d grew: %" G_GINT64_FORMAT ", "
+                      "baseline %" G_GINT64_FORMAT " (%s)",
+                      names[i], test_name, test_seq_no,
+                      value, baseline_value,
+                      baseline_path);
+        }
+    }
+}
+
+static void
+verify_view_perf (ClutterStageView *view,
+                  const char       *test_name,
+                  int               test_seq_no,
+                  int               n_frames)
+{
+  g_autoptr (GArray) paint_times_us = NULL;
+  g_autoptr (GKeyFile) key_file = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *perf_file_name = NULL;
+  g_autofree char *perf_path = NULL;
+  const char *ref_test_result_dir;
+  const char *baseline_dir;
+  int64_t total_us = 0;
+  int64_t median_us;
+  unsigned int i;
+
+  paint_times_us = measure_view (view, n_frames);
+
+  for (i = 0; i < paint_times_us->len; i++)
+    total_us += g_array_index (paint_times_us, int64_t, i);
+  median_us = g_array_index (paint_times_us, int64_t,
+                             paint_times_us->len / 2);
+
+  key_file = g_key_file_new ();
+  g_key_file_set_integer (key_file, "paint", "frames", paint_times_us->len);
+  g_key_file_set_int64 (key_file, "paint", "min-us",
+                        g_array_index (paint_times_us, int64_t, 0));
+  g_key_file_set_int64 (key_file, "paint", "median-us", median_us);
+  g_key_file_set_int64 (key_file, "paint", "mean-us",
+                        total_us / paint_times_us->len);
+  g_key_file_set_int64 (key_file, "paint", "max-us",
+                        g_array_index (paint_times_us, int64_t,
+                                       paint_times_us->len - 1));
+
+  /* The counters were last snapshot when the last measured frame ended */
+  cogl_perf_counters_foreach (add_perf_counter, key_file);
+
+  perf_file_name = g_strdup_printf ("%s_%d.perf", test_name, test_seq_no);
+
+  ref_test_result_dir = g_getenv ("MUTTER_REF_TEST_RESULT_DIR");
+  g_assert_nonnull (ref_test_result_dir);
+
+  if (g_mkdir_with_parents (ref_test_result_dir, 0755) == -1)
+    {
+      g_error ("Failed to create directory %s: %s",
+               ref_test_result_dir,
+               g_strerror (errno));
+    }
+
+  perf_path = g_build_filename (ref_test_result_dir, perf_file_name, NULL);
+  if (!g_key_file_save_to_file (key_file, perf_path, &error))
+    g_error ("Failed to write %s: %s", perf_path, error->message);
+
+  g_message ("Painting %s_%d took %" G_GINT64_FORMAT " us (median of %u frames)",
+             test_name, test_seq_no, median_us, paint_times_us->len);
+
+  baseline_dir = g_getenv ("MUTTER_REF_TEST_PERF_BASELINE_DIR");
+  if (baseline_dir)
+    {
+      g_autoptr (GKeyFile) baseline_key_file = NULL;
+      g_autofree char *baseline_path = NULL;
+      int64_t baseline_median_us;
+
+      baseline_path = g_build_filename (baseline_dir, perf_file_name, NULL);
+      baseline_key_file = g_key_file_new ();
+      if (!g_key_file_load_from_file (baseline_key_file, baseline_path,
+                                      G_KEY_FILE_NONE, &error))
+        {
+          g_message ("No baseline for %s_%d: %s",
+                     test_name, test_seq_no, error->message);
+          return;
+        }
+
+      baseline_median_us = g_key_file_get_int64 (baseline_key_file,
+                                                 "paint", "median-us",
+                                                 &error);
+      g_assert_no_error (error);
+
+      if (exceeds_baseline (median_us, baseline_median_us))
+        {
+          g_critical ("Painting %s_%d got slower: %" G_GINT64_FORMAT " us, "
+                      "baseline %" G_GINT64_FORMAT " us (%s)",
+                      test_name, test_seq_no,
+                      median_us, baseline_median_us,
+                      baseline_path);
+        }
+
+      compare_perf_counters (key_file, baseline_key_file,
+                             test_name, test_seq_no,
+                             baseline_path);
+    }
+}
+
 static void
 depathify (char *path)
 {
@@ -473,6 +769,7 @@ meta_ref_test_verify_view (ClutterStageView *view,
   g_autofree char *ref_image_path = NULL;
   cairo_surface_t *ref_image;
   cairo_status_t ref_status;
+  int n_perf_frames;
 
   if (flags & META_REFTEST_FLAG_UPDATE_REF)
     assert_software_rendered (view);
@@ -593,6 +890,10 @@ meta_ref_test_verify_view (ClutterStageView *view,
 
   cairo_surface_destroy (view_image);
   cairo_surface_destroy (ref_image);
+
+  n_perf_frames = get_perf_frames ();
+  if (n_perf_frames > 0)
+    verify_view_perf (view, test_name, test_seq_no, n_perf_frames);
 }
 
 MetaReftestFlag
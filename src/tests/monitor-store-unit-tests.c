@@ -60,6 +60,7 @@ typedef struct _MonitorStoreTestCaseLogicalMonitor
   MtkMonitorTransform transform;
   gboolean is_primary;
   gboolean is_presentation;
+  const char *sync_group;
   MonitorStoreTestCaseMonitor monitors[MAX_N_MONITORS];
   int n_monitors;
 } MonitorStoreTestCaseLogicalMonitor;
@@ -160,6 +161,9 @@ check_monitor_store_configuration (MetaMonitorConfigStore        *config_store,
       g_assert_cmpint (logical_monitor_config->is_presentation,
                        ==,
                        config_expect->logical_monitors[i].is_presentation);
+      g_assert_cmpstr (logical_monitor_config->sync_group,
+                       ==,
+                       config_expect->logical_monitors[i].sync_group);
 
       g_assert_cmpint ((int) g_list_length (logical_monitor_config->monitor_configs),
                        ==,
@@ -426,6 +430,80 @@ meta_test_monitor_store_primary (void)
   check_monitor_store_configurations (&expect);
 }
 
+static void
+meta_test_monitor_store_sync_group (void)
+{
+  MonitorStoreTestExpect expect = {
+    .configurations = {
+      {
+        .layout_mode = META_LOGICAL_MONITOR_LAYOUT_MODE_LOGICAL,
+        .logical_monitors = {
+          {
+            .layout = {
+              .x = 0,
+              .y = 0,
+              .width = 1024,
+              .height = 768
+            },
+            .scale = 1,
+            .is_primary = FALSE,
+            .is_presentation = FALSE,
+            .sync_group = "wall",
+            .monitors = {
+              {
+                .connector = "DP-1",
+                .vendor = "MetaProduct's Inc.",
+                .product = "MetaMonitor",
+                .serial = "0x123456a",
+                .mode = {
+                  .width = 1024,
+                  .height = 768,
+                  .refresh_rate = 60.000495910644531
+                },
+                .rgb_range = META_OUTPUT_RGB_RANGE_AUTO,
+              }
+            },
+            .n_monitors = 1,
+          },
+          {
+            .layout = {
+              .x = 1024,
+              .y = 0,
+              .width = 800,
+              .height = 600
+            },
+            .scale = 1,
+            .is_primary = TRUE,
+            .is_presentation = FALSE,
+            .sync_group = "wall",
+            .monitors = {
+              {
+                .connector = "DP-2",
+                .vendor = "MetaProduct's Inc.",
+                .product = "MetaMonitor",
+                .serial = "0x123456b",
+                .mode = {
+                  .width = 800,
+                  .height = 600,
+                  .refresh_rate = 60.000495910644531
+                },
+                .rgb_range = META_OUTPUT_RGB_RANGE_AUTO,
+              }
+            },
+            .n_monitors = 1,
+          }
+        },
+        .n_logical_monitors = 2
+      }
+    },
+    .n_configurations = 1
+  };
+
+  meta_set_custom_monitor_config (test_context, "sync-group.xml");
+
+  check_monitor_store_configurations (&expect);
+}
+
 static void
 meta_test_monitor_store_underscanning (void)
 {
@@ -1226,6 +1304,8 @@ init_monitor_store_tests (void)
                    meta_test_monitor_store_vertical);
   g_test_add_func ("/backends/monitor-store/primary",
                    meta_test_monitor_store_primary);
+  g_test_add_func ("/backends/monitor-store/sync-group",
+                   meta_test_monitor_store_sync_group);
   g_test_add_func ("/backends/monitor-store/underscanning",
                    meta_test_monitor_store_underscanning);
   g_test_add_func ("/backends/monitor-store/refresh-rate-mode-fixed",
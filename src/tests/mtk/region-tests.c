@@ -76,6 +76,130 @@ test_region (void)
   g_assert_cmpint (extents.height, ==, rect.height);
 }
 
+static void
+test_union_rectangle (void)
+{
+  g_autoptr (MtkRegion) r1 = NULL;
+  MtkRectangle extents;
+
+  r1 = mtk_region_create ();
+
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (10, 10, 0, 10));
+  g_assert_true (mtk_region_is_empty (r1));
+
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (10, 10, 50, 50));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+
+  /* Contained in the region */
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (20, 20, 10, 10));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  extents = mtk_region_get_extents (r1);
+  g_assert_true (mtk_rectangle_equal (&extents,
+                                      &MTK_RECTANGLE_INIT (10, 10, 50, 50)));
+
+  /* Containing the region */
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (0, 0, 100, 100));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  extents = mtk_region_get_extents (r1);
+  g_assert_true (mtk_rectangle_equal (&extents,
+                                      &MTK_RECTANGLE_INIT (0, 0, 100, 100)));
+
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (100, 0, 100, 50));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 2);
+  g_assert_true (mtk_region_contains_point (r1, 150, 25));
+  g_assert_false (mtk_region_contains_point (r1, 150, 75));
+}
+
+static void
+test_subtract_intersect (void)
+{
+  g_autoptr (MtkRegion) r1 = NULL;
+  g_autoptr (MtkRegion) r2 = NULL;
+  MtkRectangle extents;
+
+  r1 = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0, 100, 100));
+
+  /* Not overlapping */
+  mtk_region_subtract_rectangle (r1, &MTK_RECTANGLE_INIT (200, 0, 10, 10));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+
+  mtk_region_subtract_rectangle (r1, &MTK_RECTANGLE_INIT (0, 0, 50, 100));
+  extents = mtk_region_get_extents (r1);
+  g_assert_true (mtk_rectangle_equal (&extents,
+                                      &MTK_RECTANGLE_INIT (50, 0, 50, 100)));
+
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (0, 0, 75, 50));
+  extents = mtk_region_get_extents (r1);
+  g_assert_true (mtk_rectangle_equal (&extents,
+                                      &MTK_RECTANGLE_INIT (50, 0, 25, 50)));
+
+  /* Containing the region */
+  r2 = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0, 100, 100));
+  mtk_region_intersect (r1, r2);
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  mtk_region_subtract (r1, r2);
+  g_assert_true (mtk_region_is_empty (r1));
+
+  mtk_region_union (r1, r2);
+  g_assert_true (mtk_region_equal (r1, r2));
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (200, 200, 10, 10));
+  g_assert_true (mtk_region_is_empty (r1));
+}
+
+static void
+test_builder (void)
+{
+  MtkRegionBuilder builder;
+  g_autoptr (MtkRegion) r1 = NULL;
+  g_autoptr (MtkRegion) r2 = NULL;
+  MtkRectangle extents;
+  int i;
+
+  mtk_region_builder_init (&builder);
+  g_assert_true (mtk_region_builder_is_empty (&builder));
+  r1 = mtk_region_builder_finish (&builder);
+  g_assert_true (mtk_region_is_empty (r1));
+  g_clear_pointer (&r1, mtk_region_unref);
+
+  /* More rectangles than fit in the preallocated array, added out of
+   * order and overlapping */
+  mtk_region_builder_init (&builder);
+  r2 = mtk_region_create ();
+  for (i = 99; i >= 0; i--)
+    {
+      MtkRectangle rect = MTK_RECTANGLE_INIT ((i % 10) * 10, (i / 10) * 10,
+                                              15, 15);
+
+      mtk_region_builder_add_rectangle (&builder,
+                                        rect.x, rect.y,
+                                        rect.width, rect.height);
+      mtk_region_union_rectangle (r2, &rect);
+    }
+  mtk_region_builder_add_rectangle (&builder, 500, 500, 0, 0);
+  g_assert_false (mtk_region_builder_is_empty (&builder));
+
+  r1 = mtk_region_builder_finish (&builder);
+  g_assert_true (mtk_region_equal (r1, r2));
+  extents = mtk_region_get_extents (r1);
+  g_assert_true (mtk_rectangle_equal (&extents,
+                                      &MTK_RECTANGLE_INIT (0, 0, 105, 105)));
+
+  mtk_region_builder_init (&builder);
+  mtk_region_builder_add_rectangle (&builder, 200, 0, 10, 10);
+  mtk_region_builder_add_rectangle (&builder, 200, 20, 10, 10);
+  mtk_region_builder_finish_into (&builder, r1);
+  g_assert_true (mtk_region_builder_is_empty (&builder));
+  g_assert_true (mtk_region_contains_point (r1, 205, 5));
+  g_assert_true (mtk_region_contains_point (r1, 205, 25));
+  g_assert_false (mtk_region_contains_point (r1, 205, 15));
+  g_assert_true (mtk_region_contains_point (r1, 50, 50));
+
+  mtk_region_builder_add_region (&builder, r1);
+  g_clear_pointer (&r2, mtk_region_unref);
+  r2 = mtk_region_builder_finish (&builder);
+  g_assert_true (mtk_region_equal (r1, r2));
+}
+
 int
 main (int    argc,
       char **argv)
@@ -85,6 +209,9 @@ main (int    argc,
   g_test_add_func ("/mtk/region/region", test_region);
   g_test_add_func ("/mtk/region/contains-point", test_contains_point);
   g_test_add_func ("/mtk/region/translate", test_translate);
+  g_test_add_func ("/mtk/region/union-rectangle", test_union_rectangle);
+  g_test_add_func ("/mtk/region/subtract-intersect", test_subtract_intersect);
+  g_test_add_func ("/mtk/region/builder", test_builder);
 
   return g_test_run ();
 }
@@ -0,0 +1,755 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * KMS update throughput benchmark. Updates touching every CRTC, with
+ * their primary, overlay and cursor planes, are pushed through the KMS
+ * thread at a high rate, as test-only commits, cursor only commits and
+ * real page flips. The main thread CPU time spent building and
+ * processing each update, the time until the update is processed or
+ * flipped, the latency of handing a task to the KMS impl thread and
+ * back, and heap growth are recorded, and written as JSON to stdout or
+ * to the file passed with --output.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+#include "backends/native/meta-backend-native.h"
+#include "backends/native/meta-kms-connector.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device.h"
+#include "backends/native/meta-kms-mode.h"
+#include "backends/native/meta-kms-plane.h"
+#include "backends/native/meta-kms-update.h"
+#include "backends/native/meta-kms.h"
+#include "backends/native/meta-thread.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-kms-test-utils.h"
+
+#define CURSOR_SIZE 64
+#define OVERLAY_SIZE 256
+
+typedef struct _BenchmarkOutput
+{
+  MetaKmsCrtc *crtc;
+  MetaKmsConnector *connector;
+  MetaKmsMode *mode;
+
+  MetaKmsPlane *primary_plane;
+  MetaKmsPlane *cursor_plane;
+  GList *overlay_planes;
+} BenchmarkOutput;
+
+typedef struct _UpdateStats
+{
+  GArray *build_cpu_times_us;
+  GArray *process_cpu_times_us;
+  GArray *latencies_us;
+
+  size_t heap_size_start;
+  size_t heap_size_end;
+} UpdateStats;
+
+typedef struct _FlipData
+{
+  GMainLoop *loop;
+  GArray *latencies_us;
+  int64_t post_time_us;
+  int n_pending;
+} FlipData;
+
+typedef struct _HandoffData
+{
+  GMainLoop *loop;
+  int64_t post_time_us;
+  int64_t impl_time_us;
+  int64_t main_time_us;
+} HandoffData;
+
+static MetaContext *test_context;
+static GPtrArray *outputs;
+static MetaDrmBuffer *primary_buffers[2];
+static MetaDrmBuffer *overlay_buffer;
+static MetaDrmBuffer *cursor_buffer;
+
+static int n_iterations = 2000;
+static int n_flips = 120;
+static char *output_path = NULL;
+
+static const GOptionEntry benchmark_options[] = {
+  {
+    "iterations", 0, 0, G_OPTION_ARG_INT,
+    &n_iterations,
+    "Number of updates per test-only scene (default: 2000)",
+    "N"
+  },
+  {
+    "flips", 0, 0, G_OPTION_ARG_INT,
+    &n_flips,
+    "Number of page flips (default: 120)",
+    "N"
+  },
+  {
+    "output", 0, 0, G_OPTION_ARG_FILENAME,
+    &output_path,
+    "File to write the JSON results to (default: stdout)",
+    "PATH"
+  },
+  { NULL }
+};
+
+static int64_t
+get_thread_cpu_time_us (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts);
+
+  return ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+static size_t
+get_heap_size (void)
+{
+#ifdef HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2 ();
+
+  return info.uordblks;
+#else
+  return 0;
+#endif
+}
+
+static void
+benchmark_output_free (BenchmarkOutput *output)
+{
+  g_list_free (output->overlay_planes);
+  g_free (output);
+}
+
+static MetaKmsPlane *
+find_unused_plane (MetaKmsDevice    *device,
+                   MetaKmsCrtc      *crtc,
+                   MetaKmsPlaneType  type,
+                   GList            *used_planes)
+{
+  GList *l;
+
+  for (l = meta_kms_device_get_planes (device); l; l = l->next)
+    {
+      MetaKmsPlane *plane = l->data;
+
+      if (meta_kms_plane_get_plane_type (plane) != type)
+        continue;
+
+      if (!meta_kms_plane_is_usable_with (plane, crtc))
+        continue;
+
+      if (g_list_find (used_planes, plane))
+        continue;
+
+      return plane;
+    }
+
+  return NULL;
+}
+
+static void
+collect_outputs (MetaKmsDevice *device)
+{
+  g_autoptr (GList) used_planes = NULL;
+  GList *crtcs;
+  GList *l;
+
+  outputs = g_ptr_array_new_with_free_func ((GDestroyNotify) benchmark_output_free);
+  crtcs = meta_kms_device_get_crtcs (device);
+
+  for (l = meta_kms_device_get_connectors (device); l; l = l->next)
+    {
+      MetaKmsConnector *connector = l->data;
+      BenchmarkOutput *output;
+      MetaKmsMode *mode;
+      MetaKmsCrtc *crtc;
+      MetaKmsPlane *plane;
+
+      if (outputs->len == g_list_length (crtcs))
+        break;
+
+      mode = meta_kms_connector_get_preferred_mode (connector);
+      if (!mode)
+        continue;
+
+      crtc = g_list_nth_data (crtcs, outputs->len);
+
+      output = g_new0 (BenchmarkOutput, 1);
+      output->crtc = crtc;
+      output->connector = connector;
+      output->mode = mode;
+
+      output->primary_plane =
+        find_unused_plane (device, crtc, META_KMS_PLANE_TYPE_PRIMARY,
+                           used_planes);
+      g_assert_nonnull (output->primary_plane);
+      used_planes = g_list_prepend (used_planes, output->primary_plane);
+
+      output->cursor_plane =
+        find_unused_plane (device, crtc, META_KMS_PLANE_TYPE_CURSOR,
+                           used_planes);
+      if (output->cursor_plane)
+        used_planes = g_list_prepend (used_planes, output->cursor_plane);
+
+      while ((plane = find_unused_plane (device, crtc,
+                                         META_KMS_PLANE_TYPE_OVERLAY,
+                                         used_planes)))
+        {
+          output->overlay_planes = g_list_append (output->overlay_planes,
+                                                  plane);
+          used_planes = g_list_prepend (used_planes, plane);
+        }
+
+      g_ptr_array_add (outputs, output);
+    }
+
+  g_assert_cmpuint (outputs->len, >, 0);
+}
+
+static void
+assign_cursor_plane (MetaKmsUpdate   *update,
+                     BenchmarkOutput *output,
+                     int              iteration)
+{
+  int mode_width = meta_kms_mode_get_width (output->mode);
+  int mode_height = meta_kms_mode_get_height (output->mode);
+
+  if (!output->cursor_plane)
+    return;
+
+  meta_kms_update_assign_plane (update,
+                                output->crtc,
+                                output->cursor_plane,
+                                cursor_buffer,
+                                META_FIXED_16_RECTANGLE_INIT_INT (0, 0,
+                                                                  CURSOR_SIZE,
+                                                                  CURSOR_SIZE),
+                                MTK_RECTANGLE_INIT ((iteration * 7) %
+                                                    (mode_width - CURSOR_SIZE),
+                                                    (iteration * 3) %
+                                                    (mode_height - CURSOR_SIZE),
+                                                    CURSOR_SIZE, CURSOR_SIZE),
+                                META_KMS_ASSIGN_PLANE_FLAG_NONE);
+}
+
+static void
+populate_update (MetaKmsUpdate *update,
+                 int            iteration,
+                 gboolean       mode_set)
+{
+  unsigned int i;
+
+  for (i = 0; i < outputs->len; i++)
+    {
+      BenchmarkOutput *output = g_ptr_array_index (outputs, i);
+      MetaDrmBuffer *primary_buffer = primary_buffers[iteration % 2];
+      int overlay_index = 0;
+      GList *l;
+
+      if (mode_set)
+        {
+          meta_kms_update_mode_set (update, output->crtc,
+                                    g_list_append (NULL, output->connector),
+                                    output->mode);
+        }
+
+      meta_kms_update_assign_plane (update,
+                                    output->crtc,
+                                    output->primary_plane,
+                                    primary_buffer,
+                                    meta_get_mode_fixed_rect_16 (output->mode),
+                                    meta_get_mode_rect (output->mode),
+                                    META_KMS_ASSIGN_PLANE_FLAG_NONE);
+
+      for (l = output->overlay_planes; l; l = l->next)
+        {
+          MetaKmsPlane *overlay_plane = l->data;
+
+          meta_kms_update_assign_plane (update,
+                                        output->crtc,
+                                        overlay_plane,
+                                        overlay_buffer,
+                                        META_FIXED_16_RECTANGLE_INIT_INT (0, 0,
+                                                                          OVERLAY_SIZE,
+                                                                          OVERLAY_SIZE),
+                                        MTK_RECTANGLE_INIT (overlay_index * 32,
+                                                            (iteration % 64) +
+                                                            overlay_index * 32,
+                                                            OVERLAY_SIZE,
+                                                            OVERLAY_SIZE),
+                                        META_KMS_ASSIGN_PLANE_FLAG_NONE);
+          overlay_index++;
+        }
+
+      assign_cursor_plane (update, output, iteration);
+    }
+}
+
+static void
+populate_cursor_update (MetaKmsUpdate *update,
+                        int            iteration,
+                        gboolean       mode_set)
+{
+  unsigned int i;
+
+  for (i = 0; i < outputs->len; i++)
+    assign_cursor_plane (update, g_ptr_array_index (outputs, i), iteration);
+}
+
+static void
+update_stats_init (UpdateStats *stats)
+{
+  stats->build_cpu_times_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+  stats->process_cpu_times_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+  stats->latencies_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+}
+
+static void
+update_stats_clear (UpdateStats *stats)
+{
+  g_clear_pointer (&stats->build_cpu_times_us, g_array_unref);
+  g_clear_pointer (&stats->process_cpu_times_us, g_array_unref);
+  g_clear_pointer (&stats->latencies_us, g_array_unref);
+}
+
+static void
+run_test_only_scene (MetaKmsDevice *device,
+                     void (* populate) (MetaKmsUpdate *update,
+                                        int            iteration,
+                                        gboolean       mode_set),
+                     UpdateStats   *stats)
+{
+  int i;
+
+  update_stats_init (stats);
+  stats->heap_size_start = get_heap_size ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      MetaKmsUpdate *update;
+      MetaKmsFeedback *feedback;
+      int64_t cpu_time_us;
+      int64_t start_time_us;
+      int64_t value;
+
+      cpu_time_us = get_thread_cpu_time_us ();
+      update = meta_kms_update_new (device);
+      populate (update, i, TRUE);
+      value = get_thread_cpu_time_us () - cpu_time_us;
+      g_array_append_val (stats->build_cpu_times_us, value);
+
+      cpu_time_us = get_thread_cpu_time_us ();
+      start_time_us = g_get_monotonic_time ();
+      feedback =
+        meta_kms_device_process_update_sync (device, update,
+                                             META_KMS_UPDATE_FLAG_TEST_ONLY |
+                                             META_KMS_UPDATE_FLAG_MODE_SET);
+      value = g_get_monotonic_time () - start_time_us;
+      g_array_append_val (stats->latencies_us, value);
+      value = get_thread_cpu_time_us () - cpu_time_us;
+      g_array_append_val (stats->process_cpu_times_us, value);
+
+      g_assert_true (meta_kms_feedback_did_pass (feedback));
+      meta_kms_feedback_unref (feedback);
+    }
+
+  stats->heap_size_end = get_heap_size ();
+}
+
+static void
+flip_feedback_flipped (MetaKmsCrtc  *kms_crtc,
+                       unsigned int  sequence,
+                       unsigned int  tv_sec,
+                       unsigned int  tv_usec,
+                       gpointer      user_data)
+{
+  FlipData *data = user_data;
+  int64_t latency_us = g_get_monotonic_time () - data->post_time_us;
+
+  g_array_append_val (data->latencies_us, latency_us);
+}
+
+static void
+flip_feedback_ready (MetaKmsCrtc *kms_crtc,
+                     gpointer     user_data)
+{
+}
+
+static void
+flip_feedback_mode_set_fallback (MetaKmsCrtc *kms_crtc,
+                                 gpointer     user_data)
+{
+  g_assert_not_reached ();
+}
+
+static void
+flip_feedback_discarded (MetaKmsCrtc  *kms_crtc,
+                         gpointer      user_data,
+                         const GError *error)
+{
+  g_error ("Page flip was discarded: %s", error ? error->message : "none");
+}
+
+static const MetaKmsPageFlipListenerVtable flip_listener_vtable = {
+  .flipped = flip_feedback_flipped,
+  .ready = flip_feedback_ready,
+  .mode_set_fallback = flip_feedback_mode_set_fallback,
+  .discarded = flip_feedback_discarded,
+};
+
+static void
+flip_data_release (gpointer user_data)
+{
+  FlipData *data = user_data;
+
+  if (--data->n_pending == 0)
+    g_main_loop_quit (data->loop);
+}
+
+static void
+run_page_flip_scene (MetaKmsDevice *device,
+                     UpdateStats   *stats)
+{
+  g_autoptr (GMainLoop) loop = NULL;
+  FlipData data = { 0 };
+  int i;
+
+  update_stats_init (stats);
+  loop = g_main_loop_new (NULL, FALSE);
+  data.loop = loop;
+  data.latencies_us = stats->latencies_us;
+
+  stats->heap_size_start = get_heap_size ();
+
+  for (i = 0; i < n_flips; i++)
+    {
+      MetaKmsUpdate *update;
+      int64_t cpu_time_us;
+      int64_t value;
+      unsigned int j;
+
+      cpu_time_us = get_thread_cpu_time_us ();
+      update = meta_kms_update_new (device);
+      populate_update (update, i, i == 0);
+      for (j = 0; j < outputs->len; j++)
+        {
+          BenchmarkOutput *output = g_ptr_array_index (outputs, j);
+
+          meta_kms_update_add_page_flip_listener (update, output->crtc,
+                                                  &flip_listener_vtable,
+                                                  NULL,
+                                                  &data,
+                                                  flip_data_release);
+        }
+      value = get_thread_cpu_time_us () - cpu_time_us;
+      g_array_append_val (stats->build_cpu_times_us, value);
+
+      data.n_pending = outputs->len;
+
+      cpu_time_us = get_thread_cpu_time_us ();
+      data.post_time_us = g_get_monotonic_time ();
+      meta_kms_device_post_update (device, update,
+                                   i == 0 ? META_KMS_UPDATE_FLAG_MODE_SET :
+                                            META_KMS_UPDATE_FLAG_NONE);
+      value = get_thread_cpu_time_us () - cpu_time_us;
+      g_array_append_val (stats->process_cpu_times_us, value);
+
+      g_main_loop_run (loop);
+    }
+
+  stats->heap_size_end = get_heap_size ();
+}
+
+static gpointer
+handoff_in_impl (MetaThreadImpl  *thread_impl,
+                 gpointer         user_data,
+                 GError         **error)
+{
+  HandoffData *data = user_data;
+
+  data->impl_time_us = g_get_monotonic_time ();
+
+  return NULL;
+}
+
+static void
+handoff_feedback (gpointer      retval,
+                  const GError *error,
+                  gpointer      user_data)
+{
+  HandoffData *data = user_data;
+
+  data->main_time_us = g_get_monotonic_time ();
+  g_main_loop_quit (data->loop);
+}
+
+static void
+run_handoff_scene (MetaKms     *kms,
+                   UpdateStats *stats)
+{
+  g_autoptr (GMainLoop) loop = NULL;
+  HandoffData data = { 0 };
+  int i;
+
+  update_stats_init (stats);
+  loop = g_main_loop_new (NULL, FALSE);
+  data.loop = loop;
+
+  stats->heap_size_start = get_heap_size ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      int64_t value;
+
+      data.post_time_us = g_get_monotonic_time ();
+      meta_thread_post_impl_task (META_THREAD (kms),
+                                  handoff_in_impl,
+                                  &data, NULL,
+                                  handoff_feedback,
+                                  &data);
+      g_main_loop_run (loop);
+
+      /* Reuse the build and process arrays for both directions. */
+      value = data.impl_time_us - data.post_time_us;
+      g_array_append_val (stats->build_cpu_times_us, value);
+      value = data.main_time_us - data.impl_time_us;
+      g_array_append_val (stats->process_cpu_times_us, value);
+      value = data.main_time_us - data.post_time_us;
+      g_array_append_val (stats->latencies_us, value);
+    }
+
+  stats->heap_size_end = get_heap_size ();
+}
+
+static int
+compare_int64 (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t value_a = *(const int64_t *) a;
+  int64_t value_b = *(const int64_t *) b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void
+append_percentiles (GString    *json,
+                    const char *name,
+                    GArray     *values)
+{
+  static const int percentiles[] = { 50, 90, 99 };
+  unsigned int i;
+
+  g_array_sort (values, compare_int64);
+
+  g_string_append_printf (json, "      \"%s\": {", name);
+  for (i = 0; i < G_N_ELEMENTS (percentiles); i++)
+    {
+      int64_t value = 0;
+
+      if (values->len > 0)
+        {
+          unsigned int index = (values->len - 1) * percentiles[i] / 100;
+
+          value = g_array_index (values, int64_t, index);
+        }
+
+      g_string_append_printf (json, "\"p%d\": %" G_GINT64_FORMAT ", ",
+                              percentiles[i], value);
+    }
+  g_string_append_printf (json, "\"max\": %" G_GINT64_FORMAT "},\n",
+                          values->len > 0 ?
+                          g_array_index (values, int64_t, values->len - 1) :
+                          0);
+}
+
+static void
+append_heap_growth (GString     *json,
+                    UpdateStats *stats)
+{
+#ifdef HAVE_MALLINFO2
+  g_string_append_printf (json, "      \"heap-growth-bytes\": %" G_GINT64_FORMAT "\n",
+                          (int64_t) stats->heap_size_end -
+                          (int64_t) stats->heap_size_start);
+#else
+  g_string_append (json, "      \"heap-growth-bytes\": null\n");
+#endif
+}
+
+static void
+append_update_results (GString     *json,
+                       const char  *name,
+                       UpdateStats *stats,
+                       const char  *latency_name)
+{
+  g_string_append (json, "    {\n");
+  g_string_append_printf (json, "      \"name\": \"%s\",\n", name);
+  g_string_append_printf (json, "      \"updates\": %u,\n",
+                          stats->latencies_us->len);
+  append_percentiles (json, "build-cpu-time-us", stats->build_cpu_times_us);
+  append_percentiles (json, "process-cpu-time-us",
+                      stats->process_cpu_times_us);
+  append_percentiles (json, latency_name, stats->latencies_us);
+  append_heap_growth (json, stats);
+  g_string_append (json, "    },\n");
+}
+
+static void
+append_handoff_results (GString     *json,
+                        UpdateStats *stats)
+{
+  g_string_append (json, "    {\n");
+  g_string_append (json, "      \"name\": \"thread-handoff\",\n");
+  g_string_append_printf (json, "      \"tasks\": %u,\n",
+                          stats->latencies_us->len);
+  append_percentiles (json, "main-to-impl-us", stats->build_cpu_times_us);
+  append_percentiles (json, "impl-to-main-us", stats->process_cpu_times_us);
+  append_percentiles (json, "round-trip-us", stats->latencies_us);
+  append_heap_growth (json, stats);
+  g_string_append (json, "    }\n");
+}
+
+static void
+benchmark_kms_updates (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaKms *kms = meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+  MetaKmsDevice *device;
+  g_autoptr (GString) json = NULL;
+  UpdateStats stats = { 0 };
+  unsigned int cache_hits, cache_misses;
+  unsigned int hits, misses;
+  unsigned int n_planes = 0;
+  unsigned int i;
+
+  device = meta_get_test_kms_device (test_context);
+  collect_outputs (device);
+
+  for (i = 0; i < outputs->len; i++)
+    {
+      BenchmarkOutput *output = g_ptr_array_index (outputs, i);
+
+      n_planes += 1 + g_list_length (output->overlay_planes);
+      if (output->cursor_plane)
+        n_planes++;
+
+      if (!primary_buffers[0])
+        {
+          primary_buffers[0] =
+            meta_create_test_mode_dumb_buffer (device, output->mode);
+          primary_buffers[1] =
+            meta_create_test_mode_dumb_buffer (device, output->mode);
+        }
+    }
+  overlay_buffer = meta_create_test_dumb_buffer (device,
+                                                 OVERLAY_SIZE, OVERLAY_SIZE);
+  cursor_buffer = meta_create_test_dumb_buffer (device,
+                                                CURSOR_SIZE, CURSOR_SIZE);
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"device\": \"%s\",\n",
+                          meta_kms_device_get_path (device));
+  g_string_append_printf (json, "  \"crtcs\": %u,\n", outputs->len);
+  g_string_append_printf (json, "  \"planes\": %u,\n", n_planes);
+  g_string_append (json, "  \"scenes\": [\n");
+
+  g_debug ("Running scene 'test-only'");
+  meta_kms_device_get_test_cache_stats (device, &cache_hits, &cache_misses);
+  run_test_only_scene (device, populate_update, &stats);
+  append_update_results (json, "test-only", &stats, "latency-us");
+  update_stats_clear (&stats);
+
+  g_debug ("Running scene 'cursor'");
+  run_test_only_scene (device, populate_cursor_update, &stats);
+  append_update_results (json, "cursor", &stats, "latency-us");
+  update_stats_clear (&stats);
+
+  g_debug ("Running scene 'page-flip'");
+  run_page_flip_scene (device, &stats);
+  append_update_results (json, "page-flip", &stats, "post-to-flip-us");
+  update_stats_clear (&stats);
+
+  g_debug ("Running scene 'thread-handoff'");
+  run_handoff_scene (kms, &stats);
+  append_handoff_results (json, &stats);
+  update_stats_clear (&stats);
+
+  g_string_append (json, "  ],\n");
+
+  meta_kms_device_get_test_cache_stats (device, &hits, &misses);
+  g_string_append_printf (json,
+                          "  \"test-cache\": {\"hits\": %u, "
+                          "\"misses\": %u}\n",
+                          hits - cache_hits, misses - cache_misses);
+  g_string_append (json, "}\n");
+
+  g_clear_object (&primary_buffers[0]);
+  g_clear_object (&primary_buffers[1]);
+  g_clear_object (&overlay_buffer);
+  g_clear_object (&cursor_buffer);
+  g_clear_pointer (&outputs, g_ptr_array_unref);
+
+  if (output_path)
+    {
+      g_autoptr (GError) error = NULL;
+
+      if (!g_file_set_contents (output_path, json->str, json->len, &error))
+        g_error ("Failed to write results: %s", error->message);
+    }
+  else
+    {
+      g_print ("%s", json->str);
+    }
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/backends/native/kms/update/benchmark",
+                   benchmark_kms_updates);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = test_context =
+    meta_create_test_context (META_CONTEXT_TEST_TYPE_VKMS,
+                              META_CONTEXT_TEST_FLAG_NO_X11);
+  meta_context_add_option_entries (context, benchmark_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_CAN_SKIP);
+}
@@ -1266,6 +1266,110 @@ meta_test_timeline_actor_destroyed (void)
   clutter_actor_destroy (persistent_actor);
 }
 
+static void
+on_before_update_count_view (ClutterStage     *stage,
+                             ClutterStageView *view,
+                             ClutterFrame     *frame,
+                             int              *n_updates)
+{
+  GList *stage_views = clutter_stage_peek_stage_views (stage);
+
+  n_updates[g_list_index (stage_views, view)]++;
+}
+
+static void
+meta_test_actor_stage_views_redraw_updates_own_views (void)
+{
+  ClutterActor *stage = meta_backend_get_stage (test_backend);
+  ClutterActor *actor;
+  GList *stage_views;
+  int n_updates[2] = { 0 };
+  gulong before_update_id;
+
+  ensure_view_count (2);
+  stage_views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, 100, 100);
+  clutter_actor_set_position (actor, 100, 100);
+  clutter_actor_add_child (stage, actor);
+
+  clutter_actor_show (stage);
+  wait_for_paint (stage);
+
+  is_on_stage_views (actor, 1, stage_views->data);
+
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  before_update_id = g_signal_connect (stage, "before-update",
+                                       G_CALLBACK (on_before_update_count_view),
+                                       n_updates);
+
+  /* Redrawing an actor only on the first view must not update the second
+   * one.
+   */
+  clutter_actor_queue_redraw (actor);
+  wait_for_paint (stage);
+  clutter_actor_queue_redraw (actor);
+  wait_for_paint (stage);
+
+  g_assert_cmpint (n_updates[0], ==, 2);
+  g_assert_cmpint (n_updates[1], ==, 0);
+
+  /* Moving it onto the second view updates that one too. */
+  clutter_actor_set_position (actor, 1100, 100);
+  clutter_actor_queue_redraw (actor);
+  wait_for_paint (stage);
+
+  while (n_updates[1] == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  is_on_stage_views (actor, 1, stage_views->next->data);
+
+  g_signal_handler_disconnect (stage, before_update_id);
+  clutter_actor_destroy (actor);
+}
+
+static void
+check_frame_stats (const ClutterFrameStats *stats,
+                   gpointer                 user_data)
+{
+  int64_t *last_dispatch_time_us = user_data;
+
+  g_assert_cmpint (stats->dispatch_time_us, >, *last_dispatch_time_us);
+  g_assert_cmpint (stats->dispatch_time_us, <=, stats->layout_time_us);
+  g_assert_cmpint (stats->layout_time_us, <=, stats->paint_time_us);
+  g_assert_cmpint (stats->paint_time_us, <=, stats->flush_time_us);
+
+  *last_dispatch_time_us = stats->dispatch_time_us;
+}
+
+static void
+meta_test_stage_views_frame_stats (void)
+{
+  ClutterActor *stage = meta_backend_get_stage (test_backend);
+  ClutterStageView *view;
+  int64_t last_dispatch_time_us = 0;
+  int64_t before_dispatch_time_us;
+
+  clutter_actor_show (stage);
+  view = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage))->data;
+
+  before_dispatch_time_us = g_get_monotonic_time ();
+  clutter_actor_queue_redraw (stage);
+  wait_for_paint (stage);
+  clutter_actor_queue_redraw (stage);
+  wait_for_paint (stage);
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  clutter_stage_view_foreach_frame_stats (view,
+                                          check_frame_stats,
+                                          &last_dispatch_time_us);
+  g_assert_cmpint (last_dispatch_time_us, >=, before_dispatch_time_us);
+}
+
 static void
 meta_test_timeline_actor_tree_clear (void)
 {
@@ -1352,6 +1456,10 @@ init_tests (void)
                    meta_test_actor_stage_views_and_frame_clocks_freed);
   g_test_add_func ("/stage-views/actor-stage-viwes-queue-frame-drawn",
                    meta_test_actor_stage_views_queue_frame_drawn);
+  g_test_add_func ("/stage-views/actor-stage-views-redraw-updates-own-views",
+                   meta_test_actor_stage_views_redraw_updates_own_views);
+  g_test_add_func ("/stage-views/frame-stats",
+                   meta_test_stage_views_frame_stats);
   g_test_add_func ("/stage-views/timeline/actor-destroyed",
                    meta_test_timeline_actor_destroyed);
   g_test_add_func ("/stage-views/timeline/tree-clear",
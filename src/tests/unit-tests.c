@@ -31,6 +31,7 @@
 #include "core/display-private.h"
 #include "meta-test/meta-context-test.h"
 #include "meta/compositor.h"
+#include "meta/meta-backend.h"
 #include "meta/meta-context.h"
 #include "tests/boxes-tests.h"
 #include "tests/monitor-store-unit-tests.h"
@@ -199,12 +200,94 @@ meta_test_util_later_schedule_from_later (void)
   g_assert_cmpint (data.state, ==, META_TEST_LATER_FINISHED);
 }
 
+typedef struct _MetaTestLaterDeferrableData
+{
+  GMainLoop *loop;
+  unsigned int n_updates;
+  unsigned int slow_later_update;
+  gboolean slow_later_ran;
+} MetaTestLaterDeferrableData;
+
+static void
+on_deferrable_before_update (ClutterStage                *stage,
+                             ClutterStageView            *stage_view,
+                             ClutterFrame                *frame,
+                             MetaTestLaterDeferrableData *data)
+{
+  data->n_updates++;
+}
+
+static gboolean
+test_later_deferrable_slow_callback (gpointer user_data)
+{
+  MetaTestLaterDeferrableData *data = user_data;
+
+  /* Use up the whole budget of this stage update */
+  g_usleep (G_USEC_PER_SEC / 100);
+
+  data->slow_later_ran = TRUE;
+  data->slow_later_update = data->n_updates;
+
+  return FALSE;
+}
+
+static gboolean
+test_later_deferrable_callback (gpointer user_data)
+{
+  MetaTestLaterDeferrableData *data = user_data;
+
+  g_assert_true (data->slow_later_ran);
+  g_assert_cmpuint (data->n_updates, >, data->slow_later_update);
+  g_main_loop_quit (data->loop);
+
+  return FALSE;
+}
+
+static void
+meta_test_util_later_deferrable (void)
+{
+  MetaTestLaterDeferrableData data = { 0 };
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaCompositor *compositor = meta_display_get_compositor (display);
+  MetaLaters *laters = meta_compositor_get_laters (compositor);
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  gulong before_update_handler_id;
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+
+  before_update_handler_id =
+    g_signal_connect (stage, "before-update",
+                      G_CALLBACK (on_deferrable_before_update), &data);
+
+  /* Test that a deferrable later is postponed to the next stage update
+   * when a later run before it used up the frame budget, even though it
+   * was scheduled first.
+   */
+  meta_laters_add_full (laters, META_LATER_BEFORE_REDRAW,
+                        META_LATER_FLAG_DEFERRABLE,
+                        test_later_deferrable_callback,
+                        &data,
+                        NULL);
+  meta_laters_add (laters, META_LATER_BEFORE_REDRAW,
+                   test_later_deferrable_slow_callback,
+                   &data,
+                   NULL);
+
+  g_main_loop_run (data.loop);
+  g_main_loop_unref (data.loop);
+
+  g_signal_handler_disconnect (stage, before_update_handler_id);
+}
+
 static void
 init_tests (void)
 {
   g_test_add_func ("/util/meta-later/order", meta_test_util_later_order);
   g_test_add_func ("/util/meta-later/schedule-from-later",
                    meta_test_util_later_schedule_from_later);
+  g_test_add_func ("/util/meta-later/deferrable",
+                   meta_test_util_later_deferrable);
 
   init_monitor_store_tests ();
   init_boxes_tests ();
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Wayland protocol stress benchmark. The stress client is run once per
+ * scenario, each a combination of surface count, subsurface tree size,
+ * damage pattern and commit pacing, against a headless monitor. The
+ * commit to presentation latency histograms it reports are collected
+ * and written as one JSON document, to stdout or to the file passed with
+ * --output.
+ */
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "backends/meta-monitor-manager-private.h"
+#include "backends/meta-virtual-monitor.h"
+#include "meta-test/meta-context-test.h"
+#include "meta/meta-wayland-compositor.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-driver.h"
+#include "tests/meta-wayland-test-utils.h"
+
+#define MONITOR_WIDTH 1920
+#define MONITOR_HEIGHT 1080
+#define MONITOR_REFRESH_RATE 60.0
+
+typedef struct _StressScenario
+{
+  const char *name;
+  const char *windows;
+  const char *subsurfaces;
+  const char *damage;
+  const char *pacing;
+} StressScenario;
+
+static MetaContext *test_context;
+static MetaWaylandTestDriver *test_driver;
+static MetaVirtualMonitor *virtual_monitor;
+
+static char *buffer_type = NULL;
+static char *render_node = NULL;
+static int scenario_duration_ms = 3000;
+static char *output_path = NULL;
+
+static const GOptionEntry benchmark_options[] = {
+  {
+    "buffer-type", 0, 0, G_OPTION_ARG_STRING,
+    &buffer_type,
+    "Client buffer type, 'shm' or 'dma-buf' (default: shm)",
+    "TYPE"
+  },
+  {
+    "render-node", 0, 0, G_OPTION_ARG_FILENAME,
+    &render_node,
+    "Render node clients allocate dma-bufs from "
+    "(default: /dev/dri/renderD128)",
+    "PATH"
+  },
+  {
+    "scenario-duration", 0, 0, G_OPTION_ARG_INT,
+    &scenario_duration_ms,
+    "Duration of each scenario in milliseconds (default: 3000)",
+    "MS"
+  },
+  {
+    "output", 0, 0, G_OPTION_ARG_FILENAME,
+    &output_path,
+    "File to write the JSON results to (default: stdout)",
+    "PATH"
+  },
+  { NULL }
+};
+
+static const StressScenario scenarios[] = {
+  { "single-frame-full", "1", "0", "full", "frame" },
+  { "many-surfaces", "16", "0", "partial", "frame" },
+  { "subsurface-tree", "2", "15", "scattered", "frame" },
+  { "fifo", "4", "3", "partial", "fifo" },
+  { "unpaced", "4", "3", "full", "none" },
+};
+
+static char *
+run_scenario (const StressScenario *scenario,
+              const char           *results_dir)
+{
+  g_autofree char *duration = NULL;
+  g_autofree char *results_path = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaWaylandTestClient *wayland_test_client;
+  char *results;
+
+  duration = g_strdup_printf ("%d", scenario_duration_ms);
+  results_path = g_build_filename (results_dir, scenario->name, NULL);
+
+  wayland_test_client =
+    meta_wayland_test_client_new_with_args (test_context,
+                                            "stress-client",
+                                            "--windows", scenario->windows,
+                                            "--subsurfaces",
+                                            scenario->subsurfaces,
+                                            "--damage", scenario->damage,
+                                            "--pacing", scenario->pacing,
+                                            "--duration", duration,
+                                            "--output", results_path,
+                                            NULL);
+  meta_wayland_test_client_finish (wayland_test_client);
+
+  if (!g_file_get_contents (results_path, &results, NULL, &error))
+    g_error ("Failed to read results of '%s': %s",
+             scenario->name, error->message);
+
+  g_unlink (results_path);
+
+  return results;
+}
+
+static void
+benchmark_stress (void)
+{
+  g_autoptr (GString) json = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *results_dir = NULL;
+  unsigned int i;
+
+  results_dir = g_dir_make_tmp ("mutter-stress-XXXXXX", &error);
+  if (!results_dir)
+    g_error ("Failed to create results directory: %s", error->message);
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"buffer-type\": \"%s\",\n", buffer_type);
+  g_string_append_printf (json, "  \"monitor\": \"%dx%d@%.0f\",\n",
+                          MONITOR_WIDTH, MONITOR_HEIGHT,
+                          MONITOR_REFRESH_RATE);
+  g_string_append (json, "  \"scenarios\": {\n");
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    {
+      g_autofree char *results = NULL;
+
+      g_debug ("Running scenario '%s'", scenarios[i].name);
+
+      results = run_scenario (&scenarios[i], results_dir);
+      g_strchomp (results);
+      g_string_append_printf (json, "    \"%s\": %s%s\n",
+                              scenarios[i].name, results,
+                              i == G_N_ELEMENTS (scenarios) - 1 ? "" : ",");
+    }
+
+  g_string_append (json, "  }\n}\n");
+
+  g_rmdir (results_dir);
+
+  if (output_path)
+    {
+      if (!g_file_set_contents (output_path, json->str, json->len, &error))
+        g_error ("Failed to write results: %s", error->message);
+    }
+  else
+    {
+      g_print ("%s", json->str);
+    }
+}
+
+static void
+on_before_tests (void)
+{
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+
+  test_driver = meta_wayland_test_driver_new (compositor);
+
+  if (g_strcmp0 (buffer_type, "dma-buf") == 0)
+    {
+      meta_wayland_test_driver_set_property (test_driver,
+                                             "gpu-path",
+                                             render_node ?
+                                             render_node :
+                                             "/dev/dri/renderD128");
+    }
+
+  virtual_monitor = meta_create_test_monitor (test_context,
+                                              MONITOR_WIDTH, MONITOR_HEIGHT,
+                                              MONITOR_REFRESH_RATE);
+  meta_monitor_manager_reload (monitor_manager);
+}
+
+static void
+on_after_tests (void)
+{
+  g_clear_object (&test_driver);
+  g_clear_object (&virtual_monitor);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  meta_context_add_option_entries (context, benchmark_options, NULL);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  if (!buffer_type)
+    buffer_type = g_strdup ("shm");
+
+  if (!g_str_equal (buffer_type, "shm") &&
+      !g_str_equal (buffer_type, "dma-buf"))
+    g_error ("Unknown buffer type '%s'", buffer_type);
+
+  test_context = context;
+
+  g_test_add_func ("/benchmark/wayland-stress", benchmark_stress);
+
+  g_signal_connect (context, "before-tests",
+                    G_CALLBACK (on_before_tests), NULL);
+  g_signal_connect (context, "after-tests",
+                    G_CALLBACK (on_after_tests), NULL);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A client continuously redrawing a toplevel on every frame callback, used
+ * to load the compositor in the compositor benchmark. Buffers are dma-bufs
+ * if the compositor announced a "gpu-path", and shm buffers otherwise. The
+ * client quits on the first sync event.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <wayland-client.h>
+
+#include "wayland-test-client-utils.h"
+
+typedef struct _BenchmarkWindow
+{
+  WaylandSurface *surface;
+  struct wl_callback *frame_callback;
+  uint32_t frame_count;
+} BenchmarkWindow;
+
+static gboolean running = TRUE;
+
+static void redraw (BenchmarkWindow *window);
+
+static void
+frame_callback_done (void               *data,
+                     struct wl_callback *callback,
+                     uint32_t            time)
+{
+  BenchmarkWindow *window = data;
+
+  wl_callback_destroy (callback);
+  window->frame_callback = NULL;
+
+  if (running)
+    redraw (window);
+}
+
+static const struct wl_callback_listener frame_listener = {
+  frame_callback_done,
+};
+
+static void
+redraw (BenchmarkWindow *window)
+{
+  WaylandSurface *surface = window->surface;
+  uint32_t shade = window->frame_count++ % 256;
+  uint32_t color;
+
+  color = 0xff000000 | shade << 16 | (255 - shade) << 8 | 0x80;
+
+  draw_surface (surface->display, surface->wl_surface,
+                surface->width, surface->height,
+                color);
+  wl_surface_damage_buffer (surface->wl_surface,
+                            0, 0,
+                            surface->width, surface->height);
+
+  window->frame_callback = wl_surface_frame (surface->wl_surface);
+  wl_callback_add_listener (window->frame_callback, &frame_listener, window);
+
+  wl_surface_commit (surface->wl_surface);
+}
+
+static void
+on_sync_event (WaylandDisplay *display,
+               uint32_t        serial,
+               gpointer        user_data)
+{
+  running = FALSE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (WaylandDisplay) display = NULL;
+  g_autoptr (WaylandSurface) surface = NULL;
+  BenchmarkWindow window = { 0 };
+  gulong sync_event_handler_id;
+
+  if (argc != 2)
+    {
+      g_printerr ("Usage: %s TITLE\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  display = wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_TEST_DRIVER);
+  if (lookup_property_value (display, "gpu-path") && !display->gbm_device)
+    g_error ("Failed to use the GPU for dma-buf buffers");
+
+  sync_event_handler_id = g_signal_connect (display, "sync-event",
+                                            G_CALLBACK (on_sync_event),
+                                            NULL);
+
+  surface = wayland_surface_new (display, argv[1], 400, 300, 0xff3465a4);
+  wayland_surface_set_opaque (surface);
+  wl_surface_commit (surface->wl_surface);
+
+  wait_for_window_shown (display, surface->wl_surface);
+
+  window.surface = surface;
+  redraw (&window);
+
+  while (running)
+    wayland_display_dispatch (display);
+
+  g_clear_pointer (&window.frame_callback, wl_callback_destroy);
+  g_signal_handler_disconnect (display, sync_event_handler_id);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,772 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A client committing to a configurable number of toplevels, each with a
+ * tree of subsurfaces, as fast as its pacing allows, for a fixed
+ * duration. Commits are paced by frame callbacks, by fifo barriers at a
+ * fixed rate, or only by a fixed rate. Each toplevel commit asks for
+ * presentation feedback, and the commit to presentation latencies are
+ * written as JSON to the file passed with --output, or to stdout.
+ *
+ * Buffers are dma-bufs if the compositor announced a "gpu-path", and shm
+ * buffers otherwise. Released buffers are reused.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wayland-client.h>
+
+#include "fifo-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+#include "wayland-test-client-utils.h"
+
+#define SUBSURFACE_SIZE 64
+#define DAMAGE_RECT_SIZE 32
+#define N_SCATTERED_RECTS 8
+#define HISTOGRAM_BUCKET_US 1000
+#define HISTOGRAM_N_BUCKETS 100
+
+typedef enum _Pacing
+{
+  PACING_FRAME,
+  PACING_FIFO,
+  PACING_NONE,
+} Pacing;
+
+typedef enum _DamagePattern
+{
+  DAMAGE_PATTERN_FULL,
+  DAMAGE_PATTERN_PARTIAL,
+  DAMAGE_PATTERN_SCATTERED,
+} DamagePattern;
+
+typedef struct _StressWindow StressWindow;
+
+typedef struct _StressSurface
+{
+  StressWindow *window;
+
+  struct wl_surface *wl_surface;
+  struct wl_subsurface *wl_subsurface;
+  int width;
+  int height;
+
+  GPtrArray *buffers;
+} StressSurface;
+
+struct _StressWindow
+{
+  WaylandSurface *toplevel;
+  StressSurface *surface;
+  GPtrArray *subsurfaces;
+
+  struct wp_fifo_v1 *fifo;
+  struct wl_callback *frame_callback;
+  gboolean needs_redraw;
+
+  uint32_t frame_count;
+};
+
+typedef struct _PresentationFeedback
+{
+  struct wp_presentation_feedback *feedback;
+  int64_t commit_time_us;
+} PresentationFeedback;
+
+static WaylandDisplay *display;
+static struct wp_presentation *presentation;
+static struct wp_fifo_manager_v1 *fifo_manager;
+static clockid_t presentation_clock_id = CLOCK_MONOTONIC;
+static GHashTable *busy_buffers;
+
+static GArray *latencies_us;
+static unsigned int histogram[HISTOGRAM_N_BUCKETS + 1];
+static unsigned int n_commits;
+static unsigned int n_discarded;
+static unsigned int n_buffers_allocated;
+static unsigned int n_pending_feedbacks;
+
+static int n_windows = 1;
+static int n_subsurfaces = 0;
+static gboolean desync_subsurfaces = FALSE;
+static char *pacing_name = NULL;
+static char *damage_name = NULL;
+static int commit_rate = 120;
+static int duration_ms = 3000;
+static char *output_path = NULL;
+
+static Pacing pacing = PACING_FRAME;
+static DamagePattern damage_pattern = DAMAGE_PATTERN_FULL;
+
+static const GOptionEntry options[] = {
+  {
+    "windows", 0, 0, G_OPTION_ARG_INT,
+    &n_windows,
+    "Number of toplevels (default: 1)",
+    "N"
+  },
+  {
+    "subsurfaces", 0, 0, G_OPTION_ARG_INT,
+    &n_subsurfaces,
+    "Number of subsurfaces per toplevel, arranged as a binary tree "
+    "(default: 0)",
+    "N"
+  },
+  {
+    "desync", 0, 0, G_OPTION_ARG_NONE,
+    &desync_subsurfaces,
+    "Make subsurfaces desynchronized",
+    NULL
+  },
+  {
+    "pacing", 0, 0, G_OPTION_ARG_STRING,
+    &pacing_name,
+    "How commits are paced, 'frame', 'fifo' or 'none' (default: frame)",
+    "PACING"
+  },
+  {
+    "damage", 0, 0, G_OPTION_ARG_STRING,
+    &damage_name,
+    "Damage pattern, 'full', 'partial' or 'scattered' (default: full)",
+    "PATTERN"
+  },
+  {
+    "commit-rate", 0, 0, G_OPTION_ARG_INT,
+    &commit_rate,
+    "Commits per second with 'fifo' or 'none' pacing (default: 120)",
+    "HZ"
+  },
+  {
+    "duration", 0, 0, G_OPTION_ARG_INT,
+    &duration_ms,
+    "Duration in milliseconds (default: 3000)",
+    "MS"
+  },
+  {
+    "output", 0, 0, G_OPTION_ARG_FILENAME,
+    &output_path,
+    "File to write the JSON results to (default: stdout)",
+    "PATH"
+  },
+  { NULL }
+};
+
+static void
+handle_presentation_clock_id (void                   *data,
+                              struct wp_presentation *wp_presentation,
+                              uint32_t                clk_id)
+{
+  presentation_clock_id = clk_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+  handle_presentation_clock_id,
+};
+
+static void
+handle_registry_global (void               *user_data,
+                        struct wl_registry *registry,
+                        uint32_t            id,
+                        const char         *interface,
+                        uint32_t            version)
+{
+  if (strcmp (interface, wp_presentation_interface.name) == 0)
+    {
+      presentation = wl_registry_bind (registry, id,
+                                       &wp_presentation_interface, 1);
+      wp_presentation_add_listener (presentation, &presentation_listener,
+                                    NULL);
+    }
+  else if (strcmp (interface, wp_fifo_manager_v1_interface.name) == 0)
+    {
+      fifo_manager = wl_registry_bind (registry, id,
+                                       &wp_fifo_manager_v1_interface, 1);
+    }
+}
+
+static void
+handle_registry_global_remove (void               *user_data,
+                               struct wl_registry *registry,
+                               uint32_t            name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+  handle_registry_global,
+  handle_registry_global_remove
+};
+
+static int64_t
+get_clock_time_us (clockid_t clock_id)
+{
+  struct timespec ts;
+
+  clock_gettime (clock_id, &ts);
+
+  return ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+static void
+record_latency (int64_t latency_us)
+{
+  int64_t bucket = latency_us / HISTOGRAM_BUCKET_US;
+
+  g_array_append_val (latencies_us, latency_us);
+  histogram[CLAMP (bucket, 0, HISTOGRAM_N_BUCKETS)]++;
+}
+
+static void
+presentation_feedback_free (PresentationFeedback *feedback)
+{
+  wp_presentation_feedback_destroy (feedback->feedback);
+  g_free (feedback);
+  n_pending_feedbacks--;
+}
+
+static void
+handle_feedback_sync_output (void                            *data,
+                             struct wp_presentation_feedback *feedback,
+                             struct wl_output                *output)
+{
+}
+
+static void
+handle_feedback_presented (void                            *data,
+                           struct wp_presentation_feedback *wp_feedback,
+                           uint32_t                         tv_sec_hi,
+                           uint32_t                         tv_sec_lo,
+                           uint32_t                         tv_nsec,
+                           uint32_t                         refresh,
+                           uint32_t                         seq_hi,
+                           uint32_t                         seq_lo,
+                           uint32_t                         flags)
+{
+  PresentationFeedback *feedback = data;
+  int64_t tv_sec = ((int64_t) tv_sec_hi << 32) | tv_sec_lo;
+  int64_t presentation_time_us;
+
+  presentation_time_us = tv_sec * G_USEC_PER_SEC + tv_nsec / 1000;
+  record_latency (presentation_time_us - feedback->commit_time_us);
+
+  presentation_feedback_free (feedback);
+}
+
+static void
+handle_feedback_discarded (void                            *data,
+                           struct wp_presentation_feedback *wp_feedback)
+{
+  PresentationFeedback *feedback = data;
+
+  n_discarded++;
+
+  presentation_feedback_free (feedback);
+}
+
+static const struct wp_presentation_feedback_listener feedback_listener = {
+  handle_feedback_sync_output,
+  handle_feedback_presented,
+  handle_feedback_discarded,
+};
+
+static void
+handle_buffer_release (void             *user_data,
+                       struct wl_buffer *buffer_resource)
+{
+  g_hash_table_remove (busy_buffers, user_data);
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+  handle_buffer_release
+};
+
+static WaylandBuffer *
+acquire_buffer (StressSurface *surface)
+{
+  WaylandBuffer *buffer;
+  unsigned int i;
+
+  for (i = 0; i < surface->buffers->len; i++)
+    {
+      buffer = g_ptr_array_index (surface->buffers, i);
+
+      if (!g_hash_table_contains (busy_buffers, buffer))
+        goto out;
+    }
+
+  buffer = wayland_buffer_create (display, &buffer_listener,
+                                  surface->width, surface->height,
+                                  DRM_FORMAT_ARGB8888,
+                                  NULL, 0,
+                                  GBM_BO_USE_LINEAR);
+  if (!buffer)
+    g_error ("Failed to create buffer");
+
+  g_ptr_array_add (surface->buffers, buffer);
+  n_buffers_allocated++;
+
+out:
+  g_hash_table_add (busy_buffers, buffer);
+  return buffer;
+}
+
+static void
+free_buffer (WaylandBuffer *buffer)
+{
+  wl_buffer_destroy (wayland_buffer_get_wl_buffer (buffer));
+  g_object_unref (buffer);
+}
+
+static StressSurface *
+stress_surface_new (StressWindow      *window,
+                    struct wl_surface *wl_surface,
+                    int                width,
+                    int                height)
+{
+  StressSurface *surface;
+
+  surface = g_new0 (StressSurface, 1);
+  surface->window = window;
+  surface->wl_surface = wl_surface;
+  surface->width = width;
+  surface->height = height;
+  surface->buffers = g_ptr_array_new_with_free_func ((GDestroyNotify) free_buffer);
+
+  return surface;
+}
+
+static void
+stress_surface_free (StressSurface *surface)
+{
+  g_clear_pointer (&surface->wl_subsurface, wl_subsurface_destroy);
+  if (surface != surface->window->surface)
+    wl_surface_destroy (surface->wl_surface);
+  g_ptr_array_unref (surface->buffers);
+  g_free (surface);
+}
+
+static void
+damage_surface (StressSurface *surface,
+                uint32_t       frame_count)
+{
+  int max_x = MAX (surface->width - DAMAGE_RECT_SIZE, 1);
+  int max_y = MAX (surface->height - DAMAGE_RECT_SIZE, 1);
+  int i;
+
+  switch (damage_pattern)
+    {
+    case DAMAGE_PATTERN_FULL:
+      wl_surface_damage_buffer (surface->wl_surface,
+                                0, 0,
+                                surface->width, surface->height);
+      break;
+    case DAMAGE_PATTERN_PARTIAL:
+      wl_surface_damage_buffer (surface->wl_surface,
+                                (frame_count * 4) % max_x,
+                                (frame_count * 2) % max_y,
+                                DAMAGE_RECT_SIZE, DAMAGE_RECT_SIZE);
+      break;
+    case DAMAGE_PATTERN_SCATTERED:
+      for (i = 0; i < N_SCATTERED_RECTS; i++)
+        {
+          wl_surface_damage_buffer (surface->wl_surface,
+                                    g_random_int_range (0, max_x),
+                                    g_random_int_range (0, max_y),
+                                    DAMAGE_RECT_SIZE / 2,
+                                    DAMAGE_RECT_SIZE / 2);
+        }
+      break;
+    }
+}
+
+static void
+draw_stress_surface (StressSurface *surface,
+                     uint32_t       frame_count)
+{
+  WaylandBuffer *buffer;
+  uint32_t shade = frame_count % 256;
+
+  buffer = acquire_buffer (surface);
+  wayland_buffer_fill_color (buffer,
+                             0xff000000 | shade << 16 | (255 - shade) << 8);
+  wl_surface_attach (surface->wl_surface,
+                     wayland_buffer_get_wl_buffer (buffer), 0, 0);
+  damage_surface (surface, frame_count);
+}
+
+static void
+frame_callback_done (void               *data,
+                     struct wl_callback *callback,
+                     uint32_t            time)
+{
+  StressWindow *window = data;
+
+  wl_callback_destroy (callback);
+  window->frame_callback = NULL;
+  window->needs_redraw = TRUE;
+}
+
+static const struct wl_callback_listener frame_listener = {
+  frame_callback_done,
+};
+
+static void
+redraw (StressWindow *window)
+{
+  PresentationFeedback *feedback;
+  unsigned int i;
+
+  for (i = 0; i < window->subsurfaces->len; i++)
+    {
+      StressSurface *subsurface = g_ptr_array_index (window->subsurfaces, i);
+
+      draw_stress_surface (subsurface, window->frame_count);
+      wl_surface_commit (subsurface->wl_surface);
+    }
+
+  draw_stress_surface (window->surface, window->frame_count);
+  window->frame_count++;
+
+  if (pacing == PACING_FRAME)
+    {
+      window->frame_callback = wl_surface_frame (window->surface->wl_surface);
+      wl_callback_add_listener (window->frame_callback, &frame_listener,
+                                window);
+    }
+  else if (pacing == PACING_FIFO)
+    {
+      wp_fifo_v1_wait_barrier (window->fifo);
+      wp_fifo_v1_set_barrier (window->fifo);
+    }
+
+  feedback = g_new0 (PresentationFeedback, 1);
+  feedback->feedback = wp_presentation_feedback (presentation,
+                                                 window->surface->wl_surface);
+  wp_presentation_feedback_add_listener (feedback->feedback,
+                                         &feedback_listener, feedback);
+  n_pending_feedbacks++;
+
+  window->needs_redraw = FALSE;
+  feedback->commit_time_us = get_clock_time_us (presentation_clock_id);
+  wl_surface_commit (window->surface->wl_surface);
+  n_commits++;
+}
+
+static StressWindow *
+stress_window_new (int index)
+{
+  g_autofree char *title = g_strdup_printf ("stress-client-%d", index);
+  StressWindow *window;
+  int i;
+
+  window = g_new0 (StressWindow, 1);
+  window->toplevel = wayland_surface_new (display, title,
+                                          256, 256, 0xff3465a4);
+  wayland_surface_set_opaque (window->toplevel);
+  wl_surface_commit (window->toplevel->wl_surface);
+  wait_for_window_shown (display, window->toplevel->wl_surface);
+
+  window->surface = stress_surface_new (window,
+                                        window->toplevel->wl_surface,
+                                        window->toplevel->width,
+                                        window->toplevel->height);
+  window->subsurfaces =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) stress_surface_free);
+
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      StressSurface *parent;
+      StressSurface *subsurface;
+
+      parent = i == 0 ? window->surface :
+                        g_ptr_array_index (window->subsurfaces, (i - 1) / 2);
+
+      subsurface =
+        stress_surface_new (window,
+                            wl_compositor_create_surface (display->compositor),
+                            SUBSURFACE_SIZE, SUBSURFACE_SIZE);
+      subsurface->wl_subsurface =
+        wl_subcompositor_get_subsurface (display->subcompositor,
+                                         subsurface->wl_surface,
+                                         parent->wl_surface);
+      wl_subsurface_set_position (subsurface->wl_subsurface,
+                                  (i % 2) * SUBSURFACE_SIZE / 2 + 8,
+                                  SUBSURFACE_SIZE / 2 + 8);
+      if (desync_subsurfaces)
+        wl_subsurface_set_desync (subsurface->wl_subsurface);
+
+      g_ptr_array_add (window->subsurfaces, subsurface);
+    }
+
+  if (pacing == PACING_FIFO)
+    {
+      window->fifo = wp_fifo_manager_v1_get_fifo (fifo_manager,
+                                                  window->surface->wl_surface);
+    }
+
+  window->needs_redraw = TRUE;
+
+  return window;
+}
+
+static void
+stress_window_free (StressWindow *window)
+{
+  g_clear_pointer (&window->frame_callback, wl_callback_destroy);
+  g_clear_pointer (&window->fifo, wp_fifo_v1_destroy);
+  g_ptr_array_unref (window->subsurfaces);
+  stress_surface_free (window->surface);
+  g_object_unref (window->toplevel);
+  g_free (window);
+}
+
+static void
+dispatch_until (int64_t deadline_us)
+{
+  struct pollfd pfd = {
+    .fd = wl_display_get_fd (display->display),
+    .events = POLLIN,
+  };
+  int64_t timeout_us;
+  int ret;
+
+  while (wl_display_prepare_read (display->display) != 0)
+    wl_display_dispatch_pending (display->display);
+
+  if (wl_display_flush (display->display) == -1 && errno != EAGAIN)
+    g_error ("wl_display_flush failed: %s", g_strerror (errno));
+
+  timeout_us = MAX (deadline_us - g_get_monotonic_time (), 0);
+  ret = poll (&pfd, 1, (int) ((timeout_us + 999) / 1000));
+  if (ret == -1 && errno != EINTR)
+    g_error ("poll failed: %s", g_strerror (errno));
+
+  if (ret > 0)
+    {
+      if (wl_display_read_events (display->display) == -1)
+        g_error ("wl_display_read_events failed");
+    }
+  else
+    {
+      wl_display_cancel_read (display->display);
+    }
+
+  if (wl_display_dispatch_pending (display->display) == -1)
+    g_error ("wl_display_dispatch_pending failed");
+}
+
+static void
+run (GPtrArray *windows)
+{
+  int64_t end_time_us;
+  int64_t next_commit_time_us;
+  int64_t commit_interval_us;
+  unsigned int i;
+
+  commit_interval_us = G_USEC_PER_SEC / MAX (commit_rate, 1);
+  next_commit_time_us = g_get_monotonic_time ();
+  end_time_us = next_commit_time_us + duration_ms * 1000;
+
+  while (g_get_monotonic_time () < end_time_us)
+    {
+      if (pacing == PACING_FRAME)
+        {
+          for (i = 0; i < windows->len; i++)
+            {
+              StressWindow *window = g_ptr_array_index (windows, i);
+
+              if (window->needs_redraw)
+                redraw (window);
+            }
+
+          dispatch_until (end_time_us);
+        }
+      else
+        {
+          if (g_get_monotonic_time () >= next_commit_time_us)
+            {
+              for (i = 0; i < windows->len; i++)
+                redraw (g_ptr_array_index (windows, i));
+
+              next_commit_time_us += commit_interval_us;
+            }
+
+          dispatch_until (MIN (next_commit_time_us, end_time_us));
+        }
+    }
+
+  while (n_pending_feedbacks > 0)
+    wayland_display_dispatch (display);
+}
+
+static int
+compare_int64 (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t value_a = *(const int64_t *) a;
+  int64_t value_b = *(const int64_t *) b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void
+write_results (void)
+{
+  static const int percentiles[] = { 50, 90, 99 };
+  g_autoptr (GString) json = NULL;
+  unsigned int i;
+
+  g_array_sort (latencies_us, compare_int64);
+
+  json = g_string_new ("{\n");
+  g_string_append_printf (json, "  \"windows\": %d,\n", n_windows);
+  g_string_append_printf (json, "  \"subsurfaces\": %d,\n", n_subsurfaces);
+  g_string_append_printf (json, "  \"desync\": %s,\n",
+                          desync_subsurfaces ? "true" : "false");
+  g_string_append_printf (json, "  \"pacing\": \"%s\",\n",
+                          pacing_name ? pacing_name : "frame");
+  g_string_append_printf (json, "  \"damage\": \"%s\",\n",
+                          damage_name ? damage_name : "full");
+  g_string_append_printf (json, "  \"buffer-type\": \"%s\",\n",
+                          display->gbm_device ? "dma-buf" : "shm");
+  g_string_append_printf (json, "  \"duration-ms\": %d,\n", duration_ms);
+  g_string_append_printf (json, "  \"commits\": %u,\n", n_commits);
+  g_string_append_printf (json, "  \"presented\": %u,\n", latencies_us->len);
+  g_string_append_printf (json, "  \"discarded\": %u,\n", n_discarded);
+  g_string_append_printf (json, "  \"buffers-allocated\": %u,\n",
+                          n_buffers_allocated);
+
+  g_string_append (json, "  \"commit-to-present-us\": {");
+  for (i = 0; i < G_N_ELEMENTS (percentiles); i++)
+    {
+      int64_t value = 0;
+
+      if (latencies_us->len > 0)
+        {
+          unsigned int index = (latencies_us->len - 1) * percentiles[i] / 100;
+
+          value = g_array_index (latencies_us, int64_t, index);
+        }
+
+      g_string_append_printf (json, "\"p%d\": %" G_GINT64_FORMAT ", ",
+                              percentiles[i], value);
+    }
+  g_string_append_printf (json, "\"max\": %" G_GINT64_FORMAT "},\n",
+                          latencies_us->len > 0 ?
+                          g_array_index (latencies_us, int64_t,
+                                         latencies_us->len - 1) :
+                          0);
+
+  g_string_append_printf (json, "  \"histogram-bucket-us\": %d,\n",
+                          HISTOGRAM_BUCKET_US);
+  g_string_append (json, "  \"histogram\": [");
+  for (i = 0; i <= HISTOGRAM_N_BUCKETS; i++)
+    {
+      g_string_append_printf (json, "%u%s", histogram[i],
+                              i == HISTOGRAM_N_BUCKETS ? "" : ", ");
+    }
+  g_string_append (json, "]\n}\n");
+
+  if (output_path)
+    {
+      g_autoptr (GError) error = NULL;
+
+      if (!g_file_set_contents (output_path, json->str, json->len, &error))
+        g_error ("Failed to write results: %s", error->message);
+    }
+  else
+    {
+      g_print ("%s", json->str);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) option_context = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GPtrArray) windows = NULL;
+  g_autoptr (WaylandDisplay) wayland_display = NULL;
+  struct wl_registry *registry;
+  int i;
+
+  option_context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (option_context, options, NULL);
+  if (!g_option_context_parse (option_context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (!pacing_name || g_strcmp0 (pacing_name, "frame") == 0)
+    pacing = PACING_FRAME;
+  else if (g_strcmp0 (pacing_name, "fifo") == 0)
+    pacing = PACING_FIFO;
+  else if (g_strcmp0 (pacing_name, "none") == 0)
+    pacing = PACING_NONE;
+  else
+    g_error ("Unknown pacing '%s'", pacing_name);
+
+  if (!damage_name || g_strcmp0 (damage_name, "full") == 0)
+    damage_pattern = DAMAGE_PATTERN_FULL;
+  else if (g_strcmp0 (damage_name, "partial") == 0)
+    damage_pattern = DAMAGE_PATTERN_PARTIAL;
+  else if (g_strcmp0 (damage_name, "scattered") == 0)
+    damage_pattern = DAMAGE_PATTERN_SCATTERED;
+  else
+    g_error ("Unknown damage pattern '%s'", damage_name);
+
+  wayland_display = display =
+    wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_TEST_DRIVER);
+  if (lookup_property_value (display, "gpu-path") && !display->gbm_device)
+    g_error ("Failed to use the GPU for dma-buf buffers");
+
+  registry = wl_display_get_registry (display->display);
+  wl_registry_add_listener (registry, &registry_listener, NULL);
+  wl_display_roundtrip (display->display);
+
+  if (!presentation)
+    g_error ("Compositor does not support wp_presentation");
+  if (pacing == PACING_FIFO && !fifo_manager)
+    g_error ("Compositor does not support wp_fifo_manager_v1");
+
+  busy_buffers = g_hash_table_new (NULL, NULL);
+  latencies_us = g_array_new (FALSE, FALSE, sizeof (int64_t));
+
+  windows = g_ptr_array_new_with_free_func ((GDestroyNotify) stress_window_free);
+  for (i = 0; i < n_windows; i++)
+    g_ptr_array_add (windows, stress_window_new (i));
+
+  run (windows);
+  write_results ();
+
+  g_clear_pointer (&windows, g_ptr_array_unref);
+  g_clear_pointer (&fifo_manager, wp_fifo_manager_v1_destroy);
+  g_clear_pointer (&presentation, wp_presentation_destroy);
+  wl_registry_destroy (registry);
+  g_clear_pointer (&latencies_us, g_array_unref);
+  g_clear_pointer (&busy_buffers, g_hash_table_unref);
+
+  return EXIT_SUCCESS;
+}
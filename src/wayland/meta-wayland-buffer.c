@@ -50,10 +50,13 @@
 
 #include <drm_fourcc.h>
 #include <glib/gstdio.h>
+#include <string.h>
 
 #include "backends/meta-backend-private.h"
+#include "backends/meta-settings-private.h"
 #include "clutter/clutter.h"
 #include "meta/util.h"
+#include "wayland/meta-wayland-client-private.h"
 #include "wayland/meta-wayland-dma-buf.h"
 #include "wayland/meta-wayland-private.h"
 #include "common/meta-cogl-drm-formats.h"
@@ -71,6 +74,8 @@
 
 #define META_WAYLAND_SHM_MAX_PLANES 4
 
+#define SHM_DAMAGE_TILE_SIZE 64
+
 enum
 {
   RESOURCE_DESTROYED,
@@ -80,6 +85,19 @@ enum
 
 guint signals[LAST_SIGNAL];
 
+static GQuark quark_shm_tile_hashes;
+
+typedef struct _MetaWaylandShmTileHashes
+{
+  int width;
+  int height;
+  int n_columns;
+  int n_rows;
+
+  /* 0 means the contents of the tile in the texture are unknown */
+  uint64_t hashes[];
+} MetaWaylandShmTileHashes;
+
 G_DEFINE_TYPE (MetaWaylandBuffer, meta_wayland_buffer, G_TYPE_OBJECT);
 
 MetaFormatInfo supported_shm_formats[G_N_ELEMENTS (meta_format_info)];
@@ -92,6 +110,18 @@ meta_wayland_buffer_destroy_handler (struct wl_listener *listener,
   MetaWaylandBuffer *buffer =
     wl_container_of (listener, buffer, destroy_listener);
 
+  /* The staged copy may still be reading through the wl_shm_buffer, which
+   * is about to go away together with the resource. */
+  if (buffer->shm.upload)
+    {
+      meta_wayland_shm_upload_wait_for_copy (buffer->shm.upload);
+      g_clear_pointer (&buffer->shm.upload, meta_wayland_shm_upload_unref);
+    }
+
+  meta_wayland_client_stats_add_buffer_memory (wl_resource_get_client (buffer->resource),
+                                               -(int64_t) buffer->accounted_memory);
+  buffer->accounted_memory = 0;
+
   buffer->resource = NULL;
   wl_list_remove (&buffer->destroy_listener.link);
   g_signal_emit (buffer, signals[RESOURCE_DESTROYED], 0);
@@ -138,8 +168,8 @@ meta_wayland_buffer_is_realized (MetaWaylandBuffer *buffer)
   return buffer->type != META_WAYLAND_BUFFER_TYPE_UNKNOWN;
 }
 
-gboolean
-meta_wayland_buffer_realize (MetaWaylandBuffer *buffer)
+static gboolean
+realize_buffer (MetaWaylandBuffer *buffer)
 {
 #ifdef HAVE_WAYLAND_EGLSTREAM
   MetaWaylandEglStream *stream;
@@ -334,6 +364,76 @@ get_offset_and_stride (const MetaFormatInfo *format_info,
     }
 }
 
+static size_t
+get_shm_buffer_size (struct wl_shm_buffer *shm_buffer)
+{
+  const MetaFormatInfo *format_info;
+  const MetaMultiTextureFormatInfo *mt_format_info;
+  int shm_offset[3] = { 0 };
+  int shm_stride[3] = { 0 };
+  int stride;
+  int height;
+  size_t size = 0;
+  size_t i;
+
+  stride = wl_shm_buffer_get_stride (shm_buffer);
+  height = wl_shm_buffer_get_height (shm_buffer);
+
+  format_info = get_supported_shm_format_info (wl_shm_buffer_get_format (shm_buffer));
+  if (!format_info)
+    return (size_t) stride * height;
+
+  mt_format_info =
+    meta_multi_texture_format_get_info (format_info->multi_texture_format);
+  get_offset_and_stride (format_info, stride, height, shm_offset, shm_stride);
+
+  for (i = 0; i < mt_format_info->n_planes; i++)
+    {
+      size = MAX (size,
+                  shm_offset[i] +
+                  (size_t) shm_stride[i] * (height / mt_format_info->vsub[i]));
+    }
+
+  return size;
+}
+
+static size_t
+get_buffer_memory_size (MetaWaylandBuffer *buffer)
+{
+  switch (buffer->type)
+    {
+    case META_WAYLAND_BUFFER_TYPE_SHM:
+      return get_shm_buffer_size (wl_shm_buffer_get (buffer->resource));
+    case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+    case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
+      if (buffer->dma_buf.dma_buf)
+        return meta_wayland_dma_buf_get_size (buffer->dma_buf.dma_buf);
+      return 0;
+#ifdef HAVE_WAYLAND_EGLSTREAM
+    case META_WAYLAND_BUFFER_TYPE_EGL_STREAM:
+#endif
+    case META_WAYLAND_BUFFER_TYPE_SINGLE_PIXEL:
+    case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
+      return 0;
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+gboolean
+meta_wayland_buffer_realize (MetaWaylandBuffer *buffer)
+{
+  if (!realize_buffer (buffer))
+    return FALSE;
+
+  buffer->accounted_memory = get_buffer_memory_size (buffer);
+  meta_wayland_client_stats_add_buffer_memory (wl_resource_get_client (buffer->resource),
+                                               buffer->accounted_memory);
+
+  return TRUE;
+}
+
 static MetaMultiTexture *
 multi_texture_from_shm (CoglContext           *cogl_context,
                         const MetaFormatInfo  *format_info,
@@ -454,6 +554,9 @@ shm_buffer_attach (MetaWaylandBuffer  *buffer,
 
   g_clear_object (texture);
 
+  meta_wayland_client_stats_add_shm_upload (wl_resource_get_client (buffer->resource),
+                                            get_shm_buffer_size (shm_buffer));
+
   wl_shm_buffer_begin_access (shm_buffer);
   *texture = multi_texture_from_shm (cogl_context,
                                      format_info,
@@ -730,6 +833,12 @@ meta_wayland_buffer_dec_use_count (MetaWaylandBuffer *buffer)
     {
       wl_buffer_send_release (buffer->resource);
 
+      /* The last use goes away when the surface commits a replacement, or,
+       * for scanouts, once the page flip away from the buffer completed.
+       * No frame submitted after this may sample the buffer anymore, so
+       * the fence of the latest submitted one is when the GPU is done with
+       * it, and the release points don't need to wait for another frame.
+       */
       sync_fd = cogl_context_get_latest_sync_fd (cogl_context);
       if (sync_fd < 0)
         {
@@ -759,6 +868,290 @@ meta_wayland_buffer_is_y_inverted (MetaWaylandBuffer *buffer)
   return buffer->is_y_inverted;
 }
 
+static gboolean
+try_stream_shm_damage (MetaWaylandBuffer *buffer,
+                       CoglTexture       *cogl_texture,
+                       CoglPixelFormat    format,
+                       int                bpp,
+                       const uint8_t     *data,
+                       size_t             stride,
+                       MtkRegion         *region)
+{
+  MetaWaylandShmUploader *uploader = buffer->compositor->shm_uploader;
+  g_autofree MtkRectangle *rects = NULL;
+  g_autoptr (GError) error = NULL;
+  int i, n_rectangles;
+
+  if (!uploader)
+    return FALSE;
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  rects = g_new (MtkRectangle, n_rectangles);
+  for (i = 0; i < n_rectangles; i++)
+    rects[i] = mtk_region_get_rectangle (region, i);
+
+  if (!meta_wayland_shm_uploader_can_upload (uploader, cogl_texture, bpp,
+                                             rects, n_rectangles))
+    return FALSE;
+
+  if (!meta_wayland_shm_uploader_upload (uploader, cogl_texture,
+                                         format, bpp,
+                                         data, stride,
+                                         rects, n_rectangles,
+                                         &error))
+    {
+      meta_topic (META_DEBUG_WAYLAND,
+                  "Failed to stream shm damage, uploading directly: %s",
+                  error->message);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static inline uint64_t
+rotl64 (uint64_t x,
+        int      r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t
+hash_tile (const uint8_t *data,
+           size_t         stride,
+           int            row_length,
+           int            n_rows)
+{
+  const uint64_t c1 = 0x87c37b91114253d5ull;
+  const uint64_t c2 = 0x4cf5ad432745937full;
+  uint64_t hash = 0x9e3779b97f4a7c15ull;
+  int x, y;
+
+  for (y = 0; y < n_rows; y++)
+    {
+      const uint8_t *row = data + y * stride;
+      uint64_t tail = 0;
+
+      for (x = 0; x + 8 <= row_length; x += 8)
+        {
+          uint64_t word;
+
+          memcpy (&word, row + x, sizeof (word));
+          word = rotl64 (word * c1, 31) * c2;
+          hash = rotl64 (hash ^ word, 27) * 5 + 0x52dce729;
+        }
+
+      for (; x < row_length; x++)
+        tail = (tail << 8) | row[x];
+
+      tail = rotl64 (tail * c1, 31) * c2;
+      hash = rotl64 (hash ^ tail, 27) * 5 + 0x52dce729;
+    }
+
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+
+  return hash ? hash : 1;
+}
+
+static MetaWaylandShmTileHashes *
+ensure_shm_tile_hashes (MetaMultiTexture *texture,
+                        int               width,
+                        int               height)
+{
+  MetaWaylandShmTileHashes *tile_hashes;
+  int n_columns, n_rows;
+
+  tile_hashes = g_object_get_qdata (G_OBJECT (texture), quark_shm_tile_hashes);
+  if (tile_hashes &&
+      tile_hashes->width == width &&
+      tile_hashes->height == height)
+    return tile_hashes;
+
+  n_columns = (width + SHM_DAMAGE_TILE_SIZE - 1) / SHM_DAMAGE_TILE_SIZE;
+  n_rows = (height + SHM_DAMAGE_TILE_SIZE - 1) / SHM_DAMAGE_TILE_SIZE;
+
+  tile_hashes = g_malloc0 (sizeof (MetaWaylandShmTileHashes) +
+                           n_columns * n_rows * sizeof (uint64_t));
+  tile_hashes->width = width;
+  tile_hashes->height = height;
+  tile_hashes->n_columns = n_columns;
+  tile_hashes->n_rows = n_rows;
+
+  g_object_set_qdata_full (G_OBJECT (texture), quark_shm_tile_hashes,
+                           tile_hashes, g_free);
+
+  return tile_hashes;
+}
+
+static gboolean
+should_refine_shm_damage (MetaWaylandBuffer *buffer,
+                          MetaMultiTexture  *texture)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (buffer->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        settings, META_EXPERIMENTAL_FEATURE_SHM_DAMAGE_REFINEMENT))
+    return FALSE;
+
+  return meta_multi_texture_is_simple (texture);
+}
+
+/*
+ * Shrinks @region to the tiles whose contents changed since they were last
+ * uploaded to @texture. Many clients (e.g. Xwayland and Electron ones)
+ * damage their whole surface on every commit even when only a cursor
+ * blinked, and everything damaged here ends up both uploaded and redrawn.
+ *
+ * The texture contents are tracked by hashing the shm buffer contents of
+ * each tile as it's uploaded. This relies on clients not changing their
+ * buffers outside of the damage they post, as the protocol requires.
+ */
+static void
+refine_shm_damage (MetaWaylandBuffer *buffer,
+                   MetaMultiTexture  *texture,
+                   MtkRegion         *region)
+{
+  struct wl_shm_buffer *shm_buffer;
+  CoglTexture *cogl_texture;
+  MetaWaylandShmTileHashes *tile_hashes;
+  MtkRegionBuilder aligned_builder;
+  MtkRegionBuilder changed_builder;
+  g_autoptr (MtkRegion) aligned_region = NULL;
+  g_autoptr (MtkRegion) changed_region = NULL;
+  const uint8_t *data;
+  int width, height, stride, bpp;
+  int n_rectangles, i;
+
+  COGL_TRACE_BEGIN_SCOPED (RefineShmDamage,
+                           "Meta::WaylandBuffer::refine_shm_damage()");
+
+  shm_buffer = wl_shm_buffer_get (buffer->resource);
+  width = wl_shm_buffer_get_width (shm_buffer);
+  height = wl_shm_buffer_get_height (shm_buffer);
+  stride = wl_shm_buffer_get_stride (shm_buffer);
+
+  cogl_texture = meta_multi_texture_get_plane (texture, 0);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_texture_get_format (cogl_texture),
+                                                0);
+
+  tile_hashes = ensure_shm_tile_hashes (texture, width, height);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+
+  mtk_region_builder_init (&aligned_builder);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect;
+      int x1, y1, x2, y2;
+
+      rect = mtk_region_get_rectangle (region, i);
+
+      x1 = rect.x / SHM_DAMAGE_TILE_SIZE;
+      y1 = rect.y / SHM_DAMAGE_TILE_SIZE;
+      x2 = (rect.x + rect.width + SHM_DAMAGE_TILE_SIZE - 1) /
+           SHM_DAMAGE_TILE_SIZE;
+      y2 = (rect.y + rect.height + SHM_DAMAGE_TILE_SIZE - 1) /
+           SHM_DAMAGE_TILE_SIZE;
+      x2 = MIN (x2, tile_hashes->n_columns);
+      y2 = MIN (y2, tile_hashes->n_rows);
+
+      if (x2 > x1 && y2 > y1)
+        mtk_region_builder_add_rectangle (&aligned_builder,
+                                          x1, y1, x2 - x1, y2 - y1);
+    }
+  aligned_region = mtk_region_builder_finish (&aligned_builder);
+
+  wl_shm_buffer_begin_access (shm_buffer);
+  data = wl_shm_buffer_get_data (shm_buffer);
+
+  mtk_region_builder_init (&changed_builder);
+  for (i = 0; i < mtk_region_num_rectangles (aligned_region); i++)
+    {
+      MtkRectangle tiles;
+      int column, row;
+
+      tiles = mtk_region_get_rectangle (aligned_region, i);
+
+      for (row = tiles.y; row < tiles.y + tiles.height; row++)
+        {
+          for (column = tiles.x; column < tiles.x + tiles.width; column++)
+            {
+              uint64_t *stored_hash;
+              uint64_t hash;
+              int x = column * SHM_DAMAGE_TILE_SIZE;
+              int y = row * SHM_DAMAGE_TILE_SIZE;
+              int tile_width = MIN (SHM_DAMAGE_TILE_SIZE, width - x);
+              int tile_height = MIN (SHM_DAMAGE_TILE_SIZE, height - y);
+
+              hash = hash_tile (data + y * stride + x * bpp,
+                                stride,
+                                tile_width * bpp,
+                                tile_height);
+
+              stored_hash =
+                &tile_hashes->hashes[row * tile_hashes->n_columns + column];
+              if (*stored_hash == hash)
+                continue;
+
+              *stored_hash = hash;
+              mtk_region_builder_add_rectangle (&changed_builder,
+                                                x, y,
+                                                tile_width, tile_height);
+            }
+        }
+    }
+
+  wl_shm_buffer_end_access (shm_buffer);
+
+  changed_region = mtk_region_builder_finish (&changed_builder);
+  mtk_region_intersect (region, changed_region);
+
+  meta_topic (META_DEBUG_WAYLAND,
+              "[wl-shm] wl_buffer@%u damage refined from %d to %d rectangles",
+              wl_resource_get_id (buffer->resource),
+              n_rectangles,
+              mtk_region_num_rectangles (region));
+}
+
+static size_t
+get_damage_upload_size (MetaMultiTexture *texture,
+                        MtkRegion        *region)
+{
+  MetaMultiTextureFormat multi_format = meta_multi_texture_get_format (texture);
+  const MetaMultiTextureFormatInfo *mt_format_info =
+    meta_multi_texture_format_get_info (multi_format);
+  size_t area = 0;
+  size_t size = 0;
+  int i, n_rectangles, n_planes;
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+      area += mtk_rectangle_area (&rect);
+    }
+
+  n_planes = meta_multi_texture_get_n_planes (texture);
+  for (i = 0; i < n_planes; i++)
+    {
+      CoglTexture *cogl_texture = meta_multi_texture_get_plane (texture, i);
+      CoglPixelFormat subformat = cogl_texture_get_format (cogl_texture);
+      int bpp = cogl_pixel_format_get_bytes_per_pixel (subformat, 0);
+
+      size += area * bpp / (mt_format_info->hsub[i] * mt_format_info->vsub[i]);
+    }
+
+  return size;
+}
+
 static gboolean
 process_shm_buffer_damage (MetaWaylandBuffer *buffer,
                            MetaMultiTexture  *texture,
@@ -776,6 +1169,39 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
   int height;
   uint32_t shm_format;
   int i, n_rectangles, n_planes;
+  g_autoptr (MetaWaylandShmUpload) upload = NULL;
+
+  upload = g_steal_pointer (&buffer->shm.upload);
+
+  if (should_refine_shm_damage (buffer, texture))
+    {
+      refine_shm_damage (buffer, texture, region);
+      if (mtk_region_is_empty (region))
+        return TRUE;
+    }
+  else
+    {
+      /* Whatever is uploaded now won't be tracked */
+      g_object_set_qdata (G_OBJECT (texture), quark_shm_tile_hashes, NULL);
+    }
+
+  meta_wayland_client_stats_add_shm_upload (wl_resource_get_client (buffer->resource),
+                                            get_damage_upload_size (texture,
+                                                                    region));
+
+  if (upload)
+    {
+      g_autoptr (GError) upload_error = NULL;
+
+      if (meta_wayland_shm_upload_finish (upload,
+                                          meta_multi_texture_get_plane (texture, 0),
+                                          region,
+                                          &upload_error))
+        return TRUE;
+
+      meta_topic (META_DEBUG_WAYLAND,
+                  "Discarding staged shm upload: %s", upload_error->message);
+    }
 
   n_rectangles = mtk_region_num_rectangles (region);
 
@@ -813,6 +1239,11 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
       subformat = cogl_texture_get_format (cogl_texture);
       bpp = cogl_pixel_format_get_bytes_per_pixel (subformat, 0);
 
+      if (horizontal_factor == 1 && vertical_factor == 1 &&
+          try_stream_shm_damage (buffer, cogl_texture, subformat, bpp,
+                                 plane_data, plane_stride, region))
+        continue;
+
       for (j = 0; j < n_rectangles; j++)
         {
           MtkRectangle rect;
@@ -843,6 +1274,137 @@ fail:
   return FALSE;
 }
 
+typedef struct _MetaWaylandShmUploadSource
+{
+  GSource base;
+
+  MetaWaylandBuffer *buffer;
+  MetaWaylandShmUpload *upload;
+  MetaWaylandDmaBufSourceDispatch dispatch;
+  gpointer user_data;
+} MetaWaylandShmUploadSource;
+
+static gboolean
+meta_wayland_shm_upload_source_dispatch (GSource     *base,
+                                         GSourceFunc  callback,
+                                         gpointer     user_data)
+{
+  MetaWaylandShmUploadSource *source = (MetaWaylandShmUploadSource *) base;
+
+  if (!meta_wayland_shm_upload_is_done (source->upload))
+    {
+      g_source_set_ready_time (base, -1);
+      return G_SOURCE_CONTINUE;
+    }
+
+  source->dispatch (source->buffer, source->user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_wayland_shm_upload_source_finalize (GSource *base)
+{
+  MetaWaylandShmUploadSource *source = (MetaWaylandShmUploadSource *) base;
+
+  meta_wayland_shm_upload_set_ready_source (source->upload, NULL);
+  g_clear_pointer (&source->upload, meta_wayland_shm_upload_unref);
+  g_clear_object (&source->buffer);
+}
+
+static GSourceFuncs meta_wayland_shm_upload_source_funcs = {
+  .dispatch = meta_wayland_shm_upload_source_dispatch,
+  .finalize = meta_wayland_shm_upload_source_finalize
+};
+
+/**
+ * meta_wayland_buffer_create_shm_upload_source:
+ * @buffer: A #MetaWaylandBuffer object
+ * @surface_damage: Committed wl_surface.damage region
+ * @buffer_damage: Committed wl_surface.damage_buffer region
+ * @dispatch: Callback
+ * @user_data: User data for the callback
+ *
+ * Starts copying the damaged parts of a shm buffer into a pixel buffer off
+ * the main thread, and creates a GSource which will call the specified
+ * dispatch callback once the copy has finished. The staged data is used
+ * by the next meta_wayland_buffer_process_damage() call for the buffer.
+ *
+ * Returns: The new GSource (or %NULL if the buffer is not a shm buffer, or
+ * the damage is not worth staging)
+ */
+GSource *
+meta_wayland_buffer_create_shm_upload_source (MetaWaylandBuffer               *buffer,
+                                              MtkRegion                       *surface_damage,
+                                              MtkRegion                       *buffer_damage,
+                                              MetaWaylandDmaBufSourceDispatch  dispatch,
+                                              gpointer                         user_data)
+{
+  MetaWaylandShmUploader *uploader = buffer->compositor->shm_uploader;
+  MetaWaylandShmUploadSource *source;
+  struct wl_shm_buffer *shm_buffer;
+  const MetaFormatInfo *format_info;
+  g_autoptr (MtkRegion) region = NULL;
+  MtkRectangle buffer_rect;
+
+  /* Anything staged for an earlier commit of this buffer is stale now */
+  if (buffer->shm.upload)
+    {
+      meta_wayland_shm_upload_wait_for_copy (buffer->shm.upload);
+      g_clear_pointer (&buffer->shm.upload, meta_wayland_shm_upload_unref);
+    }
+
+  if (!uploader || !buffer->resource)
+    return NULL;
+
+  shm_buffer = wl_shm_buffer_get (buffer->resource);
+  if (!shm_buffer)
+    return NULL;
+
+  format_info =
+    get_supported_shm_format_info (wl_shm_buffer_get_format (shm_buffer));
+  if (!format_info ||
+      format_info->multi_texture_format != META_MULTI_TEXTURE_FORMAT_SIMPLE)
+    return NULL;
+
+  buffer_rect = (MtkRectangle) {
+    .width = wl_shm_buffer_get_width (shm_buffer),
+    .height = wl_shm_buffer_get_height (shm_buffer),
+  };
+
+  /* Surface damage is only mapped to buffer coordinates once the state is
+   * applied, so conservatively stage the whole buffer for it. */
+  if (surface_damage && !mtk_region_is_empty (surface_damage))
+    region = mtk_region_create_rectangle (&buffer_rect);
+  else if (buffer_damage && !mtk_region_is_empty (buffer_damage))
+    region = mtk_region_copy (buffer_damage);
+  else
+    return NULL;
+
+  mtk_region_intersect_rectangle (region, &buffer_rect);
+
+  buffer->shm.upload = meta_wayland_shm_uploader_stage (uploader,
+                                                        shm_buffer,
+                                                        format_info->cogl_format,
+                                                        region);
+  if (!buffer->shm.upload)
+    return NULL;
+
+  source =
+    (MetaWaylandShmUploadSource *) g_source_new (&meta_wayland_shm_upload_source_funcs,
+                                                 sizeof (*source));
+  g_source_set_name (&source->base, "[mutter] Shm upload source");
+
+  source->buffer = g_object_ref (buffer);
+  source->upload = meta_wayland_shm_upload_ref (buffer->shm.upload);
+  source->dispatch = dispatch;
+  source->user_data = user_data;
+
+  meta_wayland_shm_upload_set_ready_source (source->upload, &source->base);
+
+  return &source->base;
+}
+
 void
 meta_wayland_buffer_process_damage (MetaWaylandBuffer *buffer,
                                     MetaMultiTexture  *texture,
@@ -942,11 +1504,24 @@ scanout_destroyed (gpointer  data,
   g_object_unref (buffer);
 }
 
+static void
+track_scanout (MetaWaylandBuffer *buffer,
+               CoglScanout       *scanout)
+{
+  g_signal_connect (scanout, "scanout-failed",
+                    G_CALLBACK (on_scanout_failed), buffer);
+
+  g_object_ref (buffer);
+  meta_wayland_buffer_inc_use_count (buffer);
+  g_object_weak_ref (G_OBJECT (scanout), scanout_destroyed, buffer);
+}
+
 CoglScanout *
 meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                                          CoglOnscreen          *onscreen,
                                          const graphene_rect_t *src_rect,
-                                         const MtkRectangle    *dst_rect)
+                                         const MtkRectangle    *dst_rect,
+                                         MtkMonitorTransform    transform)
 {
   CoglScanout *scanout = NULL;
 
@@ -977,6 +1552,12 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                       "Buffer type does not support scaling operations");
           return NULL;
         }
+      if (transform != MTK_MONITOR_TRANSFORM_NORMAL)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Buffer type does not support transforms");
+          return NULL;
+        }
       scanout = try_acquire_egl_image_scanout (buffer, onscreen);
       break;
     case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
@@ -984,7 +1565,8 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
         scanout = meta_wayland_dma_buf_try_acquire_scanout (buffer,
                                                             onscreen,
                                                             src_rect,
-                                                            dst_rect);
+                                                            dst_rect,
+                                                            transform);
         break;
       }
     case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
@@ -995,12 +1577,48 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   if (!scanout)
     return NULL;
 
-  g_signal_connect (scanout, "scanout-failed",
-                    G_CALLBACK (on_scanout_failed), buffer);
+  track_scanout (buffer, scanout);
 
-  g_object_ref (buffer);
-  meta_wayland_buffer_inc_use_count (buffer);
-  g_object_weak_ref (G_OBJECT (scanout), scanout_destroyed, buffer);
+  return scanout;
+}
+
+CoglScanout *
+meta_wayland_buffer_try_acquire_overlay_scanout (MetaWaylandBuffer     *buffer,
+                                                 CoglOnscreen          *onscreen,
+                                                 const graphene_rect_t *src_rect,
+                                                 const MtkRectangle    *dst_rect,
+                                                 MtkMonitorTransform    transform,
+                                                 CoglScanout           *primary_scanout)
+{
+  CoglScanout *scanout;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaWaylandBufferTryOverlayScanout,
+                           "Meta::WaylandBuffer::try_acquire_overlay_scanout()");
+
+  if (buffer->tainted_scanout_onscreens &&
+      g_hash_table_lookup (buffer->tainted_scanout_onscreens, onscreen))
+    {
+      meta_topic (META_DEBUG_RENDER, "Buffer scanout capability tainted");
+      return NULL;
+    }
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Buffer type not overlay plane compatible");
+      return NULL;
+    }
+
+  scanout = meta_wayland_dma_buf_try_acquire_overlay_scanout (buffer,
+                                                              onscreen,
+                                                              src_rect,
+                                                              dst_rect,
+                                                              transform,
+                                                              primary_scanout);
+  if (!scanout)
+    return NULL;
+
+  track_scanout (buffer, scanout);
 
   return scanout;
 }
@@ -1023,6 +1641,7 @@ meta_wayland_buffer_finalize (GObject *object)
 #endif
   g_clear_object (&buffer->dma_buf.texture);
   g_clear_object (&buffer->dma_buf.dma_buf);
+  g_clear_pointer (&buffer->shm.upload, meta_wayland_shm_upload_unref);
   g_clear_pointer (&buffer->single_pixel.single_pixel_buffer,
                    meta_wayland_single_pixel_buffer_free);
   g_clear_object (&buffer->single_pixel.texture);
@@ -1043,6 +1662,9 @@ meta_wayland_buffer_class_init (MetaWaylandBufferClass *klass)
 
   object_class->finalize = meta_wayland_buffer_finalize;
 
+  quark_shm_tile_hashes =
+    g_quark_from_static_string ("-meta-wayland-shm-tile-hashes");
+
   /**
    * MetaWaylandBuffer::resource-destroyed:
    *
@@ -1142,4 +1764,6 @@ meta_wayland_init_shm (MetaWaylandCompositor *compositor)
                                      possible_formats[i]);
         }
     }
+
+  compositor->shm_uploader = meta_wayland_shm_uploader_new (cogl_context);
 }
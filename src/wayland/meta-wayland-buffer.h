@@ -29,6 +29,7 @@
 #include "wayland/meta-wayland-types.h"
 #include "wayland/meta-wayland-egl-stream.h"
 #include "wayland/meta-wayland-dma-buf.h"
+#include "wayland/meta-wayland-shm-upload.h"
 #include "wayland/meta-wayland-single-pixel-buffer.h"
 
 typedef enum _MetaWaylandBufferType
@@ -53,6 +54,9 @@ struct _MetaWaylandBuffer
 
   unsigned int use_count;
 
+  /* Buffer memory charged to the client while the resource exists */
+  size_t accounted_memory;
+
   gboolean is_y_inverted;
 
   MetaWaylandBufferType type;
@@ -73,6 +77,10 @@ struct _MetaWaylandBuffer
     MetaMultiTexture *texture;
   } dma_buf;
 
+  struct {
+    MetaWaylandShmUpload *upload;
+  } shm;
+
   struct {
     MetaWaylandSinglePixelBuffer *single_pixel_buffer;
     MetaMultiTexture *texture;
@@ -102,9 +110,21 @@ gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuff
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  MetaMultiTexture      *texture,
                                                                  MtkRegion             *region);
+GSource *               meta_wayland_buffer_create_shm_upload_source (MetaWaylandBuffer               *buffer,
+                                                                      MtkRegion                       *surface_damage,
+                                                                      MtkRegion                       *buffer_damage,
+                                                                      MetaWaylandDmaBufSourceDispatch  dispatch,
+                                                                      gpointer                         user_data);
 CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                                                                  CoglOnscreen          *onscreen,
                                                                  const graphene_rect_t *src_rect,
-                                                                 const MtkRectangle    *dst_rect);
+                                                                 const MtkRectangle    *dst_rect,
+                                                                 MtkMonitorTransform    transform);
+CoglScanout *           meta_wayland_buffer_try_acquire_overlay_scanout (MetaWaylandBuffer     *buffer,
+                                                                         CoglOnscreen          *onscreen,
+                                                                         const graphene_rect_t *src_rect,
+                                                                         const MtkRectangle    *dst_rect,
+                                                                         MtkMonitorTransform    transform,
+                                                                         CoglScanout           *primary_scanout);
 
 void meta_wayland_init_shm (MetaWaylandCompositor *compositor);
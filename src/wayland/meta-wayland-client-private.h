@@ -22,6 +22,8 @@
 #include "core/meta-service-channel.h"
 #include "core/util-private.h"
 #include "meta/meta-wayland-client.h"
+#include "mtk/mtk.h"
+#include "wayland/meta-wayland-types.h"
 
 META_EXPORT_TEST
 MetaWaylandClient * meta_wayland_client_new_indirect (MetaContext  *context,
@@ -39,3 +41,27 @@ void meta_wayland_client_assign_service_client_type (MetaWaylandClient     *clie
                                                      MetaServiceClientType  service_client_type);
 
 MetaServiceClientType  meta_wayland_client_get_service_client_type (MetaWaylandClient *client);
+
+void meta_wayland_client_stats_init (MetaWaylandCompositor *compositor);
+
+void meta_wayland_client_stats_finalize (MetaWaylandCompositor *compositor);
+
+void meta_wayland_client_stats_track (MetaWaylandCompositor *compositor,
+                                      struct wl_client      *wayland_client);
+
+void meta_wayland_client_stats_end_dispatch (MetaWaylandCompositor *compositor);
+
+void meta_wayland_client_stats_add_commit (struct wl_client *wayland_client);
+
+void meta_wayland_client_stats_add_frame_callback (struct wl_client *wayland_client);
+
+void meta_wayland_client_stats_add_damage (struct wl_client *wayland_client,
+                                           MtkRegion        *region);
+
+void meta_wayland_client_stats_add_shm_upload (struct wl_client *wayland_client,
+                                               size_t            n_bytes);
+
+void meta_wayland_client_stats_add_buffer_memory (struct wl_client *wayland_client,
+                                                  int64_t           n_bytes);
+
+GVariant * meta_wayland_client_stats_collect (MetaWaylandCompositor *compositor);
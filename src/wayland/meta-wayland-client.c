@@ -35,6 +35,7 @@
 #include <sys/types.h>
 #include <wayland-server.h>
 
+#include "cogl/cogl.h"
 #include "core/window-private.h"
 #include "meta/util.h"
 #include "wayland/meta-wayland-private.h"
@@ -539,3 +540,355 @@ meta_wayland_client_get_service_client_type (MetaWaylandClient *client)
 {
   return client->service_client_type;
 }
+
+/*
+ * Resource accounting is done for every connected wl_client, not only for
+ * the ones a MetaWaylandClient was created for. The stats are owned by the
+ * destroy listener of the wl_client they belong to, which is also how they
+ * are looked up. Rates are averaged over intervals of about a second,
+ * which end on the first update after the interval has passed.
+ */
+#define CLIENT_STATS_INTERVAL_US (G_USEC_PER_SEC)
+
+struct _MetaWaylandClientStats
+{
+  MetaWaylandCompositor *compositor;
+  struct wl_listener destroy_listener;
+
+  pid_t pid;
+
+  uint64_t n_commits;
+  uint64_t n_frame_callbacks;
+  uint64_t n_requests;
+  uint64_t shm_bytes_uploaded;
+  uint64_t damage_area;
+  int64_t buffer_memory;
+  int64_t request_time_us;
+
+  struct {
+    int64_t start_us;
+
+    uint64_t n_commits;
+    uint64_t shm_bytes_uploaded;
+    int64_t request_time_us;
+
+    double commit_rate;
+    double shm_upload_rate;
+    double request_time_ratio;
+  } interval;
+
+#ifdef HAVE_PROFILER
+  struct {
+    gboolean defined;
+    unsigned int commit_rate;
+    unsigned int shm_upload_rate;
+    unsigned int buffer_memory;
+    unsigned int request_time;
+  } trace_counters;
+#endif
+};
+
+static void
+client_stats_destroyed_cb (struct wl_listener *listener,
+                           void               *user_data)
+{
+  MetaWaylandClientStats *stats = wl_container_of (listener, stats,
+                                                   destroy_listener);
+
+  if (stats->compositor->client_stats.current == stats)
+    stats->compositor->client_stats.current = NULL;
+
+  g_free (stats);
+}
+
+static MetaWaylandClientStats *
+client_stats_from_client (struct wl_client *wayland_client)
+{
+  MetaWaylandClientStats *stats;
+  struct wl_listener *listener;
+
+  listener = wl_client_get_destroy_listener (wayland_client,
+                                             client_stats_destroyed_cb);
+  if (!listener)
+    return NULL;
+
+  return wl_container_of (listener, stats, destroy_listener);
+}
+
+#ifdef HAVE_PROFILER
+static unsigned int
+define_client_trace_counter (MetaWaylandClientStats *stats,
+                             const char             *name,
+                             const char             *description)
+{
+  g_autofree char *counter_name = NULL;
+  g_autofree char *counter_description = NULL;
+
+  counter_name = g_strdup_printf ("%s (%d)", name, (int) stats->pid);
+  counter_description = g_strdup_printf ("%s of Wayland client %d",
+                                         description, (int) stats->pid);
+
+  return cogl_trace_define_counter_int (counter_name, counter_description);
+}
+
+static void
+update_client_trace_counters (MetaWaylandClientStats *stats)
+{
+  if (!cogl_is_tracing_enabled ())
+    return;
+
+  if (!stats->trace_counters.defined)
+    {
+      stats->trace_counters.commit_rate =
+        define_client_trace_counter (stats, "Commits/s",
+                                     "Surface commits per second");
+      stats->trace_counters.shm_upload_rate =
+        define_client_trace_counter (stats, "Shm upload B/s",
+                                     "Bytes uploaded from shm per second");
+      stats->trace_counters.buffer_memory =
+        define_client_trace_counter (stats, "Buffer memory",
+                                     "Memory of the imported buffers");
+      stats->trace_counters.request_time =
+        define_client_trace_counter (stats, "Request time µs/s",
+                                     "Time spent handling requests per second");
+      stats->trace_counters.defined = TRUE;
+    }
+
+  cogl_trace_set_counter_int (stats->trace_counters.commit_rate,
+                              (int64_t) stats->interval.commit_rate);
+  cogl_trace_set_counter_int (stats->trace_counters.shm_upload_rate,
+                              (int64_t) stats->interval.shm_upload_rate);
+  cogl_trace_set_counter_int (stats->trace_counters.buffer_memory,
+                              stats->buffer_memory);
+  cogl_trace_set_counter_int (stats->trace_counters.request_time,
+                              (int64_t) (stats->interval.request_time_ratio *
+                                         G_USEC_PER_SEC));
+}
+#endif
+
+static void
+update_client_stats_interval (MetaWaylandClientStats *stats,
+                              int64_t                 now_us)
+{
+  int64_t elapsed_us;
+  double elapsed_s;
+
+  elapsed_us = now_us - stats->interval.start_us;
+  if (elapsed_us < CLIENT_STATS_INTERVAL_US)
+    return;
+
+  elapsed_s = (double) elapsed_us / G_USEC_PER_SEC;
+  stats->interval.commit_rate =
+    (stats->n_commits - stats->interval.n_commits) / elapsed_s;
+  stats->interval.shm_upload_rate =
+    (stats->shm_bytes_uploaded - stats->interval.shm_bytes_uploaded) /
+    elapsed_s;
+  stats->interval.request_time_ratio =
+    (double) (stats->request_time_us - stats->interval.request_time_us) /
+    elapsed_us;
+
+  stats->interval.start_us = now_us;
+  stats->interval.n_commits = stats->n_commits;
+  stats->interval.shm_bytes_uploaded = stats->shm_bytes_uploaded;
+  stats->interval.request_time_us = stats->request_time_us;
+
+#ifdef HAVE_PROFILER
+  update_client_trace_counters (stats);
+#endif
+}
+
+static void
+end_current_request (MetaWaylandCompositor *compositor,
+                     int64_t                now_us)
+{
+  MetaWaylandClientStats *stats = compositor->client_stats.current;
+
+  if (!stats)
+    return;
+
+  stats->request_time_us += now_us - compositor->client_stats.request_start_us;
+  compositor->client_stats.current = NULL;
+
+  update_client_stats_interval (stats, now_us);
+}
+
+/*
+ * Requests are logged right before their handler is invoked, so the time
+ * until the next request, or until the end of the dispatch, is charged to
+ * the client that sent the request.
+ */
+static void
+client_stats_protocol_logger (void                                    *user_data,
+                              enum wl_protocol_logger_type             type,
+                              const struct wl_protocol_logger_message *message)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaWaylandClientStats *stats;
+  int64_t now_us;
+
+  if (type != WL_PROTOCOL_LOGGER_REQUEST)
+    return;
+
+  now_us = g_get_monotonic_time ();
+  end_current_request (compositor, now_us);
+
+  stats = client_stats_from_client (wl_resource_get_client (message->resource));
+  if (!stats)
+    return;
+
+  stats->n_requests++;
+  compositor->client_stats.current = stats;
+  compositor->client_stats.request_start_us = now_us;
+}
+
+void
+meta_wayland_client_stats_init (MetaWaylandCompositor *compositor)
+{
+  compositor->client_stats.protocol_logger =
+    wl_display_add_protocol_logger (compositor->wayland_display,
+                                    client_stats_protocol_logger,
+                                    compositor);
+}
+
+void
+meta_wayland_client_stats_finalize (MetaWaylandCompositor *compositor)
+{
+  g_clear_pointer (&compositor->client_stats.protocol_logger,
+                   wl_protocol_logger_destroy);
+  compositor->client_stats.current = NULL;
+}
+
+void
+meta_wayland_client_stats_track (MetaWaylandCompositor *compositor,
+                                 struct wl_client      *wayland_client)
+{
+  MetaWaylandClientStats *stats;
+
+  stats = g_new0 (MetaWaylandClientStats, 1);
+  stats->compositor = compositor;
+  wl_client_get_credentials (wayland_client, &stats->pid, NULL, NULL);
+  stats->interval.start_us = g_get_monotonic_time ();
+
+  stats->destroy_listener.notify = client_stats_destroyed_cb;
+  wl_client_add_destroy_listener (wayland_client, &stats->destroy_listener);
+}
+
+void
+meta_wayland_client_stats_end_dispatch (MetaWaylandCompositor *compositor)
+{
+  if (!compositor->client_stats.current)
+    return;
+
+  end_current_request (compositor, g_get_monotonic_time ());
+}
+
+void
+meta_wayland_client_stats_add_commit (struct wl_client *wayland_client)
+{
+  MetaWaylandClientStats *stats = client_stats_from_client (wayland_client);
+
+  if (stats)
+    stats->n_commits++;
+}
+
+void
+meta_wayland_client_stats_add_frame_callback (struct wl_client *wayland_client)
+{
+  MetaWaylandClientStats *stats = client_stats_from_client (wayland_client);
+
+  if (stats)
+    stats->n_frame_callbacks++;
+}
+
+void
+meta_wayland_client_stats_add_damage (struct wl_client *wayland_client,
+                                      MtkRegion        *region)
+{
+  MetaWaylandClientStats *stats = client_stats_from_client (wayland_client);
+  int n_rectangles, i;
+
+  if (!stats)
+    return;
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+      stats->damage_area += mtk_rectangle_area (&rect);
+    }
+}
+
+void
+meta_wayland_client_stats_add_shm_upload (struct wl_client *wayland_client,
+                                          size_t            n_bytes)
+{
+  MetaWaylandClientStats *stats = client_stats_from_client (wayland_client);
+
+  if (stats)
+    stats->shm_bytes_uploaded += n_bytes;
+}
+
+void
+meta_wayland_client_stats_add_buffer_memory (struct wl_client *wayland_client,
+                                             int64_t           n_bytes)
+{
+  MetaWaylandClientStats *stats = client_stats_from_client (wayland_client);
+
+  if (stats)
+    stats->buffer_memory += n_bytes;
+}
+
+/**
+ * meta_wayland_client_stats_collect: (skip)
+ * @compositor: A #MetaWaylandCompositor
+ *
+ * Returns: (transfer floating): The resource usage of every connected
+ *   client, as an array of the client pid and a vardict of its stats
+ */
+GVariant *
+meta_wayland_client_stats_collect (MetaWaylandCompositor *compositor)
+{
+  struct wl_list *client_list;
+  struct wl_client *wayland_client;
+  GVariantBuilder builder;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+  client_list = wl_display_get_client_list (compositor->wayland_display);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ua{sv})"));
+  wl_client_for_each (wayland_client, client_list)
+    {
+      MetaWaylandClientStats *stats;
+      GVariantBuilder stats_builder;
+
+      stats = client_stats_from_client (wayland_client);
+      if (!stats)
+        continue;
+
+      update_client_stats_interval (stats, now_us);
+
+      g_variant_builder_init (&stats_builder, G_VARIANT_TYPE_VARDICT);
+      g_variant_builder_add (&stats_builder, "{sv}", "commits",
+                             g_variant_new_uint64 (stats->n_commits));
+      g_variant_builder_add (&stats_builder, "{sv}", "commits-per-second",
+                             g_variant_new_double (stats->interval.commit_rate));
+      g_variant_builder_add (&stats_builder, "{sv}", "frame-callbacks",
+                             g_variant_new_uint64 (stats->n_frame_callbacks));
+      g_variant_builder_add (&stats_builder, "{sv}", "damage-area",
+                             g_variant_new_uint64 (stats->damage_area));
+      g_variant_builder_add (&stats_builder, "{sv}", "shm-bytes-uploaded",
+                             g_variant_new_uint64 (stats->shm_bytes_uploaded));
+      g_variant_builder_add (&stats_builder, "{sv}", "buffer-memory",
+                             g_variant_new_int64 (stats->buffer_memory));
+      g_variant_builder_add (&stats_builder, "{sv}", "requests",
+                             g_variant_new_uint64 (stats->n_requests));
+      g_variant_builder_add (&stats_builder, "{sv}", "request-time-us",
+                             g_variant_new_int64 (stats->request_time_us));
+      g_variant_builder_add (&builder, "(ua{sv})",
+                             (uint32_t) stats->pid, &stats_builder);
+    }
+
+  return g_variant_builder_end (&builder);
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-content-type.h"
+
+#include <glib.h>
+
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "content-type-v1-server-protocol.h"
+
+static MetaWaylandContentType
+content_type_from_wire (uint32_t content_type)
+{
+  switch (content_type)
+    {
+    case WP_CONTENT_TYPE_V1_TYPE_PHOTO:
+      return META_WAYLAND_CONTENT_TYPE_PHOTO;
+    case WP_CONTENT_TYPE_V1_TYPE_VIDEO:
+      return META_WAYLAND_CONTENT_TYPE_VIDEO;
+    case WP_CONTENT_TYPE_V1_TYPE_GAME:
+      return META_WAYLAND_CONTENT_TYPE_GAME;
+    default:
+      return META_WAYLAND_CONTENT_TYPE_NONE;
+    }
+}
+
+static void
+wp_content_type_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  /* Destroying the object is equivalent to setting the 'none' type */
+  surface->pending_state->has_content_type = TRUE;
+  surface->pending_state->content_type = META_WAYLAND_CONTENT_TYPE_NONE;
+
+  g_clear_signal_handler (&surface->content_type.destroy_handler_id,
+                          surface);
+  surface->content_type.resource = NULL;
+}
+
+static void
+on_surface_destroyed (MetaWaylandSurface *surface)
+{
+  wl_resource_set_user_data (surface->content_type.resource, NULL);
+}
+
+static void
+wp_content_type_set_content_type (struct wl_client   *client,
+                                  struct wl_resource *resource,
+                                  uint32_t            content_type)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (resource);
+  MetaWaylandSurfaceState *pending;
+
+  if (!surface)
+    return;
+
+  pending = surface->pending_state;
+  pending->has_content_type = TRUE;
+  pending->content_type = content_type_from_wire (content_type);
+}
+
+static void
+wp_content_type_destroy (struct wl_client   *client,
+                         struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct wp_content_type_v1_interface meta_wayland_content_type_interface = {
+  wp_content_type_destroy,
+  wp_content_type_set_content_type,
+};
+
+static void
+wp_content_type_manager_destroy (struct wl_client   *client,
+                                 struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+wp_content_type_manager_get_surface_content_type (struct wl_client   *client,
+                                                  struct wl_resource *resource,
+                                                  uint32_t            id,
+                                                  struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
+  struct wl_resource *content_type_resource;
+
+  if (surface->content_type.resource)
+    {
+      wl_resource_post_error (resource,
+                              WP_CONTENT_TYPE_MANAGER_V1_ERROR_ALREADY_CONSTRUCTED,
+                              "content type already exists on surface");
+      return;
+    }
+
+  content_type_resource = wl_resource_create (client,
+                                              &wp_content_type_v1_interface,
+                                              wl_resource_get_version (resource),
+                                              id);
+  wl_resource_set_implementation (content_type_resource,
+                                  &meta_wayland_content_type_interface,
+                                  surface,
+                                  wp_content_type_destructor);
+
+  surface->content_type.resource = content_type_resource;
+  surface->content_type.destroy_handler_id =
+    g_signal_connect (surface,
+                      "destroy",
+                      G_CALLBACK (on_surface_destroyed),
+                      NULL);
+}
+
+static const struct wp_content_type_manager_v1_interface meta_wayland_content_type_manager_interface = {
+  wp_content_type_manager_destroy,
+  wp_content_type_manager_get_surface_content_type,
+};
+
+static void
+wp_content_type_manager_bind (struct wl_client *client,
+                              void             *data,
+                              uint32_t          version,
+                              uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_content_type_manager_v1_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &meta_wayland_content_type_manager_interface,
+                                  data,
+                                  NULL);
+}
+
+void
+meta_wayland_init_content_type (MetaWaylandCompositor *compositor)
+{
+  if (wl_global_create (compositor->wayland_display,
+                        &wp_content_type_manager_v1_interface,
+                        META_WP_CONTENT_TYPE_V1_VERSION,
+                        compositor,
+                        wp_content_type_manager_bind) == NULL)
+    g_error ("Failed to register a global wp_content_type_manager object");
+}
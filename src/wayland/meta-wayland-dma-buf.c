@@ -71,6 +71,8 @@
 
 #define META_WAYLAND_DMA_BUF_MAX_FDS 4
 
+#define SURFACE_FEEDBACK_MIN_UPDATE_INTERVAL_US (G_USEC_PER_SEC / 2)
+
 /* Compatible with zwp_linux_dmabuf_feedback_v1.tranche_flags */
 typedef enum _MetaWaylandDmaBufTrancheFlags
 {
@@ -98,6 +100,7 @@ typedef struct _MetaWaylandDmaBufTranche
   GArray *formats;
   MetaWaylandDmaBufTrancheFlags flags;
   uint64_t scanout_crtc_id;
+  uint32_t scanout_plane_id;
 } MetaWaylandDmaBufTranche;
 
 typedef struct _MetaWaylandDmaBufFeedback
@@ -113,6 +116,10 @@ typedef struct _MetaWaylandDmaBufSurfaceFeedback
   MetaWaylandDmaBufFeedback *feedback;
   GList *resources;
   gulong scanout_candidate_changed_id;
+  gulong overlay_candidate_changed_id;
+
+  int64_t last_update_time_us;
+  guint update_timeout_id;
 } MetaWaylandDmaBufSurfaceFeedback;
 
 struct _MetaWaylandDmaBufManager
@@ -603,15 +610,13 @@ import_scanout_gbm_bo (MetaWaylandDmaBufBuffer  *dma_buf,
 
   return gbm_bo;
 }
-#endif
 
-CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect)
+static CoglScanout *
+create_scanout (MetaWaylandBuffer     *buffer,
+                const graphene_rect_t *src_rect,
+                const MtkRectangle    *dst_rect,
+                MtkMonitorTransform    transform)
 {
-#ifdef HAVE_NATIVE_BACKEND
   MetaWaylandDmaBufBuffer *dma_buf;
   MetaContext *context;
   MetaBackend *backend;
@@ -621,7 +626,7 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   MetaGpuKms *gpu_kms;
   struct gbm_bo *gbm_bo;
   g_autoptr (MetaDrmBufferGbm) fb = NULL;
-  g_autoptr (CoglScanout) scanout = NULL;
+  CoglScanout *scanout;
   g_autoptr (GError) error = NULL;
   MetaDrmBufferFlags flags;
   gboolean use_modifier;
@@ -669,6 +674,25 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   scanout = cogl_scanout_new (COGL_SCANOUT_BUFFER (g_steal_pointer (&fb)));
   cogl_scanout_set_src_rect (scanout, src_rect);
   cogl_scanout_set_dst_rect (scanout, dst_rect);
+  cogl_scanout_set_transform (scanout, transform);
+
+  return scanout;
+}
+#endif
+
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
+                                          CoglOnscreen          *onscreen,
+                                          const graphene_rect_t *src_rect,
+                                          const MtkRectangle    *dst_rect,
+                                          MtkMonitorTransform    transform)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  scanout = create_scanout (buffer, src_rect, dst_rect, transform);
+  if (!scanout)
+    return NULL;
 
   if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout))
     {
@@ -683,6 +707,36 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
 #endif
 }
 
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_overlay_scanout (MetaWaylandBuffer     *buffer,
+                                                  CoglOnscreen          *onscreen,
+                                                  const graphene_rect_t *src_rect,
+                                                  const MtkRectangle    *dst_rect,
+                                                  MtkMonitorTransform    transform,
+                                                  CoglScanout           *primary_scanout)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  scanout = create_scanout (buffer, src_rect, dst_rect, transform);
+  if (!scanout)
+    return NULL;
+
+  if (!meta_onscreen_native_is_buffer_overlay_compatible (onscreen, scanout,
+                                                          primary_scanout))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Buffer not overlay plane compatible (see also KMS debug "
+                  "topic)");
+      return NULL;
+    }
+
+  return g_steal_pointer (&scanout);
+#else
+  return NULL;
+#endif
+}
+
 static void
 buffer_params_add (struct wl_client   *client,
                    struct wl_resource *resource,
@@ -853,6 +907,40 @@ meta_wayland_dma_buf_from_buffer (MetaWaylandBuffer *buffer)
   return buffer->dma_buf.dma_buf;
 }
 
+void
+meta_wayland_dma_buf_get_format (MetaWaylandDmaBufBuffer *dma_buf,
+                                 int                     *width,
+                                 int                     *height,
+                                 uint32_t                *drm_format)
+{
+  *width = dma_buf->width;
+  *height = dma_buf->height;
+  *drm_format = dma_buf->drm_format;
+}
+
+/*
+ * The size is estimated from the plane layout, since neither the size of
+ * the dma-buf objects nor the vertical subsampling of the planes are known.
+ */
+size_t
+meta_wayland_dma_buf_get_size (MetaWaylandDmaBufBuffer *dma_buf)
+{
+  size_t size = 0;
+  int i;
+
+  for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
+    {
+      if (dma_buf->fds[i] < 0)
+        continue;
+
+      size = MAX (size,
+                  dma_buf->offsets[i] +
+                  (size_t) dma_buf->strides[i] * dma_buf->height);
+    }
+
+  return size;
+}
+
 typedef struct _MetaWaylandDmaBufSource
 {
   GSource base;
@@ -1312,57 +1400,51 @@ has_modifier (GArray   *modifiers,
 }
 
 static gboolean
-crtc_supports_modifier (MetaCrtcKms *crtc_kms,
-                        uint32_t     drm_format,
-                        uint64_t     drm_modifier)
+plane_supports_modifier (MetaKmsPlane *plane,
+                         uint32_t      drm_format,
+                         uint64_t      drm_modifier)
 {
-  MetaKmsPlane *plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
-  GArray *crtc_modifiers;
+  GArray *plane_modifiers;
 
-  g_return_val_if_fail (plane, FALSE);
-
-  crtc_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
-  if (!crtc_modifiers)
+  plane_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
+  if (!plane_modifiers)
     return FALSE;
 
-  return has_modifier (crtc_modifiers, drm_modifier);
+  return has_modifier (plane_modifiers, drm_modifier);
 }
 
-static void
+static gboolean
 ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
-                        MetaCrtc                         *crtc)
+                        MetaCrtc                         *crtc,
+                        MetaKmsPlane                     *kms_plane)
 {
   MetaWaylandDmaBufManager *dma_buf_manager = surface_feedback->dma_buf_manager;
   MetaContext *context =
     meta_wayland_compositor_get_context (dma_buf_manager->compositor);
   MetaBackend *backend = meta_context_get_backend (context);
   MetaWaylandDmaBufFeedback *feedback = surface_feedback->feedback;
-  MetaCrtcKms *crtc_kms;
-  MetaKmsPlane *kms_plane;
   MetaWaylandDmaBufTranche *tranche;
+  gboolean changed = FALSE;
   GList *el;
   int i;
   g_autoptr (GArray) formats = NULL;
   MetaWaylandDmaBufTranchePriority priority;
   MetaWaylandDmaBufTrancheFlags flags;
 
-  g_return_if_fail (META_IS_CRTC_KMS (crtc));
-
-  crtc_kms = META_CRTC_KMS (crtc);
-  kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
-
-  g_return_if_fail (META_IS_KMS_PLANE (kms_plane));
+  g_return_val_if_fail (META_IS_KMS_PLANE (kms_plane), FALSE);
 
   el = g_list_find_custom (feedback->tranches, NULL, find_scanout_tranche_func);
   if (el)
     {
       tranche = el->data;
 
-      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc))
-        return;
+      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc) &&
+          tranche->scanout_plane_id == meta_kms_plane_get_id (kms_plane))
+        return FALSE;
 
       meta_wayland_dma_buf_tranche_free (tranche);
       feedback->tranches = g_list_delete_link (feedback->tranches, el);
+      changed = TRUE;
     }
 
   formats = g_array_new (FALSE, FALSE, sizeof (MetaWaylandDmaBufFormat));
@@ -1375,16 +1457,16 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                            MetaWaylandDmaBufFormat,
                            i);
 
-          if (!crtc_supports_modifier (crtc_kms,
-                                       format.drm_format,
-                                       format.drm_modifier))
+          if (!plane_supports_modifier (kms_plane,
+                                        format.drm_format,
+                                        format.drm_modifier))
             continue;
 
           g_array_append_val (formats, format);
         }
 
       if (formats->len == 0)
-        return;
+        return changed;
     }
   else
     {
@@ -1405,7 +1487,7 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
         }
 
       if (formats->len == 0)
-        return;
+        return changed;
     }
 
   priority = META_WAYLAND_DMA_BUF_TRANCHE_PRIORITY_HIGH;
@@ -1415,10 +1497,13 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                                               priority,
                                               flags);
   tranche->scanout_crtc_id = meta_crtc_get_id (crtc);
+  tranche->scanout_plane_id = meta_kms_plane_get_id (kms_plane);
   meta_wayland_dma_buf_feedback_add_tranche (feedback, tranche);
+
+  return TRUE;
 }
 
-static void
+static gboolean
 clear_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
 {
   MetaWaylandDmaBufFeedback *feedback = surface_feedback->feedback;
@@ -1427,36 +1512,60 @@ clear_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
 
   el = g_list_find_custom (feedback->tranches, NULL, find_scanout_tranche_func);
   if (!el)
-    return;
+    return FALSE;
 
   tranche = el->data;
   meta_wayland_dma_buf_tranche_free (tranche);
   feedback->tranches = g_list_delete_link (feedback->tranches, el);
+
+  return TRUE;
 }
 #endif /* HAVE_NATIVE_BACKEND */
 
-static void
+static gboolean
 update_surface_feedback_tranches (MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
 {
 #ifdef HAVE_NATIVE_BACKEND
+  MetaWaylandSurface *surface = surface_feedback->surface;
+  MetaKmsPlane *kms_plane = NULL;
   MetaCrtc *crtc;
 
-  crtc = meta_wayland_surface_get_scanout_candidate (surface_feedback->surface);
-  if (crtc)
-    ensure_scanout_tranche (surface_feedback, crtc);
+  /* Direct scanout on the primary plane takes precedence; otherwise, tune
+   * for the overlay plane the surface may be placed on. */
+  crtc = meta_wayland_surface_get_scanout_candidate (surface);
+  if (META_IS_CRTC_KMS (crtc))
+    {
+      kms_plane =
+        meta_crtc_kms_get_assigned_primary_plane (META_CRTC_KMS (crtc));
+    }
   else
-    clear_scanout_tranche (surface_feedback);
+    {
+      crtc = meta_wayland_surface_get_overlay_candidate (surface);
+      if (META_IS_CRTC_KMS (crtc))
+        {
+          kms_plane =
+            meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc));
+        }
+    }
+
+  if (kms_plane)
+    return ensure_scanout_tranche (surface_feedback, crtc, kms_plane);
+  else
+    return clear_scanout_tranche (surface_feedback);
+#else
+  return FALSE;
 #endif /* HAVE_NATIVE_BACKEND */
 }
 
 static void
-on_scanout_candidate_changed (MetaWaylandSurface               *surface,
-                              GParamSpec                       *pspec,
-                              MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
+maybe_update_surface_feedback (MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
 {
   GList *l;
 
-  update_surface_feedback_tranches (surface_feedback);
+  if (!update_surface_feedback_tranches (surface_feedback))
+    return;
+
+  surface_feedback->last_update_time_us = g_get_monotonic_time ();
 
   for (l = surface_feedback->resources; l; l = l->next)
     {
@@ -1468,6 +1577,48 @@ on_scanout_candidate_changed (MetaWaylandSurface               *surface,
     }
 }
 
+static gboolean
+update_surface_feedback_timeout (gpointer user_data)
+{
+  MetaWaylandDmaBufSurfaceFeedback *surface_feedback = user_data;
+
+  surface_feedback->update_timeout_id = 0;
+  maybe_update_surface_feedback (surface_feedback);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_scanout_candidate_changed (MetaWaylandSurface               *surface,
+                              GParamSpec                       *pspec,
+                              MetaWaylandDmaBufSurfaceFeedback *surface_feedback)
+{
+  int64_t now_us;
+  int64_t next_update_time_us;
+
+  if (surface_feedback->update_timeout_id)
+    return;
+
+  /* Each feedback update may make the client reallocate its buffers, so
+   * candidates flipping back and forth are coalesced into a single update
+   * per interval. */
+  now_us = g_get_monotonic_time ();
+  next_update_time_us = (surface_feedback->last_update_time_us +
+                         SURFACE_FEEDBACK_MIN_UPDATE_INTERVAL_US);
+  if (now_us >= next_update_time_us)
+    {
+      maybe_update_surface_feedback (surface_feedback);
+      return;
+    }
+
+  surface_feedback->update_timeout_id =
+    g_timeout_add ((guint) ((next_update_time_us - now_us) / 1000) + 1,
+                   update_surface_feedback_timeout,
+                   surface_feedback);
+  g_source_set_name_by_id (surface_feedback->update_timeout_id,
+                           "[mutter] update_surface_feedback_timeout");
+}
+
 static void
 surface_feedback_surface_destroyed_cb (gpointer user_data)
 {
@@ -1478,6 +1629,7 @@ surface_feedback_surface_destroyed_cb (gpointer user_data)
                   NULL);
   g_list_free (surface_feedback->resources);
 
+  g_clear_handle_id (&surface_feedback->update_timeout_id, g_source_remove);
   meta_wayland_dma_buf_feedback_free (surface_feedback->feedback);
 
   g_free (surface_feedback);
@@ -1500,10 +1652,16 @@ ensure_surface_feedback (MetaWaylandDmaBufManager *dma_buf_manager,
   surface_feedback->feedback =
     meta_wayland_dma_buf_feedback_copy (dma_buf_manager->default_feedback);
 
+  update_surface_feedback_tranches (surface_feedback);
+
   surface_feedback->scanout_candidate_changed_id =
     g_signal_connect (surface, "notify::scanout-candidate",
                       G_CALLBACK (on_scanout_candidate_changed),
                       surface_feedback);
+  surface_feedback->overlay_candidate_changed_id =
+    g_signal_connect (surface, "notify::overlay-candidate",
+                      G_CALLBACK (on_scanout_candidate_changed),
+                      surface_feedback);
 
   g_object_set_qdata_full (G_OBJECT (surface),
                            quark_dma_buf_surface_feedback,
@@ -1528,6 +1686,8 @@ surface_feedback_destructor (struct wl_resource *resource)
     {
       g_clear_signal_handler (&surface_feedback->scanout_candidate_changed_id,
                               surface_feedback->surface);
+      g_clear_signal_handler (&surface_feedback->overlay_candidate_changed_id,
+                              surface_feedback->surface);
       g_object_set_qdata (G_OBJECT (surface_feedback->surface),
                           quark_dma_buf_surface_feedback, NULL);
     }
@@ -1993,3 +2153,34 @@ static void
 meta_wayland_dma_buf_manager_init (MetaWaylandDmaBufManager *dma_buf)
 {
 }
+
+dev_t
+meta_wayland_dma_buf_manager_get_main_device_id (MetaWaylandDmaBufManager *dma_buf_manager)
+{
+  return dma_buf_manager->main_device_id;
+}
+
+/*
+ * Returns: (transfer full): the modifiers supported for importing
+ *   buffers of the given format, as an array of uint64_t
+ */
+GArray *
+meta_wayland_dma_buf_manager_get_modifiers (MetaWaylandDmaBufManager *dma_buf_manager,
+                                            uint32_t                  drm_format)
+{
+  GArray *modifiers;
+  int i;
+
+  modifiers = g_array_new (FALSE, FALSE, sizeof (uint64_t));
+
+  for (i = 0; i < dma_buf_manager->formats->len; i++)
+    {
+      MetaWaylandDmaBufFormat *format =
+        &g_array_index (dma_buf_manager->formats, MetaWaylandDmaBufFormat, i);
+
+      if (format->drm_format == drm_format)
+        g_array_append_val (modifiers, format->drm_modifier);
+    }
+
+  return modifiers;
+}
@@ -26,6 +26,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <sys/types.h>
 
 #include "cogl/cogl.h"
 #include "meta/meta-multi-texture.h"
@@ -55,6 +56,22 @@ meta_wayland_dma_buf_fds_for_wayland_buffer (MetaWaylandBuffer *buffer);
 MetaWaylandDmaBufBuffer *
 meta_wayland_dma_buf_from_buffer (MetaWaylandBuffer *buffer);
 
+void
+meta_wayland_dma_buf_get_format (MetaWaylandDmaBufBuffer *dma_buf,
+                                 int                     *width,
+                                 int                     *height,
+                                 uint32_t                *drm_format);
+
+size_t
+meta_wayland_dma_buf_get_size (MetaWaylandDmaBufBuffer *dma_buf);
+
+dev_t
+meta_wayland_dma_buf_manager_get_main_device_id (MetaWaylandDmaBufManager *dma_buf_manager);
+
+GArray *
+meta_wayland_dma_buf_manager_get_modifiers (MetaWaylandDmaBufManager *dma_buf_manager,
+                                            uint32_t                  drm_format);
+
 typedef void (*MetaWaylandDmaBufSourceDispatch) (MetaWaylandBuffer *buffer,
                                                  gpointer           user_data);
 
@@ -74,4 +91,13 @@ CoglScanout *
 meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                                           CoglOnscreen          *onscreen,
                                           const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect);
+                                          const MtkRectangle    *dst_rect,
+                                          MtkMonitorTransform    transform);
+
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_overlay_scanout (MetaWaylandBuffer     *buffer,
+                                                  CoglOnscreen          *onscreen,
+                                                  const graphene_rect_t *src_rect,
+                                                  const MtkRectangle    *dst_rect,
+                                                  MtkMonitorTransform    transform,
+                                                  CoglScanout           *primary_scanout);
@@ -153,8 +153,11 @@ meta_wayland_egl_stream_new (MetaWaylandBuffer *buffer,
   ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
   CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
   EGLDisplay egl_display = cogl_context_get_egl_display (cogl_context);
+  /* Frames are acquired while handling commits on the main thread; never
+   * let the acquire wait for the producer to deliver one. */
   EGLAttrib stream_attribs[] = {
     EGL_WAYLAND_EGLSTREAM_WL, (EGLAttrib) buffer->resource,
+    EGL_CONSUMER_ACQUIRE_TIMEOUT_USEC_KHR, 0,
     EGL_NONE
   };
   EGLStreamKHR egl_stream;
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-fifo.h"
+
+#include <glib.h>
+
+#include "compositor/meta-surface-actor-wayland.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-transaction.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "fifo-v1-server-protocol.h"
+
+/*
+ * Barriers are normally cleared when the stage view the surface is primarily
+ * shown on is updated. Surfaces that aren't shown anywhere, e.g. because they
+ * are fully obscured, are not redrawn, so their barriers are cleared after
+ * this timeout instead. That keeps clients making progress at a reduced
+ * rate, rather than blocking them until they become visible again.
+ */
+#define FIFO_BARRIER_FALLBACK_TIMEOUT_MS 100
+
+static gboolean
+clear_barrier (MetaWaylandSurface *surface)
+{
+  MetaWaylandCompositor *compositor = surface->compositor;
+
+  if (!surface->fifo.barrier_set)
+    return FALSE;
+
+  surface->fifo.barrier_set = FALSE;
+  g_clear_handle_id (&surface->fifo.fallback_timeout_id, g_source_remove);
+  compositor->fifo_barrier_surfaces =
+    g_list_remove (compositor->fifo_barrier_surfaces, surface);
+
+  return TRUE;
+}
+
+static void
+release_barrier (MetaWaylandSurface *surface)
+{
+  if (clear_barrier (surface))
+    meta_wayland_transaction_maybe_apply_for_surface (surface);
+}
+
+static gboolean
+on_fallback_timeout (gpointer user_data)
+{
+  MetaWaylandSurface *surface = user_data;
+
+  surface->fifo.fallback_timeout_id = 0;
+  release_barrier (surface);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+wp_fifo_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  g_clear_signal_handler (&surface->fifo.destroy_handler_id, surface);
+  surface->fifo.resource = NULL;
+
+  /* Nothing can wait on the barrier anymore once the FIFO object is gone */
+  release_barrier (surface);
+}
+
+static void
+on_surface_destroyed (MetaWaylandSurface *surface)
+{
+  clear_barrier (surface);
+  wl_resource_set_user_data (surface->fifo.resource, NULL);
+}
+
+static void
+wp_fifo_set_barrier (struct wl_client   *client,
+                     struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (resource);
+
+  if (!surface)
+    {
+      wl_resource_post_error (resource,
+                              WP_FIFO_V1_ERROR_SURFACE_DESTROYED,
+                              "surface destroyed");
+      return;
+    }
+
+  surface->pending_state->fifo_barrier = TRUE;
+}
+
+static void
+wp_fifo_wait_barrier (struct wl_client   *client,
+                      struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (resource);
+
+  if (!surface)
+    {
+      wl_resource_post_error (resource,
+                              WP_FIFO_V1_ERROR_SURFACE_DESTROYED,
+                              "surface destroyed");
+      return;
+    }
+
+  surface->pending_state->fifo_wait = TRUE;
+}
+
+static void
+wp_fifo_destroy (struct wl_client   *client,
+                 struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct wp_fifo_v1_interface meta_wayland_fifo_interface = {
+  wp_fifo_set_barrier,
+  wp_fifo_wait_barrier,
+  wp_fifo_destroy,
+};
+
+static void
+wp_fifo_manager_destroy (struct wl_client   *client,
+                         struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+wp_fifo_manager_get_fifo (struct wl_client   *client,
+                          struct wl_resource *resource,
+                          uint32_t            fifo_id,
+                          struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
+  struct wl_resource *fifo_resource;
+
+  if (surface->fifo.resource)
+    {
+      wl_resource_post_error (resource,
+                              WP_FIFO_MANAGER_V1_ERROR_ALREADY_EXISTS,
+                              "fifo resource already exists on surface");
+      return;
+    }
+
+  fifo_resource = wl_resource_create (client,
+                                      &wp_fifo_v1_interface,
+                                      wl_resource_get_version (resource),
+                                      fifo_id);
+  wl_resource_set_implementation (fifo_resource,
+                                  &meta_wayland_fifo_interface,
+                                  surface,
+                                  wp_fifo_destructor);
+
+  surface->fifo.resource = fifo_resource;
+  surface->fifo.destroy_handler_id =
+    g_signal_connect (surface,
+                      "destroy",
+                      G_CALLBACK (on_surface_destroyed),
+                      NULL);
+}
+
+static const struct wp_fifo_manager_v1_interface meta_wayland_fifo_manager_interface = {
+  wp_fifo_manager_destroy,
+  wp_fifo_manager_get_fifo,
+};
+
+static void
+wp_fifo_manager_bind (struct wl_client *client,
+                      void             *data,
+                      uint32_t          version,
+                      uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_fifo_manager_v1_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &meta_wayland_fifo_manager_interface,
+                                  data,
+                                  NULL);
+}
+
+void
+meta_wayland_init_fifo (MetaWaylandCompositor *compositor)
+{
+  if (wl_global_create (compositor->wayland_display,
+                        &wp_fifo_manager_v1_interface,
+                        META_WP_FIFO_V1_VERSION,
+                        compositor,
+                        wp_fifo_manager_bind) == NULL)
+    g_error ("Failed to register a global wp_fifo_manager object");
+}
+
+void
+meta_wayland_fifo_set_barrier (MetaWaylandSurface *surface)
+{
+  MetaWaylandCompositor *compositor = surface->compositor;
+  MetaSurfaceActor *actor;
+
+  if (!surface->fifo.resource || surface->fifo.barrier_set)
+    return;
+
+  surface->fifo.barrier_set = TRUE;
+  compositor->fifo_barrier_surfaces =
+    g_list_prepend (compositor->fifo_barrier_surfaces, surface);
+  surface->fifo.fallback_timeout_id =
+    g_timeout_add (FIFO_BARRIER_FALLBACK_TIMEOUT_MS,
+                   on_fallback_timeout,
+                   surface);
+
+  /* A commit setting a barrier doesn't necessarily come with damage, so make
+   * sure the stage is updated to clear the barrier. */
+  actor = meta_wayland_surface_get_actor (surface);
+  if (actor)
+    {
+      ClutterActor *stage = clutter_actor_get_stage (CLUTTER_ACTOR (actor));
+
+      if (stage)
+        clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+    }
+}
+
+gboolean
+meta_wayland_fifo_is_barrier_set (MetaWaylandSurface *surface)
+{
+  return surface->fifo.barrier_set;
+}
+
+void
+meta_wayland_fifo_update_barriers_for_stage_view (MetaWaylandCompositor *compositor,
+                                                  ClutterStageView      *stage_view)
+{
+  GList *l;
+
+  l = compositor->fifo_barrier_surfaces;
+  while (l)
+    {
+      MetaWaylandSurface *surface = l->data;
+      MetaSurfaceActor *actor;
+
+      l = l->next;
+
+      actor = meta_wayland_surface_get_actor (surface);
+      if (!actor)
+        continue;
+
+      if (!meta_surface_actor_wayland_is_view_primary (actor, stage_view))
+        continue;
+
+      release_barrier (surface);
+    }
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "clutter/clutter.h"
+#include "wayland/meta-wayland-types.h"
+
+void meta_wayland_init_fifo (MetaWaylandCompositor *compositor);
+
+void meta_wayland_fifo_set_barrier (MetaWaylandSurface *surface);
+
+gboolean meta_wayland_fifo_is_barrier_set (MetaWaylandSurface *surface);
+
+void meta_wayland_fifo_update_barriers_for_stage_view (MetaWaylandCompositor *compositor,
+                                                       ClutterStageView      *stage_view);
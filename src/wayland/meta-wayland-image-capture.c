@@ -0,0 +1,1415 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Implements ext-image-capture-source-v1 and ext-image-copy-capture-v1 for
+ * outputs. Frames are copied straight into the client provided shm or
+ * dma-buf buffer, limited to what was damaged since the previous capture
+ * and what the client asked to be refreshed. Like the monitor screen cast
+ * source, the copy is a blit from the view framebuffer or the scanout
+ * buffer when possible, and a stage paint of the monitor otherwise.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-image-capture.h"
+
+#include <drm_fourcc.h>
+#include <glib.h>
+#include <string.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-monitor.h"
+#include "backends/meta-output.h"
+#include "backends/meta-stage-private.h"
+#include "clutter/clutter.h"
+#include "core/meta-service-channel.h"
+#include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-client-private.h"
+#include "wayland/meta-wayland-dma-buf.h"
+#include "wayland/meta-wayland-filter-manager.h"
+#include "wayland/meta-wayland-outputs.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "ext-image-capture-source-v1-server-protocol.h"
+#include "ext-image-copy-capture-v1-server-protocol.h"
+
+#define MAX_DAMAGE_BLITS 16
+
+static const uint32_t supported_drm_formats[] = {
+  DRM_FORMAT_ARGB8888,
+  DRM_FORMAT_XRGB8888,
+};
+
+typedef struct _MetaWaylandImageCopyCaptureFrame MetaWaylandImageCopyCaptureFrame;
+
+typedef struct _MetaWaylandImageCaptureSource
+{
+  MetaWaylandOutput *output;
+} MetaWaylandImageCaptureSource;
+
+typedef struct _MetaWaylandImageCopyCaptureSession
+{
+  struct wl_resource *resource;
+  MetaWaylandCompositor *compositor;
+
+  MetaWaylandOutput *output;
+  gboolean paint_cursors;
+  gboolean stopped;
+
+  MtkRectangle layout;
+  float scale;
+  int width;
+  int height;
+
+  GList *watches;
+  gulong monitors_changed_handler_id;
+
+  /* In buffer coordinates, accumulated since the last captured frame. */
+  MtkRegion *damage;
+  gboolean has_captured;
+
+  CoglOffscreen *staging_offscreen;
+
+  MetaWaylandImageCopyCaptureFrame *frame;
+} MetaWaylandImageCopyCaptureSession;
+
+struct _MetaWaylandImageCopyCaptureFrame
+{
+  struct wl_resource *resource;
+  MetaWaylandImageCopyCaptureSession *session;
+
+  struct wl_resource *buffer_resource;
+  struct wl_listener buffer_destroy_listener;
+  MtkRegion *buffer_damage;
+
+  gboolean captured;
+  gboolean finished;
+};
+
+typedef struct _MetaWaylandImageCopyCaptureCursorSession
+{
+  MetaWaylandCompositor *compositor;
+  gboolean has_capture_session;
+} MetaWaylandImageCopyCaptureCursorSession;
+
+static void reattach_watches (MetaWaylandImageCopyCaptureSession *session);
+
+static MetaBackend *
+get_backend (MetaWaylandImageCopyCaptureSession *session)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (session->compositor);
+
+  return meta_context_get_backend (context);
+}
+
+static ClutterStage *
+get_stage (MetaWaylandImageCopyCaptureSession *session)
+{
+  return CLUTTER_STAGE (meta_backend_get_stage (get_backend (session)));
+}
+
+static MetaMonitor *
+get_monitor (MetaWaylandImageCopyCaptureSession *session)
+{
+  if (!session->output)
+    return NULL;
+
+  return meta_wayland_output_get_monitor (session->output);
+}
+
+static gboolean
+is_frame_pending (MetaWaylandImageCopyCaptureFrame *frame)
+{
+  return frame->captured && !frame->finished;
+}
+
+static void
+fail_frame (MetaWaylandImageCopyCaptureFrame                 *frame,
+            enum ext_image_copy_capture_frame_v1_failure_reason reason)
+{
+  ext_image_copy_capture_frame_v1_send_failed (frame->resource, reason);
+  frame->finished = TRUE;
+}
+
+static void
+remove_watches (MetaWaylandImageCopyCaptureSession *session)
+{
+  MetaStage *stage = META_STAGE (get_stage (session));
+  GList *l;
+
+  for (l = session->watches; l; l = l->next)
+    meta_stage_remove_watch (stage, l->data);
+  g_clear_pointer (&session->watches, g_list_free);
+}
+
+static void
+stop_session (MetaWaylandImageCopyCaptureSession *session)
+{
+  if (session->stopped)
+    return;
+
+  session->stopped = TRUE;
+  remove_watches (session);
+
+  if (session->frame && is_frame_pending (session->frame))
+    {
+      fail_frame (session->frame,
+                  EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_STOPPED);
+    }
+
+  ext_image_copy_capture_session_v1_send_stopped (session->resource);
+}
+
+static gboolean
+update_session_layout (MetaWaylandImageCopyCaptureSession *session)
+{
+  MetaBackend *backend = get_backend (session);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+
+  monitor = get_monitor (session);
+  if (!monitor)
+    return FALSE;
+
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  if (!logical_monitor)
+    return FALSE;
+
+  session->layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  if (meta_backend_is_stage_views_scaled (backend))
+    session->scale = meta_logical_monitor_get_scale (logical_monitor);
+  else
+    session->scale = 1.0;
+
+  session->width = (int) roundf (session->layout.width * session->scale);
+  session->height = (int) roundf (session->layout.height * session->scale);
+
+  return TRUE;
+}
+
+static void
+add_full_damage (MetaWaylandImageCopyCaptureSession *session)
+{
+  mtk_region_union_rectangle (session->damage,
+                              &MTK_RECTANGLE_INIT (0, 0,
+                                                   session->width,
+                                                   session->height));
+}
+
+static void
+add_stage_damage (MetaWaylandImageCopyCaptureSession *session,
+                  const MtkRegion                    *stage_region)
+{
+  int n_rects, i;
+
+  n_rects = mtk_region_num_rectangles (stage_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (stage_region, i);
+      if (!mtk_rectangle_intersect (&rect, &session->layout, &rect))
+        continue;
+
+      rect.x -= session->layout.x;
+      rect.y -= session->layout.y;
+      mtk_rectangle_scale_double (&rect, session->scale,
+                                  MTK_ROUNDING_STRATEGY_GROW,
+                                  &rect);
+      mtk_region_union_rectangle (session->damage, &rect);
+    }
+}
+
+static void
+queue_damage_redraw (MetaWaylandImageCopyCaptureSession *session)
+{
+  MtkRectangle extents;
+
+  if (mtk_region_is_empty (session->damage))
+    return;
+
+  extents = mtk_region_get_extents (session->damage);
+  mtk_rectangle_scale_double (&extents, 1.0 / session->scale,
+                              MTK_ROUNDING_STRATEGY_GROW,
+                              &extents);
+  extents.x += session->layout.x;
+  extents.y += session->layout.y;
+
+  clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (get_stage (session)),
+                                        &extents);
+}
+
+static void
+send_buffer_constraints (MetaWaylandImageCopyCaptureSession *session)
+{
+  MetaWaylandDmaBufManager *dma_buf_manager =
+    session->compositor->dma_buf_manager;
+
+  ext_image_copy_capture_session_v1_send_buffer_size (session->resource,
+                                                      session->width,
+                                                      session->height);
+  ext_image_copy_capture_session_v1_send_shm_format (session->resource,
+                                                     WL_SHM_FORMAT_ARGB8888);
+  ext_image_copy_capture_session_v1_send_shm_format (session->resource,
+                                                     WL_SHM_FORMAT_XRGB8888);
+
+  if (dma_buf_manager)
+    {
+      struct wl_array device_buf;
+      dev_t *device_id_ptr;
+      int i;
+
+      wl_array_init (&device_buf);
+      device_id_ptr = wl_array_add (&device_buf, sizeof (*device_id_ptr));
+      *device_id_ptr =
+        meta_wayland_dma_buf_manager_get_main_device_id (dma_buf_manager);
+      ext_image_copy_capture_session_v1_send_dmabuf_device (session->resource,
+                                                            &device_buf);
+      wl_array_release (&device_buf);
+
+      for (i = 0; i < G_N_ELEMENTS (supported_drm_formats); i++)
+        {
+          g_autoptr (GArray) modifiers = NULL;
+          struct wl_array modifiers_buf;
+          void *modifiers_ptr;
+
+          modifiers =
+            meta_wayland_dma_buf_manager_get_modifiers (dma_buf_manager,
+                                                        supported_drm_formats[i]);
+          if (modifiers->len == 0)
+            continue;
+
+          wl_array_init (&modifiers_buf);
+          modifiers_ptr = wl_array_add (&modifiers_buf,
+                                        modifiers->len * sizeof (uint64_t));
+          memcpy (modifiers_ptr, modifiers->data,
+                  modifiers->len * sizeof (uint64_t));
+          ext_image_copy_capture_session_v1_send_dmabuf_format (session->resource,
+                                                                supported_drm_formats[i],
+                                                                &modifiers_buf);
+          wl_array_release (&modifiers_buf);
+        }
+    }
+
+  ext_image_copy_capture_session_v1_send_done (session->resource);
+}
+
+static gboolean
+validate_buffer (MetaWaylandImageCopyCaptureSession *session,
+                 struct wl_resource                 *buffer_resource)
+{
+  struct wl_shm_buffer *shm_buffer;
+  MetaWaylandBuffer *buffer;
+  MetaWaylandDmaBufBuffer *dma_buf;
+  int width, height;
+  uint32_t drm_format;
+  int i;
+
+  shm_buffer = wl_shm_buffer_get (buffer_resource);
+  if (shm_buffer)
+    {
+      uint32_t shm_format = wl_shm_buffer_get_format (shm_buffer);
+
+      if (shm_format != WL_SHM_FORMAT_ARGB8888 &&
+          shm_format != WL_SHM_FORMAT_XRGB8888)
+        return FALSE;
+
+      return (wl_shm_buffer_get_width (shm_buffer) == session->width &&
+              wl_shm_buffer_get_height (shm_buffer) == session->height &&
+              wl_shm_buffer_get_stride (shm_buffer) >= session->width * 4);
+    }
+
+  buffer = meta_wayland_buffer_from_resource (session->compositor,
+                                              buffer_resource);
+  if (!meta_wayland_buffer_is_realized (buffer) &&
+      !meta_wayland_buffer_realize (buffer))
+    return FALSE;
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    return FALSE;
+
+  dma_buf = meta_wayland_dma_buf_from_buffer (buffer);
+  meta_wayland_dma_buf_get_format (dma_buf, &width, &height, &drm_format);
+  if (width != session->width || height != session->height)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (supported_drm_formats); i++)
+    {
+      if (supported_drm_formats[i] == drm_format)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+ensure_staging_offscreen (MetaWaylandImageCopyCaptureSession  *session,
+                          GError                             **error)
+{
+  MetaBackend *backend = get_backend (session);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  if (session->staging_offscreen)
+    {
+      CoglFramebuffer *framebuffer =
+        COGL_FRAMEBUFFER (session->staging_offscreen);
+
+      if (cogl_framebuffer_get_width (framebuffer) == session->width &&
+          cogl_framebuffer_get_height (framebuffer) == session->height)
+        return TRUE;
+
+      g_clear_object (&session->staging_offscreen);
+    }
+
+  texture = cogl_texture_2d_new_with_size (cogl_context,
+                                           session->width,
+                                           session->height);
+  cogl_texture_set_auto_mipmap (texture, FALSE);
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return FALSE;
+
+  session->staging_offscreen = g_steal_pointer (&offscreen);
+  return TRUE;
+}
+
+static CoglOffscreen *
+create_dma_buf_offscreen (MetaWaylandImageCopyCaptureSession  *session,
+                          struct wl_resource                  *buffer_resource,
+                          GError                             **error)
+{
+  MetaWaylandBuffer *buffer;
+  g_autoptr (MetaMultiTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+
+  buffer = meta_wayland_buffer_from_resource (session->compositor,
+                                              buffer_resource);
+  if (!meta_wayland_dma_buf_buffer_attach (buffer, &texture, error))
+    return NULL;
+
+  if (!meta_multi_texture_is_simple (texture))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Multi-plane capture buffers are not supported");
+      return NULL;
+    }
+
+  offscreen =
+    cogl_offscreen_new_with_texture (meta_multi_texture_get_plane (texture, 0));
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  return g_steal_pointer (&offscreen);
+}
+
+static gboolean
+get_single_view_offset (MetaWaylandImageCopyCaptureSession *session,
+                        ClutterStageView                   *view,
+                        int                                *out_x,
+                        int                                *out_y)
+{
+  MetaBackend *backend = get_backend (session);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaRendererView *renderer_view;
+  MtkRectangle view_layout;
+  MetaCrtc *crtc;
+  GList *outputs;
+
+  outputs = meta_monitor_get_outputs (get_monitor (session));
+  if (outputs->next)
+    return FALSE;
+
+  crtc = meta_output_get_assigned_crtc (outputs->data);
+  renderer_view = meta_renderer_get_view_for_crtc (renderer, crtc);
+  if (CLUTTER_STAGE_VIEW (renderer_view) != view)
+    return FALSE;
+
+  clutter_stage_view_get_layout (view, &view_layout);
+
+  *out_x = (int) roundf ((view_layout.x - session->layout.x) * session->scale);
+  *out_y = (int) roundf ((view_layout.y - session->layout.y) * session->scale);
+
+  return TRUE;
+}
+
+static gboolean
+blit_damage (CoglFramebuffer  *view_framebuffer,
+             CoglFramebuffer  *framebuffer,
+             int               x,
+             int               y,
+             const MtkRegion  *damage,
+             GError          **error)
+{
+  MtkRectangle view_rect;
+  int n_rects, i;
+
+  view_rect = (MtkRectangle) {
+    .x = x,
+    .y = y,
+    .width = cogl_framebuffer_get_width (view_framebuffer),
+    .height = cogl_framebuffer_get_height (view_framebuffer),
+  };
+
+  /* Avoid issuing lots of tiny blits for fragmented damage. */
+  n_rects = mtk_region_num_rectangles (damage);
+  if (n_rects > MAX_DAMAGE_BLITS)
+    {
+      MtkRectangle extents = mtk_region_get_extents (damage);
+
+      if (!mtk_rectangle_intersect (&extents, &view_rect, &extents))
+        return TRUE;
+
+      return cogl_blit_framebuffer (view_framebuffer,
+                                    framebuffer,
+                                    extents.x - x, extents.y - y,
+                                    extents.x, extents.y,
+                                    extents.width, extents.height,
+                                    error);
+    }
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (damage, i);
+
+      if (!mtk_rectangle_intersect (&rect, &view_rect, &rect))
+        continue;
+
+      if (!cogl_blit_framebuffer (view_framebuffer,
+                                  framebuffer,
+                                  rect.x - x, rect.y - y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
+                                  error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+record_to_framebuffer (MetaWaylandImageCopyCaptureSession *session,
+                       ClutterStageView                   *view,
+                       gboolean                            is_scanout,
+                       CoglFramebuffer                    *framebuffer,
+                       const MtkRegion                    *region)
+{
+  ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
+  int x, y;
+
+  /* Cursors are drawn outside of both the actor paint and the scanout
+   * buffer, so including them always means painting the stage. */
+  if (view &&
+      !session->paint_cursors &&
+      get_single_view_offset (session, view, &x, &y))
+    {
+      g_autoptr (GError) error = NULL;
+      gboolean blitted;
+
+      if (is_scanout)
+        {
+          blitted =
+            cogl_scanout_blit_to_framebuffer (clutter_stage_view_peek_scanout (view),
+                                              framebuffer,
+                                              x, y,
+                                              &error);
+        }
+      else
+        {
+          blitted = blit_damage (clutter_stage_view_get_framebuffer (view),
+                                 framebuffer,
+                                 x, y,
+                                 region,
+                                 &error);
+        }
+
+      if (blitted)
+        {
+          cogl_framebuffer_flush (framebuffer);
+          return;
+        }
+
+      g_warning ("Error blitting to image copy capture buffer: %s",
+                 error->message);
+    }
+
+  if (session->paint_cursors)
+    paint_flags |= CLUTTER_PAINT_FLAG_FORCE_CURSORS;
+  else
+    paint_flags |= CLUTTER_PAINT_FLAG_NO_CURSORS;
+
+  clutter_stage_paint_to_framebuffer (get_stage (session),
+                                      framebuffer,
+                                      &session->layout,
+                                      session->scale,
+                                      paint_flags);
+  cogl_framebuffer_flush (framebuffer);
+}
+
+static CoglPixelFormat
+pixel_format_from_shm_format (uint32_t shm_format)
+{
+  switch (shm_format)
+    {
+    case WL_SHM_FORMAT_ARGB8888:
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+      return COGL_PIXEL_FORMAT_BGRA_8888_PRE;
+#else
+      return COGL_PIXEL_FORMAT_ARGB_8888_PRE;
+#endif
+    case WL_SHM_FORMAT_XRGB8888:
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+      return COGL_PIXEL_FORMAT_BGRX_8888;
+#else
+      return COGL_PIXEL_FORMAT_XRGB_8888;
+#endif
+    }
+
+  g_assert_not_reached ();
+}
+
+static gboolean
+read_into_shm_buffer (MetaWaylandImageCopyCaptureSession  *session,
+                      CoglFramebuffer                     *framebuffer,
+                      struct wl_shm_buffer                *shm_buffer,
+                      const MtkRegion                     *region,
+                      GError                             **error)
+{
+  MetaBackend *backend = get_backend (session);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  CoglPixelFormat format;
+  gboolean use_extents;
+  uint8_t *data;
+  int stride;
+  int n_rects, i;
+  gboolean ret = TRUE;
+
+  format = pixel_format_from_shm_format (wl_shm_buffer_get_format (shm_buffer));
+  stride = wl_shm_buffer_get_stride (shm_buffer);
+
+  n_rects = mtk_region_num_rectangles (region);
+  use_extents = n_rects > MAX_DAMAGE_BLITS;
+  if (use_extents)
+    n_rects = 1;
+
+  wl_shm_buffer_begin_access (shm_buffer);
+  data = wl_shm_buffer_get_data (shm_buffer);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      g_autoptr (CoglBitmap) bitmap = NULL;
+      MtkRectangle rect;
+
+      if (use_extents)
+        rect = mtk_region_get_extents (region);
+      else
+        rect = mtk_region_get_rectangle (region, i);
+
+      bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                         rect.width, rect.height,
+                                         format,
+                                         stride,
+                                         data + rect.y * stride + rect.x * 4);
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect.x, rect.y,
+                                                     COGL_READ_PIXELS_COLOR_BUFFER,
+                                                     bitmap))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Failed to read back captured pixels");
+          ret = FALSE;
+          break;
+        }
+    }
+
+  wl_shm_buffer_end_access (shm_buffer);
+
+  return ret;
+}
+
+static void
+send_frame_ready (MetaWaylandImageCopyCaptureSession *session,
+                  MetaWaylandImageCopyCaptureFrame   *frame,
+                  int64_t                             presentation_time_us)
+{
+  uint64_t time_s;
+  int n_rects, i;
+
+  ext_image_copy_capture_frame_v1_send_transform (frame->resource,
+                                                  WL_OUTPUT_TRANSFORM_NORMAL);
+
+  n_rects = mtk_region_num_rectangles (session->damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (session->damage, i);
+
+      ext_image_copy_capture_frame_v1_send_damage (frame->resource,
+                                                   rect.x, rect.y,
+                                                   rect.width, rect.height);
+    }
+
+  time_s = us2s (presentation_time_us);
+  ext_image_copy_capture_frame_v1_send_presentation_time (frame->resource,
+                                                          time_s >> 32,
+                                                          (uint32_t) time_s,
+                                                          (uint32_t) us2ns (presentation_time_us -
+                                                                            s2us (time_s)));
+  ext_image_copy_capture_frame_v1_send_ready (frame->resource);
+  frame->finished = TRUE;
+
+  g_clear_pointer (&session->damage, mtk_region_unref);
+  session->damage = mtk_region_create ();
+  session->has_captured = TRUE;
+}
+
+static gboolean
+copy_frame (MetaWaylandImageCopyCaptureSession  *session,
+            MetaWaylandImageCopyCaptureFrame    *frame,
+            ClutterStageView                    *view,
+            gboolean                             is_scanout,
+            GError                             **error)
+{
+  g_autoptr (MtkRegion) region = NULL;
+  g_autoptr (CoglOffscreen) dma_buf_offscreen = NULL;
+  struct wl_shm_buffer *shm_buffer;
+  CoglFramebuffer *framebuffer;
+
+  region = mtk_region_copy (session->damage);
+  mtk_region_union (region, frame->buffer_damage);
+  mtk_region_intersect_rectangle (region,
+                                  &MTK_RECTANGLE_INIT (0, 0,
+                                                       session->width,
+                                                       session->height));
+
+  shm_buffer = wl_shm_buffer_get (frame->buffer_resource);
+  if (shm_buffer)
+    {
+      if (!ensure_staging_offscreen (session, error))
+        return FALSE;
+
+      framebuffer = COGL_FRAMEBUFFER (session->staging_offscreen);
+    }
+  else
+    {
+      dma_buf_offscreen = create_dma_buf_offscreen (session,
+                                                    frame->buffer_resource,
+                                                    error);
+      if (!dma_buf_offscreen)
+        return FALSE;
+
+      framebuffer = COGL_FRAMEBUFFER (dma_buf_offscreen);
+    }
+
+  record_to_framebuffer (session, view, is_scanout, framebuffer, region);
+
+  if (shm_buffer &&
+      !read_into_shm_buffer (session, framebuffer, shm_buffer, region, error))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+maybe_capture_frame (MetaWaylandImageCopyCaptureSession *session,
+                     ClutterStageView                   *view,
+                     gboolean                            is_scanout,
+                     ClutterFrame                       *clutter_frame)
+{
+  MetaWaylandImageCopyCaptureFrame *frame = session->frame;
+  g_autoptr (GError) error = NULL;
+  int64_t presentation_time_us;
+
+  if (!frame || !is_frame_pending (frame))
+    return;
+
+  if (session->has_captured && mtk_region_is_empty (session->damage))
+    return;
+
+  /* The buffer may have been destroyed after the capture request. */
+  if (!frame->buffer_resource)
+    {
+      fail_frame (frame,
+                  EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_UNKNOWN);
+      return;
+    }
+
+  if (!copy_frame (session, frame, view, is_scanout, &error))
+    {
+      g_warning ("Failed to copy image capture frame: %s", error->message);
+      fail_frame (frame,
+                  EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_UNKNOWN);
+      return;
+    }
+
+  if (!clutter_frame_get_target_presentation_time (clutter_frame,
+                                                   &presentation_time_us))
+    presentation_time_us = g_get_monotonic_time ();
+
+  send_frame_ready (session, frame, presentation_time_us);
+}
+
+static void
+before_stage_painted (MetaStage        *stage,
+                      ClutterStageView *view,
+                      const MtkRegion  *redraw_clip,
+                      ClutterFrame     *frame,
+                      gpointer          user_data)
+{
+  MetaWaylandImageCopyCaptureSession *session = user_data;
+  g_autoptr (MtkRegion) view_region = NULL;
+  MtkRectangle view_layout;
+
+  /* Direct scanout frames skip the stage paint, so this is the only chance
+   * to see their content. */
+  if (!clutter_stage_view_peek_scanout (view))
+    return;
+
+  clutter_stage_view_get_layout (view, &view_layout);
+  view_region = mtk_region_create_rectangle (&view_layout);
+  add_stage_damage (session, view_region);
+
+  maybe_capture_frame (session, view, TRUE, frame);
+}
+
+static void
+stage_painted (MetaStage        *stage,
+               ClutterStageView *view,
+               const MtkRegion  *redraw_clip,
+               ClutterFrame     *frame,
+               gpointer          user_data)
+{
+  MetaWaylandImageCopyCaptureSession *session = user_data;
+
+  if (redraw_clip)
+    add_stage_damage (session, redraw_clip);
+  else
+    add_full_damage (session);
+
+  maybe_capture_frame (session, view, FALSE, frame);
+}
+
+static void
+add_view_watches (MetaWaylandImageCopyCaptureSession *session,
+                  MetaStageWatchPhase                 watch_phase,
+                  MetaStageWatchFunc                  callback)
+{
+  MetaBackend *backend = get_backend (session);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaStage *stage = META_STAGE (get_stage (session));
+  GList *l;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaRendererView *view = l->data;
+      MtkRectangle view_layout;
+
+      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+      if (mtk_rectangle_overlap (&session->layout, &view_layout))
+        {
+          MetaStageWatch *watch;
+
+          watch = meta_stage_watch_view (stage,
+                                         CLUTTER_STAGE_VIEW (view),
+                                         watch_phase,
+                                         callback,
+                                         session);
+
+          session->watches = g_list_prepend (session->watches, watch);
+        }
+    }
+}
+
+static void
+reattach_watches (MetaWaylandImageCopyCaptureSession *session)
+{
+  remove_watches (session);
+
+  add_view_watches (session,
+                    META_STAGE_WATCH_BEFORE_PAINT,
+                    before_stage_painted);
+
+  if (session->paint_cursors)
+    {
+      add_view_watches (session,
+                        META_STAGE_WATCH_AFTER_PAINT,
+                        stage_painted);
+    }
+  else
+    {
+      add_view_watches (session,
+                        META_STAGE_WATCH_AFTER_ACTOR_PAINT,
+                        stage_painted);
+    }
+}
+
+static void
+on_monitors_changed (MetaMonitorManager                 *monitor_manager,
+                     MetaWaylandImageCopyCaptureSession *session)
+{
+  int old_width = session->width;
+  int old_height = session->height;
+
+  if (session->stopped)
+    return;
+
+  if (!update_session_layout (session))
+    {
+      stop_session (session);
+      return;
+    }
+
+  if (session->width != old_width || session->height != old_height)
+    {
+      if (session->frame && is_frame_pending (session->frame))
+        {
+          fail_frame (session->frame,
+                      EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_BUFFER_CONSTRAINTS);
+        }
+
+      send_buffer_constraints (session);
+    }
+
+  reattach_watches (session);
+  add_full_damage (session);
+
+  if (session->frame && is_frame_pending (session->frame))
+    queue_damage_redraw (session);
+}
+
+static void
+frame_destructor (struct wl_resource *resource)
+{
+  MetaWaylandImageCopyCaptureFrame *frame = wl_resource_get_user_data (resource);
+
+  if (frame->session)
+    frame->session->frame = NULL;
+
+  if (frame->buffer_resource)
+    wl_list_remove (&frame->buffer_destroy_listener.link);
+
+  g_clear_pointer (&frame->buffer_damage, mtk_region_unref);
+  g_free (frame);
+}
+
+static void
+on_buffer_destroyed (struct wl_listener *listener,
+                     void               *data)
+{
+  MetaWaylandImageCopyCaptureFrame *frame =
+    wl_container_of (listener, frame, buffer_destroy_listener);
+
+  wl_list_remove (&frame->buffer_destroy_listener.link);
+  frame->buffer_resource = NULL;
+}
+
+static void
+frame_destroy (struct wl_client   *client,
+               struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+frame_attach_buffer (struct wl_client   *client,
+                     struct wl_resource *resource,
+                     struct wl_resource *buffer_resource)
+{
+  MetaWaylandImageCopyCaptureFrame *frame = wl_resource_get_user_data (resource);
+
+  if (frame->captured)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_FRAME_V1_ERROR_ALREADY_CAPTURED,
+                              "attach_buffer sent after capture");
+      return;
+    }
+
+  if (frame->buffer_resource)
+    wl_list_remove (&frame->buffer_destroy_listener.link);
+
+  frame->buffer_resource = buffer_resource;
+  frame->buffer_destroy_listener.notify = on_buffer_destroyed;
+  wl_resource_add_destroy_listener (buffer_resource,
+                                    &frame->buffer_destroy_listener);
+}
+
+static void
+frame_damage_buffer (struct wl_client   *client,
+                     struct wl_resource *resource,
+                     int32_t             x,
+                     int32_t             y,
+                     int32_t             width,
+                     int32_t             height)
+{
+  MetaWaylandImageCopyCaptureFrame *frame = wl_resource_get_user_data (resource);
+
+  if (frame->captured)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_FRAME_V1_ERROR_ALREADY_CAPTURED,
+                              "damage_buffer sent after capture");
+      return;
+    }
+
+  if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_FRAME_V1_ERROR_INVALID_BUFFER_DAMAGE,
+                              "invalid buffer damage %d,%d %dx%d",
+                              x, y, width, height);
+      return;
+    }
+
+  mtk_region_union_rectangle (frame->buffer_damage,
+                              &MTK_RECTANGLE_INIT (x, y, width, height));
+}
+
+static void
+frame_capture (struct wl_client   *client,
+               struct wl_resource *resource)
+{
+  MetaWaylandImageCopyCaptureFrame *frame = wl_resource_get_user_data (resource);
+  MetaWaylandImageCopyCaptureSession *session = frame->session;
+
+  if (frame->captured)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_FRAME_V1_ERROR_ALREADY_CAPTURED,
+                              "capture sent twice");
+      return;
+    }
+
+  if (!frame->buffer_resource)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_FRAME_V1_ERROR_NO_BUFFER,
+                              "capture sent without a buffer");
+      return;
+    }
+
+  frame->captured = TRUE;
+
+  if (!session || session->stopped)
+    {
+      fail_frame (frame,
+                  EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_STOPPED);
+      return;
+    }
+
+  if (!validate_buffer (session, frame->buffer_resource))
+    {
+      fail_frame (frame,
+                  EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_BUFFER_CONSTRAINTS);
+      return;
+    }
+
+  /* Without new damage, wait for the next paint touching the monitor. */
+  queue_damage_redraw (session);
+}
+
+static const struct ext_image_copy_capture_frame_v1_interface image_copy_capture_frame_interface = {
+  frame_destroy,
+  frame_attach_buffer,
+  frame_damage_buffer,
+  frame_capture,
+};
+
+static void
+session_destructor (struct wl_resource *resource)
+{
+  MetaWaylandImageCopyCaptureSession *session =
+    wl_resource_get_user_data (resource);
+  MetaBackend *backend = get_backend (session);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+
+  remove_watches (session);
+  g_clear_signal_handler (&session->monitors_changed_handler_id,
+                          monitor_manager);
+
+  if (session->frame)
+    {
+      if (is_frame_pending (session->frame))
+        {
+          fail_frame (session->frame,
+                      EXT_IMAGE_COPY_CAPTURE_FRAME_V1_FAILURE_REASON_STOPPED);
+        }
+      session->frame->session = NULL;
+    }
+
+  g_clear_weak_pointer (&session->output);
+  g_clear_object (&session->staging_offscreen);
+  g_clear_pointer (&session->damage, mtk_region_unref);
+  g_free (session);
+}
+
+static void
+session_create_frame (struct wl_client   *client,
+                      struct wl_resource *resource,
+                      uint32_t            id)
+{
+  MetaWaylandImageCopyCaptureSession *session =
+    wl_resource_get_user_data (resource);
+  MetaWaylandImageCopyCaptureFrame *frame;
+
+  if (session->frame)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_SESSION_V1_ERROR_DUPLICATE_FRAME,
+                              "session already has a frame");
+      return;
+    }
+
+  frame = g_new0 (MetaWaylandImageCopyCaptureFrame, 1);
+  frame->session = session;
+  frame->buffer_damage = mtk_region_create ();
+  frame->resource =
+    wl_resource_create (client,
+                        &ext_image_copy_capture_frame_v1_interface,
+                        wl_resource_get_version (resource),
+                        id);
+  wl_resource_set_implementation (frame->resource,
+                                  &image_copy_capture_frame_interface,
+                                  frame,
+                                  frame_destructor);
+
+  session->frame = frame;
+}
+
+static void
+session_destroy (struct wl_client   *client,
+                 struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct ext_image_copy_capture_session_v1_interface image_copy_capture_session_interface = {
+  session_create_frame,
+  session_destroy,
+};
+
+static void
+create_session (MetaWaylandCompositor *compositor,
+                struct wl_client      *client,
+                int                    version,
+                uint32_t               id,
+                MetaWaylandOutput     *output,
+                gboolean               paint_cursors)
+{
+  MetaWaylandImageCopyCaptureSession *session;
+  MetaBackend *backend;
+  MetaMonitorManager *monitor_manager;
+
+  session = g_new0 (MetaWaylandImageCopyCaptureSession, 1);
+  session->compositor = compositor;
+  session->paint_cursors = paint_cursors;
+  session->damage = mtk_region_create ();
+  g_set_weak_pointer (&session->output, output);
+
+  session->resource =
+    wl_resource_create (client,
+                        &ext_image_copy_capture_session_v1_interface,
+                        version,
+                        id);
+  wl_resource_set_implementation (session->resource,
+                                  &image_copy_capture_session_interface,
+                                  session,
+                                  session_destructor);
+
+  if (!update_session_layout (session))
+    {
+      stop_session (session);
+      return;
+    }
+
+  add_full_damage (session);
+  send_buffer_constraints (session);
+
+  backend = get_backend (session);
+  monitor_manager = meta_backend_get_monitor_manager (backend);
+  session->monitors_changed_handler_id =
+    g_signal_connect (monitor_manager, "monitors-changed",
+                      G_CALLBACK (on_monitors_changed), session);
+
+  reattach_watches (session);
+}
+
+static void
+cursor_session_destructor (struct wl_resource *resource)
+{
+  MetaWaylandImageCopyCaptureCursorSession *cursor_session =
+    wl_resource_get_user_data (resource);
+
+  g_free (cursor_session);
+}
+
+static void
+cursor_session_destroy (struct wl_client   *client,
+                        struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+cursor_session_get_capture_session (struct wl_client   *client,
+                                    struct wl_resource *resource,
+                                    uint32_t            id)
+{
+  MetaWaylandImageCopyCaptureCursorSession *cursor_session =
+    wl_resource_get_user_data (resource);
+
+  if (cursor_session->has_capture_session)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_CURSOR_SESSION_V1_ERROR_DUPLICATE_SESSION,
+                              "capture session already retrieved");
+      return;
+    }
+
+  cursor_session->has_capture_session = TRUE;
+
+  /* Cursor capture is not supported yet, so the session stops right away. */
+  create_session (cursor_session->compositor, client,
+                  wl_resource_get_version (resource), id,
+                  NULL, FALSE);
+}
+
+static const struct ext_image_copy_capture_cursor_session_v1_interface image_copy_capture_cursor_session_interface = {
+  cursor_session_destroy,
+  cursor_session_get_capture_session,
+};
+
+static void
+image_copy_capture_manager_create_session (struct wl_client   *client,
+                                           struct wl_resource *resource,
+                                           uint32_t            id,
+                                           struct wl_resource *source_resource,
+                                           uint32_t            options)
+{
+  MetaWaylandCompositor *compositor = wl_resource_get_user_data (resource);
+  MetaWaylandImageCaptureSource *source =
+    wl_resource_get_user_data (source_resource);
+
+  if (options & ~EXT_IMAGE_COPY_CAPTURE_MANAGER_V1_OPTIONS_PAINT_CURSORS)
+    {
+      wl_resource_post_error (resource,
+                              EXT_IMAGE_COPY_CAPTURE_MANAGER_V1_ERROR_INVALID_OPTION,
+                              "invalid options 0x%x", options);
+      return;
+    }
+
+  create_session (compositor, client,
+                  wl_resource_get_version (resource), id,
+                  source->output,
+                  !!(options & EXT_IMAGE_COPY_CAPTURE_MANAGER_V1_OPTIONS_PAINT_CURSORS));
+}
+
+static void
+image_copy_capture_manager_create_pointer_cursor_session (struct wl_client   *client,
+                                                          struct wl_resource *resource,
+                                                          uint32_t            id,
+                                                          struct wl_resource *source_resource,
+                                                          struct wl_resource *pointer_resource)
+{
+  MetaWaylandCompositor *compositor = wl_resource_get_user_data (resource);
+  MetaWaylandImageCopyCaptureCursorSession *cursor_session;
+  struct wl_resource *cursor_session_resource;
+
+  cursor_session = g_new0 (MetaWaylandImageCopyCaptureCursorSession, 1);
+  cursor_session->compositor = compositor;
+
+  cursor_session_resource =
+    wl_resource_create (client,
+                        &ext_image_copy_capture_cursor_session_v1_interface,
+                        wl_resource_get_version (resource),
+                        id);
+  wl_resource_set_implementation (cursor_session_resource,
+                                  &image_copy_capture_cursor_session_interface,
+                                  cursor_session,
+                                  cursor_session_destructor);
+}
+
+static void
+image_copy_capture_manager_destroy (struct wl_client   *client,
+                                    struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct ext_image_copy_capture_manager_v1_interface image_copy_capture_manager_interface = {
+  image_copy_capture_manager_create_session,
+  image_copy_capture_manager_create_pointer_cursor_session,
+  image_copy_capture_manager_destroy,
+};
+
+static void
+image_copy_capture_manager_bind (struct wl_client *client,
+                                 void             *data,
+                                 uint32_t          version,
+                                 uint32_t          id)
+{
+  MetaWaylandCompositor *compositor = data;
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &ext_image_copy_capture_manager_v1_interface,
+                                 version, id);
+  wl_resource_set_implementation (resource,
+                                  &image_copy_capture_manager_interface,
+                                  compositor, NULL);
+}
+
+static void
+image_capture_source_destructor (struct wl_resource *resource)
+{
+  MetaWaylandImageCaptureSource *source = wl_resource_get_user_data (resource);
+
+  g_clear_weak_pointer (&source->output);
+  g_free (source);
+}
+
+static void
+image_capture_source_destroy (struct wl_client   *client,
+                              struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct ext_image_capture_source_v1_interface image_capture_source_interface = {
+  image_capture_source_destroy,
+};
+
+static void
+output_source_manager_create_source (struct wl_client   *client,
+                                     struct wl_resource *resource,
+                                     uint32_t            id,
+                                     struct wl_resource *output_resource)
+{
+  MetaWaylandImageCaptureSource *source;
+  struct wl_resource *source_resource;
+
+  source = g_new0 (MetaWaylandImageCaptureSource, 1);
+  g_set_weak_pointer (&source->output,
+                      wl_resource_get_user_data (output_resource));
+
+  source_resource = wl_resource_create (client,
+                                        &ext_image_capture_source_v1_interface,
+                                        wl_resource_get_version (resource),
+                                        id);
+  wl_resource_set_implementation (source_resource,
+                                  &image_capture_source_interface,
+                                  source,
+                                  image_capture_source_destructor);
+}
+
+static void
+output_source_manager_destroy (struct wl_client   *client,
+                               struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct ext_output_image_capture_source_manager_v1_interface output_source_manager_interface = {
+  output_source_manager_create_source,
+  output_source_manager_destroy,
+};
+
+static void
+output_source_manager_bind (struct wl_client *client,
+                            void             *data,
+                            uint32_t          version,
+                            uint32_t          id)
+{
+  MetaWaylandCompositor *compositor = data;
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &ext_output_image_capture_source_manager_v1_interface,
+                                 version, id);
+  wl_resource_set_implementation (resource,
+                                  &output_source_manager_interface,
+                                  compositor, NULL);
+}
+
+static MetaWaylandAccess
+image_capture_filter (const struct wl_client *client,
+                      const struct wl_global *global,
+                      gpointer                user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaContext *context = meta_wayland_compositor_get_context (compositor);
+  MetaServiceChannel *service_channel =
+    meta_context_get_service_channel (context);
+  MetaWaylandClient *service_client;
+
+  service_client =
+    meta_service_channel_get_service_client (service_channel,
+                                             META_SERVICE_CLIENT_TYPE_PORTAL_BACKEND);
+
+  if (service_client && meta_wayland_client_matches (service_client, client))
+    return META_WAYLAND_ACCESS_ALLOWED;
+
+  return META_WAYLAND_ACCESS_DENIED;
+}
+
+void
+meta_wayland_init_image_capture (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandFilterManager *filter_manager =
+    meta_wayland_compositor_get_filter_manager (compositor);
+  struct wl_display *wayland_display =
+    meta_wayland_compositor_get_wayland_display (compositor);
+  struct wl_global *global;
+
+  global = wl_global_create (wayland_display,
+                             &ext_output_image_capture_source_manager_v1_interface,
+                             META_EXT_OUTPUT_IMAGE_CAPTURE_SOURCE_MANAGER_V1_VERSION,
+                             compositor, output_source_manager_bind);
+  if (!global)
+    g_error ("Failed to register a global ext-output-image-capture-source object");
+
+  meta_wayland_filter_manager_add_global (filter_manager,
+                                          global,
+                                          image_capture_filter,
+                                          compositor);
+
+  global = wl_global_create (wayland_display,
+                             &ext_image_copy_capture_manager_v1_interface,
+                             META_EXT_IMAGE_COPY_CAPTURE_MANAGER_V1_VERSION,
+                             compositor, image_copy_capture_manager_bind);
+  if (!global)
+    g_error ("Failed to register a global ext-image-copy-capture object");
+
+  meta_wayland_filter_manager_add_global (filter_manager,
+                                          global,
+                                          image_capture_filter,
+                                          compositor);
+}
@@ -85,6 +85,8 @@ struct _MetaWaylandKeyboard
   xkb_mod_mask_t kbd_a11y_locked_mods;
 
   GSettings *settings;
+
+  guint keymap_flush_id;
 };
 
 G_DEFINE_TYPE (MetaWaylandKeyboard, meta_wayland_keyboard,
@@ -151,13 +153,57 @@ inform_clients_of_new_keymap (MetaWaylandKeyboard *keyboard)
     send_keymap (keyboard, keyboard_resource);
 }
 
+static void
+flush_pending_keymap (MetaWaylandKeyboard *keyboard)
+{
+  if (!keyboard->keymap_flush_id)
+    return;
+
+  g_clear_handle_id (&keyboard->keymap_flush_id, g_source_remove);
+
+  if (keyboard->xkb_info.keymap_rofile)
+    inform_clients_of_new_keymap (keyboard);
+
+  notify_modifiers (keyboard);
+}
+
+static gboolean
+flush_pending_keymap_idle (gpointer user_data)
+{
+  MetaWaylandKeyboard *keyboard = user_data;
+
+  flush_pending_keymap (keyboard);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Keymap changes tend to come in bursts, e.g. when the layouts are
+ * reconfigured, and each one means a keymap event to every client
+ * with a keyboard, so they are only sent out once things settled, or
+ * before anything else is sent to the keyboard resources.
+ */
+static void
+queue_keymap_flush (MetaWaylandKeyboard *keyboard)
+{
+  if (keyboard->keymap_flush_id)
+    return;
+
+  keyboard->keymap_flush_id = g_idle_add_full (G_PRIORITY_HIGH,
+                                               flush_pending_keymap_idle,
+                                               keyboard, NULL);
+  g_source_set_name_by_id (keyboard->keymap_flush_id,
+                           "[mutter] Wayland keymap flush");
+}
+
 static void
 meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
 				   struct xkb_keymap   *keymap)
 {
+  MetaBackend *backend = backend_from_keyboard (keyboard);
+  MetaKeymapCache *keymap_cache = meta_backend_get_keymap_cache (backend);
   MetaWaylandXkbInfo *xkb_info = &keyboard->xkb_info;
-  char *keymap_string;
-  size_t keymap_size;
+  MetaAnonymousFile *keymap_rofile;
 
   if (keymap == NULL)
     {
@@ -165,33 +211,23 @@ meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
       return;
     }
 
-  xkb_keymap_unref (xkb_info->keymap);
-  xkb_info->keymap = xkb_keymap_ref (keymap);
-
-  meta_wayland_keyboard_update_xkb_state (keyboard);
+  keymap_rofile = meta_keymap_cache_get_file (keymap_cache, keymap);
+  if (!keymap_rofile)
+    g_warning ("Failed to create anonymous file for keymap");
 
-  keymap_string =
-    xkb_keymap_get_as_string (xkb_info->keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
-  if (!keymap_string)
-    {
-      g_warning ("Failed to get string version of keymap");
-      return;
-    }
-  keymap_size = strlen (keymap_string) + 1;
+  /* The cache hands out the same file for the same keymap, so clients
+   * only need to be told about actual changes.
+   */
+  if (keymap_rofile != xkb_info->keymap_rofile)
+    queue_keymap_flush (keyboard);
 
   g_clear_pointer (&xkb_info->keymap_rofile, meta_anonymous_file_free);
-  xkb_info->keymap_rofile =
-    meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
+  xkb_info->keymap_rofile = keymap_rofile;
 
-  free (keymap_string);
-
-  if (!xkb_info->keymap_rofile)
-    {
-      g_warning ("Failed to create anonymous file for keymap");
-      return;
-    }
+  xkb_keymap_unref (xkb_info->keymap);
+  xkb_info->keymap = xkb_keymap_ref (keymap);
 
-  inform_clients_of_new_keymap (keyboard);
+  meta_wayland_keyboard_update_xkb_state (keyboard);
 
   notify_modifiers (keyboard);
 }
@@ -272,6 +308,8 @@ meta_wayland_keyboard_broadcast_key (MetaWaylandKeyboard *keyboard,
 {
   struct wl_resource *resource;
 
+  flush_pending_keymap (keyboard);
+
   if (!wl_list_empty (&keyboard->focus_resource_list))
     {
       MetaWaylandInputDevice *input_device =
@@ -315,10 +353,12 @@ notify_key (MetaWaylandKeyboard *keyboard,
   gboolean is_press = clutter_event_type (event) == CLUTTER_KEY_PRESS;
   guint32 code = 0;
 
-  /* Ignore autorepeat events, as autorepeat in Wayland is done on the client
-   * side. */
+  /* Don't forward autorepeat events, as autorepeat in Wayland is done on the
+   * client side. Still eat them when a surface is focused, like the presses
+   * they repeat, so they aren't queued on the stage and don't wake up the
+   * frame clock at the repeat rate. */
   if (clutter_event_get_flags (event) & CLUTTER_EVENT_FLAG_REPEATED)
-    return FALSE;
+    return keyboard->focus_surface != NULL;
 
   code = clutter_event_get_event_code (event);
 
@@ -395,6 +435,10 @@ meta_wayland_keyboard_broadcast_modifiers (MetaWaylandKeyboard *keyboard)
 {
   struct wl_resource *resource;
 
+  /* The modifiers are sent along with the pending keymap */
+  if (keyboard->keymap_flush_id)
+    return;
+
   if (!wl_list_empty (&keyboard->focus_resource_list))
     {
       MetaWaylandInputDevice *input_device =
@@ -590,6 +634,8 @@ meta_wayland_keyboard_disable (MetaWaylandKeyboard *keyboard)
   g_signal_handlers_disconnect_by_func (backend, on_keymap_changed, keyboard);
   g_signal_handlers_disconnect_by_func (backend, on_keymap_layout_group_changed, keyboard);
 
+  g_clear_handle_id (&keyboard->keymap_flush_id, g_source_remove);
+
   meta_wayland_keyboard_set_focus (keyboard, NULL);
 
   wl_list_remove (&keyboard->resource_list);
@@ -782,6 +828,8 @@ meta_wayland_keyboard_set_focus (MetaWaylandKeyboard *keyboard,
   if (keyboard->focus_surface == surface)
     return;
 
+  flush_pending_keymap (keyboard);
+
   if (keyboard->focus_surface != NULL)
     {
       if (!wl_list_empty (&keyboard->focus_resource_list))
@@ -862,7 +910,10 @@ meta_wayland_keyboard_create_new_resource (MetaWaylandKeyboard *keyboard,
   wl_resource_set_implementation (resource, &keyboard_interface,
                                   keyboard, unbind_resource);
 
-  send_keymap (keyboard, resource);
+  flush_pending_keymap (keyboard);
+
+  if (keyboard->xkb_info.keymap_rofile)
+    send_keymap (keyboard, resource);
 
   notify_key_repeat_for_resource (keyboard, resource);
 
@@ -927,6 +978,7 @@ meta_wayland_keyboard_finalize (GObject *object)
 {
   MetaWaylandKeyboard *keyboard = META_WAYLAND_KEYBOARD (object);
 
+  g_clear_handle_id (&keyboard->keymap_flush_id, g_source_remove);
   meta_wayland_xkb_info_destroy (&keyboard->xkb_info);
 
   G_OBJECT_CLASS (meta_wayland_keyboard_parent_class)->finalize (object);
@@ -32,6 +32,9 @@ typedef struct _MetaWaylandPresentationFeedback
   struct wl_resource *resource;
 
   MetaWaylandSurface *surface;
+
+  /* Whether the surface was the direct scanout candidate of the frame */
+  gboolean is_scanout;
 } MetaWaylandPresentationFeedback;
 
 typedef struct _MetaWaylandPresentationTime
@@ -54,7 +57,8 @@ void meta_wayland_presentation_feedback_discard (MetaWaylandPresentationFeedback
 
 void meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *feedback,
                                                  ClutterFrameInfo                *frame_info,
-                                                 MetaWaylandOutput               *output);
+                                                 MetaWaylandOutput               *output,
+                                                 gboolean                         is_variable_refresh);
 
 struct wl_list * meta_wayland_presentation_time_ensure_feedbacks (MetaWaylandPresentationTime *presentation_time,
                                                                   ClutterStageView            *stage_view);
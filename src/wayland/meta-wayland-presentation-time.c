@@ -22,6 +22,7 @@
 
 #include <glib.h>
 
+#include "backends/meta-renderer-view.h"
 #include "compositor/meta-surface-actor-wayland.h"
 #include "wayland/meta-wayland-cursor-surface.h"
 #include "wayland/meta-wayland-presentation-time-private.h"
@@ -132,6 +133,7 @@ on_after_paint (ClutterStage          *stage,
                 MetaWaylandCompositor *compositor)
 {
   struct wl_list *feedbacks;
+  MetaCrtc *crtc;
   GList *l;
 
   /*
@@ -149,6 +151,8 @@ on_after_paint (ClutterStage          *stage,
                                                      stage_view);
   discard_non_cursor_feedbacks (feedbacks);
 
+  crtc = meta_renderer_view_get_crtc (META_RENDERER_VIEW (stage_view));
+
   l = compositor->presentation_time.feedback_surfaces;
   while (l)
     {
@@ -168,6 +172,18 @@ on_after_paint (ClutterStage          *stage,
 
       if (!wl_list_empty (&surface->presentation_time.feedback_list))
         {
+          MetaWaylandPresentationFeedback *feedback;
+          gboolean is_scanout;
+
+          /* Only the surface picked for direct scanout can have been
+           * presented zero-copy; everything else on the view was composited
+           * or is hidden underneath it. */
+          is_scanout = meta_wayland_surface_get_scanout_candidate (surface) == crtc;
+          wl_list_for_each (feedback,
+                            &surface->presentation_time.feedback_list,
+                            link)
+            feedback->is_scanout = is_scanout;
+
           /* Add feedbacks to the list to be fired on presentation. */
           wl_list_insert_list (feedbacks,
                                &surface->presentation_time.feedback_list);
@@ -313,7 +329,8 @@ invalid_sequence:
 void
 meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *feedback,
                                             ClutterFrameInfo                *frame_info,
-                                            MetaWaylandOutput               *output)
+                                            MetaWaylandOutput               *output,
+                                            gboolean                         is_variable_refresh)
 {
   MetaWaylandSurface *surface = feedback->surface;
   int64_t time_us = frame_info->presentation_time;
@@ -337,19 +354,32 @@ meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *fee
   tv_sec_lo = time_s;
   tv_nsec = (uint32_t) us2ns (time_us - s2us (time_s));
 
-  refresh_interval_ns = (uint32_t) (0.5 + s2ns (1) / frame_info->refresh_rate);
+  /*
+   * With a variable refresh rate there is no fixed interval until the next
+   * refresh. Version 1 requires reporting 0 then, while version 2 lets us
+   * report the fastest rate, i.e. the one of the current mode.
+   */
+  if (is_variable_refresh &&
+      wl_resource_get_version (feedback->resource) < 2)
+    refresh_interval_ns = 0;
+  else
+    refresh_interval_ns = (uint32_t) (0.5 + s2ns (1) / frame_info->refresh_rate);
 
   maybe_update_presentation_sequence (surface, frame_info, output);
 
   seq_hi = surface->presentation_time.sequence >> 32;
   seq_lo = surface->presentation_time.sequence;
 
-  flags = WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION;
+  flags = 0;
+
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_COMPLETION)
+    flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION;
 
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_CLOCK)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK;
 
-  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY)
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY &&
+      feedback->is_scanout)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
 
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_VSYNC)
@@ -60,6 +60,10 @@ struct _MetaXWaylandManager
   guint abstract_fd_watch_id;
   guint unix_fd_watch_id;
 
+  gulong prewarm_presented_id;
+  guint prewarm_idle_id;
+  gboolean prewarmed;
+
   gulong prepare_shutdown_id;
 
   struct wl_display *wayland_display;
@@ -92,8 +96,15 @@ struct _MetaWaylandCompositor
   GSource *source;
   struct wl_listener client_created_listener;
 
+  struct {
+    struct wl_protocol_logger *protocol_logger;
+    MetaWaylandClientStats *current;
+    int64_t request_start_us;
+  } client_stats;
+
   GHashTable *outputs;
   GList *frame_callback_surfaces;
+  GList *fifo_barrier_surfaces;
 
 #ifdef HAVE_XWAYLAND
   MetaXWaylandManager xwayland_manager;
@@ -109,6 +120,7 @@ struct _MetaWaylandCompositor
 
   MetaWaylandPresentationTime presentation_time;
   MetaWaylandDmaBufManager *dma_buf_manager;
+  MetaWaylandShmUploader *shm_uploader;
 
   /*
    * Queue of transactions which have been committed but not applied yet, in the
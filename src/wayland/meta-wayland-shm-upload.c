@@ -0,0 +1,523 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Streams shm buffer damage into textures through a small pool of pixel
+ * buffers. Each upload copies the damaged rows into a pixel buffer that is
+ * mapped with the discard hint, so the driver can hand out fresh storage
+ * instead of stalling on a buffer still being read by the GPU, and the
+ * actual transfer into the texture then happens asynchronously from the
+ * pixel buffer rather than synchronously from client memory.
+ *
+ * Uploads can also be staged ahead of time: the pixel buffer is mapped on
+ * the main thread when the buffer is committed, and the damaged rows are
+ * copied into it from a worker thread. Only the final unmap and texture
+ * update, which need the GL context, are left for when the damage is
+ * actually processed.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-shm-upload.h"
+
+#include <string.h>
+
+#define MAX_IDLE_BUFFERS 4
+
+/* Below this, the pixel buffer round trip costs more than it saves */
+#define MIN_UPLOAD_SIZE (256 * 1024)
+#define MAX_UPLOAD_SIZE (64 * 1024 * 1024)
+
+/* Granularity of pixel buffer allocations, to avoid reallocating for every
+ * slightly larger damage region */
+#define UPLOAD_BUFFER_ALIGNMENT (1024 * 1024)
+
+struct _MetaWaylandShmUploader
+{
+  grefcount ref_count;
+
+  CoglContext *cogl_context;
+
+  GQueue idle_buffers;
+};
+
+struct _MetaWaylandShmUpload
+{
+  grefcount ref_count;
+
+  MetaWaylandShmUploader *uploader;
+
+  CoglPixelFormat format;
+  int bpp;
+  MtkRegion *region;
+  MtkRectangle *rects;
+  int n_rects;
+
+  CoglPixelBuffer *pixel_buffer;
+  uint8_t *mapped;
+
+  /* Only valid until the copy has finished */
+  struct wl_shm_buffer *shm_buffer;
+  struct wl_shm_pool *shm_pool;
+  const uint8_t *data;
+  size_t stride;
+
+  GMutex mutex;
+  GCond cond;
+  gboolean copied;
+
+  gboolean done;
+  GSource *ready_source;
+};
+
+MetaWaylandShmUploader *
+meta_wayland_shm_uploader_new (CoglContext *cogl_context)
+{
+  MetaWaylandShmUploader *uploader;
+
+  if (!cogl_context_has_feature (cogl_context,
+                                 COGL_FEATURE_ID_PIXEL_BUFFER_UPLOAD))
+    return NULL;
+
+  uploader = g_new0 (MetaWaylandShmUploader, 1);
+  g_ref_count_init (&uploader->ref_count);
+  uploader->cogl_context = g_object_ref (cogl_context);
+  g_queue_init (&uploader->idle_buffers);
+
+  return uploader;
+}
+
+static MetaWaylandShmUploader *
+meta_wayland_shm_uploader_ref (MetaWaylandShmUploader *uploader)
+{
+  g_ref_count_inc (&uploader->ref_count);
+  return uploader;
+}
+
+void
+meta_wayland_shm_uploader_unref (MetaWaylandShmUploader *uploader)
+{
+  if (!g_ref_count_dec (&uploader->ref_count))
+    return;
+
+  g_queue_clear_full (&uploader->idle_buffers, g_object_unref);
+  g_clear_object (&uploader->cogl_context);
+  g_free (uploader);
+}
+
+static int
+get_upload_rowstride (int width,
+                      int bpp)
+{
+  /* Keep rows 4 byte aligned so GLES can upload without repacking */
+  return (width * bpp + 3) & ~3;
+}
+
+static size_t
+calculate_upload_size (int                 bpp,
+                       const MtkRectangle *rects,
+                       int                 n_rects)
+{
+  size_t size = 0;
+  int i;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      size += (size_t) get_upload_rowstride (rects[i].width, bpp) *
+              rects[i].height;
+    }
+
+  return size;
+}
+
+static gboolean
+is_upload_size_suitable (size_t size)
+{
+  return size >= MIN_UPLOAD_SIZE && size <= MAX_UPLOAD_SIZE;
+}
+
+gboolean
+meta_wayland_shm_uploader_can_upload (MetaWaylandShmUploader *uploader,
+                                      CoglTexture            *texture,
+                                      int                     bpp,
+                                      const MtkRectangle     *rects,
+                                      int                     n_rects)
+{
+  /* Sliced textures would have the driver read back from the pixel buffer
+   * when splitting the upload up. */
+  if (!COGL_IS_TEXTURE_2D (texture))
+    return FALSE;
+
+  return is_upload_size_suitable (calculate_upload_size (bpp, rects, n_rects));
+}
+
+static CoglPixelBuffer *
+acquire_upload_buffer (MetaWaylandShmUploader *uploader,
+                       size_t                  size)
+{
+  CoglPixelBuffer *pixel_buffer;
+  size_t buffer_size;
+
+  pixel_buffer = g_queue_pop_head (&uploader->idle_buffers);
+  if (pixel_buffer &&
+      cogl_buffer_get_size (COGL_BUFFER (pixel_buffer)) >= size)
+    return pixel_buffer;
+
+  g_clear_object (&pixel_buffer);
+
+  buffer_size = ((size + UPLOAD_BUFFER_ALIGNMENT - 1) /
+                 UPLOAD_BUFFER_ALIGNMENT) * UPLOAD_BUFFER_ALIGNMENT;
+  pixel_buffer = cogl_pixel_buffer_new (uploader->cogl_context,
+                                        buffer_size, NULL);
+  cogl_buffer_set_update_hint (COGL_BUFFER (pixel_buffer),
+                               COGL_BUFFER_UPDATE_HINT_STREAM);
+
+  return pixel_buffer;
+}
+
+static void
+release_upload_buffer (MetaWaylandShmUploader *uploader,
+                       CoglPixelBuffer        *pixel_buffer)
+{
+  if (g_queue_get_length (&uploader->idle_buffers) < MAX_IDLE_BUFFERS)
+    g_queue_push_tail (&uploader->idle_buffers, pixel_buffer);
+  else
+    g_object_unref (pixel_buffer);
+}
+
+static void
+copy_rects (uint8_t            *dst,
+            const uint8_t      *data,
+            size_t              stride,
+            int                 bpp,
+            const MtkRectangle *rects,
+            int                 n_rects)
+{
+  int i;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const MtkRectangle *rect = &rects[i];
+      int rowstride = get_upload_rowstride (rect->width, bpp);
+      const uint8_t *src;
+      int y;
+
+      src = data + rect->x * bpp + rect->y * stride;
+
+      for (y = 0; y < rect->height; y++)
+        {
+          memcpy (dst, src, rect->width * bpp);
+          src += stride;
+          dst += rowstride;
+        }
+    }
+}
+
+static gboolean
+upload_rects (CoglPixelBuffer     *pixel_buffer,
+              CoglTexture         *texture,
+              CoglPixelFormat      format,
+              int                  bpp,
+              const MtkRectangle  *rects,
+              int                  n_rects,
+              GError             **error)
+{
+  size_t offset = 0;
+  int i;
+
+  for (i = 0; i < n_rects; i++)
+    {
+      const MtkRectangle *rect = &rects[i];
+      int rowstride = get_upload_rowstride (rect->width, bpp);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (pixel_buffer),
+                                            format,
+                                            rect->width,
+                                            rect->height,
+                                            rowstride,
+                                            offset);
+      if (!cogl_texture_set_region_from_bitmap (texture,
+                                                0, 0,
+                                                rect->x, rect->y,
+                                                rect->width, rect->height,
+                                                bitmap))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Failed to upload from pixel buffer");
+          return FALSE;
+        }
+
+      offset += (size_t) rowstride * rect->height;
+    }
+
+  return TRUE;
+}
+
+gboolean
+meta_wayland_shm_uploader_upload (MetaWaylandShmUploader  *uploader,
+                                  CoglTexture             *texture,
+                                  CoglPixelFormat          format,
+                                  int                      bpp,
+                                  const uint8_t           *data,
+                                  size_t                   stride,
+                                  const MtkRectangle      *rects,
+                                  int                      n_rects,
+                                  GError                 **error)
+{
+  CoglPixelBuffer *pixel_buffer;
+  size_t size;
+  uint8_t *mapped;
+  gboolean ret;
+
+  size = calculate_upload_size (bpp, rects, n_rects);
+  pixel_buffer = acquire_upload_buffer (uploader, size);
+
+  mapped = cogl_buffer_map_range (COGL_BUFFER (pixel_buffer), 0, size,
+                                  COGL_BUFFER_ACCESS_WRITE,
+                                  COGL_BUFFER_MAP_HINT_DISCARD,
+                                  error);
+  if (!mapped)
+    {
+      g_object_unref (pixel_buffer);
+      return FALSE;
+    }
+
+  copy_rects (mapped, data, stride, bpp, rects, n_rects);
+  cogl_buffer_unmap (COGL_BUFFER (pixel_buffer));
+
+  ret = upload_rects (pixel_buffer, texture, format, bpp,
+                      rects, n_rects, error);
+  release_upload_buffer (uploader, pixel_buffer);
+
+  return ret;
+}
+
+static void
+meta_wayland_shm_upload_free (MetaWaylandShmUpload *upload)
+{
+  if (upload->pixel_buffer)
+    {
+      if (upload->mapped)
+        cogl_buffer_unmap (COGL_BUFFER (upload->pixel_buffer));
+      release_upload_buffer (upload->uploader,
+                             g_steal_pointer (&upload->pixel_buffer));
+    }
+
+  g_clear_pointer (&upload->shm_pool, wl_shm_pool_unref);
+  g_clear_pointer (&upload->rects, g_free);
+  g_clear_pointer (&upload->region, mtk_region_unref);
+  g_mutex_clear (&upload->mutex);
+  g_cond_clear (&upload->cond);
+  meta_wayland_shm_uploader_unref (upload->uploader);
+  g_free (upload);
+}
+
+MetaWaylandShmUpload *
+meta_wayland_shm_upload_ref (MetaWaylandShmUpload *upload)
+{
+  g_ref_count_inc (&upload->ref_count);
+  return upload;
+}
+
+void
+meta_wayland_shm_upload_unref (MetaWaylandShmUpload *upload)
+{
+  if (g_ref_count_dec (&upload->ref_count))
+    meta_wayland_shm_upload_free (upload);
+}
+
+static void
+copy_in_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  MetaWaylandShmUpload *upload = task_data;
+
+  wl_shm_buffer_begin_access (upload->shm_buffer);
+  copy_rects (upload->mapped,
+              upload->data, upload->stride, upload->bpp,
+              upload->rects, upload->n_rects);
+  wl_shm_buffer_end_access (upload->shm_buffer);
+
+  g_mutex_lock (&upload->mutex);
+  upload->copied = TRUE;
+  g_cond_broadcast (&upload->cond);
+  g_mutex_unlock (&upload->mutex);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+on_copy_finished (GObject      *source_object,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  MetaWaylandShmUpload *upload = user_data;
+
+  upload->done = TRUE;
+  upload->shm_buffer = NULL;
+  upload->data = NULL;
+  g_clear_pointer (&upload->shm_pool, wl_shm_pool_unref);
+
+  if (upload->ready_source)
+    g_source_set_ready_time (upload->ready_source, 0);
+
+  meta_wayland_shm_upload_unref (upload);
+}
+
+MetaWaylandShmUpload *
+meta_wayland_shm_uploader_stage (MetaWaylandShmUploader *uploader,
+                                 struct wl_shm_buffer   *shm_buffer,
+                                 CoglPixelFormat         format,
+                                 MtkRegion              *region)
+{
+  MetaWaylandShmUpload *upload;
+  g_autoptr (GTask) task = NULL;
+  size_t size;
+  int bpp;
+  int i;
+
+  if (cogl_pixel_format_get_n_planes (format) != 1)
+    return NULL;
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  upload = g_new0 (MetaWaylandShmUpload, 1);
+  g_ref_count_init (&upload->ref_count);
+  upload->uploader = meta_wayland_shm_uploader_ref (uploader);
+  upload->format = format;
+  upload->bpp = bpp;
+  upload->region = mtk_region_ref (region);
+  g_mutex_init (&upload->mutex);
+  g_cond_init (&upload->cond);
+
+  upload->n_rects = mtk_region_num_rectangles (region);
+  upload->rects = g_new (MtkRectangle, upload->n_rects);
+  for (i = 0; i < upload->n_rects; i++)
+    upload->rects[i] = mtk_region_get_rectangle (region, i);
+
+  size = calculate_upload_size (bpp, upload->rects, upload->n_rects);
+  if (!is_upload_size_suitable (size))
+    {
+      meta_wayland_shm_upload_free (upload);
+      return NULL;
+    }
+
+  upload->pixel_buffer = acquire_upload_buffer (uploader, size);
+  upload->mapped = cogl_buffer_map_range (COGL_BUFFER (upload->pixel_buffer),
+                                          0, size,
+                                          COGL_BUFFER_ACCESS_WRITE,
+                                          COGL_BUFFER_MAP_HINT_DISCARD,
+                                          NULL);
+  if (!upload->mapped)
+    {
+      meta_wayland_shm_upload_free (upload);
+      return NULL;
+    }
+
+  /* Keep the pool mapping alive even if the client destroys it while the
+   * copy is in progress. */
+  upload->shm_buffer = shm_buffer;
+  upload->shm_pool = wl_shm_buffer_ref_pool (shm_buffer);
+  upload->data = wl_shm_buffer_get_data (shm_buffer);
+  upload->stride = wl_shm_buffer_get_stride (shm_buffer);
+
+  task = g_task_new (NULL, NULL, on_copy_finished,
+                     meta_wayland_shm_upload_ref (upload));
+  g_task_set_task_data (task, upload, NULL);
+  g_task_run_in_thread (task, copy_in_thread);
+
+  return upload;
+}
+
+gboolean
+meta_wayland_shm_upload_is_done (MetaWaylandShmUpload *upload)
+{
+  return upload->done;
+}
+
+void
+meta_wayland_shm_upload_set_ready_source (MetaWaylandShmUpload *upload,
+                                          GSource              *source)
+{
+  upload->ready_source = source;
+
+  if (source && upload->done)
+    g_source_set_ready_time (source, 0);
+}
+
+void
+meta_wayland_shm_upload_wait_for_copy (MetaWaylandShmUpload *upload)
+{
+  g_mutex_lock (&upload->mutex);
+  while (!upload->copied)
+    g_cond_wait (&upload->cond, &upload->mutex);
+  g_mutex_unlock (&upload->mutex);
+
+  upload->shm_buffer = NULL;
+}
+
+gboolean
+meta_wayland_shm_upload_finish (MetaWaylandShmUpload  *upload,
+                                CoglTexture           *texture,
+                                MtkRegion             *region,
+                                GError               **error)
+{
+  g_autoptr (MtkRegion) remainder = NULL;
+
+  if (!upload->done)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_PENDING,
+                   "Staged upload still in progress");
+      return FALSE;
+    }
+
+  if (!upload->mapped)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Staged upload already consumed");
+      return FALSE;
+    }
+
+  cogl_buffer_unmap (COGL_BUFFER (upload->pixel_buffer));
+  upload->mapped = NULL;
+
+  if (!COGL_IS_TEXTURE_2D (texture) ||
+      cogl_texture_get_format (texture) != upload->format)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Texture not compatible with staged upload");
+      return FALSE;
+    }
+
+  remainder = mtk_region_copy (region);
+  mtk_region_subtract (remainder, upload->region);
+  if (!mtk_region_is_empty (remainder))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Damage not covered by staged upload");
+      return FALSE;
+    }
+
+  return upload_rects (upload->pixel_buffer, texture,
+                       upload->format, upload->bpp,
+                       upload->rects, upload->n_rects,
+                       error);
+}
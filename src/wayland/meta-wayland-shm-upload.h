@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <wayland-server.h>
+
+#include "cogl/cogl.h"
+#include "mtk/mtk.h"
+#include "wayland/meta-wayland-types.h"
+
+typedef struct _MetaWaylandShmUpload MetaWaylandShmUpload;
+
+MetaWaylandShmUploader * meta_wayland_shm_uploader_new (CoglContext *cogl_context);
+
+void meta_wayland_shm_uploader_unref (MetaWaylandShmUploader *uploader);
+
+gboolean meta_wayland_shm_uploader_can_upload (MetaWaylandShmUploader *uploader,
+                                               CoglTexture            *texture,
+                                               int                     bpp,
+                                               const MtkRectangle     *rects,
+                                               int                     n_rects);
+
+gboolean meta_wayland_shm_uploader_upload (MetaWaylandShmUploader  *uploader,
+                                           CoglTexture             *texture,
+                                           CoglPixelFormat          format,
+                                           int                      bpp,
+                                           const uint8_t           *data,
+                                           size_t                   stride,
+                                           const MtkRectangle      *rects,
+                                           int                      n_rects,
+                                           GError                 **error);
+
+MetaWaylandShmUpload * meta_wayland_shm_uploader_stage (MetaWaylandShmUploader *uploader,
+                                                        struct wl_shm_buffer   *shm_buffer,
+                                                        CoglPixelFormat         format,
+                                                        MtkRegion              *region);
+
+MetaWaylandShmUpload * meta_wayland_shm_upload_ref (MetaWaylandShmUpload *upload);
+
+void meta_wayland_shm_upload_unref (MetaWaylandShmUpload *upload);
+
+gboolean meta_wayland_shm_upload_is_done (MetaWaylandShmUpload *upload);
+
+void meta_wayland_shm_upload_set_ready_source (MetaWaylandShmUpload *upload,
+                                               GSource              *source);
+
+void meta_wayland_shm_upload_wait_for_copy (MetaWaylandShmUpload *upload);
+
+gboolean meta_wayland_shm_upload_finish (MetaWaylandShmUpload  *upload,
+                                         CoglTexture           *texture,
+                                         MtkRegion             *region,
+                                         GError               **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaWaylandShmUpload, meta_wayland_shm_upload_unref)
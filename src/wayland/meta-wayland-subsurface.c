@@ -64,6 +64,12 @@ should_show (MetaWaylandSurface *surface)
     return TRUE;
 }
 
+static gboolean
+accepts_input (MetaWaylandSurface *surface)
+{
+  return !surface->input_region || !mtk_region_is_empty (surface->input_region);
+}
+
 static void
 sync_actor_subsurface_state (MetaWaylandSurface *surface)
 {
@@ -85,7 +91,11 @@ sync_actor_subsurface_state (MetaWaylandSurface *surface)
   transform_subsurface_position (surface, &x, &y);
 
   clutter_actor_set_position (actor, x, y);
-  clutter_actor_set_reactive (actor, TRUE);
+
+  /* Subsurfaces with an empty input region, e.g. video or decoration layers,
+   * can never be picked, so leave them out of picking altogether.
+   */
+  clutter_actor_set_reactive (actor, accepts_input (surface));
 
   clutter_actor_show (actor);
 
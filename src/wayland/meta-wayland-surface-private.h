@@ -41,6 +41,14 @@ G_DECLARE_FINAL_TYPE (MetaWaylandSurfaceState,
                       META, WAYLAND_SURFACE_STATE,
                       GObject)
 
+typedef enum _MetaWaylandContentType
+{
+  META_WAYLAND_CONTENT_TYPE_NONE,
+  META_WAYLAND_CONTENT_TYPE_PHOTO,
+  META_WAYLAND_CONTENT_TYPE_VIDEO,
+  META_WAYLAND_CONTENT_TYPE_GAME,
+} MetaWaylandContentType;
+
 struct _MetaWaylandSurfaceRoleClass
 {
   GObjectClass parent_class;
@@ -134,10 +142,29 @@ struct _MetaWaylandSurfaceState
   struct {
     MetaWaylandSyncPoint *acquire;
     MetaWaylandSyncPoint *release;
+
+    /* Not yet signaled acquire fence, if left to direct scanout to wait on */
+    int acquire_sync_fd;
   } drm_syncobj;
 
   gboolean has_new_color_state;
   ClutterColorState *color_state;
+
+  /* wp_fifo */
+  gboolean fifo_barrier;
+  gboolean fifo_wait;
+
+  /* wp_commit_timer */
+  gboolean has_target_time;
+  int64_t target_time_us;
+
+  /* wp_tearing_control */
+  gboolean has_tearing_hint;
+  gboolean allow_tearing;
+
+  /* wp_content_type */
+  gboolean has_content_type;
+  MetaWaylandContentType content_type;
 };
 
 struct _MetaWaylandDragDestFuncs
@@ -181,6 +208,12 @@ struct _MetaWaylandSurface
   /* Buffer renderer state. */
   gboolean buffer_held;
 
+  /* Damage of a shm buffer not yet uploaded since the surface is hidden. */
+  struct {
+    MtkRegion *region;
+    MetaWaylandBuffer *buffer;
+  } deferred_damage;
+
   /* Intermediate state for when no role has been assigned. */
   struct {
     struct wl_list pending_frame_callback_list;
@@ -248,6 +281,37 @@ struct _MetaWaylandSurface
     double scale;
   } fractional_scale;
 
+  /* wp_fifo */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    gboolean barrier_set;
+    guint fallback_timeout_id;
+  } fifo;
+
+  /* wp_commit_timer */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+  } commit_timer;
+
+  /* wp_tearing_control */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    gboolean allow_tearing;
+  } tearing_control;
+
+  /* wp_content_type */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    MetaWaylandContentType content_type;
+  } content_type;
+
   /* table of seats for which shortcuts are inhibited */
   GHashTable *shortcut_inhibited_seats;
 
@@ -269,6 +333,10 @@ struct _MetaWaylandSurface
 
   /* dma-buf feedback */
   MetaCrtc *scanout_candidate;
+  MetaCrtc *overlay_candidate;
+
+  /* Acquire fence of the applied buffer that direct scanout must wait on */
+  int scanout_acquire_sync_fd;
 
   /* Transactions */
   struct {
@@ -390,6 +458,8 @@ void                meta_wayland_surface_notify_subsurface_state_changed (MetaWa
 
 void                meta_wayland_surface_notify_unmapped (MetaWaylandSurface *surface);
 
+MetaWaylandContentType meta_wayland_surface_get_content_type (MetaWaylandSurface *surface);
+
 META_EXPORT_TEST
 int                 meta_wayland_surface_get_width (MetaWaylandSurface *surface);
 
@@ -406,11 +476,21 @@ CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface
                                                               CoglOnscreen       *onscreen,
                                                               ClutterStageView   *stage_view);
 
+CoglScanout *       meta_wayland_surface_try_acquire_overlay_scanout (MetaWaylandSurface *surface,
+                                                                      CoglOnscreen       *onscreen,
+                                                                      ClutterStageView   *stage_view,
+                                                                      CoglScanout        *primary_scanout);
+
 MetaCrtc * meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface);
 
 void meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
                                                  MetaCrtc           *crtc);
 
+MetaCrtc * meta_wayland_surface_get_overlay_candidate (MetaWaylandSurface *surface);
+
+void meta_wayland_surface_set_overlay_candidate (MetaWaylandSurface *surface,
+                                                 MetaCrtc           *crtc);
+
 int meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface);
 
 META_EXPORT_TEST
@@ -422,6 +502,8 @@ void meta_wayland_surface_notify_highest_scale_monitor (MetaWaylandSurface *surf
 
 void meta_wayland_surface_notify_actor_changed (MetaWaylandSurface *surface);
 
+void meta_wayland_surface_flush_deferred_damage (MetaWaylandSurface *surface);
+
 void meta_wayland_surface_set_main_monitor (MetaWaylandSurface *surface,
                                             MetaLogicalMonitor *logical_monitor);
 
@@ -22,6 +22,8 @@
 
 #include "wayland/meta-wayland-surface-private.h"
 
+#include <fcntl.h>
+#include <glib/gstdio.h>
 #include <gobject/gvaluecollector.h>
 #include <wayland-server.h>
 
@@ -36,6 +38,10 @@
 #include "core/window-private.h"
 #include "wayland/meta-wayland-actor-surface.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-client-private.h"
+#include "wayland/meta-wayland-commit-timing.h"
+#include "wayland/meta-wayland-content-type.h"
+#include "wayland/meta-wayland-fifo.h"
 #include "wayland/meta-wayland-fractional-scale.h"
 #include "wayland/meta-wayland-gtk-shell.h"
 #include "wayland/meta-wayland-outputs.h"
@@ -44,6 +50,7 @@
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
 #include "wayland/meta-wayland-subsurface.h"
+#include "wayland/meta-wayland-tearing-control.h"
 #include "wayland/meta-wayland-transaction.h"
 #include "wayland/meta-wayland-viewporter.h"
 #include "wayland/meta-wayland-xdg-shell.h"
@@ -80,6 +87,7 @@ enum
   PROP_0,
 
   PROP_SCANOUT_CANDIDATE,
+  PROP_OVERLAY_CANDIDATE,
   PROP_WINDOW,
   PROP_MAIN_MONITOR,
 
@@ -295,6 +303,120 @@ region_transform (const MtkRegion     *region,
   return transformed_region;
 }
 
+static void
+apply_buffer_damage (MetaWaylandSurface *surface,
+                     MetaWaylandBuffer  *buffer,
+                     MtkRegion          *buffer_region)
+{
+  MetaSurfaceActor *actor;
+
+  meta_wayland_buffer_process_damage (buffer, surface->applied_state.texture,
+                                      buffer_region);
+
+  actor = meta_wayland_surface_get_actor (surface);
+  if (actor)
+    {
+      int i, n_rectangles;
+
+      n_rectangles = mtk_region_num_rectangles (buffer_region);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect;
+          rect = mtk_region_get_rectangle (buffer_region, i);
+
+          meta_surface_actor_process_damage (actor, &rect);
+        }
+    }
+}
+
+static void
+clear_deferred_damage (MetaWaylandSurface *surface)
+{
+  g_clear_pointer (&surface->deferred_damage.region, mtk_region_unref);
+
+  if (surface->deferred_damage.buffer)
+    {
+      meta_wayland_buffer_dec_use_count (surface->deferred_damage.buffer);
+      g_clear_object (&surface->deferred_damage.buffer);
+    }
+}
+
+static gboolean
+should_defer_damage (MetaWaylandSurface *surface,
+                     MetaWaylandBuffer  *buffer)
+{
+  MetaSurfaceActor *actor;
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_SHM)
+    return FALSE;
+
+  /* Deferred damage is flushed by the Wayland window actor once the surface
+   * is about to be painted again, so only defer for surfaces part of one. */
+  if (meta_wayland_surface_is_xwayland (surface) ||
+      !meta_wayland_surface_get_toplevel_window (surface))
+    return FALSE;
+
+  actor = meta_wayland_surface_get_actor (surface);
+  if (!actor)
+    return FALSE;
+
+  return meta_surface_actor_is_effectively_hidden (actor);
+}
+
+static void
+hold_deferred_damage_buffer (MetaWaylandSurface *surface,
+                             MetaWaylandBuffer  *buffer)
+{
+  if (surface->deferred_damage.buffer == buffer)
+    return;
+
+  meta_wayland_buffer_inc_use_count (buffer);
+
+  if (surface->deferred_damage.buffer)
+    meta_wayland_buffer_dec_use_count (surface->deferred_damage.buffer);
+  g_set_object (&surface->deferred_damage.buffer, buffer);
+}
+
+/*
+ * Uploading the damage of a shm buffer is not needed while the surface
+ * is hidden, so it is accumulated instead, and the latest buffer is held
+ * until it is. Holding the buffer also keeps the client from redrawing
+ * into it right away, which throttles clients that don't wait for frame
+ * callbacks.
+ */
+static void
+defer_damage (MetaWaylandSurface *surface,
+              MetaWaylandBuffer  *buffer,
+              MtkRegion          *buffer_region)
+{
+  if (surface->deferred_damage.region)
+    mtk_region_union (surface->deferred_damage.region, buffer_region);
+  else
+    surface->deferred_damage.region = mtk_region_copy (buffer_region);
+
+  hold_deferred_damage_buffer (surface, buffer);
+}
+
+void
+meta_wayland_surface_flush_deferred_damage (MetaWaylandSurface *surface)
+{
+  g_autoptr (MtkRegion) region = NULL;
+  MetaWaylandBuffer *buffer = surface->deferred_damage.buffer;
+
+  if (!surface->deferred_damage.region)
+    return;
+
+  region = g_steal_pointer (&surface->deferred_damage.region);
+
+  /* A client destroying its buffer before it was released leaves the
+   * texture as it was, like it would for any other undefined content. */
+  if (buffer == surface->buffer && buffer->resource &&
+      surface->applied_state.texture)
+    apply_buffer_damage (surface, buffer, region);
+
+  clear_deferred_damage (surface);
+}
+
 static void
 surface_process_damage (MetaWaylandSurface *surface,
                         MtkRegion          *surface_region,
@@ -302,7 +424,6 @@ surface_process_damage (MetaWaylandSurface *surface,
 {
   MetaWaylandBuffer *buffer = meta_wayland_surface_get_buffer (surface);
   MtkRectangle buffer_rect;
-  MetaSurfaceActor *actor;
 
   /* If the client destroyed the buffer it attached before committing, but
    * still posted damage, or posted damage without any buffer, don't try to
@@ -383,23 +504,25 @@ surface_process_damage (MetaWaylandSurface *surface,
 
   mtk_region_intersect_rectangle (buffer_region, &buffer_rect);
 
-  meta_wayland_buffer_process_damage (buffer, surface->applied_state.texture,
-                                      buffer_region);
-
-  actor = meta_wayland_surface_get_actor (surface);
-  if (actor)
+  if (surface->resource)
     {
-      int i, n_rectangles;
+      meta_wayland_client_stats_add_damage (wl_resource_get_client (surface->resource),
+                                            buffer_region);
+    }
 
-      n_rectangles = mtk_region_num_rectangles (buffer_region);
-      for (i = 0; i < n_rectangles; i++)
-        {
-          MtkRectangle rect;
-          rect = mtk_region_get_rectangle (buffer_region, i);
+  if (should_defer_damage (surface, buffer))
+    {
+      defer_damage (surface, buffer, buffer_region);
+      return;
+    }
 
-          meta_surface_actor_process_damage (actor, &rect);
-        }
+  if (surface->deferred_damage.region)
+    {
+      mtk_region_union (buffer_region, surface->deferred_damage.region);
+      clear_deferred_damage (surface);
     }
+
+  apply_buffer_damage (surface, buffer, buffer_region);
 }
 
 MetaWaylandBuffer *
@@ -453,9 +576,22 @@ meta_wayland_surface_state_set_default (MetaWaylandSurfaceState *state)
 
   state->drm_syncobj.acquire = NULL;
   state->drm_syncobj.release = NULL;
+  state->drm_syncobj.acquire_sync_fd = -1;
 
   state->has_new_color_state = FALSE;
   state->color_state = NULL;
+
+  state->fifo_barrier = FALSE;
+  state->fifo_wait = FALSE;
+
+  state->has_target_time = FALSE;
+  state->target_time_us = 0;
+
+  state->has_tearing_hint = FALSE;
+  state->allow_tearing = FALSE;
+
+  state->has_content_type = FALSE;
+  state->content_type = META_WAYLAND_CONTENT_TYPE_NONE;
 }
 
 static void
@@ -478,6 +614,7 @@ meta_wayland_surface_state_clear (MetaWaylandSurfaceState *state)
   g_clear_object (&state->texture);
   g_clear_object (&state->drm_syncobj.acquire);
   g_clear_object (&state->drm_syncobj.release);
+  g_clear_fd (&state->drm_syncobj.acquire_sync_fd, NULL);
   g_clear_object (&state->color_state);
 
   g_clear_pointer (&state->surface_damage, mtk_region_unref);
@@ -649,6 +786,9 @@ meta_wayland_surface_state_merge_into (MetaWaylandSurfaceState *from,
   g_clear_object (&from->drm_syncobj.acquire);
   g_set_object (&to->drm_syncobj.release, from->drm_syncobj.release);
   g_clear_object (&from->drm_syncobj.release);
+  g_clear_fd (&to->drm_syncobj.acquire_sync_fd, NULL);
+  to->drm_syncobj.acquire_sync_fd =
+    g_steal_fd (&from->drm_syncobj.acquire_sync_fd);
 
   if (from->has_new_color_state)
     {
@@ -657,6 +797,27 @@ meta_wayland_surface_state_merge_into (MetaWaylandSurfaceState *from,
 
       to->has_new_color_state = TRUE;
     }
+
+  to->fifo_barrier |= from->fifo_barrier;
+  to->fifo_wait |= from->fifo_wait;
+
+  if (from->has_target_time)
+    {
+      to->has_target_time = TRUE;
+      to->target_time_us = from->target_time_us;
+    }
+
+  if (from->has_tearing_hint)
+    {
+      to->has_tearing_hint = TRUE;
+      to->allow_tearing = from->allow_tearing;
+    }
+
+  if (from->has_content_type)
+    {
+      to->has_content_type = TRUE;
+      to->content_type = from->content_type;
+    }
 }
 
 static void
@@ -787,7 +948,20 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
       if (surface->buffer_held)
         meta_wayland_buffer_dec_use_count (surface->buffer);
 
+      /* A new texture is fully uploaded when created, and other buffer types
+       * are not uploaded at all, so deferred damage is of no use anymore.
+       * Otherwise it is now to be uploaded from the new buffer. */
+      if (!state->buffer ||
+          state->buffer->type != META_WAYLAND_BUFFER_TYPE_SHM ||
+          state->texture != surface->applied_state.texture)
+        clear_deferred_damage (surface);
+      else if (surface->deferred_damage.region)
+        hold_deferred_damage_buffer (surface, state->buffer);
+
       g_set_object (&surface->buffer, state->buffer);
+      g_clear_fd (&surface->scanout_acquire_sync_fd, NULL);
+      surface->scanout_acquire_sync_fd =
+        g_steal_fd (&state->drm_syncobj.acquire_sync_fd);
       g_clear_object (&surface->applied_state.texture);
       surface->applied_state.texture = g_steal_pointer (&state->texture);
 
@@ -876,6 +1050,15 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
   if (state->has_new_color_state)
     g_set_object (&surface->color_state, state->color_state);
 
+  if (state->fifo_barrier)
+    meta_wayland_fifo_set_barrier (surface);
+
+  if (state->has_tearing_hint)
+    surface->tearing_control.allow_tearing = state->allow_tearing;
+
+  if (state->has_content_type)
+    surface->content_type.content_type = state->content_type;
+
   /*
    * A new commit indicates a new content update, so any previous
    * content update did not go on screen and needs to be discarded.
@@ -1197,6 +1380,8 @@ wl_surface_frame (struct wl_client   *client,
                                   destroy_frame_callback);
 
   wl_list_insert (pending->frame_callback_list.prev, &callback->link);
+
+  meta_wayland_client_stats_add_frame_callback (client);
 }
 
 static void
@@ -1241,6 +1426,7 @@ wl_surface_commit (struct wl_client   *client,
 {
   MetaWaylandSurface *surface = wl_resource_get_user_data (resource);
 
+  meta_wayland_client_stats_add_commit (client);
   meta_wayland_surface_commit (surface);
 }
 
@@ -1581,6 +1767,7 @@ meta_wayland_surface_dispose (GObject *object)
   MetaWaylandFrameCallback *cb, *next;
 
   g_clear_object (&surface->scanout_candidate);
+  g_clear_object (&surface->overlay_candidate);
   g_clear_object (&surface->role);
 
   if (surface->unassigned.buffer)
@@ -1595,8 +1782,11 @@ meta_wayland_surface_dispose (GObject *object)
       surface->buffer_held = FALSE;
     }
 
+  clear_deferred_damage (surface);
+
   g_clear_object (&surface->applied_state.texture);
   g_clear_object (&surface->buffer);
+  g_clear_fd (&surface->scanout_acquire_sync_fd, NULL);
 
   g_clear_pointer (&surface->opaque_region, mtk_region_unref);
   g_clear_pointer (&surface->input_region, mtk_region_unref);
@@ -1745,6 +1935,10 @@ meta_wayland_shell_init (MetaWaylandCompositor *compositor)
   meta_wayland_init_gtk_shell (compositor);
   meta_wayland_init_viewporter (compositor);
   meta_wayland_init_fractional_scale (compositor);
+  meta_wayland_init_fifo (compositor);
+  meta_wayland_init_commit_timing (compositor);
+  meta_wayland_init_tearing_control (compositor);
+  meta_wayland_init_content_type (compositor);
 }
 
 void
@@ -1901,6 +2095,7 @@ static void
 meta_wayland_surface_init (MetaWaylandSurface *surface)
 {
   surface->pending_state = meta_wayland_surface_state_new ();
+  surface->scanout_acquire_sync_fd = -1;
 
   surface->applied_state.subsurface_branch_node = g_node_new (surface);
   surface->applied_state.subsurface_leaf_node =
@@ -1924,6 +2119,9 @@ meta_wayland_surface_get_property (GObject    *object,
     case PROP_SCANOUT_CANDIDATE:
       g_value_set_object (value, surface->scanout_candidate);
       break;
+    case PROP_OVERLAY_CANDIDATE:
+      g_value_set_object (value, surface->overlay_candidate);
+      break;
     case PROP_WINDOW:
       g_value_set_object (value, meta_wayland_surface_get_window (surface));
       break;
@@ -1971,6 +2169,12 @@ meta_wayland_surface_class_init (MetaWaylandSurfaceClass *klass)
                          G_PARAM_READABLE |
                          G_PARAM_STATIC_STRINGS);
 
+  obj_props[PROP_OVERLAY_CANDIDATE] =
+    g_param_spec_object ("overlay-candidate", NULL, NULL,
+                         META_TYPE_CRTC,
+                         G_PARAM_READABLE |
+                         G_PARAM_STATIC_STRINGS);
+
   obj_props[PROP_WINDOW] =
     g_param_spec_object ("window", NULL, NULL,
                          META_TYPE_WINDOW,
@@ -2331,6 +2535,12 @@ meta_wayland_surface_notify_geometry_changed (MetaWaylandSurface *surface)
   g_signal_emit (surface, surface_signals[SURFACE_GEOMETRY_CHANGED], 0);
 }
 
+MetaWaylandContentType
+meta_wayland_surface_get_content_type (MetaWaylandSurface *surface)
+{
+  return surface->content_type.content_type;
+}
+
 int
 meta_wayland_surface_get_width (MetaWaylandSurface *surface)
 {
@@ -2401,47 +2611,95 @@ meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface)
     return 0;
 }
 
-CoglScanout *
-meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                          CoglOnscreen       *onscreen,
-                                          ClutterStageView   *stage_view)
+/* Translates the viewport source rectangle from surface coordinates to the
+ * buffer coordinates planes sample from. */
+static void
+get_buffer_src_rect (MetaWaylandSurface *surface,
+                     graphene_rect_t    *src_rect)
+{
+  int scale = surface->applied_state.scale;
+  float width = meta_wayland_surface_get_buffer_width (surface);
+  float height = meta_wayland_surface_get_buffer_height (surface);
+  graphene_rect_t rect;
+  float x1, y1, x2, y2;
+
+  graphene_rect_scale (&surface->viewport.src_rect, scale, scale, &rect);
+  x1 = rect.origin.x;
+  y1 = rect.origin.y;
+  x2 = rect.origin.x + rect.size.width;
+  y2 = rect.origin.y + rect.size.height;
+
+  switch (surface->buffer_transform)
+    {
+    case MTK_MONITOR_TRANSFORM_NORMAL:
+      *src_rect = rect;
+      break;
+    case MTK_MONITOR_TRANSFORM_90:
+      *src_rect = GRAPHENE_RECT_INIT (y1, height - x2,
+                                      rect.size.height, rect.size.width);
+      break;
+    case MTK_MONITOR_TRANSFORM_180:
+      *src_rect = GRAPHENE_RECT_INIT (width - x2, height - y2,
+                                      rect.size.width, rect.size.height);
+      break;
+    case MTK_MONITOR_TRANSFORM_270:
+      *src_rect = GRAPHENE_RECT_INIT (width - y2, x1,
+                                      rect.size.height, rect.size.width);
+      break;
+    case MTK_MONITOR_TRANSFORM_FLIPPED:
+      *src_rect = GRAPHENE_RECT_INIT (width - x2, y1,
+                                      rect.size.width, rect.size.height);
+      break;
+    case MTK_MONITOR_TRANSFORM_FLIPPED_90:
+      *src_rect = GRAPHENE_RECT_INIT (y1, x1,
+                                      rect.size.height, rect.size.width);
+      break;
+    case MTK_MONITOR_TRANSFORM_FLIPPED_180:
+      *src_rect = GRAPHENE_RECT_INIT (x1, height - y2,
+                                      rect.size.width, rect.size.height);
+      break;
+    case MTK_MONITOR_TRANSFORM_FLIPPED_270:
+      *src_rect = GRAPHENE_RECT_INIT (width - y2, height - x2,
+                                      rect.size.height, rect.size.width);
+      break;
+    }
+}
+
+static gboolean
+calculate_scanout_rects (MetaWaylandSurface *surface,
+                         ClutterStageView   *stage_view,
+                         graphene_rect_t    *src_rect,
+                         gboolean           *has_src_rect,
+                         MtkRectangle       *dst_rect,
+                         gboolean           *is_implicit_dst_rect)
 {
   MetaSurfaceActor *surface_actor;
   MtkMonitorTransform view_transform;
   ClutterActorBox actor_box;
-  MtkRectangle *dst_rect_ptr = NULL;
-  MtkRectangle dst_rect;
-  graphene_rect_t *src_rect_ptr = NULL;
-  graphene_rect_t src_rect;
   MtkRectangle view_rect;
   float view_scale;
   int untransformed_view_width;
   int untransformed_view_height;
 
   if (!surface->buffer)
-    return NULL;
+    return FALSE;
 
   if (surface->buffer->use_count == 0)
-    return NULL;
+    return FALSE;
 
+  /* Whether a buffer transform not matching the view can be handled by the
+   * plane is left to the backend to figure out. */
   view_transform = clutter_stage_view_get_transform (stage_view);
-  if (view_transform != surface->buffer_transform)
-    {
-      meta_topic (META_DEBUG_RENDER,
-                  "Surface can not be scanned out: buffer transform does not "
-                  "match renderer-view transform");
-      return NULL;
-    }
 
   surface_actor = meta_wayland_surface_get_actor (surface);
   if (!surface_actor ||
       !clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor), &actor_box))
-    return NULL;
+    return FALSE;
 
   clutter_stage_view_get_layout (stage_view, &view_rect);
   view_scale = clutter_stage_view_get_scale (stage_view);
 
-  dst_rect = (MtkRectangle) {
+  *dst_rect = (MtkRectangle) {
     .x = (int) roundf ((actor_box.x1 - view_rect.x) * view_scale),
     .y = (int) roundf ((actor_box.y1 - view_rect.y) * view_scale),
     .width = (int) roundf ((actor_box.x2 - actor_box.x1) * view_scale),
@@ -2459,29 +2717,88 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
       untransformed_view_height = view_rect.height;
     }
 
-  mtk_rectangle_transform (&dst_rect,
+  mtk_rectangle_transform (dst_rect,
                            view_transform,
                            untransformed_view_width,
                            untransformed_view_height,
-                           &dst_rect);
+                           dst_rect);
+
+  *is_implicit_dst_rect = (!surface->viewport.has_dst_size &&
+                           !surface->viewport.has_src_rect &&
+                           dst_rect->x == 0 && dst_rect->y == 0 &&
+                           dst_rect->width == untransformed_view_width &&
+                           dst_rect->height == untransformed_view_height);
+
+  *has_src_rect = surface->viewport.has_src_rect;
+  if (*has_src_rect)
+    get_buffer_src_rect (surface, src_rect);
+
+  return TRUE;
+}
+
+CoglScanout *
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
+                                          CoglOnscreen       *onscreen,
+                                          ClutterStageView   *stage_view)
+{
+  graphene_rect_t src_rect;
+  gboolean has_src_rect;
+  MtkRectangle dst_rect;
+  gboolean is_implicit_dst_rect;
+  CoglScanout *scanout;
+
+  if (!calculate_scanout_rects (surface, stage_view,
+                                &src_rect, &has_src_rect,
+                                &dst_rect, &is_implicit_dst_rect))
+    return NULL;
 
   /* Use an implicit destination rect when possible */
-  if (surface->viewport.has_dst_size ||
-      dst_rect.x != 0 || dst_rect.y != 0 ||
-      dst_rect.width != untransformed_view_width ||
-      dst_rect.height != untransformed_view_height)
-    dst_rect_ptr = &dst_rect;
+  scanout = meta_wayland_buffer_try_acquire_scanout (surface->buffer,
+                                                     onscreen,
+                                                     has_src_rect ? &src_rect : NULL,
+                                                     is_implicit_dst_rect ? NULL : &dst_rect,
+                                                     surface->buffer_transform);
+
+  if (scanout && surface->scanout_acquire_sync_fd >= 0)
+    {
+      cogl_scanout_set_sync_fd (scanout,
+                                fcntl (surface->scanout_acquire_sync_fd,
+                                       F_DUPFD_CLOEXEC, 0));
+    }
 
-  if (surface->viewport.has_src_rect)
+  if (scanout)
     {
-      src_rect = surface->viewport.src_rect;
-      src_rect_ptr = &src_rect;
+      cogl_scanout_set_allow_tearing (scanout,
+                                      surface->tearing_control.allow_tearing);
     }
 
-  return meta_wayland_buffer_try_acquire_scanout (surface->buffer,
-                                                  onscreen,
-                                                  src_rect_ptr,
-                                                  dst_rect_ptr);
+  return scanout;
+}
+
+CoglScanout *
+meta_wayland_surface_try_acquire_overlay_scanout (MetaWaylandSurface *surface,
+                                                  CoglOnscreen       *onscreen,
+                                                  ClutterStageView   *stage_view,
+                                                  CoglScanout        *primary_scanout)
+{
+  graphene_rect_t src_rect;
+  gboolean has_src_rect;
+  MtkRectangle dst_rect;
+  gboolean is_implicit_dst_rect;
+
+  if (!calculate_scanout_rects (surface, stage_view,
+                                &src_rect, &has_src_rect,
+                                &dst_rect, &is_implicit_dst_rect))
+    return NULL;
+
+  /* An overlay plane is positioned explicitly, even when it happens to cover
+   * the whole view. */
+  return meta_wayland_buffer_try_acquire_overlay_scanout (surface->buffer,
+                                                          onscreen,
+                                                          has_src_rect ? &src_rect : NULL,
+                                                          &dst_rect,
+                                                          surface->buffer_transform,
+                                                          primary_scanout);
 }
 
 MetaCrtc *
@@ -2502,6 +2819,24 @@ meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
                             obj_props[PROP_SCANOUT_CANDIDATE]);
 }
 
+MetaCrtc *
+meta_wayland_surface_get_overlay_candidate (MetaWaylandSurface *surface)
+{
+  return surface->overlay_candidate;
+}
+
+void
+meta_wayland_surface_set_overlay_candidate (MetaWaylandSurface *surface,
+                                            MetaCrtc           *crtc)
+{
+  if (surface->overlay_candidate == crtc)
+    return;
+
+  g_set_object (&surface->overlay_candidate, crtc);
+  g_object_notify_by_pspec (G_OBJECT (surface),
+                            obj_props[PROP_OVERLAY_CANDIDATE]);
+}
+
 int
 meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface)
 {
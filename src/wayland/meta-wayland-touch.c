@@ -316,6 +316,8 @@ handle_touch_update (MetaWaylandTouch   *touch,
 {
   MetaWaylandTouchInfo *touch_info;
   ClutterEventSequence *sequence;
+  const ClutterTouchHistoryEntry *history;
+  size_t n_entries, i;
   struct wl_resource *resource;
   struct wl_list *l;
 
@@ -326,6 +328,29 @@ handle_touch_update (MetaWaylandTouch   *touch,
     return;
 
   l = &touch_info->touch_surface->resource_list;
+
+  /* Coalesced updates still carry every sample; send all but the last,
+   * which is the position of the event itself. */
+  history = clutter_event_get_touch_history (event, &n_entries);
+  for (i = 0; history && i + 1 < n_entries; i++)
+    {
+      float x, y;
+
+      meta_wayland_surface_get_relative_coordinates (touch_info->touch_surface->surface,
+                                                     history[i].x,
+                                                     history[i].y,
+                                                     &x, &y);
+
+      wl_resource_for_each (resource, l)
+        {
+          wl_touch_send_motion (resource,
+                                (uint32_t) (history[i].time_us / 1000),
+                                touch_info->slot,
+                                wl_fixed_from_double (x),
+                                wl_fixed_from_double (y));
+        }
+    }
+
   wl_resource_for_each(resource, l)
     {
       wl_touch_send_motion (resource,
@@ -22,10 +22,14 @@
 #include "wayland/meta-wayland-transaction.h"
 
 #include <glib-unix.h>
+#include <glib/gstdio.h>
 
+#include "backends/meta-backend-private.h"
+#include "clutter/clutter.h"
 #include "wayland/meta-wayland.h"
 #include "wayland/meta-wayland-buffer.h"
 #include "wayland/meta-wayland-dma-buf.h"
+#include "wayland/meta-wayland-fifo.h"
 #include "wayland/meta-wayland-linux-drm-syncobj.h"
 
 #define META_WAYLAND_TRANSACTION_NONE ((void *)(uintptr_t) G_MAXSIZE)
@@ -37,6 +41,14 @@ struct _MetaWaylandTransaction
   MetaWaylandTransaction *next_candidate;
   uint64_t committed_sequence;
 
+  /*
+   * Number of surfaces for which an earlier committed transaction has not
+   * been applied yet. Transactions only depend on the transactions committed
+   * before them for the same surfaces, so ones for unrelated surfaces don't
+   * wait for each other.
+   */
+  unsigned int n_blocking_surfaces;
+
   /*
    * Keys:   All surfaces referenced in the transaction
    * Values: Pointer to MetaWaylandTransactionEntry for the surface
@@ -45,6 +57,14 @@ struct _MetaWaylandTransaction
 
   /* Sources for buffers which are not ready yet */
   GHashTable *buf_sources;
+
+  /* Whether any entry waits for a FIFO barrier to be cleared */
+  gboolean has_fifo_waits;
+
+  /* Held until a frame presented close to this time is being prepared */
+  gboolean has_target_time;
+  gboolean target_time_released;
+  int64_t target_time_us;
 };
 
 struct _MetaWaylandTransactionEntry
@@ -205,7 +225,12 @@ meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
 
       states[i] = entry->state;
       if (entry->state)
-        meta_wayland_surface_apply_state (surface, entry->state);
+        {
+          meta_wayland_surface_apply_state (surface, entry->state);
+          COGL_PERF_COUNTER_ADD (WaylandCommitsApplied,
+                                 "WaylandCommitsApplied",
+                                 "Wayland surface commits applied", 1);
+        }
 
       if (surface->transaction.last_committed == transaction)
         {
@@ -219,7 +244,12 @@ meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
           if (next_transaction)
             {
               surface->transaction.first_committed = next_transaction;
-              ensure_next_candidate (next_transaction, first_candidate);
+
+              g_assert (next_transaction->n_blocking_surfaces > 0);
+              next_transaction->n_blocking_surfaces--;
+
+              if (next_transaction->n_blocking_surfaces == 0)
+                ensure_next_candidate (next_transaction, first_candidate);
             }
         }
     }
@@ -236,25 +266,41 @@ free:
 }
 
 static gboolean
-has_dependencies (MetaWaylandTransaction *transaction)
+is_waiting_for_fifo_barrier (MetaWaylandTransaction *transaction)
 {
   GHashTableIter iter;
   MetaWaylandSurface *surface;
-
-  if (transaction->buf_sources &&
-      g_hash_table_size (transaction->buf_sources) > 0)
-    return TRUE;
+  MetaWaylandTransactionEntry *entry;
 
   g_hash_table_iter_init (&iter, transaction->entries);
-  while (g_hash_table_iter_next (&iter, (gpointer *) &surface, NULL))
+  while (g_hash_table_iter_next (&iter,
+                                 (gpointer *) &surface, (gpointer *) &entry))
     {
-      if (surface->transaction.first_committed != transaction)
+      if (entry && entry->state && entry->state->fifo_wait &&
+          meta_wayland_fifo_is_barrier_set (surface))
         return TRUE;
     }
 
   return FALSE;
 }
 
+static gboolean
+has_dependencies (MetaWaylandTransaction *transaction)
+{
+  if (transaction->buf_sources &&
+      g_hash_table_size (transaction->buf_sources) > 0)
+    return TRUE;
+
+  if (transaction->has_target_time)
+    return TRUE;
+
+  if (transaction->has_fifo_waits &&
+      is_waiting_for_fifo_barrier (transaction))
+    return TRUE;
+
+  return transaction->n_blocking_surfaces > 0;
+}
+
 static void
 meta_wayland_transaction_maybe_apply_one (MetaWaylandTransaction  *transaction,
                                           MetaWaylandTransaction **first_candidate)
@@ -283,6 +329,18 @@ meta_wayland_transaction_maybe_apply (MetaWaylandTransaction *transaction)
     }
 }
 
+void
+meta_wayland_transaction_maybe_apply_for_surface (MetaWaylandSurface *surface)
+{
+  MetaWaylandTransaction *transaction = surface->transaction.first_committed;
+
+  if (!transaction ||
+      transaction->n_blocking_surfaces > 0)
+    return;
+
+  meta_wayland_transaction_maybe_apply (transaction);
+}
+
 static void
 meta_wayland_transaction_dma_buf_dispatch (MetaWaylandBuffer *buffer,
                                            gpointer           user_data)
@@ -332,6 +390,50 @@ meta_wayland_transaction_add_dma_buf_source (MetaWaylandTransaction *transaction
   return TRUE;
 }
 
+/*
+ * A surface which is directly scanned out doesn't need its buffer to be
+ * ready before its state is applied, if the fence can be waited on by the
+ * KMS thread right before committing the buffer. That saves the round trip
+ * through the main loop once the client finished rendering. In case the
+ * buffer ends up being composited after all, the GPU is made to wait for
+ * the fence before sampling from it.
+ */
+static gboolean
+meta_wayland_transaction_defer_acquire_to_scanout (MetaWaylandTransaction  *transaction,
+                                                   MetaWaylandSurface      *surface,
+                                                   MetaWaylandSurfaceState *state)
+{
+  MetaWaylandSyncPoint *acquire = state->drm_syncobj.acquire;
+  MetaWaylandBuffer *buffer = state->buffer;
+  MetaContext *context =
+    meta_wayland_compositor_get_context (transaction->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  g_autofd int sync_fd = -1;
+
+  if (!buffer || buffer->type != META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    return FALSE;
+
+  if (!meta_wayland_surface_get_scanout_candidate (surface))
+    return FALSE;
+
+  /* Not possible until the client submitted the work signaling the point */
+  sync_fd = meta_wayland_sync_timeline_export_sync_file (acquire->timeline,
+                                                         acquire->sync_point,
+                                                         NULL);
+  if (sync_fd < 0)
+    return FALSE;
+
+  if (!cogl_context_wait_sync_fd (cogl_context, sync_fd))
+    return FALSE;
+
+  g_clear_fd (&state->drm_syncobj.acquire_sync_fd, NULL);
+  state->drm_syncobj.acquire_sync_fd = g_steal_fd (&sync_fd);
+
+  return TRUE;
+}
+
 static gboolean
 meta_wayland_transaction_add_drm_syncobj_source (MetaWaylandTransaction *transaction,
                                                  MetaWaylandBuffer      *buffer,
@@ -360,6 +462,34 @@ meta_wayland_transaction_add_drm_syncobj_source (MetaWaylandTransaction *transac
   return TRUE;
 }
 
+static gboolean
+meta_wayland_transaction_add_shm_upload_source (MetaWaylandTransaction  *transaction,
+                                                MetaWaylandBuffer       *buffer,
+                                                MetaWaylandSurfaceState *state)
+{
+  GSource *source;
+
+  if (transaction->buf_sources &&
+      g_hash_table_contains (transaction->buf_sources, buffer))
+    return FALSE;
+
+  source = meta_wayland_buffer_create_shm_upload_source (buffer,
+                                                         state->surface_damage,
+                                                         state->buffer_damage,
+                                                         meta_wayland_transaction_dma_buf_dispatch,
+                                                         transaction);
+  if (!source)
+    return FALSE;
+
+  ensure_buf_sources (transaction);
+
+  g_hash_table_insert (transaction->buf_sources, buffer, source);
+  g_source_attach (source, NULL);
+  g_source_unref (source);
+
+  return TRUE;
+}
+
 static void
 meta_wayland_transaction_add_placement_surfaces (MetaWaylandTransaction  *transaction,
                                                  MetaWaylandSurfaceState *state)
@@ -399,12 +529,29 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
           MetaWaylandBuffer *buffer = entry->state->buffer;
 
           if ((entry->state->drm_syncobj.acquire &&
+               !meta_wayland_transaction_defer_acquire_to_scanout (transaction,
+                                                                   surface,
+                                                                   entry->state) &&
                meta_wayland_transaction_add_drm_syncobj_source (transaction, buffer,
                                                                 entry->state->drm_syncobj.acquire))
               || (buffer &&
-                  meta_wayland_transaction_add_dma_buf_source (transaction, buffer)))
+                  meta_wayland_transaction_add_dma_buf_source (transaction, buffer))
+              || (buffer &&
+                  meta_wayland_transaction_add_shm_upload_source (transaction, buffer,
+                                                                  entry->state)))
             maybe_apply = FALSE;
 
+          if (entry->state->fifo_wait)
+            transaction->has_fifo_waits = TRUE;
+
+          if (entry->state->has_target_time &&
+              (!transaction->has_target_time ||
+               entry->state->target_time_us > transaction->target_time_us))
+            {
+              transaction->has_target_time = TRUE;
+              transaction->target_time_us = entry->state->target_time_us;
+            }
+
           if (entry->state->subsurface_placement_ops)
             {
               if (!placement_states)
@@ -425,6 +572,23 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
                                                        placement_state);
     }
 
+  if (transaction->has_target_time)
+    {
+      if (transaction->target_time_us <= g_get_monotonic_time ())
+        {
+          transaction->has_target_time = FALSE;
+        }
+      else
+        {
+          MetaContext *context =
+            meta_wayland_compositor_get_context (transaction->compositor);
+          MetaBackend *backend = meta_context_get_backend (context);
+
+          clutter_stage_schedule_update (CLUTTER_STAGE (meta_backend_get_stage (backend)));
+          maybe_apply = FALSE;
+        }
+    }
+
   transaction->committed_sequence = ++committed_sequence;
   transaction->node.data = transaction;
 
@@ -440,6 +604,7 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
           entry = g_hash_table_lookup (surface->transaction.last_committed->entries,
                                        surface);
           entry->next_transaction = transaction;
+          transaction->n_blocking_surfaces++;
           maybe_apply = FALSE;
         }
       else
@@ -454,6 +619,68 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
     meta_wayland_transaction_maybe_apply (transaction);
 }
 
+static MetaWaylandTransaction *
+find_released_timed_transaction (GQueue *committed_queue)
+{
+  GList *l;
+
+  for (l = committed_queue->head; l; l = l->next)
+    {
+      MetaWaylandTransaction *transaction = l->data;
+
+      if (transaction->target_time_released)
+        return transaction;
+    }
+
+  return NULL;
+}
+
+/*
+ * Releases the transactions targeting a presentation time no later than
+ * @presentation_time_us, i.e. the ones which should be visible in the frame
+ * being prepared. Returns whether any transaction is still held back for a
+ * later frame.
+ */
+gboolean
+meta_wayland_transaction_release_timed (MetaWaylandCompositor *compositor,
+                                        int64_t                presentation_time_us)
+{
+  GQueue *committed_queue;
+  MetaWaylandTransaction *transaction;
+  gboolean has_held = FALSE;
+  GList *l;
+
+  committed_queue =
+    meta_wayland_compositor_get_committed_transactions (compositor);
+
+  for (l = committed_queue->head; l; l = l->next)
+    {
+      transaction = l->data;
+
+      if (!transaction->has_target_time)
+        continue;
+
+      if (transaction->target_time_us > presentation_time_us)
+        {
+          has_held = TRUE;
+          continue;
+        }
+
+      transaction->has_target_time = FALSE;
+      transaction->target_time_released = TRUE;
+    }
+
+  /* Applying a transaction can apply and free the ones queued after it, so
+   * look the next one up again every time. */
+  while ((transaction = find_released_timed_transaction (committed_queue)))
+    {
+      transaction->target_time_released = FALSE;
+      meta_wayland_transaction_maybe_apply (transaction);
+    }
+
+  return has_held;
+}
+
 MetaWaylandTransactionEntry *
 meta_wayland_transaction_ensure_entry (MetaWaylandTransaction *transaction,
                                        MetaWaylandSurface     *surface)
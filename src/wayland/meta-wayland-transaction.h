@@ -22,6 +22,11 @@
 
 void meta_wayland_transaction_commit (MetaWaylandTransaction *transaction);
 
+void meta_wayland_transaction_maybe_apply_for_surface (MetaWaylandSurface *surface);
+
+gboolean meta_wayland_transaction_release_timed (MetaWaylandCompositor *compositor,
+                                                 int64_t                presentation_time_us);
+
 MetaWaylandTransactionEntry *meta_wayland_transaction_ensure_entry (MetaWaylandTransaction *transaction,
                                                                     MetaWaylandSurface     *surface);
 
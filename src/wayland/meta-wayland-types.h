@@ -60,6 +60,8 @@ typedef struct _MetaWaylandActivation MetaWaylandActivation;
 
 typedef struct _MetaWaylandDmaBufManager MetaWaylandDmaBufManager;
 
+typedef struct _MetaWaylandShmUploader MetaWaylandShmUploader;
+
 typedef struct _MetaWaylandSyncobjTimeline MetaWaylandSyncobjTimeline;
 
 typedef struct _MetaWaylandXdgPositioner MetaWaylandXdgPositioner;
@@ -72,6 +74,8 @@ typedef struct _MetaWaylandFilterManager MetaWaylandFilterManager;
 
 typedef struct _MetaWaylandClient MetaWaylandClient;
 
+typedef struct _MetaWaylandClientStats MetaWaylandClientStats;
+
 typedef struct _MetaWaylandDrmLeaseManager MetaWaylandDrmLeaseManager;
 
 typedef struct _MetaWaylandXdgSessionManager MetaWaylandXdgSessionManager;
@@ -51,7 +51,7 @@
 #define META_ZWP_TEXT_INPUT_V3_VERSION      1
 #define META_WP_VIEWPORTER_VERSION          1
 #define META_ZWP_PRIMARY_SELECTION_V1_VERSION 1
-#define META_WP_PRESENTATION_VERSION        1
+#define META_WP_PRESENTATION_VERSION        2
 #define META_XDG_ACTIVATION_V1_VERSION 1
 #define META_ZWP_IDLE_INHIBIT_V1_VERSION    1
 #define META_WP_SINGLE_PIXEL_BUFFER_V1_VERSION 1
@@ -61,3 +61,9 @@
 #define META_XDG_DIALOG_VERSION 1
 #define META_WP_DRM_LEASE_DEVICE_V1_VERSION 1
 #define META_XDG_SESSION_MANAGER_V1_VERSION 1
+#define META_WP_FIFO_V1_VERSION 1
+#define META_WP_COMMIT_TIMING_V1_VERSION 1
+#define META_WP_TEARING_CONTROL_V1_VERSION 1
+#define META_WP_CONTENT_TYPE_V1_VERSION 1
+#define META_EXT_OUTPUT_IMAGE_CAPTURE_SOURCE_MANAGER_V1_VERSION 1
+#define META_EXT_IMAGE_COPY_CAPTURE_MANAGER_V1_VERSION 1
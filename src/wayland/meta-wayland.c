@@ -39,12 +39,15 @@
 #include "core/meta-context-private.h"
 #include "wayland/meta-wayland-activation.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-client-private.h"
 #include "wayland/meta-wayland-color-management.h"
 #include "wayland/meta-wayland-data-device.h"
 #include "wayland/meta-wayland-dma-buf.h"
 #include "wayland/meta-wayland-egl-stream.h"
+#include "wayland/meta-wayland-fifo.h"
 #include "wayland/meta-wayland-filter-manager.h"
 #include "wayland/meta-wayland-idle-inhibit.h"
+#include "wayland/meta-wayland-image-capture.h"
 #include "wayland/meta-wayland-inhibit-shortcuts-dialog.h"
 #include "wayland/meta-wayland-inhibit-shortcuts.h"
 #include "wayland/meta-wayland-legacy-xdg-foreign.h"
@@ -54,6 +57,7 @@
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
+#include "wayland/meta-wayland-shm-upload.h"
 #include "wayland/meta-wayland-subsurface.h"
 #include "wayland/meta-wayland-tablet-manager.h"
 #include "wayland/meta-wayland-transaction.h"
@@ -99,6 +103,7 @@ G_DEFINE_TYPE_WITH_PRIVATE (MetaWaylandCompositor, meta_wayland_compositor,
 typedef struct
 {
   GSource source;
+  MetaWaylandCompositor *compositor;
   struct wl_display *display;
 } WaylandEventSource;
 
@@ -140,6 +145,7 @@ wayland_event_source_dispatch (GSource    *base,
   struct wl_event_loop *loop = wl_display_get_event_loop (source->display);
 
   wl_event_loop_dispatch (loop, 0);
+  meta_wayland_client_stats_end_dispatch (source->compositor);
 
   return TRUE;
 }
@@ -153,8 +159,9 @@ static GSourceFuncs wayland_event_source_funcs =
 };
 
 static GSource *
-wayland_event_source_new (struct wl_display *display)
+wayland_event_source_new (MetaWaylandCompositor *compositor)
 {
+  struct wl_display *display = compositor->wayland_display;
   GSource *source;
   WaylandEventSource *wayland_source;
   struct wl_event_loop *loop = wl_display_get_event_loop (display);
@@ -163,6 +170,7 @@ wayland_event_source_new (struct wl_display *display)
                          sizeof (WaylandEventSource));
   g_source_set_name (source, "[mutter] Wayland events");
   wayland_source = (WaylandEventSource *) source;
+  wayland_source->compositor = compositor;
   wayland_source->display = display;
   g_source_add_unix_fd (&wayland_source->source,
                         wl_event_loop_get_fd (loop),
@@ -177,6 +185,7 @@ emit_frame_callbacks_for_stage_view (MetaWaylandCompositor *compositor,
 {
   GList *l;
   int64_t now_us;
+  gboolean emitted = FALSE;
 
   now_us = g_get_monotonic_time ();
 
@@ -201,10 +210,19 @@ emit_frame_callbacks_for_stage_view (MetaWaylandCompositor *compositor,
       actor_surface = META_WAYLAND_ACTOR_SURFACE (surface->role);
       meta_wayland_actor_surface_emit_frame_callbacks (actor_surface,
                                                        now_us / 1000);
+      emitted = TRUE;
 
       compositor->frame_callback_surfaces =
         g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
     }
+
+  meta_wayland_fifo_update_barriers_for_stage_view (compositor, stage_view);
+
+  /* Events are queued per client until flushed. Flush all of them at once
+   * here, rather than whenever the main loop next goes idle, so clients
+   * get to start on their next frame right away, and only wake up once. */
+  if (emitted)
+    wl_display_flush_clients (compositor->wayland_display);
 }
 
 #ifdef HAVE_NATIVE_BACKEND
@@ -356,6 +374,30 @@ ensure_source_for_stage_view (MetaWaylandCompositor *compositor,
 }
 #endif /* HAVE_NATIVE_BACKEND */
 
+static void
+on_before_update (ClutterStage          *stage,
+                  ClutterStageView      *stage_view,
+                  ClutterFrame          *frame,
+                  MetaWaylandCompositor *compositor)
+{
+  int64_t presentation_time_us;
+  int64_t half_refresh_interval_us;
+
+  if (!clutter_frame_get_target_presentation_time (frame,
+                                                   &presentation_time_us))
+    presentation_time_us = g_get_monotonic_time ();
+
+  /* Release what targets this frame more closely than the next one */
+  half_refresh_interval_us =
+    (int64_t) (0.5 + G_USEC_PER_SEC /
+               clutter_stage_view_get_refresh_rate (stage_view) / 2);
+
+  if (meta_wayland_transaction_release_timed (compositor,
+                                              presentation_time_us +
+                                              half_refresh_interval_us))
+    clutter_stage_schedule_update (stage);
+}
+
 static void
 on_after_update (ClutterStage          *stage,
                  ClutterStageView      *stage_view,
@@ -501,6 +543,8 @@ on_presented (ClutterStage          *stage,
   MetaWaylandPresentationFeedback *feedback, *next;
   struct wl_list *feedbacks;
   MetaWaylandOutput *output;
+  ClutterFrameClock *frame_clock;
+  gboolean is_variable_refresh;
 
   feedbacks =
     meta_wayland_presentation_time_ensure_feedbacks (&compositor->presentation_time,
@@ -508,11 +552,16 @@ on_presented (ClutterStage          *stage,
 
   output = get_output_for_stage_view (compositor, stage_view);
 
+  frame_clock = clutter_stage_view_get_frame_clock (stage_view);
+  is_variable_refresh =
+    clutter_frame_clock_get_mode (frame_clock) == CLUTTER_FRAME_CLOCK_MODE_VARIABLE;
+
   wl_list_for_each_safe (feedback, next, feedbacks, link)
     {
       meta_wayland_presentation_feedback_present (feedback,
                                                   frame_info,
-                                                  output);
+                                                  output,
+                                                  is_variable_refresh);
     }
 }
 
@@ -671,6 +720,7 @@ on_client_created (struct wl_listener *listener,
     wl_container_of (listener, compositor, client_created_listener);
 
   wl_client_set_user_data (client, compositor, NULL);
+  meta_wayland_client_stats_track (compositor, client);
 }
 
 void
@@ -698,12 +748,14 @@ meta_wayland_compositor_finalize (GObject *object)
 
   g_hash_table_destroy (compositor->scheduled_surface_associations);
 
+  g_signal_handlers_disconnect_by_func (stage, on_before_update, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_after_update, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_presented, compositor);
 
   meta_wayland_transaction_finalize (compositor);
 
   g_clear_object (&compositor->dma_buf_manager);
+  g_clear_pointer (&compositor->shm_uploader, meta_wayland_shm_uploader_unref);
 
   g_clear_pointer (&compositor->seat, meta_wayland_seat_free);
   meta_wayland_tablet_manager_finalize (compositor);
@@ -712,6 +764,7 @@ meta_wayland_compositor_finalize (GObject *object)
   g_clear_pointer (&priv->frame_callback_sources, g_hash_table_destroy);
 
   g_clear_pointer (&compositor->display_name, g_free);
+  meta_wayland_client_stats_finalize (compositor);
   g_clear_pointer (&compositor->wayland_display, wl_display_destroy);
   g_clear_pointer (&compositor->source, g_source_destroy);
 
@@ -735,6 +788,7 @@ meta_wayland_compositor_init (MetaWaylandCompositor *compositor)
   compositor->client_created_listener.notify = on_client_created;
   wl_display_add_client_created_listener (compositor->wayland_display,
                                           &compositor->client_created_listener);
+  meta_wayland_client_stats_init (compositor);
 
   priv->filter_manager = meta_wayland_filter_manager_new (compositor);
   priv->frame_callback_sources =
@@ -840,7 +894,7 @@ meta_wayland_compositor_new (MetaContext *context)
   wl_display_set_default_max_buffer_size (compositor->wayland_display,
                                           1024 * 1024);
 
-  wayland_event_source = wayland_event_source_new (compositor->wayland_display);
+  wayland_event_source = wayland_event_source_new (compositor);
 
   /* XXX: Here we are setting the wayland event source to have a
    * slightly lower priority than the X event source, because we are
@@ -853,6 +907,8 @@ meta_wayland_compositor_new (MetaContext *context)
   compositor->source = wayland_event_source;
   g_source_unref (wayland_event_source);
 
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), compositor);
   g_signal_connect (stage, "after-update",
                     G_CALLBACK (on_after_update), compositor);
   g_signal_connect (stage, "presented",
@@ -894,6 +950,7 @@ meta_wayland_compositor_new (MetaContext *context)
   meta_wayland_drm_syncobj_init (compositor);
   meta_wayland_init_xdg_wm_dialog (compositor);
   meta_wayland_init_color_management (compositor);
+  meta_wayland_init_image_capture (compositor);
   meta_wayland_xdg_session_management_init (compositor);
 
 #ifdef HAVE_NATIVE_BACKEND
@@ -42,6 +42,10 @@
 #include "wayland/meta-wayland-window-configuration.h"
 #include "wayland/meta-wayland-xdg-shell.h"
 
+/* How long an interactive resize waits for the client to ack a resizing
+ * configure before sending the next one anyway. */
+#define RESIZE_CONFIGURE_ACK_TIMEOUT_MS 100
+
 enum
 {
   PROP_0,
@@ -72,6 +76,7 @@ struct _MetaWindowWayland
   MetaGravity last_sent_gravity;
 
   MetaWaylandWindowConfiguration *last_acked_configuration;
+  int64_t last_resize_configure_time_us;
 
   gboolean has_been_shown;
 
@@ -194,6 +199,9 @@ meta_window_wayland_configure (MetaWindowWayland              *wl_window,
 {
   meta_wayland_surface_configure_notify (wl_window->surface, configuration);
 
+  if (configuration->is_resizing)
+    wl_window->last_resize_configure_time_us = g_get_monotonic_time ();
+
   wl_window->pending_configurations =
     g_list_prepend (wl_window->pending_configurations, configuration);
 }
@@ -1296,6 +1304,12 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
                                     META_PLACE_FLAG_NONE,
                                     gravity,
                                     rect);
+
+  /* Motion that arrived while the client was still drawing the previous
+   * size has been held back; apply the latest of it now. */
+  if (is_window_being_resized &&
+      !meta_window_wayland_is_awaiting_configure_ack (window))
+    meta_window_drag_update_resize (window_drag);
 }
 
 void
@@ -1490,3 +1504,35 @@ meta_window_wayland_get_pending_serial (MetaWindowWayland *wl_window,
 
   return FALSE;
 }
+
+/**
+ * meta_window_wayland_is_awaiting_configure_ack:
+ * @window: a #MetaWindow
+ *
+ * Whether a resizing configure is still waiting for the client to ack and
+ * commit it. Interactive resizes hold back further configures meanwhile,
+ * so that a slow client draws the latest size next, instead of working
+ * through a queue of sizes the pointer has long left behind.
+ *
+ * Returns: %TRUE if the next resize should wait for the client
+ */
+gboolean
+meta_window_wayland_is_awaiting_configure_ack (MetaWindow *window)
+{
+  MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
+  GList *l;
+
+  if (g_get_monotonic_time () - wl_window->last_resize_configure_time_us >
+      ms2us (RESIZE_CONFIGURE_ACK_TIMEOUT_MS))
+    return FALSE;
+
+  for (l = wl_window->pending_configurations; l; l = l->next)
+    {
+      MetaWaylandWindowConfiguration *configuration = l->data;
+
+      if (configuration->is_resizing)
+        return TRUE;
+    }
+
+  return FALSE;
+}
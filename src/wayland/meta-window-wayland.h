@@ -78,6 +78,8 @@ gboolean meta_window_wayland_is_resize (MetaWindowWayland *wl_window,
 META_EXPORT_TEST
 gboolean meta_window_wayland_is_acked_fullscreen (MetaWindowWayland *wl_window);
 
+gboolean meta_window_wayland_is_awaiting_configure_ack (MetaWindow *window);
+
 META_EXPORT_TEST
 gboolean meta_window_wayland_get_pending_serial (MetaWindowWayland *wl_window,
                                                  uint32_t          *serial);
@@ -967,12 +967,21 @@ meta_xwayland_start_xserver_finish (MetaXWaylandManager  *manager,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-static gboolean
-xdisplay_connection_activity_cb (gint         fd,
-                                 GIOCondition cond,
-                                 gpointer     user_data)
+static void
+clear_prewarm (MetaXWaylandManager *manager)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (manager->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+
+  g_clear_signal_handler (&manager->prewarm_presented_id,
+                          meta_backend_get_stage (backend));
+  g_clear_handle_id (&manager->prewarm_idle_id, g_source_remove);
+}
+
+static void
+start_on_demand_x11_display (MetaXWaylandManager *manager)
 {
-  MetaXWaylandManager *manager = user_data;
   MetaContext *context =
     meta_wayland_compositor_get_context (manager->compositor);
   MetaDisplay *display = meta_context_get_display (context);
@@ -984,9 +993,74 @@ xdisplay_connection_activity_cb (gint         fd,
   g_clear_handle_id (&manager->abstract_fd_watch_id, g_source_remove);
   g_clear_handle_id (&manager->unix_fd_watch_id, g_source_remove);
 
+  clear_prewarm (manager);
+}
+
+static gboolean
+xdisplay_connection_activity_cb (gint         fd,
+                                 GIOCondition cond,
+                                 gpointer     user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  start_on_demand_x11_display (manager);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+prewarm_idle_cb (gpointer user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  manager->prewarm_idle_id = 0;
+
+  meta_topic (META_DEBUG_WAYLAND, "Starting Xwayland ahead of X11 clients");
+
+  start_on_demand_x11_display (manager);
+
   return G_SOURCE_REMOVE;
 }
 
+static void
+on_first_frame_presented (ClutterStage        *stage,
+                          ClutterStageView    *stage_view,
+                          ClutterFrameInfo    *frame_info,
+                          MetaXWaylandManager *manager)
+{
+  g_clear_signal_handler (&manager->prewarm_presented_id, stage);
+
+  manager->prewarm_idle_id =
+    g_idle_add_full (G_PRIORITY_LOW, prewarm_idle_cb, manager, NULL);
+}
+
+static void
+maybe_prewarm_xwayland (MetaXWaylandManager *manager)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (manager->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+
+  if (manager->prewarmed)
+    return;
+
+  if (!meta_settings_is_experimental_feature_enabled (settings,
+                                                      META_EXPERIMENTAL_FEATURE_XWAYLAND_PREWARM))
+    return;
+
+  /* A pre-warmed Xwayland without clients would just be terminated again. */
+  if (meta_settings_is_experimental_feature_enabled (settings,
+                                                     META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND))
+    return;
+
+  manager->prewarmed = TRUE;
+  manager->prewarm_presented_id =
+    g_signal_connect (meta_backend_get_stage (backend), "presented",
+                      G_CALLBACK (on_first_frame_presented),
+                      manager);
+}
+
 static void
 meta_xwayland_stop_xserver (MetaXWaylandManager *manager)
 {
@@ -1014,6 +1088,8 @@ meta_xwayland_shutdown (MetaWaylandCompositor *compositor)
 
   g_cancellable_cancel (manager->xserver_died_cancellable);
 
+  clear_prewarm (manager);
+
   XSetIOErrorHandler (x_io_error_noop);
   x11_display = display->x11_display;
   if (x11_display)
@@ -1136,6 +1212,8 @@ meta_xwayland_init (MetaXWaylandManager    *manager,
       manager->unix_fd_watch_id =
         g_unix_fd_add (manager->public_connection.unix_fd, G_IO_IN,
                        xdisplay_connection_activity_cb, manager);
+
+      maybe_prewarm_xwayland (manager);
     }
 
   if (policy != META_X11_DISPLAY_POLICY_DISABLED)
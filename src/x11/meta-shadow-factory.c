@@ -77,8 +77,15 @@ struct _MetaShadow
   int outer_border_left;
   int inner_border_left;
 
+  /* Texture memory, for the cache accounting */
+  size_t n_bytes;
+
+  /* Link in the factory's list of unused shadows, while unreferenced */
+  GList unused_link;
+
   guint scale_width : 1;
   guint scale_height : 1;
+  guint is_cached : 1;
 };
 
 struct _MetaShadowClassInfo
@@ -96,6 +103,18 @@ struct _MetaShadowFactory
    * by the factory, they are simply removed from the table when freed */
   GHashTable *shadows;
 
+  /* Cached shadows that are no longer referenced, most recently used
+   * first. They are kept around until their texture memory exceeds the
+   * cache budget, so recreating the same shape doesn't have to blur
+   * again. */
+  GQueue unused_shadows;
+  size_t unused_bytes;
+  size_t cache_budget;
+
+  size_t cached_bytes;
+  unsigned int cache_hits;
+  unsigned int cache_misses;
+
   /* class name => MetaShadowClassInfo */
   GHashTable *shadow_classes;
 };
@@ -145,23 +164,57 @@ meta_shadow_ref (MetaShadow *shadow)
   return shadow;
 }
 
+static void
+meta_shadow_free (MetaShadow *shadow)
+{
+  MetaShadowFactory *factory = shadow->factory;
+
+  if (factory && shadow->is_cached)
+    {
+      g_hash_table_remove (factory->shadows, &shadow->key);
+      factory->cached_bytes -= shadow->n_bytes;
+    }
+
+  meta_window_shape_unref (shadow->key.shape);
+  g_clear_object (&shadow->texture);
+  g_clear_object (&shadow->pipeline);
+
+  g_free (shadow);
+}
+
+static void
+trim_unused_shadows (MetaShadowFactory *factory)
+{
+  while (factory->unused_bytes > factory->cache_budget)
+    {
+      GList *link = g_queue_pop_tail_link (&factory->unused_shadows);
+      MetaShadow *shadow = link->data;
+
+      factory->unused_bytes -= shadow->n_bytes;
+      meta_shadow_free (shadow);
+    }
+}
+
 void
 meta_shadow_unref (MetaShadow *shadow)
 {
-  shadow->ref_count--;
-  if (shadow->ref_count == 0)
-    {
-      if (shadow->factory)
-        {
-          g_hash_table_remove (shadow->factory->shadows,
-                               &shadow->key);
-        }
+  MetaShadowFactory *factory = shadow->factory;
 
-      meta_window_shape_unref (shadow->key.shape);
-      g_object_unref (shadow->texture);
-      g_object_unref (shadow->pipeline);
+  shadow->ref_count--;
+  if (shadow->ref_count > 0)
+    return;
 
-      g_free (shadow);
+  if (factory && shadow->is_cached &&
+      shadow->n_bytes <= factory->cache_budget)
+    {
+      g_queue_push_head_link (&factory->unused_shadows,
+                              &shadow->unused_link);
+      factory->unused_bytes += shadow->n_bytes;
+      trim_unused_shadows (factory);
+    }
+  else
+    {
+      meta_shadow_free (shadow);
     }
 }
 
@@ -407,14 +460,17 @@ meta_shadow_factory_finalize (GObject *object)
 {
   MetaShadowFactory *factory = META_SHADOW_FACTORY (object);
   GHashTableIter iter;
-  gpointer key, value;
+  gpointer value;
+
+  factory->cache_budget = 0;
+  trim_unused_shadows (factory);
 
   /* Detach from the shadows in the table so we won't try to
    * remove them when they're freed. */
   g_hash_table_iter_init (&iter, factory->shadows);
-  while (g_hash_table_iter_next (&iter, &key, &value))
+  while (g_hash_table_iter_next (&iter, NULL, &value))
     {
-      MetaShadow *shadow = key;
+      MetaShadow *shadow = value;
       shadow->factory = NULL;
     }
 
@@ -509,8 +565,17 @@ blur_xspan (guchar *row,
 {
   int offset;
   int sum = 0;
+  guint64 multiplier;
   int i;
 
+  /* Dividing by d is done by multiplying with a fixed point reciprocal
+   * instead. Rounding the reciprocal up makes the truncated product
+   * exact as long as sum * (multiplier * d - 2^40) stays below 2^40;
+   * with sum < 256 * d that holds for any d below 65536, far beyond
+   * any sensible shadow radius.
+   */
+  multiplier = ((G_GUINT64_CONSTANT (1) << 40) + d - 1) / d;
+
   if (d % 2 == 1)
     offset = d / 2;
   else
@@ -519,11 +584,11 @@ blur_xspan (guchar *row,
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win. The integer division per pixel
+   * used to be the main slow down, hence the reciprocal above; one
+   * further possible optimization would be to accumulate into two 16-bit
+   * integer buffers and only divide down after all three passes. (SSE
+   * parallel implementation of the divide step is possible.)
    */
   for (i = x0 - d + offset; i < x1 + offset; i++)
     {
@@ -535,7 +600,7 @@ blur_xspan (guchar *row,
           if (i >= d)
             sum -= row[i - d];
 
-          tmp_buffer[i - offset] = (sum + d / 2) / d;
+          tmp_buffer[i - offset] = ((sum + d / 2) * multiplier) >> 40;
         }
     }
 
@@ -1061,13 +1126,26 @@ meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
 
       shadow = g_hash_table_lookup (factory->shadows, &key);
       if (shadow)
-        return meta_shadow_ref (shadow);
+        {
+          factory->cache_hits++;
+
+          if (shadow->ref_count == 0)
+            {
+              g_queue_unlink (&factory->unused_shadows, &shadow->unused_link);
+              factory->unused_bytes -= shadow->n_bytes;
+            }
+
+          return meta_shadow_ref (shadow);
+        }
+
+      factory->cache_misses++;
     }
 
   shadow = g_new0 (MetaShadow, 1);
 
   shadow->ref_count = 1;
   shadow->factory = factory;
+  shadow->unused_link.data = shadow;
   shadow->key.shape = meta_window_shape_ref (shape);
   shadow->key.radius = params->radius;
   shadow->key.top_fade = params->top_fade;
@@ -1098,12 +1176,94 @@ meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
   region = meta_window_shape_to_region (shape, center_width, center_height);
   make_shadow (shadow, cogl_context, region);
 
+  if (shadow->texture)
+    {
+      shadow->n_bytes = (size_t) cogl_texture_get_width (shadow->texture) *
+                        cogl_texture_get_height (shadow->texture);
+    }
+
   if (cacheable)
-    g_hash_table_insert (factory->shadows, &shadow->key, shadow);
+    {
+      g_hash_table_insert (factory->shadows, &shadow->key, shadow);
+      shadow->is_cached = TRUE;
+      factory->cached_bytes += shadow->n_bytes;
+    }
 
   return shadow;
 }
 
+/**
+ * meta_shadow_factory_set_cache_budget:
+ * @factory: a #MetaShadowFactory
+ * @budget: texture memory in bytes
+ *
+ * Sets how much texture memory shadows that are no longer used may keep
+ * occupying, so that they can be reused when a window with the same
+ * shape needs a shadow again. The least recently used ones are freed
+ * first. A budget of 0 frees shadows as soon as they are unused.
+ */
+void
+meta_shadow_factory_set_cache_budget (MetaShadowFactory *factory,
+                                      size_t             budget)
+{
+  g_return_if_fail (META_IS_SHADOW_FACTORY (factory));
+
+  factory->cache_budget = budget;
+  trim_unused_shadows (factory);
+}
+
+/**
+ * meta_shadow_factory_purge_unused:
+ * @factory: a #MetaShadowFactory
+ *
+ * Frees all the cached shadows that are no longer in use, regardless of
+ * the cache budget.
+ *
+ * Returns: the texture memory that was freed
+ */
+size_t
+meta_shadow_factory_purge_unused (MetaShadowFactory *factory)
+{
+  size_t n_bytes;
+
+  g_return_val_if_fail (META_IS_SHADOW_FACTORY (factory), 0);
+
+  n_bytes = factory->unused_bytes;
+
+  while (!g_queue_is_empty (&factory->unused_shadows))
+    {
+      GList *link = g_queue_pop_tail_link (&factory->unused_shadows);
+
+      meta_shadow_free (link->data);
+    }
+  factory->unused_bytes = 0;
+
+  return n_bytes;
+}
+
+/**
+ * meta_shadow_factory_get_cache_stats:
+ * @factory: a #MetaShadowFactory
+ * @n_entries: (out): number of cached shadows, used or not
+ * @n_bytes: (out): texture memory of the cached shadows
+ * @hits: (out): number of lookups served from the cache
+ * @misses: (out): number of lookups that had to create a shadow
+ */
+void
+meta_shadow_factory_get_cache_stats (MetaShadowFactory *factory,
+                                     unsigned int      *n_entries,
+                                     size_t            *n_bytes,
+                                     unsigned int      *hits,
+                                     unsigned int      *misses)
+{
+  g_return_if_fail (META_IS_SHADOW_FACTORY (factory));
+
+  *n_entries = g_hash_table_size (factory->shadows);
+  *n_bytes = factory->cached_bytes;
+  *hits = factory->cache_hits;
+  *misses = factory->cache_misses;
+}
+
 /**
  * meta_shadow_factory_get_params:
  * @factory: a #MetaShadowFactory
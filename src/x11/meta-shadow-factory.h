@@ -114,3 +114,14 @@ MetaShadow *meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
                                             const char        *class_name,
                                             gboolean           focused,
                                             CoglContext       *cogl_context);
+
+void meta_shadow_factory_set_cache_budget (MetaShadowFactory *factory,
+                                           size_t             budget);
+
+size_t meta_shadow_factory_purge_unused (MetaShadowFactory *factory);
+
+void meta_shadow_factory_get_cache_stats (MetaShadowFactory *factory,
+                                          unsigned int      *n_entries,
+                                          size_t            *n_bytes,
+                                          unsigned int      *hits,
+                                          unsigned int      *misses);
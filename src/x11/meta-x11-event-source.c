@@ -19,6 +19,13 @@
 
 #include "meta-x11-event-source.h"
 
+#include <X11/Xlibint.h>
+
+/* How far into the event queue to look for a newer copy of a
+ * PropertyNotify before giving up and handling it.
+ */
+#define MAX_PROPERTY_NOTIFY_LOOKAHEAD 64
+
 typedef struct {
   GSource base;
   GPollFD event_poll_fd;
@@ -47,6 +54,43 @@ meta_x11_event_source_check (GSource *source)
          XEventsQueued (event_source->xdisplay, QueuedAlready) > 0;
 }
 
+/* A PropertyNotify only tells that a property changed, handlers always
+ * fetch the current value. If the queue already holds another notify of
+ * the same kind for the same property, handling this one would just
+ * fetch the same value twice. Chatty clients updating a property on
+ * every frame would otherwise cost a round trip each time.
+ */
+static gboolean
+is_superseded_property_notify (Display *xdisplay,
+                               XEvent  *xevent)
+{
+  XPropertyEvent *xproperty = &xevent->xproperty;
+  struct _XSQEvent *queued;
+  int lookahead = 0;
+
+  if (xevent->type != PropertyNotify)
+    return FALSE;
+
+  for (queued = xdisplay->head;
+       queued && lookahead < MAX_PROPERTY_NOTIFY_LOOKAHEAD;
+       queued = queued->next, lookahead++)
+    {
+      XPropertyEvent *other = &queued->event.xproperty;
+
+      if (queued->event.type != PropertyNotify ||
+          other->window != xproperty->window ||
+          other->atom != xproperty->atom)
+        continue;
+
+      /* A deletion in between must still be seen, e.g. INCR selection
+       * transfers rely on every NewValue/Delete pair.
+       */
+      return other->state == xproperty->state;
+    }
+
+  return FALSE;
+}
+
 static gboolean
 meta_x11_event_source_dispatch (GSource     *source,
                                 GSourceFunc  callback,
@@ -66,6 +110,9 @@ meta_x11_event_source_dispatch (GSource     *source,
       pending--;
 
       XNextEvent (event_source->xdisplay, &xevent);
+      if (is_superseded_property_notify (event_source->xdisplay, &xevent))
+        continue;
+
       retval = event_func (&xevent, user_data);
     }
 
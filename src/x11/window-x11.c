@@ -1593,13 +1593,17 @@ meta_window_x11_move_resize_internal (MetaWindow                *window,
   window_drag =
     meta_compositor_get_current_window_drag (window->display->compositor);
 
-  if (mask != 0 &&
-      window_drag &&
+  /* Only ask for a sync response from the windows that get a new size.
+   * One that is only moved has nothing to redraw, and the resize would
+   * wait for its counter until the request times out.
+   */
+  if (window_drag &&
       window == meta_window_drag_get_window (window_drag) &&
       meta_grab_op_is_resizing (meta_window_drag_get_grab_op (window_drag)))
     {
-      meta_sync_counter_send_request (&priv->sync_counter);
-      if (priv->frame)
+      if (need_resize_client)
+        meta_sync_counter_send_request (&priv->sync_counter);
+      if (priv->frame && need_resize_frame)
         meta_sync_counter_send_request (meta_frame_get_sync_counter (priv->frame));
     }
 
@@ -4032,6 +4036,8 @@ meta_window_x11_new (MetaDisplay       *display,
                      MetaCompEffect     effect)
 {
   MetaX11Display *x11_display = display->x11_display;
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  xcb_get_property_cookie_t wm_state_cookie = { 0 };
   XWindowAttributes attrs;
   gulong existing_wm_state;
   MetaWindow *window = NULL;
@@ -4055,6 +4061,18 @@ meta_window_x11_new (MetaDisplay       *display,
    * so we must be careful with X error handling.
    */
 
+  /* When adopting existing windows, unmapped ones are only managed
+   * depending on their WM_STATE. Send that request ahead of the
+   * attributes query, so both replies come back in a single round trip.
+   */
+  if (must_be_viewable)
+    {
+      wm_state_cookie = xcb_get_property (xcb_conn, False, xwindow,
+                                          x11_display->atom_WM_STATE,
+                                          x11_display->atom_WM_STATE,
+                                          0, 1);
+    }
+
   if (!XGetWindowAttributes (x11_display->xdisplay, xwindow, &attrs))
     {
       meta_verbose ("Failed to get attributes for window 0x%lx",
@@ -4089,15 +4107,22 @@ meta_window_x11_new (MetaDisplay       *display,
   existing_wm_state = WithdrawnState;
   if (must_be_viewable && attrs.map_state != IsViewable)
     {
-      /* Only manage if WM_STATE is IconicState or NormalState */
-      uint32_t state;
+      g_autofree xcb_get_property_reply_t *reply = NULL;
+      g_autofree xcb_generic_error_t *xcb_error = NULL;
+      uint32_t state = WithdrawnState;
+
+      reply = xcb_get_property_reply (xcb_conn, wm_state_cookie, &xcb_error);
+      wm_state_cookie.sequence = 0;
 
       /* WM_STATE isn't a cardinal, it's type WM_STATE, but is an int */
-      if (!(meta_prop_get_cardinal_with_atom_type (x11_display, xwindow,
-                                                   x11_display->atom_WM_STATE,
-                                                   x11_display->atom_WM_STATE,
-                                                   &state) &&
-            (state == IconicState || state == NormalState)))
+      if (reply &&
+          reply->type == x11_display->atom_WM_STATE &&
+          reply->format == 32 &&
+          xcb_get_property_value_length (reply) >= (int) sizeof (uint32_t))
+        state = *(uint32_t *) xcb_get_property_value (reply);
+
+      /* Only manage if WM_STATE is IconicState or NormalState */
+      if (state != IconicState && state != NormalState)
         {
           meta_verbose ("Deciding not to manage unmapped or unviewable window 0x%lx",
                         xwindow);
@@ -4108,6 +4133,10 @@ meta_window_x11_new (MetaDisplay       *display,
       meta_verbose ("WM_STATE of %lx = %s", xwindow,
                     wm_state_to_string (existing_wm_state));
     }
+  else if (wm_state_cookie.sequence != 0)
+    {
+      xcb_discard_reply (xcb_conn, wm_state_cookie.sequence);
+    }
 
   /*
    * XAddToSaveSet can only be called on windows created by a different
@@ -4215,6 +4244,8 @@ meta_window_x11_new (MetaDisplay       *display,
   return window;
 
 error:
+  if (wm_state_cookie.sequence != 0)
+    xcb_discard_reply (xcb_conn, wm_state_cookie.sequence);
   mtk_x11_error_trap_pop (x11_display->xdisplay);
   return NULL;
 }
@@ -2,6 +2,7 @@
 
 import argparse
 import dbus
+import os
 
 NAME = 'org.gnome.Mutter.DebugControl'
 INTERFACE = 'org.gnome.Mutter.DebugControl'
@@ -77,6 +78,52 @@ def set_value(kv):
 
     debug_control.Set(INTERFACE, prop, value, dbus_interface=PROPS_IFACE)
 
+def counters():
+    debug_control = get_debug_control()
+    counters = debug_control.GetPerformanceCounters(dbus_interface=INTERFACE)
+    for name, value in sorted(counters.items()):
+        print(f"{name}: {value}")
+
+def frames():
+    debug_control = get_debug_control()
+    views = debug_control.GetFrameStatistics(dbus_interface=INTERFACE)
+    for name, frames in sorted(views.items()):
+        print(f"{name}:")
+        for (dispatch, layout, paint, flush, gpu_ns,
+             target, presentation, flags) in frames:
+            line = (f"  dispatch {dispatch}: layout +{layout - dispatch} µs, "
+                    f"paint +{paint - layout} µs, flush +{flush - paint} µs")
+            if gpu_ns:
+                line += f", GPU {gpu_ns // 1000} µs"
+            if presentation:
+                line += f", presented +{presentation - flush} µs"
+            if flags & 2:
+                line += ", missed deadline"
+            if flags & 4:
+                line += ", missed vblank"
+            print(line)
+
+def clients():
+    debug_control = get_debug_control()
+    clients = debug_control.GetWaylandClientStats(dbus_interface=INTERFACE)
+    for pid, stats in sorted(clients):
+        print(f"{pid}:")
+        for name, value in sorted(stats.items()):
+            print(f"  {name}: {value}")
+
+def trim():
+    debug_control = get_debug_control()
+    freed = debug_control.TrimCaches(dbus_interface=INTERFACE)
+    for name, n_bytes in sorted(freed.items()):
+        print(f"{name}: {n_bytes} bytes")
+
+def capture(directory):
+    debug_control = get_debug_control()
+    paths = debug_control.CaptureFrame(os.path.abspath(directory),
+                                       dbus_interface=INTERFACE)
+    for path in paths:
+        print(path)
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(description='Get and set debug state')
 
@@ -85,6 +132,11 @@ if __name__ == '__main__':
     parser.add_argument('--disable', metavar='PROPERTY', type=str, nargs='?')
     parser.add_argument('--toggle', metavar='PROPERTY', type=str, nargs='?')
     parser.add_argument('--set', metavar='PROPERTY', type=str, nargs=2)
+    parser.add_argument('--counters', action='store_true')
+    parser.add_argument('--frames', action='store_true')
+    parser.add_argument('--clients', action='store_true')
+    parser.add_argument('--trim', action='store_true')
+    parser.add_argument('--capture', metavar='DIRECTORY', type=str)
 
     args = parser.parse_args()
     if args.status:
@@ -97,5 +149,15 @@ if __name__ == '__main__':
         toggle(args.toggle)
     elif args.set:
         set_value(args.set)
+    elif args.counters:
+        counters()
+    elif args.frames:
+        frames()
+    elif args.clients:
+        clients()
+    elif args.trim:
+        trim()
+    elif args.capture:
+        capture(args.capture)
     else:
         parser.print_usage()
@@ -0,0 +1,950 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays frames captured with the CaptureFrame method of the
+ * org.gnome.Mutter.DebugControl interface in a headless Cogl context, and
+ * reports how long the GPU takes to render them. Every framebuffer of the
+ * capture is replaced with an offscreen one of the same size, so
+ * captures can be compared across drivers and GPUs without the session
+ * that produced them.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "clutter/clutter.h"
+#include "meta/meta-backend.h"
+#include "meta-test/meta-context-test.h"
+
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_SRC_COLOR 0x0300
+#define GL_ONE_MINUS_SRC_COLOR 0x0301
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_DST_ALPHA 0x0304
+#define GL_ONE_MINUS_DST_ALPHA 0x0305
+#define GL_DST_COLOR 0x0306
+#define GL_ONE_MINUS_DST_COLOR 0x0307
+#define GL_FUNC_ADD 0x8006
+
+typedef struct _ReplayReader
+{
+  const uint8_t *data;
+  size_t size;
+  size_t offset;
+  gboolean overflow;
+} ReplayReader;
+
+typedef struct _ReplayClipEntry
+{
+  uint32_t type;
+  float coords[4];
+  graphene_matrix_t modelview;
+  MtkRegion *region;
+} ReplayClipEntry;
+
+typedef struct _ReplayFramebuffer
+{
+  CoglFramebuffer *framebuffer;
+  uint32_t clip_id;
+  unsigned int clip_depth;
+} ReplayFramebuffer;
+
+typedef enum _ReplayOpType
+{
+  REPLAY_OP_PROJECTION,
+  REPLAY_OP_CLEAR,
+  REPLAY_OP_DRAW,
+} ReplayOpType;
+
+typedef struct _ReplayOp
+{
+  ReplayOpType type;
+  uint32_t framebuffer_id;
+  uint32_t clip_id;
+
+  /* Projection */
+  graphene_matrix_t projection;
+
+  /* Clear */
+  uint32_t buffers;
+  float color[4];
+
+  /* Draw */
+  uint32_t pipeline_id;
+  float viewport[4];
+  graphene_matrix_t modelview;
+  float coords[4];
+  int n_layers;
+  float *tex_coords;
+} ReplayOp;
+
+typedef struct _Replay
+{
+  CoglContext *cogl_context;
+
+  GHashTable *textures;
+  GHashTable *pipelines;
+  GHashTable *framebuffers;
+  GHashTable *clips;
+  GArray *ops;
+
+  unsigned int n_draws;
+  unsigned int n_approximated_pipelines;
+} Replay;
+
+static int n_iterations = 100;
+
+static const GOptionEntry replay_options[] = {
+  {
+    "iterations", 'n', 0, G_OPTION_ARG_INT,
+    &n_iterations,
+    "Number of times each capture is replayed (default: 100)",
+    "N"
+  },
+  { NULL }
+};
+
+static gboolean
+reader_read (ReplayReader *reader,
+             void         *dest,
+             size_t        size)
+{
+  if (reader->overflow || size > reader->size - reader->offset)
+    {
+      reader->overflow = TRUE;
+      memset (dest, 0, size);
+      return FALSE;
+    }
+
+  memcpy (dest, reader->data + reader->offset, size);
+  reader->offset += size;
+  return TRUE;
+}
+
+static uint32_t
+reader_read_uint32 (ReplayReader *reader)
+{
+  uint32_t value;
+
+  reader_read (reader, &value, sizeof (value));
+  return value;
+}
+
+static int32_t
+reader_read_int32 (ReplayReader *reader)
+{
+  int32_t value;
+
+  reader_read (reader, &value, sizeof (value));
+  return value;
+}
+
+static void
+reader_read_floats (ReplayReader *reader,
+                    float        *values,
+                    int           n_values)
+{
+  reader_read (reader, values, n_values * sizeof (float));
+}
+
+static void
+reader_read_matrix (ReplayReader      *reader,
+                    graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  reader_read_floats (reader, values, G_N_ELEMENTS (values));
+  graphene_matrix_init_from_float (matrix, values);
+}
+
+static void
+replay_clip_free (GArray *entries)
+{
+  unsigned int i;
+
+  for (i = 0; i < entries->len; i++)
+    {
+      ReplayClipEntry *entry = &g_array_index (entries, ReplayClipEntry, i);
+
+      g_clear_pointer (&entry->region, mtk_region_unref);
+    }
+
+  g_array_free (entries, TRUE);
+}
+
+static void
+replay_framebuffer_free (ReplayFramebuffer *replay_framebuffer)
+{
+  g_object_unref (replay_framebuffer->framebuffer);
+  g_free (replay_framebuffer);
+}
+
+static Replay *
+replay_new (CoglContext *cogl_context)
+{
+  Replay *replay;
+
+  replay = g_new0 (Replay, 1);
+  replay->cogl_context = cogl_context;
+  replay->textures = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  replay->pipelines = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  replay->framebuffers =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) replay_framebuffer_free);
+  replay->clips =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) replay_clip_free);
+  replay->ops = g_array_new (FALSE, TRUE, sizeof (ReplayOp));
+
+  return replay;
+}
+
+static void
+replay_free (Replay *replay)
+{
+  unsigned int i;
+
+  for (i = 0; i < replay->ops->len; i++)
+    g_free (g_array_index (replay->ops, ReplayOp, i).tex_coords);
+  g_array_free (replay->ops, TRUE);
+
+  g_hash_table_destroy (replay->clips);
+  g_hash_table_destroy (replay->framebuffers);
+  g_hash_table_destroy (replay->pipelines);
+  g_hash_table_destroy (replay->textures);
+  g_free (replay);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (Replay, replay_free)
+
+static gboolean
+parse_texture (Replay        *replay,
+               ReplayReader  *reader,
+               GError       **error)
+{
+  CoglTexture *texture;
+  char hash[64];
+  uint32_t id, width, height, has_pixels;
+
+  id = reader_read_uint32 (reader);
+  reader_read (reader, hash, sizeof (hash));
+  width = reader_read_uint32 (reader);
+  height = reader_read_uint32 (reader);
+  has_pixels = reader_read_uint32 (reader);
+
+  if (reader->overflow || width == 0 || height == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Invalid texture record");
+      return FALSE;
+    }
+
+  if (has_pixels)
+    {
+      size_t size = (size_t) width * height * 4;
+
+      if (size > reader->size - reader->offset)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "Truncated texture record");
+          return FALSE;
+        }
+
+      texture = cogl_texture_2d_new_from_data (replay->cogl_context,
+                                               width, height,
+                                               COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                               width * 4,
+                                               reader->data + reader->offset,
+                                               error);
+      if (!texture)
+        return FALSE;
+
+      reader->offset += size;
+    }
+  else
+    {
+      /* The contents could not be read back when capturing; only the
+       * size matters for timing anyway. */
+      texture = cogl_texture_2d_new_with_size (replay->cogl_context,
+                                               width, height);
+      if (!cogl_texture_allocate (texture, error))
+        {
+          g_object_unref (texture);
+          return FALSE;
+        }
+    }
+
+  g_hash_table_insert (replay->textures, GUINT_TO_POINTER (id), texture);
+  return TRUE;
+}
+
+static const char *
+blend_factor_to_string (uint32_t factor)
+{
+  switch (factor)
+    {
+    case GL_SRC_COLOR:
+      return "SRC_COLOR";
+    case GL_ONE_MINUS_SRC_COLOR:
+      return "1-SRC_COLOR";
+    case GL_SRC_ALPHA:
+      return "SRC_COLOR[A]";
+    case GL_ONE_MINUS_SRC_ALPHA:
+      return "1-SRC_COLOR[A]";
+    case GL_DST_ALPHA:
+      return "DST_COLOR[A]";
+    case GL_ONE_MINUS_DST_ALPHA:
+      return "1-DST_COLOR[A]";
+    case GL_DST_COLOR:
+      return "DST_COLOR";
+    case GL_ONE_MINUS_DST_COLOR:
+      return "1-DST_COLOR";
+    }
+
+  return NULL;
+}
+
+static char *
+blend_argument_to_string (const char *color,
+                          uint32_t    factor)
+{
+  const char *factor_string;
+
+  if (factor == GL_ZERO)
+    return g_strdup ("0");
+  else if (factor == GL_ONE)
+    return g_strdup (color);
+
+  factor_string = blend_factor_to_string (factor);
+  if (!factor_string)
+    return NULL;
+
+  return g_strdup_printf ("%s*(%s)", color, factor_string);
+}
+
+static char *
+blend_statement_to_string (const char *channels,
+                           uint32_t    equation,
+                           uint32_t    src_factor,
+                           uint32_t    dst_factor)
+{
+  g_autofree char *src = NULL;
+  g_autofree char *dst = NULL;
+
+  if (equation != GL_FUNC_ADD)
+    return NULL;
+
+  src = blend_argument_to_string ("SRC_COLOR", src_factor);
+  dst = blend_argument_to_string ("DST_COLOR", dst_factor);
+  if (!src || !dst)
+    return NULL;
+
+  return g_strdup_printf ("%s = ADD (%s, %s)", channels, src, dst);
+}
+
+static gboolean
+parse_pipeline (Replay        *replay,
+                ReplayReader  *reader,
+                GError       **error)
+{
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autofree char *blend_string = NULL;
+  uint32_t id, flags, n_layers, i;
+  uint32_t equation_rgb, equation_alpha;
+  uint32_t src_rgb, dst_rgb, src_alpha, dst_alpha;
+  float color_values[4];
+  CoglColor color;
+  gboolean approximated = FALSE;
+
+  id = reader_read_uint32 (reader);
+  flags = reader_read_uint32 (reader);
+  reader_read_floats (reader, color_values, G_N_ELEMENTS (color_values));
+  equation_rgb = reader_read_uint32 (reader);
+  equation_alpha = reader_read_uint32 (reader);
+  src_rgb = reader_read_uint32 (reader);
+  dst_rgb = reader_read_uint32 (reader);
+  src_alpha = reader_read_uint32 (reader);
+  dst_alpha = reader_read_uint32 (reader);
+  n_layers = reader_read_uint32 (reader);
+
+  pipeline = cogl_pipeline_new (replay->cogl_context);
+
+  cogl_color_init_from_4f (&color,
+                           color_values[0], color_values[1],
+                           color_values[2], color_values[3]);
+  cogl_pipeline_set_color (pipeline, &color);
+
+  for (i = 0; i < n_layers; i++)
+    {
+      uint32_t texture_id = reader_read_uint32 (reader);
+      uint32_t min_filter = reader_read_uint32 (reader);
+      uint32_t mag_filter = reader_read_uint32 (reader);
+      uint32_t wrap_s = reader_read_uint32 (reader);
+      uint32_t wrap_t = reader_read_uint32 (reader);
+      CoglTexture *texture;
+
+      if (reader->overflow)
+        break;
+
+      texture = g_hash_table_lookup (replay->textures,
+                                     GUINT_TO_POINTER (texture_id));
+      cogl_pipeline_set_layer_texture (pipeline, i, texture);
+      cogl_pipeline_set_layer_filters (pipeline, i, min_filter, mag_filter);
+      cogl_pipeline_set_layer_wrap_mode_s (pipeline, i, wrap_s);
+      cogl_pipeline_set_layer_wrap_mode_t (pipeline, i, wrap_t);
+    }
+
+  if (reader->overflow)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Truncated pipeline record");
+      return FALSE;
+    }
+
+  if (!(flags & COGL_CAPTURE_PIPELINE_FLAG_BLEND))
+    {
+      blend_string = g_strdup ("RGBA = ADD (SRC_COLOR, 0)");
+    }
+  else if (src_rgb == src_alpha && dst_rgb == dst_alpha &&
+           equation_rgb == equation_alpha)
+    {
+      blend_string = blend_statement_to_string ("RGBA", equation_rgb,
+                                                src_rgb, dst_rgb);
+    }
+  else
+    {
+      g_autofree char *rgb = NULL;
+      g_autofree char *alpha = NULL;
+
+      rgb = blend_statement_to_string ("RGB", equation_rgb,
+                                       src_rgb, dst_rgb);
+      alpha = blend_statement_to_string ("A", equation_alpha,
+                                         src_alpha, dst_alpha);
+      if (rgb && alpha)
+        blend_string = g_strdup_printf ("%s %s", rgb, alpha);
+    }
+
+  /* Pipelines with blending Cogl can't express as a blend string keep
+   * the default premultiplied over blending. */
+  if (!blend_string ||
+      !cogl_pipeline_set_blend (pipeline, blend_string, NULL))
+    approximated = TRUE;
+
+  if (flags & COGL_CAPTURE_PIPELINE_FLAG_SNIPPETS)
+    approximated = TRUE;
+
+  if (approximated)
+    replay->n_approximated_pipelines++;
+
+  g_hash_table_insert (replay->pipelines, GUINT_TO_POINTER (id),
+                       g_steal_pointer (&pipeline));
+  return TRUE;
+}
+
+static gboolean
+parse_framebuffer (Replay        *replay,
+                   ReplayReader  *reader,
+                   GError       **error)
+{
+  ReplayFramebuffer *replay_framebuffer;
+  ReplayOp op = { 0 };
+  uint32_t id, width, height;
+
+  id = reader_read_uint32 (reader);
+  width = reader_read_uint32 (reader);
+  height = reader_read_uint32 (reader);
+  reader_read_uint32 (reader); /* is_onscreen */
+  reader_read_matrix (reader, &op.projection);
+
+  if (reader->overflow || width == 0 || height == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Invalid framebuffer record");
+      return FALSE;
+    }
+
+  replay_framebuffer = g_hash_table_lookup (replay->framebuffers,
+                                            GUINT_TO_POINTER (id));
+  if (!replay_framebuffer)
+    {
+      g_autoptr (CoglTexture) texture = NULL;
+      CoglOffscreen *offscreen;
+
+      texture = cogl_texture_2d_new_with_size (replay->cogl_context,
+                                               width, height);
+      offscreen = cogl_offscreen_new_with_texture (texture);
+      if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+        {
+          g_object_unref (offscreen);
+          return FALSE;
+        }
+
+      replay_framebuffer = g_new0 (ReplayFramebuffer, 1);
+      replay_framebuffer->framebuffer = COGL_FRAMEBUFFER (offscreen);
+      g_hash_table_insert (replay->framebuffers, GUINT_TO_POINTER (id),
+                           replay_framebuffer);
+    }
+
+  op.type = REPLAY_OP_PROJECTION;
+  op.framebuffer_id = id;
+  g_array_append_val (replay->ops, op);
+  return TRUE;
+}
+
+static gboolean
+parse_clip (Replay        *replay,
+            ReplayReader  *reader,
+            GError       **error)
+{
+  GArray *entries;
+  uint32_t id, n_entries, i;
+
+  id = reader_read_uint32 (reader);
+  n_entries = reader_read_uint32 (reader);
+
+  entries = g_array_new (FALSE, TRUE, sizeof (ReplayClipEntry));
+  g_hash_table_insert (replay->clips, GUINT_TO_POINTER (id), entries);
+
+  for (i = 0; i < n_entries && !reader->overflow; i++)
+    {
+      ReplayClipEntry entry = { 0 };
+
+      entry.type = reader_read_uint32 (reader);
+      if (entry.type == 0)
+        {
+          reader_read_floats (reader, entry.coords, 4);
+          reader_read_matrix (reader, &entry.modelview);
+        }
+      else if (entry.type == 1)
+        {
+          uint32_t n_rects = reader_read_uint32 (reader);
+          uint32_t j;
+
+          entry.region = mtk_region_create ();
+          for (j = 0; j < n_rects && !reader->overflow; j++)
+            {
+              MtkRectangle rect;
+
+              rect.x = reader_read_int32 (reader);
+              rect.y = reader_read_int32 (reader);
+              rect.width = reader_read_int32 (reader);
+              rect.height = reader_read_int32 (reader);
+              mtk_region_union_rectangle (entry.region, &rect);
+            }
+        }
+      else
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "Unknown clip entry type %u", entry.type);
+          return FALSE;
+        }
+
+      g_array_append_val (entries, entry);
+    }
+
+  if (reader->overflow)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Truncated clip record");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+parse_clear (Replay        *replay,
+             ReplayReader  *reader,
+             GError       **error)
+{
+  ReplayOp op = { 0 };
+
+  op.type = REPLAY_OP_CLEAR;
+  op.framebuffer_id = reader_read_uint32 (reader);
+  op.clip_id = reader_read_uint32 (reader);
+  op.buffers = reader_read_uint32 (reader);
+  reader_read_floats (reader, op.color, G_N_ELEMENTS (op.color));
+
+  if (reader->overflow)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Truncated clear record");
+      return FALSE;
+    }
+
+  g_array_append_val (replay->ops, op);
+  return TRUE;
+}
+
+static gboolean
+parse_draw (Replay        *replay,
+            ReplayReader  *reader,
+            GError       **error)
+{
+  ReplayOp op = { 0 };
+
+  op.type = REPLAY_OP_DRAW;
+  op.framebuffer_id = reader_read_uint32 (reader);
+  op.pipeline_id = reader_read_uint32 (reader);
+  op.clip_id = reader_read_uint32 (reader);
+  reader_read_floats (reader, op.viewport, G_N_ELEMENTS (op.viewport));
+  reader_read_matrix (reader, &op.modelview);
+  op.n_layers = reader_read_uint32 (reader);
+  reader_read_floats (reader, op.coords, G_N_ELEMENTS (op.coords));
+
+  if (reader->overflow || op.n_layers > 32)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Invalid draw record");
+      return FALSE;
+    }
+
+  op.tex_coords = g_new0 (float, op.n_layers * 4);
+  reader_read_floats (reader, op.tex_coords, op.n_layers * 4);
+
+  if (reader->overflow)
+    {
+      g_free (op.tex_coords);
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Truncated draw record");
+      return FALSE;
+    }
+
+  g_array_append_val (replay->ops, op);
+  replay->n_draws++;
+  return TRUE;
+}
+
+static gboolean
+replay_load (Replay       *replay,
+             const char   *path,
+             GError      **error)
+{
+  g_autofree char *contents = NULL;
+  ReplayReader reader = { 0 };
+  char magic[COGL_CAPTURE_MAGIC_LEN];
+  size_t length;
+  uint32_t version;
+
+  if (!g_file_get_contents (path, &contents, &length, error))
+    return FALSE;
+
+  reader.data = (const uint8_t *) contents;
+  reader.size = length;
+
+  reader_read (&reader, magic, sizeof (magic));
+  version = reader_read_uint32 (&reader);
+  if (reader.overflow ||
+      memcmp (magic, COGL_CAPTURE_MAGIC, COGL_CAPTURE_MAGIC_LEN) != 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Not a Cogl capture");
+      return FALSE;
+    }
+
+  if (version != COGL_CAPTURE_VERSION)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Unsupported capture version %u", version);
+      return FALSE;
+    }
+
+  while (reader.offset < reader.size)
+    {
+      ReplayReader record_reader;
+      uint32_t type, size;
+      gboolean ret;
+
+      type = reader_read_uint32 (&reader);
+      size = reader_read_uint32 (&reader);
+      if (reader.overflow || size > reader.size - reader.offset)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "Truncated capture");
+          return FALSE;
+        }
+
+      record_reader = (ReplayReader) {
+        .data = reader.data + reader.offset,
+        .size = size,
+      };
+
+      switch ((CoglCaptureRecordType) type)
+        {
+        case COGL_CAPTURE_RECORD_TEXTURE:
+          ret = parse_texture (replay, &record_reader, error);
+          break;
+        case COGL_CAPTURE_RECORD_PIPELINE:
+          ret = parse_pipeline (replay, &record_reader, error);
+          break;
+        case COGL_CAPTURE_RECORD_FRAMEBUFFER:
+          ret = parse_framebuffer (replay, &record_reader, error);
+          break;
+        case COGL_CAPTURE_RECORD_CLIP:
+          ret = parse_clip (replay, &record_reader, error);
+          break;
+        case COGL_CAPTURE_RECORD_CLEAR:
+          ret = parse_clear (replay, &record_reader, error);
+          break;
+        case COGL_CAPTURE_RECORD_DRAW:
+          ret = parse_draw (replay, &record_reader, error);
+          break;
+        default:
+          /* Records added by later versions are skipped */
+          ret = TRUE;
+          break;
+        }
+
+      if (!ret)
+        return FALSE;
+
+      reader.offset += size;
+    }
+
+  return TRUE;
+}
+
+static void
+replay_set_clip (Replay            *replay,
+                 ReplayFramebuffer *replay_framebuffer,
+                 uint32_t           clip_id)
+{
+  CoglFramebuffer *framebuffer = replay_framebuffer->framebuffer;
+  GArray *entries;
+  unsigned int i;
+
+  if (replay_framebuffer->clip_id == clip_id)
+    return;
+
+  for (i = 0; i < replay_framebuffer->clip_depth; i++)
+    cogl_framebuffer_pop_clip (framebuffer);
+  replay_framebuffer->clip_depth = 0;
+  replay_framebuffer->clip_id = clip_id;
+
+  entries = g_hash_table_lookup (replay->clips, GUINT_TO_POINTER (clip_id));
+  if (!entries)
+    return;
+
+  for (i = 0; i < entries->len; i++)
+    {
+      ReplayClipEntry *entry = &g_array_index (entries, ReplayClipEntry, i);
+
+      if (entry->region)
+        {
+          cogl_framebuffer_push_region_clip (framebuffer, entry->region);
+        }
+      else
+        {
+          cogl_framebuffer_set_modelview_matrix (framebuffer,
+                                                 &entry->modelview);
+          cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                                entry->coords[0],
+                                                entry->coords[1],
+                                                entry->coords[2],
+                                                entry->coords[3]);
+        }
+      replay_framebuffer->clip_depth++;
+    }
+}
+
+static void
+replay_run (Replay *replay)
+{
+  GHashTableIter iter;
+  ReplayFramebuffer *replay_framebuffer;
+  unsigned int i;
+
+  for (i = 0; i < replay->ops->len; i++)
+    {
+      ReplayOp *op = &g_array_index (replay->ops, ReplayOp, i);
+      CoglFramebuffer *framebuffer;
+      CoglPipeline *pipeline;
+
+      replay_framebuffer =
+        g_hash_table_lookup (replay->framebuffers,
+                             GUINT_TO_POINTER (op->framebuffer_id));
+      if (!replay_framebuffer)
+        continue;
+
+      framebuffer = replay_framebuffer->framebuffer;
+
+      switch (op->type)
+        {
+        case REPLAY_OP_PROJECTION:
+          cogl_framebuffer_set_projection_matrix (framebuffer,
+                                                  &op->projection);
+          break;
+        case REPLAY_OP_CLEAR:
+          replay_set_clip (replay, replay_framebuffer, op->clip_id);
+          cogl_framebuffer_clear4f (framebuffer, op->buffers,
+                                    op->color[0], op->color[1],
+                                    op->color[2], op->color[3]);
+          break;
+        case REPLAY_OP_DRAW:
+          pipeline = g_hash_table_lookup (replay->pipelines,
+                                          GUINT_TO_POINTER (op->pipeline_id));
+          if (!pipeline)
+            break;
+
+          replay_set_clip (replay, replay_framebuffer, op->clip_id);
+          cogl_framebuffer_set_viewport (framebuffer,
+                                         op->viewport[0], op->viewport[1],
+                                         op->viewport[2], op->viewport[3]);
+          cogl_framebuffer_set_modelview_matrix (framebuffer, &op->modelview);
+          cogl_framebuffer_draw_multitextured_rectangle (framebuffer,
+                                                         pipeline,
+                                                         op->coords[0],
+                                                         op->coords[1],
+                                                         op->coords[2],
+                                                         op->coords[3],
+                                                         op->tex_coords,
+                                                         op->n_layers * 4);
+          break;
+        }
+    }
+
+  g_hash_table_iter_init (&iter, replay->framebuffers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &replay_framebuffer))
+    {
+      replay_set_clip (replay, replay_framebuffer, 0);
+      cogl_framebuffer_finish (replay_framebuffer->framebuffer);
+    }
+}
+
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t time_a = *(const int64_t *) a;
+  int64_t time_b = *(const int64_t *) b;
+
+  return (time_a > time_b) - (time_a < time_b);
+}
+
+static gboolean
+replay_capture (CoglContext  *cogl_context,
+                const char   *path,
+                GError      **error)
+{
+  g_autoptr (Replay) replay = NULL;
+  g_autoptr (GArray) times_us = NULL;
+  int64_t total_us = 0;
+  int i;
+
+  replay = replay_new (cogl_context);
+  if (!replay_load (replay, path, error))
+    {
+      g_prefix_error (error, "%s: ", path);
+      return FALSE;
+    }
+
+  /* The first run compiles the shaders and uploads what's left */
+  replay_run (replay);
+
+  times_us = g_array_sized_new (FALSE, FALSE, sizeof (int64_t), n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      int64_t start_time_us, time_us;
+
+      start_time_us = g_get_monotonic_time ();
+      replay_run (replay);
+      time_us = g_get_monotonic_time () - start_time_us;
+
+      g_array_append_val (times_us, time_us);
+      total_us += time_us;
+    }
+
+  g_array_sort (times_us, compare_times);
+
+  g_print ("%s: %u draws, %u textures, %u pipelines",
+           path,
+           replay->n_draws,
+           g_hash_table_size (replay->textures),
+           g_hash_table_size (replay->pipelines));
+  if (replay->n_approximated_pipelines)
+    g_print (" (%u approximated)", replay->n_approximated_pipelines);
+  g_print ("\n");
+
+  if (n_iterations > 0)
+    {
+      g_print ("  %d iterations: min %.3f ms, median %.3f ms, "
+               "mean %.3f ms, max %.3f ms\n",
+               n_iterations,
+               g_array_index (times_us, int64_t, 0) / 1000.0,
+               g_array_index (times_us, int64_t, n_iterations / 2) / 1000.0,
+               total_us / (n_iterations * 1000.0),
+               g_array_index (times_us, int64_t, n_iterations - 1) / 1000.0);
+    }
+
+  return TRUE;
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (MetaContext) context = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaBackend *backend;
+  ClutterBackend *clutter_backend;
+  CoglContext *cogl_context;
+  int status = EXIT_SUCCESS;
+  int i;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  meta_context_add_option_entries (context, replay_options, NULL);
+
+  if (!meta_context_configure (context, &argc, &argv, &error))
+    {
+      g_printerr ("Failed to configure: %s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (argc < 2)
+    {
+      g_printerr ("Usage: %s [--iterations N] CAPTURE...\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (!meta_context_setup (context, &error))
+    {
+      g_printerr ("Failed to set up headless context: %s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  backend = meta_context_get_backend (context);
+  clutter_backend = meta_backend_get_clutter_backend (backend);
+  cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!replay_capture (cogl_context, argv[i], &error))
+        {
+          g_printerr ("Failed to replay capture: %s\n", error->message);
+          g_clear_error (&error);
+          status = EXIT_FAILURE;
+        }
+    }
+
+  return status;
+}